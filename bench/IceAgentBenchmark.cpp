@@ -0,0 +1,125 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+class IceAgentBenchmark : public WebRtcClientBenchmarkBase {
+};
+
+// Pairs state.range(0) local candidates, each with its own socket, with as many remote candidates, then looks up the pair and
+// the transaction id of an inbound binding response the way handleStunPacket does. Items processed are lookups.
+BENCHMARK_DEFINE_F(IceAgentBenchmark, BM_IceAgentConnectivityCheckLookup)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, j, candidateCount = (UINT32) state.range(0), pairCount = 0, found = 0;
+    PIceAgent pIceAgent = NULL;
+    PSocketConnection pSocketConnections = NULL;
+    PIceCandidate pLocalCandidates = NULL, pRemoteCandidates = NULL;
+    PIceCandidatePair pIceCandidatePair = NULL, *ppIceCandidatePairs = NULL;
+    PDoubleListNode pCurNode = NULL;
+    BYTE transactionId[STUN_TRANSACTION_ID_LEN];
+
+    CHK(NULL != (pIceAgent = (PIceAgent) MEMCALLOC(1, SIZEOF(IceAgent))), STATUS_NOT_ENOUGH_MEMORY);
+    CHK(NULL != (pSocketConnections = (PSocketConnection) MEMCALLOC(candidateCount, SIZEOF(SocketConnection))), STATUS_NOT_ENOUGH_MEMORY);
+    CHK(NULL != (pLocalCandidates = (PIceCandidate) MEMCALLOC(candidateCount, SIZEOF(IceCandidate))), STATUS_NOT_ENOUGH_MEMORY);
+    CHK(NULL != (pRemoteCandidates = (PIceCandidate) MEMCALLOC(candidateCount, SIZEOF(IceCandidate))), STATUS_NOT_ENOUGH_MEMORY);
+    CHK_STATUS(doubleListCreate(&pIceAgent->localCandidates));
+    CHK_STATUS(doubleListCreate(&pIceAgent->remoteCandidates));
+    CHK_STATUS(doubleListCreate(&pIceAgent->iceCandidatePairs));
+
+    for (i = 0; i < candidateCount; i++) {
+        pLocalCandidates[i].state = ICE_CANDIDATE_STATE_VALID;
+        pLocalCandidates[i].iceCandidateType = ICE_CANDIDATE_TYPE_HOST;
+        pLocalCandidates[i].ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        pLocalCandidates[i].ipAddress.address[0] = 192;
+        pLocalCandidates[i].ipAddress.address[3] = (BYTE) i;
+        pLocalCandidates[i].priority = candidateCount - i;
+        pLocalCandidates[i].pSocketConnection = &pSocketConnections[i];
+        CHK_STATUS(doubleListInsertItemTail(pIceAgent->localCandidates, (UINT64) &pLocalCandidates[i]));
+    }
+
+    // Trickled in one at a time
+    for (i = 0; i < candidateCount; i++) {
+        pRemoteCandidates[i].state = ICE_CANDIDATE_STATE_VALID;
+        pRemoteCandidates[i].iceCandidateType = ICE_CANDIDATE_TYPE_SERVER_REFLEXIVE;
+        pRemoteCandidates[i].ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        pRemoteCandidates[i].ipAddress.address[0] = 10;
+        pRemoteCandidates[i].ipAddress.address[2] = (BYTE) (i >> 8);
+        pRemoteCandidates[i].ipAddress.address[3] = (BYTE) i;
+        pRemoteCandidates[i].ipAddress.port = (UINT16) getInt16(50000);
+        pRemoteCandidates[i].priority = i + 1;
+        CHK_STATUS(doubleListInsertItemTail(pIceAgent->remoteCandidates, (UINT64) &pRemoteCandidates[i]));
+        CHK_STATUS(createIceCandidatePairs(pIceAgent, &pRemoteCandidates[i], TRUE));
+    }
+
+    // One outstanding request per pair, responses come back in an order unrelated to the priorities
+    CHK_STATUS(doubleListGetNodeCount(pIceAgent->iceCandidatePairs, &pairCount));
+    CHK(pairCount == candidateCount * candidateCount, STATUS_INTERNAL_ERROR);
+    CHK(NULL != (ppIceCandidatePairs = (PIceCandidatePair*) MEMCALLOC(pairCount, SIZEOF(PIceCandidatePair))), STATUS_NOT_ENOUGH_MEMORY);
+    CHK_STATUS(doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode));
+    for (i = 0; pCurNode != NULL; i++, pCurNode = pCurNode->pNext) {
+        j = (UINT32) (((UINT64) i * 7919) % pairCount);
+        ppIceCandidatePairs[j] = (PIceCandidatePair) pCurNode->data;
+        MEMSET(transactionId, 0x00, SIZEOF(transactionId));
+        MEMCPY(transactionId, &j, SIZEOF(UINT32));
+        transactionIdStoreInsert(ppIceCandidatePairs[j]->pTransactionIdStore, transactionId);
+    }
+
+    i = 0;
+    for (auto _ : state) {
+        MEMSET(transactionId, 0x00, SIZEOF(transactionId));
+        MEMCPY(transactionId, &i, SIZEOF(UINT32));
+        CHK_STATUS(findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(pIceAgent, ppIceCandidatePairs[i]->local->pSocketConnection,
+                                                                              &ppIceCandidatePairs[i]->remote->ipAddress, TRUE, &pIceCandidatePair));
+        if (pIceCandidatePair != NULL && transactionIdStoreHasId(pIceCandidatePair->pTransactionIdStore, transactionId)) {
+            found++;
+        }
+        i = (i + 1) % pairCount;
+    }
+    state.SetItemsProcessed((INT64) state.iterations());
+    state.counters["pairs"] = (DOUBLE) pairCount;
+    CHK(found == state.iterations(), STATUS_INTERNAL_ERROR);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Ice agent benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("Connectivity check lookup failed");
+    }
+
+    if (pIceAgent != NULL) {
+        if (pIceAgent->iceCandidatePairs != NULL) {
+            doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode);
+            while (pCurNode != NULL) {
+                pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
+                pCurNode = pCurNode->pNext;
+                freeIceCandidatePair(&pIceCandidatePair);
+            }
+            doubleListFree(pIceAgent->iceCandidatePairs);
+        }
+        // The candidates themselves are owned by the benchmark
+        if (pIceAgent->localCandidates != NULL) {
+            doubleListFree(pIceAgent->localCandidates);
+        }
+        if (pIceAgent->remoteCandidates != NULL) {
+            doubleListFree(pIceAgent->remoteCandidates);
+        }
+    }
+
+    SAFE_MEMFREE(ppIceCandidatePairs);
+    SAFE_MEMFREE(pRemoteCandidates);
+    SAFE_MEMFREE(pLocalCandidates);
+    SAFE_MEMFREE(pSocketConnections);
+    SAFE_MEMFREE(pIceAgent);
+}
+
+BENCHMARK_REGISTER_F(IceAgentBenchmark, BM_IceAgentConnectivityCheckLookup)->Arg(4)->Arg(16)->Arg(KVS_ICE_MAX_LOCAL_CANDIDATE_COUNT);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
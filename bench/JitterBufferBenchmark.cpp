@@ -0,0 +1,115 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE 1200
+#define JITTER_BUFFER_BENCHMARK_CLOCK_RATE   90000
+
+class JitterBufferBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    // Last byte past the payload tells whether the packet starts a frame
+    static BYTE startPayload[JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE + 1];
+    static BYTE followingPayload[JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE + 1];
+    static PJitterBuffer pJitterBuffer;
+    static PBYTE pFrameBuffer;
+    static UINT32 frameBufferSize;
+    static UINT64 framesReady;
+
+    static STATUS depayFn(PBYTE pPayload, UINT32 payloadLength, PBYTE pOutBuffer, PUINT32 pBufferSize, PBOOL pIsStart)
+    {
+        if (pOutBuffer != NULL) {
+            if (*pBufferSize < payloadLength) {
+                return STATUS_BUFFER_TOO_SMALL;
+            }
+            MEMCPY(pOutBuffer, pPayload, payloadLength);
+        }
+        *pBufferSize = payloadLength;
+        if (pIsStart != NULL) {
+            *pIsStart = pPayload[payloadLength] != 0;
+        }
+        return STATUS_SUCCESS;
+    }
+
+    static STATUS frameReadyFn(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 frameSize)
+    {
+        UINT32 filledSize = 0;
+        UNUSED_PARAM(customData);
+
+        if (frameSize > frameBufferSize) {
+            SAFE_MEMFREE(pFrameBuffer);
+            pFrameBuffer = (PBYTE) MEMALLOC(frameSize);
+            frameBufferSize = frameSize;
+        }
+        framesReady++;
+        return jitterBufferFillFrameData(pJitterBuffer, pFrameBuffer, frameSize, &filledSize, startIndex, endIndex);
+    }
+
+    static STATUS frameDroppedFn(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 timestamp)
+    {
+        UNUSED_PARAM(customData);
+        UNUSED_PARAM(startIndex);
+        UNUSED_PARAM(endIndex);
+        UNUSED_PARAM(timestamp);
+        return STATUS_SUCCESS;
+    }
+};
+
+BYTE JitterBufferBenchmark::startPayload[JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE + 1];
+BYTE JitterBufferBenchmark::followingPayload[JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE + 1];
+PJitterBuffer JitterBufferBenchmark::pJitterBuffer = NULL;
+PBYTE JitterBufferBenchmark::pFrameBuffer = NULL;
+UINT32 JitterBufferBenchmark::frameBufferSize = 0;
+UINT64 JitterBufferBenchmark::framesReady = 0;
+
+// Pushes frames of state.range(0) packets in order. Items processed are packets so that the reported rate is the cost per
+// packet, which should not depend on how many packets a frame is made of.
+BENCHMARK_DEFINE_F(JitterBufferBenchmark, BM_JitterBufferPushFrame)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, packetsPerFrame = (UINT32) state.range(0);
+    UINT16 sequenceNumber = 0;
+    UINT32 timestamp = 1;
+    PRtpPacket pRtpPacket = NULL;
+
+    startPayload[JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE] = 1;
+    followingPayload[JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE] = 0;
+    framesReady = 0;
+    CHK_STATUS(createJitterBuffer(frameReadyFn, frameDroppedFn, depayFn, DEFAULT_JITTER_BUFFER_MAX_LATENCY, JITTER_BUFFER_BENCHMARK_CLOCK_RATE,
+                                  0, &pJitterBuffer));
+
+    for (auto _ : state) {
+        for (i = 0; i < packetsPerFrame; i++) {
+            // The payload is not owned by the packet, only the packet itself is freed by the jitter buffer
+            CHK_STATUS(createRtpPacket(2, FALSE, FALSE, 0, i == packetsPerFrame - 1, 96, sequenceNumber++, timestamp, 0x1234ABCD, NULL, 0, 0,
+                                       NULL, i == 0 ? startPayload : followingPayload, JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE, &pRtpPacket));
+            CHK_STATUS(jitterBufferPush(pJitterBuffer, pRtpPacket, NULL));
+            pRtpPacket = NULL;
+        }
+        timestamp += JITTER_BUFFER_BENCHMARK_CLOCK_RATE / 30;
+    }
+    state.SetItemsProcessed((INT64) state.iterations() * packetsPerFrame);
+    state.counters["framesReady"] = (DOUBLE) framesReady;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Jitter buffer benchmark failed with 0x%08x", retStatus);
+    }
+
+    freeRtpPacket(&pRtpPacket);
+    freeJitterBuffer(&pJitterBuffer);
+    SAFE_MEMFREE(pFrameBuffer);
+    frameBufferSize = 0;
+}
+
+BENCHMARK_REGISTER_F(JitterBufferBenchmark, BM_JitterBufferPushFrame)->RangeMultiplier(4)->Range(1, 4 << 10);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
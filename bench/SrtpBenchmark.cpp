@@ -0,0 +1,75 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+class SrtpBenchmark : public WebRtcClientBenchmarkBase {
+};
+
+// Every profile negotiable with the crypto library in use, against an audio sized and a MTU sized payload
+static VOID srtpBenchmarkArguments(benchmark::internal::Benchmark* pBenchmark)
+{
+    INT64 profiles[] = {
+        KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80,
+        KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32,
+#ifdef KVS_USE_OPENSSL
+        KVS_SRTP_PROFILE_AEAD_AES_128_GCM,
+        KVS_SRTP_PROFILE_AEAD_AES_256_GCM,
+#endif
+    };
+    INT64 payloadSizes[] = {160, DEFAULT_MTU_SIZE_BYTES - MIN_HEADER_LENGTH};
+
+    for (auto profile : profiles) {
+        for (auto payloadSize : payloadSizes) {
+            pBenchmark->Args({profile, payloadSize});
+        }
+    }
+}
+
+BENCHMARK_DEFINE_F(SrtpBenchmark, BM_SrtpProtect)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    KVS_SRTP_PROFILE profile = (KVS_SRTP_PROFILE) state.range(0);
+    INT32 payloadSize = (INT32) state.range(1), len;
+    BYTE key[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
+    PSrtpSession pSrtpSession = NULL;
+    PBYTE pPacket = NULL;
+    UINT16 seqNum = 0;
+
+    MEMSET(key, 0x2a, SIZEOF(key));
+    CHK_STATUS(initSrtpSession(key, key, profile, &pSrtpSession));
+
+    CHK(NULL != (pPacket = (PBYTE) MEMCALLOC(1, MIN_HEADER_LENGTH + payloadSize + SRTP_MAX_TRAILER_LEN)), STATUS_NOT_ENOUGH_MEMORY);
+    pPacket[0] = 0x80;
+    pPacket[1] = 96;
+    putUnalignedInt32BigEndian(pPacket + SSRC_OFFSET, 0x12345678);
+
+    for (auto _ : state) {
+        // libsrtp refuses to protect a sequence number twice
+        putUnalignedInt16BigEndian(pPacket + SEQ_NUMBER_OFFSET, seqNum++);
+        len = MIN_HEADER_LENGTH + payloadSize;
+        CHK_STATUS(encryptRtpPacket(pSrtpSession, pPacket, &len));
+    }
+    state.SetBytesProcessed((INT64) state.iterations() * payloadSize);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Srtp benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("SRTP protect failed");
+    }
+
+    freeSrtpSession(&pSrtpSession);
+    SAFE_MEMFREE(pPacket);
+}
+
+BENCHMARK_REGISTER_F(SrtpBenchmark, BM_SrtpProtect)->Apply(srtpBenchmarkArguments);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
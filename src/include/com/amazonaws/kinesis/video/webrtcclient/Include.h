@@ -190,6 +190,9 @@ extern "C" {
 #define STATUS_CREATE_SOCKET_PAIR_FAILED           STATUS_NETWORKING_BASE + 0x00000027
 #define STATUS_SOCKET_WRITE_FAILED                 STATUS_NETWORKING_BASE + 0X00000028
 #define STATUS_INVALID_ADDRESS_LENGTH              STATUS_NETWORKING_BASE + 0X00000029
+#define STATUS_CREATE_EPOLL_FAILED                 STATUS_NETWORKING_BASE + 0x0000002a
+#define STATUS_EPOLL_CTL_FAILED                    STATUS_NETWORKING_BASE + 0x0000002b
+#define STATUS_SOCKET_CONNECTION_BACKPRESSURED     STATUS_NETWORKING_BASE + 0x0000002c
 
 /*!@} */
 
@@ -287,11 +290,14 @@ extern "C" {
  * WEBRTC RTP related codes. Values are derived from STATUS_RTP_BASE (0x5c000000)
  *  @{
  */
-#define STATUS_RTP_BASE                   STATUS_SRTP_BASE + 0x01000000
-#define STATUS_RTP_INPUT_PACKET_TOO_SMALL STATUS_RTP_BASE + 0x00000001
-#define STATUS_RTP_INPUT_MTU_TOO_SMALL    STATUS_RTP_BASE + 0x00000002
-#define STATUS_RTP_INVALID_NALU           STATUS_RTP_BASE + 0x00000003
-#define STATUS_RTP_INVALID_EXTENSION_LEN  STATUS_RTP_BASE + 0x00000004
+#define STATUS_RTP_BASE                           STATUS_SRTP_BASE + 0x01000000
+#define STATUS_RTP_INPUT_PACKET_TOO_SMALL         STATUS_RTP_BASE + 0x00000001
+#define STATUS_RTP_INPUT_MTU_TOO_SMALL            STATUS_RTP_BASE + 0x00000002
+#define STATUS_RTP_INVALID_NALU                   STATUS_RTP_BASE + 0x00000003
+#define STATUS_RTP_INVALID_EXTENSION_LEN          STATUS_RTP_BASE + 0x00000004
+#define STATUS_RTP_BROADCAST_GROUP_CODEC_MISMATCH STATUS_RTP_BASE + 0x00000005
+#define STATUS_RTP_BROADCAST_GROUP_ALREADY_MEMBER STATUS_RTP_BASE + 0x00000006
+#define STATUS_RTP_PACER_QUEUE_FULL               STATUS_RTP_BASE + 0x00000007
 /*!@} */
 
 /////////////////////////////////////////////////////
@@ -617,6 +623,11 @@ extern "C" {
  */
 #define ICE_AGENT_METRICS_CURRENT_VERSION 0
 
+/**
+ * Version of RtcFrameSlices structure
+ */
+#define RTC_FRAME_SLICES_CURRENT_VERSION 0
+
 /*!@} */
 
 /////////////////////////////////////////////////////
@@ -698,6 +709,79 @@ extern "C" {
  */
 #define WEBRTC_THREADPOOL_MAX_THREADS_ENV_VAR (PCHAR) "AWS_KVS_WEBRTC_THREADPOOL_MAX_THREADS"
 
+/**
+ * Maximum number of threads in the shared network reactor pool
+ */
+#define NETWORK_REACTOR_MAX_THREADS 32
+
+/**
+ * Env to set the number of threads in the shared network reactor pool. Defaults to the number of online cores
+ */
+#define WEBRTC_NETWORK_REACTOR_THREADS_ENV_VAR (PCHAR) "AWS_KVS_WEBRTC_NETWORK_REACTOR_THREADS"
+
+/**
+ * Default number of threads servicing the shared timer wheels
+ */
+#define TIMER_WHEEL_DEFAULT_THREADS 2
+
+/**
+ * Maximum number of threads servicing the shared timer wheels
+ */
+#define TIMER_WHEEL_MAX_THREADS 16
+
+/**
+ * Env to set the number of threads servicing the shared timer wheels. 0 gives every PeerConnection its own timer queue thread
+ */
+#define WEBRTC_TIMER_WHEEL_THREADS_ENV_VAR (PCHAR) "AWS_KVS_WEBRTC_TIMER_WHEEL_THREADS"
+
+/**
+ * Default number of pre-generated certificates in the shared certificate pool. The pool is disabled unless
+ * WEBRTC_CERTIFICATE_POOL_SIZE_ENV_VAR asks for certificates
+ */
+#define CERTIFICATE_POOL_DEFAULT_SIZE 0
+
+/**
+ * Maximum number of certificates in the shared certificate pool
+ */
+#define CERTIFICATE_POOL_MAX_SIZE 16
+
+/**
+ * Default time a pooled certificate is handed out to new DTLS sessions before it is replaced
+ */
+#define CERTIFICATE_POOL_DEFAULT_LIFETIME (60 * 60 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+/**
+ * Env to set the number of certificates in the shared certificate pool. 0 disables the pool and every DTLS session
+ * generates its own certificate
+ */
+#define WEBRTC_CERTIFICATE_POOL_SIZE_ENV_VAR (PCHAR) "AWS_KVS_WEBRTC_CERTIFICATE_POOL_SIZE"
+
+/**
+ * Env to set the lifetime in seconds of the certificates in the shared certificate pool
+ */
+#define WEBRTC_CERTIFICATE_POOL_LIFETIME_ENV_VAR (PCHAR) "AWS_KVS_WEBRTC_CERTIFICATE_POOL_LIFETIME_SECONDS"
+
+/**
+ * Maximum number of threads in the shared receive worker pool
+ */
+#define RECEIVE_WORKER_MAX_THREADS 16
+
+/**
+ * Env to set the number of threads in the shared receive worker pool. Defaults to the number of online cores
+ */
+#define WEBRTC_RECEIVE_WORKER_THREADS_ENV_VAR (PCHAR) "AWS_KVS_WEBRTC_RECEIVE_WORKER_THREADS"
+
+/**
+ * Env to cap, in bits per second, the uplink shared by the PeerConnections using the egress bandwidth manager. Not capped by default
+ */
+#define WEBRTC_EGRESS_BANDWIDTH_CAP_ENV_VAR (PCHAR) "AWS_KVS_WEBRTC_EGRESS_BANDWIDTH_CAP_BPS"
+
+/**
+ * Number of inbound SRTP and SRTCP packets a PeerConnection can have waiting for its receive worker. Packets arriving
+ * when the queue is full are dropped. Must be a power of 2
+ */
+#define RECEIVE_WORKER_QUEUE_CAPACITY 1024
+
 /**
  * Env to control whether to use dual stack endpoints, unset means false
  */
@@ -1025,6 +1109,36 @@ typedef enum {
  */
 typedef VOID (*RtcOnFrame)(UINT64, PFrame);
 
+/**
+ * @brief Part of a received frame, pointing into a retained RTP packet or at a codec specific prefix such as an Annex-B start code
+ */
+typedef struct {
+    PBYTE pData; //!< Slice bytes, valid until the frame is released
+    UINT32 size; //!< Slice size in bytes
+} RtcFrameSlice, *PRtcFrameSlice;
+
+/**
+ * @brief Received frame given as the list of its slices instead of a single buffer. Concatenating the slices
+ * gives the same bytes RtcOnFrame would get. The frame belongs to the application until releaseFrameSlices is called.
+ */
+typedef struct {
+    UINT32 version;         //!< Version of the struct
+    UINT32 index;           //!< Index of the frame in the received stream
+    UINT64 decodingTs;      //!< Decoding timestamp
+    UINT64 presentationTs;  //!< Presentation timestamp
+    UINT32 size;            //!< Frame size in bytes, the sum of the slice sizes
+    UINT32 sliceCount;      //!< Number of slices
+    PRtcFrameSlice pSlices; //!< Slices in frame order
+} RtcFrameSlices, *PRtcFrameSlices;
+
+/**
+ * @brief RtcOnFrameSlices is fired everytime a frame is received from the remote peer, like RtcOnFrame but without
+ * copying the frame. The application releases the frame with releaseFrameSlices, from any thread, once done with it.
+ *
+ * NOTE: RtcOnFrameSlices is a KVS specific method
+ */
+typedef VOID (*RtcOnFrameSlices)(UINT64, PRtcFrameSlices);
+
 /**
  * @brief RtcOnBandwidthEstimation is fired everytime a bandwidth estimation value
  * is computed. This will be fired for receiver side estimation
@@ -1051,6 +1165,33 @@ typedef VOID (*RtcOnBandwidthEstimation)(UINT64, DOUBLE);
  */
 typedef VOID (*RtcOnSenderBandwidthEstimation)(UINT64, UINT32, UINT32, UINT32, UINT32, UINT64);
 
+/**
+ * @brief RtcOnTargetBitrate is fired everytime the built-in sender side congestion controller changes its target bitrate.
+ * The estimate combines the delay trend and the loss reported by TWCC feedback, see
+ * https://datatracker.ietf.org/doc/html/draft-ietf-rmcat-gcc-02. Encoders should be reconfigured to stay below it.
+ *
+ * NOTE: RtcOnTargetBitrate is a KVS specific method
+ *
+ * @param[in] UINT64 User customData that will be passed along when RtcOnTargetBitrate is called
+ * @param[in] UINT64 targetBitrate - bits per second available for all the transceivers
+ *
+ */
+typedef VOID (*RtcOnTargetBitrate)(UINT64, UINT64);
+
+/**
+ * @brief RtcOnBackpressure is fired when the socket carrying the media can not keep up and starts queueing outbound
+ * packets, and again once it has caught up. While backpressured the queue is bounded and drops video delta frames
+ * first, then key frames, then audio. Encoders should lower their bitrate or skip frames until it is cleared.
+ *
+ * NOTE: RtcOnBackpressure is a KVS specific method. It is invoked from the thread writing the frame or from the network
+ * thread and must not block or call back into the PeerConnection.
+ *
+ * @param[in] UINT64 User customData that will be passed along when RtcOnBackpressure is called
+ * @param[in] BOOL backpressured - TRUE when the queueing starts, FALSE once the queue has been drained
+ *
+ */
+typedef VOID (*RtcOnBackpressure)(UINT64, BOOL);
+
 /**
  * @brief RtcOnPictureLoss is fired everytime a Picture Loss Indication (PLI)
  * feedback message is received. Receiving such message normally indicates that
@@ -1172,6 +1313,26 @@ typedef struct {
     RtcRtpReceiver receiver;                 //!< RtcRtpReceiver that has track specific information
 } RtcRtpTransceiver, *PRtcRtpTransceiver;
 
+/**
+ * @brief Handle to a group of transceivers that are all sent the same frames. See createRtpBroadcastGroup
+ */
+typedef UINT64 RTP_BROADCAST_GROUP_HANDLE;
+typedef RTP_BROADCAST_GROUP_HANDLE* PRTP_BROADCAST_GROUP_HANDLE;
+
+/**
+ * @brief This is a sentinel indicating an invalid broadcast group handle value
+ */
+#ifndef INVALID_RTP_BROADCAST_GROUP_HANDLE_VALUE
+#define INVALID_RTP_BROADCAST_GROUP_HANDLE_VALUE ((RTP_BROADCAST_GROUP_HANDLE) INVALID_PIC_HANDLE_VALUE)
+#endif
+
+/**
+ * @brief Checks for the broadcast group handle validity
+ */
+#ifndef IS_VALID_RTP_BROADCAST_GROUP_HANDLE
+#define IS_VALID_RTP_BROADCAST_GROUP_HANDLE(h) ((h) != INVALID_RTP_BROADCAST_GROUP_HANDLE_VALUE)
+#endif
+
 /**
  * @brief RtcIceServer is used to describe the STUN and TURN servers that
  * can be used by the ICE Agent to establish a connection with a peer.
@@ -1245,6 +1406,44 @@ typedef struct {
     BOOL enableIceStats; //!< Control whether ICE agent stats are to be calculated. ENABLE_STATS_CALCULATION_CONTROL compiler flag must be defined
                          //!< to use this member, else stats are enabled by default.
 #endif
+
+    BOOL useSharedNetworkReactor; //!< Register the sockets of this PeerConnection with the process wide pool of network reactor
+                                  //!< threads created by initKvsWebRtc instead of spawning a dedicated listener thread.
+                                  //!< Keeps the thread count flat when serving many viewers. Disabled by default.
+
+    BOOL enablePacer; //!< Queue outgoing RTP packets and release them at a pace derived from the target bitrate instead of sending
+                      //!< whole frames at once. Audio goes first, then retransmissions, then video. Disabled by default.
+
+    UINT64 pacerTargetBitrate; //!< Initial target bitrate of the pacer in bits per second, 1 Mbps when 0. Updated by REMB feedback,
+                               //!< by the TWCC based congestion controller and by peerConnectionSetPacerTargetBitrate
+
+    BOOL disableNackGeneration; //!< Do not NACK the packets missing from inbound video streams. Retransmissions are requested by default
+                                //!< and a PLI is sent when too many packets could not be recovered.
+
+    UINT32 nackMaxRetries; //!< Number of NACKs sent for a missing packet, once per round trip, before giving up on it. 10 when 0
+
+    UINT32 nackPliLossBudget; //!< Number of packets given up on before a keyframe is requested with a PLI. 5 when 0
+
+    BOOL disableTwccFeedbackGeneration; //!< Do not send transport-wide congestion control feedback for the inbound packets. When the remote
+                                        //!< peer negotiates the TWCC header extension, feedback is sent by default so that it can react to
+                                        //!< the queuing delay rather than only to loss.
+
+    BOOL useReceiveWorkerPool; //!< Decrypt and depacketize the inbound media on the process wide pool of receive worker threads
+                               //!< instead of on the connection listener thread, so that slow frame callbacks do not delay STUN
+                               //!< and DTLS processing. Packets are dropped when the worker falls too far behind. Disabled by default.
+
+    BOOL useEgressBandwidthManager; //!< Share the uplink cap set with setEgressBandwidthCap with the other PeerConnections that opt in.
+                                    //!< The TWCC and REMB estimates of this PeerConnection are reported to the process wide manager,
+                                    //!< which sets the pacer and gives each sending transceiver its weighted max-min fair share through
+                                    //!< transceiverOnTargetBitrate. Disabled by default.
+
+    BOOL enableForwardErrorCorrection; //!< Offer and accept ULPFEC in RED for video. Outbound frames are protected by XOR parity packets
+                                       //!< sized to the loss the remote peer reports, and inbound packets are recovered from the FEC
+                                       //!< packets of the remote peer before the frames are assembled. Disabled by default.
+
+    UINT32 fecGroupSize; //!< Media packets protected together, at most 48. 16 when 0
+
+    UINT32 fecMaxProtectionPercent; //!< Most FEC packets sent per 100 media packets, however lossy the path. 50 when 0
 } KvsRtcConfiguration, *PKvsRtcConfiguration;
 
 /**
@@ -1710,6 +1909,41 @@ PUBLIC_API STATUS peerConnectionOnIceCandidate(PRtcPeerConnection, UINT64, RtcOn
  */
 PUBLIC_API STATUS peerConnectionOnSenderBandwidthEstimation(PRtcPeerConnection, UINT64, RtcOnSenderBandwidthEstimation);
 
+/**
+ * @brief Set a callback for the target bitrate computed by the built-in congestion controller from TWCC feedback.
+ * When the pacer is enabled its target bitrate follows the same estimate. Not available when
+ * KvsRtcConfiguration.disableSenderSideBandwidthEstimation is set.
+ *
+ * @param[in] PRtcPeerConnection Initialized RtcPeerConnection
+ * @param[in] UINT64 User customData that will be passed along when RtcOnTargetBitrate is called
+ * @param[in] RtcOnTargetBitrate User RtcOnTargetBitrate callback
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS peerConnectionOnTargetBitrate(PRtcPeerConnection, UINT64, RtcOnTargetBitrate);
+
+/**
+ * @brief Set a callback for the backpressure of the network path. Sends never wait for a full socket, the packets it
+ * can not take are queued and drained once it is writable again.
+ *
+ * @param[in] PRtcPeerConnection Initialized RtcPeerConnection
+ * @param[in] UINT64 User customData that will be passed along when RtcOnBackpressure is called
+ * @param[in] RtcOnBackpressure User RtcOnBackpressure callback
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS peerConnectionOnBackpressure(PRtcPeerConnection, UINT64, RtcOnBackpressure);
+
+/**
+ * @brief Set the bitrate the pacer releases packets at. Only valid when KvsRtcConfiguration.enablePacer is set
+ *
+ * @param[in] PRtcPeerConnection Initialized RtcPeerConnection
+ * @param[in] UINT64 Target bitrate in bits per second
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS peerConnectionSetPacerTargetBitrate(PRtcPeerConnection, UINT64);
+
 /**
  * Set a callback for data channel
  *
@@ -1898,6 +2132,27 @@ PUBLIC_API STATUS addTransceiver(PRtcPeerConnection, PRtcMediaStreamTrack, PRtcR
  */
 PUBLIC_API STATUS transceiverOnFrame(PRtcRtpTransceiver, UINT64, RtcOnFrame);
 
+/**
+ * @brief Set a callback for transceiver frames given as slices of the received packets. This avoids the reassembly
+ * copies of transceiverOnFrame, the packets stay allocated until the application releases the frame.
+ *
+ * @param[in] PRtcRtpTransceiver Populated RtcRtpTransceiver struct
+ * @param[in] UINT64 User customData that will be passed along when RtcOnFrameSlices is called
+ * @param[in] RtcOnFrameSlices User RtcOnFrameSlices callback
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS transceiverOnFrameSlices(PRtcRtpTransceiver, UINT64, RtcOnFrameSlices);
+
+/**
+ * @brief Release a frame given to RtcOnFrameSlices along with the packets it points to
+ *
+ * @param[in,out] PRtcFrameSlices* Frame to release, set to NULL
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS releaseFrameSlices(PRtcFrameSlices*);
+
 /**
  * @brief Set a callback for bandwidth estimation results
  *
@@ -1909,6 +2164,33 @@ PUBLIC_API STATUS transceiverOnFrame(PRtcRtpTransceiver, UINT64, RtcOnFrame);
  */
 PUBLIC_API STATUS transceiverOnBandwidthEstimation(PRtcRtpTransceiver, UINT64, RtcOnBandwidthEstimation);
 
+/**
+ * @brief Set a callback for the share of the egress bandwidth given to the transceiver. Only invoked for the sending
+ * transceivers of a PeerConnection created with useEgressBandwidthManager, when the share moves by more than a few percent.
+ *
+ * NOTE: The callback is invoked with the lock of the process wide manager held, it must not block
+ *
+ * @param[in] PRtcRtpTransceiver Populated RtcRtpTransceiver struct
+ * @param[in] UINT64 User customData that will be passed along when RtcOnTargetBitrate is called
+ * @param[in] RtcOnTargetBitrate User RtcOnTargetBitrate callback, given the bits per second the transceiver can send
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS transceiverOnTargetBitrate(PRtcRtpTransceiver, UINT64, RtcOnTargetBitrate);
+
+/**
+ * @brief Change how much of the egress bandwidth of its PeerConnection a transceiver gets. Shares are proportional to the
+ * weights, and what a transceiver can not use because of its maximum goes to the others. Transceivers start with a weight
+ * of 1, audio ones with a maximum of 128 Kbps.
+ *
+ * @param[in] PRtcRtpTransceiver Populated RtcRtpTransceiver struct
+ * @param[in] UINT32 weight, at least 1
+ * @param[in] UINT64 maximum bits per second the transceiver needs, 0 for none
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS transceiverSetEgressBandwidthShare(PRtcRtpTransceiver, UINT32, UINT64);
+
 /**
  * @brief Set a callback for picture loss packet (PLI)
  *
@@ -1946,6 +2228,16 @@ PUBLIC_API STATUS initKvsWebRtc(VOID);
  */
 PUBLIC_API STATUS deinitKvsWebRtc(VOID);
 
+/**
+ * @brief Cap the uplink shared by the PeerConnections created with useEgressBandwidthManager. Defaults to the value of
+ * WEBRTC_EGRESS_BANDWIDTH_CAP_ENV_VAR. Must be called between initKvsWebRtc and deinitKvsWebRtc
+ *
+ * @param[in] UINT64 cap in bits per second, 0 for none
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS setEgressBandwidthCap(UINT64);
+
 /**
  * @brief Adds to the list of codecs we support receiving.
  *
@@ -1968,6 +2260,65 @@ PUBLIC_API STATUS addSupportedCodec(PRtcPeerConnection, RTC_CODEC);
  */
 PUBLIC_API STATUS writeFrame(PRtcRtpTransceiver, PFrame);
 
+/**
+ * @brief Creates a group of transceivers, typically one per viewer, that are all sent the same frames.
+ *
+ * A frame written to the group is packetized once. Only the RTP headers, SRTP protection and the send are done
+ * per transceiver, so the cost of a frame grows with the number of viewers much slower than calling writeFrame
+ * for each of them.
+ *
+ * @param[in] RTC_CODEC Codec of the frames. All the transceivers of the group must send this codec
+ * @param[out] PRTP_BROADCAST_GROUP_HANDLE Handle of the new group
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS createRtpBroadcastGroup(RTC_CODEC, PRTP_BROADCAST_GROUP_HANDLE);
+
+/**
+ * @brief Frees a broadcast group. The transceivers themselves are not freed.
+ *
+ * @param[in,out] PRTP_BROADCAST_GROUP_HANDLE Handle of the group, set to INVALID_RTP_BROADCAST_GROUP_HANDLE_VALUE
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS freeRtpBroadcastGroup(PRTP_BROADCAST_GROUP_HANDLE);
+
+/**
+ * @brief Adds a transceiver to a broadcast group.
+ *
+ * NOTE: A transceiver must be removed from the group before its PeerConnection is freed
+ *
+ * @param[in] RTP_BROADCAST_GROUP_HANDLE Handle of the group
+ * @param[in] PRtcRtpTransceiver Transceiver sending the codec of the group
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS broadcastGroupAddTransceiver(RTP_BROADCAST_GROUP_HANDLE, PRtcRtpTransceiver);
+
+/**
+ * @brief Removes a transceiver from a broadcast group. Removing a transceiver that is not a member is a no-op.
+ *
+ * @param[in] RTP_BROADCAST_GROUP_HANDLE Handle of the group
+ * @param[in] PRtcRtpTransceiver Transceiver to remove
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS broadcastGroupRemoveTransceiver(RTP_BROADCAST_GROUP_HANDLE, PRtcRtpTransceiver);
+
+/**
+ * @brief Packetizes a frame once and sends it on every transceiver of a broadcast group
+ *
+ * Transceivers whose PeerConnection is not connected yet are skipped, like writeFrame does with
+ * STATUS_SRTP_NOT_READY_YET. A failure on one transceiver does not prevent sending to the others.
+ *
+ * @param[in] RTP_BROADCAST_GROUP_HANDLE Handle of the group
+ * @param[in] PFrame Frame of media that will be sent
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS when every connected transceiver was sent the frame,
+ *         otherwise the first failure
+ */
+PUBLIC_API STATUS broadcastGroupWriteFrame(RTP_BROADCAST_GROUP_HANDLE, PFrame);
+
 /** @brief call this function to update stats which depend on external encoder
  *  @param[in] PRtcRtpTransceiver transceiver for which encoder stats will be updated
  *  @param[in] PRtcEncoderStats populated in the application layer which is then consumed as part
@@ -387,7 +387,7 @@ typedef struct {
     UINT32 sliCount;              //!< Only valid for video. Count the total number of Slice Loss Indication (SLI) packets received by this sender
     UINT32 qualityLimitationResolutionChanges; //!< Only valid for video. The number of times that the resolution has changed because we are quality
                                                //!< limited
-    INT32 fecPacketsSent; //!< TODO Total number of RTP FEC packets sent for this SSRC. Can also be incremented while sending FEC packets in band
+    INT32 fecPacketsSent; //!< Total number of RTP FEC packets sent for this SSRC. Can also be incremented while sending FEC packets in band
     UINT64 lastPacketSentTimestamp;  //!< The timestamp in milliseconds at which the last packet was sent for this SSRC
     UINT64 headerBytesSent;          //!< Total number of RTP header and padding bytes sent for this SSRC
     UINT64 bytesDiscardedOnSend;     //!< Total number of bytes for this SSRC that have been discarded due to socket errors
@@ -406,6 +406,9 @@ typedef struct {
     QualityLimitationDurationsRecord qualityLimitationDurations; //!< Total time (seconds) spent in each reason state
     DscpPacketsSentRecord perDscpPacketsSent;                    //!< Total number of packets sent for this SSRC, per DSCP
     RTC_QUALITY_LIMITATION_REASON qualityLimitationReason;       //!< Only valid for video.
+    UINT32 packetsQueued;                                        //!< Number of RTP packets of this SSRC currently waiting in the pacer queue
+    UINT64 bytesQueued;                                          //!< Number of bytes of this SSRC currently waiting in the pacer queue
+    DOUBLE totalPacketSendDelaySeconds;                          //!< totalPacketSendDelay without truncating to whole seconds
 } RtcOutboundRtpStreamStats, *PRtcOutboundRtpStreamStats;
 
 /**
@@ -508,10 +511,10 @@ typedef struct {
     UINT64 headerBytesReceived; //!< Total number of RTP header and padding bytes received for this SSRC. This does not include the size of transport
                                 //!< layer headers such as IP or UDP. headerBytesReceived + bytesReceived equals the number of bytes received as
                                 //!< payload over the transport.
-    UINT64 fecPacketsReceived;  //!< TODO Total number of RTP FEC packets received for this SSRC. This counter can also be incremented when receiving
+    UINT64 fecPacketsReceived;  //!< Total number of RTP FEC packets received for this SSRC. This counter can also be incremented when receiving
                                 //!< FEC packets in-band with media packets (e.g., with Opus).
     UINT64
-    fecPacketsDiscarded;  //!< TODO Total number of RTP FEC packets received for this SSRC where the error correction payload was discarded by the
+    fecPacketsDiscarded;  //!< Total number of RTP FEC packets received for this SSRC where the error correction payload was discarded by the
                           //!< application. This may happen 1. if all the source packets protected by the FEC packet were received or already
                           //!< recovered by a separate FEC packet, or 2. if the FEC packet arrived late, i.e., outside the recovery window, and
                           //!< the lost RTP packets have already been skipped during playout. This is a subset of fecPacketsReceived.
@@ -524,9 +527,9 @@ typedef struct {
     //!< packets can be calculated by adding packetsDuplicated to packetsLost; this will always result in a positive number,
     //!< but not the same number as RFC 3550 would calculate.
 
-    UINT32 nackCount; //!< TODO Count the total number of Negative ACKnowledgement (NACK) packets sent by this receiver.
+    UINT32 nackCount; //!< Count the total number of Negative ACKnowledgement (NACK) packets sent by this receiver.
     UINT32 firCount;  //!< TODO Only valid for video. Count the total number of Full Intra Request (FIR) packets sent by this receiver.
-    UINT32 pliCount;  //!< TODO Only valid for video. Count the total number of Picture Loss Indication (PLI) packets sent by this receiver.
+    UINT32 pliCount;  //!< Only valid for video. Count the total number of Picture Loss Indication (PLI) packets sent by this receiver.
     UINT32 sliCount;  //!< TODO Only valid for video. Count the total number of Slice Loss Indication (SLI) packets sent by this receiver.
     DOMHighResTimeStamp estimatedPlayoutTimestamp; //!< TODO This is the estimated playout time of this receiver's track.
     DOUBLE jitterBufferDelay; //!< TODO It is the sum of the time, in seconds, each audio sample or video frame takes from the time it is received and
@@ -651,6 +654,9 @@ typedef struct {
     UINT64 closePeerConnectionTime;    //!< Time taken (ms) to close the peer connection
     UINT64 freePeerConnectionTime;     //!< Time taken (ms) to free the peer connection object
     UINT64 stunDnsResolutionTime;      //!< Time taken (ms) to complete STUN DNS resolution on the thread
+    UINT32 receiveQueueDepth;          //!< Inbound packets waiting for the receive worker. 0 unless useReceiveWorkerPool is set
+    UINT32 receiveQueueMaxDepth;       //!< Highest number of inbound packets that have been waiting for the receive worker
+    UINT64 receiveQueueDroppedPackets; //!< Inbound packets dropped because the receive worker queue was full
 } PeerConnectionStats, *PPeerConnectionStats;
 
 /**
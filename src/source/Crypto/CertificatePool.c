@@ -0,0 +1,256 @@
+/**
+ * Kinesis Video Producer Certificate Pool
+ */
+#define LOG_CLASS "CertificatePool"
+#include "../Include_i.h"
+
+PCertificatePool getCertificatePoolInstance()
+{
+    static CertificatePool pool = {
+        .lock = INVALID_MUTEX_VALUE, .timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE, .timerId = MAX_UINT32, .poolSize = 0};
+    return &pool;
+}
+
+STATUS createCertificatePool()
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PCertificatePool pCertificatePool = getCertificatePoolInstance();
+    PCHAR pValue;
+    UINT32 poolSize, lifetimeSeconds;
+    BOOL created = FALSE;
+
+    CHK_ERR(!IS_VALID_MUTEX_VALUE(pCertificatePool->lock), STATUS_INVALID_OPERATION, "Certificate pool has been created already");
+
+    if (NULL == (pValue = GETENV(WEBRTC_CERTIFICATE_POOL_SIZE_ENV_VAR)) || STATUS_SUCCESS != STRTOUI32(pValue, NULL, 10, &poolSize)) {
+        poolSize = CERTIFICATE_POOL_DEFAULT_SIZE;
+    }
+    if (NULL == (pValue = GETENV(WEBRTC_CERTIFICATE_POOL_LIFETIME_ENV_VAR)) ||
+        STATUS_SUCCESS != STRTOUI32(pValue, NULL, 10, &lifetimeSeconds) || lifetimeSeconds == 0) {
+        pCertificatePool->lifetime = CERTIFICATE_POOL_DEFAULT_LIFETIME;
+    } else {
+        pCertificatePool->lifetime = lifetimeSeconds * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    }
+    pCertificatePool->poolSize = MIN(poolSize, CERTIFICATE_POOL_MAX_SIZE);
+    pCertificatePool->nextIndex = 0;
+
+    pCertificatePool->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pCertificatePool->lock), STATUS_INVALID_OPERATION);
+    created = TRUE;
+
+    // The generation thread only exists when the pool is enabled. The first run fills the pool right away
+    if (pCertificatePool->poolSize > 0) {
+        CHK_STATUS(timerQueueCreate(&pCertificatePool->timerQueueHandle));
+        CHK_STATUS(timerQueueAddTimer(pCertificatePool->timerQueueHandle, 0, CERTIFICATE_POOL_REFILL_INTERVAL, certificatePoolRefillTimerCallback,
+                                      (UINT64) pCertificatePool, &pCertificatePool->timerId));
+    }
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && created) {
+        freeCertificatePool();
+    }
+
+    return retStatus;
+}
+
+STATUS freeCertificatePool()
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PCertificatePool pCertificatePool = getCertificatePoolInstance();
+    UINT32 i;
+
+    CHK_WARN(IS_VALID_MUTEX_VALUE(pCertificatePool->lock), STATUS_INVALID_OPERATION, "Certificate pool not created, nothing to free");
+
+    // Waits for a running refill to return, it takes the pool lock
+    if (IS_VALID_TIMER_QUEUE_HANDLE(pCertificatePool->timerQueueHandle)) {
+        CHK_LOG_ERR(timerQueueFree(&pCertificatePool->timerQueueHandle));
+    }
+
+    MUTEX_LOCK(pCertificatePool->lock);
+    for (i = 0; i < CERTIFICATE_POOL_MAX_SIZE; i++) {
+        certificatePoolRelease(&pCertificatePool->certificates[i]);
+    }
+
+    // All members of the static instance must be reset so that the pool can be created again
+    pCertificatePool->timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    pCertificatePool->timerId = MAX_UINT32;
+    pCertificatePool->poolSize = 0;
+    pCertificatePool->nextIndex = 0;
+    MUTEX_UNLOCK(pCertificatePool->lock);
+
+    MUTEX_FREE(pCertificatePool->lock);
+    pCertificatePool->lock = INVALID_MUTEX_VALUE;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS certificatePoolAcquire(PPooledCertificate* ppPooledCertificate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PCertificatePool pCertificatePool = getCertificatePoolInstance();
+    PPooledCertificate pPooledCertificate = NULL;
+    BOOL locked = FALSE;
+    UINT32 i;
+
+    CHK(ppPooledCertificate != NULL, STATUS_NULL_ARG);
+    CHK(IS_VALID_MUTEX_VALUE(pCertificatePool->lock), STATUS_NOT_FOUND);
+
+    MUTEX_LOCK(pCertificatePool->lock);
+    locked = TRUE;
+
+    // In turn, skipping the slots not generated yet
+    for (i = 0; i < pCertificatePool->poolSize && pPooledCertificate == NULL; i++) {
+        pPooledCertificate = pCertificatePool->certificates[(pCertificatePool->nextIndex + i) % pCertificatePool->poolSize];
+    }
+    CHK(pPooledCertificate != NULL, STATUS_NOT_FOUND);
+
+    pCertificatePool->nextIndex = (pCertificatePool->nextIndex + i) % pCertificatePool->poolSize;
+    ATOMIC_INCREMENT(&pPooledCertificate->refCount);
+    *ppPooledCertificate = pPooledCertificate;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pCertificatePool->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS certificatePoolRelease(PPooledCertificate* ppPooledCertificate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(ppPooledCertificate != NULL, STATUS_NULL_ARG);
+    CHK(*ppPooledCertificate != NULL, retStatus);
+
+    // ATOMIC_DECREMENT returns the value before the decrement
+    if (ATOMIC_DECREMENT(&(*ppPooledCertificate)->refCount) == 1) {
+        CHK_STATUS(freePooledCertificate(ppPooledCertificate));
+    }
+    *ppPooledCertificate = NULL;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS certificatePoolRefillTimerCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData)
+{
+    UNUSED_PARAM(timerId);
+    STATUS retStatus = STATUS_SUCCESS;
+    PCertificatePool pCertificatePool = (PCertificatePool) customData;
+    PPooledCertificate pPooledCertificate = NULL, pReplacedCertificate = NULL;
+    BOOL locked = FALSE, replace;
+    UINT32 i;
+
+    CHK(pCertificatePool != NULL, STATUS_NULL_ARG);
+
+    for (i = 0; i < pCertificatePool->poolSize; i++) {
+        MUTEX_LOCK(pCertificatePool->lock);
+        replace = pCertificatePool->certificates[i] == NULL || pCertificatePool->certificates[i]->expiration <= currentTime;
+        MUTEX_UNLOCK(pCertificatePool->lock);
+
+        if (replace) {
+            // The expired certificate keeps being handed out until the new one is ready, key generation runs without the lock
+            CHK_STATUS(createPooledCertificate(currentTime + pCertificatePool->lifetime, &pPooledCertificate));
+
+            MUTEX_LOCK(pCertificatePool->lock);
+            locked = TRUE;
+            pReplacedCertificate = pCertificatePool->certificates[i];
+            pCertificatePool->certificates[i] = pPooledCertificate;
+            pPooledCertificate = NULL;
+            MUTEX_UNLOCK(pCertificatePool->lock);
+            locked = FALSE;
+
+            // Sessions still using it hold their own reference
+            CHK_STATUS(certificatePoolRelease(&pReplacedCertificate));
+            DLOGV("Certificate %u of the pool has been generated", i);
+        }
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pCertificatePool->lock);
+    }
+
+    freePooledCertificate(&pPooledCertificate);
+    CHK_LOG_ERR(retStatus);
+
+    // Keep trying on the next run
+    return STATUS_SUCCESS;
+}
+
+STATUS createPooledCertificate(UINT64 expiration, PPooledCertificate* ppPooledCertificate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PPooledCertificate pPooledCertificate = NULL;
+    UINT64 startTimeInMacro = 0;
+#ifdef KVS_USE_OPENSSL
+    DtlsSessionCertificateInfo certInfo;
+#endif
+
+    CHK(ppPooledCertificate != NULL, STATUS_NULL_ARG);
+
+    CHK(NULL != (pPooledCertificate = (PPooledCertificate) MEMCALLOC(1, SIZEOF(PooledCertificate))), STATUS_NOT_ENOUGH_MEMORY);
+    // The reference of the pool
+    pPooledCertificate->refCount = 1;
+    pPooledCertificate->expiration = expiration;
+
+#ifdef KVS_USE_OPENSSL
+    PROFILE_CALL(CHK_STATUS(createCertificateAndKey(GENERATED_CERTIFICATE_BITS, FALSE, &pPooledCertificate->pCert, &pPooledCertificate->pKey)),
+                 "Pooled certificate creation time");
+    CHK_STATUS(dtlsCertificateFingerprint(pPooledCertificate->pCert, pPooledCertificate->fingerprint));
+
+    MEMSET(&certInfo, 0x00, SIZEOF(DtlsSessionCertificateInfo));
+    certInfo.pCert = pPooledCertificate->pCert;
+    certInfo.pKey = pPooledCertificate->pKey;
+    CHK_STATUS(createSslCtx(&certInfo, 1, &pPooledCertificate->pSslCtx));
+#elif KVS_USE_MBEDTLS
+    PROFILE_CALL(CHK_STATUS(createCertificateAndKey(GENERATED_CERTIFICATE_BITS, FALSE, &pPooledCertificate->cert, &pPooledCertificate->privateKey)),
+                 "Pooled certificate creation time");
+    CHK_STATUS(dtlsCertificateFingerprint(&pPooledCertificate->cert, pPooledCertificate->fingerprint));
+#else
+#error "A Crypto implementation is required."
+#endif
+
+    *ppPooledCertificate = pPooledCertificate;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        freePooledCertificate(&pPooledCertificate);
+    }
+
+    return retStatus;
+}
+
+STATUS freePooledCertificate(PPooledCertificate* ppPooledCertificate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PPooledCertificate pPooledCertificate;
+
+    CHK(ppPooledCertificate != NULL, STATUS_NULL_ARG);
+    pPooledCertificate = *ppPooledCertificate;
+    CHK(pPooledCertificate != NULL, retStatus);
+
+#ifdef KVS_USE_OPENSSL
+    if (pPooledCertificate->pSslCtx != NULL) {
+        SSL_CTX_free(pPooledCertificate->pSslCtx);
+    }
+    freeCertificateAndKey(&pPooledCertificate->pCert, &pPooledCertificate->pKey);
+#elif KVS_USE_MBEDTLS
+    freeCertificateAndKey(&pPooledCertificate->cert, &pPooledCertificate->privateKey);
+#else
+#error "A Crypto implementation is required."
+#endif
+
+    SAFE_MEMFREE(*ppPooledCertificate);
+
+CleanUp:
+
+    return retStatus;
+}
@@ -0,0 +1,105 @@
+/*******************************************
+Certificate Pool internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_CRYPTO_CERTIFICATE_POOL__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_CRYPTO_CERTIFICATE_POOL__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Period of the background check replacing the expired certificates and generating the missing ones
+#define CERTIFICATE_POOL_REFILL_INTERVAL (1 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+/**
+ * Pre-generated self-signed certificate shared by the DTLS sessions that did not get certificates in their configuration.
+ * Freed once it has left the pool and the last session using it is freed.
+ */
+typedef struct {
+    volatile SIZE_T refCount;
+    // Sessions are no longer given the certificate after this time
+    UINT64 expiration;
+    CHAR fingerprint[CERTIFICATE_FINGERPRINT_LENGTH + 1];
+#ifdef KVS_USE_OPENSSL
+    X509* pCert;
+    EVP_PKEY* pKey;
+    // Context built once for the certificate, every session creates its SSL from it
+    SSL_CTX* pSslCtx;
+#elif KVS_USE_MBEDTLS
+    // mbedtls configurations hold per session state, the sessions copy the certificate and key instead
+    mbedtls_x509_crt cert;
+    mbedtls_pk_context privateKey;
+#else
+#error "A Crypto implementation is required."
+#endif
+} PooledCertificate, *PPooledCertificate;
+
+/**
+ * Process wide pool of ECDSA certificates generated in the background, so that DTLS session creation does not pay for the
+ * key generation. Sessions are given the pooled certificates in turn until they expire. The pool size and the certificate
+ * lifetime come from WEBRTC_CERTIFICATE_POOL_SIZE_ENV_VAR and WEBRTC_CERTIFICATE_POOL_LIFETIME_ENV_VAR.
+ */
+typedef struct {
+    MUTEX lock;
+    TIMER_QUEUE_HANDLE timerQueueHandle;
+    UINT32 timerId;
+    UINT32 poolSize;
+    UINT64 lifetime;
+    // Next certificate handed out
+    UINT32 nextIndex;
+    PPooledCertificate certificates[CERTIFICATE_POOL_MAX_SIZE];
+} CertificatePool, *PCertificatePool;
+
+/**
+ * Get the process wide certificate pool
+ *
+ * @return - PCertificatePool - the singleton
+ */
+PCertificatePool getCertificatePoolInstance();
+
+/**
+ * Create the certificate pool and start generating the certificates in the background. Called by initKvsWebRtc.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createCertificatePool();
+
+/**
+ * Stop the background generation and release the pooled certificates. Sessions still using one keep it alive.
+ * Called by deinitKvsWebRtc.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS freeCertificatePool();
+
+/**
+ * Take a reference to the next certificate of the pool
+ *
+ * @param - PPooledCertificate* - OUT - certificate to release with certificatePoolRelease
+ *
+ * @return - STATUS status of execution. STATUS_NOT_FOUND when the pool is disabled or has no certificate ready yet
+ */
+STATUS certificatePoolAcquire(PPooledCertificate*);
+
+/**
+ * Release a certificate returned by certificatePoolAcquire and set the pointer to NULL
+ *
+ * @param - PPooledCertificate* - IN/OUT - certificate to release
+ *
+ * @return - STATUS status of execution
+ */
+STATUS certificatePoolRelease(PPooledCertificate*);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+STATUS certificatePoolRefillTimerCallback(UINT32, UINT64, UINT64);
+STATUS createPooledCertificate(UINT64, PPooledCertificate*);
+STATUS freePooledCertificate(PPooledCertificate*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_CRYPTO_CERTIFICATE_POOL__ */
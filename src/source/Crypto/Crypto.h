@@ -7,11 +7,21 @@
 extern "C" {
 #endif
 
+// AEAD profiles of https://tools.ietf.org/html/rfc7714#section-14.2, not named by every supported library version
+#define KVS_SRTP_AEAD_AES_128_GCM 0x0007
+#define KVS_SRTP_AEAD_AES_256_GCM 0x0008
+
 #ifdef KVS_USE_OPENSSL
 #define KVS_RSA_F4                  RSA_F4
 #define KVS_MD5_DIGEST_LENGTH       MD5_DIGEST_LENGTH
 #define KVS_SHA1_DIGEST_LENGTH      SHA_DIGEST_LENGTH
 #define KVS_MD5_DIGEST(m, mlen, ob) MD5((m), (mlen), (ob));
+#define KVS_SHA1_CONTEXT            SHA_CTX
+#define KVS_SHA1_INIT(c)            CHK(1 == SHA1_Init(c), STATUS_HMAC_GENERATION_ERROR);
+#define KVS_SHA1_UPDATE(c, m, mlen) CHK(1 == SHA1_Update((c), (m), (mlen)), STATUS_HMAC_GENERATION_ERROR);
+#define KVS_SHA1_FINAL(c, ob)       CHK(1 == SHA1_Final((ob), (c)), STATUS_HMAC_GENERATION_ERROR);
+#define KVS_SHA1_COPY(dst, src)     *(dst) = *(src);
+#define KVS_SHA1_FREE(c)
 #define KVS_SHA1_HMAC(k, klen, m, mlen, ob, plen)                                                                                                    \
     CHK(NULL != HMAC(EVP_sha1(), (k), (INT32) (klen), (m), (mlen), (ob), (plen)), STATUS_HMAC_GENERATION_ERROR);
 #define KVS_CRYPTO_INIT()                                                                                                                            \
@@ -30,6 +40,8 @@ extern "C" {
 typedef enum {
     KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80 = SRTP_AES128_CM_SHA1_80,
     KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32 = SRTP_AES128_CM_SHA1_32,
+    KVS_SRTP_PROFILE_AEAD_AES_128_GCM = KVS_SRTP_AEAD_AES_128_GCM,
+    KVS_SRTP_PROFILE_AEAD_AES_256_GCM = KVS_SRTP_AEAD_AES_256_GCM,
 } KVS_SRTP_PROFILE;
 #elif KVS_USE_MBEDTLS
 #define KVS_RSA_F4             0x10001L
@@ -40,6 +52,22 @@ typedef enum {
 #else
 #define KVS_MD5_DIGEST(m, mlen, ob) mbedtls_md5_ret((m), (mlen), (ob));
 #endif
+#define KVS_SHA1_CONTEXT        mbedtls_sha1_context
+#define KVS_SHA1_COPY(dst, src) mbedtls_sha1_clone((dst), (src));
+#define KVS_SHA1_FREE(c)        mbedtls_sha1_free(c);
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+#define KVS_SHA1_INIT(c)                                                                                                                             \
+    mbedtls_sha1_init(c);                                                                                                                            \
+    CHK(0 == mbedtls_sha1_starts(c), STATUS_HMAC_GENERATION_ERROR);
+#define KVS_SHA1_UPDATE(c, m, mlen) CHK(0 == mbedtls_sha1_update((c), (m), (mlen)), STATUS_HMAC_GENERATION_ERROR);
+#define KVS_SHA1_FINAL(c, ob)       CHK(0 == mbedtls_sha1_finish((c), (ob)), STATUS_HMAC_GENERATION_ERROR);
+#else
+#define KVS_SHA1_INIT(c)                                                                                                                             \
+    mbedtls_sha1_init(c);                                                                                                                            \
+    CHK(0 == mbedtls_sha1_starts_ret(c), STATUS_HMAC_GENERATION_ERROR);
+#define KVS_SHA1_UPDATE(c, m, mlen) CHK(0 == mbedtls_sha1_update_ret((c), (m), (mlen)), STATUS_HMAC_GENERATION_ERROR);
+#define KVS_SHA1_FINAL(c, ob)       CHK(0 == mbedtls_sha1_finish_ret((c), (ob)), STATUS_HMAC_GENERATION_ERROR);
+#endif
 #define KVS_SHA1_HMAC(k, klen, m, mlen, ob, plen)                                                                                                    \
     CHK(0 == mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA1), (k), (klen), (m), (mlen), (ob)), STATUS_HMAC_GENERATION_ERROR);             \
     *(plen) = mbedtls_md_get_size(mbedtls_md_info_from_type(MBEDTLS_MD_SHA1));
@@ -58,6 +86,9 @@ typedef enum {
 typedef enum {
     KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80 = MBEDTLS_TLS_SRTP_AES128_CM_HMAC_SHA1_80,
     KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32 = MBEDTLS_TLS_SRTP_AES128_CM_HMAC_SHA1_32,
+    // mbedtls use_srtp only knows the AES_CM profiles, these are never negotiated
+    KVS_SRTP_PROFILE_AEAD_AES_128_GCM = KVS_SRTP_AEAD_AES_128_GCM,
+    KVS_SRTP_PROFILE_AEAD_AES_256_GCM = KVS_SRTP_AEAD_AES_256_GCM,
 } KVS_SRTP_PROFILE;
 #else
 #error "A Crypto implementation is required."
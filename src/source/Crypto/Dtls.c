@@ -103,3 +103,58 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS dtlsGetSrtpKeyLengths(KVS_SRTP_PROFILE profile, PUINT32 pKeyLen, PUINT32 pSaltLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pKeyLen != NULL && pSaltLen != NULL, STATUS_NULL_ARG);
+
+    switch (profile) {
+        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32:
+        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80:
+            *pKeyLen = SRTP_AES_128_KEY_LEN;
+            *pSaltLen = SRTP_AES_CM_SALT_KEY_LEN;
+            break;
+        case KVS_SRTP_PROFILE_AEAD_AES_128_GCM:
+            *pKeyLen = SRTP_AES_128_KEY_LEN;
+            *pSaltLen = SRTP_AES_GCM_SALT_KEY_LEN;
+            break;
+        case KVS_SRTP_PROFILE_AEAD_AES_256_GCM:
+            *pKeyLen = SRTP_AES_256_KEY_LEN;
+            *pSaltLen = SRTP_AES_GCM_SALT_KEY_LEN;
+            break;
+        default:
+            CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS dtlsSplitKeyingMaterial(PBYTE pKeyingMaterial, UINT32 keyLen, UINT32 saltLen, PDtlsKeyingMaterial pDtlsKeyingMaterial)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 offset = 0;
+
+    CHK(pKeyingMaterial != NULL && pDtlsKeyingMaterial != NULL, STATUS_NULL_ARG);
+    CHK(keyLen <= MAX_SRTP_MASTER_KEY_LEN && saltLen <= MAX_SRTP_SALT_KEY_LEN, STATUS_INVALID_ARG);
+
+    pDtlsKeyingMaterial->key_length = (UINT8) (keyLen + saltLen);
+
+    MEMCPY(pDtlsKeyingMaterial->clientWriteKey, &pKeyingMaterial[offset], keyLen);
+    offset += keyLen;
+
+    MEMCPY(pDtlsKeyingMaterial->serverWriteKey, &pKeyingMaterial[offset], keyLen);
+    offset += keyLen;
+
+    MEMCPY(pDtlsKeyingMaterial->clientWriteKey + keyLen, &pKeyingMaterial[offset], saltLen);
+    offset += saltLen;
+
+    MEMCPY(pDtlsKeyingMaterial->serverWriteKey + keyLen, &pKeyingMaterial[offset], saltLen);
+
+CleanUp:
+
+    return retStatus;
+}
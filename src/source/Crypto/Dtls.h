@@ -13,8 +13,12 @@
 extern "C" {
 #endif
 
-#define MAX_SRTP_MASTER_KEY_LEN   16
+#define MAX_SRTP_MASTER_KEY_LEN   32
 #define MAX_SRTP_SALT_KEY_LEN     14
+#define SRTP_AES_128_KEY_LEN      16
+#define SRTP_AES_256_KEY_LEN      32
+#define SRTP_AES_CM_SALT_KEY_LEN  14
+#define SRTP_AES_GCM_SALT_KEY_LEN 12
 #define MAX_DTLS_RANDOM_BYTES_LEN 32
 #define MAX_DTLS_MASTER_KEY_LEN   48
 
@@ -66,7 +70,8 @@ typedef struct {
 } DtlsSessionCallbacks, *PDtlsSessionCallbacks;
 
 // DtlsKeyingMaterial is information extracted via https://tools.ietf.org/html/rfc5705
-// also includes the use_srtp value from Handshake
+// also includes the use_srtp value from Handshake. Each write key is the master key followed by the master salt,
+// key_length bytes in total
 typedef struct {
     BYTE clientWriteKey[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
     BYTE serverWriteKey[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
@@ -127,8 +132,11 @@ struct __DtlsSession {
     BYTE outgoingDataBuffer[MAX_UDP_PACKET_SIZE];
     UINT32 outgoingDataLen;
     CHAR certFingerprints[MAX_RTCCONFIGURATION_CERTIFICATES][CERTIFICATE_FINGERPRINT_LENGTH + 1];
+    // Shared with the other sessions given the same pooled certificate
     SSL_CTX* pSslCtx;
     SSL* pSsl;
+    // Certificate from the pool, NULL when the session has its own
+    PPooledCertificate pPooledCertificate;
 #elif KVS_USE_MBEDTLS
     DtlsSessionTimer transmissionTimer;
     TlsKeys tlsKeys;
@@ -189,6 +197,26 @@ STATUS dtlsSessionChangeState(PDtlsSession, RTC_DTLS_TRANSPORT_STATE);
 
 STATUS dtlsFillPseudoRandomBits(PBYTE, UINT32);
 
+/**
+ * Master key and salt lengths of a SRTP protection profile
+ * @param KVS_SRTP_PROFILE - negotiated profile
+ * @param PUINT32 - OUT - master key length
+ * @param PUINT32 - OUT - master salt length
+ * @return STATUS - STATUS_SSL_UNKNOWN_SRTP_PROFILE for the profiles not supported
+ */
+STATUS dtlsGetSrtpKeyLengths(KVS_SRTP_PROFILE, PUINT32, PUINT32);
+
+/**
+ * Split the exported keying material, client key, server key, client salt then server salt as in
+ * https://tools.ietf.org/html/rfc5764#section-4.2, into the write keys of DtlsKeyingMaterial
+ * @param PBYTE - exported keying material, 2 * (key length + salt length) bytes
+ * @param UINT32 - master key length
+ * @param UINT32 - master salt length
+ * @param PDtlsKeyingMaterial - OUT - keying material whose write keys and key_length are set
+ * @return STATUS - status of operation
+ */
+STATUS dtlsSplitKeyingMaterial(PBYTE, UINT32, UINT32, PDtlsKeyingMaterial);
+
 #ifdef KVS_USE_OPENSSL
 STATUS dtlsCheckOutgoingDataBuffer(PDtlsSession);
 STATUS dtlsCertificateFingerprint(X509*, PCHAR);
@@ -1,7 +1,8 @@
 #define LOG_CLASS "DTLS_mbedtls"
 #include "../Include_i.h"
 
-/**  https://tools.ietf.org/html/rfc5764#section-4.1.2 */
+/**  https://tools.ietf.org/html/rfc5764#section-4.1.2
+ * The AEAD_AES_*_GCM profiles are not offered, mbedtls rejects the profile values it does not know */
 mbedtls_ssl_srtp_profile DTLS_SRTP_SUPPORTED_PROFILES[] = {
     MBEDTLS_TLS_SRTP_AES128_CM_HMAC_SHA1_80,
     MBEDTLS_TLS_SRTP_AES128_CM_HMAC_SHA1_32,
@@ -15,6 +16,7 @@ STATUS createDtlsSession(PDtlsSessionCallbacks pDtlsSessionCallbacks, TIMER_QUEU
     STATUS retStatus = STATUS_SUCCESS;
     PDtlsSession pDtlsSession = NULL;
     PDtlsSessionCertificateInfo pCertInfo;
+    PPooledCertificate pPooledCertificate = NULL;
     UINT32 i, certCount;
 
     CHK(ppDtlsSession != NULL && pDtlsSessionCallbacks != NULL, STATUS_NULL_ARG);
@@ -40,7 +42,12 @@ STATUS createDtlsSession(PDtlsSessionCallbacks pDtlsSessionCallbacks, TIMER_QUEU
         certificateBits = GENERATED_CERTIFICATE_BITS;
     }
 
-    if (certCount == 0) {
+    // The pool only holds the default ECDSA certificates. The configuration is per session, so the pooled certificate is copied
+    if (certCount == 0 && !generateRSACertificate && STATUS_SUCCEEDED(certificatePoolAcquire(&pPooledCertificate))) {
+        CHK_STATUS(copyCertificateAndKey(&pPooledCertificate->cert, &pPooledCertificate->privateKey, &pDtlsSession->certificates[0],
+                                         &pDtlsSession->ctrDrbg));
+        pDtlsSession->certificateCount = 1;
+    } else if (certCount == 0) {
         CHK_STATUS(createCertificateAndKey(certificateBits, generateRSACertificate, &pDtlsSession->certificates[0].cert,
                                            &pDtlsSession->certificates[0].privateKey));
         pDtlsSession->certificateCount = 1;
@@ -65,6 +72,7 @@ CleanUp:
 
     CHK_LOG_ERR(retStatus);
 
+    certificatePoolRelease(&pPooledCertificate);
     if (STATUS_FAILED(retStatus) && pDtlsSession != NULL) {
         freeDtlsSession(&pDtlsSession);
     }
@@ -87,7 +95,7 @@ STATUS freeDtlsSession(PDtlsSession* ppDtlsSession)
     CHK(pDtlsSession != NULL, retStatus);
 
     if (pDtlsSession->timerId != MAX_UINT32) {
-        timerQueueCancelTimer(pDtlsSession->timerQueueHandle, pDtlsSession->timerId, (UINT64) pDtlsSession);
+        sharedTimerQueueCancelTimer(pDtlsSession->timerQueueHandle, pDtlsSession->timerId, (UINT64) pDtlsSession);
     }
 
     for (i = 0; i < pDtlsSession->certificateCount; i++) {
@@ -336,8 +344,8 @@ STATUS dtlsSessionStart(PDtlsSession pDtlsSession, BOOL isServer)
 
     // Start non-blocking handshaking
     pDtlsSession->dtlsSessionStartTime = GETTIME();
-    CHK_STATUS(timerQueueAddTimer(pDtlsSession->timerQueueHandle, DTLS_SESSION_TIMER_START_DELAY, DTLS_TRANSMISSION_INTERVAL,
-                                  dtlsTransmissionTimerCallback, (UINT64) pDtlsSession, &pDtlsSession->timerId));
+    CHK_STATUS(sharedTimerQueueAddTimer(pDtlsSession->timerQueueHandle, DTLS_SESSION_TIMER_START_DELAY, DTLS_TRANSMISSION_INTERVAL,
+                                        dtlsTransmissionTimerCallback, (UINT64) pDtlsSession, &pDtlsSession->timerId));
 
 CleanUp:
     if (locked) {
@@ -519,7 +527,7 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 offset = 0;
+    UINT32 keyLen, saltLen;
     BOOL locked = FALSE;
     PTlsKeys pKeys;
     BYTE keyingMaterialBuffer[MAX_SRTP_MASTER_KEY_LEN * 2 + MAX_SRTP_SALT_KEY_LEN * 2];
@@ -531,23 +539,6 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
     MUTEX_LOCK(pDtlsSession->sslLock);
     locked = TRUE;
 
-    CHK(mbedtls_ssl_tls_prf(pKeys->tlsProfile, pKeys->masterSecret, ARRAY_SIZE(pKeys->masterSecret), KEYING_EXTRACTOR_LABEL, pKeys->randBytes,
-                            ARRAY_SIZE(pKeys->randBytes), keyingMaterialBuffer, ARRAY_SIZE(keyingMaterialBuffer)) == 0,
-        STATUS_INTERNAL_ERROR);
-
-    pDtlsKeyingMaterial->key_length = MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->clientWriteKey, &keyingMaterialBuffer[offset], MAX_SRTP_MASTER_KEY_LEN);
-    offset += MAX_SRTP_MASTER_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->serverWriteKey, &keyingMaterialBuffer[offset], MAX_SRTP_MASTER_KEY_LEN);
-    offset += MAX_SRTP_MASTER_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->clientWriteKey + MAX_SRTP_MASTER_KEY_LEN, &keyingMaterialBuffer[offset], MAX_SRTP_SALT_KEY_LEN);
-    offset += MAX_SRTP_SALT_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->serverWriteKey + MAX_SRTP_MASTER_KEY_LEN, &keyingMaterialBuffer[offset], MAX_SRTP_SALT_KEY_LEN);
-
     mbedtls_ssl_get_dtls_srtp_negotiation_result(&pDtlsSession->sslCtx, &negotiatedSRTPProfile);
 #if MBEDTLS_BEFORE_V3
     switch (negotiatedSRTPProfile.chosen_dtls_srtp_profile) {
@@ -563,6 +554,13 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
         default:
             CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
     }
+    CHK_STATUS(dtlsGetSrtpKeyLengths(pDtlsKeyingMaterial->srtpProfile, &keyLen, &saltLen));
+
+    CHK(mbedtls_ssl_tls_prf(pKeys->tlsProfile, pKeys->masterSecret, ARRAY_SIZE(pKeys->masterSecret), KEYING_EXTRACTOR_LABEL, pKeys->randBytes,
+                            ARRAY_SIZE(pKeys->randBytes), keyingMaterialBuffer, 2 * (keyLen + saltLen)) == 0,
+        STATUS_INTERNAL_ERROR);
+
+    CHK_STATUS(dtlsSplitKeyingMaterial(keyingMaterialBuffer, keyLen, saltLen, pDtlsKeyingMaterial));
 
 CleanUp:
 
@@ -1,6 +1,15 @@
 #define LOG_CLASS "DTLS_openssl"
 #include "../Include_i.h"
 
+// In order of preference, the server picks the first one the client offers. The AEAD profiles come first as AES-GCM
+// encrypts and authenticates in one pass, much cheaper than AES-CTR plus HMAC-SHA1 on CPUs with AES and carry-less
+// multiply instructions. OpenSSL names them from 1.1.0 on, and they are only offered if libsrtp can run them
+#if (OPENSSL_VERSION_NUMBER >= 0x10100000L) && defined(HAVE_SRTP_AES_GCM)
+#define DTLS_SRTP_SUPPORTED_PROFILES "SRTP_AEAD_AES_128_GCM:SRTP_AEAD_AES_256_GCM:SRTP_AES128_CM_SHA1_32:SRTP_AES128_CM_SHA1_80"
+#else
+#define DTLS_SRTP_SUPPORTED_PROFILES "SRTP_AES128_CM_SHA1_32:SRTP_AES128_CM_SHA1_80"
+#endif
+
 // Allow all certificates since they are checked via fingerprint in SDP later
 // https://www.openssl.org/docs/man1.0.2/man3/SSL_CTX_set_verify.html
 INT32 dtlsCertificateVerifyCallback(INT32 preverify_ok, X509_STORE_CTX* ctx)
@@ -202,7 +211,7 @@ STATUS createSslCtx(PDtlsSessionCertificateInfo pCertificates, UINT32 certCount,
 #endif
 
     SSL_CTX_set_verify(pSslCtx, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, dtlsCertificateVerifyCallback);
-    CHK(SSL_CTX_set_tlsext_use_srtp(pSslCtx, "SRTP_AES128_CM_SHA1_32:SRTP_AES128_CM_SHA1_80") == 0, STATUS_SSL_CTX_CREATION_FAILED);
+    CHK(SSL_CTX_set_tlsext_use_srtp(pSslCtx, DTLS_SRTP_SUPPORTED_PROFILES) == 0, STATUS_SSL_CTX_CREATION_FAILED);
 
     for (i = 0; i < certCount; i++) {
         CHK(SSL_CTX_use_certificate(pSslCtx, pCertificates[i].pCert) == 1, STATUS_SSL_CTX_CREATION_FAILED);
@@ -210,6 +219,9 @@ STATUS createSslCtx(PDtlsSessionCertificateInfo pCertificates, UINT32 certCount,
     }
 
     CHK(SSL_CTX_set_cipher_list(pSslCtx, "HIGH:!aNULL:!MD5:!RC4") == 1, STATUS_SSL_CTX_CREATION_FAILED);
+    // The context can be shared by many sessions through the certificate pool. A resumed session would skip the certificate
+    // exchange the fingerprint verification relies on
+    SSL_CTX_set_session_cache_mode(pSslCtx, SSL_SESS_CACHE_OFF);
     *ppSslCtx = pSslCtx;
 
 CleanUp:
@@ -319,7 +331,17 @@ STATUS createDtlsSession(PDtlsSessionCallbacks pDtlsSessionCallbacks, TIMER_QUEU
         certificateBits = GENERATED_CERTIFICATE_BITS;
     }
 
-    if (certCount == 0) {
+    // The pool only holds the default ECDSA certificates
+    if (certCount == 0 && !generateRSACertificate && STATUS_SUCCEEDED(certificatePoolAcquire(&pDtlsSession->pPooledCertificate))) {
+        pDtlsSession->certificateCount = 1;
+        STRCPY(pDtlsSession->certFingerprints[0], pDtlsSession->pPooledCertificate->fingerprint);
+#if (OPENSSL_VERSION_NUMBER >= 0x10100000L)
+        CHK(SSL_CTX_up_ref(pDtlsSession->pPooledCertificate->pSslCtx) == 1, STATUS_SSL_CTX_CREATION_FAILED);
+#else
+        CRYPTO_add(&pDtlsSession->pPooledCertificate->pSslCtx->references, 1, CRYPTO_LOCK_SSL_CTX);
+#endif
+        pDtlsSession->pSslCtx = pDtlsSession->pPooledCertificate->pSslCtx;
+    } else if (certCount == 0) {
         PROFILE_CALL(CHK_STATUS(createCertificateAndKey(certificateBits, generateRSACertificate, &certInfos[0].pCert, &certInfos[0].pKey)),
                      "Certificate creation time");
         certInfos[0].created = TRUE;
@@ -333,12 +355,13 @@ STATUS createDtlsSession(PDtlsSessionCallbacks pDtlsSessionCallbacks, TIMER_QUEU
         }
     }
 
-    PROFILE_CALL(CHK_STATUS(createSslCtx(certInfos, pDtlsSession->certificateCount, &pDtlsSession->pSslCtx)), "Create SSL Context");
+    if (pDtlsSession->pPooledCertificate == NULL) {
+        PROFILE_CALL(CHK_STATUS(createSslCtx(certInfos, pDtlsSession->certificateCount, &pDtlsSession->pSslCtx)), "Create SSL Context");
+        // Generate and store the certificate fingerprints
+        CHK_STATUS(dtlsGenerateCertificateFingerprints(pDtlsSession, certInfos));
+    }
     PROFILE_CALL(CHK_STATUS(createSsl(pDtlsSession->pSslCtx, &pDtlsSession->pSsl)), "Create SSL session");
 
-    // Generate and store the certificate fingerprints
-    CHK_STATUS(dtlsGenerateCertificateFingerprints(pDtlsSession, certInfos));
-
     *ppDtlsSession = pDtlsSession;
 
 CleanUp:
@@ -429,8 +452,8 @@ STATUS dtlsSessionStart(PDtlsSession pDtlsSession, BOOL isServer)
 
     CHK_STATUS(beginHandshakeProcess(pDtlsSession, isServer, &sslRet));
     pDtlsSession->dtlsSessionStartTime = GETTIME();
-    CHK_STATUS(timerQueueAddTimer(pDtlsSession->timerQueueHandle, DTLS_SESSION_TIMER_START_DELAY, DTLS_TRANSMISSION_INTERVAL,
-                                  dtlsTransmissionTimerCallback, (UINT64) pDtlsSession, &pDtlsSession->timerId));
+    CHK_STATUS(sharedTimerQueueAddTimer(pDtlsSession->timerQueueHandle, DTLS_SESSION_TIMER_START_DELAY, DTLS_TRANSMISSION_INTERVAL,
+                                        dtlsTransmissionTimerCallback, (UINT64) pDtlsSession, &pDtlsSession->timerId));
 CleanUp:
     CHK_LOG_ERR(retStatus);
     if (locked) {
@@ -588,7 +611,7 @@ STATUS freeDtlsSession(PDtlsSession* ppDtlsSession)
         THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
     }
     if (pDtlsSession->timerId != MAX_UINT32) {
-        timerQueueCancelTimer(pDtlsSession->timerQueueHandle, pDtlsSession->timerId, (UINT64) pDtlsSession);
+        sharedTimerQueueCancelTimer(pDtlsSession->timerQueueHandle, pDtlsSession->timerId, (UINT64) pDtlsSession);
     }
 
     // Lock SSL free as an additional protection to ensure SSL contexts are not being used in the callbacks
@@ -601,6 +624,7 @@ STATUS freeDtlsSession(PDtlsSession* ppDtlsSession)
     if (pDtlsSession->pSslCtx != NULL) {
         SSL_CTX_free(pDtlsSession->pSslCtx);
     }
+    certificatePoolRelease(&pDtlsSession->pPooledCertificate);
     if (IS_VALID_MUTEX_VALUE(pDtlsSession->sslLock)) {
         CVAR_BROADCAST(pDtlsSession->receivePacketCvar);
         MUTEX_UNLOCK(pDtlsSession->sslLock);
@@ -814,8 +838,9 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 offset = 0;
+    UINT32 keyLen, saltLen;
     BYTE keyingMaterialBuffer[MAX_SRTP_MASTER_KEY_LEN * 2 + MAX_SRTP_SALT_KEY_LEN * 2];
+    SRTP_PROTECTION_PROFILE* pSrtpProfile;
     BOOL locked = FALSE;
 
     acquireDtlsSession(pDtlsSession);
@@ -824,31 +849,15 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
     MUTEX_LOCK(pDtlsSession->sslLock);
     locked = TRUE;
 
-    CHK(SSL_export_keying_material(pDtlsSession->pSsl, keyingMaterialBuffer, SIZEOF(keyingMaterialBuffer), KEYING_EXTRACTOR_LABEL,
+    CHK((pSrtpProfile = SSL_get_selected_srtp_profile(pDtlsSession->pSsl)) != NULL, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
+    pDtlsKeyingMaterial->srtpProfile = (KVS_SRTP_PROFILE) pSrtpProfile->id;
+    CHK_STATUS(dtlsGetSrtpKeyLengths(pDtlsKeyingMaterial->srtpProfile, &keyLen, &saltLen));
+
+    CHK(SSL_export_keying_material(pDtlsSession->pSsl, keyingMaterialBuffer, 2 * (keyLen + saltLen), KEYING_EXTRACTOR_LABEL,
                                    ARRAY_SIZE(KEYING_EXTRACTOR_LABEL) - 1, NULL, 0, 0),
         STATUS_INTERNAL_ERROR);
 
-    pDtlsKeyingMaterial->key_length = MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->clientWriteKey, &keyingMaterialBuffer[offset], MAX_SRTP_MASTER_KEY_LEN);
-    offset += MAX_SRTP_MASTER_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->serverWriteKey, &keyingMaterialBuffer[offset], MAX_SRTP_MASTER_KEY_LEN);
-    offset += MAX_SRTP_MASTER_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->clientWriteKey + MAX_SRTP_MASTER_KEY_LEN, &keyingMaterialBuffer[offset], MAX_SRTP_SALT_KEY_LEN);
-    offset += MAX_SRTP_SALT_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->serverWriteKey + MAX_SRTP_MASTER_KEY_LEN, &keyingMaterialBuffer[offset], MAX_SRTP_SALT_KEY_LEN);
-
-    switch (SSL_get_selected_srtp_profile(pDtlsSession->pSsl)->id) {
-        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32:
-        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80:
-            pDtlsKeyingMaterial->srtpProfile = SSL_get_selected_srtp_profile(pDtlsSession->pSsl)->id;
-            break;
-        default:
-            CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
-    }
+    CHK_STATUS(dtlsSplitKeyingMaterial(keyingMaterialBuffer, keyLen, saltLen, pDtlsKeyingMaterial));
 
 CleanUp:
     if (locked) {
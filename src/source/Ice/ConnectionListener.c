@@ -2,37 +2,133 @@
  * Kinesis Video Producer ConnectionListener
  */
 #define LOG_CLASS "ConnectionListener"
+// recvmmsg is a GNU extension and needs to be requested before any system header is pulled in
+#if defined(HAVE_RECVMMSG) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
 #include "../Include_i.h"
 
 STATUS createConnectionListener(PConnectionListener* ppConnectionListener)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 allocationSize = SIZEOF(ConnectionListener) + MAX_UDP_PACKET_SIZE;
+    UINT32 bufferSize = MAX_UDP_PACKET_SIZE;
+#if defined(HAVE_RECVMMSG)
+    bufferSize += CONNECTION_LISTENER_RECV_BATCH_SIZE * CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE;
+#endif
+    PConnectionListener pConnectionListener = NULL;
+#if defined(HAVE_EPOLL) && defined(HAVE_SOCKETPAIR)
+    struct epoll_event event;
+#endif
+
+    CHK(ppConnectionListener != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(connectionListenerAllocate(bufferSize, &pConnectionListener));
+
+    // pConnectionListener->pBuffer starts at the end of ConnectionListener struct
+    pConnectionListener->pBuffer = (PBYTE) (pConnectionListener + 1);
+    pConnectionListener->bufferLen = MAX_UDP_PACKET_SIZE;
+#if defined(HAVE_RECVMMSG)
+    // recvmmsg slots follow the single datagram buffer
+    pConnectionListener->pBatchBuffer = pConnectionListener->pBuffer + pConnectionListener->bufferLen;
+#endif
+
+#if defined(HAVE_SOCKETPAIR)
+    CHK_STATUS(createSocketPair(&(pConnectionListener->kickSocket)));
+#endif
+
+#if defined(HAVE_EPOLL)
+    pConnectionListener->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (pConnectionListener->epollFd == -1) {
+        DLOGE("epoll_create1() failed with errno %s", getErrorString(getErrorCode()));
+        CHK(FALSE, STATUS_CREATE_EPOLL_FAILED);
+    }
+
+#if defined(HAVE_SOCKETPAIR)
+    // The kick socket is the only registration with a NULL data pointer
+    MEMSET(&event, 0x00, SIZEOF(event));
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    if (epoll_ctl(pConnectionListener->epollFd, EPOLL_CTL_ADD, pConnectionListener->kickSocket[CONNECTION_LISTENER_KICK_SOCKET_LISTEN], &event) ==
+        -1) {
+        DLOGE("epoll_ctl() failed to add the kick socket with errno %s", getErrorString(getErrorCode()));
+        CHK(FALSE, STATUS_EPOLL_CTL_FAILED);
+    }
+#endif
+#endif
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && pConnectionListener != NULL) {
+        freeConnectionListener(&pConnectionListener);
+        pConnectionListener = NULL;
+    }
+
+    if (ppConnectionListener != NULL) {
+        *ppConnectionListener = pConnectionListener;
+    }
+
+    return retStatus;
+}
+
+STATUS createSharedConnectionListener(PConnectionListener* ppConnectionListener)
+{
+    STATUS retStatus = STATUS_SUCCESS;
     PConnectionListener pConnectionListener = NULL;
 
     CHK(ppConnectionListener != NULL, STATUS_NULL_ARG);
 
-    pConnectionListener = (PConnectionListener) MEMCALLOC(1, allocationSize);
+    // No receive buffer, the reactor reads the sockets
+    CHK_STATUS(connectionListenerAllocate(0, &pConnectionListener));
+    CHK_STATUS(networkReactorPoolAcquire(&pConnectionListener->pReactor));
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && pConnectionListener != NULL) {
+        freeConnectionListener(&pConnectionListener);
+        pConnectionListener = NULL;
+    }
+
+    if (ppConnectionListener != NULL) {
+        *ppConnectionListener = pConnectionListener;
+    }
+
+    return retStatus;
+}
+
+STATUS connectionListenerAllocate(UINT32 bufferSize, PConnectionListener* ppConnectionListener)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PConnectionListener pConnectionListener = NULL;
+
+    CHK(ppConnectionListener != NULL, STATUS_NULL_ARG);
+
+    // The receive buffers, if any, follow the struct in the same allocation
+    pConnectionListener = (PConnectionListener) MEMCALLOC(1, SIZEOF(ConnectionListener) + bufferSize);
     CHK(pConnectionListener != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
     ATOMIC_STORE_BOOL(&pConnectionListener->terminate, FALSE);
     pConnectionListener->receiveDataRoutine = INVALID_TID_VALUE;
     pConnectionListener->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pConnectionListener->lock), STATUS_INVALID_OPERATION);
 
-    // No sockets are present
-    pConnectionListener->socketCount = 0;
-
-    // pConnectionListener->pBuffer starts at the end of ConnectionListener struct
-    pConnectionListener->pBuffer = (PBYTE) (pConnectionListener + 1);
-    pConnectionListener->bufferLen = MAX_UDP_PACKET_SIZE;
+#if defined(HAVE_EPOLL)
+    pConnectionListener->epollFd = -1;
+#endif
 
     // Use socketpair only if available
 #if defined(HAVE_SOCKETPAIR)
     pConnectionListener->kickSocket[CONNECTION_LISTENER_KICK_SOCKET_LISTEN] = -1;
     pConnectionListener->kickSocket[CONNECTION_LISTENER_KICK_SOCKET_WRITE] = -1;
-    CHK_STATUS(createSocketPair(&(pConnectionListener->kickSocket)));
 #endif
 
+    // No sockets are present
+    pConnectionListener->socketCount = 0;
+    pConnectionListener->socketCapacity = CONNECTION_LISTENER_DEFAULT_SOCKET_CAPACITY;
+    pConnectionListener->sockets = (PSocketConnection*) MEMCALLOC(pConnectionListener->socketCapacity, SIZEOF(PSocketConnection));
+    CHK(pConnectionListener->sockets != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    CHK_STATUS(hashTableCreateWithParams(CONNECTION_LISTENER_SOCKET_INDEX_BUCKET_COUNT, CONNECTION_LISTENER_SOCKET_INDEX_BUCKET_LENGTH,
+                                         &pConnectionListener->pSocketIndex));
+
 CleanUp:
 
     if (STATUS_FAILED(retStatus) && pConnectionListener != NULL) {
@@ -52,6 +148,7 @@ STATUS freeConnectionListener(PConnectionListener* ppConnectionListener)
     STATUS retStatus = STATUS_SUCCESS;
     PConnectionListener pConnectionListener = NULL;
     TID threadId;
+    UINT32 i;
     const char* msg = "1";
 
     CHK(ppConnectionListener != NULL, STATUS_NULL_ARG);
@@ -61,6 +158,23 @@ STATUS freeConnectionListener(PConnectionListener* ppConnectionListener)
 
     ATOMIC_STORE_BOOL(&pConnectionListener->terminate, TRUE);
 
+    // The owners remove their sockets before freeing them. Whatever is still registered might be gone already, so the shared
+    // reactor only forgets about it without dereferencing it. A freed socket has closed its fd which drops it from epoll.
+    if (pConnectionListener->pReactor != NULL) {
+        if (IS_VALID_MUTEX_VALUE(pConnectionListener->lock)) {
+            MUTEX_LOCK(pConnectionListener->lock);
+            MUTEX_LOCK(pConnectionListener->pReactor->lock);
+            for (i = 0; i < pConnectionListener->socketCount; i++) {
+                CHK_LOG_ERR(connectionListenerUnregisterLocked(pConnectionListener->pReactor, pConnectionListener->sockets[i]));
+            }
+            MUTEX_UNLOCK(pConnectionListener->pReactor->lock);
+            MUTEX_UNLOCK(pConnectionListener->lock);
+        }
+
+        CHK_LOG_ERR(networkReactorPoolRelease(pConnectionListener->pReactor));
+        pConnectionListener->pReactor = NULL;
+    }
+
     if (IS_VALID_MUTEX_VALUE(pConnectionListener->lock)) {
         MUTEX_LOCK(pConnectionListener->lock);
         threadId = pConnectionListener->receiveDataRoutine;
@@ -70,7 +184,9 @@ STATUS freeConnectionListener(PConnectionListener* ppConnectionListener)
         // This writes to the socketpair, kicking the POLL() out early,
         // otherwise wait for the POLL to timeout
 #if defined(HAVE_SOCKETPAIR)
-        socketWrite(pConnectionListener->kickSocket[CONNECTION_LISTENER_KICK_SOCKET_WRITE], msg, STRLEN(msg));
+        if (pConnectionListener->kickSocket[CONNECTION_LISTENER_KICK_SOCKET_WRITE] != -1) {
+            socketWrite(pConnectionListener->kickSocket[CONNECTION_LISTENER_KICK_SOCKET_WRITE], msg, STRLEN(msg));
+        }
 #endif
 
         // wait for thread to finish.
@@ -81,6 +197,16 @@ STATUS freeConnectionListener(PConnectionListener* ppConnectionListener)
         MUTEX_FREE(pConnectionListener->lock);
     }
 
+    if (pConnectionListener->socketCount > 0) {
+        DLOGW("Freeing connection listener with %u socket(s) that were not removed", (UINT32) pConnectionListener->socketCount);
+    }
+
+#if defined(HAVE_EPOLL)
+    if (pConnectionListener->epollFd != -1) {
+        close(pConnectionListener->epollFd);
+    }
+#endif
+
     // TODO add support for windows socketpair
 #if defined(HAVE_SOCKETPAIR)
     if (pConnectionListener->kickSocket[CONNECTION_LISTENER_KICK_SOCKET_LISTEN] != -1) {
@@ -91,6 +217,11 @@ STATUS freeConnectionListener(PConnectionListener* ppConnectionListener)
     }
 #endif
 
+    if (pConnectionListener->pSocketIndex != NULL) {
+        hashTableFree(pConnectionListener->pSocketIndex);
+    }
+
+    SAFE_MEMFREE(pConnectionListener->sockets);
     MEMFREE(pConnectionListener);
 
     *ppConnectionListener = NULL;
@@ -105,8 +236,13 @@ CleanUp:
 STATUS connectionListenerAddConnection(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    BOOL locked = FALSE, iterate = TRUE;
-    UINT32 i;
+    BOOL locked = FALSE, indexed = FALSE, present = FALSE;
+    UINT32 newCapacity;
+    PSocketConnection* pNewSockets = NULL;
+#if defined(HAVE_EPOLL)
+    struct epoll_event event;
+    INT32 localSocket;
+#endif
 
     CHK(pConnectionListener != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
     CHK(!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate), retStatus);
@@ -114,23 +250,56 @@ STATUS connectionListenerAddConnection(PConnectionListener pConnectionListener,
     MUTEX_LOCK(pConnectionListener->lock);
     locked = TRUE;
 
-    // Check for space
-    CHK(pConnectionListener->socketCount < CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION, STATUS_NOT_ENOUGH_MEMORY);
+    // Adding the same connection twice is a no-op
+    CHK_STATUS(hashTableContains(pConnectionListener->pSocketIndex, (UINT64) pSocketConnection, &present));
+    CHK(!present, retStatus);
+
+    // Grow the registry when it runs out of slots
+    if (pConnectionListener->socketCount == pConnectionListener->socketCapacity) {
+        newCapacity = pConnectionListener->socketCapacity * 2;
+        pNewSockets = (PSocketConnection*) MEMREALLOC(pConnectionListener->sockets, newCapacity * SIZEOF(PSocketConnection));
+        CHK(pNewSockets != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pConnectionListener->sockets = pNewSockets;
+        pConnectionListener->socketCapacity = newCapacity;
+    }
 
-    // Find an empty slot by checking whether connected
-    for (i = 0; iterate && i < CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION; i++) {
-        if (pConnectionListener->sockets[i] == NULL) {
-            pConnectionListener->sockets[i] = pSocketConnection;
-            pConnectionListener->socketCount++;
-            iterate = FALSE;
+    CHK_STATUS(hashTablePut(pConnectionListener->pSocketIndex, (UINT64) pSocketConnection, pConnectionListener->socketCount));
+    indexed = TRUE;
+
+    if (pConnectionListener->pReactor != NULL) {
+        // The shared reactor owns the receive thread, this listener only keeps track of what it registered
+        CHK_STATUS(connectionListenerAddConnection(pConnectionListener->pReactor, pSocketConnection));
+    }
+
+#if defined(HAVE_EPOLL)
+    if (pConnectionListener->pReactor == NULL) {
+        MUTEX_LOCK(pSocketConnection->lock);
+        localSocket = pSocketConnection->localSocket;
+        MUTEX_UNLOCK(pSocketConnection->lock);
+
+        // Edge triggered: the listener thread always drains the socket until EWOULDBLOCK
+        MEMSET(&event, 0x00, SIZEOF(event));
+        event.events = EPOLLIN | EPOLLET;
+        event.data.ptr = pSocketConnection;
+        if (epoll_ctl(pConnectionListener->epollFd, EPOLL_CTL_ADD, localSocket, &event) == -1) {
+            DLOGW("epoll_ctl() failed to add socket %d with errno %s", localSocket, getErrorString(getErrorCode()));
+            CHK(FALSE, STATUS_EPOLL_CTL_FAILED);
         }
+
+        // This thread drains whatever a full send buffer makes the socket queue
+        CHK_STATUS(socketConnectionEnableEgressQueue(pSocketConnection, pConnectionListener->epollFd));
     }
+#endif
 
-    MUTEX_UNLOCK(pConnectionListener->lock);
-    locked = FALSE;
+    pConnectionListener->sockets[pConnectionListener->socketCount] = pSocketConnection;
+    pConnectionListener->socketCount++;
 
 CleanUp:
 
+    if (STATUS_FAILED(retStatus) && indexed) {
+        hashTableRemove(pConnectionListener->pSocketIndex, (UINT64) pSocketConnection);
+    }
+
     if (locked) {
         MUTEX_UNLOCK(pConnectionListener->lock);
     }
@@ -138,15 +307,88 @@ CleanUp:
     return retStatus;
 }
 
+STATUS connectionListenerRemoveConnectionLocked(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL present = FALSE;
+    STATUS reactorStatus;
+#if defined(HAVE_EPOLL)
+    struct epoll_event event;
+#endif
+
+    CHK(pConnectionListener != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(hashTableContains(pConnectionListener->pSocketIndex, (UINT64) pSocketConnection, &present));
+    CHK(present, retStatus);
+
+    if (pConnectionListener->pReactor != NULL) {
+        MUTEX_LOCK(pConnectionListener->pReactor->lock);
+        reactorStatus = connectionListenerRemoveConnectionLocked(pConnectionListener->pReactor, pSocketConnection);
+        MUTEX_UNLOCK(pConnectionListener->pReactor->lock);
+        CHK_STATUS(reactorStatus);
+    }
+
+#if defined(HAVE_EPOLL)
+    // Nothing drains the egress queue past this point
+    if (pConnectionListener->pReactor == NULL) {
+        CHK_LOG_ERR(socketConnectionDisableEgressQueue(pSocketConnection));
+    }
+
+    // Kernels before 2.6.9 require a non-NULL event for EPOLL_CTL_DEL. The socket might already be
+    // closed in which case the kernel has dropped it from the interest list already.
+    MEMSET(&event, 0x00, SIZEOF(event));
+    if (pConnectionListener->pReactor == NULL &&
+        epoll_ctl(pConnectionListener->epollFd, EPOLL_CTL_DEL, pSocketConnection->localSocket, &event) == -1) {
+        DLOGD("epoll_ctl() failed to remove socket %d with errno %s", pSocketConnection->localSocket, getErrorString(getErrorCode()));
+    }
+#endif
+
+    CHK_STATUS(connectionListenerUnregisterLocked(pConnectionListener, pSocketConnection));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS connectionListenerUnregisterLocked(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 slot;
+    UINT32 lastSlot;
+    PSocketConnection pLastSocketConnection;
+    BOOL present = FALSE;
+
+    CHK(pConnectionListener != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(hashTableContains(pConnectionListener->pSocketIndex, (UINT64) pSocketConnection, &present));
+    CHK(present, retStatus);
+    CHK_STATUS(hashTableGet(pConnectionListener->pSocketIndex, (UINT64) pSocketConnection, &slot));
+
+    // Move the last socket into the vacated slot to keep the occupied slots contiguous
+    lastSlot = (UINT32) pConnectionListener->socketCount - 1;
+    if ((UINT32) slot != lastSlot) {
+        pLastSocketConnection = pConnectionListener->sockets[lastSlot];
+        pConnectionListener->sockets[slot] = pLastSocketConnection;
+        CHK_STATUS(hashTableUpsert(pConnectionListener->pSocketIndex, (UINT64) pLastSocketConnection, slot));
+    }
+
+    pConnectionListener->sockets[lastSlot] = NULL;
+    pConnectionListener->socketCount--;
+    CHK_STATUS(hashTableRemove(pConnectionListener->pSocketIndex, (UINT64) pSocketConnection));
+
+CleanUp:
+
+    return retStatus;
+}
+
 STATUS connectionListenerRemoveConnection(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    BOOL locked = FALSE, iterate = TRUE;
-    UINT32 i;
+    BOOL locked = FALSE;
 
     CHK(pConnectionListener != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
-    CHK(!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate), retStatus);
 
+    // Always done synchronously, the owner frees the socket next
     MUTEX_LOCK(pConnectionListener->lock);
     locked = TRUE;
 
@@ -154,15 +396,7 @@ STATUS connectionListenerRemoveConnection(PConnectionListener pConnectionListene
     CHK_STATUS(socketConnectionClosed(pSocketConnection));
 
     // Remove from the list of sockets
-    for (i = 0; iterate && i < CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION; i++) {
-        if (pConnectionListener->sockets[i] == pSocketConnection) {
-            iterate = FALSE;
-
-            // Mark the slot as empty and decrement the count
-            pConnectionListener->sockets[i] = NULL;
-            pConnectionListener->socketCount--;
-        }
-    }
+    CHK_STATUS(connectionListenerRemoveConnectionLocked(pConnectionListener, pSocketConnection));
 
 CleanUp:
 
@@ -177,20 +411,15 @@ STATUS connectionListenerRemoveAllConnection(PConnectionListener pConnectionList
 {
     STATUS retStatus = STATUS_SUCCESS;
     BOOL locked = FALSE;
-    UINT32 i;
 
     CHK(pConnectionListener != NULL, STATUS_NULL_ARG);
-    CHK(!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate), retStatus);
 
     MUTEX_LOCK(pConnectionListener->lock);
     locked = TRUE;
 
-    for (i = 0; i < CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION; i++) {
-        if (pConnectionListener->sockets[i] != NULL) {
-            CHK_STATUS(socketConnectionClosed(pConnectionListener->sockets[i]));
-            pConnectionListener->sockets[i] = NULL;
-            pConnectionListener->socketCount--;
-        }
+    while (pConnectionListener->socketCount > 0) {
+        CHK_STATUS(socketConnectionClosed(pConnectionListener->sockets[pConnectionListener->socketCount - 1]));
+        CHK_STATUS(connectionListenerRemoveConnectionLocked(pConnectionListener, pConnectionListener->sockets[pConnectionListener->socketCount - 1]));
     }
 
 CleanUp:
@@ -210,6 +439,9 @@ STATUS connectionListenerStart(PConnectionListener pConnectionListener)
     CHK(pConnectionListener != NULL, STATUS_NULL_ARG);
     CHK(!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate), retStatus);
 
+    // Shared listeners are serviced by a reactor thread that is already running
+    CHK(pConnectionListener->pReactor == NULL, retStatus);
+
     MUTEX_LOCK(pConnectionListener->lock);
     locked = TRUE;
 
@@ -225,47 +457,306 @@ CleanUp:
     return retStatus;
 }
 
-BOOL canReadFd(INT32 fd, struct pollfd* fds, INT32 nfds)
+/**
+ * Decrypt a received datagram/segment in place if needed and hand it to the socket's data available callback.
+ */
+STATUS connectionListenerDispatchData(PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen, UINT32 readLen,
+                                      struct sockaddr_storage* pSrcAddrBuff)
 {
-    INT32 i;
-    for (i = 0; i < nfds; i++) {
-        if (fds[i].fd == fd && (fds[i].revents & POLLIN) != 0) {
-            return TRUE;
+    STATUS retStatus = STATUS_SUCCESS;
+    struct sockaddr_in* pIpv4Addr;
+    struct sockaddr_in6* pIpv6Addr;
+    KvsIpAddress srcAddr;
+    PKvsIpAddress pSrcAddr = NULL;
+
+    CHK(pSocketConnection != NULL && pBuffer != NULL, STATUS_NULL_ARG);
+
+    // data could be encrypted so they need to be decrypted through socketConnectionReadData and get the decrypted data length.
+    CHK(ATOMIC_LOAD_BOOL(&pSocketConnection->receiveData) && pSocketConnection->dataAvailableCallbackFn != NULL &&
+            STATUS_SUCCEEDED(socketConnectionReadData(pSocketConnection, pBuffer, bufferLen, &readLen)),
+        retStatus);
+
+    if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP && pSrcAddrBuff != NULL) {
+        MEMSET(&srcAddr, 0x00, SIZEOF(KvsIpAddress));
+        srcAddr.isPointToPoint = FALSE;
+        if (pSrcAddrBuff->ss_family == AF_INET) {
+            srcAddr.family = KVS_IP_FAMILY_TYPE_IPV4;
+            pIpv4Addr = (struct sockaddr_in*) pSrcAddrBuff;
+            MEMCPY(srcAddr.address, (PBYTE) &pIpv4Addr->sin_addr, IPV4_ADDRESS_LENGTH);
+            srcAddr.port = pIpv4Addr->sin_port;
+        } else if (pSrcAddrBuff->ss_family == AF_INET6) {
+            srcAddr.family = KVS_IP_FAMILY_TYPE_IPV6;
+            pIpv6Addr = (struct sockaddr_in6*) pSrcAddrBuff;
+            MEMCPY(srcAddr.address, (PBYTE) &pIpv6Addr->sin6_addr, IPV6_ADDRESS_LENGTH);
+            srcAddr.port = pIpv6Addr->sin6_port;
         }
+        pSrcAddr = &srcAddr;
+    } else {
+        // srcAddr is ignored in TCP callback handlers
+        pSrcAddr = NULL;
+    }
+
+    // readLen may be 0 if SSL does not emit any application data.
+    // in that case, no need to call dataAvailable callback
+    if (readLen > 0) {
+        pSocketConnection->dataAvailableCallbackFn(pSocketConnection->dataAvailableCallbackCustomData, pSocketConnection, pBuffer, readLen,
+                                                   pSrcAddr,
+                                                   NULL); // no dest information available right now.
     }
-    return FALSE;
+
+CleanUp:
+
+    return retStatus;
 }
 
-PVOID connectionListenerReceiveDataRoutine(PVOID arg)
+/**
+ * Drain the socket one datagram/segment at a time with recvfrom until it would block.
+ */
+STATUS connectionListenerReadSocketSingle(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection, INT32 localSocket)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    PConnectionListener pConnectionListener = (PConnectionListener) arg;
-    PSocketConnection pSocketConnection;
     BOOL iterate = TRUE;
-    PSocketConnection sockets[CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION];
-    UINT32 i, socketCount;
-
-    INT32 nfds = 0;
-    //+1 added for the pipe() to kickout poll()
-    struct pollfd rfds[CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION + 1];
-    INT32 retval, localSocket;
     INT64 readLen;
     // the source address is put here. sockaddr_storage can hold either sockaddr_in or sockaddr_in6
     struct sockaddr_storage srcAddrBuff;
     socklen_t srcAddrBuffLen = SIZEOF(srcAddrBuff);
-    struct sockaddr_in* pIpv4Addr;
-    struct sockaddr_in6* pIpv6Addr;
-    KvsIpAddress srcAddr;
-    PKvsIpAddress pSrcAddr = NULL;
+
+    while (iterate) {
+        readLen = recvfrom(localSocket, pConnectionListener->pBuffer, pConnectionListener->bufferLen, 0, (struct sockaddr*) &srcAddrBuff,
+                           &srcAddrBuffLen);
+        if (readLen < 0) {
+            switch (getErrorCode()) {
+                case EWOULDBLOCK:
+                    break;
+                default:
+                    /* on any other error, close connection */
+                    CHK_STATUS(socketConnectionClosed(pSocketConnection));
+                    DLOGD("recvfrom() failed with errno %s for socket %d", getErrorString(getErrorCode()), localSocket);
+                    break;
+            }
+
+            iterate = FALSE;
+        } else if (readLen == 0) {
+            CHK_STATUS(socketConnectionClosed(pSocketConnection));
+            iterate = FALSE;
+        } else {
+            CHK_STATUS(connectionListenerDispatchData(pSocketConnection, pConnectionListener->pBuffer, (UINT32) pConnectionListener->bufferLen,
+                                                      (UINT32) readLen, &srcAddrBuff));
+        }
+
+        // reset srcAddrBuffLen to actual size
+        srcAddrBuffLen = SIZEOF(srcAddrBuff);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+#if defined(HAVE_RECVMMSG)
+/**
+ * Drain a UDP socket with recvmmsg, up to CONNECTION_LISTENER_RECV_BATCH_SIZE datagrams per syscall. Every datagram lands in
+ * its own slot of pBatchBuffer and is dispatched in the order it was received. A datagram bigger than its slot continues
+ * in the overflow part of pBuffer, which all the datagrams of a batch share.
+ */
+STATUS connectionListenerReadSocketBatch(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection, INT32 localSocket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL iterate = TRUE;
+    INT32 received, i, lastOverflow;
+    PBYTE pSlot;
+    struct mmsghdr messages[CONNECTION_LISTENER_RECV_BATCH_SIZE];
+    struct iovec iovecs[CONNECTION_LISTENER_RECV_BATCH_SIZE][2];
+    struct sockaddr_storage srcAddrBuffs[CONNECTION_LISTENER_RECV_BATCH_SIZE];
+
+    while (iterate) {
+        MEMSET(messages, 0x00, SIZEOF(messages));
+        for (i = 0; i < CONNECTION_LISTENER_RECV_BATCH_SIZE; i++) {
+            iovecs[i][0].iov_base = pConnectionListener->pBatchBuffer + i * CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE;
+            iovecs[i][0].iov_len = CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE;
+            iovecs[i][1].iov_base = pConnectionListener->pBuffer + CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE;
+            iovecs[i][1].iov_len = pConnectionListener->bufferLen - CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE;
+            messages[i].msg_hdr.msg_iov = iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 2;
+            messages[i].msg_hdr.msg_name = &srcAddrBuffs[i];
+            messages[i].msg_hdr.msg_namelen = SIZEOF(srcAddrBuffs[i]);
+        }
+
+        received = recvmmsg(localSocket, messages, CONNECTION_LISTENER_RECV_BATCH_SIZE, 0, NULL);
+        if (received < 0) {
+            switch (getErrorCode()) {
+                case EWOULDBLOCK:
+                    break;
+                default:
+                    /* on any other error, close connection */
+                    CHK_STATUS(socketConnectionClosed(pSocketConnection));
+                    DLOGD("recvmmsg() failed with errno %s for socket %d", getErrorString(getErrorCode()), localSocket);
+                    break;
+            }
+
+            iterate = FALSE;
+        } else {
+            // Only the last datagram that overflowed its slot still has its tail in pBuffer
+            for (i = 0, lastOverflow = -1; i < received; i++) {
+                if (messages[i].msg_len > CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE) {
+                    lastOverflow = i;
+                }
+            }
+
+            for (i = 0; i < received; i++) {
+                pSlot = (PBYTE) iovecs[i][0].iov_base;
+                if ((messages[i].msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+                    DLOGW("Dropping datagram larger than %u bytes on socket %d", (UINT32) pConnectionListener->bufferLen, localSocket);
+                } else if (messages[i].msg_len <= CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE) {
+                    CHK_STATUS(connectionListenerDispatchData(pSocketConnection, pSlot, CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE,
+                                                              (UINT32) messages[i].msg_len, &srcAddrBuffs[i]));
+                } else if (i == lastOverflow) {
+                    // Join the head with the tail that follows it in pBuffer
+                    MEMCPY(pConnectionListener->pBuffer, pSlot, CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE);
+                    CHK_STATUS(connectionListenerDispatchData(pSocketConnection, pConnectionListener->pBuffer,
+                                                              (UINT32) pConnectionListener->bufferLen, (UINT32) messages[i].msg_len,
+                                                              &srcAddrBuffs[i]));
+                } else {
+                    DLOGW("Dropping datagram of %u bytes on socket %d, its tail was overwritten by a later one", messages[i].msg_len, localSocket);
+                }
+            }
+
+            // A partially filled batch means the receive queue is empty. Any datagram arriving after this point raises a new
+            // readiness event so there is no need to spend another syscall just to see EWOULDBLOCK.
+            iterate = received == CONNECTION_LISTENER_RECV_BATCH_SIZE;
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+#endif
+
+/**
+ * Drain a readable socket until it would block and hand every datagram/segment to the socket's data available callback.
+ * The whole drain is reported to the socket as a single batch. Only called from the listener thread while the socket is marked as in use.
+ */
+STATUS connectionListenerReadSocket(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    INT32 localSocket;
+    KVS_SOCKET_PROTOCOL protocol;
+    ConnectionBatchFunc batchBeginFn, batchEndFn;
+    UINT64 customData;
+
+    CHK(pConnectionListener != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pSocketConnection->lock);
+    localSocket = pSocketConnection->localSocket;
+    protocol = pSocketConnection->protocol;
+    batchBeginFn = pSocketConnection->batchBeginCallbackFn;
+    batchEndFn = pSocketConnection->batchEndCallbackFn;
+    customData = pSocketConnection->dataAvailableCallbackCustomData;
+    MUTEX_UNLOCK(pSocketConnection->lock);
+
+    if (batchBeginFn != NULL) {
+        CHK_LOG_ERR(batchBeginFn(customData, pSocketConnection));
+    }
+
+#if defined(HAVE_RECVMMSG)
+    if (protocol == KVS_SOCKET_PROTOCOL_UDP) {
+        retStatus = connectionListenerReadSocketBatch(pConnectionListener, pSocketConnection, localSocket);
+    } else {
+        retStatus = connectionListenerReadSocketSingle(pConnectionListener, pSocketConnection, localSocket);
+    }
+#else
+    UNUSED_PARAM(protocol);
+    retStatus = connectionListenerReadSocketSingle(pConnectionListener, pSocketConnection, localSocket);
+#endif
+
+    // Always close the batch, even when draining failed half way through
+    if (batchEndFn != NULL) {
+        CHK_LOG_ERR(batchEndFn(customData, pSocketConnection));
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+#if defined(HAVE_EPOLL)
+PVOID connectionListenerReceiveDataRoutine(PVOID arg)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PConnectionListener pConnectionListener = (PConnectionListener) arg;
+    PSocketConnection pSocketConnection;
+    struct epoll_event events[CONNECTION_LISTENER_MAX_EPOLL_EVENTS];
+    PSocketConnection readySockets[CONNECTION_LISTENER_MAX_EPOLL_EVENTS];
+    UINT32 readyEvents[CONNECTION_LISTENER_MAX_EPOLL_EVENTS];
+    INT32 eventCount, i, readyCount;
+    BOOL present;
 
     CHK(pConnectionListener != NULL, STATUS_NULL_ARG);
 
-    /* Ensure that memory sanitizers consider
-     * rfds initialized even if FD_ZERO is
-     * implemented in assembly. */
-    MEMSET(&rfds, 0x00, SIZEOF(rfds));
+    MEMSET(events, 0x00, SIZEOF(events));
+
+    while (!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate)) {
+        // blocking call until resolves as a timeout, an error, a signal or data received
+        eventCount = epoll_wait(pConnectionListener->epollFd, events, CONNECTION_LISTENER_MAX_EPOLL_EVENTS,
+                                CONNECTION_LISTENER_SOCKET_WAIT_FOR_DATA_TIMEOUT / HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        if (eventCount == -1 && getErrorCode() != EINTR) {
+            DLOGW("epoll_wait() failed with errno %s", getErrorString(getErrorCode()));
+        }
+
+        // The event data points straight at the socket connection. It is only dereferenced if the connection is still
+        // registered, owners remove it before freeing it. It is marked as in use so that it can't be freed while reading.
+        // NOTE: There is no cleanup jump from the lock/unlock block so we don't need to use a boolean indicator whether locked
+        readyCount = 0;
+        MUTEX_LOCK(pConnectionListener->lock);
+        for (i = 0; i < eventCount; i++) {
+            pSocketConnection = (PSocketConnection) events[i].data.ptr;
+            present = FALSE;
+            if (pSocketConnection != NULL &&
+                STATUS_SUCCEEDED(hashTableContains(pConnectionListener->pSocketIndex, (UINT64) pSocketConnection, &present)) && present &&
+                !socketConnectionIsClosed(pSocketConnection)) {
+                ATOMIC_STORE_BOOL(&pSocketConnection->inUse, TRUE);
+                readyEvents[readyCount] = events[i].events;
+                readySockets[readyCount++] = pSocketConnection;
+            }
+        }
+        MUTEX_UNLOCK(pConnectionListener->lock);
+
+        for (i = 0; i < readyCount; i++) {
+            // EPOLLOUT is only requested while the egress queue holds packets
+            if ((readyEvents[i] & EPOLLOUT) != 0) {
+                CHK_LOG_ERR(socketConnectionFlushEgressQueue(readySockets[i]));
+            }
+            if ((readyEvents[i] & ~((UINT32) EPOLLOUT)) != 0) {
+                CHK_LOG_ERR(connectionListenerReadSocket(pConnectionListener, readySockets[i]));
+            }
+            ATOMIC_STORE_BOOL(&readySockets[i]->inUse, FALSE);
+        }
+    }
 
-    srcAddr.isPointToPoint = FALSE;
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return (PVOID) (ULONG_PTR) retStatus;
+}
+#else
+PVOID connectionListenerReceiveDataRoutine(PVOID arg)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PConnectionListener pConnectionListener = (PConnectionListener) arg;
+    PSocketConnection pSocketConnection;
+    PSocketConnection* sockets = NULL;
+    PSocketConnection* pNewSockets;
+    UINT32 i, socketCount, scratchCapacity = 0;
+
+    INT32 nfds = 0;
+    //+1 added for the pipe() to kickout poll()
+    struct pollfd* rfds = NULL;
+    struct pollfd* pNewRfds;
+    INT32 retval, localSocket;
+
+    CHK(pConnectionListener != NULL, STATUS_NULL_ARG);
 
     while (!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate)) {
         nfds = 0;
@@ -274,30 +765,42 @@ PVOID connectionListenerReceiveDataRoutine(PVOID arg)
         // NOTE: There is no cleanup jump from the lock/unlock block
         // so we don't need to use a boolean indicator whether locked
         MUTEX_LOCK(pConnectionListener->lock);
-        for (i = 0, socketCount = 0; i < CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION; i++) {
+
+        // Grow the scratch arrays along with the registry
+        if (scratchCapacity < pConnectionListener->socketCapacity + 1) {
+            pNewRfds = (struct pollfd*) MEMREALLOC(rfds, (pConnectionListener->socketCapacity + 1) * SIZEOF(struct pollfd));
+            if (pNewRfds != NULL) {
+                rfds = pNewRfds;
+                pNewSockets = (PSocketConnection*) MEMREALLOC(sockets, pConnectionListener->socketCapacity * SIZEOF(PSocketConnection));
+                if (pNewSockets != NULL) {
+                    sockets = pNewSockets;
+                    scratchCapacity = pConnectionListener->socketCapacity + 1;
+                }
+            }
+        }
+
+        for (i = 0, socketCount = 0; i < pConnectionListener->socketCount && socketCount + 1 < scratchCapacity; i++) {
+            // Registered sockets are alive, a closed one stays registered until its owner removes it
             pSocketConnection = pConnectionListener->sockets[i];
-            if (pSocketConnection != NULL) {
-                if (!socketConnectionIsClosed(pSocketConnection)) {
-                    MUTEX_LOCK(pSocketConnection->lock);
-                    localSocket = pSocketConnection->localSocket;
-                    MUTEX_UNLOCK(pSocketConnection->lock);
-                    rfds[nfds].fd = localSocket;
-                    rfds[nfds].events = POLLIN | POLLPRI;
+            if (socketConnectionIsClosed(pSocketConnection)) {
+                continue;
+            }
+
+            MUTEX_LOCK(pSocketConnection->lock);
+            localSocket = pSocketConnection->localSocket;
+            MUTEX_UNLOCK(pSocketConnection->lock);
+            rfds[nfds].fd = localSocket;
+            rfds[nfds].events = POLLIN | POLLPRI;
 #if !defined(HAVE_SOCKETPAIR)
-                    rfds[nfds].events &= ~POLLPRI;
+            rfds[nfds].events &= ~POLLPRI;
 #endif
-                    rfds[nfds].revents = 0;
-                    nfds++;
+            rfds[nfds].revents = 0;
+            nfds++;
 
-                    // Store the sockets locally while in use and mark it as in use
-                    sockets[socketCount++] = pSocketConnection;
-                    ATOMIC_STORE_BOOL(&pSocketConnection->inUse, TRUE);
-                } else {
-                    // Remove the connection
-                    pConnectionListener->sockets[i] = NULL;
-                    pConnectionListener->socketCount--;
-                }
-            }
+            // Store the sockets locally while in use and mark it as in use.
+            // sockets[i] always corresponds to rfds[i].
+            sockets[socketCount++] = pSocketConnection;
+            ATOMIC_STORE_BOOL(&pSocketConnection->inUse, TRUE);
         }
 
         // Need to unlock the mutex to ensure other racing threads unblock
@@ -326,69 +829,8 @@ PVOID connectionListenerReceiveDataRoutine(PVOID arg)
             DLOGW("poll() failed with errno %s", getErrorString(getErrorCode()));
         } else if (retval > 0) {
             for (i = 0; i < socketCount; i++) {
-                pSocketConnection = sockets[i];
-                if (!socketConnectionIsClosed(pSocketConnection)) {
-                    MUTEX_LOCK(pSocketConnection->lock);
-                    localSocket = pSocketConnection->localSocket;
-                    MUTEX_UNLOCK(pSocketConnection->lock);
-
-                    if (canReadFd(localSocket, rfds, nfds)) {
-                        iterate = TRUE;
-                        while (iterate) {
-                            readLen = recvfrom(localSocket, pConnectionListener->pBuffer, pConnectionListener->bufferLen, 0,
-                                               (struct sockaddr*) &srcAddrBuff, &srcAddrBuffLen);
-                            if (readLen < 0) {
-                                switch (getErrorCode()) {
-                                    case EWOULDBLOCK:
-                                        break;
-                                    default:
-                                        /* on any other error, close connection */
-                                        CHK_STATUS(socketConnectionClosed(pSocketConnection));
-                                        DLOGD("recvfrom() failed with errno %s for socket %d", getErrorString(getErrorCode()), localSocket);
-                                        break;
-                                }
-
-                                iterate = FALSE;
-                            } else if (readLen == 0) {
-                                CHK_STATUS(socketConnectionClosed(pSocketConnection));
-                                iterate = FALSE;
-                            } else if (/* readLen > 0 */
-                                       ATOMIC_LOAD_BOOL(&pSocketConnection->receiveData) && pSocketConnection->dataAvailableCallbackFn != NULL &&
-                                       /* data could be encrypted so they need to be decrypted through socketConnectionReadData
-                                        * and get the decrypted data length. */
-                                       STATUS_SUCCEEDED(socketConnectionReadData(pSocketConnection, pConnectionListener->pBuffer,
-                                                                                 pConnectionListener->bufferLen, (PUINT32) &readLen))) {
-                                if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP) {
-                                    if (srcAddrBuff.ss_family == AF_INET) {
-                                        srcAddr.family = KVS_IP_FAMILY_TYPE_IPV4;
-                                        pIpv4Addr = (struct sockaddr_in*) &srcAddrBuff;
-                                        MEMCPY(srcAddr.address, (PBYTE) &pIpv4Addr->sin_addr, IPV4_ADDRESS_LENGTH);
-                                        srcAddr.port = pIpv4Addr->sin_port;
-                                    } else if (srcAddrBuff.ss_family == AF_INET6) {
-                                        srcAddr.family = KVS_IP_FAMILY_TYPE_IPV6;
-                                        pIpv6Addr = (struct sockaddr_in6*) &srcAddrBuff;
-                                        MEMCPY(srcAddr.address, (PBYTE) &pIpv6Addr->sin6_addr, IPV6_ADDRESS_LENGTH);
-                                        srcAddr.port = pIpv6Addr->sin6_port;
-                                    }
-                                    pSrcAddr = &srcAddr;
-                                } else {
-                                    // srcAddr is ignored in TCP callback handlers
-                                    pSrcAddr = NULL;
-                                }
-
-                                // readLen may be 0 if SSL does not emit any application data.
-                                // in that case, no need to call dataAvailable callback
-                                if (readLen > 0) {
-                                    pSocketConnection->dataAvailableCallbackFn(pSocketConnection->dataAvailableCallbackCustomData, pSocketConnection,
-                                                                               pConnectionListener->pBuffer, (UINT32) readLen, pSrcAddr,
-                                                                               NULL); // no dest information available right now.
-                                }
-                            }
-
-                            // reset srcAddrBuffLen to actual size
-                            srcAddrBuffLen = SIZEOF(srcAddrBuff);
-                        }
-                    }
+                if ((rfds[i].revents & POLLIN) != 0 && !socketConnectionIsClosed(sockets[i])) {
+                    CHK_LOG_ERR(connectionListenerReadSocket(pConnectionListener, sockets[i]));
                 }
             }
         }
@@ -403,5 +845,9 @@ CleanUp:
 
     CHK_LOG_ERR(retStatus);
 
+    SAFE_MEMFREE(rfds);
+    SAFE_MEMFREE(sockets);
+
     return (PVOID) (ULONG_PTR) retStatus;
 }
+#endif
@@ -10,24 +10,56 @@ Connection Listener internal include file
 extern "C" {
 #endif
 
-#define CONNECTION_LISTENER_SOCKET_WAIT_FOR_DATA_TIMEOUT     (200 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
-#define CONNECTION_LISTENER_SHUTDOWN_TIMEOUT                 (1000 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
-#define CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION 64
-#define CONNECTION_LISTENER_KICK_SOCKET_LISTEN               0
-#define CONNECTION_LISTENER_KICK_SOCKET_WRITE                1
+#define CONNECTION_LISTENER_SOCKET_WAIT_FOR_DATA_TIMEOUT (200 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define CONNECTION_LISTENER_SHUTDOWN_TIMEOUT             (1000 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define CONNECTION_LISTENER_KICK_SOCKET_LISTEN           0
+#define CONNECTION_LISTENER_KICK_SOCKET_WRITE            1
 
-typedef struct {
+// Initial number of socket slots in the registry. The registry doubles whenever it runs out of slots.
+#define CONNECTION_LISTENER_DEFAULT_SOCKET_CAPACITY 64
+
+// Hash table parameters for the socket connection -> registry slot index
+#define CONNECTION_LISTENER_SOCKET_INDEX_BUCKET_COUNT  64
+#define CONNECTION_LISTENER_SOCKET_INDEX_BUCKET_LENGTH 2
+
+// Max number of events returned by a single epoll_wait call
+#define CONNECTION_LISTENER_MAX_EPOLL_EVENTS 64
+
+// Max number of datagrams pulled from a UDP socket by a single recvmmsg call
+#define CONNECTION_LISTENER_RECV_BATCH_SIZE 16
+
+// Size of each recvmmsg slot, an MTU sized datagram with room to spare. Bigger datagrams spill over into pBuffer.
+#define CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE 2048
+
+typedef struct __ConnectionListener ConnectionListener;
+struct __ConnectionListener {
     volatile ATOMIC_BOOL terminate;
-    PSocketConnection sockets[CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION];
+    // Dynamically sized array of the listened sockets. Slots [0, socketCount) are occupied.
+    PSocketConnection* sockets;
+    UINT32 socketCapacity;
     UINT64 socketCount;
+    // Maps a PSocketConnection to its slot in sockets so that add/remove/lookup are O(1)
+    PHashTable pSocketIndex;
     MUTEX lock;
     TID receiveDataRoutine;
     PBYTE pBuffer;
     UINT64 bufferLen;
+#if defined(HAVE_RECVMMSG)
+    // CONNECTION_LISTENER_RECV_BATCH_SIZE slots of CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE bytes each. The tail of a
+    // datagram that does not fit its slot lands in pBuffer past the first CONNECTION_LISTENER_RECV_BATCH_SLOT_SIZE bytes.
+    PBYTE pBatchBuffer;
+#endif
+#if defined(HAVE_EPOLL)
+    INT32 epollFd;
+#endif
 #if defined(HAVE_SOCKETPAIR)
     INT32 kickSocket[2];
 #endif
-} ConnectionListener, *PConnectionListener;
+    // Set for listeners created with createSharedConnectionListener. Such a listener has no thread of its own, it only
+    // tracks the sockets it registered and forwards them to this shared reactor.
+    struct __ConnectionListener* pReactor;
+};
+typedef struct __ConnectionListener* PConnectionListener;
 
 /**
  * allocate the ConnectionListener struct
@@ -38,6 +70,16 @@ typedef struct {
  */
 STATUS createConnectionListener(PConnectionListener*);
 
+/**
+ * allocate a ConnectionListener attached to one of the process wide network reactors. Sockets added to it are serviced
+ * by the reactor thread, removing or freeing it only affects the sockets that were added through it.
+ *
+ * @param - PConnectionListener* - IN/OUT - pointer to PConnectionListener being allocated
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createSharedConnectionListener(PConnectionListener*);
+
 /**
  * free the ConnectionListener struct and all its resources
  *
@@ -89,7 +131,16 @@ STATUS connectionListenerStart(PConnectionListener);
 ////////////////////////////////////////////
 // internal functionalities
 ////////////////////////////////////////////
+STATUS connectionListenerAllocate(UINT32, PConnectionListener*);
 PVOID connectionListenerReceiveDataRoutine(PVOID arg);
+STATUS connectionListenerRemoveConnectionLocked(PConnectionListener, PSocketConnection);
+STATUS connectionListenerUnregisterLocked(PConnectionListener, PSocketConnection);
+STATUS connectionListenerReadSocket(PConnectionListener, PSocketConnection);
+STATUS connectionListenerReadSocketSingle(PConnectionListener, PSocketConnection, INT32);
+#if defined(HAVE_RECVMMSG)
+STATUS connectionListenerReadSocketBatch(PConnectionListener, PSocketConnection, INT32);
+#endif
+STATUS connectionListenerDispatchData(PSocketConnection, PBYTE, UINT32, UINT32, struct sockaddr_storage*);
 
 #ifdef __cplusplus
 }
@@ -47,6 +47,9 @@ STATUS createIceAgent(PCHAR username, PCHAR password, PIceAgentCallbacks pIceAge
     CHK(NULL != (pIceAgent = (PIceAgent) MEMCALLOC(1, SIZEOF(IceAgent))), STATUS_NOT_ENOUGH_MEMORY);
     STRNCPY(pIceAgent->localUsername, username, MAX_ICE_CONFIG_USER_NAME_LEN);
     STRNCPY(pIceAgent->localPassword, password, MAX_ICE_CONFIG_CREDENTIAL_LEN);
+    CHK_STATUS(initStunHmacKey(&pIceAgent->localHmacKey, (PBYTE) pIceAgent->localPassword, (UINT32) STRLEN(pIceAgent->localPassword)));
+    // Valid until the remote credentials are received
+    CHK_STATUS(initStunHmacKey(&pIceAgent->remoteHmacKey, (PBYTE) pIceAgent->remotePassword, 0));
     ATOMIC_STORE_BOOL(&pIceAgent->remoteCredentialReceived, FALSE);
     ATOMIC_STORE_BOOL(&pIceAgent->agentStartGathering, FALSE);
     ATOMIC_STORE_BOOL(&pIceAgent->stopGathering, FALSE);
@@ -70,6 +73,10 @@ STATUS createIceAgent(PCHAR username, PCHAR password, PIceAgentCallbacks pIceAge
     pIceAgent->candidateGatheringEndTime = INVALID_TIMESTAMP_VALUE;
 
     pIceAgent->lock = MUTEX_CREATE(TRUE);
+    pIceAgent->sendPathLock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pIceAgent->sendPathLock), STATUS_INVALID_OPERATION);
+    pIceAgent->sendPathReleasedCvar = CVAR_CREATE();
+    CHK(IS_VALID_CVAR_VALUE(pIceAgent->sendPathReleasedCvar), STATUS_INVALID_OPERATION);
 
     // Create the state machine
     CHK_STATUS(createStateMachineWithName(ICE_AGENT_STATE_MACHINE_STATES, ICE_AGENT_STATE_MACHINE_STATE_COUNT, (UINT64) pIceAgent,
@@ -206,6 +213,15 @@ STATUS freeIceAgent(PIceAgent* ppIceAgent)
 
     pIceAgent = *ppIceAgent;
 
+    // No sender may use the sockets freed below
+    if (IS_VALID_MUTEX_VALUE(pIceAgent->lock) && IS_VALID_MUTEX_VALUE(pIceAgent->sendPathLock) &&
+        IS_VALID_CVAR_VALUE(pIceAgent->sendPathReleasedCvar)) {
+        MUTEX_LOCK(pIceAgent->lock);
+        CHK_LOG_ERR(iceAgentSetSendPathLocked(pIceAgent, NULL));
+        MUTEX_UNLOCK(pIceAgent->lock);
+        iceAgentAwaitSendPathRelease(pIceAgent);
+    }
+
     if (pIceAgent->localCandidates != NULL) {
         CHK_STATUS(doubleListGetHeadNode(pIceAgent->localCandidates, &pCurNode));
         while (pCurNode != NULL) {
@@ -219,6 +235,8 @@ STATUS freeIceAgent(PIceAgent* ppIceAgent)
     }
 
     if (pIceAgent->pConnectionListener != NULL) {
+        // The host sockets are freed below, they must not be registered anymore by then
+        CHK_LOG_ERR(connectionListenerRemoveAllConnection(pIceAgent->pConnectionListener));
         CHK_LOG_ERR(freeConnectionListener(&pIceAgent->pConnectionListener));
     }
 
@@ -281,6 +299,14 @@ STATUS freeIceAgent(PIceAgent* ppIceAgent)
         MUTEX_FREE(pIceAgent->lock);
     }
 
+    if (IS_VALID_MUTEX_VALUE(pIceAgent->sendPathLock)) {
+        MUTEX_FREE(pIceAgent->sendPathLock);
+    }
+
+    if (IS_VALID_CVAR_VALUE(pIceAgent->sendPathReleasedCvar)) {
+        CVAR_FREE(pIceAgent->sendPathReleasedCvar);
+    }
+
     freeStateMachine(pIceAgent->pStateMachine);
 
     if (pIceAgent->pBindingIndication != NULL) {
@@ -291,6 +317,9 @@ STATUS freeIceAgent(PIceAgent* ppIceAgent)
         freeStunPacket(&pIceAgent->pBindingRequest);
     }
 
+    freeStunHmacKey(&pIceAgent->localHmacKey);
+    freeStunHmacKey(&pIceAgent->remoteHmacKey);
+
     if (pIceAgent->pStunBindingRequestTransactionIdStore != NULL) {
         freeTransactionIdStore(&pIceAgent->pStunBindingRequestTransactionIdStore);
     }
@@ -543,6 +572,8 @@ STATUS iceAgentInitHostCandidate(PIceAgent pIceAgent)
         if (pDuplicatedIceCandidate == NULL &&
             STATUS_SUCCEEDED(createSocketConnection(pIpAddress->family, KVS_SOCKET_PROTOCOL_UDP, pIpAddress, NULL, (UINT64) pIceAgent,
                                                     incomingDataHandler, pIceAgent->kvsRtcConfiguration.sendBufSize, &pSocketConnection))) {
+            CHK_STATUS(socketConnectionSetBatchCallbacks(pSocketConnection, iceAgentIncomingBatchBegin, iceAgentIncomingBatchEnd));
+            CHK_STATUS(socketConnectionSetEgressStateCallback(pSocketConnection, iceAgentSocketEgressStateChanged));
             pTmpIceCandidate = MEMCALLOC(1, SIZEOF(IceCandidate));
             generateJSONSafeString(pTmpIceCandidate->id, ARRAY_SIZE(pTmpIceCandidate->id));
             pTmpIceCandidate->isRemote = FALSE;
@@ -561,6 +592,8 @@ STATUS iceAgentInitHostCandidate(PIceAgent pIceAgent)
             locked = TRUE;
 
             CHK_STATUS(doubleListInsertItemHead(pIceAgent->localCandidates, (UINT64) pTmpIceCandidate));
+            // The candidate owns the socket connection from here on
+            pSocketConnection = NULL;
             CHK_STATUS(createIceCandidatePairs(pIceAgent, pTmpIceCandidate, FALSE));
 
             MUTEX_UNLOCK(pIceAgent->lock);
@@ -571,7 +604,7 @@ STATUS iceAgentInitHostCandidate(PIceAgent pIceAgent)
             pNewIceCandidate = pTmpIceCandidate;
             pTmpIceCandidate = NULL;
 
-            ATOMIC_STORE_BOOL(&pSocketConnection->receiveData, TRUE);
+            ATOMIC_STORE_BOOL(&pNewIceCandidate->pSocketConnection->receiveData, TRUE);
             // connectionListener will free the pSocketConnection at the end.
             CHK_STATUS(connectionListenerAddConnection(pIceAgent->pConnectionListener, pNewIceCandidate->pSocketConnection));
         }
@@ -588,6 +621,10 @@ CleanUp:
 
     SAFE_MEMFREE(pTmpIceCandidate);
 
+    if (pSocketConnection != NULL) {
+        CHK_LOG_ERR(freeSocketConnection(&pSocketConnection));
+    }
+
     if (STATUS_FAILED(retStatus)) {
         iceAgentFatalError(pIceAgent, retStatus);
     }
@@ -620,6 +657,7 @@ STATUS iceAgentStartAgent(PIceAgent pIceAgent, PCHAR remoteUsername, PCHAR remot
 
     STRNCPY(pIceAgent->remoteUsername, remoteUsername, MAX_ICE_CONFIG_USER_NAME_LEN);
     STRNCPY(pIceAgent->remotePassword, remotePassword, MAX_ICE_CONFIG_CREDENTIAL_LEN);
+    CHK_STATUS(initStunHmacKey(&pIceAgent->remoteHmacKey, (PBYTE) pIceAgent->remotePassword, (UINT32) STRLEN(pIceAgent->remotePassword)));
     if (STRLEN(pIceAgent->remoteUsername) + STRLEN(pIceAgent->localUsername) + 1 > MAX_ICE_CONFIG_USER_NAME_LEN) {
         DLOGW("remoteUsername:localUsername will be truncated to stay within %u char limit", MAX_ICE_CONFIG_USER_NAME_LEN);
     }
@@ -628,9 +666,9 @@ STATUS iceAgentStartAgent(PIceAgent pIceAgent, PCHAR remoteUsername, PCHAR remot
     MUTEX_UNLOCK(pIceAgent->lock);
     locked = FALSE;
 
-    CHK_STATUS(timerQueueAddTimer(pIceAgent->timerQueueHandle, KVS_ICE_DEFAULT_TIMER_START_DELAY,
-                                  pIceAgent->kvsRtcConfiguration.iceConnectionCheckPollingInterval, iceAgentStateTransitionTimerCallback,
-                                  (UINT64) pIceAgent, &pIceAgent->iceAgentStateTimerTask));
+    CHK_STATUS(sharedTimerQueueAddTimer(pIceAgent->timerQueueHandle, KVS_ICE_DEFAULT_TIMER_START_DELAY,
+                                        pIceAgent->kvsRtcConfiguration.iceConnectionCheckPollingInterval, iceAgentStateTransitionTimerCallback,
+                                        (UINT64) pIceAgent, &pIceAgent->iceAgentStateTimerTask));
 
 CleanUp:
 
@@ -675,8 +713,9 @@ STATUS iceAgentStartGathering(PIceAgent pIceAgent)
 
     pIceAgent->candidateGatheringEndTime = GETTIME() + pIceAgent->kvsRtcConfiguration.iceLocalCandidateGatheringTimeout;
 
-    CHK_STATUS(timerQueueAddTimer(pIceAgent->timerQueueHandle, KVS_ICE_DEFAULT_TIMER_START_DELAY, KVS_ICE_GATHER_CANDIDATE_TIMER_POLLING_INTERVAL,
-                                  iceAgentGatherCandidateTimerCallback, (UINT64) pIceAgent, &pIceAgent->iceCandidateGatheringTimerTask));
+    CHK_STATUS(sharedTimerQueueAddTimer(pIceAgent->timerQueueHandle, KVS_ICE_DEFAULT_TIMER_START_DELAY,
+                                        KVS_ICE_GATHER_CANDIDATE_TIMER_POLLING_INTERVAL, iceAgentGatherCandidateTimerCallback, (UINT64) pIceAgent,
+                                        &pIceAgent->iceCandidateGatheringTimerTask));
 
 CleanUp:
 
@@ -692,81 +731,281 @@ CleanUp:
 STATUS iceAgentSendPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    BOOL locked = FALSE, isRelay = FALSE;
-    PTurnConnection pTurnConnection = NULL;
-    UINT32 packetsDiscarded = 0;
-    UINT32 bytesDiscarded = 0;
-    UINT32 bytesSent = 0;
-    UINT32 packetsSent = 0;
 
     CHK(pIceAgent != NULL && pBuffer != NULL, STATUS_NULL_ARG);
     CHK(bufferLen != 0, STATUS_INVALID_ARG);
 
-    MUTEX_LOCK(pIceAgent->lock);
-    locked = TRUE;
+    retStatus = iceAgentSendPacketBatch(pIceAgent, &pBuffer, &bufferLen, 1, SOCKET_EGRESS_PRIORITY_CONTROL);
 
-    /* Do not proceed if ice is shutting down */
-    CHK(!ATOMIC_LOAD_BOOL(&pIceAgent->shutdown), retStatus);
-    CHK(bufferLen != 0, STATUS_INVALID_ARG);
+CleanUp:
 
-    CHK_WARN(pIceAgent->pDataSendingIceCandidatePair != NULL, retStatus, "No valid ice candidate pair available to send data");
-    CHK_WARN(pIceAgent->pDataSendingIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED, retStatus,
-             "Invalid state for data sending candidate pair.");
+    return retStatus;
+}
 
-    CHK_WARN(pIceAgent->pDataSendingIceCandidatePair->local != NULL, retStatus, "Local ice candidate is invalid");
+STATUS iceAgentSendPacketBatch(PIceAgent pIceAgent, PBYTE* ppBuffers, PUINT32 pBufferLens, UINT32 count, SOCKET_EGRESS_PRIORITY priority)
+{
+    STATUS retStatus = STATUS_SUCCESS, sendStatus = STATUS_SUCCESS, packetStatus;
+    PIceSendPath pSendPath = NULL;
+    PIceCandidatePair pIceCandidatePair = NULL;
+    UINT32 i, sentCount = 0;
+    UINT32 packetsDiscarded = 0;
+    UINT64 bytesDiscarded = 0;
+    UINT64 bytesSent = 0;
+    UINT32 packetsSent = 0;
 
-    isRelay = IS_CANN_PAIR_SENDING_FROM_RELAYED(pIceAgent->pDataSendingIceCandidatePair);
-    if (isRelay) {
-        CHK_ERR(pIceAgent->pDataSendingIceCandidatePair->local->pTurnConnection != NULL, STATUS_NULL_ARG,
-                "Candidate is relay but pTurnConnection is NULL");
-        pTurnConnection = pIceAgent->pDataSendingIceCandidatePair->local->pTurnConnection;
+    CHK(pIceAgent != NULL && ppBuffers != NULL && pBufferLens != NULL, STATUS_NULL_ARG);
+    CHK(count != 0, STATUS_INVALID_ARG);
+    for (i = 0; i < count; i++) {
+        CHK(ppBuffers[i] != NULL, STATUS_NULL_ARG);
+        CHK(pBufferLens[i] != 0, STATUS_INVALID_ARG);
     }
 
-    retStatus = iceUtilsSendData(pBuffer, bufferLen, &pIceAgent->pDataSendingIceCandidatePair->remote->ipAddress,
-                                 pIceAgent->pDataSendingIceCandidatePair->local->pSocketConnection, pTurnConnection, isRelay);
+    /* Do not proceed if ice is shutting down */
+    CHK(!ATOMIC_LOAD_BOOL(&pIceAgent->shutdown), retStatus);
 
-    if (STATUS_FAILED(retStatus)) {
-        DLOGW("iceUtilsSendData failed with 0x%08x", retStatus);
-        packetsDiscarded++;
-        bytesDiscarded = bufferLen; // This includes header and padding. TODO: update length to remove header and padding
-        if (retStatus == STATUS_SOCKET_CONNECTION_CLOSED_ALREADY) {
-            DLOGW("IceAgent connection closed unexpectedly");
-            pIceAgent->iceAgentStatus = STATUS_SOCKET_CONNECTION_CLOSED_ALREADY;
-            pIceAgent->pDataSendingIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+    // pIceAgent->lock is not taken, it is held through STUN handling, gathering and nomination
+    iceAgentAcquireSendPath(pIceAgent, &pSendPath);
+    CHK_WARN(pSendPath != NULL, retStatus, "No valid ice candidate pair available to send data");
+
+    if (pSendPath->isRelay) {
+        // TURN wraps every packet in its own channel data message so there is nothing to batch on the wire
+        for (i = 0; i < count; i++) {
+            packetStatus = iceUtilsSendData(ppBuffers[i], pBufferLens[i], &pSendPath->remoteAddress, pSendPath->pSocketConnection,
+                                            pSendPath->pTurnConnection, TRUE);
+            if (STATUS_FAILED(packetStatus)) {
+                sendStatus = packetStatus;
+                packetsDiscarded++;
+                bytesDiscarded += pBufferLens[i]; // This includes header and padding. TODO: update length to remove header and padding
+            } else {
+                packetsSent++;
+                bytesSent += pBufferLens[i];
+            }
         }
-        retStatus = STATUS_SUCCESS;
     } else {
+        sendStatus = socketConnectionSendBatch(pSendPath->pSocketConnection, ppBuffers, pBufferLens, count, &pSendPath->remoteAddress, priority,
+                                               &sentCount);
+
+        // Fix-up the not-yet-ready socket
+        if (sendStatus == STATUS_SOCKET_CONNECTION_NOT_READY_TO_SEND) {
+            sendStatus = STATUS_SUCCESS;
+            sentCount = count;
+        } else if (sendStatus == STATUS_SOCKET_CONNECTION_BACKPRESSURED) {
+            // The socket queued what it could not send right away, the backpressure is reported through the callbacks
+            sendStatus = STATUS_SUCCESS;
+        }
+
+        for (i = 0; i < count; i++) {
+            if (i < sentCount) {
+                packetsSent++;
+                bytesSent += pBufferLens[i];
+            } else {
+                packetsDiscarded++;
+                bytesDiscarded += pBufferLens[i]; // This includes header and padding. TODO: update length to remove header and padding
+            }
+        }
+    }
+
+    ATOMIC_ADD(&pSendPath->packetsDiscarded, packetsDiscarded);
+    ATOMIC_ADD(&pSendPath->bytesDiscarded, (SIZE_T) bytesDiscarded);
+    ATOMIC_ADD(&pSendPath->packetsSent, packetsSent);
+    ATOMIC_ADD(&pSendPath->bytesSent, (SIZE_T) bytesSent);
+    if (packetsSent > 0) {
         // TODO: use a better estimate of actual time when packet was sent
         // eg setsockopt(SO_TIMESTAMPING)
         // SOF_TIMESTAMPING_TX_HARDWARE - tx timestamps generated by network hardware
         // SOF_TIMESTAMPING_TX_SOFTWARE - tx timestamps generated by kernel, when data leaves kernel, before hardware
-        pIceAgent->pDataSendingIceCandidatePair->lastDataSentTime = GETTIME();
+        ATOMIC_STORE(&pSendPath->lastDataSentTime, (SIZE_T) ((GETTIME() - pSendPath->publishTime) / HUNDREDS_OF_NANOS_IN_A_MILLISECOND) + 1);
 
-        bytesSent = bufferLen;
-        packetsSent++;
+        // Keep the pair stats current without waiting for the agent, whoever holds the lock is busy with it
+        if (MUTEX_TRYLOCK(pIceAgent->lock)) {
+            if (pIceAgent->pSendPath == pSendPath) {
+                iceSendPathCollectStats(pSendPath);
+            }
+            MUTEX_UNLOCK(pIceAgent->lock);
+        }
     }
 
-CleanUp:
+    if (STATUS_FAILED(sendStatus)) {
+        DLOGW("Sending %u packet(s) failed with 0x%08x. %u packet(s) discarded", count, sendStatus, packetsDiscarded);
+        if (sendStatus == STATUS_SOCKET_CONNECTION_CLOSED_ALREADY) {
+            DLOGW("IceAgent connection closed unexpectedly");
+            pIceCandidatePair = pSendPath->pIceCandidatePair;
 
-    if (STATUS_SUCCEEDED(retStatus) && pIceAgent->pDataSendingIceCandidatePair != NULL) {
-        if (pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics != NULL) {
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->packetsDiscardedOnSend += packetsDiscarded;
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->bytesDiscardedOnSend += bytesDiscarded;
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->state = pIceAgent->pDataSendingIceCandidatePair->state;
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->lastPacketSentTimestamp =
-                pIceAgent->pDataSendingIceCandidatePair->lastDataSentTime;
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->bytesSent += bytesSent;
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->packetsSent += packetsSent;
+            MUTEX_LOCK(pIceAgent->lock);
+            pIceAgent->iceAgentStatus = STATUS_SOCKET_CONNECTION_CLOSED_ALREADY;
+            if (pIceCandidatePair == pIceAgent->pDataSendingIceCandidatePair) {
+                pIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+                CHK_LOG_ERR(iceAgentUpdateSendPathLocked(pIceAgent));
+            }
+            MUTEX_UNLOCK(pIceAgent->lock);
         }
     }
 
-    if (locked) {
-        MUTEX_UNLOCK(pIceAgent->lock);
+CleanUp:
+
+    iceAgentReleaseSendPath(pIceAgent, &pSendPath);
+
+    return retStatus;
+}
+
+STATUS iceAgentUpdateSendPathLocked(PIceAgent pIceAgent)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidatePair pIceCandidatePair = NULL;
+
+    // Assume holding pIceAgent->lock
+    CHK(pIceAgent != NULL, STATUS_NULL_ARG);
+
+    pIceCandidatePair = pIceAgent->pDataSendingIceCandidatePair;
+    if (ATOMIC_LOAD_BOOL(&pIceAgent->shutdown) || pIceCandidatePair == NULL || pIceCandidatePair->state != ICE_CANDIDATE_PAIR_STATE_SUCCEEDED ||
+        pIceCandidatePair->local == NULL) {
+        pIceCandidatePair = NULL;
+    } else if (IS_CANN_PAIR_SENDING_FROM_RELAYED(pIceCandidatePair) && pIceCandidatePair->local->pTurnConnection == NULL) {
+        DLOGE("Candidate is relay but pTurnConnection is NULL");
+        pIceCandidatePair = NULL;
+    }
+
+    CHK_STATUS(iceAgentSetSendPathLocked(pIceAgent, pIceCandidatePair));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS iceAgentSetSendPathLocked(PIceAgent pIceAgent, PIceCandidatePair pIceCandidatePair)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceSendPath pSendPath = NULL, pOldSendPath = NULL;
+
+    // Assume holding pIceAgent->lock
+    CHK(pIceAgent != NULL, STATUS_NULL_ARG);
+
+    // Only ever written with pIceAgent->lock held, so it can be read without sendPathLock here
+    pOldSendPath = pIceAgent->pSendPath;
+    if (pOldSendPath == NULL) {
+        CHK(pIceCandidatePair != NULL, retStatus);
+    } else if (pIceCandidatePair != NULL) {
+        CHK(pOldSendPath->pIceCandidatePair != pIceCandidatePair || pOldSendPath->pSocketConnection != pIceCandidatePair->local->pSocketConnection ||
+                pOldSendPath->pTurnConnection != pIceCandidatePair->local->pTurnConnection ||
+                !isSameIpAddress(&pOldSendPath->remoteAddress, &pIceCandidatePair->remote->ipAddress, FALSE),
+            retStatus);
+    }
+
+    if (pIceCandidatePair != NULL) {
+        CHK(NULL != (pSendPath = (PIceSendPath) MEMCALLOC(1, SIZEOF(IceSendPath))), STATUS_NOT_ENOUGH_MEMORY);
+        // The reference of the agent, dropped when the send path is replaced
+        pSendPath->refCount = 1;
+        pSendPath->pIceCandidatePair = pIceCandidatePair;
+        pSendPath->pSocketConnection = pIceCandidatePair->local->pSocketConnection;
+        pSendPath->pTurnConnection = pIceCandidatePair->local->pTurnConnection;
+        pSendPath->isRelay = IS_CANN_PAIR_SENDING_FROM_RELAYED(pIceCandidatePair);
+        pSendPath->remoteAddress = pIceCandidatePair->remote->ipAddress;
+        pSendPath->publishTime = GETTIME();
+    }
+
+    MUTEX_LOCK(pIceAgent->sendPathLock);
+    pIceAgent->pSendPath = pSendPath;
+    MUTEX_UNLOCK(pIceAgent->sendPathLock);
+    pSendPath = NULL;
+
+    if (pOldSendPath != NULL) {
+        // The pair may be freed once the lock is dropped, what the senders still in flight add afterwards is not accounted
+        iceSendPathCollectStats(pOldSendPath);
+
+        // Not waited for here, the callers that free the sockets of the replaced pair call iceAgentAwaitSendPathRelease first
+        MUTEX_LOCK(pIceAgent->sendPathLock);
+        if (ATOMIC_DECREMENT(&pOldSendPath->refCount) == 1) {
+            MEMFREE(pOldSendPath);
+        } else {
+            pIceAgent->retiredSendPathCount++;
+        }
+        MUTEX_UNLOCK(pIceAgent->sendPathLock);
+        pOldSendPath = NULL;
     }
 
+CleanUp:
+
+    SAFE_MEMFREE(pSendPath);
+
     return retStatus;
 }
 
+VOID iceAgentAcquireSendPath(PIceAgent pIceAgent, PIceSendPath* ppSendPath)
+{
+    if (pIceAgent == NULL || ppSendPath == NULL) {
+        return;
+    }
+
+    MUTEX_LOCK(pIceAgent->sendPathLock);
+    *ppSendPath = pIceAgent->pSendPath;
+    if (*ppSendPath != NULL) {
+        ATOMIC_INCREMENT(&(*ppSendPath)->refCount);
+    }
+    MUTEX_UNLOCK(pIceAgent->sendPathLock);
+}
+
+VOID iceAgentReleaseSendPath(PIceAgent pIceAgent, PIceSendPath* ppSendPath)
+{
+    if (pIceAgent == NULL || ppSendPath == NULL || *ppSendPath == NULL) {
+        return;
+    }
+
+    // ATOMIC_DECREMENT returns the value before the decrement. The last reference is only dropped here once the
+    // agent replaced the send path, so it is a retired one
+    if (ATOMIC_DECREMENT(&(*ppSendPath)->refCount) == 1) {
+        MUTEX_LOCK(pIceAgent->sendPathLock);
+        pIceAgent->retiredSendPathCount--;
+        CVAR_BROADCAST(pIceAgent->sendPathReleasedCvar);
+        MUTEX_UNLOCK(pIceAgent->sendPathLock);
+        MEMFREE(*ppSendPath);
+    }
+    *ppSendPath = NULL;
+}
+
+VOID iceAgentAwaitSendPathRelease(PIceAgent pIceAgent)
+{
+    // Must not hold pIceAgent->lock, a sender can sit in the retry of a full socket for a while
+    if (pIceAgent == NULL) {
+        return;
+    }
+
+    MUTEX_LOCK(pIceAgent->sendPathLock);
+    while (pIceAgent->retiredSendPathCount > 0) {
+        CVAR_WAIT(pIceAgent->sendPathReleasedCvar, pIceAgent->sendPathLock, INFINITE_TIME_VALUE);
+    }
+    MUTEX_UNLOCK(pIceAgent->sendPathLock);
+}
+
+VOID iceSendPathCollectStats(PIceSendPath pSendPath)
+{
+    PIceCandidatePair pIceCandidatePair;
+    PRtcIceCandidatePairDiagnostics pDiagnostics;
+    SIZE_T lastDataSentTime;
+
+    // Assume holding pIceAgent->lock, the pair of a published send path is not freed before it is replaced
+    if (pSendPath == NULL) {
+        return;
+    }
+
+    pIceCandidatePair = pSendPath->pIceCandidatePair;
+    lastDataSentTime = ATOMIC_LOAD(&pSendPath->lastDataSentTime);
+    if (lastDataSentTime != 0) {
+        pIceCandidatePair->lastDataSentTime =
+            MAX(pIceCandidatePair->lastDataSentTime, pSendPath->publishTime + (UINT64) (lastDataSentTime - 1) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    // The counters are exchanged so that every packet is accounted for once
+    pDiagnostics = pIceCandidatePair->pRtcIceCandidatePairDiagnostics;
+    if (pDiagnostics != NULL) {
+        pDiagnostics->packetsDiscardedOnSend += (UINT32) ATOMIC_EXCHANGE(&pSendPath->packetsDiscarded, 0);
+        pDiagnostics->bytesDiscardedOnSend += ATOMIC_EXCHANGE(&pSendPath->bytesDiscarded, 0);
+        pDiagnostics->packetsSent += ATOMIC_EXCHANGE(&pSendPath->packetsSent, 0);
+        pDiagnostics->bytesSent += ATOMIC_EXCHANGE(&pSendPath->bytesSent, 0);
+        pDiagnostics->state = pIceCandidatePair->state;
+        pDiagnostics->lastPacketSentTimestamp = pIceCandidatePair->lastDataSentTime;
+    }
+}
+
 STATUS iceAgentPopulateSdpMediaDescriptionCandidates(PIceAgent pIceAgent, PSdpMediaDescription pSdpMediaDescription, UINT32 attrBufferLen,
                                                      PUINT32 pIndex)
 {
@@ -822,23 +1061,26 @@ STATUS iceAgentShutdown(PIceAgent pIceAgent)
     CHK(!ATOMIC_EXCHANGE_BOOL(&pIceAgent->shutdown, TRUE), retStatus);
 
     if (pIceAgent->iceAgentStateTimerTask != MAX_UINT32) {
-        CHK_STATUS(timerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->iceAgentStateTimerTask, (UINT64) pIceAgent));
+        CHK_STATUS(sharedTimerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->iceAgentStateTimerTask, (UINT64) pIceAgent));
         pIceAgent->iceAgentStateTimerTask = MAX_UINT32;
     }
 
     if (pIceAgent->keepAliveTimerTask != MAX_UINT32) {
-        CHK_STATUS(timerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->keepAliveTimerTask, (UINT64) pIceAgent));
+        CHK_STATUS(sharedTimerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->keepAliveTimerTask, (UINT64) pIceAgent));
         pIceAgent->keepAliveTimerTask = MAX_UINT32;
     }
 
     if (pIceAgent->iceCandidateGatheringTimerTask != MAX_UINT32) {
-        CHK_STATUS(timerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->iceCandidateGatheringTimerTask, (UINT64) pIceAgent));
+        CHK_STATUS(sharedTimerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->iceCandidateGatheringTimerTask, (UINT64) pIceAgent));
         pIceAgent->iceCandidateGatheringTimerTask = MAX_UINT32;
     }
 
     MUTEX_LOCK(pIceAgent->lock);
     locked = TRUE;
 
+    /* stop the senders before the sockets are closed */
+    CHK_STATUS(iceAgentUpdateSendPathLocked(pIceAgent));
+
     CHK_STATUS(doubleListGetHeadNode(pIceAgent->localCandidates, &pCurNode));
     while (pCurNode != NULL) {
         pLocalCandidate = (PIceCandidate) pCurNode->data;
@@ -856,6 +1098,8 @@ STATUS iceAgentShutdown(PIceAgent pIceAgent)
     MUTEX_UNLOCK(pIceAgent->lock);
     locked = FALSE;
 
+    iceAgentAwaitSendPathRelease(pIceAgent);
+
     turnShutdownTimeout = GETTIME() + KVS_ICE_TURN_CONNECTION_SHUTDOWN_TIMEOUT;
     while (!turnShutdownCompleted && GETTIME() < turnShutdownTimeout) {
         for (i = 0, turnShutdownCompleted = TRUE; turnShutdownCompleted && i < turnConnectionCount; ++i) {
@@ -910,17 +1154,17 @@ STATUS iceAgentRestart(PIceAgent pIceAgent, PCHAR localIceUfrag, PCHAR localIceP
     CHK(!alreadyRestarting, retStatus);
 
     if (pIceAgent->iceAgentStateTimerTask != MAX_UINT32) {
-        CHK_STATUS(timerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->iceAgentStateTimerTask, (UINT64) pIceAgent));
+        CHK_STATUS(sharedTimerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->iceAgentStateTimerTask, (UINT64) pIceAgent));
         pIceAgent->iceAgentStateTimerTask = MAX_UINT32;
     }
 
     if (pIceAgent->keepAliveTimerTask != MAX_UINT32) {
-        CHK_STATUS(timerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->keepAliveTimerTask, (UINT64) pIceAgent));
+        CHK_STATUS(sharedTimerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->keepAliveTimerTask, (UINT64) pIceAgent));
         pIceAgent->keepAliveTimerTask = MAX_UINT32;
     }
 
     if (pIceAgent->iceCandidateGatheringTimerTask != MAX_UINT32) {
-        CHK_STATUS(timerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->iceCandidateGatheringTimerTask, (UINT64) pIceAgent));
+        CHK_STATUS(sharedTimerQueueCancelTimer(pIceAgent->timerQueueHandle, pIceAgent->iceCandidateGatheringTimerTask, (UINT64) pIceAgent));
         pIceAgent->iceCandidateGatheringTimerTask = MAX_UINT32;
     }
 
@@ -949,6 +1193,7 @@ STATUS iceAgentRestart(PIceAgent pIceAgent, PCHAR localIceUfrag, PCHAR localIceP
     CHK_STATUS(doubleListClear(pIceAgent->localCandidates, FALSE));
 
     /* free all candidate pairs except the selected pair */
+    iceAgentClearIceCandidatePairIndex(pIceAgent);
     CHK_STATUS(doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode));
     while (pCurNode != NULL) {
         pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
@@ -970,6 +1215,7 @@ STATUS iceAgentRestart(PIceAgent pIceAgent, PCHAR localIceUfrag, PCHAR localIceP
 
     /* At this point there should be no thread accessing anything in iceAgent other than
      * pIceAgent->pDataSendingIceCandidatePair and its ice candidates. Therefore safe to proceed freeing resources */
+    iceAgentAwaitSendPathRelease(pIceAgent);
 
     for (i = 0; i < localCandidateCount; ++i) {
         if (pIceAgent->pDataSendingIceCandidatePair == NULL || localCandidates[i] != pIceAgent->pDataSendingIceCandidatePair->local) {
@@ -1008,6 +1254,7 @@ STATUS iceAgentRestart(PIceAgent pIceAgent, PCHAR localIceUfrag, PCHAR localIceP
 
     STRNCPY(pIceAgent->localUsername, localIceUfrag, MAX_ICE_CONFIG_USER_NAME_LEN);
     STRNCPY(pIceAgent->localPassword, localIcePwd, MAX_ICE_CONFIG_CREDENTIAL_LEN);
+    CHK_STATUS(initStunHmacKey(&pIceAgent->localHmacKey, (PBYTE) pIceAgent->localPassword, (UINT32) STRLEN(pIceAgent->localPassword)));
 
     pIceAgent->iceAgentState = ICE_AGENT_STATE_NEW;
     CHK_STATUS(setStateMachineCurrentState(pIceAgent->pStateMachine, ICE_AGENT_STATE_NEW));
@@ -1183,6 +1430,7 @@ STATUS createIceCandidatePairs(PIceAgent pIceAgent, PIceCandidate pIceCandidate,
 
             CHK_STATUS(insertIceCandidatePair(pIceAgent->iceCandidatePairs, pIceCandidatePair));
             freeObjOnFailure = FALSE;
+            iceAgentIndexIceCandidatePair(pIceAgent, pIceCandidatePair);
         }
     }
 
@@ -1263,23 +1511,22 @@ STATUS findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(PIceAgent pIce
     STATUS retStatus = STATUS_SUCCESS;
     UINT32 addrLen;
     PIceCandidatePair pTargetIceCandidatePair = NULL, pIceCandidatePair = NULL;
-    PDoubleListNode pCurNode = NULL;
 
     CHK(pIceAgent != NULL && ppIceCandidatePair != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
 
     addrLen = IS_IPV4_ADDR(pRemoteAddr) ? IPV4_ADDRESS_LENGTH : IPV6_ADDRESS_LENGTH;
 
-    CHK_STATUS(doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode));
-    while (pCurNode != NULL && pTargetIceCandidatePair == NULL) {
-        pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
-        pCurNode = pCurNode->pNext;
-
+    // The port is not part of the key, the bucket holds the pairs in priority order like iceCandidatePairs
+    pIceCandidatePair = pIceAgent->candidatePairIndex[iceCandidatePairIndexBucket(pSocketConnection, pRemoteAddr)];
+    while (pIceCandidatePair != NULL && pTargetIceCandidatePair == NULL) {
         if (pIceCandidatePair->state != ICE_CANDIDATE_PAIR_STATE_FAILED && pIceCandidatePair->local->pSocketConnection == pSocketConnection &&
             pIceCandidatePair->remote->ipAddress.family == pRemoteAddr->family &&
             MEMCMP(pIceCandidatePair->remote->ipAddress.address, pRemoteAddr->address, addrLen) == 0 &&
             (!checkPort || pIceCandidatePair->remote->ipAddress.port == pRemoteAddr->port)) {
             pTargetIceCandidatePair = pIceCandidatePair;
         }
+
+        pIceCandidatePair = pIceCandidatePair->pNextIndexed;
     }
 
 CleanUp:
@@ -1292,6 +1539,86 @@ CleanUp:
     return retStatus;
 }
 
+UINT32 iceCandidatePairIndexBucket(PSocketConnection pSocketConnection, PKvsIpAddress pRemoteAddr)
+{
+    // FNV-1a over the socket connection pointer, the family and the address
+    UINT32 hash = 2166136261U, i, addrLen = IS_IPV4_ADDR(pRemoteAddr) ? IPV4_ADDRESS_LENGTH : IPV6_ADDRESS_LENGTH;
+    UINT64 socketConnection = (UINT64) pSocketConnection;
+
+    for (i = 0; i < SIZEOF(UINT64); i++) {
+        hash = (hash ^ (UINT32) ((socketConnection >> (i * 8)) & 0xff)) * 16777619U;
+    }
+
+    hash = (hash ^ (UINT32) pRemoteAddr->family) * 16777619U;
+    for (i = 0; i < addrLen; i++) {
+        hash = (hash ^ pRemoteAddr->address[i]) * 16777619U;
+    }
+
+    return hash & (ICE_CANDIDATE_PAIR_INDEX_BUCKET_COUNT - 1);
+}
+
+VOID iceAgentIndexIceCandidatePair(PIceAgent pIceAgent, PIceCandidatePair pIceCandidatePair)
+{
+    PIceCandidatePair* ppLink;
+
+    if (pIceAgent == NULL || pIceCandidatePair == NULL || pIceCandidatePair->indexed || pIceCandidatePair->local->pSocketConnection == NULL) {
+        return;
+    }
+
+    pIceCandidatePair->indexBucket = iceCandidatePairIndexBucket(pIceCandidatePair->local->pSocketConnection, &pIceCandidatePair->remote->ipAddress);
+
+    // Same position as insertIceCandidatePair so that the first match of a bucket is the first match of the list
+    ppLink = &pIceAgent->candidatePairIndex[pIceCandidatePair->indexBucket];
+    while (*ppLink != NULL && (*ppLink)->priority > pIceCandidatePair->priority) {
+        ppLink = &(*ppLink)->pNextIndexed;
+    }
+
+    pIceCandidatePair->pNextIndexed = *ppLink;
+    *ppLink = pIceCandidatePair;
+    pIceCandidatePair->indexed = TRUE;
+}
+
+VOID iceAgentUnindexIceCandidatePair(PIceAgent pIceAgent, PIceCandidatePair pIceCandidatePair)
+{
+    PIceCandidatePair* ppLink;
+
+    if (pIceAgent == NULL || pIceCandidatePair == NULL || !pIceCandidatePair->indexed) {
+        return;
+    }
+
+    ppLink = &pIceAgent->candidatePairIndex[pIceCandidatePair->indexBucket];
+    while (*ppLink != NULL && *ppLink != pIceCandidatePair) {
+        ppLink = &(*ppLink)->pNextIndexed;
+    }
+
+    if (*ppLink != NULL) {
+        *ppLink = pIceCandidatePair->pNextIndexed;
+    }
+
+    pIceCandidatePair->pNextIndexed = NULL;
+    pIceCandidatePair->indexed = FALSE;
+}
+
+VOID iceAgentClearIceCandidatePairIndex(PIceAgent pIceAgent)
+{
+    UINT32 i;
+    PIceCandidatePair pIceCandidatePair, pNextIceCandidatePair;
+
+    if (pIceAgent == NULL) {
+        return;
+    }
+
+    for (i = 0; i < ICE_CANDIDATE_PAIR_INDEX_BUCKET_COUNT; i++) {
+        for (pIceCandidatePair = pIceAgent->candidatePairIndex[i]; pIceCandidatePair != NULL; pIceCandidatePair = pNextIceCandidatePair) {
+            pNextIceCandidatePair = pIceCandidatePair->pNextIndexed;
+            pIceCandidatePair->pNextIndexed = NULL;
+            pIceCandidatePair->indexed = FALSE;
+        }
+
+        pIceAgent->candidatePairIndex[i] = NULL;
+    }
+}
+
 STATUS pruneUnconnectedIceCandidatePair(PIceAgent pIceAgent)
 {
     ENTERS();
@@ -1309,6 +1636,7 @@ STATUS pruneUnconnectedIceCandidatePair(PIceAgent pIceAgent)
         if (pIceCandidatePair->state != ICE_CANDIDATE_PAIR_STATE_SUCCEEDED) {
             // backup next node as we will lose that after deleting pCurNode.
             pNextNode = pCurNode->pNext;
+            iceAgentUnindexIceCandidatePair(pIceAgent, pIceCandidatePair);
             CHK_STATUS(freeIceCandidatePair(&pIceCandidatePair));
             CHK_STATUS(doubleListDeleteNode(pIceAgent->iceCandidatePairs, pCurNode));
             pCurNode = pNextNode;
@@ -1360,8 +1688,7 @@ STATUS iceCandidatePairCheckConnection(PStunPacket pStunBindingRequest, PIceAgen
         pIceAgent->pRtcIceServerDiagnostics[pIceCandidatePair->local->iceServerIndex]->totalRequestsSent++;
     }
 
-    CHK_STATUS(iceAgentSendStunPacket(pStunBindingRequest, (PBYTE) pIceAgent->remotePassword,
-                                      (UINT32) STRLEN(pIceAgent->remotePassword) * SIZEOF(CHAR), pIceAgent, pIceCandidatePair->local,
+    CHK_STATUS(iceAgentSendStunPacket(pStunBindingRequest, &pIceAgent->remoteHmacKey, pIceAgent, pIceCandidatePair->local,
                                       &pIceCandidatePair->remote->ipAddress));
 
     if (pIceCandidatePair->pRtcIceCandidatePairDiagnostics != NULL) {
@@ -1375,21 +1702,41 @@ CleanUp:
     return retStatus;
 }
 
-STATUS iceAgentSendStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passwordLen, PIceAgent pIceAgent, PIceCandidate pLocalCandidate,
+STATUS iceAgentSendStunPacket(PStunPacket pStunPacket, PStunHmacKey pHmacKey, PIceAgent pIceAgent, PIceCandidate pLocalCandidate,
                               PKvsIpAddress pDestAddr)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 stunPacketSize = STUN_PACKET_ALLOCATION_SIZE;
+    BYTE stunPacketBuffer[STUN_PACKET_ALLOCATION_SIZE];
+
+    // Assuming holding pIceAgent->lock
+
+    CHK(pStunPacket != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(iceUtilsPackageStunPacketWithHmacKey(pStunPacket, pHmacKey, stunPacketBuffer, &stunPacketSize));
+    CHK_STATUS(iceAgentSendStunBuffer(stunPacketBuffer, stunPacketSize, pIceAgent, pLocalCandidate, pDestAddr));
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+STATUS iceAgentSendStunBuffer(PBYTE pBuffer, UINT32 bufferLen, PIceAgent pIceAgent, PIceCandidate pLocalCandidate, PKvsIpAddress pDestAddr)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PIceCandidatePair pIceCandidatePair = NULL;
 
     // Assuming holding pIceAgent->lock
 
-    CHK(pStunPacket != NULL && pIceAgent != NULL && pLocalCandidate != NULL && pDestAddr != NULL, STATUS_NULL_ARG);
+    CHK(pBuffer != NULL && pIceAgent != NULL && pLocalCandidate != NULL && pDestAddr != NULL, STATUS_NULL_ARG);
 
-    retStatus = iceUtilsSendStunPacket(pStunPacket, password, passwordLen, pDestAddr, pLocalCandidate->pSocketConnection,
-                                       pLocalCandidate->pTurnConnection, pLocalCandidate->iceCandidateType == ICE_CANDIDATE_TYPE_RELAYED);
+    retStatus = iceUtilsSendData(pBuffer, bufferLen, pDestAddr, pLocalCandidate->pSocketConnection, pLocalCandidate->pTurnConnection,
+                                 pLocalCandidate->iceCandidateType == ICE_CANDIDATE_TYPE_RELAYED);
 
     if (STATUS_FAILED(retStatus)) {
-        DLOGW("iceUtilsSendStunPacket failed with 0x%08x", retStatus);
+        DLOGW("iceUtilsSendData failed with 0x%08x", retStatus);
 
         if (retStatus == STATUS_SOCKET_CONNECTION_CLOSED_ALREADY) {
             pLocalCandidate->state = ICE_CANDIDATE_STATE_INVALID;
@@ -1406,6 +1753,7 @@ STATUS iceAgentSendStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 pa
         if (pIceCandidatePair != NULL) {
             DLOGD("mark candidate pair %s_%s as failed", pIceCandidatePair->local->id, pIceCandidatePair->remote->id);
             pIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+            CHK_STATUS(iceAgentUpdateSendPathLocked(pIceAgent));
         }
     } else {
         CHK_STATUS(findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(pIceAgent, pLocalCandidate->pSocketConnection, pDestAddr, TRUE,
@@ -1541,7 +1889,7 @@ STATUS iceAgentSendSrflxCandidateRequest(PIceAgent pIceAgent)
                     transactionIdStoreInsert(pIceAgent->pStunBindingRequestTransactionIdStore, pBindingRequest->header.transactionId);
                     checkSum = COMPUTE_CRC32(pBindingRequest->header.transactionId, ARRAY_SIZE(pBindingRequest->header.transactionId));
 
-                    CHK_STATUS(iceAgentSendStunPacket(pBindingRequest, NULL, 0, pIceAgent, pCandidate, pStunServerAddr));
+                    CHK_STATUS(iceAgentSendStunPacket(pBindingRequest, NULL, pIceAgent, pCandidate, pStunServerAddr));
                     if (pIceAgent->pRtcIceServerDiagnostics[pCandidate->iceServerIndex] != NULL) {
                         pIceAgent->pRtcIceServerDiagnostics[pCandidate->iceServerIndex]->totalRequestsSent++;
                         CHK_STATUS(hashTableUpsert(pIceAgent->requestTimestampDiagnostics, checkSum, GETTIME()));
@@ -1646,7 +1994,7 @@ STATUS iceAgentSendKeepAliveTimerCallback(UINT32 timerId, UINT64 currentTime, UI
         if (pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED) {
             pIceCandidatePair->lastDataSentTime = currentTime;
             DLOGV("send keep alive");
-            CHK_STATUS(iceAgentSendStunPacket(pIceAgent->pBindingIndication, NULL, 0, pIceAgent, pIceCandidatePair->local,
+            CHK_STATUS(iceAgentSendStunPacket(pIceAgent->pBindingIndication, NULL, pIceAgent, pIceCandidatePair->local,
                                               &pIceCandidatePair->remote->ipAddress));
         }
     }
@@ -1897,6 +2245,8 @@ STATUS iceAgentInitSrflxCandidate(PIceAgent pIceAgent)
         CHK_STATUS(createSocketConnection(pCandidate->ipAddress.family, KVS_SOCKET_PROTOCOL_UDP, &pCandidate->ipAddress,
                                           pIceServer->scheme == ICE_SERVER_SCHEME_STUNS ? pStunServerAddress : NULL, (UINT64) pIceAgent,
                                           incomingDataHandler, pIceAgent->kvsRtcConfiguration.sendBufSize, &pCandidate->pSocketConnection));
+        CHK_STATUS(socketConnectionSetBatchCallbacks(pCandidate->pSocketConnection, iceAgentIncomingBatchBegin, iceAgentIncomingBatchEnd));
+        CHK_STATUS(socketConnectionSetEgressStateCallback(pCandidate->pSocketConnection, iceAgentSocketEgressStateChanged));
         ATOMIC_STORE_BOOL(&pCandidate->pSocketConnection->receiveData, TRUE);
         // connectionListener will free the pSocketConnection at the end.
         CHK_STATUS(connectionListenerAddConnection(pIceAgent->pConnectionListener, pCandidate->pSocketConnection));
@@ -2246,23 +2596,33 @@ STATUS iceAgentConnectedStateSetup(PIceAgent pIceAgent)
         ATOMIC_STORE_BOOL(&pIceAgent->restart, FALSE);
         pLastDataSendingIceCandidatePair = pIceAgent->pDataSendingIceCandidatePair;
         pIceAgent->pDataSendingIceCandidatePair = NULL;
+        CHK_STATUS(iceAgentUpdateSendPathLocked(pIceAgent));
 
         MUTEX_UNLOCK(pIceAgent->lock);
         locked = FALSE;
 
+        iceAgentAwaitSendPathRelease(pIceAgent);
+
         /* If pDataSendingIceCandidatePair is not NULL, then it must be the data sending pair before ice restart.
          * Free its resource here since not there is a new connected pair to replace it. */
         if (IS_CANN_PAIR_SENDING_FROM_RELAYED(pLastDataSendingIceCandidatePair)) {
-            CHK_STATUS(turnConnectionShutdown(pLastDataSendingIceCandidatePair->local->pTurnConnection, KVS_ICE_TURN_CONNECTION_SHUTDOWN_TIMEOUT));
-            CHK_STATUS(freeTurnConnection(&pLastDataSendingIceCandidatePair->local->pTurnConnection));
+            /* This runs on the timer queue thread, which also drives the turn deallocation, so do not wait for it here.
+             * Hand the candidate back to the local candidate list, the ready state frees it once the shutdown completes. */
+            CHK_STATUS(turnConnectionShutdown(pLastDataSendingIceCandidatePair->local->pTurnConnection, 0));
+            pLastDataSendingIceCandidatePair->local->state = ICE_CANDIDATE_STATE_INVALID;
 
+            MUTEX_LOCK(pIceAgent->lock);
+            locked = TRUE;
+            CHK_STATUS(doubleListInsertItemTail(pIceAgent->localCandidates, (UINT64) pLastDataSendingIceCandidatePair->local));
+            MUTEX_UNLOCK(pIceAgent->lock);
+            locked = FALSE;
         } else {
             CHK_STATUS(
                 connectionListenerRemoveConnection(pIceAgent->pConnectionListener, pLastDataSendingIceCandidatePair->local->pSocketConnection));
             CHK_STATUS(freeSocketConnection(&pLastDataSendingIceCandidatePair->local->pSocketConnection));
+            MEMFREE(pLastDataSendingIceCandidatePair->local);
         }
 
-        MEMFREE(pLastDataSendingIceCandidatePair->local);
         CHK_STATUS(freeIceCandidatePair(&pLastDataSendingIceCandidatePair));
     }
 
@@ -2280,10 +2640,11 @@ STATUS iceAgentConnectedStateSetup(PIceAgent pIceAgent)
             break;
         }
     }
+    CHK_STATUS(iceAgentUpdateSendPathLocked(pIceAgent));
 
     // schedule sending keep alive
-    CHK_STATUS(timerQueueAddTimer(pIceAgent->timerQueueHandle, KVS_ICE_DEFAULT_TIMER_START_DELAY, KVS_ICE_SEND_KEEP_ALIVE_INTERVAL,
-                                  iceAgentSendKeepAliveTimerCallback, (UINT64) pIceAgent, &pIceAgent->keepAliveTimerTask));
+    CHK_STATUS(sharedTimerQueueAddTimer(pIceAgent->timerQueueHandle, KVS_ICE_DEFAULT_TIMER_START_DELAY, KVS_ICE_SEND_KEEP_ALIVE_INTERVAL,
+                                        iceAgentSendKeepAliveTimerCallback, (UINT64) pIceAgent, &pIceAgent->keepAliveTimerTask));
 
 CleanUp:
 
@@ -2355,8 +2716,8 @@ STATUS iceAgentReadyStateSetup(PIceAgent pIceAgent)
 
     CHK(pIceAgent != NULL, STATUS_NULL_ARG);
 
-    CHK_STATUS(timerQueueUpdateTimerPeriod(pIceAgent->timerQueueHandle, (UINT64) pIceAgent, pIceAgent->iceAgentStateTimerTask,
-                                           KVS_ICE_STATE_READY_TIMER_POLLING_INTERVAL));
+    CHK_STATUS(sharedTimerQueueUpdateTimerPeriod(pIceAgent->timerQueueHandle, (UINT64) pIceAgent, pIceAgent->iceAgentStateTimerTask,
+                                                 KVS_ICE_STATE_READY_TIMER_POLLING_INTERVAL));
 
     MUTEX_LOCK(pIceAgent->lock);
     locked = TRUE;
@@ -2381,6 +2742,7 @@ STATUS iceAgentReadyStateSetup(PIceAgent pIceAgent)
         // Set to stop gathering
         ATOMIC_STORE_BOOL(&pIceAgent->stopGathering, TRUE);
     }
+    CHK_STATUS(iceAgentUpdateSendPathLocked(pIceAgent));
 
     CHK_STATUS(getIpAddrStr(&pIceAgent->pDataSendingIceCandidatePair->local->ipAddress, ipAddrStr, ARRAY_SIZE(ipAddrStr)));
     DLOGP("Selected pair %s_%s, local candidate type: %s. remote candidate type: %s. Round trip time %u ms. Local candidate priority: %u, ice "
@@ -2420,6 +2782,7 @@ STATUS iceAgentReadyStateSetup(PIceAgent pIceAgent)
         pCurNode = pCurNode->pNext;
 
         if (pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_FAILED) {
+            iceAgentUnindexIceCandidatePair(pIceAgent, pIceCandidatePair);
             freeIceCandidatePair(&pIceCandidatePair);
             doubleListDeleteNode(pIceAgent->iceCandidatePairs, pNodeToDelete);
         }
@@ -2520,6 +2883,8 @@ STATUS iceAgentInvalidateCandidatePair(PIceAgent pIceAgent)
         }
     }
 
+    CHK_STATUS(iceAgentUpdateSendPathLocked(pIceAgent));
+
 CleanUp:
 
     CHK_LOG_ERR(retStatus);
@@ -2558,17 +2923,33 @@ STATUS incomingDataHandler(UINT64 customData, PSocketConnection pSocketConnectio
     STATUS retStatus = STATUS_SUCCESS;
     PIceAgent pIceAgent = (PIceAgent) customData;
     PSocketConnection pSocketConnectionToShutdown = NULL;
-    BOOL locked = FALSE;
-    UINT32 addrLen = 0;
+    PSocketConnectionReceiveBatch pReceiveBatch = NULL;
+    BOOL locked = FALSE, isStunPacket;
     CHK(pIceAgent != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
 
+    // for stun packets, first 8 bytes are 4 byte type and length, then 4 byte magic byte
+    isStunPacket = bufferLen >= 8 && IS_STUN_PACKET(pBuffer);
+
+    // Within a receive batch, media from the batch's remote address is handed off without taking the agent lock.
+    // The bookkeeping is accumulated on the socket and committed under a single lock by iceAgentIncomingBatchEnd.
+    pReceiveBatch = &pSocketConnection->receiveBatch;
+    if (pReceiveBatch->active && !isStunPacket && pIceAgent->iceAgentCallbacks.inboundPacketFn != NULL && pSrc != NULL &&
+        (pReceiveBatch->packetCount == 0 || isSameIpAddress(&pReceiveBatch->srcAddr, pSrc, TRUE))) {
+        if (pReceiveBatch->packetCount == 0) {
+            pReceiveBatch->srcAddr = *pSrc;
+        }
+        pReceiveBatch->packetCount++;
+        pReceiveBatch->byteCount += bufferLen;
+        pIceAgent->iceAgentCallbacks.inboundPacketFn(pIceAgent->iceAgentCallbacks.customData, pBuffer, bufferLen);
+        CHK(FALSE, retStatus);
+    }
+
     MUTEX_LOCK(pIceAgent->lock);
     locked = TRUE;
 
     pIceAgent->lastDataReceivedTime = GETTIME();
 
-    // for stun packets, first 8 bytes are 4 byte type and length, then 4 byte magic byte
-    if ((bufferLen < 8 || !IS_STUN_PACKET(pBuffer)) && pIceAgent->iceAgentCallbacks.inboundPacketFn != NULL) {
+    if (!isStunPacket && pIceAgent->iceAgentCallbacks.inboundPacketFn != NULL) {
         // release lock early
 
         MUTEX_UNLOCK(pIceAgent->lock);
@@ -2577,19 +2958,7 @@ STATUS incomingDataHandler(UINT64 customData, PSocketConnection pSocketConnectio
 
         MUTEX_LOCK(pIceAgent->lock);
         locked = TRUE;
-        addrLen = IS_IPV4_ADDR(pSrc) ? IPV4_ADDRESS_LENGTH : IPV6_ADDRESS_LENGTH;
-        if (pIceAgent->pDataSendingIceCandidatePair != NULL &&
-            pIceAgent->pDataSendingIceCandidatePair->local->pSocketConnection == pSocketConnection &&
-            pIceAgent->pDataSendingIceCandidatePair->remote->ipAddress.family == pSrc->family &&
-            MEMCMP(pIceAgent->pDataSendingIceCandidatePair->remote->ipAddress.address, pSrc->address, addrLen) == 0 &&
-            (pIceAgent->pDataSendingIceCandidatePair->remote->ipAddress.port == pSrc->port)) {
-            if (pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics != NULL) {
-                pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->lastPacketReceivedTimestamp = GETTIME();
-                pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->bytesReceived += bufferLen;
-                pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics
-                    ->packetsReceived++; // Since every byte buffer translates to a single RTP packet
-            }
-        }
+        iceAgentUpdateReceivedStatsLocked(pIceAgent, pSocketConnection, pSrc, bufferLen, 1, GETTIME());
     } else {
         if (ATOMIC_LOAD_BOOL(&pIceAgent->processStun)) {
             CHK_STATUS(handleStunPacket(pIceAgent, pBuffer, bufferLen, pSocketConnection, pSrc, pDest, &pSocketConnectionToShutdown));
@@ -2610,6 +2979,78 @@ CleanUp:
     return retStatus;
 }
 
+STATUS iceAgentIncomingBatchBegin(UINT64 customData, PSocketConnection pSocketConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(customData != 0 && pSocketConnection != NULL, STATUS_NULL_ARG);
+
+    MEMSET(&pSocketConnection->receiveBatch, 0x00, SIZEOF(SocketConnectionReceiveBatch));
+    pSocketConnection->receiveBatch.active = TRUE;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS iceAgentIncomingBatchEnd(UINT64 customData, PSocketConnection pSocketConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceAgent pIceAgent = (PIceAgent) customData;
+    PSocketConnectionReceiveBatch pReceiveBatch = NULL;
+    UINT64 currentTime;
+
+    CHK(pIceAgent != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
+
+    pReceiveBatch = &pSocketConnection->receiveBatch;
+    if (pReceiveBatch->packetCount > 0) {
+        MUTEX_LOCK(pIceAgent->lock);
+        currentTime = GETTIME();
+        pIceAgent->lastDataReceivedTime = currentTime;
+        iceAgentUpdateReceivedStatsLocked(pIceAgent, pSocketConnection, &pReceiveBatch->srcAddr, pReceiveBatch->byteCount,
+                                          pReceiveBatch->packetCount, currentTime);
+        MUTEX_UNLOCK(pIceAgent->lock);
+    }
+
+    MEMSET(pReceiveBatch, 0x00, SIZEOF(SocketConnectionReceiveBatch));
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * Forward the backpressure of a local socket. Invoked from the sending thread, possibly with the agent lock held, or from
+ * the connection listener thread, so the agent lock is not taken.
+ */
+VOID iceAgentSocketEgressStateChanged(UINT64 customData, PSocketConnection pSocketConnection, BOOL backpressured)
+{
+    PIceAgent pIceAgent = (PIceAgent) customData;
+
+    if (pIceAgent == NULL || pSocketConnection == NULL) {
+        return;
+    }
+
+    DLOGD("Socket %d %s", pSocketConnection->localSocket, backpressured ? "is backpressured" : "is writable again");
+    if (pIceAgent->iceAgentCallbacks.egressStateChangedFn != NULL) {
+        pIceAgent->iceAgentCallbacks.egressStateChangedFn(pIceAgent->iceAgentCallbacks.customData, backpressured);
+    }
+}
+
+VOID iceAgentUpdateReceivedStatsLocked(PIceAgent pIceAgent, PSocketConnection pSocketConnection, PKvsIpAddress pSrc, UINT64 byteCount,
+                                       UINT32 packetCount, UINT64 currentTime)
+{
+    PIceCandidatePair pIceCandidatePair = pIceAgent->pDataSendingIceCandidatePair;
+
+    if (pSrc != NULL && pIceCandidatePair != NULL && pIceCandidatePair->local->pSocketConnection == pSocketConnection &&
+        isSameIpAddress(&pIceCandidatePair->remote->ipAddress, pSrc, TRUE) && pIceCandidatePair->pRtcIceCandidatePairDiagnostics != NULL) {
+        pIceCandidatePair->pRtcIceCandidatePairDiagnostics->lastPacketReceivedTimestamp = currentTime;
+        pIceCandidatePair->pRtcIceCandidatePairDiagnostics->bytesReceived += byteCount;
+        // Since every byte buffer translates to a single RTP packet
+        pIceCandidatePair->pRtcIceCandidatePairDiagnostics->packetsReceived += packetCount;
+    }
+}
+
 STATUS iceCandidateSerialize(PIceCandidate pIceCandidate, PCHAR pOutputData, PUINT32 pOutputLength)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -2657,12 +3098,13 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
     UNUSED_PARAM(pDestAddr);
 
     STATUS retStatus = STATUS_SUCCESS;
-    PStunPacket pStunPacket = NULL, pStunResponse = NULL;
-    PStunAttributeHeader pStunAttr = NULL;
+    StunPacketView stunPacketView;
+    PStunAttributeView pStunAttributeView = NULL;
+    KvsIpAddress mappedAddress;
+    BYTE stunResponseBuffer[STUN_PACKET_ALLOCATION_SIZE];
+    UINT32 stunResponseSize = ARRAY_SIZE(stunResponseBuffer);
     UINT16 stunPacketType = 0;
     PIceCandidatePair pIceCandidatePair = NULL;
-    PStunAttributeAddress pStunAttributeAddress = NULL;
-    PStunAttributePriority pStunAttributePriority = NULL;
     UINT32 priority = 0;
     PIceCandidate pIceCandidate = NULL;
     CHAR ipAddrStr[KVS_IP_ADDRESS_STRING_BUFFER_LEN], ipAddrStr2[KVS_IP_ADDRESS_STRING_BUFFER_LEN];
@@ -2683,22 +3125,20 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
     switch (stunPacketType) {
         case STUN_PACKET_TYPE_BINDING_REQUEST:
             connectivityCheckRequestsReceived++;
-            CHK_STATUS(deserializeStunPacket(pBuffer, bufferLen, (PBYTE) pIceAgent->localPassword,
-                                             (UINT32) STRLEN(pIceAgent->localPassword) * SIZEOF(CHAR), &pStunPacket));
-            CHK_STATUS(createStunPacket(STUN_PACKET_TYPE_BINDING_RESPONSE_SUCCESS, pStunPacket->header.transactionId, &pStunResponse));
-            CHK_STATUS(appendStunAddressAttribute(pStunResponse, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, pSrcAddr));
-            CHK_STATUS(appendStunIceControllAttribute(
-                pStunResponse, pIceAgent->isControlling ? STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING : STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED,
-                pIceAgent->tieBreaker));
-
-            CHK_STATUS(getStunAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_PRIORITY, (PStunAttributeHeader*) &pStunAttributePriority));
-            priority = pStunAttributePriority == NULL ? 0 : pStunAttributePriority->priority;
+            // Parsed in place and answered from a stack buffer, nothing is allocated for a connectivity check
+            CHK_STATUS(parseStunPacketView(pBuffer, bufferLen, &pIceAgent->localHmacKey, &stunPacketView));
+
+            CHK_STATUS(getStunPacketViewAttribute(&stunPacketView, STUN_ATTRIBUTE_TYPE_PRIORITY, &pStunAttributeView));
+            priority = pStunAttributeView == NULL ? 0 : (UINT32) getInt32(*(PINT32) pStunAttributeView->pValue);
             CHK_STATUS(iceAgentCheckPeerReflexiveCandidate(pIceAgent, pSrcAddr, priority, TRUE, 0));
 
             CHK_STATUS(findCandidateWithSocketConnection(pSocketConnection, pIceAgent->localCandidates, &pIceCandidate));
             CHK_WARN(pIceCandidate != NULL, retStatus, "Could not find local candidate to send STUN response");
-            CHK_STATUS(iceAgentSendStunPacket(pStunResponse, (PBYTE) pIceAgent->localPassword,
-                                              (UINT32) STRLEN(pIceAgent->localPassword) * SIZEOF(CHAR), pIceAgent, pIceCandidate, pSrcAddr));
+            CHK_STATUS(serializeStunBindingResponse(stunPacketView.transactionId, pSrcAddr,
+                                                    pIceAgent->isControlling ? STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING
+                                                                             : STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED,
+                                                    pIceAgent->tieBreaker, &pIceAgent->localHmacKey, stunResponseBuffer, &stunResponseSize));
+            CHK_STATUS(iceAgentSendStunBuffer(stunResponseBuffer, stunResponseSize, pIceAgent, pIceCandidate, pSrcAddr));
 
             connectivityCheckResponsesSent++;
             // return early if there is no candidate pair. This can happen when we get connectivity check from the peer
@@ -2708,8 +3148,8 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
             DLOGD("Pair binding request! %s %s", pIceCandidatePair->local->id, pIceCandidatePair->remote->id);
 
             if (!pIceCandidatePair->nominated) {
-                CHK_STATUS(getStunAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_USE_CANDIDATE, &pStunAttr));
-                if (pStunAttr != NULL) {
+                CHK_STATUS(getStunPacketViewAttribute(&stunPacketView, STUN_ATTRIBUTE_TYPE_USE_CANDIDATE, &pStunAttributeView));
+                if (pStunAttributeView != NULL) {
                     DLOGI("received candidate with USE_CANDIDATE flag, local candidate type %s(%s:%s).",
                           iceAgentGetCandidateTypeStr(pIceCandidatePair->local->iceCandidateType), pIceCandidatePair->local->id,
                           pIceCandidatePair->remote->id);
@@ -2758,14 +3198,13 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
                     }
                 }
 
-                CHK_STATUS(deserializeStunPacket(pBuffer, bufferLen, NULL, 0, &pStunPacket));
-                CHK_STATUS(getStunAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, &pStunAttr));
-                CHK_WARN(pStunAttr != NULL, retStatus, "No mapped address attribute found in STUN binding response. Dropping Packet");
-
-                pStunAttributeAddress = (PStunAttributeAddress) pStunAttr;
+                CHK_STATUS(parseStunPacketView(pBuffer, bufferLen, NULL, &stunPacketView));
+                CHK_STATUS(getStunPacketViewAttribute(&stunPacketView, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, &pStunAttributeView));
+                CHK_WARN(pStunAttributeView != NULL, retStatus, "No mapped address attribute found in STUN binding response. Dropping Packet");
+                CHK_STATUS(getStunPacketViewAddress(&stunPacketView, pStunAttributeView, &mappedAddress));
 
                 // Update the server reflexive address which later will be picked up by the timer callback
-                CHK_STATUS(updateCandidateAddress(pIceCandidate, &pStunAttributeAddress->address));
+                CHK_STATUS(updateCandidateAddress(pIceCandidate, &mappedAddress));
 
                 if (pIceAgent->iceServers[pIceCandidate->iceServerIndex].scheme == ICE_SERVER_SCHEME_STUNS) {
                     // Shut down the DTLS session after releasing the ICE agent lock to avoid inverting the
@@ -2829,16 +3268,14 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
                     }
                 }
             }
-            CHK_STATUS(deserializeStunPacket(pBuffer, bufferLen, (PBYTE) pIceAgent->remotePassword,
-                                             (UINT32) STRLEN(pIceAgent->remotePassword) * SIZEOF(CHAR), &pStunPacket));
-            CHK_STATUS(getStunAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, &pStunAttr));
-            CHK_WARN(pStunAttr != NULL, retStatus, "No mapped address attribute found in STUN response. Dropping Packet");
-
-            pStunAttributeAddress = (PStunAttributeAddress) pStunAttr;
+            CHK_STATUS(parseStunPacketView(pBuffer, bufferLen, &pIceAgent->remoteHmacKey, &stunPacketView));
+            CHK_STATUS(getStunPacketViewAttribute(&stunPacketView, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, &pStunAttributeView));
+            CHK_WARN(pStunAttributeView != NULL, retStatus, "No mapped address attribute found in STUN response. Dropping Packet");
+            CHK_STATUS(getStunPacketViewAddress(&stunPacketView, pStunAttributeView, &mappedAddress));
 
             if (pIceCandidatePair->local->iceCandidateType == ICE_CANDIDATE_TYPE_SERVER_REFLEXIVE &&
                 pIceCandidatePair->remote->iceCandidateType == ICE_CANDIDATE_TYPE_SERVER_REFLEXIVE &&
-                !isSameIpAddress(&pStunAttributeAddress->address, &pIceCandidatePair->local->ipAddress, FALSE)) {
+                !isSameIpAddress(&mappedAddress, &pIceCandidatePair->local->ipAddress, FALSE)) {
                 // this can happen for host and server reflexive candidates. If the peer
                 // is in the same subnet, server reflexive candidate's binding response's xor mapped IP address will be
                 // the host candidate IP address. In this case we will ignore the packet since the host candidate will
@@ -2846,13 +3283,15 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
                 DLOGD("local candidate IP address does not match with xor mapped address in binding response");
 
                 // we have a peer reflexive local candidate
-                CHK_STATUS(iceAgentCheckPeerReflexiveCandidate(pIceAgent, &pStunAttributeAddress->address, pIceCandidatePair->local->priority, FALSE,
-                                                               pSocketConnection));
+                CHK_STATUS(
+                    iceAgentCheckPeerReflexiveCandidate(pIceAgent, &mappedAddress, pIceCandidatePair->local->priority, FALSE, pSocketConnection));
             }
 
             if (pIceCandidatePair->state != ICE_CANDIDATE_PAIR_STATE_SUCCEEDED) {
                 DLOGD("Pair succeeded! %s %s", pIceCandidatePair->local->id, pIceCandidatePair->remote->id);
                 pIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_SUCCEEDED;
+                // Resumes the sending on the selected pair if it had failed
+                CHK_STATUS(iceAgentUpdateSendPathLocked(pIceAgent));
                 retStatus = hashTableGet(pIceCandidatePair->requestSentTime, checkSum, &requestSentTime);
                 if (hashTableGet(pIceCandidatePair->requestSentTime, checkSum, &requestSentTime) == STATUS_SUCCESS) {
                     pIceCandidatePair->roundTripTime = GETTIME() - requestSentTime;
@@ -2916,14 +3355,6 @@ CleanUp:
 
     SAFE_MEMFREE(hexStr);
 
-    if (pStunPacket != NULL) {
-        freeStunPacket(&pStunPacket);
-    }
-
-    if (pStunResponse != NULL) {
-        freeStunPacket(&pStunResponse);
-    }
-
     // TODO send error packet
 
     return retStatus;
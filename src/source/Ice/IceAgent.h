@@ -59,6 +59,9 @@ extern "C" {
 
 #define ICE_CANDIDATE_ID_LEN 8
 
+// Buckets of the index of the candidate pairs by local socket and remote address. A power of two
+#define ICE_CANDIDATE_PAIR_INDEX_BUCKET_COUNT 256
+
 #define STATS_NOT_APPLICABLE_STR (PCHAR) "N/A"
 
 #define ICE_STATE_MACHINE_NAME (PCHAR) "ICE"
@@ -72,6 +75,7 @@ typedef enum {
 typedef VOID (*IceInboundPacketFunc)(UINT64, PBYTE, UINT32);
 typedef VOID (*IceConnectionStateChangedFunc)(UINT64, UINT64);
 typedef VOID (*IceNewLocalCandidateFunc)(UINT64, PCHAR);
+typedef VOID (*IceEgressStateChangedFunc)(UINT64, BOOL);
 
 typedef struct __IceAgent IceAgent;
 typedef struct __IceAgent* PIceAgent;
@@ -143,6 +147,8 @@ typedef struct {
     IceConnectionStateChangedFunc connectionStateChangedFn;
     IceNewLocalCandidateFunc newLocalCandidateFn;
     IceServerSetIpFunc setStunServerIpFn;
+    // Invoked when a local socket starts (TRUE) or stops (FALSE) queueing outbound packets, must not block
+    IceEgressStateChangedFunc egressStateChangedFn;
 } IceAgentCallbacks, *PIceAgentCallbacks;
 
 typedef struct {
@@ -170,7 +176,8 @@ typedef struct {
     KVS_SOCKET_PROTOCOL remoteProtocol;
 } IceCandidate, *PIceCandidate;
 
-typedef struct {
+typedef struct __IceCandidatePair IceCandidatePair;
+struct __IceCandidatePair {
     PIceCandidate local;
     PIceCandidate remote;
     BOOL nominated;
@@ -183,7 +190,37 @@ typedef struct {
     UINT64 roundTripTime;
     UINT64 responsesReceived;
     PRtcIceCandidatePairDiagnostics pRtcIceCandidatePairDiagnostics;
-} IceCandidatePair, *PIceCandidatePair;
+
+    // Whether the pair is in the candidate pair index of the agent, in bucket indexBucket
+    BOOL indexed;
+    UINT32 indexBucket;
+    // Next pair of the same bucket, in the order of iceCandidatePairs
+    struct __IceCandidatePair* pNextIndexed;
+};
+typedef struct __IceCandidatePair* PIceCandidatePair;
+
+/**
+ * Send state of the data sending pair, published by the agent so that media senders do not take pIceAgent->lock.
+ * Never modified once published, a new snapshot replaces it when the pair changes. Freed with the last reference.
+ */
+typedef struct {
+    volatile SIZE_T refCount;
+    // Only dereferenced with pIceAgent->lock held while this send path is published
+    PIceCandidatePair pIceCandidatePair;
+    PSocketConnection pSocketConnection;
+    struct __TurnConnection* pTurnConnection;
+    BOOL isRelay;
+    KvsIpAddress remoteAddress;
+    UINT64 publishTime;
+
+    // Updated by the senders, folded into the diagnostics of the pair by the agent
+    volatile SIZE_T packetsSent;
+    volatile SIZE_T bytesSent;
+    volatile SIZE_T packetsDiscarded;
+    volatile SIZE_T bytesDiscarded;
+    // Milliseconds after publishTime plus one, 0 until data is sent
+    volatile SIZE_T lastDataSentTime;
+} IceSendPath, *PIceSendPath;
 
 typedef struct {
     UINT64 localCandidateGatheringTime;
@@ -211,6 +248,8 @@ struct __IceAgent {
     CHAR remoteUsername[MAX_ICE_CONFIG_USER_NAME_LEN + 1];
     CHAR remotePassword[MAX_ICE_CONFIG_CREDENTIAL_LEN + 1];
     CHAR combinedUserName[(MAX_ICE_CONFIG_USER_NAME_LEN + 1) << 1]; //!< the combination of remote user name and local user name.
+    StunHmacKey localHmacKey;                                        //!< message integrity key schedule of localPassword
+    StunHmacKey remoteHmacKey;                                       //!< message integrity key schedule of remotePassword
 
     PRtcIceServerDiagnostics pRtcIceServerDiagnostics[MAX_ICE_SERVERS_COUNT];
     PRtcIceCandidateDiagnostics pRtcSelectedLocalIceCandidateDiagnostics;
@@ -224,6 +263,8 @@ struct __IceAgent {
     // store PIceCandidatePair which will be immediately checked for connectivity when the timer is fired.
     PStackQueue triggeredCheckQueue;
     PDoubleList iceCandidatePairs;
+    // iceCandidatePairs hashed by local socket connection and remote address, so that inbound packets do not scan the pairs
+    PIceCandidatePair candidatePairIndex[ICE_CANDIDATE_PAIR_INDEX_BUCKET_COUNT];
 
     PConnectionListener pConnectionListener;
     BOOL isControlling;
@@ -244,6 +285,13 @@ struct __IceAgent {
     UINT64 stateEndTime;
     UINT64 candidateGatheringEndTime;
     PIceCandidatePair pDataSendingIceCandidatePair;
+    // Snapshot of pDataSendingIceCandidatePair for the senders, NULL when it can not send. sendPathLock only guards taking
+    // a reference, the agent publishes while holding lock
+    PIceSendPath pSendPath;
+    MUTEX sendPathLock;
+    // Replaced send paths still referenced by a sender, guarded by sendPathLock. Signaled when one is released
+    UINT32 retiredSendPathCount;
+    CVAR sendPathReleasedCvar;
 
     IceAgentCallbacks iceAgentCallbacks;
 
@@ -345,6 +393,7 @@ STATUS iceCandidateSerialize(PIceCandidate, PCHAR, PUINT32);
 
 /**
  * Send data through selected connection. PIceAgent has to be in ICE_AGENT_CONNECTION_STATE_CONNECTED state.
+ * Does not take the lock of the agent, the selected pair is read from the published pSendPath.
  *
  * @param - PIceAgent - IN - IceAgent object
  * @param - PBYTE - IN - buffer storing the data to be sent
@@ -354,6 +403,21 @@ STATUS iceCandidateSerialize(PIceCandidate, PCHAR, PUINT32);
  */
 STATUS iceAgentSendPacket(PIceAgent, PBYTE, UINT32);
 
+/**
+ * Send several packets through selected connection with a single pass over the agent and socket locks. On a direct UDP
+ * pair the packets leave through one batched socket send, relayed pairs send them one at a time through TURN.
+ * PIceAgent has to be in ICE_AGENT_CONNECTION_STATE_CONNECTED state.
+ *
+ * @param - PIceAgent - IN - IceAgent object
+ * @param - PBYTE* - IN - buffers storing the packets to be sent, in order
+ * @param - PUINT32 - IN - length of each packet
+ * @param - UINT32 - IN - number of packets
+ * @param - SOCKET_EGRESS_PRIORITY - IN - drop priority of the packets should the socket have to queue them
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS iceAgentSendPacketBatch(PIceAgent, PBYTE*, PUINT32, UINT32, SOCKET_EGRESS_PRIORITY);
+
 /**
  * gather local IP addresses and create a udp port. If port creation succeeded then create a new candidate
  * and store it in localCandidates. Ips that are already a local candidate will not be added again.
@@ -406,6 +470,10 @@ STATUS iceAgentValidateKvsRtcConfig(PKvsRtcConfiguration);
 // Incoming data handling functions
 STATUS incomingDataHandler(UINT64, PSocketConnection, PBYTE, UINT32, PKvsIpAddress, PKvsIpAddress);
 STATUS incomingRelayedDataHandler(UINT64, PSocketConnection, PBYTE, UINT32, PKvsIpAddress, PKvsIpAddress);
+STATUS iceAgentIncomingBatchBegin(UINT64, PSocketConnection);
+STATUS iceAgentIncomingBatchEnd(UINT64, PSocketConnection);
+VOID iceAgentSocketEgressStateChanged(UINT64, PSocketConnection, BOOL);
+VOID iceAgentUpdateReceivedStatsLocked(PIceAgent, PSocketConnection, PKvsIpAddress, UINT64, UINT32, UINT64);
 STATUS handleStunPacket(PIceAgent, PBYTE, UINT32, PSocketConnection, PKvsIpAddress, PKvsIpAddress, PSocketConnection*);
 
 // IceCandidate functions
@@ -419,12 +487,25 @@ STATUS freeIceCandidatePair(PIceCandidatePair*);
 STATUS insertIceCandidatePair(PDoubleList, PIceCandidatePair);
 STATUS findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(PIceAgent, PSocketConnection, PKvsIpAddress, BOOL, PIceCandidatePair*);
 STATUS pruneUnconnectedIceCandidatePair(PIceAgent);
+UINT32 iceCandidatePairIndexBucket(PSocketConnection, PKvsIpAddress);
+VOID iceAgentIndexIceCandidatePair(PIceAgent, PIceCandidatePair);
+VOID iceAgentUnindexIceCandidatePair(PIceAgent, PIceCandidatePair);
+VOID iceAgentClearIceCandidatePairIndex(PIceAgent);
 STATUS iceCandidatePairCheckConnection(PStunPacket, PIceAgent, PIceCandidatePair);
 
+// Selected pair send path functions
+STATUS iceAgentUpdateSendPathLocked(PIceAgent);
+STATUS iceAgentSetSendPathLocked(PIceAgent, PIceCandidatePair);
+VOID iceAgentAcquireSendPath(PIceAgent, PIceSendPath*);
+VOID iceAgentReleaseSendPath(PIceAgent, PIceSendPath*);
+VOID iceAgentAwaitSendPathRelease(PIceAgent);
+VOID iceSendPathCollectStats(PIceSendPath);
+
 STATUS iceAgentSendSrflxCandidateRequest(PIceAgent);
 STATUS iceAgentCheckCandidatePairConnection(PIceAgent);
 STATUS iceAgentSendCandidateNomination(PIceAgent);
-STATUS iceAgentSendStunPacket(PStunPacket, PBYTE, UINT32, PIceAgent, PIceCandidate, PKvsIpAddress);
+STATUS iceAgentSendStunPacket(PStunPacket, PStunHmacKey, PIceAgent, PIceCandidate, PKvsIpAddress);
+STATUS iceAgentSendStunBuffer(PBYTE, UINT32, PIceAgent, PIceCandidate, PKvsIpAddress);
 
 STATUS iceAgentInitHostCandidate(PIceAgent);
 STATUS iceAgentInitSrflxCandidate(PIceAgent);
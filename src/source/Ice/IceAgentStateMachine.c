@@ -561,6 +561,7 @@ STATUS executeReadyIceAgentState(UINT64 customData, UINT64 time)
 
         if (pIceCandidate->iceCandidateType == ICE_CANDIDATE_TYPE_RELAYED && turnConnectionIsShutdownComplete(pIceCandidate->pTurnConnection)) {
             MUTEX_UNLOCK(pIceAgent->lock);
+            iceAgentAwaitSendPathRelease(pIceAgent);
             CHK_LOG_ERR(freeTurnConnection(&pIceCandidate->pTurnConnection));
             MUTEX_LOCK(pIceAgent->lock);
             MEMFREE(pIceCandidate);
@@ -41,10 +41,15 @@ STATUS createTransactionIdStore(UINT32 maxIdCount, PTransactionIdStore* ppTransa
     CHK(ppTransactionIdStore != NULL, STATUS_NULL_ARG);
     CHK(maxIdCount < MAX_STORED_TRANSACTION_ID_COUNT && maxIdCount > 0, STATUS_INVALID_ARG);
 
-    pTransactionIdStore = (PTransactionIdStore) MEMCALLOC(1, SIZEOF(TransactionIdStore) + STUN_TRANSACTION_ID_LEN * maxIdCount);
+    // The ids, the bucket heads, the bucket links and the used flags follow the struct in the same allocation
+    pTransactionIdStore = (PTransactionIdStore) MEMCALLOC(
+        1, SIZEOF(TransactionIdStore) + (STUN_TRANSACTION_ID_LEN + SIZEOF(UINT32) + SIZEOF(UINT32) + SIZEOF(BOOL)) * maxIdCount);
     CHK(pTransactionIdStore != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
     pTransactionIdStore->transactionIds = (PBYTE) (pTransactionIdStore + 1);
+    pTransactionIdStore->bucketHeads = (PUINT32) (pTransactionIdStore->transactionIds + STUN_TRANSACTION_ID_LEN * maxIdCount);
+    pTransactionIdStore->slotNext = pTransactionIdStore->bucketHeads + maxIdCount;
+    pTransactionIdStore->slotUsed = (PBOOL) (pTransactionIdStore->slotNext + maxIdCount);
     pTransactionIdStore->maxTransactionIdsCount = maxIdCount;
 
 CleanUp:
@@ -83,13 +88,22 @@ CleanUp:
 
 VOID transactionIdStoreInsert(PTransactionIdStore pTransactionIdStore, PBYTE transactionId)
 {
-    PBYTE storeLocation = NULL;
+    UINT32 slot, bucket;
 
     CHECK(pTransactionIdStore != NULL);
 
-    storeLocation = pTransactionIdStore->transactionIds +
-        ((pTransactionIdStore->nextTransactionIdIndex % pTransactionIdStore->maxTransactionIdsCount) * STUN_TRANSACTION_ID_LEN);
-    MEMCPY(storeLocation, transactionId, STUN_TRANSACTION_ID_LEN);
+    slot = pTransactionIdStore->nextTransactionIdIndex % pTransactionIdStore->maxTransactionIdsCount;
+
+    // The oldest id is overwritten once the ring is full
+    if (pTransactionIdStore->slotUsed[slot]) {
+        transactionIdStoreUnlinkSlot(pTransactionIdStore, slot);
+    }
+
+    MEMCPY(pTransactionIdStore->transactionIds + slot * STUN_TRANSACTION_ID_LEN, transactionId, STUN_TRANSACTION_ID_LEN);
+    bucket = transactionIdStoreGetBucket(pTransactionIdStore, transactionId);
+    pTransactionIdStore->slotNext[slot] = pTransactionIdStore->bucketHeads[bucket];
+    pTransactionIdStore->bucketHeads[bucket] = slot + 1;
+    pTransactionIdStore->slotUsed[slot] = TRUE;
 
     pTransactionIdStore->nextTransactionIdIndex = (pTransactionIdStore->nextTransactionIdIndex + 1) % pTransactionIdStore->maxTransactionIdsCount;
 
@@ -104,35 +118,22 @@ VOID transactionIdStoreInsert(PTransactionIdStore pTransactionIdStore, PBYTE tra
 
 BOOL transactionIdStoreHasId(PTransactionIdStore pTransactionIdStore, PBYTE transactionId)
 {
-    BOOL idFound = FALSE;
-    UINT32 i, j;
+    UINT32 slot;
 
     CHECK(pTransactionIdStore != NULL);
 
-    for (i = pTransactionIdStore->earliestTransactionIdIndex, j = 0; j < pTransactionIdStore->maxTransactionIdsCount && !idFound; ++j) {
-        if (MEMCMP(transactionId, pTransactionIdStore->transactionIds + i * STUN_TRANSACTION_ID_LEN, STUN_TRANSACTION_ID_LEN) == 0) {
-            idFound = TRUE;
-        }
-
-        i = (i + 1) % pTransactionIdStore->maxTransactionIdsCount;
-    }
-
-    return idFound;
+    return transactionIdStoreFindSlot(pTransactionIdStore, transactionId, &slot);
 }
 
 VOID transactionIdStoreRemove(PTransactionIdStore pTransactionIdStore, PBYTE transactionId)
 {
-    UINT32 i, j;
+    UINT32 slot;
 
     CHECK(pTransactionIdStore != NULL);
 
-    for (i = pTransactionIdStore->earliestTransactionIdIndex, j = 0; j < pTransactionIdStore->maxTransactionIdsCount; ++j) {
-        if (MEMCMP(transactionId, pTransactionIdStore->transactionIds + i * STUN_TRANSACTION_ID_LEN, STUN_TRANSACTION_ID_LEN) == 0) {
-            MEMSET(pTransactionIdStore->transactionIds + i * STUN_TRANSACTION_ID_LEN, 0x00, STUN_TRANSACTION_ID_LEN);
-            return;
-        }
-
-        i = (i + 1) % pTransactionIdStore->maxTransactionIdsCount;
+    if (transactionIdStoreFindSlot(pTransactionIdStore, transactionId, &slot)) {
+        transactionIdStoreUnlinkSlot(pTransactionIdStore, slot);
+        MEMSET(pTransactionIdStore->transactionIds + slot * STUN_TRANSACTION_ID_LEN, 0x00, STUN_TRANSACTION_ID_LEN);
     }
 }
 
@@ -140,11 +141,56 @@ VOID transactionIdStoreClear(PTransactionIdStore pTransactionIdStore)
 {
     CHECK(pTransactionIdStore != NULL);
 
+    MEMSET(pTransactionIdStore->bucketHeads, 0x00, SIZEOF(UINT32) * pTransactionIdStore->maxTransactionIdsCount);
+    MEMSET(pTransactionIdStore->slotUsed, 0x00, SIZEOF(BOOL) * pTransactionIdStore->maxTransactionIdsCount);
     pTransactionIdStore->nextTransactionIdIndex = 0;
     pTransactionIdStore->earliestTransactionIdIndex = 0;
     pTransactionIdStore->transactionIdCount = 0;
 }
 
+UINT32 transactionIdStoreGetBucket(PTransactionIdStore pTransactionIdStore, PBYTE transactionId)
+{
+    UINT32 hash;
+
+    // Transaction ids are random, their first bytes are as good a hash as any
+    MEMCPY(&hash, transactionId, SIZEOF(UINT32));
+
+    return hash % pTransactionIdStore->maxTransactionIdsCount;
+}
+
+BOOL transactionIdStoreFindSlot(PTransactionIdStore pTransactionIdStore, PBYTE transactionId, PUINT32 pSlot)
+{
+    UINT32 next = pTransactionIdStore->bucketHeads[transactionIdStoreGetBucket(pTransactionIdStore, transactionId)];
+
+    while (next != 0) {
+        if (MEMCMP(transactionId, pTransactionIdStore->transactionIds + (next - 1) * STUN_TRANSACTION_ID_LEN, STUN_TRANSACTION_ID_LEN) == 0) {
+            *pSlot = next - 1;
+            return TRUE;
+        }
+
+        next = pTransactionIdStore->slotNext[next - 1];
+    }
+
+    return FALSE;
+}
+
+VOID transactionIdStoreUnlinkSlot(PTransactionIdStore pTransactionIdStore, UINT32 slot)
+{
+    UINT32 bucket = transactionIdStoreGetBucket(pTransactionIdStore, pTransactionIdStore->transactionIds + slot * STUN_TRANSACTION_ID_LEN);
+    PUINT32 pLink = &pTransactionIdStore->bucketHeads[bucket];
+
+    while (*pLink != 0 && *pLink != slot + 1) {
+        pLink = &pTransactionIdStore->slotNext[*pLink - 1];
+    }
+
+    if (*pLink != 0) {
+        *pLink = pTransactionIdStore->slotNext[slot];
+    }
+
+    pTransactionIdStore->slotNext[slot] = 0;
+    pTransactionIdStore->slotUsed[slot] = FALSE;
+}
+
 STATUS iceUtilsGenerateTransactionId(PBYTE pBuffer, UINT32 bufferLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -167,20 +213,40 @@ CleanUp:
 STATUS iceUtilsPackageStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passwordLen, PBYTE pBuffer, PUINT32 pBufferLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 stunPacketSize = 0;
-    BOOL addMessageIntegrity = FALSE;
+    StunHmacKey hmacKey;
+    BOOL keyInitialized = FALSE;
 
     CHK(pStunPacket != NULL && pBuffer != NULL && pBufferLen != NULL, STATUS_NULL_ARG);
     CHK((password == NULL && passwordLen == 0) || (password != NULL && passwordLen > 0), STATUS_INVALID_ARG);
 
     if (password != NULL) {
-        addMessageIntegrity = TRUE;
+        CHK_STATUS(initStunHmacKey(&hmacKey, password, passwordLen));
+        keyInitialized = TRUE;
+    }
+
+    CHK_STATUS(iceUtilsPackageStunPacketWithHmacKey(pStunPacket, keyInitialized ? &hmacKey : NULL, pBuffer, pBufferLen));
+
+CleanUp:
+
+    if (keyInitialized) {
+        freeStunHmacKey(&hmacKey);
     }
 
-    CHK_STATUS(serializeStunPacket(pStunPacket, password, passwordLen, addMessageIntegrity, TRUE, NULL, &stunPacketSize));
-    CHK(stunPacketSize <= *pBufferLen, STATUS_BUFFER_TOO_SMALL);
-    CHK_STATUS(serializeStunPacket(pStunPacket, password, passwordLen, addMessageIntegrity, TRUE, pBuffer, &stunPacketSize));
-    *pBufferLen = stunPacketSize;
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+STATUS iceUtilsPackageStunPacketWithHmacKey(PStunPacket pStunPacket, PStunHmacKey pHmacKey, PBYTE pBuffer, PUINT32 pBufferLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pStunPacket != NULL && pBuffer != NULL && pBufferLen != NULL, STATUS_NULL_ARG);
+
+    // Packaged in a single pass, the buffer only has to be large enough
+    retStatus = serializeStunPacketWithHmacKey(pStunPacket, pHmacKey, TRUE, pBuffer, pBufferLen);
+    CHK(retStatus != STATUS_NOT_ENOUGH_MEMORY, STATUS_BUFFER_TOO_SMALL);
+    CHK_STATUS(retStatus);
 
 CleanUp:
 
@@ -234,8 +300,9 @@ STATUS iceUtilsSendData(PBYTE buffer, UINT32 size, PKvsIpAddress pDest, PSocketC
         retStatus = socketConnectionSendData(pSocketConnection, buffer, size, pDest);
     }
 
-    // Fix-up the not-yet-ready socket
-    CHK(STATUS_SUCCEEDED(retStatus) || retStatus == STATUS_SOCKET_CONNECTION_NOT_READY_TO_SEND, retStatus);
+    // Fix-up the not-yet-ready socket, and the one that queued the data until it is writable again
+    CHK(STATUS_SUCCEEDED(retStatus) || retStatus == STATUS_SOCKET_CONNECTION_NOT_READY_TO_SEND || retStatus == STATUS_SOCKET_CONNECTION_BACKPRESSURED,
+        retStatus);
     retStatus = STATUS_SUCCESS;
 
 CleanUp:
@@ -28,7 +28,7 @@ extern "C" {
 #define ICE_TRANSPORT_TYPE_TLS "tls"
 
 /**
- * Ring buffer storing transactionIds
+ * Ring buffer storing transactionIds, indexed by a hash of the id so that lookups do not scan the ring
  */
 typedef struct {
     UINT32 maxTransactionIdsCount;
@@ -36,6 +36,12 @@ typedef struct {
     UINT32 earliestTransactionIdIndex;
     UINT32 transactionIdCount;
     PBYTE transactionIds;
+    // First slot + 1 of every bucket, 0 for an empty bucket. There are maxTransactionIdsCount buckets
+    PUINT32 bucketHeads;
+    // Next slot + 1 in the bucket of every slot, 0 at the end of the bucket
+    PUINT32 slotNext;
+    // Whether a slot holds an id
+    PBOOL slotUsed;
 } TransactionIdStore, *PTransactionIdStore;
 
 STATUS createTransactionIdStore(UINT32, PTransactionIdStore*);
@@ -44,11 +50,15 @@ VOID transactionIdStoreInsert(PTransactionIdStore, PBYTE);
 VOID transactionIdStoreRemove(PTransactionIdStore, PBYTE);
 BOOL transactionIdStoreHasId(PTransactionIdStore, PBYTE);
 VOID transactionIdStoreClear(PTransactionIdStore);
+UINT32 transactionIdStoreGetBucket(PTransactionIdStore, PBYTE);
+BOOL transactionIdStoreFindSlot(PTransactionIdStore, PBYTE, PUINT32);
+VOID transactionIdStoreUnlinkSlot(PTransactionIdStore, UINT32);
 
 STATUS iceUtilsGenerateTransactionId(PBYTE, UINT32);
 
 // Stun packaging and sending functions
 STATUS iceUtilsPackageStunPacket(PStunPacket, PBYTE, UINT32, PBYTE, PUINT32);
+STATUS iceUtilsPackageStunPacketWithHmacKey(PStunPacket, PStunHmacKey, PBYTE, PUINT32);
 STATUS iceUtilsSendStunPacket(PStunPacket, PBYTE, UINT32, PKvsIpAddress, PSocketConnection, struct __TurnConnection*, BOOL);
 STATUS iceUtilsSendData(PBYTE, UINT32, PKvsIpAddress, PSocketConnection, struct __TurnConnection*, BOOL);
 
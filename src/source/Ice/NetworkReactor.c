@@ -0,0 +1,179 @@
+/**
+ * Kinesis Video Producer Shared Network Reactor
+ */
+#define LOG_CLASS "NetworkReactor"
+#include "../Include_i.h"
+
+PNetworkReactorPool getNetworkReactorPoolInstance()
+{
+    static NetworkReactorPool pool = {.lock = INVALID_MUTEX_VALUE, .isInitialized = FALSE, .reactorCount = 0};
+    return &pool;
+}
+
+STATUS createNetworkReactorPool()
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PNetworkReactorPool pNetworkReactorPool = getNetworkReactorPoolInstance();
+
+    CHK_ERR(!IS_VALID_MUTEX_VALUE(pNetworkReactorPool->lock), STATUS_INVALID_OPERATION, "Network reactor pool has been created already");
+
+    pNetworkReactorPool->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pNetworkReactorPool->lock), STATUS_INVALID_OPERATION);
+    pNetworkReactorPool->isInitialized = TRUE;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS freeNetworkReactorPool()
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    UINT32 i;
+    PNetworkReactorPool pNetworkReactorPool = getNetworkReactorPoolInstance();
+
+    CHK_WARN(IS_VALID_MUTEX_VALUE(pNetworkReactorPool->lock), STATUS_INVALID_OPERATION, "Network reactor pool not created, nothing to free");
+
+    MUTEX_LOCK(pNetworkReactorPool->lock);
+    locked = TRUE;
+
+    pNetworkReactorPool->isInitialized = FALSE;
+    for (i = 0; i < pNetworkReactorPool->reactorCount; i++) {
+        if (pNetworkReactorPool->reactorUsers[i] != 0) {
+            DLOGW("Freeing network reactor %u with %u shared listener(s) still attached", i, pNetworkReactorPool->reactorUsers[i]);
+        }
+
+        CHK_LOG_ERR(freeConnectionListener(&pNetworkReactorPool->reactors[i]));
+        pNetworkReactorPool->reactorUsers[i] = 0;
+    }
+
+    // All members of the static instance must be reset so that the pool can be created again
+    pNetworkReactorPool->reactorCount = 0;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pNetworkReactorPool->lock);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pNetworkReactorPool->lock)) {
+        MUTEX_FREE(pNetworkReactorPool->lock);
+        pNetworkReactorPool->lock = INVALID_MUTEX_VALUE;
+    }
+
+    return retStatus;
+}
+
+UINT32 networkReactorPoolGetThreadCount()
+{
+    PCHAR pThreadCount;
+    UINT32 threadCount = 0;
+#if defined(_WIN32)
+    SYSTEM_INFO systemInfo;
+#else
+    INT64 coreCount;
+#endif
+
+    if (NULL == (pThreadCount = GETENV(WEBRTC_NETWORK_REACTOR_THREADS_ENV_VAR)) ||
+        STATUS_SUCCESS != STRTOUI32(pThreadCount, NULL, 10, &threadCount) || threadCount == 0) {
+#if defined(_WIN32)
+        GetSystemInfo(&systemInfo);
+        threadCount = (UINT32) systemInfo.dwNumberOfProcessors;
+#else
+        coreCount = (INT64) sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = coreCount > 0 ? (UINT32) coreCount : 1;
+#endif
+    }
+
+    return MAX(1, MIN(threadCount, NETWORK_REACTOR_MAX_THREADS));
+}
+
+STATUS networkReactorPoolAcquire(PConnectionListener* ppReactor)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE, started = FALSE;
+    UINT32 i, reactorCount, selected = 0;
+    PNetworkReactorPool pNetworkReactorPool = getNetworkReactorPoolInstance();
+
+    CHK(ppReactor != NULL, STATUS_NULL_ARG);
+    CHK_ERR(IS_VALID_MUTEX_VALUE(pNetworkReactorPool->lock), STATUS_INVALID_OPERATION, "Network reactor pool not created. Call initKvsWebRtc first");
+
+    MUTEX_LOCK(pNetworkReactorPool->lock);
+    locked = TRUE;
+
+    CHK_ERR(pNetworkReactorPool->isInitialized, STATUS_INVALID_OPERATION, "Network reactor pool is shutting down");
+
+    // Start the reactors on first use
+    if (pNetworkReactorPool->reactorCount == 0) {
+        started = TRUE;
+        reactorCount = networkReactorPoolGetThreadCount();
+        for (i = 0; i < reactorCount; i++) {
+            CHK_STATUS(createConnectionListener(&pNetworkReactorPool->reactors[i]));
+            pNetworkReactorPool->reactorUsers[i] = 0;
+            pNetworkReactorPool->reactorCount++;
+            CHK_STATUS(connectionListenerStart(pNetworkReactorPool->reactors[i]));
+        }
+
+        DLOGI("Started %u shared network reactor thread(s)", reactorCount);
+    }
+
+    // Least loaded reactor in terms of attached PeerConnections
+    for (i = 1; i < pNetworkReactorPool->reactorCount; i++) {
+        if (pNetworkReactorPool->reactorUsers[i] < pNetworkReactorPool->reactorUsers[selected]) {
+            selected = i;
+        }
+    }
+
+    pNetworkReactorPool->reactorUsers[selected]++;
+    *ppReactor = pNetworkReactorPool->reactors[selected];
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && started) {
+        // Do not leave a partially started pool behind
+        for (i = 0; i < pNetworkReactorPool->reactorCount; i++) {
+            freeConnectionListener(&pNetworkReactorPool->reactors[i]);
+        }
+        pNetworkReactorPool->reactorCount = 0;
+    }
+
+    if (locked) {
+        MUTEX_UNLOCK(pNetworkReactorPool->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS networkReactorPoolRelease(PConnectionListener pReactor)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    UINT32 i;
+    PNetworkReactorPool pNetworkReactorPool = getNetworkReactorPoolInstance();
+
+    CHK(pReactor != NULL, STATUS_NULL_ARG);
+    CHK(IS_VALID_MUTEX_VALUE(pNetworkReactorPool->lock), STATUS_INVALID_OPERATION);
+
+    MUTEX_LOCK(pNetworkReactorPool->lock);
+    locked = TRUE;
+
+    for (i = 0; i < pNetworkReactorPool->reactorCount; i++) {
+        if (pNetworkReactorPool->reactors[i] == pReactor) {
+            if (pNetworkReactorPool->reactorUsers[i] > 0) {
+                pNetworkReactorPool->reactorUsers[i]--;
+            }
+            CHK(FALSE, retStatus);
+        }
+    }
+
+    CHK_WARN(FALSE, STATUS_INVALID_ARG, "Releasing a reactor that does not belong to the pool");
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pNetworkReactorPool->lock);
+    }
+
+    return retStatus;
+}
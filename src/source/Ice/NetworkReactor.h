@@ -0,0 +1,75 @@
+/*******************************************
+Shared Network Reactor internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_NETWORK_REACTOR__
+#define __KINESIS_VIDEO_WEBRTC_NETWORK_REACTOR__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Process wide pool of connection listeners, each running its own receive thread. PeerConnections that opt in through
+ * KvsRtcConfiguration.useSharedNetworkReactor register their sockets with one of these reactors instead of spawning a
+ * dedicated listener thread. The reactor threads are started lazily on first use.
+ */
+typedef struct {
+    MUTEX lock;
+    BOOL isInitialized;
+    // Number of reactors, fixed once the reactors are started
+    UINT32 reactorCount;
+    PConnectionListener reactors[NETWORK_REACTOR_MAX_THREADS];
+    // Number of shared listeners currently attached to each reactor
+    UINT32 reactorUsers[NETWORK_REACTOR_MAX_THREADS];
+} NetworkReactorPool, *PNetworkReactorPool;
+
+/**
+ * Get the process wide network reactor pool
+ *
+ * @return - PNetworkReactorPool - the singleton
+ */
+PNetworkReactorPool getNetworkReactorPoolInstance();
+
+/**
+ * Make the network reactor pool available. Called by initKvsWebRtc. No threads are created until a reactor is acquired.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createNetworkReactorPool();
+
+/**
+ * Stop and free all the reactors. Called by deinitKvsWebRtc once all the PeerConnections have been freed.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS freeNetworkReactorPool();
+
+/**
+ * Attach to the least loaded reactor, starting the reactor threads if this is the first use
+ *
+ * @param - PConnectionListener* - OUT - reactor to register sockets with
+ *
+ * @return - STATUS status of execution
+ */
+STATUS networkReactorPoolAcquire(PConnectionListener*);
+
+/**
+ * Detach from a reactor returned by networkReactorPoolAcquire
+ *
+ * @param - PConnectionListener - IN - reactor to detach from
+ *
+ * @return - STATUS status of execution
+ */
+STATUS networkReactorPoolRelease(PConnectionListener);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+UINT32 networkReactorPoolGetThreadCount();
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_NETWORK_REACTOR__ */
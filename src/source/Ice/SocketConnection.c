@@ -2,6 +2,10 @@
  * Kinesis Video Tcp
  */
 #define LOG_CLASS "SocketConnection"
+// sendmmsg is a GNU extension and needs to be requested before any system header is pulled in
+#if defined(HAVE_SENDMMSG) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
 #include "../Include_i.h"
 
 STATUS createSocketConnection(KVS_IP_FAMILY_TYPE familyType, KVS_SOCKET_PROTOCOL protocol, PKvsIpAddress pBindAddr, PKvsIpAddress pPeerIpAddr,
@@ -41,6 +45,8 @@ STATUS createSocketConnection(KVS_IP_FAMILY_TYPE familyType, KVS_SOCKET_PROTOCOL
     ATOMIC_STORE_BOOL(&pSocketConnection->connectionClosed, FALSE);
     ATOMIC_STORE_BOOL(&pSocketConnection->receiveData, FALSE);
     ATOMIC_STORE_BOOL(&pSocketConnection->inUse, FALSE);
+    ATOMIC_STORE_BOOL(&pSocketConnection->egressBackpressured, FALSE);
+    pSocketConnection->egressEpollFd = -1;
     pSocketConnection->dataAvailableCallbackCustomData = customData;
     pSocketConnection->dataAvailableCallbackFn = dataAvailableFn;
 
@@ -73,6 +79,37 @@ CleanUp:
     return retStatus;
 }
 
+STATUS socketConnectionSetBatchCallbacks(PSocketConnection pSocketConnection, ConnectionBatchFunc batchBeginFn, ConnectionBatchFunc batchEndFn)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pSocketConnection != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pSocketConnection->lock);
+    pSocketConnection->batchBeginCallbackFn = batchBeginFn;
+    pSocketConnection->batchEndCallbackFn = batchEndFn;
+    MUTEX_UNLOCK(pSocketConnection->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS socketConnectionSetEgressStateCallback(PSocketConnection pSocketConnection, ConnectionEgressStateFunc egressStateFn)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pSocketConnection != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pSocketConnection->lock);
+    pSocketConnection->egressStateCallbackFn = egressStateFn;
+    MUTEX_UNLOCK(pSocketConnection->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
 STATUS freeSocketConnection(PSocketConnection* ppSocketConnection)
 {
     ENTERS();
@@ -112,6 +149,11 @@ STATUS freeSocketConnection(PSocketConnection* ppSocketConnection)
         freeDtlsSession(&pSocketConnection->pDtlsSession);
     }
 
+    while (pSocketConnection->egressCount > 0) {
+        socketEgressQueueRemoveLocked(pSocketConnection, 0, FALSE);
+    }
+    SAFE_MEMFREE(pSocketConnection->pEgressPackets);
+
     SAFE_MEMFREE(pSocketConnection->hostname);
 
     getIpAddrStr(&pSocketConnection->hostIpAddr, ipAddr, ARRAY_SIZE(ipAddr));
@@ -221,6 +263,7 @@ VOID socketConnectionDtlsSessionOutBoundPacket(UINT64 customData, PBYTE pBuffer,
     CHK(customData != 0, STATUS_NULL_ARG);
 
     pSocketConnection = (PSocketConnection) customData;
+    // Records are not queued, the DTLS session retransmits whatever a full socket did not take
     CHK_STATUS(socketSendDataWithRetry(pSocketConnection, pBuffer, bufferLen, &pSocketConnection->peerIpAddr, NULL));
 
 CleanUp:
@@ -294,7 +337,8 @@ CleanUp:
 STATUS socketConnectionSendData(PSocketConnection pSocketConnection, PBYTE pBuf, UINT32 bufLen, PKvsIpAddress pDestIp)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    BOOL locked = FALSE;
+    BOOL locked = FALSE, backpressureStarted = FALSE;
+    UINT32 sentCount = 0;
 
     CHK(pSocketConnection != NULL, STATUS_NULL_ARG);
     CHK((pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_TCP || pDestIp != NULL), STATUS_INVALID_ARG);
@@ -317,7 +361,15 @@ STATUS socketConnectionSendData(PSocketConnection pSocketConnection, PBYTE pBuf,
     } else if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_TCP) {
         CHK_STATUS(retStatus = socketSendDataWithRetry(pSocketConnection, pBuf, bufLen, NULL, NULL));
     } else if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP) {
-        CHK_STATUS(retStatus = socketSendDataWithRetry(pSocketConnection, pBuf, bufLen, pDestIp, NULL));
+        // Nothing may overtake the queued packets
+        retStatus = ATOMIC_LOAD_BOOL(&pSocketConnection->egressBackpressured)
+            ? STATUS_SOCKET_CONNECTION_BACKPRESSURED
+            : socketSendDataWithRetry(pSocketConnection, pBuf, bufLen, pDestIp, NULL);
+        if (retStatus == STATUS_SOCKET_CONNECTION_BACKPRESSURED) {
+            retStatus = socketEgressQueueBatchLocked(pSocketConnection, &pBuf, &bufLen, 1, pDestIp, SOCKET_EGRESS_PRIORITY_CONTROL, &sentCount,
+                                                     &backpressureStarted);
+        }
+        CHK_STATUS(retStatus);
     } else {
         CHECK_EXT(FALSE, "socketConnectionSendData should not reach here. Nothing is sent.");
     }
@@ -328,6 +380,152 @@ CleanUp:
         MUTEX_UNLOCK(pSocketConnection->lock);
     }
 
+    if (backpressureStarted && pSocketConnection->egressStateCallbackFn != NULL) {
+        pSocketConnection->egressStateCallbackFn(pSocketConnection->dataAvailableCallbackCustomData, pSocketConnection, TRUE);
+    }
+
+    return retStatus;
+}
+
+STATUS socketConnectionSendBatch(PSocketConnection pSocketConnection, PBYTE* ppBuffers, PUINT32 pBufferLens, UINT32 count, PKvsIpAddress pDestIp,
+                                 SOCKET_EGRESS_PRIORITY priority, PUINT32 pSentCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE, sendIndividually, backpressureStarted = FALSE;
+    UINT32 i, sentCount = 0;
+
+    CHK(pSocketConnection != NULL && ppBuffers != NULL && pBufferLens != NULL, STATUS_NULL_ARG);
+    CHK(count > 0, STATUS_INVALID_ARG);
+    for (i = 0; i < count; i++) {
+        CHK(ppBuffers[i] != NULL && pBufferLens[i] > 0, STATUS_INVALID_ARG);
+    }
+
+    MUTEX_LOCK(pSocketConnection->lock);
+    sendIndividually = pSocketConnection->protocol != KVS_SOCKET_PROTOCOL_UDP || pSocketConnection->secureConnection;
+    MUTEX_UNLOCK(pSocketConnection->lock);
+
+    // TCP and secure sockets frame every buffer on their own, so there is nothing to batch
+    if (sendIndividually) {
+        for (i = 0; i < count; i++) {
+            CHK_STATUS(socketConnectionSendData(pSocketConnection, ppBuffers[i], pBufferLens[i], pDestIp));
+            sentCount++;
+        }
+
+        CHK(FALSE, retStatus);
+    }
+
+    CHK(pDestIp != NULL, STATUS_INVALID_ARG);
+
+    // Using a single CHK_WARN might output too much spew in bad network conditions
+    if (ATOMIC_LOAD_BOOL(&pSocketConnection->connectionClosed)) {
+        DLOGW("Warning: Failed to send data. Socket closed already");
+        CHK(FALSE, STATUS_SOCKET_CONNECTION_CLOSED_ALREADY);
+    }
+
+    MUTEX_LOCK(pSocketConnection->lock);
+    locked = TRUE;
+
+    // Nothing may overtake the queued packets
+    if (ATOMIC_LOAD_BOOL(&pSocketConnection->egressBackpressured)) {
+        retStatus = STATUS_SOCKET_CONNECTION_BACKPRESSURED;
+    } else if (count == 1) {
+        retStatus = socketSendDataWithRetry(pSocketConnection, ppBuffers[0], pBufferLens[0], pDestIp, NULL);
+        sentCount = STATUS_SUCCEEDED(retStatus) ? 1 : 0;
+    } else {
+        retStatus = socketSendBatchWithRetry(pSocketConnection, ppBuffers, pBufferLens, count, pDestIp, &sentCount);
+    }
+
+    if (retStatus == STATUS_SOCKET_CONNECTION_BACKPRESSURED) {
+        retStatus =
+            socketEgressQueueBatchLocked(pSocketConnection, ppBuffers, pBufferLens, count, pDestIp, priority, &sentCount, &backpressureStarted);
+    }
+    CHK_STATUS(retStatus);
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSocketConnection->lock);
+    }
+
+    if (backpressureStarted && pSocketConnection->egressStateCallbackFn != NULL) {
+        pSocketConnection->egressStateCallbackFn(pSocketConnection->dataAvailableCallbackCustomData, pSocketConnection, TRUE);
+    }
+
+    if (pSentCount != NULL) {
+        *pSentCount = sentCount;
+    }
+
+    return retStatus;
+}
+
+STATUS socketConnectionSendDataGather(PSocketConnection pSocketConnection, PBYTE* ppBuffers, PUINT32 pBufferLens, UINT32 count,
+                                      PKvsIpAddress pDestIp)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE, backpressureStarted = FALSE;
+    UINT32 i, totalLen = 0, offset = 0;
+    BYTE stackBuffer[SOCKET_SEND_GATHER_STACK_BUFFER_LEN];
+    PBYTE pMessage = NULL, pAllocatedMessage = NULL;
+
+    CHK(pSocketConnection != NULL && ppBuffers != NULL && pBufferLens != NULL, STATUS_NULL_ARG);
+    CHK(count > 0 && count <= SOCKET_SEND_GATHER_MAX_BUFFERS, STATUS_INVALID_ARG);
+    CHK((pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_TCP || pDestIp != NULL), STATUS_INVALID_ARG);
+    for (i = 0; i < count; i++) {
+        CHK(ppBuffers[i] != NULL && pBufferLens[i] > 0, STATUS_INVALID_ARG);
+        totalLen += pBufferLens[i];
+    }
+
+    // Using a single CHK_WARN might output too much spew in bad network conditions
+    if (ATOMIC_LOAD_BOOL(&pSocketConnection->connectionClosed)) {
+        DLOGW("Warning: Failed to send data. Socket closed already");
+        CHK(FALSE, STATUS_SOCKET_CONNECTION_CLOSED_ALREADY);
+    }
+
+#if defined(HAVE_SENDMSG)
+    // A socket becomes secure before anything is sent on it and stays so
+    if (!pSocketConnection->secureConnection) {
+        // Concurrent writes on a stream must not interleave, and a datagram must not overtake the queued ones
+        MUTEX_LOCK(pSocketConnection->lock);
+        locked = TRUE;
+
+        retStatus = ATOMIC_LOAD_BOOL(&pSocketConnection->egressBackpressured)
+            ? STATUS_SOCKET_CONNECTION_BACKPRESSURED
+            : socketSendGatherWithRetry(pSocketConnection, ppBuffers, pBufferLens, count,
+                                        pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_TCP ? NULL : pDestIp);
+        if (retStatus == STATUS_SOCKET_CONNECTION_BACKPRESSURED) {
+            retStatus = socketEgressQueuePushLocked(pSocketConnection, ppBuffers, pBufferLens, count, pDestIp, SOCKET_EGRESS_PRIORITY_CONTROL,
+                                                    &backpressureStarted);
+        }
+        CHK(FALSE, retStatus);
+    }
+#endif
+
+    if (totalLen <= SIZEOF(stackBuffer)) {
+        pMessage = stackBuffer;
+    } else {
+        CHK(NULL != (pAllocatedMessage = (PBYTE) MEMALLOC(totalLen)), STATUS_NOT_ENOUGH_MEMORY);
+        pMessage = pAllocatedMessage;
+    }
+
+    for (i = 0; i < count; i++) {
+        MEMCPY(pMessage + offset, ppBuffers[i], pBufferLens[i]);
+        offset += pBufferLens[i];
+    }
+
+    CHK_STATUS(socketConnectionSendData(pSocketConnection, pMessage, totalLen, pDestIp));
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSocketConnection->lock);
+    }
+
+    if (backpressureStarted && pSocketConnection->egressStateCallbackFn != NULL) {
+        pSocketConnection->egressStateCallbackFn(pSocketConnection->dataAvailableCallbackCustomData, pSocketConnection, TRUE);
+    }
+
+    SAFE_MEMFREE(pAllocatedMessage);
+
     return retStatus;
 }
 
@@ -490,6 +688,102 @@ BOOL socketConnectionIsConnected(PSocketConnection pSocketConnection)
     return FALSE;
 }
 
+#if defined(HAVE_EPOLL)
+STATUS socketConnectionEnableEgressQueue(PSocketConnection pSocketConnection, INT32 epollFd)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+
+    CHK(pSocketConnection != NULL, STATUS_NULL_ARG);
+    CHK(epollFd != -1, STATUS_INVALID_ARG);
+
+    MUTEX_LOCK(pSocketConnection->lock);
+    locked = TRUE;
+
+    // A stream can not drop or reorder its writes
+    CHK(pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP, retStatus);
+
+    pSocketConnection->egressEpollFd = epollFd;
+    pSocketConnection->egressQueueEnabled = TRUE;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSocketConnection->lock);
+    }
+
+    return retStatus;
+}
+#endif
+
+STATUS socketConnectionDisableEgressQueue(PSocketConnection pSocketConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pSocketConnection != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pSocketConnection->lock);
+    if (ATOMIC_LOAD_BOOL(&pSocketConnection->egressBackpressured)) {
+        CHK_LOG_ERR(socketEgressQueueSetWritableInterestLocked(pSocketConnection, FALSE));
+        ATOMIC_STORE_BOOL(&pSocketConnection->egressBackpressured, FALSE);
+    }
+
+    while (pSocketConnection->egressCount > 0) {
+        socketEgressQueueRemoveLocked(pSocketConnection, 0, TRUE);
+    }
+
+    pSocketConnection->egressQueueEnabled = FALSE;
+    pSocketConnection->egressEpollFd = -1;
+    MUTEX_UNLOCK(pSocketConnection->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS socketConnectionFlushEgressQueue(PSocketConnection pSocketConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS, sendStatus;
+    BOOL locked = FALSE, backpressureEnded = FALSE;
+    PSocketEgressPacket pPacket;
+
+    CHK(pSocketConnection != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pSocketConnection->lock);
+    locked = TRUE;
+
+    while (pSocketConnection->egressCount > 0 && !ATOMIC_LOAD_BOOL(&pSocketConnection->connectionClosed)) {
+        pPacket = &pSocketConnection->pEgressPackets[pSocketConnection->egressHead];
+        sendStatus = socketSendDataWithRetry(pSocketConnection, pPacket->pData, pPacket->size, &pPacket->destIp, NULL);
+
+        // Full again, the next EPOLLOUT edge resumes from here
+        if (sendStatus == STATUS_SOCKET_CONNECTION_BACKPRESSURED) {
+            break;
+        }
+
+        // Any other failure would fail again on retry
+        socketEgressQueueRemoveLocked(pSocketConnection, 0, STATUS_FAILED(sendStatus));
+    }
+
+    if (pSocketConnection->egressCount == 0 && ATOMIC_LOAD_BOOL(&pSocketConnection->egressBackpressured)) {
+        CHK_LOG_ERR(socketEgressQueueSetWritableInterestLocked(pSocketConnection, FALSE));
+        ATOMIC_STORE_BOOL(&pSocketConnection->egressBackpressured, FALSE);
+        backpressureEnded = TRUE;
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSocketConnection->lock);
+    }
+
+    if (backpressureEnded && pSocketConnection->egressStateCallbackFn != NULL) {
+        pSocketConnection->egressStateCallbackFn(pSocketConnection->dataAvailableCallbackCustomData, pSocketConnection, FALSE);
+    }
+
+    return retStatus;
+}
+
 STATUS socketSendDataWithRetry(PSocketConnection pSocketConnection, PBYTE buf, UINT32 bufLen, PKvsIpAddress pDestIp, PUINT32 pBytesWritten)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -497,6 +791,7 @@ STATUS socketSendDataWithRetry(PSocketConnection pSocketConnection, PBYTE buf, U
     SSIZE_T result = 0;
     UINT32 bytesWritten = 0;
     INT32 errorNum = 0;
+    BOOL wouldBlock = FALSE;
 
     struct pollfd wfds;
     socklen_t addrLen = 0;
@@ -531,6 +826,12 @@ STATUS socketSendDataWithRetry(PSocketConnection pSocketConnection, PBYTE buf, U
         if (result < 0) {
             errorNum = getErrorCode();
             if (errorNum == EAGAIN || errorNum == EWOULDBLOCK) {
+                // The egress queue takes over instead of waiting for the socket
+                if (pSocketConnection->egressQueueEnabled) {
+                    wouldBlock = TRUE;
+                    break;
+                }
+
                 MEMSET(&wfds, 0x00, SIZEOF(struct pollfd));
                 wfds.fd = pSocketConnection->localSocket;
                 wfds.events = POLLOUT;
@@ -579,7 +880,9 @@ STATUS socketSendDataWithRetry(PSocketConnection pSocketConnection, PBYTE buf, U
         CLOSE_SOCKET_IF_CANT_RETRY(errorNum, pSocketConnection);
     }
 
-    if (bytesWritten < bufLen) {
+    if (wouldBlock) {
+        retStatus = STATUS_SOCKET_CONNECTION_BACKPRESSURED;
+    } else if (bytesWritten < bufLen) {
         DLOGD("Failed to send data. Bytes sent %u. Data len %u. Retry count %u", bytesWritten, bufLen, socketWriteAttempt);
         retStatus = STATUS_SEND_DATA_FAILED;
     }
@@ -587,9 +890,585 @@ STATUS socketSendDataWithRetry(PSocketConnection pSocketConnection, PBYTE buf, U
 CleanUp:
 
     // CHK_LOG_ERR might be too verbose in this case
-    if (STATUS_FAILED(retStatus)) {
+    if (STATUS_FAILED(retStatus) && retStatus != STATUS_SOCKET_CONNECTION_BACKPRESSURED) {
         DLOGD("Warning: Send data failed with 0x%08x", retStatus);
     }
 
     return retStatus;
 }
+
+#if defined(HAVE_SENDMSG)
+/**
+ * Send the buffers as one message with sendmsg, resuming after partial stream writes. Must be called with the socket
+ * lock held for TCP sockets.
+ */
+STATUS socketSendGatherWithRetry(PSocketConnection pSocketConnection, PBYTE* ppBuffers, PUINT32 pBufferLens, UINT32 count, PKvsIpAddress pDestIp)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    INT32 socketWriteAttempt = 0, errorNum = 0;
+    SSIZE_T result = 0;
+    UINT32 i, totalLen = 0, bytesWritten = 0, firstIovec = 0;
+    SIZE_T remaining;
+    BOOL wouldBlock = FALSE;
+    struct pollfd wfds;
+    struct msghdr message;
+    struct iovec iovecs[SOCKET_SEND_GATHER_MAX_BUFFERS];
+    struct sockaddr_in ipv4Addr;
+    struct sockaddr_in6 ipv6Addr;
+
+    CHK(pSocketConnection != NULL && ppBuffers != NULL && pBufferLens != NULL, STATUS_NULL_ARG);
+    CHK(count > 0 && count <= SOCKET_SEND_GATHER_MAX_BUFFERS, STATUS_INVALID_ARG);
+
+    MEMSET(&message, 0x00, SIZEOF(message));
+    for (i = 0; i < count; i++) {
+        iovecs[i].iov_base = ppBuffers[i];
+        iovecs[i].iov_len = pBufferLens[i];
+        totalLen += pBufferLens[i];
+    }
+
+    if (pDestIp != NULL) {
+        if (IS_IPV4_ADDR(pDestIp)) {
+            MEMSET(&ipv4Addr, 0x00, SIZEOF(ipv4Addr));
+            ipv4Addr.sin_family = AF_INET;
+            ipv4Addr.sin_port = pDestIp->port;
+            MEMCPY(&ipv4Addr.sin_addr, pDestIp->address, IPV4_ADDRESS_LENGTH);
+            message.msg_name = &ipv4Addr;
+            message.msg_namelen = SIZEOF(ipv4Addr);
+        } else {
+            MEMSET(&ipv6Addr, 0x00, SIZEOF(ipv6Addr));
+            ipv6Addr.sin6_family = AF_INET6;
+            ipv6Addr.sin6_port = pDestIp->port;
+            MEMCPY(&ipv6Addr.sin6_addr, pDestIp->address, IPV6_ADDRESS_LENGTH);
+            message.msg_name = &ipv6Addr;
+            message.msg_namelen = SIZEOF(ipv6Addr);
+        }
+    }
+
+    while (socketWriteAttempt < MAX_SOCKET_WRITE_RETRY && bytesWritten < totalLen) {
+        message.msg_iov = &iovecs[firstIovec];
+        message.msg_iovlen = count - firstIovec;
+        result = sendmsg(pSocketConnection->localSocket, &message, NO_SIGNAL_SEND);
+        if (result < 0) {
+            errorNum = getErrorCode();
+            if (errorNum == EAGAIN || errorNum == EWOULDBLOCK) {
+                // The egress queue takes over instead of waiting for the socket
+                if (pSocketConnection->egressQueueEnabled) {
+                    wouldBlock = TRUE;
+                    break;
+                }
+
+                MEMSET(&wfds, 0x00, SIZEOF(struct pollfd));
+                wfds.fd = pSocketConnection->localSocket;
+                wfds.events = POLLOUT;
+                wfds.revents = 0;
+                result = POLL(&wfds, 1, SOCKET_SEND_RETRY_TIMEOUT_MILLI_SECOND);
+
+                if (result == 0) {
+                    /* loop back and try again */
+                    DLOGE("poll() timed out");
+                } else if (result < 0) {
+                    DLOGE("poll() failed with errno %s", getErrorString(getErrorCode()));
+                    break;
+                }
+            } else if (errorNum == EINTR) {
+                /* nothing need to be done, just retry */
+            } else {
+                /* fatal error from sendmsg() */
+                DLOGE("sendmsg() socket %d failed with errno %s(%d)", pSocketConnection->localSocket, getErrorString(errorNum), errorNum);
+                break;
+            }
+
+            // Indicate an attempt only on error
+            socketWriteAttempt++;
+        } else {
+            bytesWritten += (UINT32) result;
+
+            // Only a stream can be partially written, skip what went out
+            remaining = (SIZE_T) result;
+            while (firstIovec < count && remaining >= iovecs[firstIovec].iov_len) {
+                remaining -= iovecs[firstIovec].iov_len;
+                firstIovec++;
+            }
+            if (firstIovec < count) {
+                iovecs[firstIovec].iov_base = (PBYTE) iovecs[firstIovec].iov_base + remaining;
+                iovecs[firstIovec].iov_len -= remaining;
+            }
+        }
+    }
+
+    if (result < 0) {
+        CLOSE_SOCKET_IF_CANT_RETRY(errorNum, pSocketConnection);
+    }
+
+    if (wouldBlock) {
+        retStatus = STATUS_SOCKET_CONNECTION_BACKPRESSURED;
+    } else if (bytesWritten < totalLen) {
+        DLOGD("Failed to send data. Bytes sent %u. Data len %u. Retry count %u", bytesWritten, totalLen, socketWriteAttempt);
+        retStatus = STATUS_SEND_DATA_FAILED;
+    }
+
+CleanUp:
+
+    // CHK_LOG_ERR might be too verbose in this case
+    if (STATUS_FAILED(retStatus) && retStatus != STATUS_SOCKET_CONNECTION_BACKPRESSURED) {
+        DLOGD("Warning: Send data failed with 0x%08x", retStatus);
+    }
+
+    return retStatus;
+}
+#endif
+
+/**
+ * Send the buffers as individual datagrams. Must be called with the socket lock held.
+ */
+STATUS socketSendBatchWithRetry(PSocketConnection pSocketConnection, PBYTE* ppBuffers, PUINT32 pBufferLens, UINT32 count, PKvsIpAddress pDestIp,
+                                PUINT32 pSentCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 sentCount = 0;
+    socklen_t addrLen = 0;
+    struct sockaddr* destAddr = NULL;
+    struct sockaddr_in ipv4Addr;
+    struct sockaddr_in6 ipv6Addr;
+#if defined(HAVE_UDP_SEGMENT)
+    UINT32 segmentSize = 0;
+    BOOL segmentationUnsupported = FALSE;
+#endif
+#if defined(HAVE_SENDMMSG)
+    INT32 socketWriteAttempt = 0, result = 0, errorNum = 0;
+    UINT32 i, batchCount;
+    BOOL wouldBlock = FALSE;
+    struct pollfd wfds;
+    struct mmsghdr messages[SOCKET_SEND_BATCH_MAX_PACKETS];
+    struct iovec iovecs[SOCKET_SEND_BATCH_MAX_PACKETS];
+#endif
+
+    CHK(pSocketConnection != NULL && ppBuffers != NULL && pBufferLens != NULL && pDestIp != NULL, STATUS_NULL_ARG);
+    CHK(count > 0, STATUS_INVALID_ARG);
+
+    if (IS_IPV4_ADDR(pDestIp)) {
+        addrLen = SIZEOF(ipv4Addr);
+        MEMSET(&ipv4Addr, 0x00, SIZEOF(ipv4Addr));
+        ipv4Addr.sin_family = AF_INET;
+        ipv4Addr.sin_port = pDestIp->port;
+        MEMCPY(&ipv4Addr.sin_addr, pDestIp->address, IPV4_ADDRESS_LENGTH);
+        destAddr = (struct sockaddr*) &ipv4Addr;
+    } else {
+        addrLen = SIZEOF(ipv6Addr);
+        MEMSET(&ipv6Addr, 0x00, SIZEOF(ipv6Addr));
+        ipv6Addr.sin6_family = AF_INET6;
+        ipv6Addr.sin6_port = pDestIp->port;
+        MEMCPY(&ipv6Addr.sin6_addr, pDestIp->address, IPV6_ADDRESS_LENGTH);
+        destAddr = (struct sockaddr*) &ipv6Addr;
+    }
+
+#if defined(HAVE_UDP_SEGMENT)
+    // A frame cut into MTU sized packets can leave as a single super datagram that the kernel or NIC segments
+    if (!pSocketConnection->udpSegmentationDisabled && socketBatchGetSegmentSize(pBufferLens, count, &segmentSize)) {
+        retStatus = socketSendSegmentedWithRetry(pSocketConnection, ppBuffers, pBufferLens, count, segmentSize, destAddr, addrLen,
+                                                 &segmentationUnsupported);
+        if (!segmentationUnsupported) {
+            sentCount = STATUS_SUCCEEDED(retStatus) ? count : 0;
+            CHK(FALSE, retStatus);
+        }
+
+        DLOGI("UDP segmentation offload is not available on socket %d, falling back to sendmmsg", pSocketConnection->localSocket);
+        pSocketConnection->udpSegmentationDisabled = TRUE;
+        retStatus = STATUS_SUCCESS;
+    }
+#endif
+
+#if defined(HAVE_SENDMMSG)
+    while (socketWriteAttempt < MAX_SOCKET_WRITE_RETRY && sentCount < count) {
+        batchCount = MIN(count - sentCount, SOCKET_SEND_BATCH_MAX_PACKETS);
+        MEMSET(messages, 0x00, batchCount * SIZEOF(struct mmsghdr));
+        for (i = 0; i < batchCount; i++) {
+            iovecs[i].iov_base = ppBuffers[sentCount + i];
+            iovecs[i].iov_len = pBufferLens[sentCount + i];
+            messages[i].msg_hdr.msg_name = destAddr;
+            messages[i].msg_hdr.msg_namelen = addrLen;
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        result = sendmmsg(pSocketConnection->localSocket, messages, batchCount, NO_SIGNAL_SEND);
+        if (result < 0) {
+            errorNum = getErrorCode();
+            if (errorNum == EAGAIN || errorNum == EWOULDBLOCK) {
+                // The egress queue takes over instead of waiting for the socket
+                if (pSocketConnection->egressQueueEnabled) {
+                    wouldBlock = TRUE;
+                    break;
+                }
+
+                MEMSET(&wfds, 0x00, SIZEOF(struct pollfd));
+                wfds.fd = pSocketConnection->localSocket;
+                wfds.events = POLLOUT;
+                wfds.revents = 0;
+                result = POLL(&wfds, 1, SOCKET_SEND_RETRY_TIMEOUT_MILLI_SECOND);
+
+                if (result == 0) {
+                    /* loop back and try again */
+                    DLOGE("poll() timed out");
+                } else if (result < 0) {
+                    DLOGE("poll() failed with errno %s", getErrorString(getErrorCode()));
+                    break;
+                }
+            } else if (errorNum == EINTR) {
+                /* nothing need to be done, just retry */
+            } else {
+                /* fatal error from sendmmsg() */
+                DLOGE("sendmmsg() socket %d failed with errno %s(%d)", pSocketConnection->localSocket, getErrorString(errorNum), errorNum);
+                break;
+            }
+
+            // Indicate an attempt only on error
+            socketWriteAttempt++;
+        } else {
+            sentCount += (UINT32) result;
+        }
+    }
+
+    if (result < 0) {
+        CLOSE_SOCKET_IF_CANT_RETRY(errorNum, pSocketConnection);
+    }
+
+    if (wouldBlock) {
+        retStatus = STATUS_SOCKET_CONNECTION_BACKPRESSURED;
+    } else if (sentCount < count) {
+        DLOGD("Failed to send batch. Datagrams sent %u. Batch size %u. Retry count %u", sentCount, count, socketWriteAttempt);
+        retStatus = STATUS_SEND_DATA_FAILED;
+    }
+#else
+    for (; sentCount < count; sentCount++) {
+        CHK_STATUS(socketSendDataWithRetry(pSocketConnection, ppBuffers[sentCount], pBufferLens[sentCount], pDestIp, NULL));
+    }
+#endif
+
+CleanUp:
+
+    if (pSentCount != NULL) {
+        *pSentCount = sentCount;
+    }
+
+    // CHK_LOG_ERR might be too verbose in this case
+    if (STATUS_FAILED(retStatus) && retStatus != STATUS_SOCKET_CONNECTION_BACKPRESSURED) {
+        DLOGD("Warning: Send batch failed with 0x%08x", retStatus);
+    }
+
+    return retStatus;
+}
+
+#if defined(HAVE_UDP_SEGMENT)
+/**
+ * A batch can be sent with UDP_SEGMENT when it has more than one buffer, all the buffers but the last have the same
+ * size, the last is not bigger than the others and the whole batch fits in a single UDP datagram.
+ */
+BOOL socketBatchGetSegmentSize(PUINT32 pBufferLens, UINT32 count, PUINT32 pSegmentSize)
+{
+    UINT32 i, totalLen;
+
+    if (pBufferLens == NULL || pSegmentSize == NULL || count < 2 || count > SOCKET_SEND_MAX_GSO_SEGMENTS) {
+        return FALSE;
+    }
+
+    totalLen = pBufferLens[count - 1];
+    for (i = 0; i < count - 1; i++) {
+        if (pBufferLens[i] != pBufferLens[0]) {
+            return FALSE;
+        }
+        totalLen += pBufferLens[i];
+    }
+
+    if (pBufferLens[count - 1] > pBufferLens[0] || totalLen > MAX_UDP_PACKET_SIZE) {
+        return FALSE;
+    }
+
+    *pSegmentSize = pBufferLens[0];
+    return TRUE;
+}
+
+/**
+ * Send the whole batch with a single sendmsg carrying a UDP_SEGMENT control message. pSegmentationUnsupported is set
+ * when the kernel or the egress device can not segment, in which case nothing was sent. Must be called with the socket lock held.
+ */
+STATUS socketSendSegmentedWithRetry(PSocketConnection pSocketConnection, PBYTE* ppBuffers, PUINT32 pBufferLens, UINT32 count, UINT32 segmentSize,
+                                    struct sockaddr* destAddr, socklen_t addrLen, PBOOL pSegmentationUnsupported)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    INT32 socketWriteAttempt = 0, errorNum = 0;
+    SSIZE_T result = 0;
+    UINT32 i;
+    BOOL sent = FALSE, wouldBlock = FALSE;
+    struct pollfd wfds;
+    struct msghdr message;
+    struct cmsghdr* pControlMessage;
+    struct iovec iovecs[SOCKET_SEND_MAX_GSO_SEGMENTS];
+    union {
+        CHAR buffer[CMSG_SPACE(SIZEOF(UINT16))];
+        struct cmsghdr align;
+    } control;
+
+    CHK(pSocketConnection != NULL && ppBuffers != NULL && pBufferLens != NULL && destAddr != NULL && pSegmentationUnsupported != NULL,
+        STATUS_NULL_ARG);
+    CHK(count > 0 && count <= SOCKET_SEND_MAX_GSO_SEGMENTS, STATUS_INVALID_ARG);
+
+    *pSegmentationUnsupported = FALSE;
+
+    for (i = 0; i < count; i++) {
+        iovecs[i].iov_base = ppBuffers[i];
+        iovecs[i].iov_len = pBufferLens[i];
+    }
+
+    MEMSET(&message, 0x00, SIZEOF(message));
+    MEMSET(&control, 0x00, SIZEOF(control));
+    message.msg_name = destAddr;
+    message.msg_namelen = addrLen;
+    message.msg_iov = iovecs;
+    message.msg_iovlen = count;
+    message.msg_control = control.buffer;
+    message.msg_controllen = SIZEOF(control.buffer);
+
+    pControlMessage = CMSG_FIRSTHDR(&message);
+    pControlMessage->cmsg_level = SOL_UDP;
+    pControlMessage->cmsg_type = UDP_SEGMENT;
+    pControlMessage->cmsg_len = CMSG_LEN(SIZEOF(UINT16));
+    *((PUINT16) CMSG_DATA(pControlMessage)) = (UINT16) segmentSize;
+
+    while (socketWriteAttempt < MAX_SOCKET_WRITE_RETRY && !sent) {
+        result = sendmsg(pSocketConnection->localSocket, &message, NO_SIGNAL_SEND);
+        if (result >= 0) {
+            sent = TRUE;
+            continue;
+        }
+
+        errorNum = getErrorCode();
+        if (errorNum == EAGAIN || errorNum == EWOULDBLOCK) {
+            // The egress queue takes over instead of waiting for the socket
+            if (pSocketConnection->egressQueueEnabled) {
+                wouldBlock = TRUE;
+                break;
+            }
+
+            MEMSET(&wfds, 0x00, SIZEOF(struct pollfd));
+            wfds.fd = pSocketConnection->localSocket;
+            wfds.events = POLLOUT;
+            wfds.revents = 0;
+            result = POLL(&wfds, 1, SOCKET_SEND_RETRY_TIMEOUT_MILLI_SECOND);
+
+            if (result == 0) {
+                /* loop back and try again */
+                DLOGE("poll() timed out");
+            } else if (result < 0) {
+                DLOGE("poll() failed with errno %s", getErrorString(getErrorCode()));
+                break;
+            }
+        } else if (errorNum == EINTR) {
+            /* nothing need to be done, just retry */
+        } else if (errorNum == EIO || errorNum == EINVAL || errorNum == ENOPROTOOPT || errorNum == EOPNOTSUPP) {
+            // Old kernel or a device without checksum offload, nothing left the socket
+            *pSegmentationUnsupported = TRUE;
+            break;
+        } else {
+            /* fatal error from sendmsg() */
+            DLOGE("sendmsg() socket %d failed with errno %s(%d)", pSocketConnection->localSocket, getErrorString(errorNum), errorNum);
+            break;
+        }
+
+        // Indicate an attempt only on error
+        socketWriteAttempt++;
+    }
+
+    if (wouldBlock) {
+        retStatus = STATUS_SOCKET_CONNECTION_BACKPRESSURED;
+    } else if (!sent && !*pSegmentationUnsupported) {
+        CLOSE_SOCKET_IF_CANT_RETRY(errorNum, pSocketConnection);
+        DLOGD("Failed to send segmented batch of %u datagrams. Retry count %u", count, socketWriteAttempt);
+        retStatus = STATUS_SEND_DATA_FAILED;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+#endif
+
+/**
+ * Queue a copy of the concatenation of the buffers as one datagram. When the queue is full the oldest packet with a lower
+ * priority is dropped to make room, if there is none the new packet is dropped instead. pBackpressureStarted is set when
+ * the queue was empty before, in which case the caller reports the backpressure once it released the lock.
+ *
+ * @return - STATUS_SOCKET_CONNECTION_BACKPRESSURED when the packet was queued, STATUS_SEND_DATA_FAILED when it was dropped
+ */
+STATUS socketEgressQueuePushLocked(PSocketConnection pSocketConnection, PBYTE* ppBuffers, PUINT32 pBufferLens, UINT32 bufferCount,
+                                   PKvsIpAddress pDestIp, SOCKET_EGRESS_PRIORITY priority, PBOOL pBackpressureStarted)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, size = 0, victim, offset = 0;
+    SOCKET_EGRESS_PRIORITY victimPriority;
+    PSocketEgressPacket pPacket;
+    PBYTE pData = NULL;
+
+    CHK(pSocketConnection != NULL && ppBuffers != NULL && pBufferLens != NULL && pDestIp != NULL && pBackpressureStarted != NULL, STATUS_NULL_ARG);
+    CHK(pSocketConnection->egressQueueEnabled, STATUS_SEND_DATA_FAILED);
+
+    *pBackpressureStarted = FALSE;
+    for (i = 0; i < bufferCount; i++) {
+        size += pBufferLens[i];
+    }
+
+    if (pSocketConnection->pEgressPackets == NULL) {
+        pSocketConnection->pEgressPackets = (PSocketEgressPacket) MEMCALLOC(SOCKET_EGRESS_QUEUE_MAX_PACKETS, SIZEOF(SocketEgressPacket));
+        CHK(pSocketConnection->pEgressPackets != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    }
+
+    while (pSocketConnection->egressCount == SOCKET_EGRESS_QUEUE_MAX_PACKETS ||
+           pSocketConnection->egressBytes + size > SOCKET_EGRESS_QUEUE_MAX_BYTES) {
+        victim = pSocketConnection->egressCount;
+        victimPriority = priority;
+        for (i = 0; i < pSocketConnection->egressCount; i++) {
+            pPacket = &pSocketConnection->pEgressPackets[(pSocketConnection->egressHead + i) % SOCKET_EGRESS_QUEUE_MAX_PACKETS];
+            if (pPacket->priority < victimPriority) {
+                victim = i;
+                victimPriority = pPacket->priority;
+            }
+        }
+
+        if (victim == pSocketConnection->egressCount) {
+            pSocketConnection->egressPacketsDropped++;
+            pSocketConnection->egressBytesDropped += size;
+            CHK(FALSE, STATUS_SEND_DATA_FAILED);
+        }
+
+        socketEgressQueueRemoveLocked(pSocketConnection, victim, TRUE);
+    }
+
+    CHK(NULL != (pData = (PBYTE) MEMALLOC(size)), STATUS_NOT_ENOUGH_MEMORY);
+    for (i = 0; i < bufferCount; i++) {
+        MEMCPY(pData + offset, ppBuffers[i], pBufferLens[i]);
+        offset += pBufferLens[i];
+    }
+
+    // The listener has to be told to wait for the socket before it can drain anything
+    if (pSocketConnection->egressCount == 0) {
+        CHK_STATUS(socketEgressQueueSetWritableInterestLocked(pSocketConnection, TRUE));
+        ATOMIC_STORE_BOOL(&pSocketConnection->egressBackpressured, TRUE);
+        *pBackpressureStarted = TRUE;
+    }
+
+    pPacket = &pSocketConnection->pEgressPackets[(pSocketConnection->egressHead + pSocketConnection->egressCount) % SOCKET_EGRESS_QUEUE_MAX_PACKETS];
+    pPacket->pData = pData;
+    pPacket->size = size;
+    pPacket->destIp = *pDestIp;
+    pPacket->priority = priority;
+    pSocketConnection->egressCount++;
+    pSocketConnection->egressBytes += size;
+    pData = NULL;
+
+    retStatus = STATUS_SOCKET_CONNECTION_BACKPRESSURED;
+
+CleanUp:
+
+    SAFE_MEMFREE(pData);
+
+    return retStatus;
+}
+
+/**
+ * Queue the buffers from *pSentCount on, each as its own datagram. *pSentCount is advanced past every queued buffer. The
+ * buffers share a priority so once one of them is dropped so are the ones after it.
+ */
+STATUS socketEgressQueueBatchLocked(PSocketConnection pSocketConnection, PBYTE* ppBuffers, PUINT32 pBufferLens, UINT32 count, PKvsIpAddress pDestIp,
+                                    SOCKET_EGRESS_PRIORITY priority, PUINT32 pSentCount, PBOOL pBackpressureStarted)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL started = FALSE;
+    UINT32 i;
+
+    CHK(pSocketConnection != NULL && ppBuffers != NULL && pBufferLens != NULL && pSentCount != NULL && pBackpressureStarted != NULL,
+        STATUS_NULL_ARG);
+
+    *pBackpressureStarted = FALSE;
+    for (; *pSentCount < count; (*pSentCount)++) {
+        retStatus =
+            socketEgressQueuePushLocked(pSocketConnection, &ppBuffers[*pSentCount], &pBufferLens[*pSentCount], 1, pDestIp, priority, &started);
+        *pBackpressureStarted = *pBackpressureStarted || started;
+        CHK(retStatus == STATUS_SOCKET_CONNECTION_BACKPRESSURED, retStatus);
+    }
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && retStatus != STATUS_SOCKET_CONNECTION_BACKPRESSURED && pSocketConnection != NULL && pSentCount != NULL) {
+        // Account for the rest of the batch as well
+        for (i = *pSentCount + 1; i < count; i++) {
+            pSocketConnection->egressPacketsDropped++;
+            pSocketConnection->egressBytesDropped += pBufferLens[i];
+        }
+    }
+
+    return retStatus;
+}
+
+/**
+ * Remove the packet index slots after the head of the egress queue, keeping the order of the others
+ */
+VOID socketEgressQueueRemoveLocked(PSocketConnection pSocketConnection, UINT32 index, BOOL dropped)
+{
+    UINT32 i;
+    PSocketEgressPacket pPacket;
+
+    if (pSocketConnection == NULL || index >= pSocketConnection->egressCount) {
+        return;
+    }
+
+    pPacket = &pSocketConnection->pEgressPackets[(pSocketConnection->egressHead + index) % SOCKET_EGRESS_QUEUE_MAX_PACKETS];
+    if (dropped) {
+        pSocketConnection->egressPacketsDropped++;
+        pSocketConnection->egressBytesDropped += pPacket->size;
+    }
+    pSocketConnection->egressBytes -= pPacket->size;
+    SAFE_MEMFREE(pPacket->pData);
+
+    if (index == 0) {
+        pSocketConnection->egressHead = (pSocketConnection->egressHead + 1) % SOCKET_EGRESS_QUEUE_MAX_PACKETS;
+    } else {
+        for (i = index; i + 1 < pSocketConnection->egressCount; i++) {
+            pSocketConnection->pEgressPackets[(pSocketConnection->egressHead + i) % SOCKET_EGRESS_QUEUE_MAX_PACKETS] =
+                pSocketConnection->pEgressPackets[(pSocketConnection->egressHead + i + 1) % SOCKET_EGRESS_QUEUE_MAX_PACKETS];
+        }
+    }
+
+    pSocketConnection->egressCount--;
+}
+
+/**
+ * Add or remove EPOLLOUT from the events the listener waits for on the socket. The other events mirror the ones set by
+ * connectionListenerAddConnection.
+ */
+STATUS socketEgressQueueSetWritableInterestLocked(PSocketConnection pSocketConnection, BOOL writable)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+#if defined(HAVE_EPOLL)
+    struct epoll_event event;
+#endif
+
+    CHK(pSocketConnection != NULL, STATUS_NULL_ARG);
+
+#if defined(HAVE_EPOLL)
+    CHK(pSocketConnection->egressEpollFd != -1, retStatus);
+
+    MEMSET(&event, 0x00, SIZEOF(event));
+    event.events = EPOLLIN | EPOLLET | (writable ? EPOLLOUT : 0);
+    event.data.ptr = pSocketConnection;
+    if (epoll_ctl(pSocketConnection->egressEpollFd, EPOLL_CTL_MOD, pSocketConnection->localSocket, &event) == -1) {
+        DLOGW("epoll_ctl() failed to update socket %d with errno %s", pSocketConnection->localSocket, getErrorString(getErrorCode()));
+        CHK(FALSE, STATUS_EPOLL_CTL_FAILED);
+    }
+#else
+    UNUSED_PARAM(writable);
+#endif
+
+CleanUp:
+
+    return retStatus;
+}
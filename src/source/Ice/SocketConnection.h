@@ -13,6 +13,22 @@ extern "C" {
 #define SOCKET_SEND_RETRY_TIMEOUT_MILLI_SECOND 500
 #define MAX_SOCKET_WRITE_RETRY                 3
 
+// Max number of datagrams handed to a single sendmmsg call
+#define SOCKET_SEND_BATCH_MAX_PACKETS 64
+
+// Max number of segments the kernel accepts in a single UDP_SEGMENT send
+#define SOCKET_SEND_MAX_GSO_SEGMENTS 64
+
+// Max number of buffers a single gathered send is made of
+#define SOCKET_SEND_GATHER_MAX_BUFFERS 4
+
+// Gathered sends that have to be assembled first, for encryption or without sendmsg, up to this size do it on the stack
+#define SOCKET_SEND_GATHER_STACK_BUFFER_LEN 1500
+
+// Bounds of the per socket egress queue that absorbs a full send buffer instead of waiting for it to drain
+#define SOCKET_EGRESS_QUEUE_MAX_PACKETS 256
+#define SOCKET_EGRESS_QUEUE_MAX_BYTES   (SOCKET_EGRESS_QUEUE_MAX_PACKETS * 1500)
+
 #define CLOSE_SOCKET_IF_CANT_RETRY(e, ps)                                                                                                            \
     if ((e) != EAGAIN && (e) != EWOULDBLOCK && (e) != EINTR && (e) != EINPROGRESS && (e) != EPERM && (e) != EALREADY && (e) != ENETUNREACH) {        \
         DLOGD("Close socket %d", (ps)->localSocket);                                                                                                 \
@@ -21,6 +37,42 @@ extern "C" {
 
 typedef STATUS (*ConnectionDataAvailableFunc)(UINT64, struct __SocketConnection*, PBYTE, UINT32, PKvsIpAddress, PKvsIpAddress);
 
+/* Invoked with the data available callback custom data right before/after a batch of incoming data is dispatched */
+typedef STATUS (*ConnectionBatchFunc)(UINT64, struct __SocketConnection*);
+
+/* Invoked with the data available callback custom data when the egress queue fills up (TRUE) or is drained (FALSE) */
+typedef VOID (*ConnectionEgressStateFunc)(UINT64, struct __SocketConnection*, BOOL);
+
+/*
+ * Drop order of the egress queue. When the queue is full the oldest packet of the lowest priority below the one of the
+ * new packet is dropped to make room, otherwise the new packet is.
+ */
+typedef enum {
+    SOCKET_EGRESS_PRIORITY_DISCARDABLE_VIDEO = 0, //!< Video that no other frame depends on. Only key frames are known to be referenced.
+    SOCKET_EGRESS_PRIORITY_VIDEO = 1,             //!< Video key frames and retransmissions
+    SOCKET_EGRESS_PRIORITY_AUDIO = 2,
+    SOCKET_EGRESS_PRIORITY_CONTROL = 3, //!< STUN, DTLS, RTCP and data channel messages
+} SOCKET_EGRESS_PRIORITY;
+
+/* A datagram waiting in the egress queue for the socket to become writable */
+typedef struct {
+    PBYTE pData;
+    UINT32 size;
+    KvsIpAddress destIp;
+    SOCKET_EGRESS_PRIORITY priority;
+} SocketEgressPacket, *PSocketEgressPacket;
+
+/*
+ * Scratch state the data available callback can use to defer per packet work to the end of a receive batch.
+ * Only touched by the thread that is currently draining the socket.
+ */
+typedef struct {
+    BOOL active;
+    UINT32 packetCount;
+    UINT64 byteCount;
+    KvsIpAddress srcAddr;
+} SocketConnectionReceiveBatch, *PSocketConnectionReceiveBatch;
+
 typedef struct __SocketConnection SocketConnection;
 struct __SocketConnection {
     /* Indicate whether this socket is marked for cleanup */
@@ -44,10 +96,35 @@ struct __SocketConnection {
 
     ConnectionDataAvailableFunc dataAvailableCallbackFn;
     UINT64 dataAvailableCallbackCustomData;
+
+    /* Optional hooks surrounding every batch of data drained from the socket by the connection listener */
+    ConnectionBatchFunc batchBeginCallbackFn;
+    ConnectionBatchFunc batchEndCallbackFn;
+    SocketConnectionReceiveBatch receiveBatch;
+
     UINT64 tlsHandshakeStartTime;
 
     /* Hostname for TLS verification */
     PCHAR hostname;
+
+    /* Set once the kernel or the egress device rejected a UDP_SEGMENT send, batches then go out through sendmmsg */
+    BOOL udpSegmentationDisabled;
+
+    /*
+     * Egress queue, guarded by the lock. Only enabled for UDP sockets serviced by an epoll based connection listener, which
+     * drains it once the socket is writable again. Other sockets keep waiting for the socket in the send call.
+     */
+    BOOL egressQueueEnabled;
+    INT32 egressEpollFd;
+    PSocketEgressPacket pEgressPackets; // Ring of SOCKET_EGRESS_QUEUE_MAX_PACKETS slots, allocated on first use
+    UINT32 egressHead;
+    UINT32 egressCount;
+    UINT64 egressBytes;
+    UINT64 egressPacketsDropped;
+    UINT64 egressBytesDropped;
+    /* Set while the queue holds packets, readable without the lock */
+    volatile ATOMIC_BOOL egressBackpressured;
+    ConnectionEgressStateFunc egressStateCallbackFn;
 };
 typedef struct __SocketConnection* PSocketConnection;
 
@@ -70,6 +147,31 @@ typedef struct __SocketConnection* PSocketConnection;
 STATUS createSocketConnection(KVS_IP_FAMILY_TYPE, KVS_SOCKET_PROTOCOL, PKvsIpAddress, PKvsIpAddress, UINT64, ConnectionDataAvailableFunc, UINT32,
                               PSocketConnection*);
 
+/**
+ * Set the hooks invoked before and after each batch of incoming data is handed to the data available callback.
+ * Both hooks receive the data available callback custom data. Must be called before the socket is added to a connection listener.
+ *
+ * @param - PSocketConnection - IN - the SocketConnection struct
+ * @param - ConnectionBatchFunc - IN - batch begin callback (OPTIONAL)
+ * @param - ConnectionBatchFunc - IN - batch end callback (OPTIONAL)
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS socketConnectionSetBatchCallbacks(PSocketConnection, ConnectionBatchFunc, ConnectionBatchFunc);
+
+/**
+ * Set the callback invoked when the socket starts or stops being backpressured. The callback receives the data available
+ * callback custom data and is invoked without the socket lock, from the sending thread when the egress queue fills up
+ * and from the connection listener thread once it has been drained. It must not block. Must be called before the socket
+ * is added to a connection listener.
+ *
+ * @param - PSocketConnection - IN - the SocketConnection struct
+ * @param - ConnectionEgressStateFunc - IN - egress state callback (OPTIONAL)
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS socketConnectionSetEgressStateCallback(PSocketConnection, ConnectionEgressStateFunc);
+
 /**
  * Free the SocketConnection struct
  *
@@ -102,10 +204,44 @@ STATUS socketConnectionInitSecureConnection(PSocketConnection, BOOL, TIMER_QUEUE
  * @param - UINT32 - IN - length of buffer
  * @param - PKvsIpAddress - IN - destination address. Required only if socket type is UDP.
  *
- * @return - STATUS - status of execution
+ * @return - STATUS - status of execution. STATUS_SOCKET_CONNECTION_BACKPRESSURED when the data was queued until the
+ * socket becomes writable.
  */
 STATUS socketConnectionSendData(PSocketConnection, PBYTE, UINT32, PKvsIpAddress);
 
+/**
+ * Send a batch of buffers as individual datagrams with as few syscalls as possible. Plain UDP sockets use a single
+ * UDP_SEGMENT send when all the buffers but the last have the same size and sendmmsg otherwise. TCP and secure sockets
+ * fall back to socketConnectionSendData for every buffer. Buffers the socket can not take right away are queued with the
+ * given priority when the egress queue is enabled.
+ *
+ * @param - PSocketConnection - IN - the SocketConnection struct
+ * @param - PBYTE* - IN - buffers to send, in order
+ * @param - PUINT32 - IN - length of each buffer
+ * @param - UINT32 - IN - number of buffers
+ * @param - PKvsIpAddress - IN - destination address. Required only if socket type is UDP.
+ * @param - SOCKET_EGRESS_PRIORITY - IN - drop priority of the buffers if they have to be queued
+ * @param - PUINT32 - OUT - number of leading buffers that were sent or queued (OPTIONAL)
+ *
+ * @return - STATUS - status of execution. STATUS_SOCKET_CONNECTION_BACKPRESSURED when some of the buffers were queued.
+ */
+STATUS socketConnectionSendBatch(PSocketConnection, PBYTE*, PUINT32, UINT32, PKvsIpAddress, SOCKET_EGRESS_PRIORITY, PUINT32);
+
+/**
+ * Send the concatenation of the buffers as a single datagram, or in one piece on a TCP stream, without assembling it
+ * first. Plain sockets hand the buffers to a single sendmsg, plain UDP without taking the socket lock as a datagram
+ * can not interleave with another one. Secure sockets need the message contiguous to encrypt it and copy it once.
+ *
+ * @param - PSocketConnection - IN - the SocketConnection struct
+ * @param - PBYTE* - IN - buffers making up the message, in order
+ * @param - PUINT32 - IN - length of each buffer
+ * @param - UINT32 - IN - number of buffers, at most SOCKET_SEND_GATHER_MAX_BUFFERS
+ * @param - PKvsIpAddress - IN - destination address. Required only if socket type is UDP.
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS socketConnectionSendDataGather(PSocketConnection, PBYTE*, PUINT32, UINT32, PKvsIpAddress);
+
 /**
  * If PSocketConnection is not secure then nothing happens, otherwise assuming the bytes passed in are encrypted, and
  * the encryted data will be replaced with unencrypted data at function return.
@@ -156,8 +292,53 @@ BOOL socketConnectionIsClosed(PSocketConnection);
  */
 BOOL socketConnectionIsConnected(PSocketConnection);
 
+#if defined(HAVE_EPOLL)
+/**
+ * Enable the egress queue of a UDP socket. Called by the connection listener that registered the socket with the epoll
+ * instance, the socket is then watched for EPOLLOUT whenever the queue holds packets.
+ *
+ * @param - PSocketConnection - IN - the SocketConnection struct
+ * @param - INT32 - IN - epoll instance the socket is registered with
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS socketConnectionEnableEgressQueue(PSocketConnection, INT32);
+#endif
+
+/**
+ * Disable the egress queue and drop whatever it holds, without invoking the egress state callback. Called by the
+ * connection listener when it stops servicing the socket.
+ *
+ * @param - PSocketConnection - IN - the SocketConnection struct
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS socketConnectionDisableEgressQueue(PSocketConnection);
+
+/**
+ * Send the queued packets until the socket would block again. Called by the connection listener thread when the socket
+ * becomes writable.
+ *
+ * @param - PSocketConnection - IN - the SocketConnection struct
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS socketConnectionFlushEgressQueue(PSocketConnection);
+
 // internal functions
+STATUS socketEgressQueuePushLocked(PSocketConnection, PBYTE*, PUINT32, UINT32, PKvsIpAddress, SOCKET_EGRESS_PRIORITY, PBOOL);
+STATUS socketEgressQueueBatchLocked(PSocketConnection, PBYTE*, PUINT32, UINT32, PKvsIpAddress, SOCKET_EGRESS_PRIORITY, PUINT32, PBOOL);
+VOID socketEgressQueueRemoveLocked(PSocketConnection, UINT32, BOOL);
+STATUS socketEgressQueueSetWritableInterestLocked(PSocketConnection, BOOL);
 STATUS socketSendDataWithRetry(PSocketConnection, PBYTE, UINT32, PKvsIpAddress, PUINT32);
+STATUS socketSendBatchWithRetry(PSocketConnection, PBYTE*, PUINT32, UINT32, PKvsIpAddress, PUINT32);
+#if defined(HAVE_SENDMSG)
+STATUS socketSendGatherWithRetry(PSocketConnection, PBYTE*, PUINT32, UINT32, PKvsIpAddress);
+#endif
+#if defined(HAVE_UDP_SEGMENT)
+BOOL socketBatchGetSegmentSize(PUINT32, UINT32, PUINT32);
+STATUS socketSendSegmentedWithRetry(PSocketConnection, PBYTE*, PUINT32, UINT32, UINT32, struct sockaddr*, socklen_t, PBOOL);
+#endif
 
 // TLS and DTLS session callbacks used by SocketConnection to forward encrypted records and react to handshake state
 // changes. These are internal hooks for the secure transport path, not part of the public SocketConnection API.
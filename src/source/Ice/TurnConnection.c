@@ -77,11 +77,9 @@ STATUS createTurnConnection(PIceServer pTurnServer, TIMER_QUEUE_HANDLE timerQueu
     CHK_STATUS(getHostnameFromUrl(pTurnServer->url, &hostname));
     pTurnSocket->hostname = hostname;
 
-    pTurnConnection = (PTurnConnection) MEMCALLOC(
-        1, SIZEOF(TurnConnection) + DEFAULT_TURN_MESSAGE_RECV_CHANNEL_DATA_BUFFER_LEN * 2 + DEFAULT_TURN_MESSAGE_SEND_CHANNEL_DATA_BUFFER_LEN);
+    pTurnConnection = (PTurnConnection) MEMCALLOC(1, SIZEOF(TurnConnection) + DEFAULT_TURN_MESSAGE_RECV_CHANNEL_DATA_BUFFER_LEN * 2);
     CHK(pTurnConnection != NULL, STATUS_NOT_ENOUGH_MEMORY);
     pTurnConnection->lock = MUTEX_CREATE(TRUE);
-    pTurnConnection->sendLock = MUTEX_CREATE(FALSE);
     pTurnConnection->freeAllocationCvar = CVAR_CREATE();
     pTurnConnection->timerQueueHandle = timerQueueHandle;
     pTurnConnection->turnServer = *pTurnServer;
@@ -106,10 +104,8 @@ STATUS createTurnConnection(PIceServer pTurnServer, TIMER_QUEUE_HANDLE timerQueu
     }
     pTurnConnection->recvDataBufferSize = DEFAULT_TURN_MESSAGE_RECV_CHANNEL_DATA_BUFFER_LEN;
     pTurnConnection->dataBufferSize = DEFAULT_TURN_MESSAGE_SEND_CHANNEL_DATA_BUFFER_LEN;
-    pTurnConnection->sendDataBuffer = (PBYTE) (pTurnConnection + 1);
-    pTurnConnection->recvDataBuffer = pTurnConnection->sendDataBuffer + pTurnConnection->dataBufferSize;
-    pTurnConnection->completeChannelDataBuffer =
-        pTurnConnection->sendDataBuffer + pTurnConnection->dataBufferSize + pTurnConnection->recvDataBufferSize;
+    pTurnConnection->recvDataBuffer = (PBYTE) (pTurnConnection + 1);
+    pTurnConnection->completeChannelDataBuffer = pTurnConnection->recvDataBuffer + pTurnConnection->recvDataBufferSize;
     pTurnConnection->currRecvDataLen = 0;
     pTurnConnection->allocationExpirationTime = INVALID_TIMESTAMP_VALUE;
     pTurnConnection->nextAllocationRefreshTime = 0;
@@ -165,7 +161,7 @@ STATUS freeTurnConnection(PTurnConnection* ppTurnConnection)
     // Ensure we are not freeing everything without cancelling the timer
     timerCallbackId = ATOMIC_EXCHANGE(&pTurnConnection->timerCallbackId, MAX_UINT32);
     if (timerCallbackId != MAX_UINT32) {
-        CHK_LOG_ERR(timerQueueCancelTimer(pTurnConnection->timerQueueHandle, (UINT32) timerCallbackId, (UINT64) pTurnConnection));
+        CHK_LOG_ERR(sharedTimerQueueCancelTimer(pTurnConnection->timerQueueHandle, (UINT32) timerCallbackId, (UINT64) pTurnConnection));
     }
     // shutdown control channel
     if (pTurnConnection->pControlChannel) {
@@ -186,13 +182,6 @@ STATUS freeTurnConnection(PTurnConnection* ppTurnConnection)
         MUTEX_FREE(pTurnConnection->lock);
     }
 
-    if (IS_VALID_MUTEX_VALUE(pTurnConnection->sendLock)) {
-        /* in case some thread is in the middle of a turn api call. */
-        MUTEX_LOCK(pTurnConnection->sendLock);
-        MUTEX_UNLOCK(pTurnConnection->sendLock);
-        MUTEX_FREE(pTurnConnection->sendLock);
-    }
-
     if (IS_VALID_CVAR_VALUE(pTurnConnection->freeAllocationCvar)) {
         CVAR_FREE(pTurnConnection->freeAllocationCvar);
     }
@@ -784,11 +773,15 @@ STATUS turnConnectionSendData(PTurnConnection pTurnConnection, PBYTE pBuf, UINT3
 {
     STATUS retStatus = STATUS_SUCCESS;
     PTurnPeer pSendPeer = NULL;
-    UINT32 paddedDataLen = 0;
+    UINT16 channelNumber;
+    UINT32 paddingLen = 0, bufferCount = 2;
     CHAR ipAddrStr[KVS_IP_ADDRESS_STRING_BUFFER_LEN];
     BOOL locked = FALSE;
-    BOOL sendLocked = FALSE;
     PKvsIpAddress pTurnServerIp = NULL;
+    BYTE channelDataHeader[TURN_DATA_CHANNEL_SEND_OVERHEAD];
+    BYTE padding[3] = {0};
+    PBYTE buffers[3];
+    UINT32 bufferLens[3];
 
     CHK(pTurnConnection != NULL && pDestIp != NULL, STATUS_NULL_ARG);
     CHK(pBuf != NULL && bufLen > 0, STATUS_INVALID_ARG);
@@ -818,28 +811,35 @@ STATUS turnConnectionSendData(PTurnConnection pTurnConnection, PBYTE pBuf, UINT3
         CHK(FALSE, retStatus);
     }
 
+    channelNumber = pSendPeer->channelNumber;
+    getTurnConnectionIpAddress(pTurnConnection, &pTurnServerIp);
+
     MUTEX_UNLOCK(pTurnConnection->lock);
     locked = FALSE;
 
-    /* need to serialize send because every send load data into the same buffer pTurnConnection->sendDataBuffer */
-    MUTEX_LOCK(pTurnConnection->sendLock);
-    sendLocked = TRUE;
-
     CHK(pTurnConnection->dataBufferSize - TURN_DATA_CHANNEL_SEND_OVERHEAD >= bufLen, STATUS_BUFFER_TOO_SMALL);
 
-    paddedDataLen = (UINT32) ROUND_UP(TURN_DATA_CHANNEL_SEND_OVERHEAD + bufLen, 4);
-
-    /* generate data channel TURN message */
-    putInt16((PINT16) (pTurnConnection->sendDataBuffer), pSendPeer->channelNumber);
-    putInt16((PINT16) (pTurnConnection->sendDataBuffer + 2), (UINT16) bufLen);
-    MEMCPY(pTurnConnection->sendDataBuffer + TURN_DATA_CHANNEL_SEND_OVERHEAD, pBuf, bufLen);
-
-    getTurnConnectionIpAddress(pTurnConnection, &pTurnServerIp);
+    /* generate data channel TURN message. The payload is not copied, the header goes out with it in a single send */
+    putInt16((PINT16) channelDataHeader, channelNumber);
+    putInt16((PINT16) (channelDataHeader + 2), (UINT16) bufLen);
+    buffers[0] = channelDataHeader;
+    bufferLens[0] = TURN_DATA_CHANNEL_SEND_OVERHEAD;
+    buffers[1] = pBuf;
+    bufferLens[1] = bufLen;
+
+    // ChannelData over a stream must be padded to 4 bytes, https://tools.ietf.org/html/rfc8656#section-12.5
+    if (pTurnConnection->protocol == KVS_SOCKET_PROTOCOL_TCP) {
+        paddingLen = (UINT32) ROUND_UP(bufLen, 4) - bufLen;
+    }
+    if (paddingLen > 0) {
+        buffers[bufferCount] = padding;
+        bufferLens[bufferCount++] = paddingLen;
+    }
 
-    retStatus = iceUtilsSendData(pTurnConnection->sendDataBuffer, paddedDataLen, pTurnServerIp, pTurnConnection->pControlChannel, NULL, FALSE);
+    retStatus = socketConnectionSendDataGather(pTurnConnection->pControlChannel, buffers, bufferLens, bufferCount, pTurnServerIp);
 
     if (STATUS_FAILED(retStatus)) {
-        DLOGW("iceUtilsSendData failed with 0x%08x", retStatus);
+        DLOGW("socketConnectionSendDataGather failed with 0x%08x", retStatus);
         if (retStatus != STATUS_SOCKET_CONNECTION_CLOSED_ALREADY) {
             retStatus = STATUS_SUCCESS;
         }
@@ -849,10 +849,6 @@ CleanUp:
 
     CHK_LOG_ERR(retStatus);
 
-    if (sendLocked) {
-        MUTEX_UNLOCK(pTurnConnection->sendLock);
-    }
-
     if (locked) {
         MUTEX_UNLOCK(pTurnConnection->lock);
     }
@@ -879,12 +875,13 @@ STATUS turnConnectionStart(PTurnConnection pTurnConnection)
 
     timerCallbackId = ATOMIC_EXCHANGE(&pTurnConnection->timerCallbackId, MAX_UINT32);
     if (timerCallbackId != MAX_UINT32) {
-        CHK_STATUS(timerQueueCancelTimer(pTurnConnection->timerQueueHandle, (UINT32) timerCallbackId, (UINT64) pTurnConnection));
+        CHK_STATUS(sharedTimerQueueCancelTimer(pTurnConnection->timerQueueHandle, (UINT32) timerCallbackId, (UINT64) pTurnConnection));
     }
 
     /* schedule the timer, which will drive the state machine. */
-    CHK_STATUS(timerQueueAddTimer(pTurnConnection->timerQueueHandle, KVS_ICE_DEFAULT_TIMER_START_DELAY, pTurnConnection->currentTimerCallingPeriod,
-                                  turnConnectionTimerCallback, (UINT64) pTurnConnection, (PUINT32) &timerCallbackId));
+    CHK_STATUS(sharedTimerQueueAddTimer(pTurnConnection->timerQueueHandle, KVS_ICE_DEFAULT_TIMER_START_DELAY,
+                                        pTurnConnection->currentTimerCallingPeriod, turnConnectionTimerCallback, (UINT64) pTurnConnection,
+                                        (PUINT32) &timerCallbackId));
 
     ATOMIC_STORE(&pTurnConnection->timerCallbackId, timerCallbackId);
 
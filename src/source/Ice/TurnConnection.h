@@ -141,7 +141,6 @@ struct __TurnConnection {
     IceServer turnServer;
 
     MUTEX lock;
-    MUTEX sendLock;
     CVAR freeAllocationCvar;
 
     UINT64 state;
@@ -166,7 +165,7 @@ struct __TurnConnection {
 
     TurnConnectionCallbacks turnConnectionCallbacks;
 
-    PBYTE sendDataBuffer;
+    // Largest ChannelData message sent, header included. The message is framed on the stack of the sender
     UINT32 dataBufferSize;
 
     PBYTE recvDataBuffer;
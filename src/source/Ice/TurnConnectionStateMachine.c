@@ -580,15 +580,17 @@ STATUS fromReadyTurnState(UINT64 customData, PUINT64 pState)
         pTurnConnection->stateTimeoutTime = currentTime + DEFAULT_TURN_CREATE_PERMISSION_TIMEOUT;
         MUTEX_UNLOCK(pTurnConnection->lock);
         locked = FALSE;
-        CHK_STATUS(timerQueueUpdateTimerPeriod(pTurnConnection->timerQueueHandle, (UINT64) pTurnConnection,
-                                               (UINT32) ATOMIC_LOAD(&pTurnConnection->timerCallbackId), pTurnConnection->currentTimerCallingPeriod));
+        CHK_STATUS(sharedTimerQueueUpdateTimerPeriod(pTurnConnection->timerQueueHandle, (UINT64) pTurnConnection,
+                                                     (UINT32) ATOMIC_LOAD(&pTurnConnection->timerCallbackId),
+                                                     pTurnConnection->currentTimerCallingPeriod));
     } else if (pTurnConnection->currentTimerCallingPeriod != DEFAULT_TURN_TIMER_INTERVAL_AFTER_READY) {
         // use longer timer interval as now it just needs to check disconnection and permission expiration.
         pTurnConnection->currentTimerCallingPeriod = DEFAULT_TURN_TIMER_INTERVAL_AFTER_READY;
         MUTEX_UNLOCK(pTurnConnection->lock);
         locked = FALSE;
-        CHK_STATUS(timerQueueUpdateTimerPeriod(pTurnConnection->timerQueueHandle, (UINT64) pTurnConnection,
-                                               (UINT32) ATOMIC_LOAD(&pTurnConnection->timerCallbackId), pTurnConnection->currentTimerCallingPeriod));
+        CHK_STATUS(sharedTimerQueueUpdateTimerPeriod(pTurnConnection->timerQueueHandle, (UINT64) pTurnConnection,
+                                                     (UINT32) ATOMIC_LOAD(&pTurnConnection->timerCallbackId),
+                                                     pTurnConnection->currentTimerCallingPeriod));
     }
 
     *pState = state;
@@ -42,12 +42,17 @@ extern "C" {
 #if MBEDTLS_VERSION_NUMBER < 0x03000000
 #include <mbedtls/certs.h>
 #endif
+#include <mbedtls/sha1.h>
 #include <mbedtls/sha256.h>
 #include <mbedtls/md5.h>
 #endif
 
 #include <srtp2/srtp.h>
 
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
 // INET/INET6 MUST be defined before usrsctp
 // If removed will cause corruption that is hard to determine at runtime
 #define INET  1
@@ -70,6 +75,12 @@ extern "C" {
 #ifdef HAVE_POLL_H
 #include <poll.h>
 #endif
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#endif
+#ifdef HAVE_UDP_SEGMENT
+#include <netinet/udp.h>
+#endif
 #endif
 
 // Max uFrag and uPwd length as documented in https://tools.ietf.org/html/rfc5245#section-15.4
@@ -142,13 +153,16 @@ STATUS generateJSONSafeString(PCHAR, UINT32);
 // Project internal includes
 ////////////////////////////////////////////////////
 #include "Threadpool/ThreadpoolContext.h"
+#include "Timer/TimerWheel.h"
 #include "Crypto/IOBuffer.h"
 #include "Crypto/Crypto.h"
+#include "Crypto/CertificatePool.h"
 #include "Crypto/Dtls.h"
 #include "Crypto/Tls.h"
 #include "Ice/Network.h"
 #include "Ice/SocketConnection.h"
 #include "Ice/ConnectionListener.h"
+#include "Ice/NetworkReactor.h"
 #include "Stun/Stun.h"
 #include "Ice/IceUtils.h"
 #include "Sdp/Sdp.h"
@@ -169,10 +183,19 @@ STATUS generateJSONSafeString(PCHAR, UINT32);
 #include "Rtcp/RollingBuffer.h"
 #include "Rtcp/RtpRollingBuffer.h"
 #include "PeerConnection/JitterBuffer.h"
+#include "PeerConnection/SsrcTable.h"
+#include "PeerConnection/Pacer.h"
+#include "PeerConnection/CongestionController.h"
+#include "PeerConnection/NackGenerator.h"
+#include "PeerConnection/Fec.h"
+#include "PeerConnection/TwccFeedbackGenerator.h"
+#include "PeerConnection/ReceiveWorker.h"
+#include "PeerConnection/EgressBandwidthManager.h"
 #include "PeerConnection/PeerConnection.h"
 #include "PeerConnection/Retransmitter.h"
 #include "PeerConnection/SessionDescription.h"
 #include "PeerConnection/Rtp.h"
+#include "PeerConnection/RtpBroadcastGroup.h"
 #include "PeerConnection/Rtcp.h"
 #include "PeerConnection/DataChannel.h"
 #include "Rtp/Codecs/RtpVP8Payloader.h"
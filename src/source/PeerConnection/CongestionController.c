@@ -0,0 +1,317 @@
+#define LOG_CLASS "CongestionController"
+
+#include "../Include_i.h"
+
+STATUS createCongestionController(UINT64 startBitrate, PCongestionController* ppCongestionController)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PCongestionController pCongestionController = NULL;
+
+    CHK(ppCongestionController != NULL, STATUS_NULL_ARG);
+
+    CHK(NULL != (pCongestionController = (PCongestionController) MEMCALLOC(1, SIZEOF(CongestionController))), STATUS_NOT_ENOUGH_MEMORY);
+    pCongestionController->minBitrate = CONGESTION_CONTROL_MIN_BITRATE;
+    pCongestionController->maxBitrate = CONGESTION_CONTROL_MAX_BITRATE;
+    pCongestionController->targetBitrate = startBitrate == 0 ? CONGESTION_CONTROL_DEFAULT_START_BITRATE : startBitrate;
+    pCongestionController->targetBitrate =
+        MIN(MAX(pCongestionController->targetBitrate, pCongestionController->minBitrate), pCongestionController->maxBitrate);
+    pCongestionController->delayBasedBitrate = (DOUBLE) pCongestionController->targetBitrate;
+    pCongestionController->lossBasedBitrate = (DOUBLE) pCongestionController->targetBitrate;
+    pCongestionController->threshold = CONGESTION_CONTROL_INITIAL_THRESHOLD;
+    pCongestionController->timeOverUsing = -1;
+    pCongestionController->usage = CONGESTION_CONTROL_USAGE_NORMAL;
+    pCongestionController->rateState = CONGESTION_CONTROL_RATE_HOLD;
+
+    *ppCongestionController = pCongestionController;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeCongestionController(PCongestionController* ppCongestionController)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(ppCongestionController != NULL, STATUS_NULL_ARG);
+    SAFE_MEMFREE(*ppCongestionController);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS congestionControllerOnPacketFeedback(PCongestionController pCongestionController, PPacketFeedback pPacketFeedback, UINT32 packetCount,
+                                            UINT64 currentTime, PUINT64 pTargetBitrate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PPacketFeedback pPacket;
+    UINT32 i;
+    DOUBLE sendDelta, arrivalDelta, targetBitrate;
+
+    CHK(pCongestionController != NULL && (pPacketFeedback != NULL || packetCount == 0), STATUS_NULL_ARG);
+
+    for (i = 0; i < packetCount; i++) {
+        pPacket = pPacketFeedback + i;
+        pCongestionController->reportedPacketCount++;
+        if (pPacket->arrivalTime == TWCC_PACKET_LOST_TIME) {
+            pCongestionController->lostPacketCount++;
+            continue;
+        }
+
+        // Acknowledged bitrate, from what the remote end actually received
+        if (pCongestionController->ackWindowStartTime == 0 || pPacket->arrivalTime < pCongestionController->ackWindowStartTime) {
+            pCongestionController->ackWindowStartTime = pPacket->arrivalTime;
+            pCongestionController->ackWindowBytes = 0;
+        } else if (pPacket->arrivalTime - pCongestionController->ackWindowStartTime >= CONGESTION_CONTROL_ACKED_RATE_WINDOW) {
+            pCongestionController->acknowledgedBitrate = (DOUBLE) (pCongestionController->ackWindowBytes * 8 * HUNDREDS_OF_NANOS_IN_A_SECOND) /
+                (DOUBLE) (pPacket->arrivalTime - pCongestionController->ackWindowStartTime);
+            pCongestionController->ackWindowStartTime = pPacket->arrivalTime;
+            pCongestionController->ackWindowBytes = 0;
+        }
+        pCongestionController->ackWindowBytes += pPacket->packetSize;
+
+        // Inter-arrival of packet groups
+        if (!pCongestionController->hasCurrentGroup) {
+            pCongestionController->hasCurrentGroup = TRUE;
+            pCongestionController->groupFirstSendTime = pPacket->sendTime;
+            pCongestionController->groupLastSendTime = pPacket->sendTime;
+            pCongestionController->groupLastArrivalTime = pPacket->arrivalTime;
+            pCongestionController->firstArrivalTime = pPacket->arrivalTime;
+        } else if (pPacket->sendTime < pCongestionController->groupFirstSendTime) {
+            // Reordered across groups, can not be attributed to either of them
+            continue;
+        } else if (pPacket->sendTime - pCongestionController->groupFirstSendTime <= CONGESTION_CONTROL_BURST_INTERVAL) {
+            pCongestionController->groupLastSendTime = MAX(pCongestionController->groupLastSendTime, pPacket->sendTime);
+            pCongestionController->groupLastArrivalTime = MAX(pCongestionController->groupLastArrivalTime, pPacket->arrivalTime);
+        } else {
+            if (pCongestionController->hasPreviousGroup) {
+                sendDelta = (DOUBLE) (INT64) (pCongestionController->groupLastSendTime - pCongestionController->previousGroupLastSendTime) /
+                    HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+                arrivalDelta = (DOUBLE) (INT64) (pCongestionController->groupLastArrivalTime - pCongestionController->previousGroupLastArrivalTime) /
+                    HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+                congestionControllerOnGroupDelta(pCongestionController, sendDelta, arrivalDelta, pCongestionController->groupLastArrivalTime,
+                                                 currentTime);
+            }
+            pCongestionController->hasPreviousGroup = TRUE;
+            pCongestionController->previousGroupLastSendTime = pCongestionController->groupLastSendTime;
+            pCongestionController->previousGroupLastArrivalTime = pCongestionController->groupLastArrivalTime;
+            pCongestionController->groupFirstSendTime = pPacket->sendTime;
+            pCongestionController->groupLastSendTime = pPacket->sendTime;
+            pCongestionController->groupLastArrivalTime = pPacket->arrivalTime;
+        }
+    }
+
+    congestionControllerUpdateDelayBasedBitrate(pCongestionController, currentTime);
+    congestionControllerUpdateLossBasedBitrate(pCongestionController, currentTime);
+
+    targetBitrate = MIN(pCongestionController->delayBasedBitrate, pCongestionController->lossBasedBitrate);
+    targetBitrate = MIN(MAX(targetBitrate, (DOUBLE) pCongestionController->minBitrate), (DOUBLE) pCongestionController->maxBitrate);
+    pCongestionController->targetBitrate = (UINT64) targetBitrate;
+
+    if (pTargetBitrate != NULL) {
+        *pTargetBitrate = pCongestionController->targetBitrate;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+VOID congestionControllerOnGroupDelta(PCongestionController pCongestionController, DOUBLE sendDelta, DOUBLE arrivalDelta, UINT64 arrivalTime,
+                                      UINT64 currentTime)
+{
+    UINT32 index;
+    DOUBLE trend = 0;
+
+    pCongestionController->deltaCount = MIN(pCongestionController->deltaCount + 1, MAX_UINT16);
+    pCongestionController->accumulatedDelay += arrivalDelta - sendDelta;
+    pCongestionController->smoothedDelay = CONGESTION_CONTROL_TRENDLINE_SMOOTHING_COEF * pCongestionController->smoothedDelay +
+        (1 - CONGESTION_CONTROL_TRENDLINE_SMOOTHING_COEF) * pCongestionController->accumulatedDelay;
+
+    index = (pCongestionController->windowHead + pCongestionController->windowCount) % CONGESTION_CONTROL_TRENDLINE_WINDOW_SIZE;
+    if (pCongestionController->windowCount == CONGESTION_CONTROL_TRENDLINE_WINDOW_SIZE) {
+        pCongestionController->windowHead = (pCongestionController->windowHead + 1) % CONGESTION_CONTROL_TRENDLINE_WINDOW_SIZE;
+    } else {
+        pCongestionController->windowCount++;
+    }
+    pCongestionController->windowArrivalTimes[index] =
+        (DOUBLE) (arrivalTime - pCongestionController->firstArrivalTime) / HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    pCongestionController->windowSmoothedDelays[index] = pCongestionController->smoothedDelay;
+
+    if (pCongestionController->windowCount == CONGESTION_CONTROL_TRENDLINE_WINDOW_SIZE) {
+        trend = congestionControllerTrendlineSlope(pCongestionController);
+    }
+
+    congestionControllerDetect(pCongestionController, trend, sendDelta, currentTime);
+}
+
+DOUBLE congestionControllerTrendlineSlope(PCongestionController pCongestionController)
+{
+    UINT32 i, index;
+    DOUBLE meanX = 0, meanY = 0, numerator = 0, denominator = 0, x, y;
+
+    for (i = 0; i < pCongestionController->windowCount; i++) {
+        index = (pCongestionController->windowHead + i) % CONGESTION_CONTROL_TRENDLINE_WINDOW_SIZE;
+        meanX += pCongestionController->windowArrivalTimes[index];
+        meanY += pCongestionController->windowSmoothedDelays[index];
+    }
+    meanX /= pCongestionController->windowCount;
+    meanY /= pCongestionController->windowCount;
+
+    // Least squares fit of the smoothed delay against the arrival time
+    for (i = 0; i < pCongestionController->windowCount; i++) {
+        index = (pCongestionController->windowHead + i) % CONGESTION_CONTROL_TRENDLINE_WINDOW_SIZE;
+        x = pCongestionController->windowArrivalTimes[index] - meanX;
+        y = pCongestionController->windowSmoothedDelays[index] - meanY;
+        numerator += x * y;
+        denominator += x * x;
+    }
+
+    return denominator == 0 ? pCongestionController->previousTrend : numerator / denominator;
+}
+
+VOID congestionControllerDetect(PCongestionController pCongestionController, DOUBLE trend, DOUBLE sendDelta, UINT64 currentTime)
+{
+    DOUBLE modifiedTrend;
+
+    if (pCongestionController->deltaCount < 2) {
+        pCongestionController->usage = CONGESTION_CONTROL_USAGE_NORMAL;
+        return;
+    }
+
+    modifiedTrend = MIN(pCongestionController->deltaCount, CONGESTION_CONTROL_TRENDLINE_MAX_DELTA_COUNT) * trend *
+        CONGESTION_CONTROL_TRENDLINE_THRESHOLD_GAIN;
+
+    if (modifiedTrend > pCongestionController->threshold) {
+        if (pCongestionController->timeOverUsing < 0) {
+            // Assume the trend started halfway through the last delta
+            pCongestionController->timeOverUsing = sendDelta / 2;
+        } else {
+            pCongestionController->timeOverUsing += sendDelta;
+        }
+        pCongestionController->overuseCount++;
+        if (pCongestionController->timeOverUsing > CONGESTION_CONTROL_OVERUSE_TIME_THRESHOLD && pCongestionController->overuseCount > 1 &&
+            trend >= pCongestionController->previousTrend) {
+            pCongestionController->timeOverUsing = 0;
+            pCongestionController->overuseCount = 0;
+            pCongestionController->usage = CONGESTION_CONTROL_USAGE_OVERUSE;
+        }
+    } else if (modifiedTrend < -pCongestionController->threshold) {
+        pCongestionController->timeOverUsing = -1;
+        pCongestionController->overuseCount = 0;
+        pCongestionController->usage = CONGESTION_CONTROL_USAGE_UNDERUSE;
+    } else {
+        pCongestionController->timeOverUsing = -1;
+        pCongestionController->overuseCount = 0;
+        pCongestionController->usage = CONGESTION_CONTROL_USAGE_NORMAL;
+    }
+
+    pCongestionController->previousTrend = trend;
+    congestionControllerUpdateThreshold(pCongestionController, modifiedTrend, currentTime);
+}
+
+VOID congestionControllerUpdateThreshold(PCongestionController pCongestionController, DOUBLE modifiedTrend, UINT64 currentTime)
+{
+    DOUBLE absoluteTrend = modifiedTrend < 0 ? -modifiedTrend : modifiedTrend, k, elapsed;
+
+    if (pCongestionController->lastThresholdUpdateTime == 0) {
+        pCongestionController->lastThresholdUpdateTime = currentTime;
+    }
+
+    // Spikes such as a route change should not drag the threshold along
+    if (absoluteTrend > pCongestionController->threshold + CONGESTION_CONTROL_MAX_THRESHOLD_DELTA) {
+        pCongestionController->lastThresholdUpdateTime = currentTime;
+        return;
+    }
+
+    k = absoluteTrend < pCongestionController->threshold ? CONGESTION_CONTROL_THRESHOLD_K_DOWN : CONGESTION_CONTROL_THRESHOLD_K_UP;
+    elapsed = MIN((DOUBLE) (currentTime - pCongestionController->lastThresholdUpdateTime) / HUNDREDS_OF_NANOS_IN_A_MILLISECOND,
+                  CONGESTION_CONTROL_MAX_THRESHOLD_UPDATE_INTERVAL);
+    pCongestionController->threshold += k * (absoluteTrend - pCongestionController->threshold) * elapsed;
+    pCongestionController->threshold = MIN(MAX(pCongestionController->threshold, CONGESTION_CONTROL_MIN_THRESHOLD), CONGESTION_CONTROL_MAX_THRESHOLD);
+    pCongestionController->lastThresholdUpdateTime = currentTime;
+}
+
+VOID congestionControllerUpdateDelayBasedBitrate(PCongestionController pCongestionController, UINT64 currentTime)
+{
+    DOUBLE elapsed, maxBitrate;
+
+    // State machine of the draft section 5.5
+    switch (pCongestionController->usage) {
+        case CONGESTION_CONTROL_USAGE_OVERUSE:
+            pCongestionController->rateState = CONGESTION_CONTROL_RATE_DECREASE;
+            break;
+        case CONGESTION_CONTROL_USAGE_UNDERUSE:
+            pCongestionController->rateState = CONGESTION_CONTROL_RATE_HOLD;
+            break;
+        case CONGESTION_CONTROL_USAGE_NORMAL:
+            if (pCongestionController->rateState == CONGESTION_CONTROL_RATE_HOLD) {
+                pCongestionController->rateState = CONGESTION_CONTROL_RATE_INCREASE;
+            }
+            break;
+    }
+
+    switch (pCongestionController->rateState) {
+        case CONGESTION_CONTROL_RATE_INCREASE:
+            if (pCongestionController->lastRateUpdateTime != 0 && currentTime > pCongestionController->lastRateUpdateTime) {
+                elapsed = MIN((DOUBLE) (currentTime - pCongestionController->lastRateUpdateTime) / HUNDREDS_OF_NANOS_IN_A_SECOND, 1.0);
+                // Linear stand-in for the 1.08^elapsed of the draft, within 0.3% over a second and no libm dependency
+                pCongestionController->delayBasedBitrate *= 1 + (CONGESTION_CONTROL_INCREASE_FACTOR_PER_SECOND - 1) * elapsed;
+            }
+            // Do not run away from what the path has been shown to carry
+            if (pCongestionController->acknowledgedBitrate > 0) {
+                maxBitrate =
+                    CONGESTION_CONTROL_MAX_ACKED_RATE_RATIO * pCongestionController->acknowledgedBitrate + CONGESTION_CONTROL_ACKED_RATE_HEADROOM;
+                pCongestionController->delayBasedBitrate = MIN(pCongestionController->delayBasedBitrate, maxBitrate);
+            }
+            break;
+        case CONGESTION_CONTROL_RATE_DECREASE:
+            if (pCongestionController->acknowledgedBitrate > 0) {
+                pCongestionController->delayBasedBitrate = MIN(pCongestionController->delayBasedBitrate,
+                                                               CONGESTION_CONTROL_DECREASE_FACTOR * pCongestionController->acknowledgedBitrate);
+            } else {
+                pCongestionController->delayBasedBitrate *= CONGESTION_CONTROL_DECREASE_FACTOR;
+            }
+            // One decrease per overuse, the next one needs a new overuse signal
+            pCongestionController->rateState = CONGESTION_CONTROL_RATE_HOLD;
+            pCongestionController->usage = CONGESTION_CONTROL_USAGE_NORMAL;
+            break;
+        case CONGESTION_CONTROL_RATE_HOLD:
+            break;
+    }
+
+    pCongestionController->delayBasedBitrate =
+        MIN(MAX(pCongestionController->delayBasedBitrate, (DOUBLE) pCongestionController->minBitrate), (DOUBLE) pCongestionController->maxBitrate);
+    pCongestionController->lastRateUpdateTime = currentTime;
+}
+
+VOID congestionControllerUpdateLossBasedBitrate(PCongestionController pCongestionController, UINT64 currentTime)
+{
+    DOUBLE lossFraction;
+
+    if (pCongestionController->lastLossUpdateTime == 0) {
+        pCongestionController->lastLossUpdateTime = currentTime;
+    }
+    if (pCongestionController->reportedPacketCount == 0 ||
+        currentTime - pCongestionController->lastLossUpdateTime < CONGESTION_CONTROL_LOSS_UPDATE_INTERVAL) {
+        return;
+    }
+
+    lossFraction = (DOUBLE) pCongestionController->lostPacketCount / pCongestionController->reportedPacketCount;
+    if (lossFraction > CONGESTION_CONTROL_HIGH_LOSS_FRACTION) {
+        pCongestionController->lossBasedBitrate = pCongestionController->targetBitrate * (1 - 0.5 * lossFraction);
+    } else if (lossFraction < CONGESTION_CONTROL_LOW_LOSS_FRACTION) {
+        pCongestionController->lossBasedBitrate =
+            MIN(pCongestionController->lossBasedBitrate * CONGESTION_CONTROL_LOSS_INCREASE_FACTOR, (DOUBLE) pCongestionController->maxBitrate);
+    }
+
+    pCongestionController->lossBasedBitrate = MAX(pCongestionController->lossBasedBitrate, (DOUBLE) pCongestionController->minBitrate);
+    pCongestionController->lostPacketCount = 0;
+    pCongestionController->reportedPacketCount = 0;
+    pCongestionController->lastLossUpdateTime = currentTime;
+}
@@ -0,0 +1,159 @@
+/*******************************************
+CongestionController internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_CONGESTION_CONTROLLER__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_CONGESTION_CONTROLLER__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Google Congestion Control, https://datatracker.ietf.org/doc/html/draft-ietf-rmcat-gcc-02
+#define CONGESTION_CONTROL_DEFAULT_START_BITRATE (300 * 1024)
+#define CONGESTION_CONTROL_MIN_BITRATE           (30 * 1024)
+#define CONGESTION_CONTROL_MAX_BITRATE           (20 * 1024 * 1024)
+
+// Packets sent within this interval of the first packet of a group form one group, see the draft section 5.2
+#define CONGESTION_CONTROL_BURST_INTERVAL (5 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Trendline filter
+#define CONGESTION_CONTROL_TRENDLINE_WINDOW_SIZE     20
+#define CONGESTION_CONTROL_TRENDLINE_SMOOTHING_COEF  0.9
+#define CONGESTION_CONTROL_TRENDLINE_THRESHOLD_GAIN  4.0
+#define CONGESTION_CONTROL_TRENDLINE_MAX_DELTA_COUNT 60
+
+// Adaptive overuse threshold, in milliseconds
+#define CONGESTION_CONTROL_INITIAL_THRESHOLD   12.5
+#define CONGESTION_CONTROL_MIN_THRESHOLD       6.0
+#define CONGESTION_CONTROL_MAX_THRESHOLD       600.0
+#define CONGESTION_CONTROL_THRESHOLD_K_UP      0.0087
+#define CONGESTION_CONTROL_THRESHOLD_K_DOWN    0.039
+#define CONGESTION_CONTROL_MAX_THRESHOLD_DELTA 15.0
+// Longest gap, in milliseconds, the threshold adapts over in one update
+#define CONGESTION_CONTROL_MAX_THRESHOLD_UPDATE_INTERVAL 100.0
+// Time in milliseconds the trend has to stay above the threshold before overuse is signaled
+#define CONGESTION_CONTROL_OVERUSE_TIME_THRESHOLD 10.0
+
+// AIMD rate controller
+#define CONGESTION_CONTROL_INCREASE_FACTOR_PER_SECOND 1.08
+#define CONGESTION_CONTROL_DECREASE_FACTOR            0.85
+#define CONGESTION_CONTROL_MAX_ACKED_RATE_RATIO       1.5
+#define CONGESTION_CONTROL_ACKED_RATE_HEADROOM        (10 * 1024)
+#define CONGESTION_CONTROL_ACKED_RATE_WINDOW          (500 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Loss based controller, see the draft section 6
+#define CONGESTION_CONTROL_LOSS_UPDATE_INTERVAL (200 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define CONGESTION_CONTROL_LOW_LOSS_FRACTION    0.02
+#define CONGESTION_CONTROL_HIGH_LOSS_FRACTION   0.1
+#define CONGESTION_CONTROL_LOSS_INCREASE_FACTOR 1.05
+
+// Packets handed to the controller at once when converting a TWCC feedback
+#define CONGESTION_CONTROL_FEEDBACK_BATCH_SIZE 64
+
+typedef enum {
+    CONGESTION_CONTROL_USAGE_NORMAL,
+    CONGESTION_CONTROL_USAGE_UNDERUSE,
+    CONGESTION_CONTROL_USAGE_OVERUSE,
+} CONGESTION_CONTROL_USAGE;
+
+typedef enum {
+    CONGESTION_CONTROL_RATE_HOLD,
+    CONGESTION_CONTROL_RATE_INCREASE,
+    CONGESTION_CONTROL_RATE_DECREASE,
+} CONGESTION_CONTROL_RATE_STATE;
+
+/**
+ * Outcome of one sent packet as reported by TWCC feedback
+ */
+typedef struct {
+    // Local time the packet was sent at
+    UINT64 sendTime;
+    // Time the packet was received at, on the remote clock. TWCC_PACKET_LOST_TIME when reported lost
+    UINT64 arrivalTime;
+    UINT32 packetSize;
+} PacketFeedback, *PPacketFeedback;
+
+typedef struct {
+    BOOL hasCurrentGroup;
+    BOOL hasPreviousGroup;
+    UINT64 groupFirstSendTime;
+    UINT64 groupLastSendTime;
+    UINT64 groupLastArrivalTime;
+    UINT64 previousGroupLastSendTime;
+    UINT64 previousGroupLastArrivalTime;
+    UINT64 firstArrivalTime;
+
+    // Trendline filter, delays in milliseconds
+    UINT32 deltaCount;
+    DOUBLE accumulatedDelay;
+    DOUBLE smoothedDelay;
+    DOUBLE windowArrivalTimes[CONGESTION_CONTROL_TRENDLINE_WINDOW_SIZE];
+    DOUBLE windowSmoothedDelays[CONGESTION_CONTROL_TRENDLINE_WINDOW_SIZE];
+    UINT32 windowCount;
+    UINT32 windowHead;
+    DOUBLE previousTrend;
+
+    // Overuse detector
+    DOUBLE threshold;
+    UINT64 lastThresholdUpdateTime;
+    DOUBLE timeOverUsing;
+    UINT32 overuseCount;
+    CONGESTION_CONTROL_USAGE usage;
+
+    // Rate controllers, bits per second
+    CONGESTION_CONTROL_RATE_STATE rateState;
+    DOUBLE delayBasedBitrate;
+    UINT64 lastRateUpdateTime;
+    DOUBLE acknowledgedBitrate;
+    UINT64 ackWindowStartTime;
+    UINT64 ackWindowBytes;
+    DOUBLE lossBasedBitrate;
+    UINT64 lastLossUpdateTime;
+    UINT32 lostPacketCount;
+    UINT32 reportedPacketCount;
+
+    UINT64 minBitrate;
+    UINT64 maxBitrate;
+    UINT64 targetBitrate;
+} CongestionController, *PCongestionController;
+
+/**
+ * Create a congestion controller
+ *
+ * @param - UINT64 - IN - start bitrate in bits per second, CONGESTION_CONTROL_DEFAULT_START_BITRATE when 0
+ * @param - PCongestionController* - OUT - the new controller
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createCongestionController(UINT64, PCongestionController*);
+STATUS freeCongestionController(PCongestionController*);
+
+/**
+ * Run the estimators over the outcome of the packets covered by one TWCC feedback, in sequence number order
+ *
+ * @param - PCongestionController - IN - the controller
+ * @param - PPacketFeedback - IN - packets of the feedback
+ * @param - UINT32 - IN - number of packets
+ * @param - UINT64 - IN - current local time
+ * @param - PUINT64 - OUT - OPTIONAL - new target bitrate in bits per second
+ *
+ * @return - STATUS status of execution
+ */
+STATUS congestionControllerOnPacketFeedback(PCongestionController, PPacketFeedback, UINT32, UINT64, PUINT64);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+VOID congestionControllerOnGroupDelta(PCongestionController, DOUBLE, DOUBLE, UINT64, UINT64);
+DOUBLE congestionControllerTrendlineSlope(PCongestionController);
+VOID congestionControllerDetect(PCongestionController, DOUBLE, DOUBLE, UINT64);
+VOID congestionControllerUpdateThreshold(PCongestionController, DOUBLE, UINT64);
+VOID congestionControllerUpdateDelayBasedBitrate(PCongestionController, UINT64);
+VOID congestionControllerUpdateLossBasedBitrate(PCongestionController, UINT64);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_CONGESTION_CONTROLLER__ */
@@ -0,0 +1,456 @@
+/**
+ * Kinesis Video Producer Egress Bandwidth Manager
+ */
+#define LOG_CLASS "EgressBandwidthManager"
+#include "../Include_i.h"
+
+PEgressBandwidthManager getEgressBandwidthManagerInstance()
+{
+    static EgressBandwidthManager manager = {.lock = INVALID_MUTEX_VALUE, .capBitrate = 0, .pPeers = NULL};
+    return &manager;
+}
+
+STATUS createEgressBandwidthManager()
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PCHAR pCap;
+    UINT64 capBitrate = 0;
+
+    if (NULL != (pCap = GETENV(WEBRTC_EGRESS_BANDWIDTH_CAP_ENV_VAR)) && STATUS_SUCCESS != STRTOUI64(pCap, NULL, 10, &capBitrate)) {
+        DLOGW("Ignoring invalid %s value %s", WEBRTC_EGRESS_BANDWIDTH_CAP_ENV_VAR, pCap);
+        capBitrate = 0;
+    }
+
+    CHK_STATUS(initEgressBandwidthManager(getEgressBandwidthManagerInstance(), capBitrate));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS freeEgressBandwidthManager()
+{
+    return deinitEgressBandwidthManager(getEgressBandwidthManagerInstance());
+}
+
+STATUS initEgressBandwidthManager(PEgressBandwidthManager pManager, UINT64 capBitrate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pManager != NULL, STATUS_NULL_ARG);
+    CHK_ERR(!IS_VALID_MUTEX_VALUE(pManager->lock), STATUS_INVALID_OPERATION, "Egress bandwidth manager has been initialized already");
+
+    // Recursive so that the callbacks can change the weights
+    pManager->lock = MUTEX_CREATE(TRUE);
+    CHK(IS_VALID_MUTEX_VALUE(pManager->lock), STATUS_INVALID_OPERATION);
+    pManager->capBitrate = capBitrate;
+    pManager->pPeers = NULL;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS deinitEgressBandwidthManager(PEgressBandwidthManager pManager)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pManager != NULL, STATUS_NULL_ARG);
+    CHK_WARN(IS_VALID_MUTEX_VALUE(pManager->lock), STATUS_INVALID_OPERATION, "Egress bandwidth manager not initialized, nothing to free");
+
+    if (pManager->pPeers != NULL) {
+        DLOGW("Freeing the egress bandwidth manager with peers still added");
+    }
+
+    MUTEX_FREE(pManager->lock);
+    // All members of the static instance must be reset so that the manager can be created again
+    pManager->lock = INVALID_MUTEX_VALUE;
+    pManager->capBitrate = 0;
+    pManager->pPeers = NULL;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS egressBandwidthManagerSetCap(PEgressBandwidthManager pManager, UINT64 capBitrate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+
+    CHK(pManager != NULL, STATUS_NULL_ARG);
+    CHK(IS_VALID_MUTEX_VALUE(pManager->lock), STATUS_INVALID_OPERATION);
+
+    MUTEX_LOCK(pManager->lock);
+    locked = TRUE;
+
+    if (pManager->capBitrate != capBitrate) {
+        DLOGI("Egress bandwidth cap set to %" PRIu64 " bps", capBitrate);
+        pManager->capBitrate = capBitrate;
+        egressBandwidthManagerReallocate(pManager);
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pManager->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS egressBandwidthManagerAddPeer(PEgressBandwidthManager pManager, PEgressBandwidthPeer pPeer, RtcOnTargetBitrate onAllocation,
+                                     UINT64 customData)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+
+    CHK(pManager != NULL && pPeer != NULL, STATUS_NULL_ARG);
+    CHK(IS_VALID_MUTEX_VALUE(pManager->lock) && pPeer->pManager == NULL, STATUS_INVALID_OPERATION);
+
+    MUTEX_LOCK(pManager->lock);
+    locked = TRUE;
+
+    pPeer->estimate = 0;
+    pPeer->allocatedBitrate = 0;
+    pPeer->onAllocation = onAllocation;
+    pPeer->onAllocationCustomData = customData;
+    pPeer->pFlows = NULL;
+    pPeer->pManager = pManager;
+    pPeer->pNext = pManager->pPeers;
+    pManager->pPeers = pPeer;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pManager->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS egressBandwidthManagerRemovePeer(PEgressBandwidthPeer pPeer)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    PEgressBandwidthManager pManager = NULL;
+    PEgressBandwidthPeer* ppCur;
+    PEgressBandwidthFlow pFlow, pNextFlow;
+
+    CHK(pPeer != NULL, STATUS_NULL_ARG);
+    CHK((pManager = pPeer->pManager) != NULL, retStatus);
+
+    MUTEX_LOCK(pManager->lock);
+    locked = TRUE;
+
+    for (ppCur = &pManager->pPeers; *ppCur != NULL; ppCur = &(*ppCur)->pNext) {
+        if (*ppCur == pPeer) {
+            *ppCur = pPeer->pNext;
+            break;
+        }
+    }
+
+    for (pFlow = pPeer->pFlows; pFlow != NULL; pFlow = pNextFlow) {
+        pNextFlow = pFlow->pNext;
+        pFlow->pPeer = NULL;
+        pFlow->pNext = NULL;
+    }
+
+    pPeer->pFlows = NULL;
+    pPeer->pNext = NULL;
+    pPeer->pManager = NULL;
+
+    // What the peer was given goes back to the others
+    egressBandwidthManagerReallocate(pManager);
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pManager->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS egressBandwidthPeerOnEstimate(PEgressBandwidthPeer pPeer, UINT64 estimate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    PEgressBandwidthManager pManager = NULL;
+
+    CHK(pPeer != NULL, STATUS_NULL_ARG);
+    CHK((pManager = pPeer->pManager) != NULL, STATUS_INVALID_OPERATION);
+
+    MUTEX_LOCK(pManager->lock);
+    locked = TRUE;
+
+    if (pPeer->estimate != estimate) {
+        pPeer->estimate = estimate;
+        egressBandwidthManagerReallocate(pManager);
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pManager->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS egressBandwidthPeerAddFlow(PEgressBandwidthPeer pPeer, PEgressBandwidthFlow pFlow, UINT32 weight, UINT64 maxBitrate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    PEgressBandwidthManager pManager = NULL;
+
+    CHK(pPeer != NULL && pFlow != NULL, STATUS_NULL_ARG);
+    CHK(weight > 0, STATUS_INVALID_ARG);
+    CHK((pManager = pPeer->pManager) != NULL, STATUS_INVALID_OPERATION);
+
+    MUTEX_LOCK(pManager->lock);
+    locked = TRUE;
+
+    CHK(pFlow->pPeer == NULL, STATUS_INVALID_OPERATION);
+
+    pFlow->weight = weight;
+    pFlow->maxBitrate = maxBitrate;
+    pFlow->allocatedBitrate = 0;
+    pFlow->targetBitrate = 0;
+    pFlow->pManager = pManager;
+    pFlow->pPeer = pPeer;
+    pFlow->pNext = pPeer->pFlows;
+    pPeer->pFlows = pFlow;
+
+    egressBandwidthManagerReallocate(pManager);
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pManager->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS egressBandwidthFlowRemove(PEgressBandwidthFlow pFlow)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    PEgressBandwidthManager pManager = NULL;
+    PEgressBandwidthFlow* ppCur;
+
+    CHK(pFlow != NULL, STATUS_NULL_ARG);
+    CHK((pManager = pFlow->pManager) != NULL, retStatus);
+
+    MUTEX_LOCK(pManager->lock);
+    locked = TRUE;
+
+    // Already gone along with its peer
+    CHK(pFlow->pPeer != NULL, retStatus);
+
+    for (ppCur = &pFlow->pPeer->pFlows; *ppCur != NULL; ppCur = &(*ppCur)->pNext) {
+        if (*ppCur == pFlow) {
+            *ppCur = pFlow->pNext;
+            break;
+        }
+    }
+
+    pFlow->pPeer = NULL;
+    pFlow->pNext = NULL;
+
+    egressBandwidthManagerReallocate(pManager);
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pManager->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS egressBandwidthFlowSetShare(PEgressBandwidthFlow pFlow, UINT32 weight, UINT64 maxBitrate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PEgressBandwidthManager pManager = NULL;
+
+    CHK(pFlow != NULL, STATUS_NULL_ARG);
+    CHK(weight > 0, STATUS_INVALID_ARG);
+
+    if ((pManager = pFlow->pManager) != NULL) {
+        MUTEX_LOCK(pManager->lock);
+    }
+
+    pFlow->weight = weight;
+    pFlow->maxBitrate = maxBitrate;
+
+    if (pManager != NULL) {
+        if (pFlow->pPeer != NULL) {
+            egressBandwidthManagerReallocate(pManager);
+        }
+        MUTEX_UNLOCK(pManager->lock);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS egressBandwidthFlowSetCallback(PEgressBandwidthFlow pFlow, UINT64 customData, RtcOnTargetBitrate onTargetBitrate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PEgressBandwidthManager pManager = NULL;
+
+    CHK(pFlow != NULL, STATUS_NULL_ARG);
+
+    if ((pManager = pFlow->pManager) != NULL) {
+        MUTEX_LOCK(pManager->lock);
+    }
+
+    pFlow->onTargetBitrate = onTargetBitrate;
+    pFlow->onTargetBitrateCustomData = customData;
+
+    // Do not leave the new callback waiting for the next feedback
+    if (pFlow->pPeer != NULL && pFlow->allocatedBitrate != 0 && onTargetBitrate != NULL) {
+        pFlow->targetBitrate = pFlow->allocatedBitrate;
+        onTargetBitrate(customData, pFlow->targetBitrate);
+    }
+
+    if (pManager != NULL) {
+        MUTEX_UNLOCK(pManager->lock);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+VOID egressBandwidthWaterFill(PEgressBandwidthPeer pPeers, BOOL singlePeer, DOUBLE capacity)
+{
+    PEgressBandwidthPeer pPeer;
+    PEgressBandwidthFlow pFlow;
+    DOUBLE remaining = capacity, totalWeight, share;
+    BOOL progress = TRUE;
+
+    for (pPeer = pPeers; pPeer != NULL; pPeer = singlePeer ? NULL : pPeer->pNext) {
+        for (pFlow = pPeer->pFlows; pFlow != NULL; pFlow = pFlow->pNext) {
+            pFlow->allocation = pFlow->limit;
+            pFlow->settled = capacity < 0;
+        }
+    }
+
+    // Progressive filling. The flows that need less than their share of what is left settle at their limit, which
+    // raises the share of the others. Once every flow left can use its share, they get it.
+    while (capacity >= 0 && progress) {
+        progress = FALSE;
+        totalWeight = 0;
+        for (pPeer = pPeers; pPeer != NULL; pPeer = singlePeer ? NULL : pPeer->pNext) {
+            for (pFlow = pPeer->pFlows; pFlow != NULL; pFlow = pFlow->pNext) {
+                if (!pFlow->settled) {
+                    totalWeight += pFlow->weight;
+                }
+            }
+        }
+
+        if (totalWeight == 0) {
+            break;
+        }
+
+        share = MAX(remaining, 0) / totalWeight;
+        for (pPeer = pPeers; pPeer != NULL; pPeer = singlePeer ? NULL : pPeer->pNext) {
+            for (pFlow = pPeer->pFlows; pFlow != NULL; pFlow = pFlow->pNext) {
+                if (!pFlow->settled && pFlow->limit >= 0 && pFlow->limit <= share * pFlow->weight) {
+                    pFlow->allocation = pFlow->limit;
+                    pFlow->settled = TRUE;
+                    remaining -= pFlow->limit;
+                    progress = TRUE;
+                }
+            }
+        }
+
+        if (!progress) {
+            for (pPeer = pPeers; pPeer != NULL; pPeer = singlePeer ? NULL : pPeer->pNext) {
+                for (pFlow = pPeer->pFlows; pFlow != NULL; pFlow = pFlow->pNext) {
+                    if (!pFlow->settled) {
+                        pFlow->allocation = share * pFlow->weight;
+                        pFlow->settled = TRUE;
+                    }
+                }
+            }
+        }
+    }
+}
+
+VOID egressBandwidthManagerReallocate(PEgressBandwidthManager pManager)
+{
+    PEgressBandwidthPeer pPeer;
+    PEgressBandwidthFlow pFlow;
+    UINT64 peerBitrate;
+    BOOL peerUnlimited;
+
+    // What each flow could use is its weighted share of the estimate of its own peer
+    for (pPeer = pManager->pPeers; pPeer != NULL; pPeer = pPeer->pNext) {
+        for (pFlow = pPeer->pFlows; pFlow != NULL; pFlow = pFlow->pNext) {
+            pFlow->limit = pFlow->maxBitrate == 0 ? EGRESS_BANDWIDTH_UNLIMITED : (DOUBLE) pFlow->maxBitrate;
+        }
+
+        egressBandwidthWaterFill(pPeer, TRUE, pPeer->estimate == 0 ? EGRESS_BANDWIDTH_UNLIMITED : (DOUBLE) pPeer->estimate);
+
+        for (pFlow = pPeer->pFlows; pFlow != NULL; pFlow = pFlow->pNext) {
+            pFlow->limit = pFlow->allocation;
+        }
+    }
+
+    // Then the cap is shared between all the flows, the slow peers leaving to the others what they can not use
+    egressBandwidthWaterFill(pManager->pPeers, FALSE, pManager->capBitrate == 0 ? EGRESS_BANDWIDTH_UNLIMITED : (DOUBLE) pManager->capBitrate);
+
+    for (pPeer = pManager->pPeers; pPeer != NULL; pPeer = pPeer->pNext) {
+        peerBitrate = 0;
+        peerUnlimited = FALSE;
+        for (pFlow = pPeer->pFlows; pFlow != NULL; pFlow = pFlow->pNext) {
+            if (pFlow->allocation < 0) {
+                pFlow->allocatedBitrate = 0;
+                peerUnlimited = TRUE;
+            } else {
+                pFlow->allocatedBitrate = MAX(1, (UINT64) pFlow->allocation);
+                peerBitrate += pFlow->allocatedBitrate;
+            }
+
+            egressBandwidthFlowNotify(pFlow);
+        }
+
+        if (pPeer->pFlows == NULL) {
+            // Nothing to share, the peer is only bounded by its own estimate and the cap
+            peerBitrate = pPeer->estimate;
+            if (pManager->capBitrate != 0 && (peerBitrate == 0 || peerBitrate > pManager->capBitrate)) {
+                peerBitrate = pManager->capBitrate;
+            }
+        } else if (peerUnlimited || (pPeer->estimate == 0 && pManager->capBitrate == 0)) {
+            // Only the maximums of the flows bound the peer, the pacer is left alone until there is an estimate
+            peerBitrate = 0;
+        }
+
+        if (peerBitrate != 0 && peerBitrate != pPeer->allocatedBitrate && pPeer->onAllocation != NULL) {
+            pPeer->onAllocation(pPeer->onAllocationCustomData, peerBitrate);
+        }
+
+        pPeer->allocatedBitrate = peerBitrate;
+    }
+}
+
+VOID egressBandwidthFlowNotify(PEgressBandwidthFlow pFlow)
+{
+    UINT64 delta;
+
+    if (pFlow->allocatedBitrate == 0 || pFlow->onTargetBitrate == NULL) {
+        return;
+    }
+
+    delta = pFlow->allocatedBitrate > pFlow->targetBitrate ? pFlow->allocatedBitrate - pFlow->targetBitrate
+                                                           : pFlow->targetBitrate - pFlow->allocatedBitrate;
+    if (pFlow->targetBitrate == 0 || delta * 100 > pFlow->targetBitrate * EGRESS_BANDWIDTH_NOTIFY_THRESHOLD_PERCENT) {
+        pFlow->targetBitrate = pFlow->allocatedBitrate;
+        pFlow->onTargetBitrate(pFlow->onTargetBitrateCustomData, pFlow->targetBitrate);
+    }
+}
@@ -0,0 +1,232 @@
+/*******************************************
+Egress Bandwidth Manager internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_EGRESS_BANDWIDTH_MANAGER__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_EGRESS_BANDWIDTH_MANAGER__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Weight of a flow unless changed with transceiverSetEgressBandwidthShare
+#define EGRESS_BANDWIDTH_DEFAULT_WEIGHT 1
+
+// Audio flows never need more than this, the rest of their fair share goes to the video flows
+#define EGRESS_BANDWIDTH_DEFAULT_AUDIO_MAX_BITRATE (128 * 1024)
+
+// A flow is only told about a new target when it moved by more than this, so encoders are not reconfigured on every feedback
+#define EGRESS_BANDWIDTH_NOTIFY_THRESHOLD_PERCENT 5
+
+// Limit and allocation of a flow that nothing bounds
+#define EGRESS_BANDWIDTH_UNLIMITED ((DOUBLE) -1)
+
+struct __EgressBandwidthPeer;
+struct __EgressBandwidthManager;
+
+/**
+ * One sending transceiver. Embedded in the KvsRtpTransceiver.
+ */
+typedef struct __EgressBandwidthFlow EgressBandwidthFlow;
+struct __EgressBandwidthFlow {
+    UINT32 weight;
+    // 0 when the flow takes whatever it is given
+    UINT64 maxBitrate;
+
+    RtcOnTargetBitrate onTargetBitrate;
+    UINT64 onTargetBitrateCustomData;
+
+    // Outcome of the last allocation, 0 while nothing bounds the flow
+    UINT64 allocatedBitrate;
+    // Last target given to onTargetBitrate
+    UINT64 targetBitrate;
+
+    // Scratch of the allocation
+    DOUBLE limit;
+    DOUBLE allocation;
+    BOOL settled;
+
+    // Set once the flow has been added, never cleared so that removal is always done under the manager lock
+    struct __EgressBandwidthManager* pManager;
+    // NULL once removed, or once its peer has been removed
+    struct __EgressBandwidthPeer* pPeer;
+    struct __EgressBandwidthFlow* pNext;
+};
+typedef struct __EgressBandwidthFlow* PEgressBandwidthFlow;
+
+/**
+ * One PeerConnection. Embedded in the KvsPeerConnection.
+ */
+typedef struct __EgressBandwidthPeer EgressBandwidthPeer;
+struct __EgressBandwidthPeer {
+    // Latest congestion controller or REMB estimate, 0 until the first feedback
+    UINT64 estimate;
+
+    // Given the sum of the allocations of the flows, used to set the pacer of the PeerConnection
+    RtcOnTargetBitrate onAllocation;
+    UINT64 onAllocationCustomData;
+    UINT64 allocatedBitrate;
+
+    // NULL unless added to a manager
+    struct __EgressBandwidthManager* pManager;
+    PEgressBandwidthFlow pFlows;
+    struct __EgressBandwidthPeer* pNext;
+};
+typedef struct __EgressBandwidthPeer* PEgressBandwidthPeer;
+
+/**
+ * Splits a process wide uplink cap between the sending transceivers of the PeerConnections that opt in through
+ * KvsRtcConfiguration.useEgressBandwidthManager. Every time an estimate or the cap changes, the estimate of each
+ * PeerConnection is first split between its own flows, which gives what each flow could use, then the cap is split
+ * between all the flows. Both splits are weighted max-min fair: a flow that needs less than its share keeps what it
+ * needs and the rest is shared between the others in proportion to their weights.
+ *
+ * The callbacks are invoked with the manager lock held, from whichever thread reported the change. The lock is
+ * recursive so the callbacks can change the weights, but they must not block.
+ */
+typedef struct __EgressBandwidthManager EgressBandwidthManager;
+struct __EgressBandwidthManager {
+    MUTEX lock;
+    // 0 when the uplink is not capped
+    UINT64 capBitrate;
+    PEgressBandwidthPeer pPeers;
+};
+typedef struct __EgressBandwidthManager* PEgressBandwidthManager;
+
+/**
+ * Get the process wide egress bandwidth manager
+ *
+ * @return - PEgressBandwidthManager - the singleton
+ */
+PEgressBandwidthManager getEgressBandwidthManagerInstance();
+
+/**
+ * Make the egress bandwidth manager available, capped by WEBRTC_EGRESS_BANDWIDTH_CAP_ENV_VAR. Called by initKvsWebRtc.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createEgressBandwidthManager();
+
+/**
+ * Called by deinitKvsWebRtc once all the PeerConnections have been freed
+ *
+ * @return - STATUS status of execution
+ */
+STATUS freeEgressBandwidthManager();
+
+/**
+ * Initialize a manager
+ *
+ * @param - PEgressBandwidthManager - IN - manager to initialize
+ * @param - UINT64 - IN - uplink cap in bits per second, 0 for none
+ *
+ * @return - STATUS status of execution
+ */
+STATUS initEgressBandwidthManager(PEgressBandwidthManager, UINT64);
+
+/**
+ * Release a manager initialized with initEgressBandwidthManager. The peers must have been removed.
+ *
+ * @param - PEgressBandwidthManager - IN - manager
+ *
+ * @return - STATUS status of execution
+ */
+STATUS deinitEgressBandwidthManager(PEgressBandwidthManager);
+
+/**
+ * Change the uplink cap and reallocate
+ *
+ * @param - PEgressBandwidthManager - IN - manager
+ * @param - UINT64 - IN - uplink cap in bits per second, 0 for none
+ *
+ * @return - STATUS status of execution
+ */
+STATUS egressBandwidthManagerSetCap(PEgressBandwidthManager, UINT64);
+
+/**
+ * Add a peer, without any flow nor estimate
+ *
+ * @param - PEgressBandwidthManager - IN - manager
+ * @param - PEgressBandwidthPeer - IN - zeroed peer
+ * @param - RtcOnTargetBitrate - IN/OPT - given the sum of the allocations of the flows of the peer
+ * @param - UINT64 - IN - customData passed to the callback
+ *
+ * @return - STATUS status of execution
+ */
+STATUS egressBandwidthManagerAddPeer(PEgressBandwidthManager, PEgressBandwidthPeer, RtcOnTargetBitrate, UINT64);
+
+/**
+ * Remove a peer along with its flows and reallocate. No callback of the peer nor of its flows is invoked once this
+ * returns. Does nothing for a peer that has not been added.
+ *
+ * @param - PEgressBandwidthPeer - IN - peer
+ *
+ * @return - STATUS status of execution
+ */
+STATUS egressBandwidthManagerRemovePeer(PEgressBandwidthPeer);
+
+/**
+ * Report a new estimate of what the path to the peer can carry and reallocate
+ *
+ * @param - PEgressBandwidthPeer - IN - peer
+ * @param - UINT64 - IN - estimate in bits per second
+ *
+ * @return - STATUS status of execution
+ */
+STATUS egressBandwidthPeerOnEstimate(PEgressBandwidthPeer, UINT64);
+
+/**
+ * Add a flow to a peer and reallocate
+ *
+ * @param - PEgressBandwidthPeer - IN - peer
+ * @param - PEgressBandwidthFlow - IN - flow, its callback is kept
+ * @param - UINT32 - IN - weight, at least 1
+ * @param - UINT64 - IN - bitrate the flow never needs more than, 0 for none
+ *
+ * @return - STATUS status of execution
+ */
+STATUS egressBandwidthPeerAddFlow(PEgressBandwidthPeer, PEgressBandwidthFlow, UINT32, UINT64);
+
+/**
+ * Remove a flow from its peer and reallocate. Does nothing for a flow that has not been added or has been removed.
+ *
+ * @param - PEgressBandwidthFlow - IN - flow
+ *
+ * @return - STATUS status of execution
+ */
+STATUS egressBandwidthFlowRemove(PEgressBandwidthFlow);
+
+/**
+ * Change the weight and the maximum of a flow, and reallocate if the flow has been added
+ *
+ * @param - PEgressBandwidthFlow - IN - flow
+ * @param - UINT32 - IN - weight, at least 1
+ * @param - UINT64 - IN - bitrate the flow never needs more than, 0 for none
+ *
+ * @return - STATUS status of execution
+ */
+STATUS egressBandwidthFlowSetShare(PEgressBandwidthFlow, UINT32, UINT64);
+
+/**
+ * Set the callback given the target of a flow. Invoked right away when the flow already has a target.
+ *
+ * @param - PEgressBandwidthFlow - IN - flow
+ * @param - UINT64 - IN - customData passed to the callback
+ * @param - RtcOnTargetBitrate - IN/OPT - callback
+ *
+ * @return - STATUS status of execution
+ */
+STATUS egressBandwidthFlowSetCallback(PEgressBandwidthFlow, UINT64, RtcOnTargetBitrate);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+VOID egressBandwidthManagerReallocate(PEgressBandwidthManager);
+VOID egressBandwidthWaterFill(PEgressBandwidthPeer, BOOL, DOUBLE);
+VOID egressBandwidthFlowNotify(PEgressBandwidthFlow);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_EGRESS_BANDWIDTH_MANAGER__ */
@@ -0,0 +1,619 @@
+#define LOG_CLASS "Fec"
+
+#include "../Include_i.h"
+
+STATUS createFecEncoder(UINT32 groupSize, UINT32 maxProtectionPercent, PFecEncoder* ppFecEncoder)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFecEncoder pFecEncoder = NULL;
+
+    CHK(ppFecEncoder != NULL, STATUS_NULL_ARG);
+    groupSize = groupSize == 0 ? FEC_DEFAULT_GROUP_SIZE : groupSize;
+    maxProtectionPercent = maxProtectionPercent == 0 ? FEC_DEFAULT_MAX_PROTECTION_PERCENT : maxProtectionPercent;
+    CHK_ERR(groupSize <= FEC_MAX_GROUP_SIZE, STATUS_INVALID_ARG, "FEC group size %u is more than the %u packets a mask covers", groupSize,
+            FEC_MAX_GROUP_SIZE);
+    CHK_ERR(maxProtectionPercent <= 100, STATUS_INVALID_ARG, "FEC protection of %u%% is more than one FEC packet per media packet",
+            maxProtectionPercent);
+
+    CHK(NULL != (pFecEncoder = (PFecEncoder) MEMCALLOC(1, SIZEOF(FecEncoder))), STATUS_NOT_ENOUGH_MEMORY);
+    pFecEncoder->groupSize = groupSize;
+    pFecEncoder->maxProtectionPercent = maxProtectionPercent;
+    ATOMIC_STORE(&pFecEncoder->protectionPercent, (SIZE_T) MIN(FEC_INITIAL_PROTECTION_PERCENT, maxProtectionPercent));
+    CHK(NULL != (pFecEncoder->pPackets = (PBYTE) MEMALLOC(groupSize * FEC_MAX_PACKET_LENGTH)), STATUS_NOT_ENOUGH_MEMORY);
+
+    *ppFecEncoder = pFecEncoder;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freeFecEncoder(&pFecEncoder);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeFecEncoder(PFecEncoder* ppFecEncoder)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFecEncoder pFecEncoder = NULL;
+
+    CHK(ppFecEncoder != NULL, STATUS_NULL_ARG);
+    pFecEncoder = *ppFecEncoder;
+    CHK(pFecEncoder != NULL, retStatus);
+
+    SAFE_MEMFREE(pFecEncoder->pPackets);
+    SAFE_MEMFREE(pFecEncoder->pFecPayloads);
+    SAFE_MEMFREE(pFecEncoder->fecPayloadLengths);
+    SAFE_MEMFREE(pFecEncoder);
+
+    *ppFecEncoder = NULL;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS fecEncoderOnLoss(PFecEncoder pFecEncoder, DOUBLE fractionLost)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 protectionPercent;
+
+    CHK(pFecEncoder != NULL, STATUS_NULL_ARG);
+    CHK(fractionLost >= 0.0 && fractionLost <= 1.0, STATUS_INVALID_ARG);
+
+    // Rounded up so that any loss gets some protection, none at all on a clean path
+    protectionPercent = (UINT32) (fractionLost * 100 * FEC_LOSS_PROTECTION_MULTIPLIER + 0.999);
+    protectionPercent = MIN(protectionPercent, pFecEncoder->maxProtectionPercent);
+    ATOMIC_STORE(&pFecEncoder->protectionPercent, (SIZE_T) protectionPercent);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS fecEncoderProtect(PFecEncoder pFecEncoder, PRtpPacket pRtpPackets, UINT32 packetCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacket pRtpPacket;
+    UINT32 i, packetLength;
+
+    CHK(pFecEncoder != NULL && (pRtpPackets != NULL || packetCount == 0), STATUS_NULL_ARG);
+
+    // The payloads of the previous call have been sent
+    pFecEncoder->fecPacketCount = 0;
+
+    for (i = 0; i < packetCount; i++) {
+        pRtpPacket = pRtpPackets + i;
+        packetLength = RTP_GET_RAW_PACKET_SIZE(pRtpPacket);
+
+        // Packets missed by the encoder break the group, the receiver could not recover anything past the gap
+        if (pFecEncoder->packetCount > 0 &&
+            pRtpPacket->header.sequenceNumber != (UINT16) (pFecEncoder->baseSequenceNumber + pFecEncoder->packetCount)) {
+            CHK_STATUS(fecEncoderCloseGroup(pFecEncoder));
+        }
+
+        if (ATOMIC_LOAD(&pFecEncoder->protectionPercent) == 0 || packetLength > FEC_MAX_PACKET_LENGTH) {
+            CHK_STATUS(fecEncoderCloseGroup(pFecEncoder));
+            continue;
+        }
+
+        if (pFecEncoder->packetCount == 0) {
+            pFecEncoder->baseSequenceNumber = pRtpPacket->header.sequenceNumber;
+        }
+
+        CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, pFecEncoder->pPackets + pFecEncoder->packetCount * FEC_MAX_PACKET_LENGTH, &packetLength));
+        pFecEncoder->packetLengths[pFecEncoder->packetCount++] = packetLength;
+
+        if (pFecEncoder->packetCount == pFecEncoder->groupSize || (pRtpPacket->header.marker && pFecEncoder->packetCount >= FEC_MIN_GROUP_SIZE)) {
+            CHK_STATUS(fecEncoderCloseGroup(pFecEncoder));
+        }
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS fecEncoderCloseGroup(PFecEncoder pFecEncoder)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 fecCount, capacity, levelHeaderLength, protectionLength, mediaLength, i, j, b;
+    UINT16 lengthRecovery;
+    BOOL longMask;
+    PBYTE pFec, pProtected, pPacket, pNewPayloads;
+    PUINT32 pNewLengths;
+
+    CHK(pFecEncoder != NULL, STATUS_NULL_ARG);
+    CHK(pFecEncoder->packetCount > 0, retStatus);
+
+    fecCount = (pFecEncoder->packetCount * (UINT32) ATOMIC_LOAD(&pFecEncoder->protectionPercent) + 99) / 100;
+    fecCount = MIN(fecCount, pFecEncoder->packetCount);
+    CHK(fecCount > 0, retStatus);
+
+    if (pFecEncoder->fecPacketCount + fecCount > pFecEncoder->fecPacketCapacity) {
+        capacity = MAX(pFecEncoder->fecPacketCount + fecCount, 2 * pFecEncoder->fecPacketCapacity);
+        pNewPayloads = (PBYTE) MEMREALLOC(pFecEncoder->pFecPayloads, capacity * FEC_ENCODER_PAYLOAD_SLOT_LENGTH);
+        CHK(pNewPayloads != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pFecEncoder->pFecPayloads = pNewPayloads;
+        pNewLengths = (PUINT32) MEMREALLOC(pFecEncoder->fecPayloadLengths, capacity * SIZEOF(UINT32));
+        CHK(pNewLengths != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pFecEncoder->fecPayloadLengths = pNewLengths;
+        pFecEncoder->fecPacketCapacity = capacity;
+    }
+
+    longMask = pFecEncoder->packetCount > FEC_SHORT_MASK_GROUP_SIZE;
+    levelHeaderLength = longMask ? FEC_LEVEL_HEADER_LONG_LENGTH : FEC_LEVEL_HEADER_LENGTH;
+
+    // Packet j goes to FEC packet j % fecCount, consecutive losses are repaired by different FEC packets
+    for (i = 0; i < fecCount; i++) {
+        pFec = pFecEncoder->pFecPayloads + pFecEncoder->fecPacketCount * FEC_ENCODER_PAYLOAD_SLOT_LENGTH + RED_PRIMARY_HEADER_LENGTH;
+        pProtected = pFec + FEC_HEADER_LENGTH + levelHeaderLength;
+
+        protectionLength = 0;
+        for (j = i; j < pFecEncoder->packetCount; j += fecCount) {
+            protectionLength = MAX(protectionLength, pFecEncoder->packetLengths[j] - MIN_HEADER_LENGTH);
+        }
+        MEMSET(pFec, 0x00, FEC_HEADER_LENGTH + levelHeaderLength + protectionLength);
+
+        lengthRecovery = 0;
+        for (j = i; j < pFecEncoder->packetCount; j += fecCount) {
+            pPacket = pFecEncoder->pPackets + j * FEC_MAX_PACKET_LENGTH;
+            mediaLength = pFecEncoder->packetLengths[j] - MIN_HEADER_LENGTH;
+
+            pFec[0] ^= pPacket[0];
+            pFec[1] ^= pPacket[1];
+            for (b = 0; b < SIZEOF(UINT32); b++) {
+                pFec[TIMESTAMP_OFFSET + b] ^= pPacket[TIMESTAMP_OFFSET + b];
+            }
+            lengthRecovery ^= (UINT16) mediaLength;
+            for (b = 0; b < mediaLength; b++) {
+                pProtected[b] ^= pPacket[MIN_HEADER_LENGTH + b];
+            }
+
+            // Mask bits start from the most significant one, for the base sequence number
+            pFec[FEC_HEADER_LENGTH + 2 + j / 8] |= (BYTE) (0x80 >> (j % 8));
+        }
+
+        pFec[0] = (pFec[0] & FEC_FIRST_BYTE_RECOVERY_MASK) | (longMask ? FEC_LONG_MASK_FLAG : 0);
+        putUnalignedInt16BigEndian((PINT16) (pFec + SEQ_NUMBER_OFFSET), pFecEncoder->baseSequenceNumber);
+        putUnalignedInt16BigEndian((PINT16) (pFec + 8), lengthRecovery);
+        putUnalignedInt16BigEndian((PINT16) (pFec + FEC_HEADER_LENGTH), (UINT16) protectionLength);
+
+        pFecEncoder->fecPayloadLengths[pFecEncoder->fecPacketCount++] = FEC_HEADER_LENGTH + levelHeaderLength + protectionLength;
+    }
+
+CleanUp:
+
+    if (pFecEncoder != NULL) {
+        pFecEncoder->packetCount = 0;
+    }
+
+    return retStatus;
+}
+
+STATUS createFecDecoder(PFecDecoder* ppFecDecoder)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFecDecoder pFecDecoder = NULL;
+
+    CHK(ppFecDecoder != NULL, STATUS_NULL_ARG);
+
+    // Slot buffers are allocated as packets come in
+    CHK(NULL != (pFecDecoder = (PFecDecoder) MEMCALLOC(1, SIZEOF(FecDecoder))), STATUS_NOT_ENOUGH_MEMORY);
+
+    *ppFecDecoder = pFecDecoder;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeFecDecoder(PFecDecoder* ppFecDecoder)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFecDecoder pFecDecoder = NULL;
+    UINT32 i;
+
+    CHK(ppFecDecoder != NULL, STATUS_NULL_ARG);
+    pFecDecoder = *ppFecDecoder;
+    CHK(pFecDecoder != NULL, retStatus);
+
+    for (i = 0; i < FEC_DECODER_MEDIA_WINDOW; i++) {
+        SAFE_MEMFREE(pFecDecoder->mediaSlots[i].pPacket);
+    }
+    for (i = 0; i < FEC_DECODER_MAX_FEC_PACKETS; i++) {
+        SAFE_MEMFREE(pFecDecoder->protectionSlots[i].pPayload);
+    }
+    SAFE_MEMFREE(pFecDecoder);
+
+    *ppFecDecoder = NULL;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS fecDecoderOnMediaPacket(PFecDecoder pFecDecoder, PRtpPacket pRtpPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pFecDecoder != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(fecDecoderStoreMediaPacket(pFecDecoder, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength));
+    CHK_STATUS(fecDecoderRecover(pFecDecoder));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS fecDecoderOnFecPacket(PFecDecoder pFecDecoder, PRtpPacket pRtpPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PFecProtectionSlot pSlot = NULL;
+    PBYTE pPayload, pNewPayload;
+    UINT32 levelHeaderLength, protectionLength, i;
+    UINT16 baseSequenceNumber;
+    UINT64 mask = 0;
+    BOOL kept = FALSE;
+
+    CHK(pFecDecoder != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
+    pPayload = pRtpPacket->payload;
+
+    // Malformed packets are discarded like useless ones, the media is still played
+    CHK(pRtpPacket->payloadLength >= FEC_HEADER_LENGTH + FEC_LEVEL_HEADER_LENGTH, retStatus);
+    CHK((pPayload[0] & FEC_EXTENSION_FLAG) == 0, retStatus);
+    levelHeaderLength = (pPayload[0] & FEC_LONG_MASK_FLAG) != 0 ? FEC_LEVEL_HEADER_LONG_LENGTH : FEC_LEVEL_HEADER_LENGTH;
+    CHK(pRtpPacket->payloadLength >= FEC_HEADER_LENGTH + levelHeaderLength, retStatus);
+    protectionLength = (UINT16) getUnalignedInt16BigEndian(pPayload + FEC_HEADER_LENGTH);
+    CHK(protectionLength <= FEC_MAX_PACKET_LENGTH - MIN_HEADER_LENGTH &&
+            pRtpPacket->payloadLength >= FEC_HEADER_LENGTH + levelHeaderLength + protectionLength,
+        retStatus);
+
+    for (i = 0; i < (levelHeaderLength - 2) * 8; i++) {
+        if ((pPayload[FEC_HEADER_LENGTH + 2 + i / 8] & (0x80 >> (i % 8))) != 0) {
+            mask |= ((UINT64) 1) << i;
+        }
+    }
+    CHK(mask != 0, retStatus);
+    baseSequenceNumber = (UINT16) getUnalignedInt16BigEndian(pPayload + SEQ_NUMBER_OFFSET);
+
+    // A free slot, or the one protecting the oldest packets
+    for (i = 0; i < FEC_DECODER_MAX_FEC_PACKETS; i++) {
+        if (!pFecDecoder->protectionSlots[i].used) {
+            pSlot = &pFecDecoder->protectionSlots[i];
+            break;
+        } else if (pSlot == NULL || (INT16) (pFecDecoder->protectionSlots[i].baseSequenceNumber - pSlot->baseSequenceNumber) < 0) {
+            pSlot = &pFecDecoder->protectionSlots[i];
+        }
+    }
+    if (pSlot->used) {
+        pSlot->used = FALSE;
+        pFecDecoder->fecPacketsDiscarded++;
+    }
+
+    if (pSlot->capacity < FEC_HEADER_LENGTH + protectionLength) {
+        pNewPayload = (PBYTE) MEMREALLOC(pSlot->pPayload, FEC_HEADER_LENGTH + protectionLength);
+        CHK(pNewPayload != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pSlot->pPayload = pNewPayload;
+        pSlot->capacity = FEC_HEADER_LENGTH + protectionLength;
+    }
+
+    // The level header is kept parsed, the FEC header is followed by the protected bytes
+    MEMCPY(pSlot->pPayload, pPayload, FEC_HEADER_LENGTH);
+    MEMCPY(pSlot->pPayload + FEC_HEADER_LENGTH, pPayload + FEC_HEADER_LENGTH + levelHeaderLength, protectionLength);
+    pSlot->length = FEC_HEADER_LENGTH + protectionLength;
+    pSlot->ssrc = pRtpPacket->header.ssrc;
+    pSlot->baseSequenceNumber = baseSequenceNumber;
+    pSlot->mask = mask;
+    pSlot->used = TRUE;
+    kept = TRUE;
+
+    // FEC packets share the sequence numbers of the media, they move the window just the same
+    if (!pFecDecoder->started || (INT16) (pRtpPacket->header.sequenceNumber - pFecDecoder->highestSequenceNumber) > 0) {
+        pFecDecoder->highestSequenceNumber = pRtpPacket->header.sequenceNumber;
+        pFecDecoder->started = TRUE;
+    }
+
+    CHK_STATUS(fecDecoderRecover(pFecDecoder));
+
+CleanUp:
+
+    if (pFecDecoder != NULL && !kept) {
+        pFecDecoder->fecPacketsDiscarded++;
+    }
+
+    return retStatus;
+}
+
+STATUS fecDecoderPopRecoveredPacket(PFecDecoder pFecDecoder, PRtpPacket* ppRtpPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PFecMediaSlot pSlot;
+    PBYTE pRawPacket = NULL;
+    PRtpPacket pRtpPacket = NULL;
+    UINT16 sequenceNumber;
+
+    CHK(pFecDecoder != NULL && ppRtpPacket != NULL, STATUS_NULL_ARG);
+
+    while (pRtpPacket == NULL && pFecDecoder->recoveredCount > 0) {
+        sequenceNumber = pFecDecoder->recoveredSequenceNumbers[--pFecDecoder->recoveredCount];
+        pSlot = &pFecDecoder->mediaSlots[sequenceNumber % FEC_DECODER_MEDIA_WINDOW];
+        // Already replaced by a newer packet
+        if (pSlot->length == 0 || pSlot->sequenceNumber != sequenceNumber) {
+            continue;
+        }
+
+        CHK(NULL != (pRawPacket = (PBYTE) MEMALLOC(pSlot->length)), STATUS_NOT_ENOUGH_MEMORY);
+        MEMCPY(pRawPacket, pSlot->pPacket, pSlot->length);
+        CHK_STATUS(createRtpPacketFromBytes(pRawPacket, pSlot->length, &pRtpPacket));
+        // pRtpPacket took ownership of pRawPacket
+        pRawPacket = NULL;
+    }
+
+CleanUp:
+
+    SAFE_MEMFREE(pRawPacket);
+
+    if (ppRtpPacket != NULL) {
+        *ppRtpPacket = pRtpPacket;
+    }
+
+    return retStatus;
+}
+
+STATUS fecDecoderStoreMediaPacket(PFecDecoder pFecDecoder, PBYTE pPacket, UINT32 packetLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PFecMediaSlot pSlot;
+    PBYTE pNewPacket;
+    UINT16 sequenceNumber;
+
+    CHK(pFecDecoder != NULL && pPacket != NULL, STATUS_NULL_ARG);
+    // The encoder does not protect larger packets either
+    CHK(packetLength >= MIN_HEADER_LENGTH && packetLength <= FEC_MAX_PACKET_LENGTH, retStatus);
+
+    sequenceNumber = (UINT16) getUnalignedInt16BigEndian(pPacket + SEQ_NUMBER_OFFSET);
+    pSlot = &pFecDecoder->mediaSlots[sequenceNumber % FEC_DECODER_MEDIA_WINDOW];
+    if (pSlot->capacity < packetLength) {
+        pSlot->length = 0;
+        pNewPacket = (PBYTE) MEMREALLOC(pSlot->pPacket, packetLength);
+        CHK(pNewPacket != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pSlot->pPacket = pNewPacket;
+        pSlot->capacity = packetLength;
+    }
+
+    MEMCPY(pSlot->pPacket, pPacket, packetLength);
+    pSlot->length = packetLength;
+    pSlot->sequenceNumber = sequenceNumber;
+
+    if (!pFecDecoder->started || (INT16) (sequenceNumber - pFecDecoder->highestSequenceNumber) > 0) {
+        pFecDecoder->highestSequenceNumber = sequenceNumber;
+        pFecDecoder->started = TRUE;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS fecDecoderRecover(PFecDecoder pFecDecoder)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PFecProtectionSlot pSlot;
+    PFecMediaSlot pMediaSlot;
+    UINT32 i, b, missingCount;
+    UINT16 sequenceNumber, missingSequenceNumber = 0;
+    BOOL recovered = TRUE;
+
+    CHK(pFecDecoder != NULL, STATUS_NULL_ARG);
+
+    // A recovered packet can be the one but last missing packet of another FEC packet
+    while (recovered) {
+        recovered = FALSE;
+        for (i = 0; i < FEC_DECODER_MAX_FEC_PACKETS; i++) {
+            pSlot = &pFecDecoder->protectionSlots[i];
+            if (!pSlot->used) {
+                continue;
+            }
+
+            // The packets it protects may have been replaced in the window already
+            if ((INT16) (pFecDecoder->highestSequenceNumber - pSlot->baseSequenceNumber) >= FEC_DECODER_MEDIA_WINDOW) {
+                pSlot->used = FALSE;
+                pFecDecoder->fecPacketsDiscarded++;
+                continue;
+            }
+
+            missingCount = 0;
+            for (b = 0; b < FEC_MAX_GROUP_SIZE && missingCount < 2; b++) {
+                if ((pSlot->mask & (((UINT64) 1) << b)) == 0) {
+                    continue;
+                }
+                sequenceNumber = (UINT16) (pSlot->baseSequenceNumber + b);
+                pMediaSlot = &pFecDecoder->mediaSlots[sequenceNumber % FEC_DECODER_MEDIA_WINDOW];
+                if (pMediaSlot->length == 0 || pMediaSlot->sequenceNumber != sequenceNumber) {
+                    missingCount++;
+                    missingSequenceNumber = sequenceNumber;
+                }
+            }
+
+            if (missingCount == 0) {
+                pSlot->used = FALSE;
+                pFecDecoder->fecPacketsDiscarded++;
+            } else if (missingCount == 1) {
+                pSlot->used = FALSE;
+                CHK_STATUS(fecDecoderRecoverPacket(pFecDecoder, pSlot, missingSequenceNumber));
+                recovered = TRUE;
+            }
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS fecDecoderRecoverPacket(PFecDecoder pFecDecoder, PFecProtectionSlot pSlot, UINT16 missingSequenceNumber)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PFecMediaSlot pTarget, pMediaSlot;
+    PBYTE pFec, pOut, pPacket, pNewPacket;
+    UINT32 protectionLength, mediaLength, b, k;
+    UINT16 sequenceNumber, lengthRecovery;
+    BYTE header[FEC_HEADER_LENGTH];
+
+    CHK(pFecDecoder != NULL && pSlot != NULL, STATUS_NULL_ARG);
+
+    pFec = pSlot->pPayload;
+    protectionLength = pSlot->length - FEC_HEADER_LENGTH;
+    pTarget = &pFecDecoder->mediaSlots[missingSequenceNumber % FEC_DECODER_MEDIA_WINDOW];
+
+    // The slot held an older packet, it is given to the recovered one
+    pTarget->length = 0;
+    if (pTarget->capacity < MIN_HEADER_LENGTH + protectionLength) {
+        pNewPacket = (PBYTE) MEMREALLOC(pTarget->pPacket, MIN_HEADER_LENGTH + protectionLength);
+        CHK(pNewPacket != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pTarget->pPacket = pNewPacket;
+        pTarget->capacity = MIN_HEADER_LENGTH + protectionLength;
+    }
+    pOut = pTarget->pPacket;
+
+    MEMCPY(header, pFec, FEC_HEADER_LENGTH);
+    lengthRecovery = (UINT16) getUnalignedInt16BigEndian(header + 8);
+    MEMCPY(pOut + MIN_HEADER_LENGTH, pFec + FEC_HEADER_LENGTH, protectionLength);
+
+    for (k = 0; k < FEC_MAX_GROUP_SIZE; k++) {
+        sequenceNumber = (UINT16) (pSlot->baseSequenceNumber + k);
+        if ((pSlot->mask & (((UINT64) 1) << k)) == 0 || sequenceNumber == missingSequenceNumber) {
+            continue;
+        }
+
+        pMediaSlot = &pFecDecoder->mediaSlots[sequenceNumber % FEC_DECODER_MEDIA_WINDOW];
+        pPacket = pMediaSlot->pPacket;
+        mediaLength = pMediaSlot->length - MIN_HEADER_LENGTH;
+
+        header[0] ^= pPacket[0];
+        header[1] ^= pPacket[1];
+        for (b = 0; b < SIZEOF(UINT32); b++) {
+            header[TIMESTAMP_OFFSET + b] ^= pPacket[TIMESTAMP_OFFSET + b];
+        }
+        lengthRecovery ^= (UINT16) mediaLength;
+        for (b = 0; b < MIN(mediaLength, protectionLength); b++) {
+            pOut[MIN_HEADER_LENGTH + b] ^= pPacket[MIN_HEADER_LENGTH + b];
+        }
+    }
+
+    // A corrupted FEC packet or one that did not protect what its mask says
+    CHK_WARN(lengthRecovery <= protectionLength, retStatus, "Dropping recovered packet %u, its length %u is more than the FEC protects",
+             missingSequenceNumber, lengthRecovery);
+
+    pOut[0] = (BYTE) ((2 << VERSION_SHIFT) | (header[0] & FEC_FIRST_BYTE_RECOVERY_MASK));
+    pOut[1] = header[1];
+    putUnalignedInt16BigEndian((PINT16) (pOut + SEQ_NUMBER_OFFSET), missingSequenceNumber);
+    MEMCPY(pOut + TIMESTAMP_OFFSET, header + TIMESTAMP_OFFSET, SIZEOF(UINT32));
+    putUnalignedInt32BigEndian((PINT32) (pOut + SSRC_OFFSET), pSlot->ssrc);
+    pTarget->length = MIN_HEADER_LENGTH + lengthRecovery;
+    pTarget->sequenceNumber = missingSequenceNumber;
+
+    if ((INT16) (missingSequenceNumber - pFecDecoder->highestSequenceNumber) > 0) {
+        pFecDecoder->highestSequenceNumber = missingSequenceNumber;
+    }
+
+    if (pFecDecoder->recoveredCount < FEC_DECODER_MAX_FEC_PACKETS) {
+        pFecDecoder->recoveredSequenceNumbers[pFecDecoder->recoveredCount++] = missingSequenceNumber;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS redEncapsulateRtpPacket(PBYTE pPacket, UINT32 headerLength, PUINT32 pPacketLength, UINT8 redPayloadType)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pPacket != NULL && pPacketLength != NULL, STATUS_NULL_ARG);
+    CHK(headerLength >= MIN_HEADER_LENGTH && headerLength <= *pPacketLength, STATUS_INVALID_ARG);
+
+    MEMMOVE(pPacket + headerLength + RED_PRIMARY_HEADER_LENGTH, pPacket + headerLength, *pPacketLength - headerLength);
+    pPacket[headerLength] = pPacket[1] & PAYLOAD_TYPE_MASK;
+    pPacket[1] = (BYTE) ((pPacket[1] & (MARKER_MASK << MARKER_SHIFT)) | (redPayloadType & PAYLOAD_TYPE_MASK));
+    *pPacketLength += RED_PRIMARY_HEADER_LENGTH;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS redDecapsulateRtpPacket(PBYTE pPacket, PUINT32 pPacketLength, PUINT8 pBlockPayloadType)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 headerLength = 0, offset, payloadEnd, redundantLength = 0;
+    UINT8 blockPayloadType;
+
+    CHK(pPacket != NULL && pPacketLength != NULL && pBlockPayloadType != NULL, STATUS_NULL_ARG);
+    CHK_STATUS(getRtpHeaderLengthFromBytes(pPacket, *pPacketLength, &headerLength));
+
+    payloadEnd = *pPacketLength;
+    if (((pPacket[0] >> PADDING_SHIFT) & PADDING_MASK) != 0) {
+        CHK(payloadEnd > headerLength && pPacket[payloadEnd - 1] <= payloadEnd - headerLength, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+        payloadEnd -= pPacket[payloadEnd - 1];
+    }
+
+    // Redundant blocks come first, their data is skipped along with them
+    offset = headerLength;
+    while (offset < payloadEnd && (pPacket[offset] & RED_FOLLOWING_BLOCK_FLAG) != 0) {
+        CHK(offset + RED_REDUNDANT_HEADER_LENGTH <= payloadEnd, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+        redundantLength += (UINT16) getUnalignedInt16BigEndian(pPacket + offset + 2) & RED_BLOCK_LENGTH_MASK;
+        offset += RED_REDUNDANT_HEADER_LENGTH;
+    }
+    CHK(offset < payloadEnd, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+    blockPayloadType = pPacket[offset] & PAYLOAD_TYPE_MASK;
+    offset += RED_PRIMARY_HEADER_LENGTH + redundantLength;
+    CHK(offset <= payloadEnd, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+
+    MEMMOVE(pPacket + headerLength, pPacket + offset, *pPacketLength - offset);
+    pPacket[1] = (BYTE) ((pPacket[1] & (MARKER_MASK << MARKER_SHIFT)) | blockPayloadType);
+    *pPacketLength -= offset - headerLength;
+    *pBlockPayloadType = blockPayloadType;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS getRtpHeaderLengthFromBytes(PBYTE pPacket, UINT32 packetLength, PUINT32 pHeaderLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 headerLength;
+
+    CHK(pPacket != NULL && pHeaderLength != NULL, STATUS_NULL_ARG);
+    CHK(packetLength >= MIN_HEADER_LENGTH, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+
+    headerLength = CSRC_OFFSET + (pPacket[0] & CSRC_COUNT_MASK) * CSRC_LENGTH;
+    if (((pPacket[0] >> EXTENSION_SHIFT) & EXTENSION_MASK) != 0) {
+        CHK(packetLength >= headerLength + 4, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+        headerLength += 4 + (UINT16) getUnalignedInt16BigEndian(pPacket + headerLength + 2) * 4;
+    }
+    CHK(packetLength >= headerLength, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+
+    *pHeaderLength = headerLength;
+
+CleanUp:
+
+    return retStatus;
+}
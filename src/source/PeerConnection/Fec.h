@@ -0,0 +1,258 @@
+/*******************************************
+Forward error correction internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_FEC__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_FEC__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * ULPFEC packet, https://tools.ietf.org/html/rfc5109#section-7, carried in a single RED block
+ *
+ *  0                   1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |E|L|P|X|  CC   |M| PT recovery |            SN base            |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                          TS recovery                          |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |        length recovery        |       Protection Length       |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |             mask              |  mask cont. (present if L=1)  |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |              mask cont. (present only if L = 1)               |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |               XOR of the protected packets ...                |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ */
+#define FEC_HEADER_LENGTH            10
+#define FEC_LEVEL_HEADER_LENGTH      4
+#define FEC_LEVEL_HEADER_LONG_LENGTH 8
+#define FEC_LONG_MASK_FLAG           0x40
+#define FEC_EXTENSION_FLAG           0x80
+// Recovered bits of the first byte of the media packets, P, X and CC
+#define FEC_FIRST_BYTE_RECOVERY_MASK 0x3F
+
+// Packets a mask covers without and with the L bit
+#define FEC_SHORT_MASK_GROUP_SIZE 16
+#define FEC_MAX_GROUP_SIZE        48
+
+// Media packets protected together unless configured otherwise
+#define FEC_DEFAULT_GROUP_SIZE 16
+
+// Small frames are grouped together until there are that many packets, a group is always closed at the end of a frame otherwise
+#define FEC_MIN_GROUP_SIZE 4
+
+#define FEC_DEFAULT_MAX_PROTECTION_PERCENT 50
+
+// Protection until the first receiver report tells the loss
+#define FEC_INITIAL_PROTECTION_PERCENT 10
+
+// FEC overhead given per percent of measured loss, losses come in bursts that a single FEC packet per group does not repair
+#define FEC_LOSS_PROTECTION_MULTIPLIER 2
+
+// Larger packets are sent unprotected, and ignored by the decoder
+#define FEC_MAX_PACKET_LENGTH 1500
+
+#define FEC_MAX_PAYLOAD_LENGTH (FEC_HEADER_LENGTH + FEC_LEVEL_HEADER_LONG_LENGTH + FEC_MAX_PACKET_LENGTH - MIN_HEADER_LENGTH)
+
+// Media packets kept by the decoder to recover from, a power of 2
+#define FEC_DECODER_MEDIA_WINDOW 128
+
+// FEC packets kept by the decoder until they are used up or too old
+#define FEC_DECODER_MAX_FEC_PACKETS 16
+
+/*
+ * RED block header, https://tools.ietf.org/html/rfc2198#section-3. Only the last block, the primary one, has the short form.
+ *
+ *  0                   1                    2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |F|   block PT  |  timestamp offset         |   block length    |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ */
+#define RED_PRIMARY_HEADER_LENGTH   1
+#define RED_REDUNDANT_HEADER_LENGTH 4
+#define RED_FOLLOWING_BLOCK_FLAG    0x80
+#define RED_BLOCK_LENGTH_MASK       0x3FF
+
+// Room taken by each FEC payload of the encoder, RED header included
+#define FEC_ENCODER_PAYLOAD_SLOT_LENGTH (RED_PRIMARY_HEADER_LENGTH + FEC_MAX_PAYLOAD_LENGTH)
+
+// A FEC packet is as long as the largest media packet it protects plus these headers, plus the header extensions of that media
+// packet which are protected along with its payload
+#define FEC_PACKET_OVERHEAD (RED_PRIMARY_HEADER_LENGTH + FEC_HEADER_LENGTH + FEC_LEVEL_HEADER_LONG_LENGTH)
+
+/**
+ * Generates ULPFEC packets for the outbound video stream. Media packets are XORed together in groups of up to groupSize
+ * packets, a group ending early at the end of a frame. Each group gets enough FEC packets for the current protection
+ * percentage, the packets of a group being interleaved over them so that a burst of losses is spread over several FEC
+ * packets. Used under the SRTP session lock of the PeerConnection, only the protection percentage is changed from elsewhere.
+ */
+typedef struct {
+    UINT32 groupSize;
+    UINT32 maxProtectionPercent;
+    // Percentage of FEC packets per media packet
+    volatile SIZE_T protectionPercent;
+
+    // Media packets of the current group, FEC_MAX_PACKET_LENGTH bytes each
+    PBYTE pPackets;
+    UINT32 packetLengths[FEC_MAX_GROUP_SIZE];
+    UINT32 packetCount;
+    UINT16 baseSequenceNumber;
+
+    // FEC payloads of the groups closed by the last fecEncoderProtect call, FEC_ENCODER_PAYLOAD_SLOT_LENGTH bytes each. Every
+    // payload is preceded by RED_PRIMARY_HEADER_LENGTH free bytes for the RED header.
+    PBYTE pFecPayloads;
+    PUINT32 fecPayloadLengths;
+    UINT32 fecPacketCount;
+    UINT32 fecPacketCapacity;
+} FecEncoder, *PFecEncoder;
+
+typedef struct {
+    UINT16 sequenceNumber;
+    UINT32 length;
+    UINT32 capacity;
+    PBYTE pPacket;
+} FecMediaSlot, *PFecMediaSlot;
+
+typedef struct {
+    BOOL used;
+    UINT32 ssrc;
+    UINT16 baseSequenceNumber;
+    // Bit 0 is the base sequence number
+    UINT64 mask;
+    UINT32 length;
+    UINT32 capacity;
+    // FEC header followed by the protected bytes, the level header is parsed into the fields above
+    PBYTE pPayload;
+} FecProtectionSlot, *PFecProtectionSlot;
+
+/**
+ * Recovers the media packets of an inbound video stream from its ULPFEC packets. A FEC packet repairs the one packet it
+ * protects that is missing, it is kept until then or until the packets it protects leave the media window. Used from the
+ * thread that receives the packets of the PeerConnection only.
+ */
+typedef struct {
+    BOOL started;
+    UINT16 highestSequenceNumber;
+
+    // Indexed by sequence number modulo the window, the slot is empty unless its packet has that sequence number
+    FecMediaSlot mediaSlots[FEC_DECODER_MEDIA_WINDOW];
+    FecProtectionSlot protectionSlots[FEC_DECODER_MAX_FEC_PACKETS];
+
+    // Recovered packets not taken yet by fecDecoderPopRecoveredPacket, in the media window
+    UINT16 recoveredSequenceNumbers[FEC_DECODER_MAX_FEC_PACKETS];
+    UINT32 recoveredCount;
+
+    // FEC packets that recovered nothing, either nothing was missing or they came too late
+    UINT64 fecPacketsDiscarded;
+} FecDecoder, *PFecDecoder;
+
+/**
+ * Create a FEC encoder
+ *
+ * @param - UINT32 - IN - media packets per group, FEC_DEFAULT_GROUP_SIZE when 0, at most FEC_MAX_GROUP_SIZE
+ * @param - UINT32 - IN - highest percentage of FEC packets per media packet, FEC_DEFAULT_MAX_PROTECTION_PERCENT when 0
+ * @param - PFecEncoder* - OUT - the new encoder
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createFecEncoder(UINT32, UINT32, PFecEncoder*);
+
+STATUS freeFecEncoder(PFecEncoder*);
+
+/**
+ * Adapt the protection to the loss the remote peer reports
+ *
+ * @param - PFecEncoder - IN - the encoder
+ * @param - DOUBLE - IN - fraction of the packets lost since the previous report, between 0 and 1
+ */
+STATUS fecEncoderOnLoss(PFecEncoder, DOUBLE);
+
+/**
+ * Add the media packets of a frame to the current group. The FEC payloads of the groups closed meanwhile replace the
+ * previous ones in the encoder, they go out right after the media packets with the RED payload type.
+ *
+ * @param - PFecEncoder - IN - the encoder
+ * @param - PRtpPacket - IN - media packets with consecutive sequence numbers, the marker bit set on the last one of the frame
+ * @param - UINT32 - IN - number of packets
+ *
+ * @return - STATUS status of execution
+ */
+STATUS fecEncoderProtect(PFecEncoder, PRtpPacket, UINT32);
+
+STATUS createFecDecoder(PFecDecoder*);
+
+STATUS freeFecDecoder(PFecDecoder*);
+
+/**
+ * Keep a received media packet to recover others from, and recover the packet it was the last one missing for
+ *
+ * @param - PFecDecoder - IN - the decoder
+ * @param - PRtpPacket - IN - the packet, without its RED header
+ *
+ * @return - STATUS status of execution
+ */
+STATUS fecDecoderOnMediaPacket(PFecDecoder, PRtpPacket);
+
+/**
+ * Recover the packet missing from those a FEC packet protects, or keep the FEC packet until a single one is missing
+ *
+ * @param - PFecDecoder - IN - the decoder
+ * @param - PRtpPacket - IN - the packet, without its RED header
+ *
+ * @return - STATUS status of execution
+ */
+STATUS fecDecoderOnFecPacket(PFecDecoder, PRtpPacket);
+
+/**
+ * Take a recovered packet
+ *
+ * @param - PFecDecoder - IN - the decoder
+ * @param - PRtpPacket* - OUT - packet owned by the caller, NULL when nothing was recovered
+ *
+ * @return - STATUS status of execution
+ */
+STATUS fecDecoderPopRecoveredPacket(PFecDecoder, PRtpPacket*);
+
+/**
+ * Wrap a packet in a single RED block in place. The packet needs RED_PRIMARY_HEADER_LENGTH bytes of room after it.
+ *
+ * @param - PBYTE - IN/OUT - the packet
+ * @param - UINT32 - IN - length of its header
+ * @param - PUINT32 - IN/OUT - length of the packet
+ * @param - UINT8 - IN - RED payload type
+ *
+ * @return - STATUS status of execution
+ */
+STATUS redEncapsulateRtpPacket(PBYTE, UINT32, PUINT32, UINT8);
+
+/**
+ * Unwrap the primary block of a RED packet in place, the redundant blocks are dropped
+ *
+ * @param - PBYTE - IN/OUT - the packet
+ * @param - PUINT32 - IN/OUT - length of the packet
+ * @param - PUINT8 - OUT - payload type of the primary block, now the payload type of the packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS redDecapsulateRtpPacket(PBYTE, PUINT32, PUINT8);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+STATUS fecEncoderCloseGroup(PFecEncoder);
+STATUS fecDecoderStoreMediaPacket(PFecDecoder, PBYTE, UINT32);
+STATUS fecDecoderRecover(PFecDecoder);
+STATUS fecDecoderRecoverPacket(PFecDecoder, PFecProtectionSlot, UINT16);
+STATUS getRtpHeaderLengthFromBytes(PBYTE, UINT32, PUINT32);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_FEC__ */
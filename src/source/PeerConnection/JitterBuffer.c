@@ -7,6 +7,12 @@
 
 // forward declaration
 STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed);
+STATUS jitterBufferStorePacket(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket, UINT32 payloadSize, BOOL isStart, BOOL isPadding);
+PJitterBufferSlot jitterBufferGetSlot(PJitterBuffer pJitterBuffer, UINT16 sequenceNumber);
+STATUS jitterBufferGrowRing(PJitterBuffer pJitterBuffer);
+
+// return true if sequenceNumber is between start and end inclusive, accounting for wrap around
+#define JITTER_BUFFER_SEQUENCE_NUMBER_IN_RANGE(sequenceNumber, start, end) ((UINT16) ((sequenceNumber) - (start)) <= (UINT16) ((end) - (start)))
 
 STATUS createJitterBuffer(FrameReadyFunc onFrameReadyFunc, FrameDroppedFunc onFrameDroppedFunc, DepayRtpPayloadFunc depayRtpPayloadFunc,
                           UINT32 maxLatency, UINT32 clockRate, UINT64 customData, PJitterBuffer* ppJitterBuffer)
@@ -18,7 +24,7 @@ STATUS createJitterBuffer(FrameReadyFunc onFrameReadyFunc, FrameDroppedFunc onFr
     CHK(ppJitterBuffer != NULL && onFrameReadyFunc != NULL && onFrameDroppedFunc != NULL && depayRtpPayloadFunc != NULL, STATUS_NULL_ARG);
     CHK(clockRate != 0, STATUS_INVALID_ARG);
 
-    pJitterBuffer = (PJitterBuffer) MEMALLOC(SIZEOF(JitterBuffer));
+    pJitterBuffer = (PJitterBuffer) MEMCALLOC(1, SIZEOF(JitterBuffer));
     CHK(pJitterBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
     pJitterBuffer->onFrameReadyFn = onFrameReadyFunc;
@@ -44,8 +50,9 @@ STATUS createJitterBuffer(FrameReadyFunc onFrameReadyFunc, FrameDroppedFunc onFr
     pJitterBuffer->sequenceNumberOverflowState = FALSE;
 
     pJitterBuffer->customData = customData;
-    CHK_STATUS(hashTableCreateWithParams(JITTER_BUFFER_HASH_TABLE_BUCKET_COUNT, JITTER_BUFFER_HASH_TABLE_BUCKET_LENGTH,
-                                         &pJitterBuffer->pPkgBufferHashTable));
+    pJitterBuffer->ringCapacity = JITTER_BUFFER_INITIAL_RING_CAPACITY;
+    pJitterBuffer->pRing = (PJitterBufferSlot) MEMCALLOC(pJitterBuffer->ringCapacity, SIZEOF(JitterBufferSlot));
+    CHK(pJitterBuffer->pRing != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
 CleanUp:
     if (STATUS_FAILED(retStatus) && pJitterBuffer != NULL) {
@@ -74,9 +81,11 @@ STATUS freeJitterBuffer(PJitterBuffer* ppJitterBuffer)
 
     pJitterBuffer = *ppJitterBuffer;
 
-    jitterBufferInternalParse(pJitterBuffer, TRUE);
-    jitterBufferDropBufferData(pJitterBuffer, 0, MAX_RTP_SEQUENCE_NUM, 0);
-    hashTableFree(pJitterBuffer->pPkgBufferHashTable);
+    if (pJitterBuffer->pRing != NULL) {
+        jitterBufferInternalParse(pJitterBuffer, TRUE);
+        jitterBufferDropBufferData(pJitterBuffer, 0, MAX_RTP_SEQUENCE_NUM, 0);
+        MEMFREE(pJitterBuffer->pRing);
+    }
 
     SAFE_MEMFREE(*ppJitterBuffer);
 
@@ -394,9 +403,9 @@ BOOL withinLatencyTolerance(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket)
 STATUS jitterBufferPush(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket, PBOOL pPacketDiscarded)
 {
     ENTERS();
-    STATUS retStatus = STATUS_SUCCESS, status = STATUS_SUCCESS;
-    UINT64 hashValue = 0;
-    PRtpPacket pCurPacket = NULL;
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 payloadSize = 0;
+    BOOL isStart = FALSE;
 
     CHK(pJitterBuffer != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
 
@@ -423,16 +432,12 @@ STATUS jitterBufferPush(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket, PBOO
         DLOGS("Entered timestamp overflow state");
     }
 
-    // is the packet within the accepted latency range, if so, add it to the hashtable
+    // is the packet within the accepted latency range, if so, add it to the ring
     if (withinLatencyTolerance(pJitterBuffer, pRtpPacket)) {
-        status = hashTableGet(pJitterBuffer->pPkgBufferHashTable, pRtpPacket->header.sequenceNumber, &hashValue);
-        pCurPacket = (PRtpPacket) hashValue;
-        if (STATUS_SUCCEEDED(status) && pCurPacket != NULL) {
-            freeRtpPacket(&pCurPacket);
-            CHK_STATUS(hashTableRemove(pJitterBuffer->pPkgBufferHashTable, pRtpPacket->header.sequenceNumber));
-        }
-
-        CHK_STATUS(hashTablePut(pJitterBuffer->pPkgBufferHashTable, pRtpPacket->header.sequenceNumber, (UINT64) pRtpPacket));
+        // With the missing output buffer parameter, this will only return the size of the packet, and identify if it is a starting packet of a
+        // frame. Done once here so that parsing never has to depay the same packet again
+        CHK_STATUS(pJitterBuffer->depayPayloadFn(pRtpPacket->payload, pRtpPacket->payloadLength, NULL, &payloadSize, &isStart));
+        CHK_STATUS(jitterBufferStorePacket(pJitterBuffer, pRtpPacket, payloadSize, isStart, FALSE));
 
         if (headCheckingAllowed(pJitterBuffer, pRtpPacket)) {
             // if the timestamp is less, we'll accept it as a new head, since it must be an earlier frame.
@@ -464,6 +469,42 @@ CleanUp:
     return retStatus;
 }
 
+STATUS jitterBufferPushPadding(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket, PBOOL pPacketDiscarded)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL stored = FALSE;
+
+    CHK(pJitterBuffer != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
+
+    // Padding never becomes the head, a frame always starts on a media packet. It only moves the tail sequence number, its
+    // timestamp is not trusted to be the one of the frame around it.
+    if (pJitterBuffer->started && (INT16) (pRtpPacket->header.sequenceNumber - pJitterBuffer->headSequenceNumber) > 0) {
+        if (!enterSequenceNumberOverflowCheck(pJitterBuffer, pRtpPacket)) {
+            tailSequenceNumberCheck(pJitterBuffer, pRtpPacket);
+        } else {
+            DLOGS("Entered sequenceNumber overflow state");
+        }
+
+        CHK_STATUS(jitterBufferStorePacket(pJitterBuffer, pRtpPacket, 0, FALSE, TRUE));
+        stored = TRUE;
+        CHK_STATUS(jitterBufferInternalParse(pJitterBuffer, FALSE));
+    }
+
+CleanUp:
+    if (!stored && pRtpPacket != NULL) {
+        freeRtpPacket(&pRtpPacket);
+        if (pPacketDiscarded != NULL) {
+            *pPacketDiscarded = TRUE;
+        }
+    }
+
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
 {
     ENTERS();
@@ -475,11 +516,9 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
     UINT32 curTimestamp = 0;
     UINT16 startDropIndex = 0;
     UINT32 curFrameSize = 0;
-    UINT32 partialFrameSize = 0;
-    UINT64 hashValue = 0;
-    BOOL isStart = FALSE, containStartForEarliestFrame = FALSE, hasEntry = FALSE;
+    BOOL containStartForEarliestFrame = FALSE, saveCursor = FALSE;
     UINT16 lastNonNullIndex = 0;
-    PRtpPacket pCurPacket = NULL;
+    PJitterBufferSlot pSlot = NULL;
 
     CHK(pJitterBuffer != NULL && pJitterBuffer->onFrameDroppedFn != NULL && pJitterBuffer->onFrameReadyFn != NULL, STATUS_NULL_ARG);
     CHK(pJitterBuffer->tailTimestamp != 0, retStatus);
@@ -491,6 +530,20 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
     lastIndex = pJitterBuffer->tailSequenceNumber + 1;
     index = pJitterBuffer->headSequenceNumber;
     startDropIndex = index;
+
+    // Skip the packets of the head frame that the previous parse already went through
+    if (!bufferClosed && pJitterBuffer->parseCursorValid && pJitterBuffer->parseHeadSequenceNumber == pJitterBuffer->headSequenceNumber &&
+        pJitterBuffer->parseHeadTimestamp == pJitterBuffer->headTimestamp &&
+        JITTER_BUFFER_SEQUENCE_NUMBER_IN_RANGE(pJitterBuffer->parseCursor, index, lastIndex)) {
+        if (pJitterBuffer->parseCursor != index) {
+            lastNonNullIndex = UINT16_DEC(pJitterBuffer->parseCursor);
+        }
+        index = pJitterBuffer->parseCursor;
+        curFrameSize = pJitterBuffer->parseFrameSize;
+        containStartForEarliestFrame = pJitterBuffer->parseContainsStart;
+    }
+    pJitterBuffer->parseCursorValid = FALSE;
+
     // Loop through entire buffer to find complete frames.
     /*A Frame is ready when these conditions are met:
      * 1. We have a starting packet
@@ -507,23 +560,20 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
      *conditions have been met from dropping an earlier frame, then it will be processed.
      */
     for (; index != lastIndex; index++) {
-        CHK_STATUS(hashTableContains(pJitterBuffer->pPkgBufferHashTable, index, &hasEntry));
-        if (!hasEntry) {
-            isFrameDataContinuous = FALSE;
+        pSlot = jitterBufferGetSlot(pJitterBuffer, index);
+        if (pSlot == NULL) {
             // if the max latency has not been reached, or the buffer is not being closed, exit parse when a missing entry is found
-            CHK(pJitterBuffer->headTimestamp < earliestAllowedTimestamp || bufferClosed, retStatus);
+            if (pJitterBuffer->headTimestamp >= earliestAllowedTimestamp && !bufferClosed) {
+                saveCursor = isFrameDataContinuous;
+                break;
+            }
+            isFrameDataContinuous = FALSE;
+        } else if (pSlot->isPadding) {
+            // Stays with the frame before it
+            lastNonNullIndex = index;
         } else {
             lastNonNullIndex = index;
-            retStatus = hashTableGet(pJitterBuffer->pPkgBufferHashTable, index, &hashValue);
-            if (retStatus == STATUS_HASH_KEY_NOT_PRESENT) {
-                // should be unreachable, this means hashTablContains() said we had it but hashTableGet() couldn't find it.
-                continue;
-            } else {
-                CHK_STATUS(retStatus);
-            }
-            pCurPacket = (PRtpPacket) hashValue;
-            CHK(pCurPacket != NULL, STATUS_NULL_ARG);
-            curTimestamp = pCurPacket->header.timestamp;
+            curTimestamp = pSlot->pRtpPacket->header.timestamp;
             // new timestamp on an RTP packet means new frame
             if (curTimestamp != pJitterBuffer->headTimestamp) {
                 // was previous frame complete? Deliver it
@@ -543,38 +593,37 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
                     CHK_STATUS(jitterBufferDropBufferData(pJitterBuffer, startDropIndex, UINT16_DEC(index), curTimestamp));
                     pJitterBuffer->firstFrameProcessed = TRUE;
                     isFrameDataContinuous = TRUE;
+                    containStartForEarliestFrame = FALSE;
                     startDropIndex = index;
                 } else {
                     // if you're here, it means we're not force clearing the buffer, and the previous frame must be missing its starting packet.
                     // The starting packet isn't going to be found at an incremental sequence number, so we can save some time and break here.
+                    saveCursor = isFrameDataContinuous;
                     break;
                 }
                 // new timestamp means new frame, drop tracking for previous frame size
                 curFrameSize = 0;
             }
 
-            // With the missing output buffer parameter, this will only return the size of the packet, and identify if it is a starting packet of a
-            // frame
-            CHK_STATUS(pJitterBuffer->depayPayloadFn(pCurPacket->payload, pCurPacket->payloadLength, NULL, &partialFrameSize, &isStart));
-            curFrameSize += partialFrameSize;
-            if (isStart && pJitterBuffer->headTimestamp == curTimestamp) {
+            curFrameSize += pSlot->payloadSize;
+            if (pSlot->isStart && pJitterBuffer->headTimestamp == curTimestamp) {
                 containStartForEarliestFrame = TRUE;
             }
         }
     }
 
+    if (index == lastIndex) {
+        saveCursor = isFrameDataContinuous && !bufferClosed;
+    }
+
     // Deal with last frame, we're force clearing the entire buffer.
     if (bufferClosed && curFrameSize > 0) {
         curFrameSize = 0;
-        hasEntry = TRUE;
-        for (index = startDropIndex; UINT16_DEC(index) != lastNonNullIndex && hasEntry; index++) {
-            CHK_STATUS(hashTableContains(pJitterBuffer->pPkgBufferHashTable, index, &hasEntry));
-            if (hasEntry) {
-                CHK_STATUS(hashTableGet(pJitterBuffer->pPkgBufferHashTable, index, &hashValue));
-                pCurPacket = (PRtpPacket) hashValue;
-                CHK_STATUS(pJitterBuffer->depayPayloadFn(pCurPacket->payload, pCurPacket->payloadLength, NULL, &partialFrameSize, NULL));
-                curFrameSize += partialFrameSize;
+        for (index = startDropIndex; UINT16_DEC(index) != lastNonNullIndex; index++) {
+            if ((pSlot = jitterBufferGetSlot(pJitterBuffer, index)) == NULL) {
+                break;
             }
+            curFrameSize += pSlot->payloadSize;
         }
 
         // There is no NULL between startIndex and lastNonNullIndex
@@ -582,12 +631,22 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
             CHK_STATUS(pJitterBuffer->onFrameReadyFn(pJitterBuffer->customData, startDropIndex, lastNonNullIndex, curFrameSize));
             CHK_STATUS(jitterBufferDropBufferData(pJitterBuffer, startDropIndex, lastNonNullIndex, pJitterBuffer->headTimestamp));
         } else {
-            CHK_STATUS(pJitterBuffer->onFrameDroppedFn(pJitterBuffer->customData, startDropIndex, UINT16_DEC(index), pJitterBuffer->headTimestamp));
+            CHK_STATUS(pJitterBuffer->onFrameDroppedFn(pJitterBuffer->customData, startDropIndex, index, pJitterBuffer->headTimestamp));
             CHK_STATUS(jitterBufferDropBufferData(pJitterBuffer, startDropIndex, lastNonNullIndex, pJitterBuffer->headTimestamp));
         }
     }
 
 CleanUp:
+    // The packets between the head and index all belong to the head frame, remember where to pick up from next time
+    if (STATUS_SUCCEEDED(retStatus) && saveCursor) {
+        pJitterBuffer->parseCursorValid = TRUE;
+        pJitterBuffer->parseCursor = index;
+        pJitterBuffer->parseHeadSequenceNumber = pJitterBuffer->headSequenceNumber;
+        pJitterBuffer->parseHeadTimestamp = pJitterBuffer->headTimestamp;
+        pJitterBuffer->parseFrameSize = curFrameSize;
+        pJitterBuffer->parseContainsStart = containStartForEarliestFrame;
+    }
+
     CHK_LOG_ERR(retStatus);
 
     LEAVES();
@@ -601,24 +660,30 @@ STATUS jitterBufferDropBufferData(PJitterBuffer pJitterBuffer, UINT16 startIndex
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     UINT16 index = startIndex;
-    UINT64 hashValue;
-    PRtpPacket pCurPacket = NULL;
-    BOOL hasEntry = FALSE;
+    UINT32 i;
+    PJitterBufferSlot pSlot = NULL;
 
     CHK(pJitterBuffer != NULL, STATUS_NULL_ARG);
-    for (; UINT16_DEC(index) != endIndex; index++) {
-        CHK_STATUS(hashTableContains(pJitterBuffer->pPkgBufferHashTable, index, &hasEntry));
-        if (hasEntry) {
-            CHK_STATUS(hashTableGet(pJitterBuffer->pPkgBufferHashTable, index, &hashValue));
-            pCurPacket = (PRtpPacket) hashValue;
-            if (pCurPacket) {
-                freeRtpPacket(&pCurPacket);
+    if ((UINT32) (UINT16) (endIndex - startIndex) + 1 >= pJitterBuffer->ringCapacity) {
+        // The range covers every slot, no point in looking up each sequence number
+        for (i = 0; i < pJitterBuffer->ringCapacity; i++) {
+            pSlot = &pJitterBuffer->pRing[i];
+            if (pSlot->pRtpPacket != NULL && JITTER_BUFFER_SEQUENCE_NUMBER_IN_RANGE(pSlot->pRtpPacket->header.sequenceNumber, startIndex, endIndex)) {
+                freeRtpPacket(&pSlot->pRtpPacket);
+                pSlot->pRtpPacket = NULL;
+            }
+        }
+    } else {
+        for (; UINT16_DEC(index) != endIndex; index++) {
+            if ((pSlot = jitterBufferGetSlot(pJitterBuffer, index)) != NULL) {
+                freeRtpPacket(&pSlot->pRtpPacket);
+                pSlot->pRtpPacket = NULL;
             }
-            CHK_STATUS(hashTableRemove(pJitterBuffer->pPkgBufferHashTable, index));
         }
     }
     pJitterBuffer->headTimestamp = nextTimestamp;
     pJitterBuffer->headSequenceNumber = endIndex + 1;
+    pJitterBuffer->parseCursorValid = FALSE;
     if (exitTimestampOverflowCheck(pJitterBuffer)) {
         DLOGS("Exited timestamp overflow state");
     }
@@ -639,20 +704,21 @@ STATUS jitterBufferFillFrameData(PJitterBuffer pJitterBuffer, PBYTE pFrame, UINT
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     UINT16 index = startIndex;
-    UINT64 hashValue;
-    PRtpPacket pCurPacket = NULL;
+    PJitterBufferSlot pSlot = NULL;
     PBYTE pCurPtrInFrame = pFrame;
     UINT32 remainingFrameSize = frameSize;
     UINT32 partialFrameSize = 0;
 
     CHK(pJitterBuffer != NULL && pFrame != NULL && pFilledSize != NULL, STATUS_NULL_ARG);
     for (; UINT16_DEC(index) != endIndex; index++) {
-        hashValue = 0;
-        CHK_STATUS(hashTableGet(pJitterBuffer->pPkgBufferHashTable, index, &hashValue));
-        pCurPacket = (PRtpPacket) hashValue;
-        CHK(pCurPacket != NULL, STATUS_NULL_ARG);
+        pSlot = jitterBufferGetSlot(pJitterBuffer, index);
+        CHK(pSlot != NULL, STATUS_HASH_KEY_NOT_PRESENT);
+        if (pSlot->isPadding) {
+            continue;
+        }
         partialFrameSize = remainingFrameSize;
-        CHK_STATUS(pJitterBuffer->depayPayloadFn(pCurPacket->payload, pCurPacket->payloadLength, pCurPtrInFrame, &partialFrameSize, NULL));
+        CHK_STATUS(
+            pJitterBuffer->depayPayloadFn(pSlot->pRtpPacket->payload, pSlot->pRtpPacket->payloadLength, pCurPtrInFrame, &partialFrameSize, NULL));
         pCurPtrInFrame += partialFrameSize;
         remainingFrameSize -= partialFrameSize;
     }
@@ -666,3 +732,117 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS jitterBufferGetPacket(PJitterBuffer pJitterBuffer, UINT16 sequenceNumber, PRtpPacket* ppRtpPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PJitterBufferSlot pSlot = NULL;
+
+    CHK(pJitterBuffer != NULL && ppRtpPacket != NULL, STATUS_NULL_ARG);
+    pSlot = jitterBufferGetSlot(pJitterBuffer, sequenceNumber);
+    CHK(pSlot != NULL, STATUS_NOT_FOUND);
+    *ppRtpPacket = pSlot->isPadding ? NULL : pSlot->pRtpPacket;
+
+CleanUp:
+    return retStatus;
+}
+
+STATUS jitterBufferTakePacket(PJitterBuffer pJitterBuffer, UINT16 sequenceNumber, PRtpPacket* ppRtpPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PJitterBufferSlot pSlot = NULL;
+
+    CHK(pJitterBuffer != NULL && ppRtpPacket != NULL, STATUS_NULL_ARG);
+    pSlot = jitterBufferGetSlot(pJitterBuffer, sequenceNumber);
+    CHK(pSlot != NULL, STATUS_NOT_FOUND);
+    // Padding stays in the ring and is freed along with the frame
+    *ppRtpPacket = pSlot->isPadding ? NULL : pSlot->pRtpPacket;
+    if (!pSlot->isPadding) {
+        pSlot->pRtpPacket = NULL;
+    }
+
+CleanUp:
+    return retStatus;
+}
+
+PJitterBufferSlot jitterBufferGetSlot(PJitterBuffer pJitterBuffer, UINT16 sequenceNumber)
+{
+    PJitterBufferSlot pSlot = &pJitterBuffer->pRing[sequenceNumber & (pJitterBuffer->ringCapacity - 1)];
+
+    if (pSlot->pRtpPacket == NULL || pSlot->pRtpPacket->header.sequenceNumber != sequenceNumber) {
+        return NULL;
+    }
+
+    return pSlot;
+}
+
+STATUS jitterBufferGrowRing(PJitterBuffer pJitterBuffer)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, newCapacity = pJitterBuffer->ringCapacity * 2;
+    PJitterBufferSlot pNewRing = NULL, pSlot;
+
+    CHK(newCapacity <= JITTER_BUFFER_MAX_RING_CAPACITY, STATUS_INVALID_OPERATION);
+    pNewRing = (PJitterBufferSlot) MEMCALLOC(newCapacity, SIZEOF(JitterBufferSlot));
+    CHK(pNewRing != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    // Sequence numbers that did not collide in the smaller ring can not collide in the bigger one
+    for (i = 0; i < pJitterBuffer->ringCapacity; i++) {
+        pSlot = &pJitterBuffer->pRing[i];
+        if (pSlot->pRtpPacket != NULL) {
+            pNewRing[pSlot->pRtpPacket->header.sequenceNumber & (newCapacity - 1)] = *pSlot;
+        }
+    }
+
+    MEMFREE(pJitterBuffer->pRing);
+    pJitterBuffer->pRing = pNewRing;
+    pJitterBuffer->ringCapacity = newCapacity;
+    DLOGS("Jitter buffer ring grown to %u slots", newCapacity);
+
+CleanUp:
+    return retStatus;
+}
+
+STATUS jitterBufferStorePacket(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket, UINT32 payloadSize, BOOL isStart, BOOL isPadding)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT16 sequenceNumber = pRtpPacket->header.sequenceNumber, windowStart = pJitterBuffer->headSequenceNumber;
+    PJitterBufferSlot pSlot = NULL;
+
+    // The packet can still become the new head if it is earlier than the current one
+    if (JITTER_BUFFER_SEQUENCE_NUMBER_IN_RANGE(windowStart, sequenceNumber, pJitterBuffer->tailSequenceNumber)) {
+        windowStart = sequenceNumber;
+    }
+
+    pSlot = &pJitterBuffer->pRing[sequenceNumber & (pJitterBuffer->ringCapacity - 1)];
+    while (pSlot->pRtpPacket != NULL && pSlot->pRtpPacket->header.sequenceNumber != sequenceNumber) {
+        if (JITTER_BUFFER_SEQUENCE_NUMBER_IN_RANGE(pSlot->pRtpPacket->header.sequenceNumber, windowStart, pJitterBuffer->tailSequenceNumber)) {
+            CHK_STATUS(jitterBufferGrowRing(pJitterBuffer));
+            pSlot = &pJitterBuffer->pRing[sequenceNumber & (pJitterBuffer->ringCapacity - 1)];
+        } else {
+            // Left behind the head, it can never be part of a frame anymore
+            freeRtpPacket(&pSlot->pRtpPacket);
+            pSlot->pRtpPacket = NULL;
+        }
+    }
+
+    // Duplicate packet, keep the latest one
+    if (pSlot->pRtpPacket != NULL && pSlot->pRtpPacket != pRtpPacket) {
+        freeRtpPacket(&pSlot->pRtpPacket);
+    }
+
+    pSlot->pRtpPacket = pRtpPacket;
+    pSlot->payloadSize = payloadSize;
+    pSlot->isStart = isStart;
+    pSlot->isPadding = isPadding;
+
+    // The previous parse went past this sequence number without it
+    if (pJitterBuffer->parseCursorValid &&
+        (UINT16) (sequenceNumber - pJitterBuffer->parseHeadSequenceNumber) <
+            (UINT16) (pJitterBuffer->parseCursor - pJitterBuffer->parseHeadSequenceNumber)) {
+        pJitterBuffer->parseCursorValid = FALSE;
+    }
+
+CleanUp:
+    return retStatus;
+}
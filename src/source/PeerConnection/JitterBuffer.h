@@ -14,8 +14,18 @@ typedef STATUS (*FrameReadyFunc)(UINT64, UINT16, UINT16, UINT32);
 typedef STATUS (*FrameDroppedFunc)(UINT64, UINT16, UINT16, UINT32);
 #define UINT16_DEC(a) ((UINT16) ((a) - 1))
 
-#define JITTER_BUFFER_HASH_TABLE_BUCKET_COUNT  3000
-#define JITTER_BUFFER_HASH_TABLE_BUCKET_LENGTH 2
+// Packets are stored in a ring indexed by sequence number. Power of 2, grows when two live packets collide
+#define JITTER_BUFFER_INITIAL_RING_CAPACITY 512
+#define JITTER_BUFFER_MAX_RING_CAPACITY     (MAX_RTP_SEQUENCE_NUM + 1)
+
+typedef struct {
+    PRtpPacket pRtpPacket;
+    // Depayloaded size and start of frame flag, computed once when the packet is pushed
+    UINT32 payloadSize;
+    BOOL isStart;
+    // Takes a sequence number without being part of any frame, like a FEC packet sharing the sequence numbers of the media
+    BOOL isPadding;
+} JitterBufferSlot, *PJitterBufferSlot;
 
 typedef struct {
     FrameReadyFunc onFrameReadyFn;
@@ -41,7 +51,18 @@ typedef struct {
     BOOL firstFrameProcessed;
     BOOL sequenceNumberOverflowState;
     BOOL timestampOverFlowState;
-    PHashTable pPkgBufferHashTable;
+
+    PJitterBufferSlot pRing;
+    UINT32 ringCapacity;
+
+    // Where the previous parse stopped. Packets from the head up to the cursor are all present and belong to the
+    // head frame, so the next parse can resume from there as long as the head did not move and nothing was inserted before the cursor
+    BOOL parseCursorValid;
+    UINT16 parseCursor;
+    UINT16 parseHeadSequenceNumber;
+    UINT32 parseHeadTimestamp;
+    UINT32 parseFrameSize;
+    BOOL parseContainsStart;
 } JitterBuffer, *PJitterBuffer;
 
 // constructor
@@ -49,8 +70,14 @@ STATUS createJitterBuffer(FrameReadyFunc, FrameDroppedFunc, DepayRtpPayloadFunc,
 // destructor
 STATUS freeJitterBuffer(PJitterBuffer*);
 STATUS jitterBufferPush(PJitterBuffer, PRtpPacket, PBOOL);
+// Fills the sequence number of the packet so that the frame around it is still continuous, its payload is never delivered
+STATUS jitterBufferPushPadding(PJitterBuffer, PRtpPacket, PBOOL);
 STATUS jitterBufferDropBufferData(PJitterBuffer, UINT16, UINT16, UINT32);
 STATUS jitterBufferFillFrameData(PJitterBuffer, PBYTE, UINT32, PUINT32, UINT16, UINT16);
+// The packet is NULL for padding
+STATUS jitterBufferGetPacket(PJitterBuffer, UINT16, PRtpPacket*);
+// Like jitterBufferGetPacket, the caller owns the packet afterwards and dropping the frame no longer frees it
+STATUS jitterBufferTakePacket(PJitterBuffer, UINT16, PRtpPacket*);
 
 #ifdef __cplusplus
 }
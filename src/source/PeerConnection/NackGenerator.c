@@ -0,0 +1,240 @@
+#define LOG_CLASS "NackGenerator"
+
+#include "../Include_i.h"
+
+STATUS createNackGenerator(TIMER_QUEUE_HANDLE timerQueueHandle, UINT32 maxRetries, UINT32 pliLossBudget, NackGeneratorSendFunc sendFn,
+                           UINT64 customData, PNackGenerator* ppNackGenerator)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PNackGenerator pNackGenerator = NULL;
+
+    CHK(sendFn != NULL && ppNackGenerator != NULL, STATUS_NULL_ARG);
+
+    CHK(NULL != (pNackGenerator = (PNackGenerator) MEMCALLOC(1, SIZEOF(NackGenerator))), STATUS_NOT_ENOUGH_MEMORY);
+    pNackGenerator->lock = MUTEX_CREATE(FALSE);
+    pNackGenerator->timerQueueHandle = timerQueueHandle;
+    pNackGenerator->timerId = MAX_UINT32;
+    pNackGenerator->sendFn = sendFn;
+    pNackGenerator->customData = customData;
+    pNackGenerator->maxRetries = maxRetries == 0 ? NACK_GENERATOR_DEFAULT_MAX_RETRIES : maxRetries;
+    pNackGenerator->pliLossBudget = pliLossBudget == 0 ? NACK_GENERATOR_DEFAULT_PLI_LOSS_BUDGET : pliLossBudget;
+    pNackGenerator->roundTripTime = NACK_GENERATOR_DEFAULT_ROUND_TRIP_TIME;
+
+    if (IS_VALID_TIMER_QUEUE_HANDLE(timerQueueHandle)) {
+        CHK_STATUS(sharedTimerQueueAddTimer(timerQueueHandle, NACK_GENERATOR_PROCESS_INTERVAL, NACK_GENERATOR_PROCESS_INTERVAL,
+                                            nackGeneratorTimerCallback, (UINT64) pNackGenerator, &pNackGenerator->timerId));
+    }
+
+    *ppNackGenerator = pNackGenerator;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freeNackGenerator(&pNackGenerator);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeNackGenerator(PNackGenerator* ppNackGenerator)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PNackGenerator pNackGenerator = NULL;
+
+    CHK(ppNackGenerator != NULL, STATUS_NULL_ARG);
+    pNackGenerator = *ppNackGenerator;
+    CHK(pNackGenerator != NULL, retStatus);
+
+    // Waits for a running timer callback to return
+    if (pNackGenerator->timerId != MAX_UINT32) {
+        CHK_LOG_ERR(sharedTimerQueueCancelTimer(pNackGenerator->timerQueueHandle, pNackGenerator->timerId, (UINT64) pNackGenerator));
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pNackGenerator->lock)) {
+        MUTEX_FREE(pNackGenerator->lock);
+    }
+
+    SAFE_MEMFREE(*ppNackGenerator);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS nackGeneratorOnPacket(PNackGenerator pNackGenerator, UINT16 sequenceNumber, UINT64 currentTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PMissingPacket pMissingPacket;
+    UINT16 distance, gap, i;
+
+    CHK(pNackGenerator != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pNackGenerator->lock);
+
+    distance = (UINT16) (sequenceNumber - pNackGenerator->highestSequenceNumber);
+    if (!pNackGenerator->started) {
+        pNackGenerator->started = TRUE;
+        pNackGenerator->highestSequenceNumber = sequenceNumber;
+    } else if (distance == 0) {
+        // Duplicate
+    } else if (distance < MAX_RTP_SEQUENCE_NUM / 2) {
+        gap = distance - 1;
+        if (pNackGenerator->missingPacketCount + gap > NACK_GENERATOR_MAX_MISSING_PACKETS) {
+            DLOGW("Lost %u packets at once, requesting a keyframe", gap);
+            nackGeneratorLosePacketsLocked(pNackGenerator, pNackGenerator->missingPacketCount + gap);
+            pNackGenerator->keyFrameNeeded = TRUE;
+            pNackGenerator->missingPacketCount = 0;
+        } else {
+            for (i = 1; i <= gap; i++) {
+                pMissingPacket = &pNackGenerator->missingPackets[pNackGenerator->missingPacketCount++];
+                pMissingPacket->sequenceNumber = (UINT16) (pNackGenerator->highestSequenceNumber + i);
+                pMissingPacket->retries = 0;
+                pMissingPacket->nextNackTime = currentTime + NACK_GENERATOR_REORDERING_DELAY;
+            }
+        }
+        pNackGenerator->highestSequenceNumber = sequenceNumber;
+    } else {
+        // Late, either reordered or retransmitted
+        for (i = 0; i < pNackGenerator->missingPacketCount; i++) {
+            if (pNackGenerator->missingPackets[i].sequenceNumber == sequenceNumber) {
+                MEMMOVE(&pNackGenerator->missingPackets[i], &pNackGenerator->missingPackets[i + 1],
+                        (pNackGenerator->missingPacketCount - i - 1) * SIZEOF(MissingPacket));
+                pNackGenerator->missingPacketCount--;
+                break;
+            }
+        }
+    }
+
+    MUTEX_UNLOCK(pNackGenerator->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS nackGeneratorDropUntil(PNackGenerator pNackGenerator, UINT16 sequenceNumber)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 count = 0;
+
+    CHK(pNackGenerator != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pNackGenerator->lock);
+
+    // The missing packets are in order, the ones at or before the sequence number are at the front
+    while (count < pNackGenerator->missingPacketCount &&
+           (UINT16) (sequenceNumber - pNackGenerator->missingPackets[count].sequenceNumber) < MAX_RTP_SEQUENCE_NUM / 2) {
+        count++;
+    }
+    if (count > 0) {
+        MEMMOVE(&pNackGenerator->missingPackets[0], &pNackGenerator->missingPackets[count],
+                (pNackGenerator->missingPacketCount - count) * SIZEOF(MissingPacket));
+        pNackGenerator->missingPacketCount -= count;
+        nackGeneratorLosePacketsLocked(pNackGenerator, count);
+    }
+
+    MUTEX_UNLOCK(pNackGenerator->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS nackGeneratorSetRoundTripTime(PNackGenerator pNackGenerator, UINT64 roundTripTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pNackGenerator != NULL, STATUS_NULL_ARG);
+    CHK(roundTripTime != 0, retStatus);
+
+    MUTEX_LOCK(pNackGenerator->lock);
+    pNackGenerator->roundTripTime = roundTripTime;
+    MUTEX_UNLOCK(pNackGenerator->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS nackGeneratorProcess(PNackGenerator pNackGenerator)
+{
+    return nackGeneratorProcessAtTime(pNackGenerator, GETTIME());
+}
+
+STATUS nackGeneratorProcessAtTime(PNackGenerator pNackGenerator, UINT64 currentTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT16 sequenceNumbers[NACK_GENERATOR_MAX_BATCH_SIZE];
+    PMissingPacket pMissingPacket;
+    UINT32 i, kept = 0, lost = 0, count = 0;
+    BOOL sendPli = FALSE;
+
+    CHK(pNackGenerator != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pNackGenerator->lock);
+
+    for (i = 0; i < pNackGenerator->missingPacketCount; i++) {
+        pMissingPacket = &pNackGenerator->missingPackets[i];
+        if (currentTime >= pMissingPacket->nextNackTime) {
+            if (pMissingPacket->retries >= pNackGenerator->maxRetries) {
+                lost++;
+                continue;
+            }
+            if (count < NACK_GENERATOR_MAX_BATCH_SIZE) {
+                sequenceNumbers[count++] = pMissingPacket->sequenceNumber;
+                pMissingPacket->retries++;
+                // The retransmission takes at least a round trip to arrive
+                pMissingPacket->nextNackTime = currentTime + MAX(pNackGenerator->roundTripTime, NACK_GENERATOR_MIN_RETRY_INTERVAL);
+            }
+        }
+        pNackGenerator->missingPackets[kept++] = *pMissingPacket;
+    }
+    pNackGenerator->missingPacketCount = kept;
+    nackGeneratorLosePacketsLocked(pNackGenerator, lost);
+
+    if (pNackGenerator->keyFrameNeeded &&
+        (pNackGenerator->lastPliTime == 0 ||
+         currentTime - pNackGenerator->lastPliTime >= MAX(pNackGenerator->roundTripTime, NACK_GENERATOR_MIN_PLI_INTERVAL))) {
+        // The keyframe makes the missing packets useless
+        sendPli = TRUE;
+        count = 0;
+        pNackGenerator->missingPacketCount = 0;
+        pNackGenerator->lostPacketCount = 0;
+        pNackGenerator->keyFrameNeeded = FALSE;
+        pNackGenerator->lastPliTime = currentTime;
+    }
+
+    MUTEX_UNLOCK(pNackGenerator->lock);
+
+    if (count > 0 || sendPli) {
+        CHK_STATUS(pNackGenerator->sendFn(pNackGenerator->customData, sequenceNumbers, count, sendPli));
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS nackGeneratorTimerCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData)
+{
+    UNUSED_PARAM(timerId);
+    UNUSED_PARAM(currentTime);
+
+    CHK_LOG_ERR(nackGeneratorProcess((PNackGenerator) customData));
+
+    return STATUS_SUCCESS;
+}
+
+VOID nackGeneratorLosePacketsLocked(PNackGenerator pNackGenerator, UINT32 count)
+{
+    pNackGenerator->lostPacketCount += count;
+    if (count > 0 && pNackGenerator->lostPacketCount >= pNackGenerator->pliLossBudget) {
+        pNackGenerator->keyFrameNeeded = TRUE;
+    }
+}
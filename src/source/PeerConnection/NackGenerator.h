@@ -0,0 +1,149 @@
+/*******************************************
+NackGenerator internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_NACK_GENERATOR__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_NACK_GENERATOR__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Period of the generator timer
+#define NACK_GENERATOR_PROCESS_INTERVAL (10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Time a gap is given to be filled by a reordered packet before it is NACKed
+#define NACK_GENERATOR_REORDERING_DELAY (5 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Round trip time used until one is measured from the receiver reports
+#define NACK_GENERATOR_DEFAULT_ROUND_TRIP_TIME (100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// A NACK is not repeated sooner than this, however small the round trip time
+#define NACK_GENERATOR_MIN_RETRY_INTERVAL (20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+#define NACK_GENERATOR_DEFAULT_MAX_RETRIES 10
+
+// Number of packets given up on before a keyframe is requested with a PLI
+#define NACK_GENERATOR_DEFAULT_PLI_LOSS_BUDGET 5
+
+// PLIs are not sent more often than this, the keyframe needs time to arrive
+#define NACK_GENERATOR_MIN_PLI_INTERVAL (500 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Packets tracked as missing at once. A bigger gap is not worth recovering packet by packet, a keyframe is requested instead
+#define NACK_GENERATOR_MAX_MISSING_PACKETS 512
+
+// Sequence numbers NACKed at once, they all fit in one RTCP packet within the MTU
+#define NACK_GENERATOR_MAX_BATCH_SIZE 128
+
+typedef struct {
+    UINT16 sequenceNumber;
+    // NACKs sent so far
+    UINT32 retries;
+    // The packet is NACKed again, or given up on once out of retries, from then on
+    UINT64 nextNackTime;
+} MissingPacket, *PMissingPacket;
+
+/**
+ * Sends the loss feedback of one process run. Invoked without the generator lock held.
+ *
+ * @param - UINT64 - IN - customData given to createNackGenerator
+ * @param - PUINT16 - IN - sequence numbers to NACK in increasing order
+ * @param - UINT32 - IN - number of sequence numbers, can be 0
+ * @param - BOOL - IN - whether a PLI should be sent as well
+ *
+ * @return - STATUS status of execution
+ */
+typedef STATUS (*NackGeneratorSendFunc)(UINT64, PUINT16, UINT32, BOOL);
+
+/**
+ * Tracks the sequence number gaps of an inbound stream and NACKs them, once per round trip, until they are received
+ * or the retries run out. Packets that could not be recovered count against a loss budget, a PLI is requested once it is spent.
+ */
+typedef struct {
+    MUTEX lock;
+
+    TIMER_QUEUE_HANDLE timerQueueHandle;
+    UINT32 timerId;
+
+    NackGeneratorSendFunc sendFn;
+    UINT64 customData;
+
+    UINT32 maxRetries;
+    UINT32 pliLossBudget;
+    UINT64 roundTripTime;
+
+    BOOL started;
+    UINT16 highestSequenceNumber;
+
+    // Missing packets in sequence number order
+    MissingPacket missingPackets[NACK_GENERATOR_MAX_MISSING_PACKETS];
+    UINT32 missingPacketCount;
+
+    // Packets given up on since the last PLI
+    UINT32 lostPacketCount;
+    BOOL keyFrameNeeded;
+    UINT64 lastPliTime;
+} NackGenerator, *PNackGenerator;
+
+/**
+ * Create a NACK generator. When the timer queue handle is valid it runs periodically from it, otherwise only
+ * by nackGeneratorProcess calls.
+ *
+ * @param - TIMER_QUEUE_HANDLE - IN - timer queue to run from
+ * @param - UINT32 - IN - NACKs sent per packet before giving up on it, NACK_GENERATOR_DEFAULT_MAX_RETRIES when 0
+ * @param - UINT32 - IN - packets given up on before a PLI, NACK_GENERATOR_DEFAULT_PLI_LOSS_BUDGET when 0
+ * @param - NackGeneratorSendFunc - IN - function sending the feedback
+ * @param - UINT64 - IN - custom data for the send function
+ * @param - PNackGenerator* - OUT - the new generator
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createNackGenerator(TIMER_QUEUE_HANDLE, UINT32, UINT32, NackGeneratorSendFunc, UINT64, PNackGenerator*);
+
+/**
+ * Cancel the generator timer and free the generator
+ */
+STATUS freeNackGenerator(PNackGenerator*);
+
+/**
+ * Account for a received packet. Sequence numbers skipped since the highest one received are tracked as missing.
+ *
+ * @param - PNackGenerator - IN - the generator
+ * @param - UINT16 - IN - sequence number of the packet
+ * @param - UINT64 - IN - time the packet was received at
+ */
+STATUS nackGeneratorOnPacket(PNackGenerator, UINT16, UINT64);
+
+/**
+ * Stop tracking the missing packets up to and including the sequence number, the jitter buffer gave up on their frame.
+ * They count as lost.
+ */
+STATUS nackGeneratorDropUntil(PNackGenerator, UINT16);
+
+/**
+ * @param - PNackGenerator - IN - the generator
+ * @param - UINT64 - IN - round trip time, ignored when 0
+ */
+STATUS nackGeneratorSetRoundTripTime(PNackGenerator, UINT64);
+
+/**
+ * NACK the missing packets that are due and send a PLI if the loss budget is spent
+ */
+STATUS nackGeneratorProcess(PNackGenerator);
+
+/**
+ * Same as nackGeneratorProcess with the current time given by the caller
+ */
+STATUS nackGeneratorProcessAtTime(PNackGenerator, UINT64);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+STATUS nackGeneratorTimerCallback(UINT32, UINT64, UINT64);
+VOID nackGeneratorLosePacketsLocked(PNackGenerator, UINT32);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_NACK_GENERATOR__ */
@@ -0,0 +1,282 @@
+#define LOG_CLASS "Pacer"
+
+#include "../Include_i.h"
+
+STATUS createPacer(TIMER_QUEUE_HANDLE timerQueueHandle, UINT64 targetBitrate, PacerSendPacketsFunc sendPacketsFn, UINT64 customData,
+                   PPacer* ppPacer)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PPacer pPacer = NULL;
+    UINT32 i;
+
+    CHK(sendPacketsFn != NULL && ppPacer != NULL, STATUS_NULL_ARG);
+
+    CHK(NULL != (pPacer = (PPacer) MEMCALLOC(1, SIZEOF(Pacer))), STATUS_NOT_ENOUGH_MEMORY);
+    pPacer->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pPacer->lock), STATUS_INVALID_OPERATION);
+    pPacer->sendLock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pPacer->sendLock), STATUS_INVALID_OPERATION);
+    pPacer->timerQueueHandle = timerQueueHandle;
+    pPacer->timerId = MAX_UINT32;
+    pPacer->sendPacketsFn = sendPacketsFn;
+    pPacer->customData = customData;
+    pPacer->targetBitrate = targetBitrate == 0 ? DEFAULT_PACER_TARGET_BITRATE : targetBitrate;
+    pPacer->lastBudgetUpdateTime = GETTIME();
+
+    for (i = 0; i < PACER_PRIORITY_COUNT; i++) {
+        CHK(NULL != (pPacer->queues[i].pPackets = (PPacedPacket) MEMALLOC(PACER_INITIAL_QUEUE_CAPACITY * SIZEOF(PacedPacket))),
+            STATUS_NOT_ENOUGH_MEMORY);
+        pPacer->queues[i].capacity = PACER_INITIAL_QUEUE_CAPACITY;
+    }
+
+    if (IS_VALID_TIMER_QUEUE_HANDLE(timerQueueHandle)) {
+        CHK_STATUS(sharedTimerQueueAddTimer(timerQueueHandle, PACER_PROCESS_INTERVAL, PACER_PROCESS_INTERVAL, pacerTimerCallback, (UINT64) pPacer,
+                                            &pPacer->timerId));
+    }
+
+    *ppPacer = pPacer;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freePacer(&pPacer);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freePacer(PPacer* ppPacer)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PPacer pPacer = NULL;
+    PPacerQueue pQueue;
+    UINT32 i, j;
+
+    CHK(ppPacer != NULL, STATUS_NULL_ARG);
+    pPacer = *ppPacer;
+    CHK(pPacer != NULL, retStatus);
+
+    // Waits for a running timer callback to return
+    if (pPacer->timerId != MAX_UINT32) {
+        CHK_LOG_ERR(sharedTimerQueueCancelTimer(pPacer->timerQueueHandle, pPacer->timerId, (UINT64) pPacer));
+    }
+
+    for (i = 0; i < PACER_PRIORITY_COUNT; i++) {
+        pQueue = &pPacer->queues[i];
+        for (j = 0; pQueue->pPackets != NULL && j < pQueue->count; j++) {
+            rtpPacketBufferRelease(&pQueue->pPackets[(pQueue->head + j) % pQueue->capacity].pRtpPacketBuffer);
+        }
+        SAFE_MEMFREE(pQueue->pPackets);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pPacer->lock)) {
+        MUTEX_FREE(pPacer->lock);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pPacer->sendLock)) {
+        MUTEX_FREE(pPacer->sendLock);
+    }
+
+    SAFE_MEMFREE(*ppPacer);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS pacerSetTargetBitrate(PPacer pPacer, UINT64 targetBitrate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pPacer != NULL, STATUS_NULL_ARG);
+    CHK(targetBitrate != 0, retStatus);
+
+    MUTEX_LOCK(pPacer->lock);
+    // Settle the budget earned at the previous rate first
+    pacerUpdateBudgetLocked(pPacer, GETTIME());
+    pPacer->targetBitrate = targetBitrate;
+    MUTEX_UNLOCK(pPacer->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS pacerEnqueue(PPacer pPacer, PRtpPacketBuffer pRtpPacketBuffer, UINT64 customData, PACER_PRIORITY priority)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    PacedPacket pacedPacket;
+
+    CHK(pPacer != NULL && pRtpPacketBuffer != NULL, STATUS_NULL_ARG);
+    CHK(priority < PACER_PRIORITY_COUNT, STATUS_INVALID_ARG);
+
+    pacedPacket.pRtpPacketBuffer = pRtpPacketBuffer;
+    pacedPacket.customData = customData;
+    pacedPacket.enqueueTime = GETTIME();
+    pacedPacket.priority = priority;
+
+    MUTEX_LOCK(pPacer->lock);
+    locked = TRUE;
+
+    CHK_STATUS(pacerQueuePush(&pPacer->queues[priority], &pacedPacket));
+    CHK_STATUS(rtpPacketBufferAddRef(pRtpPacketBuffer));
+    pPacer->queuedPacketCount++;
+    pPacer->queuedByteCount += pRtpPacketBuffer->packet.rawPacketLength;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pPacer->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS pacerProcess(PPacer pPacer)
+{
+    return pacerProcessAtTime(pPacer, GETTIME());
+}
+
+STATUS pacerProcessAtTime(PPacer pPacer, UINT64 currentTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PPacerQueue pQueue;
+    PPacedPacket pPacedPacket;
+    UINT32 i, batchSize = 0;
+
+    CHK(pPacer != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pPacer->sendLock);
+
+    do {
+        batchSize = 0;
+
+        MUTEX_LOCK(pPacer->lock);
+        pacerUpdateBudgetLocked(pPacer, currentTime);
+        for (i = 0; i < PACER_PRIORITY_COUNT && batchSize < PACER_MAX_BATCH_SIZE;) {
+            pQueue = &pPacer->queues[i];
+            if (pQueue->count == 0) {
+                i++;
+                continue;
+            }
+            if (i != PACER_PRIORITY_AUDIO && pPacer->budget <= 0) {
+                break;
+            }
+
+            pPacedPacket = &pPacer->batch[batchSize++];
+            *pPacedPacket = pQueue->pPackets[pQueue->head];
+            pQueue->head = (pQueue->head + 1) % pQueue->capacity;
+            pQueue->count--;
+
+            pPacer->budget -= (INT64) pPacedPacket->pRtpPacketBuffer->packet.rawPacketLength;
+            pPacer->queuedPacketCount--;
+            pPacer->queuedByteCount -= pPacedPacket->pRtpPacketBuffer->packet.rawPacketLength;
+        }
+        MUTEX_UNLOCK(pPacer->lock);
+
+        if (batchSize > 0) {
+            CHK_LOG_ERR(pPacer->sendPacketsFn(pPacer->customData, pPacer->batch, batchSize));
+            for (i = 0; i < batchSize; i++) {
+                rtpPacketBufferRelease(&pPacer->batch[i].pRtpPacketBuffer);
+            }
+        }
+    } while (batchSize == PACER_MAX_BATCH_SIZE);
+
+    MUTEX_UNLOCK(pPacer->sendLock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS pacerGetQueueDepth(PPacer pPacer, PUINT32 pPacketCount, PUINT64 pByteCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pPacer != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pPacer->lock);
+    if (pPacketCount != NULL) {
+        *pPacketCount = pPacer->queuedPacketCount;
+    }
+    if (pByteCount != NULL) {
+        *pByteCount = pPacer->queuedByteCount;
+    }
+    MUTEX_UNLOCK(pPacer->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS pacerTimerCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData)
+{
+    UNUSED_PARAM(timerId);
+    UNUSED_PARAM(currentTime);
+
+    // The timer time is the expiration time, which can be up to a tick in the past
+    pacerProcess((PPacer) customData);
+
+    return STATUS_SUCCESS;
+}
+
+STATUS pacerQueuePush(PPacerQueue pQueue, PPacedPacket pPacedPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PPacedPacket pPackets = NULL;
+    UINT32 i;
+
+    if (pQueue->count == pQueue->capacity) {
+        // The link cannot keep up even at the drain rate, the caller drops the packet
+        CHK(pQueue->capacity < PACER_MAX_QUEUE_CAPACITY, STATUS_RTP_PACER_QUEUE_FULL);
+        CHK(NULL != (pPackets = (PPacedPacket) MEMALLOC(2 * pQueue->capacity * SIZEOF(PacedPacket))), STATUS_NOT_ENOUGH_MEMORY);
+        for (i = 0; i < pQueue->count; i++) {
+            pPackets[i] = pQueue->pPackets[(pQueue->head + i) % pQueue->capacity];
+        }
+        SAFE_MEMFREE(pQueue->pPackets);
+        pQueue->pPackets = pPackets;
+        pQueue->capacity *= 2;
+        pQueue->head = 0;
+    }
+
+    pQueue->pPackets[(pQueue->head + pQueue->count) % pQueue->capacity] = *pPacedPacket;
+    pQueue->count++;
+
+CleanUp:
+
+    return retStatus;
+}
+
+UINT64 pacerGetPacingRateLocked(PPacer pPacer)
+{
+    UINT64 pacingRate = (UINT64) (pPacer->targetBitrate * PACER_PACING_FACTOR);
+    // Rate at which the current queue would be gone within PACER_MAX_QUEUE_DELAY
+    UINT64 drainRate = pPacer->queuedByteCount * 8 * HUNDREDS_OF_NANOS_IN_A_SECOND / PACER_MAX_QUEUE_DELAY;
+
+    return MAX(pacingRate, drainRate);
+}
+
+VOID pacerUpdateBudgetLocked(PPacer pPacer, UINT64 currentTime)
+{
+    UINT64 elapsed, pacingRate;
+    INT64 maxBudget;
+
+    if (currentTime <= pPacer->lastBudgetUpdateTime) {
+        return;
+    }
+
+    elapsed = MIN(currentTime - pPacer->lastBudgetUpdateTime, PACER_MAX_BURST_DURATION);
+    pPacer->lastBudgetUpdateTime = currentTime;
+
+    pacingRate = pacerGetPacingRateLocked(pPacer);
+    maxBudget = (INT64) (pacingRate * PACER_MAX_BURST_DURATION / 8 / HUNDREDS_OF_NANOS_IN_A_SECOND);
+    pPacer->budget += (INT64) (pacingRate * elapsed / 8 / HUNDREDS_OF_NANOS_IN_A_SECOND);
+    pPacer->budget = MIN(pPacer->budget, maxBudget);
+}
@@ -0,0 +1,171 @@
+/*******************************************
+Pacer internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_PACER__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_PACER__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Target bitrate used until the application or the bandwidth estimation sets one
+#define DEFAULT_PACER_TARGET_BITRATE (1 * 1024 * 1024)
+
+// Packets leave faster than the target bitrate so that a frame does not sit in the queue for a whole frame interval
+#define PACER_PACING_FACTOR 2.5
+
+// The queue is drained at least fast enough to empty it within this delay, whatever the target bitrate
+#define PACER_MAX_QUEUE_DELAY (1000 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Unused budget is capped to this much sending time so that an idle period does not turn into a burst
+#define PACER_MAX_BURST_DURATION (10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Period of the pacer timer. Same as the shared timer wheel resolution
+#define PACER_PROCESS_INTERVAL (5 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Maximum number of packets handed to the send function at once
+#define PACER_MAX_BATCH_SIZE 64
+
+#define PACER_INITIAL_QUEUE_CAPACITY 64
+
+// Packets each queue can hold, a power of two multiple of PACER_INITIAL_QUEUE_CAPACITY. Over 5MB of 1200 byte packets
+#define PACER_MAX_QUEUE_CAPACITY 4096
+
+/**
+ * Queues are served in this order. Audio is never held back by the budget, it is only charged against it.
+ */
+typedef enum {
+    PACER_PRIORITY_AUDIO = 0,
+    PACER_PRIORITY_RETRANSMISSION = 1,
+    PACER_PRIORITY_VIDEO = 2,
+} PACER_PRIORITY;
+
+#define PACER_PRIORITY_COUNT 3
+
+typedef struct {
+    // Encrypted packet, sent as is. The pacer holds a reference until the packet has been handed to the send function
+    PRtpPacketBuffer pRtpPacketBuffer;
+    // Passed back to the send function along with the packet
+    UINT64 customData;
+    UINT64 enqueueTime;
+    PACER_PRIORITY priority;
+} PacedPacket, *PPacedPacket;
+
+/**
+ * Sends a batch of packets released by the pacer. Invoked without the pacer lock held, one batch at a time.
+ *
+ * @param - UINT64 - IN - customData given to createPacer
+ * @param - PPacedPacket - IN - packets in send order
+ * @param - UINT32 - IN - number of packets
+ *
+ * @return - STATUS status of execution
+ */
+typedef STATUS (*PacerSendPacketsFunc)(UINT64, PPacedPacket, UINT32);
+
+typedef struct {
+    // Ring of capacity packets, doubled when full up to PACER_MAX_QUEUE_CAPACITY
+    PPacedPacket pPackets;
+    UINT32 capacity;
+    UINT32 head;
+    UINT32 count;
+} PacerQueue, *PPacerQueue;
+
+/**
+ * Leaky bucket between packetization and the ICE agent. Budget accrues at the pacing rate and every released packet
+ * is charged against it, one packet of debt is allowed so that a packet bigger than the budget is not stuck forever.
+ */
+typedef struct {
+    // Protects the queues, the budget and the target bitrate
+    MUTEX lock;
+    // Serializes the drains so that packets leave in the order they were dequeued. Taken before lock
+    MUTEX sendLock;
+
+    TIMER_QUEUE_HANDLE timerQueueHandle;
+    UINT32 timerId;
+
+    PacerSendPacketsFunc sendPacketsFn;
+    UINT64 customData;
+
+    // bits per second
+    UINT64 targetBitrate;
+    // bytes, negative when in debt
+    INT64 budget;
+    UINT64 lastBudgetUpdateTime;
+
+    PacerQueue queues[PACER_PRIORITY_COUNT];
+    UINT32 queuedPacketCount;
+    UINT64 queuedByteCount;
+
+    // Packets of the batch being sent, only accessed with sendLock held
+    PacedPacket batch[PACER_MAX_BATCH_SIZE];
+} Pacer, *PPacer;
+
+/**
+ * Create a pacer. When the timer queue handle is valid the queues are drained periodically from it, otherwise only
+ * by pacerProcess calls.
+ *
+ * @param - TIMER_QUEUE_HANDLE - IN - timer queue to drain the queues from
+ * @param - UINT64 - IN - target bitrate in bits per second, DEFAULT_PACER_TARGET_BITRATE when 0
+ * @param - PacerSendPacketsFunc - IN - function sending the released packets
+ * @param - UINT64 - IN - custom data for the send function
+ * @param - PPacer* - OUT - the new pacer
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createPacer(TIMER_QUEUE_HANDLE, UINT64, PacerSendPacketsFunc, UINT64, PPacer*);
+
+/**
+ * Cancel the pacer timer and free the pacer. Packets still queued are dropped.
+ */
+STATUS freePacer(PPacer*);
+
+/**
+ * @param - PPacer - IN - the pacer
+ * @param - UINT64 - IN - target bitrate in bits per second. Ignored when 0
+ */
+STATUS pacerSetTargetBitrate(PPacer, UINT64);
+
+/**
+ * Queue an encrypted packet. The pacer takes its own reference on the buffer, nothing is sent until the next pacerProcess.
+ * Fails with STATUS_RTP_PACER_QUEUE_FULL when the queue of the priority holds PACER_MAX_QUEUE_CAPACITY packets
+ *
+ * @param - PPacer - IN - the pacer
+ * @param - PRtpPacketBuffer - IN - packet to send
+ * @param - UINT64 - IN - custom data handed back to the send function with the packet
+ * @param - PACER_PRIORITY - IN - queue of the packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS pacerEnqueue(PPacer, PRtpPacketBuffer, UINT64, PACER_PRIORITY);
+
+/**
+ * Send as many queued packets as the budget allows
+ */
+STATUS pacerProcess(PPacer);
+
+/**
+ * Same as pacerProcess with the current time given by the caller
+ */
+STATUS pacerProcessAtTime(PPacer, UINT64);
+
+/**
+ * @param - PPacer - IN - the pacer
+ * @param - PUINT32 - OUT - OPTIONAL - number of packets queued
+ * @param - PUINT64 - OUT - OPTIONAL - number of bytes queued
+ */
+STATUS pacerGetQueueDepth(PPacer, PUINT32, PUINT64);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+STATUS pacerTimerCallback(UINT32, UINT64, UINT64);
+STATUS pacerQueuePush(PPacerQueue, PPacedPacket);
+UINT64 pacerGetPacingRateLocked(PPacer);
+VOID pacerUpdateBudgetLocked(PPacer, UINT64);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_PACER__ */
@@ -209,15 +209,11 @@ VOID onInboundPacket(UINT64 customData, PBYTE buff, UINT32 buffLen)
         }
 
     } else if ((buff[0] > 127 && buff[0] < 192) && (pKvsPeerConnection->pSrtpSession != NULL)) {
-        if (buff[1] >= 192 && buff[1] <= 223) {
-            if (STATUS_FAILED(retStatus = decryptSrtcpPacket(pKvsPeerConnection->pSrtpSession, buff, &signedBuffLen))) {
-                DLOGW("decryptSrtcpPacket failed with 0x%08x", retStatus);
-                CHK(FALSE, STATUS_SUCCESS);
-            }
-
-            CHK_STATUS(onRtcpPacket(pKvsPeerConnection, buff, signedBuffLen));
+        if (pKvsPeerConnection->pReceiveQueue != NULL) {
+            // Decryption, depacketization and the frame callbacks run on the receive worker, the listener goes back to STUN and DTLS
+            CHK_STATUS(receiveQueuePush(pKvsPeerConnection->pReceiveQueue, buff, buffLen));
         } else {
-            CHK_STATUS(sendPacketToRtpReceiver(pKvsPeerConnection, buff, signedBuffLen));
+            CHK_STATUS(onInboundSrtpPacket(customData, buff, buffLen));
         }
     }
 
@@ -227,19 +223,57 @@ CleanUp:
     LEAVES();
 }
 
+STATUS onInboundSrtpPacket(UINT64 customData, PBYTE buff, UINT32 buffLen)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+    INT32 signedBuffLen = buffLen;
+
+    CHK(pKvsPeerConnection != NULL && buff != NULL, STATUS_NULL_ARG);
+    CHK(signedBuffLen > 2, STATUS_SUCCESS);
+
+    if (buff[1] >= 192 && buff[1] <= 223) {
+        if (STATUS_FAILED(retStatus = decryptSrtcpPacket(pKvsPeerConnection->pSrtpSession, buff, &signedBuffLen))) {
+            DLOGW("decryptSrtcpPacket failed with 0x%08x", retStatus);
+            CHK(FALSE, STATUS_SUCCESS);
+        }
+
+        CHK_STATUS(onRtcpPacket(pKvsPeerConnection, buff, signedBuffLen));
+    } else {
+        CHK_STATUS(sendPacketToRtpReceiver(pKvsPeerConnection, buff, signedBuffLen));
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+VOID onEgressBandwidthAllocation(UINT64 customData, UINT64 allocatedBitrate)
+{
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+
+    if (pKvsPeerConnection != NULL && pKvsPeerConnection->pPacer != NULL) {
+        CHK_LOG_ERR(pacerSetTargetBitrate(pKvsPeerConnection->pPacer, allocatedBitrate));
+    }
+}
+
 STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuffer, UINT32 bufferLen)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PDoubleListNode pCurNode = NULL;
-    PKvsRtpTransceiver pTransceiver;
-    UINT64 item, now;
+    PKvsRtpTransceiver pTransceiver = NULL;
+    UINT64 item = 0, now;
     UINT32 ssrc;
     PRtpPacket pRtpPacket = NULL;
     PBYTE pPayload = NULL;
-    BOOL ownedByJitterBuffer = FALSE, discarded = FALSE;
+    BOOL ownedByJitterBuffer = FALSE, discarded = FALSE, isFecPacket = FALSE, isRtxPacket = FALSE;
+    UINT16 sequenceNumber;
+    PBYTE pTwccExtension = NULL;
+    UINT8 twccExtensionLen = 0, blockPayloadType, aptPayloadType;
     UINT64 packetsReceived = 0, packetsFailedDecryption = 0, lastPacketReceivedTimestamp = 0, headerBytesReceived = 0, bytesReceived = 0,
-           packetsDiscarded = 0;
+           packetsDiscarded = 0, fecPacketsReceived = 0;
     INT64 arrival, r_ts, transit, delta;
 
     CHK(pKvsPeerConnection != NULL && pBuffer != NULL, STATUS_NULL_ARG);
@@ -247,54 +281,105 @@ STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuf
 
     ssrc = getInt32(*(PUINT32) (pBuffer + SSRC_OFFSET));
 
-    CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceivers, &pCurNode));
-    while (pCurNode != NULL) {
-        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
-        pTransceiver = (PKvsRtpTransceiver) item;
-
-        if (pTransceiver->jitterBufferSsrc == ssrc) {
-            packetsReceived++;
-            if (STATUS_FAILED(retStatus = decryptSrtpPacket(pKvsPeerConnection->pSrtpSession, pBuffer, (PINT32) &bufferLen))) {
-                DLOGW("decryptSrtpPacket failed with 0x%08x", retStatus);
-                packetsFailedDecryption++;
-                CHK(FALSE, STATUS_SUCCESS);
-            }
-            now = GETTIME();
-            CHK(NULL != (pPayload = (PBYTE) MEMALLOC(bufferLen)), STATUS_NOT_ENOUGH_MEMORY);
-            MEMCPY(pPayload, pBuffer, bufferLen);
-            CHK_STATUS(createRtpPacketFromBytes(pPayload, bufferLen, &pRtpPacket));
-            // pRtpPacket took ownership of pPayload. Set pPayload to NULL to
-            // avoid possible double-free.
-            pPayload = NULL;
-            pRtpPacket->receivedTime = now;
-
-            // https://tools.ietf.org/html/rfc3550#section-6.4.1
-            // https://tools.ietf.org/html/rfc3550#appendix-A.8
-            // interarrival jitter
-            // arrival, the current time in the same units.
-            // r_ts, the timestamp from   the incoming packet
-            arrival = KVS_CONVERT_TIMESCALE(now, HUNDREDS_OF_NANOS_IN_A_SECOND, pTransceiver->pJitterBuffer->clockRate);
-            r_ts = pRtpPacket->header.timestamp;
-            transit = arrival - r_ts;
-            delta = transit - pTransceiver->pJitterBuffer->transit;
-            pTransceiver->pJitterBuffer->transit = transit;
-            pTransceiver->pJitterBuffer->jitter += (1. / 16.) * ((DOUBLE) ABS(delta) - pTransceiver->pJitterBuffer->jitter);
-
-            headerBytesReceived += RTP_HEADER_LEN(pRtpPacket);
-            bytesReceived += pRtpPacket->rawPacketLength - RTP_HEADER_LEN(pRtpPacket);
-
-            CHK_STATUS(jitterBufferPush(pTransceiver->pJitterBuffer, pRtpPacket, &discarded));
-            if (discarded) {
-                packetsDiscarded++;
-            }
-            lastPacketReceivedTimestamp = KVS_CONVERT_TIMESCALE(now, HUNDREDS_OF_NANOS_IN_A_SECOND, 1000);
-            ownedByJitterBuffer = TRUE;
-            CHK(FALSE, STATUS_SUCCESS);
+    if (STATUS_FAILED(ssrcTableGet(pKvsPeerConnection->pSsrcTable, ssrc, SSRC_TABLE_KIND_RECEIVER, &item))) {
+        isRtxPacket = STATUS_SUCCEEDED(ssrcTableGet(pKvsPeerConnection->pSsrcTable, ssrc, SSRC_TABLE_KIND_RECEIVER_RTX, &item));
+        // Only report an ssrc the first time, a remote peer sending an unnegotiated stream would flood the logs otherwise
+        if (!isRtxPacket && ssrcTableReportUnknown(pKvsPeerConnection->pSsrcTable, ssrc)) {
+            DLOGW("No transceiver to handle inbound ssrc %u", ssrc);
+        }
+        CHK(isRtxPacket, STATUS_SUCCESS);
+    }
+    pTransceiver = (PKvsRtpTransceiver) item;
+
+    packetsReceived++;
+    if (STATUS_FAILED(retStatus = decryptSrtpPacket(pKvsPeerConnection->pSrtpSession, pBuffer, (PINT32) &bufferLen))) {
+        DLOGW("decryptSrtpPacket failed with 0x%08x", retStatus);
+        packetsFailedDecryption++;
+        CHK(FALSE, STATUS_SUCCESS);
+    }
+    now = GETTIME();
+
+    // Retransmissions go on as the packet they replace, with the payload type their apt names so that RTX of RED is taken out
+    // of RED below. Padding only packets probing the bandwidth have nothing to play.
+    if (isRtxPacket) {
+        aptPayloadType = pKvsPeerConnection->rtxAptPayloadTypes[pBuffer[1] & PAYLOAD_TYPE_MASK];
+        CHK(aptPayloadType != 0 && STATUS_SUCCEEDED(rtxDecapsulateRtpPacket(pBuffer, &bufferLen, aptPayloadType, pTransceiver->jitterBufferSsrc)),
+            STATUS_SUCCESS);
+    }
+
+    // Media and FEC packets are both carried in RED once ULPFEC is negotiated, they are taken out of it in place
+    if (pTransceiver->pFecDecoder != NULL && pKvsPeerConnection->ulpfecPayloadType != 0 &&
+        (pBuffer[1] & PAYLOAD_TYPE_MASK) == pKvsPeerConnection->redPayloadType) {
+        CHK_WARN(STATUS_SUCCEEDED(redDecapsulateRtpPacket(pBuffer, &bufferLen, &blockPayloadType)), STATUS_SUCCESS, "Dropping malformed RED packet");
+        isFecPacket = blockPayloadType == pKvsPeerConnection->ulpfecPayloadType;
+    }
+
+    CHK(NULL != (pPayload = (PBYTE) MEMALLOC(bufferLen)), STATUS_NOT_ENOUGH_MEMORY);
+    MEMCPY(pPayload, pBuffer, bufferLen);
+    CHK_STATUS(createRtpPacketFromBytes(pPayload, bufferLen, &pRtpPacket));
+    // pRtpPacket took ownership of pPayload. Set pPayload to NULL to
+    // avoid possible double-free.
+    pPayload = NULL;
+    pRtpPacket->receivedTime = now;
+
+    // https://tools.ietf.org/html/rfc3550#section-6.4.1
+    // https://tools.ietf.org/html/rfc3550#appendix-A.8
+    // interarrival jitter
+    // arrival, the current time in the same units.
+    // r_ts, the timestamp from   the incoming packet
+    // A retransmission arrives a round trip late, it says nothing about the jitter of the stream
+    if (!isRtxPacket) {
+        arrival = KVS_CONVERT_TIMESCALE(now, HUNDREDS_OF_NANOS_IN_A_SECOND, pTransceiver->pJitterBuffer->clockRate);
+        r_ts = pRtpPacket->header.timestamp;
+        transit = arrival - r_ts;
+        delta = transit - pTransceiver->pJitterBuffer->transit;
+        pTransceiver->pJitterBuffer->transit = transit;
+        pTransceiver->pJitterBuffer->jitter += (1. / 16.) * ((DOUBLE) ABS(delta) - pTransceiver->pJitterBuffer->jitter);
+    }
+
+    headerBytesReceived += RTP_HEADER_LEN(pRtpPacket);
+    bytesReceived += pRtpPacket->rawPacketLength - RTP_HEADER_LEN(pRtpPacket);
+
+    if (pKvsPeerConnection->pTwccFeedbackGenerator != NULL && pKvsPeerConnection->twccExtId != 0) {
+        // A malformed extension only costs the feedback, the media is still played
+        if (STATUS_SUCCEEDED(getRtpOneByteHeaderExtension(pRtpPacket, (UINT8) pKvsPeerConnection->twccExtId, &pTwccExtension, &twccExtensionLen)) &&
+            twccExtensionLen == SIZEOF(UINT16)) {
+            CHK_STATUS(twccFeedbackGeneratorOnPacket(pKvsPeerConnection->pTwccFeedbackGenerator, getUnalignedInt16BigEndian(pTwccExtension), ssrc,
+                                                     now));
+        }
+    }
+
+    lastPacketReceivedTimestamp = KVS_CONVERT_TIMESCALE(now, HUNDREDS_OF_NANOS_IN_A_SECOND, 1000);
+
+    // The jitter buffer can free the packet
+    sequenceNumber = pRtpPacket->header.sequenceNumber;
+    if (isFecPacket) {
+        // The decoder keeps what it needs. FEC packets are numbered along with the media, the jitter buffer takes them as padding
+        // so that the frame they follow is still continuous.
+        fecPacketsReceived++;
+        CHK_STATUS(fecDecoderOnFecPacket(pTransceiver->pFecDecoder, pRtpPacket));
+        // Freed by the jitter buffer even when it fails
+        ownedByJitterBuffer = TRUE;
+        CHK_STATUS(jitterBufferPushPadding(pTransceiver->pJitterBuffer, pRtpPacket, &discarded));
+    } else {
+        if (pTransceiver->pFecDecoder != NULL) {
+            CHK_STATUS(fecDecoderOnMediaPacket(pTransceiver->pFecDecoder, pRtpPacket));
+        }
+        CHK_STATUS(jitterBufferPush(pTransceiver->pJitterBuffer, pRtpPacket, &discarded));
+        ownedByJitterBuffer = TRUE;
+        if (discarded) {
+            packetsDiscarded++;
         }
-        pCurNode = pCurNode->pNext;
     }
 
-    DLOGW("No transceiver to handle inbound ssrc %u", ssrc);
+    // A received FEC packet is not asked for again either
+    if (!discarded && pTransceiver->pNackGenerator != NULL) {
+        CHK_STATUS(nackGeneratorOnPacket(pTransceiver->pNackGenerator, sequenceNumber, now));
+    }
+
+    if (pTransceiver->pFecDecoder != NULL) {
+        CHK_STATUS(pushRecoveredRtpPackets(pTransceiver, now));
+    }
 
 CleanUp:
     if (packetsReceived > 0) {
@@ -306,6 +391,10 @@ CleanUp:
         pTransceiver->inboundStats.bytesReceived += bytesReceived;
         pTransceiver->inboundStats.received.jitter = pTransceiver->pJitterBuffer->jitter / pTransceiver->pJitterBuffer->clockRate;
         pTransceiver->inboundStats.received.packetsDiscarded += packetsDiscarded;
+        pTransceiver->inboundStats.fecPacketsReceived += fecPacketsReceived;
+        if (pTransceiver->pFecDecoder != NULL) {
+            pTransceiver->inboundStats.fecPacketsDiscarded = pTransceiver->pFecDecoder->fecPacketsDiscarded;
+        }
         MUTEX_UNLOCK(pTransceiver->statsLock);
     }
     if (!ownedByJitterBuffer) {
@@ -319,6 +408,37 @@ CleanUp:
     return retStatus;
 }
 
+STATUS pushRecoveredRtpPackets(PKvsRtpTransceiver pTransceiver, UINT64 now)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacket pRtpPacket = NULL;
+    UINT16 sequenceNumber;
+    BOOL discarded = FALSE;
+
+    CHK(pTransceiver != NULL, STATUS_NULL_ARG);
+
+    // Pushed as if they had just been received, the NACK generator stops asking for them
+    CHK_STATUS(fecDecoderPopRecoveredPacket(pTransceiver->pFecDecoder, &pRtpPacket));
+    while (pRtpPacket != NULL) {
+        pRtpPacket->receivedTime = now;
+        sequenceNumber = pRtpPacket->header.sequenceNumber;
+        CHK_STATUS(jitterBufferPush(pTransceiver->pJitterBuffer, pRtpPacket, &discarded));
+        // The jitter buffer can free the packet
+        pRtpPacket = NULL;
+        if (!discarded && pTransceiver->pNackGenerator != NULL) {
+            CHK_STATUS(nackGeneratorOnPacket(pTransceiver->pNackGenerator, sequenceNumber, now));
+        }
+        CHK_STATUS(fecDecoderPopRecoveredPacket(pTransceiver->pFecDecoder, &pRtpPacket));
+    }
+
+CleanUp:
+    if (pRtpPacket != NULL) {
+        freeRtpPacket(&pRtpPacket);
+    }
+
+    return retStatus;
+}
+
 STATUS changePeerConnectionState(PKvsPeerConnection pKvsPeerConnection, RTC_PEER_CONNECTION_STATE newState)
 {
     ENTERS();
@@ -378,21 +498,15 @@ STATUS onFrameReadyFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex, U
     STATUS retStatus = STATUS_SUCCESS;
     PKvsRtpTransceiver pTransceiver = (PKvsRtpTransceiver) customData;
     PRtpPacket pPacket = NULL;
+    PKvsFrameSlices pKvsFrameSlices = NULL;
     Frame frame;
-    UINT64 hashValue;
     UINT32 filledSize = 0, index;
+    UINT64 decodingTs;
 
     CHK(pTransceiver != NULL, STATUS_NULL_ARG);
 
     // TODO: handle multi-packet frames
-    retStatus = hashTableGet(pTransceiver->pJitterBuffer->pPkgBufferHashTable, startIndex, &hashValue);
-    pPacket = (PRtpPacket) hashValue;
-    if (retStatus == STATUS_SUCCESS || retStatus == STATUS_HASH_KEY_NOT_PRESENT) {
-        retStatus = STATUS_SUCCESS;
-    } else {
-        CHK(FALSE, retStatus);
-    }
-    CHK(pPacket != NULL, STATUS_NULL_ARG);
+    CHK_STATUS(jitterBufferGetPacket(pTransceiver->pJitterBuffer, startIndex, &pPacket));
     MUTEX_LOCK(pTransceiver->statsLock);
     // https://www.w3.org/TR/webrtc-stats/#dom-rtcinboundrtpstreamstats-jitterbufferdelay
     pTransceiver->inboundStats.jitterBufferDelay += (DOUBLE) (GETTIME() - pPacket->receivedTime) / HUNDREDS_OF_NANOS_IN_A_SECOND;
@@ -402,29 +516,42 @@ STATUS onFrameReadyFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex, U
         pTransceiver->inboundStats.framesReceived++;
     }
     MUTEX_UNLOCK(pTransceiver->statsLock);
+    decodingTs = pPacket->header.timestamp * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
 
-    if (frameSize > pTransceiver->peerFrameBufferSize) {
-        MEMFREE(pTransceiver->peerFrameBuffer);
-        pTransceiver->peerFrameBufferSize = (UINT32) (frameSize * PEER_FRAME_BUFFER_SIZE_INCREMENT_FACTOR);
-        pTransceiver->peerFrameBuffer = (PBYTE) MEMALLOC(pTransceiver->peerFrameBufferSize);
-        CHK(pTransceiver->peerFrameBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
-    }
-
-    CHK_STATUS(jitterBufferFillFrameData(pTransceiver->pJitterBuffer, pTransceiver->peerFrameBuffer, frameSize, &filledSize, startIndex, endIndex));
-    CHK(frameSize == filledSize, STATUS_INVALID_ARG_LEN);
-
-    frame.version = FRAME_CURRENT_VERSION;
-    frame.decodingTs = pPacket->header.timestamp * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
-    frame.presentationTs = frame.decodingTs;
-    frame.frameData = pTransceiver->peerFrameBuffer;
-    frame.size = frameSize;
-    frame.duration = 0;
-    frame.index = index;
-    // TODO: Fill frame flag and track id and index if we need to, currently those are not used by RtcRtpTransceiver
+    // The frame is only reassembled into a single buffer for onFrame
     if (pTransceiver->onFrame != NULL) {
+        if (frameSize > pTransceiver->peerFrameBufferSize) {
+            MEMFREE(pTransceiver->peerFrameBuffer);
+            pTransceiver->peerFrameBufferSize = (UINT32) (frameSize * PEER_FRAME_BUFFER_SIZE_INCREMENT_FACTOR);
+            pTransceiver->peerFrameBuffer = (PBYTE) MEMALLOC(pTransceiver->peerFrameBufferSize);
+            CHK(pTransceiver->peerFrameBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        }
+
+        CHK_STATUS(
+            jitterBufferFillFrameData(pTransceiver->pJitterBuffer, pTransceiver->peerFrameBuffer, frameSize, &filledSize, startIndex, endIndex));
+        CHK(frameSize == filledSize, STATUS_INVALID_ARG_LEN);
+
+        frame.version = FRAME_CURRENT_VERSION;
+        frame.decodingTs = decodingTs;
+        frame.presentationTs = frame.decodingTs;
+        frame.frameData = pTransceiver->peerFrameBuffer;
+        frame.size = frameSize;
+        frame.duration = 0;
+        frame.index = index;
+        // TODO: Fill frame flag and track id and index if we need to, currently those are not used by RtcRtpTransceiver
         pTransceiver->onFrame(pTransceiver->onFrameCustomData, &frame);
     }
 
+    // Takes the packets out of the jitter buffer, so it has to come after the copy
+    if (pTransceiver->onFrameSlices != NULL) {
+        CHK_STATUS(createKvsFrameSlices(pTransceiver->pJitterBuffer, pTransceiver->depaySlicesFn, startIndex, endIndex, &pKvsFrameSlices));
+        pKvsFrameSlices->frameSlices.index = index;
+        pKvsFrameSlices->frameSlices.decodingTs = decodingTs;
+        pKvsFrameSlices->frameSlices.presentationTs = decodingTs;
+        // The application releases the frame
+        pTransceiver->onFrameSlices(pTransceiver->onFrameSlicesCustomData, &pKvsFrameSlices->frameSlices);
+    }
+
 CleanUp:
     CHK_LOG_ERR(retStatus);
 
@@ -435,21 +562,12 @@ CleanUp:
 STATUS onFrameDroppedFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 timestamp)
 {
     ENTERS();
-    UNUSED_PARAM(endIndex);
     STATUS retStatus = STATUS_SUCCESS;
-    UINT64 hashValue = 0;
     PRtpPacket pPacket = NULL;
     PKvsRtpTransceiver pTransceiver = (PKvsRtpTransceiver) customData;
     DLOGW("Frame with timestamp %ld is dropped!", timestamp);
     CHK(pTransceiver != NULL, STATUS_NULL_ARG);
-    retStatus = hashTableGet(pTransceiver->pJitterBuffer->pPkgBufferHashTable, startIndex, &hashValue);
-    pPacket = (PRtpPacket) hashValue;
-    if (retStatus == STATUS_SUCCESS || retStatus == STATUS_HASH_KEY_NOT_PRESENT) {
-        retStatus = STATUS_SUCCESS;
-    } else {
-        CHK(FALSE, retStatus);
-    }
-    CHK(pPacket != NULL, STATUS_NULL_ARG);
+    CHK_STATUS(jitterBufferGetPacket(pTransceiver->pJitterBuffer, startIndex, &pPacket));
     MUTEX_LOCK(pTransceiver->statsLock);
     // https://www.w3.org/TR/webrtc-stats/#dom-rtcinboundrtpstreamstats-jitterbufferdelay
     pTransceiver->inboundStats.jitterBufferDelay += (DOUBLE) (GETTIME() - pPacket->receivedTime) / HUNDREDS_OF_NANOS_IN_A_SECOND;
@@ -458,6 +576,11 @@ STATUS onFrameDroppedFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex,
     pTransceiver->inboundStats.received.fullFramesLost++;
     MUTEX_UNLOCK(pTransceiver->statsLock);
 
+    // Too late for retransmissions of this frame
+    if (pTransceiver->pNackGenerator != NULL) {
+        CHK_STATUS(nackGeneratorDropUntil(pTransceiver->pNackGenerator, endIndex));
+    }
+
 CleanUp:
     CHK_LOG_ERR(retStatus);
 
@@ -586,6 +709,22 @@ CleanUp:
     LEAVES();
 }
 
+VOID onIceEgressStateChange(UINT64 customData, BOOL backpressured)
+{
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+    RtcOnBackpressure onBackpressure;
+
+    if (pKvsPeerConnection == NULL) {
+        return;
+    }
+
+    // The sender may hold the SRTP session lock, the object lock is not taken
+    onBackpressure = pKvsPeerConnection->onBackpressure;
+    if (onBackpressure != NULL) {
+        onBackpressure(pKvsPeerConnection->onBackpressureCustomData, backpressured);
+    }
+}
+
 VOID onSctpSessionOutboundPacket(UINT64 customData, PBYTE pPacket, UINT32 packetLen)
 {
     ENTERS();
@@ -780,9 +919,9 @@ STATUS rtcpReportsCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData
     delay = 100 + (RAND() % 200);
     DLOGS("next sender report %u in %" PRIu64 " msec", ssrc, delay);
     // reschedule timer with 200msec +- 100ms
-    CHK_STATUS(timerQueueAddTimer(pKvsPeerConnection->timerQueueHandle, delay * HUNDREDS_OF_NANOS_IN_A_MILLISECOND,
-                                  TIMER_QUEUE_SINGLE_INVOCATION_PERIOD, rtcpReportsCallback, (UINT64) pKvsRtpTransceiver,
-                                  &pKvsRtpTransceiver->rtcpReportsTimerId));
+    CHK_STATUS(sharedTimerQueueAddTimer(pKvsPeerConnection->timerQueueHandle, delay * HUNDREDS_OF_NANOS_IN_A_MILLISECOND,
+                                        TIMER_QUEUE_SINGLE_INVOCATION_PERIOD, rtcpReportsCallback, (UINT64) pKvsRtpTransceiver,
+                                        &pKvsRtpTransceiver->rtcpReportsTimerId));
 
 CleanUp:
     CHK_LOG_ERR(retStatus);
@@ -792,6 +931,102 @@ CleanUp:
     return retStatus;
 }
 
+STATUS sendRtcpLossFeedback(UINT64 customData, PUINT16 pSequenceNumbers, UINT32 sequenceNumberCount, BOOL sendPli)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) customData;
+    PKvsPeerConnection pKvsPeerConnection = NULL;
+    PBYTE rawPacket = NULL;
+    UINT32 nackLen = 0, pliLen = 0, allocSize;
+    INT32 packetLen;
+    BOOL locked = FALSE;
+
+    CHK(pKvsRtpTransceiver != NULL && pKvsRtpTransceiver->pKvsPeerConnection != NULL, STATUS_NULL_ARG);
+    pKvsPeerConnection = pKvsRtpTransceiver->pKvsPeerConnection;
+    // Nothing to request before the remote stream is known or while DTLS is not done
+    CHK(pKvsRtpTransceiver->jitterBufferSsrc != 0 && pKvsPeerConnection->pSrtpSession != NULL, retStatus);
+
+    if (sequenceNumberCount > 0) {
+        CHK_STATUS(createRtcpNackPacket(pSequenceNumbers, sequenceNumberCount, pKvsRtpTransceiver->sender.ssrc, pKvsRtpTransceiver->jitterBufferSsrc,
+                                        NULL, &nackLen));
+    }
+    if (sendPli) {
+        CHK_STATUS(createRtcpPliPacket(pKvsRtpTransceiver->sender.ssrc, pKvsRtpTransceiver->jitterBufferSsrc, NULL, &pliLen));
+    }
+
+    // Same trailer room as the sender reports, see rtcpReportsCallback
+    allocSize = nackLen + pliLen + SRTP_AUTH_TAG_OVERHEAD + SRTP_MAX_TRAILER_LEN + 4;
+    CHK(NULL != (rawPacket = (PBYTE) MEMALLOC(allocSize)), STATUS_NOT_ENOUGH_MEMORY);
+    if (nackLen > 0) {
+        CHK_STATUS(createRtcpNackPacket(pSequenceNumbers, sequenceNumberCount, pKvsRtpTransceiver->sender.ssrc, pKvsRtpTransceiver->jitterBufferSsrc,
+                                        rawPacket, &nackLen));
+    }
+    if (pliLen > 0) {
+        CHK_STATUS(createRtcpPliPacket(pKvsRtpTransceiver->sender.ssrc, pKvsRtpTransceiver->jitterBufferSsrc, rawPacket + nackLen, &pliLen));
+    }
+    packetLen = (INT32) (nackLen + pliLen);
+
+    MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+    locked = TRUE;
+    CHK_STATUS(encryptRtcpPacket(pKvsPeerConnection->pSrtpSession, rawPacket, &packetLen));
+    MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+    locked = FALSE;
+
+    CHK_STATUS(iceAgentSendPacket(pKvsPeerConnection->pIceAgent, rawPacket, packetLen));
+
+    MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
+    if (nackLen > 0) {
+        pKvsRtpTransceiver->inboundStats.nackCount++;
+    }
+    if (pliLen > 0) {
+        pKvsRtpTransceiver->inboundStats.pliCount++;
+    }
+    MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+    }
+    CHK_LOG_ERR(retStatus);
+    SAFE_MEMFREE(rawPacket);
+
+    return retStatus;
+}
+
+STATUS sendRtcpTwccFeedback(UINT64 customData, PBYTE pPacket, UINT32 packetLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+    PBYTE rawPacket = NULL;
+    INT32 encryptedLen = (INT32) packetLen;
+    BOOL locked = FALSE;
+
+    CHK(pKvsPeerConnection != NULL && pPacket != NULL, STATUS_NULL_ARG);
+    // Packets can come in before DTLS is done, they are not reported
+    CHK(pKvsPeerConnection->pSrtpSession != NULL, retStatus);
+
+    // Same trailer room as the sender reports, see rtcpReportsCallback
+    CHK(NULL != (rawPacket = (PBYTE) MEMALLOC(packetLen + SRTP_AUTH_TAG_OVERHEAD + SRTP_MAX_TRAILER_LEN + 4)), STATUS_NOT_ENOUGH_MEMORY);
+    MEMCPY(rawPacket, pPacket, packetLen);
+
+    MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+    locked = TRUE;
+    CHK_STATUS(encryptRtcpPacket(pKvsPeerConnection->pSrtpSession, rawPacket, &encryptedLen));
+    MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+    locked = FALSE;
+
+    CHK_STATUS(iceAgentSendPacket(pKvsPeerConnection->pIceAgent, rawPacket, encryptedLen));
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+    }
+    CHK_LOG_ERR(retStatus);
+    SAFE_MEMFREE(rawPacket);
+
+    return retStatus;
+}
+
 // Not thread safe
 STATUS getStunAddr(PStunIpAddrContext pStunIpAddrCtx)
 {
@@ -1005,7 +1240,7 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
     pKvsPeerConnection = (PKvsPeerConnection) MEMCALLOC(1, SIZEOF(KvsPeerConnection));
     CHK(pKvsPeerConnection != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
-    CHK_STATUS(timerQueueCreate(&pKvsPeerConnection->timerQueueHandle));
+    CHK_STATUS(sharedTimerQueueCreate(&pKvsPeerConnection->timerQueueHandle));
 
     pKvsPeerConnection->peerConnection.version = PEER_CONNECTION_CURRENT_VERSION;
 
@@ -1024,6 +1259,7 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
     CHK_STATUS(hashTableCreateWithParams(CODEC_HASH_TABLE_BUCKET_COUNT, CODEC_HASH_TABLE_BUCKET_LENGTH, &pKvsPeerConnection->pDataChannels));
     CHK_STATUS(hashTableCreateWithParams(RTX_HASH_TABLE_BUCKET_COUNT, RTX_HASH_TABLE_BUCKET_LENGTH, &pKvsPeerConnection->pRtxTable));
     CHK_STATUS(doubleListCreate(&(pKvsPeerConnection->pTransceivers)));
+    CHK_STATUS(createSsrcTable(&pKvsPeerConnection->pSsrcTable));
     CHK_STATUS(doubleListCreate(&(pKvsPeerConnection->pFakeTransceivers)));
     CHK_STATUS(doubleListCreate(&(pKvsPeerConnection->pAnswerTransceivers)));
 
@@ -1040,8 +1276,19 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
     iceAgentCallbacks.connectionStateChangedFn = onIceConnectionStateChange;
     iceAgentCallbacks.newLocalCandidateFn = onNewIceLocalCandidate;
     iceAgentCallbacks.setStunServerIpFn = onSetStunServerIp;
+    iceAgentCallbacks.egressStateChangedFn = onIceEgressStateChange;
 
-    PROFILE_CALL(CHK_STATUS(createConnectionListener(&pConnectionListener)), "Create connection listener");
+    if (pConfiguration->kvsRtcConfiguration.useSharedNetworkReactor &&
+        STATUS_FAILED(createSharedConnectionListener(&pConnectionListener))) {
+        DLOGW("Shared network reactor is not available, falling back to a dedicated connection listener");
+    }
+    if (pConnectionListener == NULL) {
+        PROFILE_CALL(CHK_STATUS(createConnectionListener(&pConnectionListener)), "Create connection listener");
+    }
+    if (pConfiguration->kvsRtcConfiguration.useReceiveWorkerPool &&
+        STATUS_FAILED(createReceiveQueue(onInboundSrtpPacket, (UINT64) pKvsPeerConnection, &pKvsPeerConnection->pReceiveQueue))) {
+        DLOGW("Receive worker pool is not available, inbound media is processed on the connection listener thread");
+    }
     // IceAgent will own the lifecycle of pConnectionListener;
     PROFILE_CALL(CHK_STATUS(createIceAgent(pKvsPeerConnection->localIceUfrag, pKvsPeerConnection->localIcePwd, &iceAgentCallbacks, pConfiguration,
                                            pKvsPeerConnection->timerQueueHandle, pConnectionListener, &pKvsPeerConnection->pIceAgent)),
@@ -1057,6 +1304,40 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
                                              &pKvsPeerConnection->pTwccManager->pTwccRtpPktInfosHashTable));
     }
 
+    pKvsPeerConnection->nackGenerationEnabled = !pConfiguration->kvsRtcConfiguration.disableNackGeneration;
+    pKvsPeerConnection->nackMaxRetries = pConfiguration->kvsRtcConfiguration.nackMaxRetries;
+    pKvsPeerConnection->nackPliLossBudget = pConfiguration->kvsRtcConfiguration.nackPliLossBudget;
+
+    CHK(pConfiguration->kvsRtcConfiguration.fecGroupSize <= FEC_MAX_GROUP_SIZE &&
+            pConfiguration->kvsRtcConfiguration.fecMaxProtectionPercent <= 100,
+        STATUS_INVALID_ARG);
+    pKvsPeerConnection->fecEnabled = pConfiguration->kvsRtcConfiguration.enableForwardErrorCorrection;
+    pKvsPeerConnection->fecGroupSize = pConfiguration->kvsRtcConfiguration.fecGroupSize;
+    pKvsPeerConnection->fecMaxProtectionPercent = pConfiguration->kvsRtcConfiguration.fecMaxProtectionPercent;
+
+    if (!pConfiguration->kvsRtcConfiguration.disableTwccFeedbackGeneration) {
+        // Nothing is recorded unless the remote peer negotiates the header extension
+        CHK_STATUS(createTwccFeedbackGenerator(pKvsPeerConnection->timerQueueHandle, (UINT32) RAND(), sendRtcpTwccFeedback,
+                                               (UINT64) pKvsPeerConnection, &pKvsPeerConnection->pTwccFeedbackGenerator));
+    }
+
+    if (pConfiguration->kvsRtcConfiguration.enablePacer) {
+        CHK_STATUS(createPacer(pKvsPeerConnection->timerQueueHandle, pConfiguration->kvsRtcConfiguration.pacerTargetBitrate, sendPacedPackets,
+                               (UINT64) pKvsPeerConnection, &pKvsPeerConnection->pPacer));
+    }
+
+    if (pConfiguration->kvsRtcConfiguration.useEgressBandwidthManager &&
+        STATUS_FAILED(egressBandwidthManagerAddPeer(getEgressBandwidthManagerInstance(), &pKvsPeerConnection->egressBandwidthPeer,
+                                                    onEgressBandwidthAllocation, (UINT64) pKvsPeerConnection))) {
+        DLOGW("Egress bandwidth manager is not available, the estimates only drive this PeerConnection");
+    }
+
+    if (pKvsPeerConnection->pTwccManager != NULL) {
+        // Start from what the pacer already paces at so that the first estimate does not yank it around
+        CHK_STATUS(createCongestionController(pKvsPeerConnection->pPacer != NULL ? pKvsPeerConnection->pPacer->targetBitrate : 0,
+                                              &pKvsPeerConnection->pCongestionController));
+    }
+
     *ppPeerConnection = (PRtcPeerConnection) pKvsPeerConnection;
 
 CleanUp:
@@ -1111,7 +1392,7 @@ STATUS freePeerConnection(PRtcPeerConnection* ppPeerConnection)
 
     // free timer queue first to remove liveness provided by timer
     if (IS_VALID_TIMER_QUEUE_HANDLE(pKvsPeerConnection->timerQueueHandle)) {
-        timerQueueShutdown(pKvsPeerConnection->timerQueueHandle);
+        sharedTimerQueueShutdown(pKvsPeerConnection->timerQueueHandle);
     }
 
     /* Free structs that have their own thread. SCTP has threads created by SCTP library. IceAgent has the
@@ -1120,6 +1401,16 @@ STATUS freePeerConnection(PRtcPeerConnection* ppPeerConnection)
     CHK_LOG_ERR(freeSctpSession(&pKvsPeerConnection->pSctpSession));
 #endif
 
+    // The listener no longer pushes, wait for the worker to be done with the PeerConnection
+    CHK_LOG_ERR(freeReceiveQueue(&pKvsPeerConnection->pReceiveQueue));
+
+    // The other PeerConnections reallocating no longer reach the pacer nor the transceivers
+    CHK_LOG_ERR(egressBandwidthManagerRemovePeer(&pKvsPeerConnection->egressBandwidthPeer));
+
+    // Queued packets point at the transceivers
+    CHK_LOG_ERR(freePacer(&pKvsPeerConnection->pPacer));
+    CHK_LOG_ERR(freeTwccFeedbackGenerator(&pKvsPeerConnection->pTwccFeedbackGenerator));
+
     // free transceivers
     CHK_LOG_ERR(doubleListGetHeadNode(pKvsPeerConnection->pTransceivers, &pCurNode));
     while (pCurNode != NULL) {
@@ -1148,6 +1439,7 @@ STATUS freePeerConnection(PRtcPeerConnection* ppPeerConnection)
     // it is safer to free the ICE agent after DTLS session
     CHK_LOG_ERR(freeIceAgent(&pKvsPeerConnection->pIceAgent));
     CHK_LOG_ERR(doubleListFree(pKvsPeerConnection->pTransceivers));
+    CHK_LOG_ERR(freeSsrcTable(&pKvsPeerConnection->pSsrcTable));
     CHK_LOG_ERR(doubleListFree(pKvsPeerConnection->pFakeTransceivers));
     CHK_LOG_ERR(doubleListFree(pKvsPeerConnection->pAnswerTransceivers));
     CHK_LOG_ERR(hashTableFree(pKvsPeerConnection->pCodecTable));
@@ -1161,7 +1453,7 @@ STATUS freePeerConnection(PRtcPeerConnection* ppPeerConnection)
     }
 
     if (IS_VALID_TIMER_QUEUE_HANDLE(pKvsPeerConnection->timerQueueHandle)) {
-        timerQueueFree(&pKvsPeerConnection->timerQueueHandle);
+        sharedTimerQueueFree(&pKvsPeerConnection->timerQueueHandle);
     }
 
     if (pKvsPeerConnection->pTwccManager != NULL) {
@@ -1178,6 +1470,8 @@ STATUS freePeerConnection(PRtcPeerConnection* ppPeerConnection)
         SAFE_MEMFREE(pKvsPeerConnection->pTwccManager);
     }
 
+    CHK_LOG_ERR(freeCongestionController(&pKvsPeerConnection->pCongestionController));
+
     // Incase the `RemoteSessionDescription` has not already been freed.
     SAFE_MEMFREE(pKvsPeerConnection->pRemoteSessionDescription);
 
@@ -1301,6 +1595,75 @@ CleanUp:
     return retStatus;
 }
 
+STATUS peerConnectionOnTargetBitrate(PRtcPeerConnection pRtcPeerConnection, UINT64 customData, RtcOnTargetBitrate rtcOnTargetBitrate)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    BOOL locked = FALSE;
+
+    CHK(pKvsPeerConnection != NULL && rtcOnTargetBitrate != NULL, STATUS_NULL_ARG);
+    CHK(pKvsPeerConnection->pCongestionController != NULL, STATUS_INVALID_OPERATION);
+
+    MUTEX_LOCK(pKvsPeerConnection->peerConnectionObjLock);
+    locked = TRUE;
+
+    pKvsPeerConnection->onTargetBitrate = rtcOnTargetBitrate;
+    pKvsPeerConnection->onTargetBitrateCustomData = customData;
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->peerConnectionObjLock);
+    }
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS peerConnectionOnBackpressure(PRtcPeerConnection pRtcPeerConnection, UINT64 customData, RtcOnBackpressure rtcOnBackpressure)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    BOOL locked = FALSE;
+
+    CHK(pKvsPeerConnection != NULL && rtcOnBackpressure != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pKvsPeerConnection->peerConnectionObjLock);
+    locked = TRUE;
+
+    pKvsPeerConnection->onBackpressureCustomData = customData;
+    pKvsPeerConnection->onBackpressure = rtcOnBackpressure;
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->peerConnectionObjLock);
+    }
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS peerConnectionSetPacerTargetBitrate(PRtcPeerConnection pRtcPeerConnection, UINT64 targetBitrate)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+
+    CHK(pKvsPeerConnection != NULL, STATUS_NULL_ARG);
+    CHK(pKvsPeerConnection->pPacer != NULL, STATUS_INVALID_OPERATION);
+
+    CHK_STATUS(pacerSetTargetBitrate(pKvsPeerConnection->pPacer, targetBitrate));
+
+CleanUp:
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS peerConnectionGetLocalDescription(PRtcPeerConnection pRtcPeerConnection, PRtcSessionDescriptionInit pRtcSessionDescriptionInit)
 {
     ENTERS();
@@ -1483,7 +1846,11 @@ STATUS setRemoteDescription(PRtcPeerConnection pPeerConnection, PRtcSessionDescr
         CHK_STATUS(setPayloadTypesFromOffer(pKvsPeerConnection->pCodecTable, pKvsPeerConnection->pRtxTable, pSessionDescription));
     }
     CHK_STATUS(setTransceiverPayloadTypes(pKvsPeerConnection->pCodecTable, pKvsPeerConnection->pRtxTable, pKvsPeerConnection->pTransceivers));
-    CHK_STATUS(setReceiversSsrc(pSessionDescription, pKvsPeerConnection->pTransceivers));
+    if (pKvsPeerConnection->fecEnabled) {
+        CHK_STATUS(setFecPayloadTypes(pSessionDescription, &pKvsPeerConnection->redPayloadType, &pKvsPeerConnection->ulpfecPayloadType));
+    }
+    CHK_STATUS(setRtxAptPayloadTypes(pSessionDescription, pKvsPeerConnection->rtxAptPayloadTypes));
+    CHK_STATUS(setReceiversSsrc(pSessionDescription, pKvsPeerConnection->pTransceivers, pKvsPeerConnection->pSsrcTable));
 
     if (NULL != GETENV(DEBUG_LOG_SDP)) {
         DLOGD("REMOTE_SDP:%s\n", pSessionDescriptionInit->sdp);
@@ -1610,6 +1977,7 @@ STATUS addTransceiver(PRtcPeerConnection pPeerConnection, PRtcMediaStreamTrack p
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pPeerConnection;
     PJitterBuffer pJitterBuffer = NULL;
     DepayRtpPayloadFunc depayFunc;
+    DepayRtpPayloadSlicesFunc depaySlicesFunc;
     UINT32 clockRate = 0;
     UINT32 ssrc = (UINT32) RAND(), rtxSsrc = (UINT32) RAND();
     RTC_RTP_TRANSCEIVER_DIRECTION direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV;
@@ -1640,26 +2008,31 @@ STATUS addTransceiver(PRtcPeerConnection pPeerConnection, PRtcMediaStreamTrack p
     switch (pRtcMediaStreamTrack->codec) {
         case RTC_CODEC_OPUS:
             depayFunc = depayOpusFromRtpPayload;
+            depaySlicesFunc = depayOpusSlicesFromRtpPayload;
             clockRate = OPUS_CLOCKRATE;
             break;
 
         case RTC_CODEC_MULAW:
         case RTC_CODEC_ALAW:
             depayFunc = depayG711FromRtpPayload;
+            depaySlicesFunc = depayG711SlicesFromRtpPayload;
             clockRate = PCM_CLOCKRATE;
             break;
 
         case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
             depayFunc = depayH264FromRtpPayload;
+            depaySlicesFunc = depayH264SlicesFromRtpPayload;
             clockRate = VIDEO_CLOCKRATE;
             break;
 
         case RTC_CODEC_VP8:
             depayFunc = depayVP8FromRtpPayload;
+            depaySlicesFunc = depayVP8SlicesFromRtpPayload;
             clockRate = VIDEO_CLOCKRATE;
             break;
         case RTC_CODEC_H265:
             depayFunc = depayH265FromRtpPayload;
+            depaySlicesFunc = depayH265SlicesFromRtpPayload;
             clockRate = VIDEO_CLOCKRATE;
             break;
 
@@ -1672,6 +2045,7 @@ STATUS addTransceiver(PRtcPeerConnection pPeerConnection, PRtcMediaStreamTrack p
     // TODO: Add ssrc duplicate detection here not only relying on RAND()
     CHK_STATUS(createKvsRtpTransceiver(direction, pKvsPeerConnection, ssrc, rtxSsrc, pRtcMediaStreamTrack, NULL, pRtcMediaStreamTrack->codec,
                                        &pKvsRtpTransceiver));
+    pKvsRtpTransceiver->depaySlicesFn = depaySlicesFunc;
     CHK_STATUS(createJitterBuffer(onFrameReadyFunc, onFrameDroppedFunc, depayFunc, DEFAULT_JITTER_BUFFER_MAX_LATENCY, clockRate,
                                   (UINT64) pKvsRtpTransceiver, &pJitterBuffer));
     CHK_STATUS(kvsRtpTransceiverSetJitterBuffer(pKvsRtpTransceiver, pJitterBuffer));
@@ -1679,11 +2053,31 @@ STATUS addTransceiver(PRtcPeerConnection pPeerConnection, PRtcMediaStreamTrack p
     // after pKvsRtpTransceiver is successfully created, jitterBuffer will be freed by pKvsRtpTransceiver.
     pJitterBuffer = NULL;
 
+    if (pKvsPeerConnection->nackGenerationEnabled && pRtcMediaStreamTrack->kind == MEDIA_STREAM_TRACK_KIND_VIDEO &&
+        direction != RTC_RTP_TRANSCEIVER_DIRECTION_SENDONLY) {
+        CHK_STATUS(createNackGenerator(pKvsPeerConnection->timerQueueHandle, pKvsPeerConnection->nackMaxRetries,
+                                       pKvsPeerConnection->nackPliLossBudget, sendRtcpLossFeedback, (UINT64) pKvsRtpTransceiver,
+                                       &pKvsRtpTransceiver->pNackGenerator));
+    }
+
+    // Idle until the remote description negotiates the payload types
+    if (pKvsPeerConnection->fecEnabled && pRtcMediaStreamTrack->kind == MEDIA_STREAM_TRACK_KIND_VIDEO) {
+        if (direction == RTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV || direction == RTC_RTP_TRANSCEIVER_DIRECTION_SENDONLY) {
+            CHK_STATUS(createFecEncoder(pKvsPeerConnection->fecGroupSize, pKvsPeerConnection->fecMaxProtectionPercent,
+                                        &pKvsRtpTransceiver->sender.pFecEncoder));
+        }
+        if (direction != RTC_RTP_TRANSCEIVER_DIRECTION_SENDONLY) {
+            CHK_STATUS(createFecDecoder(&pKvsRtpTransceiver->pFecDecoder));
+        }
+    }
+
     CHK_STATUS(doubleListInsertItemHead(pKvsPeerConnection->pTransceivers, (UINT64) pKvsRtpTransceiver));
+    CHK_STATUS(ssrcTablePut(pKvsPeerConnection->pSsrcTable, pKvsRtpTransceiver->sender.ssrc, SSRC_TABLE_KIND_SENDER, (UINT64) pKvsRtpTransceiver));
+    CHK_STATUS(ssrcTablePut(pKvsPeerConnection->pSsrcTable, pKvsRtpTransceiver->sender.rtxSsrc, SSRC_TABLE_KIND_RTX, (UINT64) pKvsRtpTransceiver));
     *ppRtcRtpTransceiver = (PRtcRtpTransceiver) pKvsRtpTransceiver;
 
-    CHK_STATUS(timerQueueAddTimer(pKvsPeerConnection->timerQueueHandle, RTCP_FIRST_REPORT_DELAY, TIMER_QUEUE_SINGLE_INVOCATION_PERIOD,
-                                  rtcpReportsCallback, (UINT64) pKvsRtpTransceiver, &pKvsRtpTransceiver->rtcpReportsTimerId));
+    CHK_STATUS(sharedTimerQueueAddTimer(pKvsPeerConnection->timerQueueHandle, RTCP_FIRST_REPORT_DELAY, TIMER_QUEUE_SINGLE_INVOCATION_PERIOD,
+                                        rtcpReportsCallback, (UINT64) pKvsRtpTransceiver, &pKvsRtpTransceiver->rtcpReportsTimerId));
 
     pKvsRtpTransceiver = NULL;
 
@@ -1812,11 +2206,17 @@ STATUS initKvsWebRtc(VOID)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
+    BOOL srtpInitialized = FALSE, reactorPoolCreated = FALSE, timerWheelCreated = FALSE, certificatePoolCreated = FALSE,
+         receiveWorkerPoolCreated = FALSE, bandwidthManagerCreated = FALSE;
+#ifdef ENABLE_DATA_CHANNEL
+    BOOL sctpInitialized = FALSE;
+#endif
     CHK(!ATOMIC_LOAD_BOOL(&gKvsWebRtcInitialized), retStatus);
     DLOGI("Initializing WebRTC library...");
     SRAND(GETTIME());
 
     CHK(srtp_init() == srtp_err_status_ok, STATUS_SRTP_INIT_FAILED);
+    srtpInitialized = TRUE;
 
     // init endianness handling
     initializeEndianness();
@@ -1827,7 +2227,22 @@ STATUS initKvsWebRtc(VOID)
     SET_INSTRUMENTED_ALLOCATORS();
 #ifdef ENABLE_DATA_CHANNEL
     CHK_STATUS(initSctpSession());
+    sctpInitialized = TRUE;
 #endif
+    // Reactor threads are only started once a PeerConnection opts in with useSharedNetworkReactor
+    CHK_STATUS(createNetworkReactorPool());
+    reactorPoolCreated = TRUE;
+    // Timer wheel threads are started by the first PeerConnection
+    CHK_STATUS(createTimerWheelService());
+    timerWheelCreated = TRUE;
+    // Certificates for the DTLS sessions are generated in the background ahead of the PeerConnections
+    CHK_STATUS(createCertificatePool());
+    certificatePoolCreated = TRUE;
+    // Receive worker threads are only started once a PeerConnection opts in with useReceiveWorkerPool
+    CHK_STATUS(createReceiveWorkerPool());
+    receiveWorkerPoolCreated = TRUE;
+    CHK_STATUS(createEgressBandwidthManager());
+    bandwidthManagerCreated = TRUE;
 #ifdef ENABLE_KVS_THREADPOOL
     DLOGI("KVS WebRtc library using thread pool");
     CHK_STATUS(createWebRtcClientInstance());
@@ -1841,6 +2256,33 @@ STATUS initKvsWebRtc(VOID)
 CleanUp:
     CHK_LOG_ERR(retStatus);
 
+    // The singletons refuse to be created twice, so a failed init is rolled back for the next attempt
+    if (STATUS_FAILED(retStatus)) {
+        if (bandwidthManagerCreated) {
+            freeEgressBandwidthManager();
+        }
+        if (receiveWorkerPoolCreated) {
+            freeReceiveWorkerPool();
+        }
+        if (certificatePoolCreated) {
+            freeCertificatePool();
+        }
+        if (timerWheelCreated) {
+            freeTimerWheelService();
+        }
+        if (reactorPoolCreated) {
+            freeNetworkReactorPool();
+        }
+#ifdef ENABLE_DATA_CHANNEL
+        if (sctpInitialized) {
+            deinitSctpSession();
+        }
+#endif
+        if (srtpInitialized) {
+            srtp_shutdown();
+        }
+    }
+
     LEAVES();
     return retStatus;
 }
@@ -1901,6 +2343,12 @@ STATUS deinitKvsWebRtc(VOID)
     deinitSctpSession();
 #endif
 
+    freeNetworkReactorPool();
+    freeTimerWheelService();
+    freeCertificatePool();
+    freeReceiveWorkerPool();
+    freeEgressBandwidthManager();
+
     srtp_shutdown();
 
 #ifdef ENABLE_KVS_THREADPOOL
@@ -1917,6 +2365,21 @@ CleanUp:
     return retStatus;
 }
 
+STATUS setEgressBandwidthCap(UINT64 capBitrate)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(ATOMIC_LOAD_BOOL(&gKvsWebRtcInitialized), STATUS_INVALID_OPERATION);
+    CHK_STATUS(egressBandwidthManagerSetCap(getEgressBandwidthManagerInstance(), capBitrate));
+
+CleanUp:
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
 // Not thread safe. Ensure this function is invoked in a guarded section
 static STATUS twccRollingWindowDeletion(PKvsPeerConnection pKvsPeerConnection, PRtpPacket pRtpPacket, UINT16 endingSeqNum)
 {
@@ -1985,7 +2448,7 @@ STATUS twccManagerOnPacketSent(PKvsPeerConnection pKvsPeerConnection, PRtpPacket
     PTwccRtpPacketInfo pTwccRtpPktInfo = NULL;
 
     CHK(pKvsPeerConnection != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
-    CHK(pKvsPeerConnection->onSenderBandwidthEstimation != NULL && pKvsPeerConnection->pTwccManager != NULL, STATUS_SUCCESS);
+    CHK(IS_TWCC_FEEDBACK_NEEDED(pKvsPeerConnection), STATUS_SUCCESS);
     CHK(TWCC_EXT_PROFILE == pRtpPacket->header.extensionProfile, STATUS_SUCCESS);
 
     MUTEX_LOCK(pKvsPeerConnection->twccLock);
@@ -2039,6 +2502,11 @@ STATUS peerConnectionGetMetrics(PRtcPeerConnection pPeerConnection, PPeerConnect
     // Cannot record these 2 in here because peer connection object would become NULL after clearing. Need another strategy
     pPeerConnectionMetrics->peerConnectionStats.closePeerConnectionTime = pKvsPeerConnection->peerConnectionDiagnostics.closePeerConnectionTime;
     pPeerConnectionMetrics->peerConnectionStats.freePeerConnectionTime = pKvsPeerConnection->peerConnectionDiagnostics.freePeerConnectionTime;
+    if (pKvsPeerConnection->pReceiveQueue != NULL) {
+        CHK_STATUS(receiveQueueGetStats(pKvsPeerConnection->pReceiveQueue, &pPeerConnectionMetrics->peerConnectionStats.receiveQueueDepth,
+                                        &pPeerConnectionMetrics->peerConnectionStats.receiveQueueMaxDepth,
+                                        &pPeerConnectionMetrics->peerConnectionStats.receiveQueueDroppedPackets));
+    }
 CleanUp:
     releaseHoldOnInstance(pWebRtcClientContext);
     CHK_LOG_ERR(retStatus);
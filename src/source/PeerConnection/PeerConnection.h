@@ -61,6 +61,12 @@ typedef struct {
     UINT16 prevReportedBaseSeqNum;        // To monitor the base seqNum in the TWCC response
 } TwccManager, *PTwccManager;
 
+// Sent packets only need to be tracked for TWCC when somebody consumes the feedback
+#define IS_TWCC_FEEDBACK_NEEDED(pKvsPeerConnection)                                                                                                  \
+    ((pKvsPeerConnection)->pTwccManager != NULL &&                                                                                                   \
+     ((pKvsPeerConnection)->onSenderBandwidthEstimation != NULL || (pKvsPeerConnection)->onTargetBitrate != NULL ||                                  \
+      (pKvsPeerConnection)->pPacer != NULL || (pKvsPeerConnection)->egressBandwidthPeer.pManager != NULL))
+
 typedef struct {
     UINT64 peerConnectionCreationTime;
     UINT64 dtlsSessionSetupTime;
@@ -89,6 +95,8 @@ typedef struct {
 
     PSessionDescription pRemoteSessionDescription;
     PDoubleList pTransceivers;
+    // Transceivers indexed by their sender, rtx and receiver ssrc for the inbound packet path
+    PSsrcTable pSsrcTable;
     PDoubleList pFakeTransceivers;
     PDoubleList pAnswerTransceivers;
 
@@ -145,6 +153,42 @@ typedef struct {
     PTwccManager pTwccManager;
     RtcOnSenderBandwidthEstimation onSenderBandwidthEstimation;
     UINT64 onSenderBandwidthEstimationCustomData;
+    // Delay and loss based estimator fed by the same feedback, guarded by twccLock
+    PCongestionController pCongestionController;
+    RtcOnTargetBitrate onTargetBitrate;
+    UINT64 onTargetBitrateCustomData;
+
+    // Read without the object lock as it is invoked from the sending threads
+    RtcOnBackpressure onBackpressure;
+    UINT64 onBackpressureCustomData;
+
+    // Sender side pacing, NULL unless enabled in the configuration
+    PPacer pPacer;
+
+    // Loss feedback of the inbound video streams
+    BOOL nackGenerationEnabled;
+    UINT32 nackMaxRetries;
+    UINT32 nackPliLossBudget;
+
+    // ULPFEC in RED for the video transceivers. The payload types are 0 until the remote description negotiates both
+    BOOL fecEnabled;
+    UINT32 fecGroupSize;
+    UINT32 fecMaxProtectionPercent;
+    UINT8 redPayloadType;
+    UINT8 ulpfecPayloadType;
+
+    // The payload type each negotiated RTX payload type retransmits, 0 for the payload types that are not RTX
+    UINT8 rtxAptPayloadTypes[PAYLOAD_TYPE_MASK + 1];
+
+    // Transport-wide feedback of the inbound packets, NULL when disabled in the configuration
+    PTwccFeedbackGenerator pTwccFeedbackGenerator;
+
+    // Inbound SRTP and SRTCP packets waiting for the receive worker, NULL when they are processed on the listener thread
+    PReceiveQueue pReceiveQueue;
+
+    // Reports the estimates to the process wide egress bandwidth manager instead of setting the pacer, not added unless
+    // enabled in the configuration
+    EgressBandwidthPeer egressBandwidthPeer;
 
     UINT64 iceConnectingStartTime;
     KvsPeerConnectionDiagnostics peerConnectionDiagnostics;
@@ -182,12 +226,21 @@ VOID onSctpSessionDataChannelMessage(UINT64, UINT32, BOOL, PBYTE, UINT32);
 VOID onSctpSessionDataChannelOpen(UINT64, UINT32, PBYTE, UINT32);
 
 STATUS sendPacketToRtpReceiver(PKvsPeerConnection, PBYTE, UINT32);
+// ReceiveQueueProcessFunc, customData is the PKvsPeerConnection
+STATUS onInboundSrtpPacket(UINT64, PBYTE, UINT32);
+// RtcOnTargetBitrate given the egress bandwidth allocated to the PeerConnection, customData is the PKvsPeerConnection
+VOID onEgressBandwidthAllocation(UINT64, UINT64);
 STATUS changePeerConnectionState(PKvsPeerConnection, RTC_PEER_CONNECTION_STATE);
 STATUS twccManagerOnPacketSent(PKvsPeerConnection, PRtpPacket);
+// NackGeneratorSendFunc of the inbound video streams, customData is the PKvsRtpTransceiver
+STATUS sendRtcpLossFeedback(UINT64, PUINT16, UINT32, BOOL);
+// TwccFeedbackGeneratorSendFunc, customData is the PKvsPeerConnection
+STATUS sendRtcpTwccFeedback(UINT64, PBYTE, UINT32);
 UINT32 parseExtId(PCHAR);
 
 // visible for testing only
 VOID onIceConnectionStateChange(UINT64, UINT64);
+VOID onIceEgressStateChange(UINT64, BOOL);
 
 #ifdef __cplusplus
 }
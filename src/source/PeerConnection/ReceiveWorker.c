@@ -0,0 +1,481 @@
+/**
+ * Kinesis Video Producer Shared Receive Worker
+ */
+#define LOG_CLASS "ReceiveWorker"
+#include "../Include_i.h"
+
+PReceiveWorkerPool getReceiveWorkerPoolInstance()
+{
+    static ReceiveWorkerPool pool = {.lock = INVALID_MUTEX_VALUE, .isInitialized = FALSE, .workerCount = 0};
+    return &pool;
+}
+
+STATUS createReceiveWorkerPool()
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PReceiveWorkerPool pReceiveWorkerPool = getReceiveWorkerPoolInstance();
+
+    CHK_ERR(!IS_VALID_MUTEX_VALUE(pReceiveWorkerPool->lock), STATUS_INVALID_OPERATION, "Receive worker pool has been created already");
+
+    pReceiveWorkerPool->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pReceiveWorkerPool->lock), STATUS_INVALID_OPERATION);
+    pReceiveWorkerPool->isInitialized = TRUE;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS freeReceiveWorkerPool()
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    UINT32 i, workerCount = 0;
+    PReceiveWorker workers[RECEIVE_WORKER_MAX_THREADS];
+    PReceiveWorkerPool pReceiveWorkerPool = getReceiveWorkerPoolInstance();
+
+    CHK_WARN(IS_VALID_MUTEX_VALUE(pReceiveWorkerPool->lock), STATUS_INVALID_OPERATION, "Receive worker pool not created, nothing to free");
+
+    MUTEX_LOCK(pReceiveWorkerPool->lock);
+    locked = TRUE;
+
+    pReceiveWorkerPool->isInitialized = FALSE;
+    for (i = 0; i < pReceiveWorkerPool->workerCount; i++) {
+        if (pReceiveWorkerPool->workerUsers[i] != 0) {
+            DLOGW("Freeing receive worker %u with %u queue(s) still attached", i, pReceiveWorkerPool->workerUsers[i]);
+        }
+
+        workers[workerCount++] = pReceiveWorkerPool->workers[i];
+        pReceiveWorkerPool->workers[i] = NULL;
+        pReceiveWorkerPool->workerUsers[i] = 0;
+    }
+
+    // All members of the static instance must be reset so that the pool can be created again
+    pReceiveWorkerPool->workerCount = 0;
+
+    // A worker releasing a queue freed from its own callback takes the pool lock, so it is not held while joining
+    MUTEX_UNLOCK(pReceiveWorkerPool->lock);
+    locked = FALSE;
+
+    for (i = 0; i < workerCount; i++) {
+        CHK_LOG_ERR(freeReceiveWorker(&workers[i]));
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pReceiveWorkerPool->lock);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pReceiveWorkerPool->lock)) {
+        MUTEX_FREE(pReceiveWorkerPool->lock);
+        pReceiveWorkerPool->lock = INVALID_MUTEX_VALUE;
+    }
+
+    return retStatus;
+}
+
+UINT32 receiveWorkerPoolGetThreadCount()
+{
+    PCHAR pThreadCount;
+    UINT32 threadCount = 0;
+#if defined(_WIN32)
+    SYSTEM_INFO systemInfo;
+#else
+    INT64 coreCount;
+#endif
+
+    if (NULL == (pThreadCount = GETENV(WEBRTC_RECEIVE_WORKER_THREADS_ENV_VAR)) ||
+        STATUS_SUCCESS != STRTOUI32(pThreadCount, NULL, 10, &threadCount) || threadCount == 0) {
+#if defined(_WIN32)
+        GetSystemInfo(&systemInfo);
+        threadCount = (UINT32) systemInfo.dwNumberOfProcessors;
+#else
+        coreCount = (INT64) sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = coreCount > 0 ? (UINT32) coreCount : 1;
+#endif
+    }
+
+    return MAX(1, MIN(threadCount, RECEIVE_WORKER_MAX_THREADS));
+}
+
+STATUS createReceiveWorker(PReceiveWorker* ppReceiveWorker)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PReceiveWorker pReceiveWorker = NULL;
+
+    CHK(ppReceiveWorker != NULL, STATUS_NULL_ARG);
+
+    pReceiveWorker = (PReceiveWorker) MEMCALLOC(1, SIZEOF(ReceiveWorker));
+    CHK(pReceiveWorker != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pReceiveWorker->workerRoutine = INVALID_TID_VALUE;
+    pReceiveWorker->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pReceiveWorker->lock), STATUS_INVALID_OPERATION);
+    pReceiveWorker->drainedCvar = CVAR_CREATE();
+    CHK(IS_VALID_CVAR_VALUE(pReceiveWorker->drainedCvar), STATUS_INVALID_OPERATION);
+    pReceiveWorker->wakeLock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pReceiveWorker->wakeLock), STATUS_INVALID_OPERATION);
+    pReceiveWorker->wakeCvar = CVAR_CREATE();
+    CHK(IS_VALID_CVAR_VALUE(pReceiveWorker->wakeCvar), STATUS_INVALID_OPERATION);
+    ATOMIC_STORE_BOOL(&pReceiveWorker->terminate, FALSE);
+    ATOMIC_STORE_BOOL(&pReceiveWorker->signaled, FALSE);
+
+    CHK_STATUS(THREAD_CREATE(&pReceiveWorker->workerRoutine, receiveWorkerRoutine, (PVOID) pReceiveWorker));
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && pReceiveWorker != NULL) {
+        freeReceiveWorker(&pReceiveWorker);
+    }
+
+    if (ppReceiveWorker != NULL) {
+        *ppReceiveWorker = pReceiveWorker;
+    }
+
+    return retStatus;
+}
+
+STATUS freeReceiveWorker(PReceiveWorker* ppReceiveWorker)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PReceiveWorker pReceiveWorker;
+
+    CHK(ppReceiveWorker != NULL, STATUS_NULL_ARG);
+    pReceiveWorker = *ppReceiveWorker;
+    CHK(pReceiveWorker != NULL, retStatus);
+
+    if (IS_VALID_TID_VALUE(pReceiveWorker->workerRoutine)) {
+        ATOMIC_STORE_BOOL(&pReceiveWorker->terminate, TRUE);
+        MUTEX_LOCK(pReceiveWorker->wakeLock);
+        CVAR_SIGNAL(pReceiveWorker->wakeCvar);
+        MUTEX_UNLOCK(pReceiveWorker->wakeLock);
+
+        THREAD_JOIN(pReceiveWorker->workerRoutine, NULL);
+    }
+
+    if (IS_VALID_CVAR_VALUE(pReceiveWorker->wakeCvar)) {
+        CVAR_FREE(pReceiveWorker->wakeCvar);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pReceiveWorker->wakeLock)) {
+        MUTEX_FREE(pReceiveWorker->wakeLock);
+    }
+
+    if (IS_VALID_CVAR_VALUE(pReceiveWorker->drainedCvar)) {
+        CVAR_FREE(pReceiveWorker->drainedCvar);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pReceiveWorker->lock)) {
+        MUTEX_FREE(pReceiveWorker->lock);
+    }
+
+    MEMFREE(pReceiveWorker);
+    *ppReceiveWorker = NULL;
+
+CleanUp:
+
+    return retStatus;
+}
+
+PVOID receiveWorkerRoutine(PVOID arg)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PReceiveWorker pReceiveWorker = (PReceiveWorker) arg;
+    PReceiveQueue pReceiveQueue, pNextQueue, pReleasedQueues, *ppCurrent;
+    UINT32 processedCount;
+
+    CHK(pReceiveWorker != NULL, STATUS_NULL_ARG);
+
+    while (!ATOMIC_LOAD_BOOL(&pReceiveWorker->terminate)) {
+        // Packets pushed from here on need to signal again
+        ATOMIC_STORE_BOOL(&pReceiveWorker->signaled, FALSE);
+
+        processedCount = 0;
+        pReleasedQueues = NULL;
+        MUTEX_LOCK(pReceiveWorker->lock);
+        pReceiveQueue = pReceiveWorker->pQueues;
+        while (pReceiveQueue != NULL) {
+            if (ATOMIC_LOAD_BOOL(&pReceiveQueue->detached)) {
+                pReceiveQueue = pReceiveQueue->pNext;
+                continue;
+            }
+
+            // The callbacks may free PeerConnections, so the lock is dropped. The queue stays linked while draining
+            pReceiveQueue->draining = TRUE;
+            MUTEX_UNLOCK(pReceiveWorker->lock);
+            processedCount += receiveQueueDrain(pReceiveQueue, RECEIVE_WORKER_BATCH_SIZE);
+            MUTEX_LOCK(pReceiveWorker->lock);
+            pReceiveQueue->draining = FALSE;
+            pNextQueue = pReceiveQueue->pNext;
+
+            if (pReceiveQueue->releaseOnWorker) {
+                for (ppCurrent = &pReceiveWorker->pQueues; *ppCurrent != pReceiveQueue; ppCurrent = &(*ppCurrent)->pNext) {
+                }
+                *ppCurrent = pNextQueue;
+                pReceiveQueue->pNext = pReleasedQueues;
+                pReleasedQueues = pReceiveQueue;
+            } else if (ATOMIC_LOAD_BOOL(&pReceiveQueue->detached)) {
+                CVAR_BROADCAST(pReceiveWorker->drainedCvar);
+            }
+
+            pReceiveQueue = pNextQueue;
+        }
+        MUTEX_UNLOCK(pReceiveWorker->lock);
+
+        // Released without the worker lock as it takes the pool lock
+        while (pReleasedQueues != NULL) {
+            pReceiveQueue = pReleasedQueues;
+            pReleasedQueues = pReceiveQueue->pNext;
+            receiveQueueRelease(pReceiveQueue);
+        }
+
+        if (processedCount == 0) {
+            // A producer that pushed after the drain either set signaled already or signals once the wait has started
+            MUTEX_LOCK(pReceiveWorker->wakeLock);
+            if (!ATOMIC_LOAD_BOOL(&pReceiveWorker->signaled) && !ATOMIC_LOAD_BOOL(&pReceiveWorker->terminate)) {
+                CVAR_WAIT(pReceiveWorker->wakeCvar, pReceiveWorker->wakeLock, RECEIVE_WORKER_IDLE_TIMEOUT);
+            }
+            MUTEX_UNLOCK(pReceiveWorker->wakeLock);
+        }
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return NULL;
+}
+
+UINT32 receiveQueueDrain(PReceiveQueue pReceiveQueue, UINT32 maxCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PReceiveQueueEntry pEntry;
+    SIZE_T head, tail;
+    UINT32 processedCount = 0;
+
+    head = pReceiveQueue->head;
+    tail = ATOMIC_LOAD(&pReceiveQueue->tail);
+
+    while (head != tail && processedCount < maxCount) {
+        pEntry = &pReceiveQueue->pEntries[head & (pReceiveQueue->capacity - 1)];
+        if (STATUS_FAILED(retStatus = pReceiveQueue->processFn(pReceiveQueue->customData, pEntry->pBuffer, pEntry->length))) {
+            DLOGW("Processing a queued inbound packet failed with 0x%08x", retStatus);
+        }
+        SAFE_MEMFREE(pEntry->pBuffer);
+
+        // Hands the slot back to the producer
+        ATOMIC_STORE(&pReceiveQueue->head, ++head);
+        processedCount++;
+
+        // The callback freed its own queue
+        if (ATOMIC_LOAD_BOOL(&pReceiveQueue->detached)) {
+            break;
+        }
+    }
+
+    return processedCount;
+}
+
+STATUS createReceiveQueue(ReceiveQueueProcessFunc processFn, UINT64 customData, PReceiveQueue* ppReceiveQueue)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE, started = FALSE;
+    UINT32 i, workerCount, selected = 0;
+    PReceiveQueue pReceiveQueue = NULL;
+    PReceiveWorker pReceiveWorker;
+    PReceiveWorkerPool pReceiveWorkerPool = getReceiveWorkerPoolInstance();
+
+    CHK(processFn != NULL && ppReceiveQueue != NULL, STATUS_NULL_ARG);
+    CHK_ERR(IS_VALID_MUTEX_VALUE(pReceiveWorkerPool->lock), STATUS_INVALID_OPERATION, "Receive worker pool not created. Call initKvsWebRtc first");
+
+    MUTEX_LOCK(pReceiveWorkerPool->lock);
+    locked = TRUE;
+
+    CHK_ERR(pReceiveWorkerPool->isInitialized, STATUS_INVALID_OPERATION, "Receive worker pool is shutting down");
+
+    // Start the workers on first use
+    if (pReceiveWorkerPool->workerCount == 0) {
+        started = TRUE;
+        workerCount = receiveWorkerPoolGetThreadCount();
+        for (i = 0; i < workerCount; i++) {
+            CHK_STATUS(createReceiveWorker(&pReceiveWorkerPool->workers[i]));
+            pReceiveWorkerPool->workerUsers[i] = 0;
+            pReceiveWorkerPool->workerCount++;
+        }
+
+        DLOGI("Started %u shared receive worker thread(s)", workerCount);
+    }
+
+    for (i = 1; i < pReceiveWorkerPool->workerCount; i++) {
+        if (pReceiveWorkerPool->workerUsers[i] < pReceiveWorkerPool->workerUsers[selected]) {
+            selected = i;
+        }
+    }
+
+    // The ring follows the queue in the same allocation
+    pReceiveQueue = (PReceiveQueue) MEMCALLOC(1, SIZEOF(ReceiveQueue) + RECEIVE_WORKER_QUEUE_CAPACITY * SIZEOF(ReceiveQueueEntry));
+    CHK(pReceiveQueue != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pReceiveQueue->capacity = RECEIVE_WORKER_QUEUE_CAPACITY;
+    pReceiveQueue->pEntries = (PReceiveQueueEntry) (pReceiveQueue + 1);
+    pReceiveQueue->processFn = processFn;
+    pReceiveQueue->customData = customData;
+    pReceiveQueue->workerIndex = selected;
+    pReceiveQueue->pWorker = pReceiveWorker = pReceiveWorkerPool->workers[selected];
+
+    MUTEX_LOCK(pReceiveWorker->lock);
+    pReceiveQueue->pNext = pReceiveWorker->pQueues;
+    pReceiveWorker->pQueues = pReceiveQueue;
+    MUTEX_UNLOCK(pReceiveWorker->lock);
+
+    pReceiveWorkerPool->workerUsers[selected]++;
+    *ppReceiveQueue = pReceiveQueue;
+    pReceiveQueue = NULL;
+
+CleanUp:
+
+    SAFE_MEMFREE(pReceiveQueue);
+
+    if (STATUS_FAILED(retStatus) && started) {
+        // Do not leave a partially started pool behind
+        for (i = 0; i < pReceiveWorkerPool->workerCount; i++) {
+            freeReceiveWorker(&pReceiveWorkerPool->workers[i]);
+        }
+        pReceiveWorkerPool->workerCount = 0;
+    }
+
+    if (locked) {
+        MUTEX_UNLOCK(pReceiveWorkerPool->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS freeReceiveQueue(PReceiveQueue* ppReceiveQueue)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PReceiveQueue pReceiveQueue, *ppCurrent;
+    PReceiveWorker pReceiveWorker;
+    BOOL releaseOnWorker = FALSE;
+
+    CHK(ppReceiveQueue != NULL, STATUS_NULL_ARG);
+    pReceiveQueue = *ppReceiveQueue;
+    CHK(pReceiveQueue != NULL, retStatus);
+    pReceiveWorker = pReceiveQueue->pWorker;
+
+    MUTEX_LOCK(pReceiveWorker->lock);
+    ATOMIC_STORE_BOOL(&pReceiveQueue->detached, TRUE);
+    if (pReceiveQueue->draining && GETTID() == pReceiveWorker->workerRoutine) {
+        // Called from the processFn of this queue, waiting would never return
+        pReceiveQueue->releaseOnWorker = releaseOnWorker = TRUE;
+    } else {
+        // Only waits for this queue, the other queues of the worker keep being drained
+        while (pReceiveQueue->draining) {
+            CVAR_WAIT(pReceiveWorker->drainedCvar, pReceiveWorker->lock, INFINITE_TIME_VALUE);
+        }
+
+        for (ppCurrent = &pReceiveWorker->pQueues; *ppCurrent != NULL; ppCurrent = &(*ppCurrent)->pNext) {
+            if (*ppCurrent == pReceiveQueue) {
+                *ppCurrent = pReceiveQueue->pNext;
+                break;
+            }
+        }
+    }
+    MUTEX_UNLOCK(pReceiveWorker->lock);
+
+    if (!releaseOnWorker) {
+        receiveQueueRelease(pReceiveQueue);
+    }
+
+    *ppReceiveQueue = NULL;
+
+CleanUp:
+
+    return retStatus;
+}
+
+VOID receiveQueueRelease(PReceiveQueue pReceiveQueue)
+{
+    PReceiveWorkerPool pReceiveWorkerPool = getReceiveWorkerPoolInstance();
+    SIZE_T head, tail;
+
+    // The queue is not linked to its worker anymore
+    if (IS_VALID_MUTEX_VALUE(pReceiveWorkerPool->lock)) {
+        MUTEX_LOCK(pReceiveWorkerPool->lock);
+        if (pReceiveWorkerPool->workerUsers[pReceiveQueue->workerIndex] > 0) {
+            pReceiveWorkerPool->workerUsers[pReceiveQueue->workerIndex]--;
+        }
+        MUTEX_UNLOCK(pReceiveWorkerPool->lock);
+    }
+
+    tail = ATOMIC_LOAD(&pReceiveQueue->tail);
+    for (head = pReceiveQueue->head; head != tail; head++) {
+        SAFE_MEMFREE(pReceiveQueue->pEntries[head & (pReceiveQueue->capacity - 1)].pBuffer);
+    }
+
+    MEMFREE(pReceiveQueue);
+}
+
+STATUS receiveQueuePush(PReceiveQueue pReceiveQueue, PBYTE pBuffer, UINT32 length)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PReceiveQueueEntry pEntry;
+    PReceiveWorker pReceiveWorker;
+    SIZE_T tail, depth;
+    PBYTE pCopy = NULL;
+
+    CHK(pReceiveQueue != NULL && pBuffer != NULL, STATUS_NULL_ARG);
+
+    tail = pReceiveQueue->tail;
+    depth = tail - ATOMIC_LOAD(&pReceiveQueue->head);
+    if (depth >= pReceiveQueue->capacity) {
+        // Same as an overflowing socket buffer, NACKs and keyframe requests recover from it
+        ATOMIC_INCREMENT(&pReceiveQueue->droppedPackets);
+        CHK(FALSE, retStatus);
+    }
+
+    // The listener reuses its receive buffer for the next packet
+    CHK(NULL != (pCopy = (PBYTE) MEMALLOC(length)), STATUS_NOT_ENOUGH_MEMORY);
+    MEMCPY(pCopy, pBuffer, length);
+    pEntry = &pReceiveQueue->pEntries[tail & (pReceiveQueue->capacity - 1)];
+    pEntry->pBuffer = pCopy;
+    pEntry->length = length;
+
+    // Publishes the entry to the worker
+    ATOMIC_STORE(&pReceiveQueue->tail, tail + 1);
+
+    if (depth + 1 > ATOMIC_LOAD(&pReceiveQueue->maxDepth)) {
+        ATOMIC_STORE(&pReceiveQueue->maxDepth, depth + 1);
+    }
+
+    pReceiveWorker = pReceiveQueue->pWorker;
+    if (!ATOMIC_EXCHANGE_BOOL(&pReceiveWorker->signaled, TRUE)) {
+        MUTEX_LOCK(pReceiveWorker->wakeLock);
+        CVAR_SIGNAL(pReceiveWorker->wakeCvar);
+        MUTEX_UNLOCK(pReceiveWorker->wakeLock);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS receiveQueueGetStats(PReceiveQueue pReceiveQueue, PUINT32 pDepth, PUINT32 pMaxDepth, PUINT64 pDroppedPackets)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    SIZE_T head, tail;
+
+    CHK(pReceiveQueue != NULL && pDepth != NULL && pMaxDepth != NULL && pDroppedPackets != NULL, STATUS_NULL_ARG);
+
+    // The head can only catch up with a tail read after it
+    head = ATOMIC_LOAD(&pReceiveQueue->head);
+    tail = ATOMIC_LOAD(&pReceiveQueue->tail);
+    *pDepth = (UINT32) (tail - head);
+    *pMaxDepth = (UINT32) ATOMIC_LOAD(&pReceiveQueue->maxDepth);
+    *pDroppedPackets = (UINT64) ATOMIC_LOAD(&pReceiveQueue->droppedPackets);
+
+CleanUp:
+
+    return retStatus;
+}
@@ -0,0 +1,181 @@
+/*******************************************
+Shared Receive Worker internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_RECEIVE_WORKER__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_RECEIVE_WORKER__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Packets taken from one queue before moving to the next one, so that a busy PeerConnection does not starve the others
+#define RECEIVE_WORKER_BATCH_SIZE 32
+
+// Upper bound of a worker sleep, only a safety net as producers wake the worker up
+#define RECEIVE_WORKER_IDLE_TIMEOUT (100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+/**
+ * Invoked on the worker thread for every queued packet, in the order they were pushed
+ *
+ * @param - UINT64 - IN - customData given to createReceiveQueue
+ * @param - PBYTE - IN - packet, freed by the worker once the callback returns
+ * @param - UINT32 - IN - packet length
+ */
+typedef STATUS (*ReceiveQueueProcessFunc)(UINT64, PBYTE, UINT32);
+
+typedef struct {
+    PBYTE pBuffer;
+    UINT32 length;
+} ReceiveQueueEntry, *PReceiveQueueEntry;
+
+struct __ReceiveWorker;
+
+/**
+ * Bounded single producer single consumer ring of inbound packets. The producer is the connection listener thread of
+ * the PeerConnection, the consumer is the worker the queue is attached to.
+ */
+typedef struct __ReceiveQueue ReceiveQueue;
+struct __ReceiveQueue {
+    // Only written by the consumer
+    volatile SIZE_T head;
+    // Only written by the producer
+    volatile SIZE_T tail;
+    UINT32 capacity;
+
+    ReceiveQueueProcessFunc processFn;
+    UINT64 customData;
+
+    volatile SIZE_T maxDepth;
+    volatile SIZE_T droppedPackets;
+
+    struct __ReceiveWorker* pWorker;
+    UINT32 workerIndex;
+    // Next queue of the worker, only accessed with the worker lock held
+    struct __ReceiveQueue* pNext;
+    // The worker is calling processFn, guarded by the worker lock
+    BOOL draining;
+    // Set by freeReceiveQueue, the worker does not start draining it anymore
+    volatile ATOMIC_BOOL detached;
+    // Freed from its own processFn, the worker releases it once the drain returns. Guarded by the worker lock
+    BOOL releaseOnWorker;
+
+    PReceiveQueueEntry pEntries;
+};
+typedef struct __ReceiveQueue* PReceiveQueue;
+
+/**
+ * One worker thread draining the queues attached to it in turn
+ */
+typedef struct __ReceiveWorker ReceiveWorker;
+struct __ReceiveWorker {
+    // Guards the queue list and the draining flags, never held while calling processFn
+    MUTEX lock;
+    // Broadcast when the drain of a detached queue returns
+    CVAR drainedCvar;
+    // Only guards the sleep, producers never wait on the drain
+    MUTEX wakeLock;
+    CVAR wakeCvar;
+    TID workerRoutine;
+    volatile ATOMIC_BOOL terminate;
+    // Set by the producers, a worker only needs to be signaled once per wake up
+    volatile ATOMIC_BOOL signaled;
+    PReceiveQueue pQueues;
+};
+typedef struct __ReceiveWorker* PReceiveWorker;
+
+/**
+ * Process wide pool of receive workers. PeerConnections that opt in through KvsRtcConfiguration.useReceiveWorkerPool
+ * hand their inbound SRTP and SRTCP packets to one of these workers instead of processing them on the listener thread.
+ * A PeerConnection is attached to a single worker so its packets are processed in order.
+ */
+typedef struct {
+    MUTEX lock;
+    BOOL isInitialized;
+    // Number of workers, fixed once the workers are started. 0 until first use
+    UINT32 workerCount;
+    PReceiveWorker workers[RECEIVE_WORKER_MAX_THREADS];
+    // Number of queues currently attached to each worker
+    UINT32 workerUsers[RECEIVE_WORKER_MAX_THREADS];
+} ReceiveWorkerPool, *PReceiveWorkerPool;
+
+/**
+ * Get the process wide receive worker pool
+ *
+ * @return - PReceiveWorkerPool - the singleton
+ */
+PReceiveWorkerPool getReceiveWorkerPoolInstance();
+
+/**
+ * Make the receive worker pool available. Called by initKvsWebRtc. No threads are created until a queue is created.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createReceiveWorkerPool();
+
+/**
+ * Stop and free all the workers. Called by deinitKvsWebRtc once all the PeerConnections have been freed.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS freeReceiveWorkerPool();
+
+/**
+ * Create a queue attached to the least loaded worker, starting the worker threads if this is the first use
+ *
+ * @param - ReceiveQueueProcessFunc - IN - invoked on the worker for every packet
+ * @param - UINT64 - IN - customData passed to processFn
+ * @param - PReceiveQueue* - OUT - new queue
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createReceiveQueue(ReceiveQueueProcessFunc, UINT64, PReceiveQueue*);
+
+/**
+ * Detach the queue from its worker, waiting for a running processFn of this queue to return, and drop the packets still
+ * queued. When called from the processFn of the queue itself, the worker releases the queue once the callback returns.
+ *
+ * @param - PReceiveQueue* - IN/OUT - queue to free
+ *
+ * @return - STATUS status of execution
+ */
+STATUS freeReceiveQueue(PReceiveQueue*);
+
+/**
+ * Copy a packet into the queue. Only one thread may push to a given queue. The packet is dropped when the queue is full.
+ *
+ * @param - PReceiveQueue - IN - queue
+ * @param - PBYTE - IN - packet
+ * @param - UINT32 - IN - packet length
+ *
+ * @return - STATUS status of execution. STATUS_SUCCESS for a dropped packet as well
+ */
+STATUS receiveQueuePush(PReceiveQueue, PBYTE, UINT32);
+
+/**
+ * Depth and drop counters of the queue
+ *
+ * @param - PReceiveQueue - IN - queue
+ * @param - PUINT32 - OUT - packets waiting for the worker
+ * @param - PUINT32 - OUT - highest number of packets that have been waiting
+ * @param - PUINT64 - OUT - packets dropped because the queue was full
+ *
+ * @return - STATUS status of execution
+ */
+STATUS receiveQueueGetStats(PReceiveQueue, PUINT32, PUINT32, PUINT64);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+UINT32 receiveWorkerPoolGetThreadCount();
+STATUS createReceiveWorker(PReceiveWorker*);
+STATUS freeReceiveWorker(PReceiveWorker*);
+PVOID receiveWorkerRoutine(PVOID);
+UINT32 receiveQueueDrain(PReceiveQueue, UINT32);
+VOID receiveQueueRelease(PReceiveQueue);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_RECEIVE_WORKER__ */
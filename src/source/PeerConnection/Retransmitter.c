@@ -48,9 +48,10 @@ STATUS resendPacketOnNack(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerCo
     UINT32 senderSsrc = 0, receiverSsrc = 0;
     UINT32 filledLen = 0, validIndexListLen = 0;
     PKvsRtpTransceiver pSenderTranceiver = NULL;
-    UINT64 item, index;
+    UINT64 index;
     STATUS tmpStatus = STATUS_SUCCESS;
-    PRtpPacket pRtpPacket = NULL, pRtxRtpPacket = NULL;
+    PRtpPacket pRtpPacket = NULL;
+    PRtpPacketBuffer pRtpPacketBuffer = NULL, pRtxPacketBuffer = NULL;
     PRetransmitter pRetransmitter = NULL;
     // stats
     UINT32 retransmittedPacketsSent = 0, retransmittedBytesSent = 0, nackCount = 0;
@@ -79,19 +80,30 @@ STATUS resendPacketOnNack(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerCo
     CHK_STATUS(rtpRollingBufferGetValidSeqIndexList(pSenderTranceiver->sender.packetBuffer, pRetransmitter->sequenceNumberList, filledLen,
                                                     pRetransmitter->validIndexList, &validIndexListLen));
     for (index = 0; index < validIndexListLen; index++) {
-        retStatus = rollingBufferExtractData(pSenderTranceiver->sender.packetBuffer->pRollingBuffer, pRetransmitter->validIndexList[index], &item);
-        pRtpPacket = (PRtpPacket) item;
-        CHK(retStatus == STATUS_SUCCESS, retStatus);
+        // Shared with the rolling buffer, our reference keeps the packet alive even if it gets evicted meanwhile
+        CHK_STATUS(rtpRollingBufferGetRtpPacketBuffer(pSenderTranceiver->sender.packetBuffer, pRetransmitter->validIndexList[index],
+                                                      &pRtpPacketBuffer));
 
-        if (pRtpPacket != NULL) {
+        if (pRtpPacketBuffer != NULL) {
+            pRtpPacket = &pRtpPacketBuffer->packet;
             if (pSenderTranceiver->sender.payloadType == pSenderTranceiver->sender.rtxPayloadType) {
-                retStatus = iceAgentSendPacket(pKvsPeerConnection->pIceAgent, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength);
+                // Kept encrypted, send as is
+                if (pKvsPeerConnection->pPacer != NULL) {
+                    retStatus = writePacedRtpPacket(pSenderTranceiver, pRtpPacketBuffer, FALSE, PACER_PRIORITY_RETRANSMISSION);
+                } else {
+                    retStatus = iceAgentSendPacket(pKvsPeerConnection->pIceAgent, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength);
+                }
             } else {
-                CHK_STATUS(constructRetransmitRtpPacketFromBytes(
-                    pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength, pSenderTranceiver->sender.rtxSequenceNumber,
-                    pSenderTranceiver->sender.rtxPayloadType, pSenderTranceiver->sender.rtxSsrc, &pRtxRtpPacket));
+                CHK_STATUS(constructRetransmitRtpPacketBuffer(pRtpPacket, pSenderTranceiver->sender.rtxSequenceNumber,
+                                                              pSenderTranceiver->sender.rtxPayloadType, pSenderTranceiver->sender.rtxSsrc,
+                                                              SRTP_AUTH_TAG_OVERHEAD, &pRtxPacketBuffer));
                 pSenderTranceiver->sender.rtxSequenceNumber++;
-                retStatus = writeRtpPacket(pKvsPeerConnection, pRtxRtpPacket);
+                if (pKvsPeerConnection->pPacer != NULL) {
+                    retStatus = writePacedRtpPacket(pSenderTranceiver, pRtxPacketBuffer, TRUE, PACER_PRIORITY_RETRANSMISSION);
+                } else {
+                    retStatus = writeRtpPacket(pKvsPeerConnection, pRtxPacketBuffer);
+                }
+                rtpPacketBufferRelease(&pRtxPacketBuffer);
             }
             // resendPacket
             if (STATUS_SUCCEEDED(retStatus)) {
@@ -99,30 +111,25 @@ STATUS resendPacketOnNack(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerCo
                 retransmittedPacketsSent++;
                 retransmittedBytesSent += pRtpPacket->rawPacketLength - RTP_HEADER_LEN(pRtpPacket);
                 DLOGV("Resent packet ssrc %lu seq %lu succeeded", pRtpPacket->header.ssrc, pRtpPacket->header.sequenceNumber);
-                twccManagerOnPacketSent(pKvsPeerConnection, pRtpPacket);
+                // Paced packets are reported once they actually leave
+                if (pKvsPeerConnection->pPacer == NULL) {
+                    twccManagerOnPacketSent(pKvsPeerConnection, pRtpPacket);
+                }
             } else {
                 DLOGV("Resent packet ssrc %lu seq %lu failed 0x%08x", pRtpPacket->header.ssrc, pRtpPacket->header.sequenceNumber, retStatus);
             }
-            // putBackPacketToRollingBuffer
-            retStatus =
-                rollingBufferInsertData(pSenderTranceiver->sender.packetBuffer->pRollingBuffer, pRetransmitter->sequenceNumberList[index], item);
-            CHK(retStatus == STATUS_SUCCESS || retStatus == STATUS_ROLLING_BUFFER_NOT_IN_RANGE, retStatus);
-
-            // free the packet if it is not in the valid range any more
-            if (retStatus == STATUS_ROLLING_BUFFER_NOT_IN_RANGE) {
-                DLOGS("Retransmit STATUS_ROLLING_BUFFER_NOT_IN_RANGE free %lu by self", pRtpPacket->header.sequenceNumber);
-                freeRtpPacket(&pRtpPacket);
-                retStatus = STATUS_SUCCESS;
-            } else {
-                DLOGS("Retransmit add back to rolling %lu", pRtpPacket->header.sequenceNumber);
-            }
 
-            freeRtpPacket(&pRtxRtpPacket);
+            retStatus = STATUS_SUCCESS;
             pRtpPacket = NULL;
+            rtpPacketBufferRelease(&pRtpPacketBuffer);
         }
     }
 
 CleanUp:
+    if (retransmittedPacketsSent > 0 && pKvsPeerConnection->pPacer != NULL) {
+        pacerProcess(pKvsPeerConnection->pPacer);
+    }
+
     if (pSenderTranceiver != NULL) {
         MUTEX_LOCK(pSenderTranceiver->statsLock);
         pSenderTranceiver->outboundStats.nackCount += nackCount;
@@ -134,12 +141,38 @@ CleanUp:
     }
 
     CHK_LOG_ERR(retStatus);
-    if (pRtpPacket != NULL) {
-        // free the packet as it is not put back into rolling buffer
-        freeRtpPacket(&pRtpPacket);
-        pRtpPacket = NULL;
-    }
+    rtpPacketBufferRelease(&pRtxPacketBuffer);
+    rtpPacketBufferRelease(&pRtpPacketBuffer);
 
     LEAVES();
     return retStatus;
 }
+
+STATUS rtxDecapsulateRtpPacket(PBYTE pPacket, PUINT32 pPacketLength, UINT8 payloadType, UINT32 ssrc)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 headerLength = 0, payloadEnd;
+    UINT16 originalSequenceNumber;
+
+    CHK(pPacket != NULL && pPacketLength != NULL, STATUS_NULL_ARG);
+    CHK_STATUS(getRtpHeaderLengthFromBytes(pPacket, *pPacketLength, &headerLength));
+
+    payloadEnd = *pPacketLength;
+    if (((pPacket[0] >> PADDING_SHIFT) & PADDING_MASK) != 0) {
+        CHK(payloadEnd > headerLength && pPacket[payloadEnd - 1] <= payloadEnd - headerLength, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+        payloadEnd -= pPacket[payloadEnd - 1];
+    }
+    CHK(payloadEnd >= headerLength + SIZEOF(UINT16), STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+
+    // The original sequence number comes first, the padding stays at the end
+    originalSequenceNumber = (UINT16) getUnalignedInt16BigEndian(pPacket + headerLength);
+    MEMMOVE(pPacket + headerLength, pPacket + headerLength + SIZEOF(UINT16), *pPacketLength - headerLength - SIZEOF(UINT16));
+    pPacket[1] = (BYTE) ((pPacket[1] & (MARKER_MASK << MARKER_SHIFT)) | payloadType);
+    putUnalignedInt16BigEndian(pPacket + SEQ_NUMBER_OFFSET, originalSequenceNumber);
+    putUnalignedInt32BigEndian(pPacket + SSRC_OFFSET, ssrc);
+    *pPacketLength -= SIZEOF(UINT16);
+
+CleanUp:
+
+    return retStatus;
+}
@@ -21,6 +21,19 @@ STATUS createRetransmitter(UINT32, UINT32, PRetransmitter*);
 STATUS freeRetransmitter(PRetransmitter*);
 STATUS resendPacketOnNack(PRtcpPacket, PKvsPeerConnection);
 
+/**
+ * Turn a packet received on the RTX stream of the remote peer back into the packet it retransmits, in place.
+ * https://tools.ietf.org/html/rfc4588#section-4
+ *
+ * @param - PBYTE - IN/OUT - the decrypted packet
+ * @param - PUINT32 - IN/OUT - length of the packet
+ * @param - UINT8 - IN - payload type of the original stream
+ * @param - UINT32 - IN - ssrc of the original stream
+ *
+ * @return - STATUS status of execution, STATUS_RTP_INPUT_PACKET_TOO_SMALL for the padding only packets that retransmit nothing
+ */
+STATUS rtxDecapsulateRtpPacket(PBYTE, PUINT32, UINT8, UINT32);
+
 #ifdef __cplusplus
 }
 #endif
@@ -83,6 +83,8 @@ static STATUS onRtcpReceiverReport(PRtcpPacket pRtcpPacket, PKvsPeerConnection p
 {
     STATUS retStatus = STATUS_SUCCESS;
     PKvsRtpTransceiver pTransceiver = NULL;
+    PDoubleListNode pCurNode = NULL;
+    UINT64 item = 0;
     DOUBLE fractionLost;
     UINT32 rttPropDelayMsec = 0, rttPropDelay, delaySinceLastSR, lastSR, interarrivalJitter, extHiSeqNumReceived, cumulativeLost, senderSSRC, ssrc1;
     UINT64 currentTimeNTP = convertTimestampToNTP(GETTIME());
@@ -141,6 +143,23 @@ static STATUS onRtcpReceiverReport(PRtcpPacket pRtcpPacket, PKvsPeerConnection p
     pTransceiver->remoteInboundStats.roundTripTime = rttPropDelayMsec;
     MUTEX_UNLOCK(pTransceiver->statsLock);
 
+    if (pTransceiver->sender.pFecEncoder != NULL) {
+        CHK_STATUS(fecEncoderOnLoss(pTransceiver->sender.pFecEncoder, fractionLost));
+    }
+
+    if (lastSR != 0) {
+        // Same path for all the streams, the inbound ones retry their NACKs at this pace
+        CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceivers, &pCurNode));
+        while (pCurNode != NULL) {
+            CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
+            if (((PKvsRtpTransceiver) item)->pNackGenerator != NULL) {
+                CHK_STATUS(nackGeneratorSetRoundTripTime(((PKvsRtpTransceiver) item)->pNackGenerator,
+                                                         (UINT64) rttPropDelayMsec * HUNDREDS_OF_NANOS_IN_A_MILLISECOND));
+            }
+            pCurNode = pCurNode->pNext;
+        }
+    }
+
 CleanUp:
 
     return retStatus;
@@ -317,6 +336,123 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Write a transport-wide feedback packet in the format read by parseRtcpTwccPacket.
+ *
+ * pArrivalTimes holds the arrival time of packetStatusCount packets from baseSeqNum on, 0 for the ones not received.
+ * When pPacket is NULL only the length is computed. Otherwise pPacketLen holds the size of pPacket on input.
+ */
+STATUS createRtcpTwccPacket(UINT32 senderSsrc, UINT32 mediaSsrc, UINT16 baseSeqNum, PUINT64 pArrivalTimes, UINT16 packetStatusCount,
+                            UINT8 feedbackPacketCount, PBYTE pPacket, PUINT32 pPacketLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT8 statusSymbols[TWCC_FB_MAX_PACKET_STATUS_COUNT];
+    INT16 recvDeltas[TWCC_FB_MAX_PACKET_STATUS_COUNT];
+    UINT16 packetChunks[TWCC_FB_MAX_PACKET_STATUS_COUNT];
+    UINT32 i, j, runLength, vectorCount, chunkCount = 0, recvDeltaLen = 0, packetLen;
+    UINT64 referenceTime = 0, rebuiltTime = 0;
+    INT64 recvDelta;
+    BOOL referenceTimeSet = FALSE, is2Bit;
+    PBYTE pCurPtr;
+
+    CHK(pArrivalTimes != NULL && pPacketLen != NULL, STATUS_NULL_ARG);
+    CHK(packetStatusCount > 0 && packetStatusCount <= TWCC_FB_MAX_PACKET_STATUS_COUNT, STATUS_INVALID_ARG);
+
+    // The deltas are taken from the time the parser rebuilds rather than the previous arrival so that rounding does not add up
+    for (i = 0; i < packetStatusCount; i++) {
+        if (pArrivalTimes[i] == 0) {
+            statusSymbols[i] = TWCC_STATUS_SYMBOL_NOTRECEIVED;
+            continue;
+        }
+        if (!referenceTimeSet) {
+            referenceTimeSet = TRUE;
+            // Arrival times are from the epoch, the reference only wraps on the wire
+            referenceTime = pArrivalTimes[i] / TWCC_REFERENCE_TIME_UNIT;
+            rebuiltTime = referenceTime * TWCC_REFERENCE_TIME_UNIT;
+        }
+        recvDelta = (INT64) (pArrivalTimes[i] - rebuiltTime);
+        recvDelta = (recvDelta + (recvDelta >= 0 ? TWCC_TICK_DURATION / 2 : -TWCC_TICK_DURATION / 2)) / TWCC_TICK_DURATION;
+        // More than 8 seconds between two packets, the sender gets a skewed time rather than nothing. MIN_INT16 is left out as
+        // parseRtcpTwccPacket takes it for no delta
+        recvDelta = MAX(MIN(recvDelta, MAX_INT16), MIN_INT16 + 1);
+        recvDeltas[i] = (INT16) recvDelta;
+        rebuiltTime += recvDelta * TWCC_TICK_DURATION;
+        if (recvDelta >= 0 && recvDelta <= TWCC_SMALLDELTA_MAX) {
+            statusSymbols[i] = TWCC_STATUS_SYMBOL_SMALLDELTA;
+            recvDeltaLen++;
+        } else {
+            statusSymbols[i] = TWCC_STATUS_SYMBOL_LARGEDELTA;
+            recvDeltaLen += 2;
+        }
+    }
+
+    // Runs of one symbol go in run length chunks, mixed symbols in status vectors of 14 one bit or 7 two bit symbols
+    for (i = 0; i < packetStatusCount; i += runLength) {
+        runLength = 1;
+        while (i + runLength < packetStatusCount && runLength < TWCC_RUNLEN_MAX && statusSymbols[i + runLength] == statusSymbols[i]) {
+            runLength++;
+        }
+
+        vectorCount = MIN(TWCC_STATUSVECTOR_COUNT(TWCC_STATUSVECTOR_CHUNK), packetStatusCount - i);
+        is2Bit = FALSE;
+        for (j = i; j < i + vectorCount; j++) {
+            is2Bit = is2Bit || statusSymbols[j] == TWCC_STATUS_SYMBOL_LARGEDELTA;
+        }
+        if (is2Bit) {
+            vectorCount = MIN(TWCC_STATUSVECTOR_COUNT(TWCC_STATUSVECTOR_2BIT_CHUNK), packetStatusCount - i);
+        }
+
+        if (runLength >= vectorCount) {
+            packetChunks[chunkCount++] = (UINT16) ((statusSymbols[i] << 13u) | runLength);
+        } else {
+            runLength = vectorCount;
+            packetChunks[chunkCount] = is2Bit ? TWCC_STATUSVECTOR_2BIT_CHUNK : TWCC_STATUSVECTOR_CHUNK;
+            for (j = 0; j < vectorCount; j++) {
+                packetChunks[chunkCount] |= statusSymbols[i + j] << (14u - (j + 1) * (is2Bit ? 2u : 1u));
+            }
+            chunkCount++;
+        }
+    }
+
+    packetLen = ROUND_UP(TWCC_FB_HEADER_LEN + chunkCount * TWCC_FB_PACKETCHUNK_SIZE + recvDeltaLen, RTCP_PACKET_LEN_WORD_SIZE);
+
+    if (pPacket != NULL) {
+        CHK(*pPacketLen >= packetLen, STATUS_BUFFER_TOO_SMALL);
+        MEMSET(pPacket, 0x00, packetLen);
+        pPacket[0] = (RTCP_PACKET_VERSION_VAL << VERSION_SHIFT) | RTCP_FEEDBACK_MESSAGE_TYPE_APPLICATION_LAYER_FEEDBACK;
+        pPacket[RTCP_PACKET_TYPE_OFFSET] = RTCP_PACKET_TYPE_GENERIC_RTP_FEEDBACK;
+        putUnalignedInt16BigEndian(pPacket + RTCP_PACKET_LEN_OFFSET, (packetLen / RTCP_PACKET_LEN_WORD_SIZE) - 1);
+        putUnalignedInt32BigEndian(pPacket + 4, senderSsrc);
+        putUnalignedInt32BigEndian(pPacket + 8, mediaSsrc);
+        putUnalignedInt16BigEndian(pPacket + 12, baseSeqNum);
+        putUnalignedInt16BigEndian(pPacket + 14, packetStatusCount);
+        referenceTime &= TWCC_REFERENCE_TIME_MASK;
+        pPacket[16] = (BYTE) (referenceTime >> 16);
+        pPacket[17] = (BYTE) (referenceTime >> 8);
+        pPacket[18] = (BYTE) referenceTime;
+        pPacket[19] = feedbackPacketCount;
+
+        pCurPtr = pPacket + TWCC_FB_HEADER_LEN;
+        for (i = 0; i < chunkCount; i++, pCurPtr += TWCC_FB_PACKETCHUNK_SIZE) {
+            putUnalignedInt16BigEndian(pCurPtr, packetChunks[i]);
+        }
+        for (i = 0; i < packetStatusCount; i++) {
+            if (statusSymbols[i] == TWCC_STATUS_SYMBOL_SMALLDELTA) {
+                *pCurPtr++ = (BYTE) recvDeltas[i];
+            } else if (statusSymbols[i] == TWCC_STATUS_SYMBOL_LARGEDELTA) {
+                putUnalignedInt16BigEndian(pCurPtr, recvDeltas[i]);
+                pCurPtr += 2;
+            }
+        }
+    }
+
+    *pPacketLen = packetLen;
+
+CleanUp:
+
+    return retStatus;
+}
+
 STATUS updateTwccHashTable(PTwccManager pTwccManager, PINT64 duration, PUINT64 receivedBytes, PUINT64 receivedPackets, PUINT64 sentBytes,
                            PUINT64 sentPackets)
 {
@@ -397,6 +533,40 @@ CleanUp:
     return retStatus;
 }
 
+STATUS updateCongestionController(PTwccManager pTwccManager, PCongestionController pCongestionController, PUINT64 pTargetBitrate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PacketFeedback packetFeedback[CONGESTION_CONTROL_FEEDBACK_BATCH_SIZE];
+    PTwccRtpPacketInfo pTwccPacket = NULL;
+    UINT64 twccPktValue = 0, currentTime = GETTIME();
+    UINT32 packetCount = 0;
+    UINT16 seqNum;
+
+    CHK(pTwccManager != NULL && pCongestionController != NULL && pTargetBitrate != NULL, STATUS_NULL_ARG);
+
+    // Has to run before updateTwccHashTable which frees the received packets
+    for (seqNum = pTwccManager->prevReportedBaseSeqNum; seqNum != (UINT16) (pTwccManager->lastReportedSeqNum + 1); seqNum++) {
+        if (STATUS_FAILED(hashTableGet(pTwccManager->pTwccRtpPktInfosHashTable, seqNum, &twccPktValue)) ||
+            (pTwccPacket = (PTwccRtpPacketInfo) twccPktValue) == NULL) {
+            continue;
+        }
+
+        packetFeedback[packetCount].sendTime = pTwccPacket->localTimeKvs;
+        packetFeedback[packetCount].arrivalTime = pTwccPacket->remoteTimeKvs;
+        packetFeedback[packetCount].packetSize = pTwccPacket->packetSize;
+        if (++packetCount == CONGESTION_CONTROL_FEEDBACK_BATCH_SIZE) {
+            CHK_STATUS(congestionControllerOnPacketFeedback(pCongestionController, packetFeedback, packetCount, currentTime, NULL));
+            packetCount = 0;
+        }
+    }
+
+    CHK_STATUS(congestionControllerOnPacketFeedback(pCongestionController, packetFeedback, packetCount, currentTime, pTargetBitrate));
+
+CleanUp:
+    CHK_LOG_ERR(retStatus);
+    return retStatus;
+}
+
 STATUS onRtcpTwccPacket(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConnection)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -404,21 +574,41 @@ STATUS onRtcpTwccPacket(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConn
     BOOL locked = FALSE;
     UINT64 sentBytes = 0, receivedBytes = 0;
     UINT64 sentPackets = 0, receivedPackets = 0;
+    UINT64 previousTargetBitrate = 0, targetBitrate = 0;
     INT64 duration = 0;
 
     CHK(pKvsPeerConnection != NULL && pRtcpPacket != NULL, STATUS_NULL_ARG);
-    CHK(pKvsPeerConnection->pTwccManager != NULL && pKvsPeerConnection->onSenderBandwidthEstimation != NULL, STATUS_SUCCESS);
+    CHK(IS_TWCC_FEEDBACK_NEEDED(pKvsPeerConnection), STATUS_SUCCESS);
 
     MUTEX_LOCK(pKvsPeerConnection->twccLock);
     locked = TRUE;
     pTwccManager = pKvsPeerConnection->pTwccManager;
     CHK_STATUS(parseRtcpTwccPacket(pRtcpPacket, pTwccManager));
 
+    if (pKvsPeerConnection->pCongestionController != NULL) {
+        previousTargetBitrate = pKvsPeerConnection->pCongestionController->targetBitrate;
+        CHK_STATUS(updateCongestionController(pTwccManager, pKvsPeerConnection->pCongestionController, &targetBitrate));
+    }
+
     updateTwccHashTable(pTwccManager, &duration, &receivedBytes, &receivedPackets, &sentBytes, &sentPackets);
 
-    if (duration > 0) {
-        MUTEX_UNLOCK(pKvsPeerConnection->twccLock);
-        locked = FALSE;
+    MUTEX_UNLOCK(pKvsPeerConnection->twccLock);
+    locked = FALSE;
+
+    if (targetBitrate != previousTargetBitrate) {
+        DLOGV("Congestion controller target bitrate %" PRIu64 " bps", targetBitrate);
+        if (pKvsPeerConnection->egressBandwidthPeer.pManager != NULL) {
+            // The pacer is set by the manager once the estimate has been shared out
+            CHK_LOG_ERR(egressBandwidthPeerOnEstimate(&pKvsPeerConnection->egressBandwidthPeer, targetBitrate));
+        } else if (pKvsPeerConnection->pPacer != NULL) {
+            CHK_LOG_ERR(pacerSetTargetBitrate(pKvsPeerConnection->pPacer, targetBitrate));
+        }
+        if (pKvsPeerConnection->onTargetBitrate != NULL) {
+            pKvsPeerConnection->onTargetBitrate(pKvsPeerConnection->onTargetBitrateCustomData, targetBitrate);
+        }
+    }
+
+    if (duration > 0 && pKvsPeerConnection->onSenderBandwidthEstimation != NULL) {
         pKvsPeerConnection->onSenderBandwidthEstimation(pKvsPeerConnection->onSenderBandwidthEstimationCustomData, sentBytes, receivedBytes,
                                                         sentPackets, receivedPackets, duration);
     }
@@ -502,6 +692,13 @@ STATUS onRtcpRembPacket(PRtcpPacket pRtcpPacket, PKvsPeerConnection pKvsPeerConn
 
     CHK_STATUS(rembValueGet(pRtcpPacket->payload, pRtcpPacket->payloadLength, &maximumBitRate, (PUINT32) &ssrcList, &ssrcListLen));
 
+    // REMB is the receiver's estimate for the whole session
+    if (pKvsPeerConnection->egressBandwidthPeer.pManager != NULL) {
+        CHK_STATUS(egressBandwidthPeerOnEstimate(&pKvsPeerConnection->egressBandwidthPeer, (UINT64) maximumBitRate));
+    } else if (pKvsPeerConnection->pPacer != NULL) {
+        CHK_STATUS(pacerSetTargetBitrate(pKvsPeerConnection->pPacer, (UINT64) maximumBitRate));
+    }
+
     for (i = 0; i < ssrcListLen; i++) {
         pTransceiver = NULL;
         if (STATUS_FAILED(findTransceiverBySsrc(pKvsPeerConnection, &pTransceiver, ssrcList[i]))) {
@@ -11,8 +11,10 @@ STATUS onRtcpPacket(PKvsPeerConnection, PBYTE, UINT32);
 STATUS onRtcpRembPacket(PRtcpPacket, PKvsPeerConnection);
 STATUS onRtcpPLIPacket(PRtcpPacket, PKvsPeerConnection);
 STATUS parseRtcpTwccPacket(PRtcpPacket, PTwccManager);
+STATUS createRtcpTwccPacket(UINT32, UINT32, UINT16, PUINT64, UINT16, UINT8, PBYTE, PUINT32);
 STATUS onRtcpTwccPacket(PRtcpPacket, PKvsPeerConnection);
 STATUS updateTwccHashTable(PTwccManager, PINT64, PUINT64, PUINT64, PUINT64, PUINT64);
+STATUS updateCongestionController(PTwccManager, PCongestionController, PUINT64);
 
 // https://tools.ietf.org/html/draft-holmer-rmcat-transport-wide-cc-extensions-01
 // Deltas are represented as multiples of 250us:
@@ -38,12 +40,26 @@ typedef enum {
 #define TWCC_RUNLEN_ISRECEIVED(packetChunk)    TWCC_ISRECEIVED(TWCC_RUNLEN_STATUS_SYMBOL(packetChunk))
 #define TWCC_STATUSVECTOR_IS_2BIT(packetChunk) (((packetChunk) >> 14u) & 1u)
 #define TWCC_STATUSVECTOR_SSIZE(packetChunk)   (TWCC_STATUSVECTOR_IS_2BIT(packetChunk) ? 2u : 1u)
-#define TWCC_STATUSVECTOR_SMASK(packetChunk)   (TWCC_STATUSVECTOR_IS_2BIT(packetChunk) ? 2u : 1u)
+#define TWCC_STATUSVECTOR_SMASK(packetChunk)   (TWCC_STATUSVECTOR_IS_2BIT(packetChunk) ? 3u : 1u)
+// The symbols follow the T and S bits, the first one in the most significant bits
 #define TWCC_STATUSVECTOR_STATUS(packetChunk, i)                                                                                                     \
-    (((packetChunk) >> (14u - (i) * TWCC_STATUSVECTOR_SSIZE(packetChunk))) & TWCC_STATUSVECTOR_SMASK(packetChunk))
+    (((packetChunk) >> (14u - ((i) + 1) * TWCC_STATUSVECTOR_SSIZE(packetChunk))) & TWCC_STATUSVECTOR_SMASK(packetChunk))
 #define TWCC_STATUSVECTOR_COUNT(packetChunk) (TWCC_STATUSVECTOR_IS_2BIT(packetChunk) ? 7 : 14)
 #define TWCC_PACKET_STATUS_COUNT(payload)    (getUnalignedInt16BigEndian((payload) + 10))
 
+#define TWCC_RUNLEN_MAX                 0x1fffu
+#define TWCC_STATUSVECTOR_CHUNK         0x8000u
+#define TWCC_STATUSVECTOR_2BIT_CHUNK    0xc000u
+#define TWCC_SMALLDELTA_MAX             0xff
+#define TWCC_TICK_DURATION              (HUNDREDS_OF_NANOS_IN_A_SECOND / TWCC_TICKS_PER_SECOND)
+#define TWCC_REFERENCE_TIME_UNIT        (64 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define TWCC_REFERENCE_TIME_MASK        0xffffffu
+// RTCP header, both SSRCs, base sequence number, packet status count, reference time and feedback packet count
+#define TWCC_FB_HEADER_LEN              20
+// A status takes at most a 2 byte chunk of its own and a 2 byte delta, the biggest feedback packet stays within the MTU
+#define TWCC_FB_MAX_PACKET_STATUS_COUNT 256
+#define TWCC_FB_MAX_PACKET_LEN          (TWCC_FB_HEADER_LEN + 4 * TWCC_FB_MAX_PACKET_STATUS_COUNT)
+
 #ifdef __cplusplus
 }
 #endif
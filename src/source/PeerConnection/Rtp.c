@@ -2,8 +2,6 @@
 
 #include "../Include_i.h"
 
-typedef STATUS (*RtpPayloadFunc)(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
-
 STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION direction, PKvsPeerConnection pKvsPeerConnection, UINT32 ssrc, UINT32 rtxSsrc,
                                PRtcMediaStreamTrack pRtcMediaStreamTrack, PJitterBuffer pJitterBuffer, RTC_CODEC rtcCodec,
                                PKvsRtpTransceiver* ppKvsRtpTransceiver)
@@ -36,6 +34,15 @@ STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION direction, PKvsPeer
             MAX_STATS_STRING_LENGTH);
     STRNCPY(pKvsRtpTransceiver->outboundStats.trackId, pRtcMediaStreamTrack->trackId, MAX_STATS_STRING_LENGTH);
 
+    pKvsRtpTransceiver->egressBandwidthFlow.weight = EGRESS_BANDWIDTH_DEFAULT_WEIGHT;
+    pKvsRtpTransceiver->egressBandwidthFlow.maxBitrate =
+        pRtcMediaStreamTrack->kind == MEDIA_STREAM_TRACK_KIND_AUDIO ? EGRESS_BANDWIDTH_DEFAULT_AUDIO_MAX_BITRATE : 0;
+    if (pKvsPeerConnection->egressBandwidthPeer.pManager != NULL &&
+        (direction == RTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV || direction == RTC_RTP_TRANSCEIVER_DIRECTION_SENDONLY)) {
+        CHK_STATUS(egressBandwidthPeerAddFlow(&pKvsPeerConnection->egressBandwidthPeer, &pKvsRtpTransceiver->egressBandwidthFlow,
+                                              pKvsRtpTransceiver->egressBandwidthFlow.weight, pKvsRtpTransceiver->egressBandwidthFlow.maxBitrate));
+    }
+
 CleanUp:
 
     if (STATUS_FAILED(retStatus)) {
@@ -140,6 +147,13 @@ STATUS freeKvsRtpTransceiver(PKvsRtpTransceiver* ppKvsRtpTransceiver)
     // free is idempotent
     CHK(pKvsRtpTransceiver != NULL, retStatus);
 
+    // No target is given to the transceiver once this returns
+    CHK_LOG_ERR(egressBandwidthFlowRemove(&pKvsRtpTransceiver->egressBandwidthFlow));
+
+    freeNackGenerator(&pKvsRtpTransceiver->pNackGenerator);
+    freeFecDecoder(&pKvsRtpTransceiver->pFecDecoder);
+    freeFecEncoder(&pKvsRtpTransceiver->sender.pFecEncoder);
+
     if (pKvsRtpTransceiver->pJitterBuffer != NULL) {
         freeJitterBuffer(&pKvsRtpTransceiver->pJitterBuffer);
     }
@@ -198,6 +212,108 @@ CleanUp:
     return retStatus;
 }
 
+STATUS transceiverOnFrameSlices(PRtcRtpTransceiver pRtcRtpTransceiver, UINT64 customData, RtcOnFrameSlices rtcOnFrameSlices)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+
+    CHK(pKvsRtpTransceiver != NULL && rtcOnFrameSlices != NULL, STATUS_NULL_ARG);
+
+    pKvsRtpTransceiver->onFrameSlices = rtcOnFrameSlices;
+    pKvsRtpTransceiver->onFrameSlicesCustomData = customData;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS createKvsFrameSlices(PJitterBuffer pJitterBuffer, DepayRtpPayloadSlicesFunc depaySlicesFn, UINT16 startIndex, UINT16 endIndex,
+                            PKvsFrameSlices* ppKvsFrameSlices)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsFrameSlices pKvsFrameSlices = NULL;
+    PRtcFrameSlices pFrameSlices;
+    PRtpPacket pRtpPacket = NULL;
+    UINT32 i, packetCount, sliceCount = 0, packetSliceCount;
+    UINT16 index;
+
+    CHK(pJitterBuffer != NULL && depaySlicesFn != NULL && ppKvsFrameSlices != NULL, STATUS_NULL_ARG);
+    packetCount = (UINT32) (UINT16) (endIndex - startIndex) + 1;
+
+    // Count the slices first so that the frame is a single allocation, padding has none
+    for (i = 0, index = startIndex; i < packetCount; i++, index++) {
+        CHK_STATUS(jitterBufferGetPacket(pJitterBuffer, index, &pRtpPacket));
+        if (pRtpPacket == NULL) {
+            continue;
+        }
+        packetSliceCount = 0;
+        CHK_STATUS(depaySlicesFn(pRtpPacket->payload, pRtpPacket->payloadLength, NULL, &packetSliceCount));
+        sliceCount += packetSliceCount;
+    }
+
+    pKvsFrameSlices =
+        (PKvsFrameSlices) MEMCALLOC(1, SIZEOF(KvsFrameSlices) + packetCount * SIZEOF(PRtpPacket) + sliceCount * SIZEOF(RtcFrameSlice));
+    CHK(pKvsFrameSlices != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pKvsFrameSlices->pPackets = (PRtpPacket*) (pKvsFrameSlices + 1);
+    pFrameSlices = &pKvsFrameSlices->frameSlices;
+    pFrameSlices->version = RTC_FRAME_SLICES_CURRENT_VERSION;
+    pFrameSlices->pSlices = (PRtcFrameSlice) (pKvsFrameSlices->pPackets + packetCount);
+
+    for (i = 0, index = startIndex; i < packetCount; i++, index++) {
+        CHK_STATUS(jitterBufferTakePacket(pJitterBuffer, index, &pRtpPacket));
+        if (pRtpPacket == NULL) {
+            continue;
+        }
+        pKvsFrameSlices->pPackets[pKvsFrameSlices->packetCount++] = pRtpPacket;
+        packetSliceCount = sliceCount - pFrameSlices->sliceCount;
+        CHK_STATUS(depaySlicesFn(pRtpPacket->payload, pRtpPacket->payloadLength, pFrameSlices->pSlices + pFrameSlices->sliceCount,
+                                 &packetSliceCount));
+        pFrameSlices->sliceCount += packetSliceCount;
+    }
+
+    for (i = 0; i < pFrameSlices->sliceCount; i++) {
+        pFrameSlices->size += pFrameSlices->pSlices[i].size;
+    }
+
+    *ppKvsFrameSlices = pKvsFrameSlices;
+    pKvsFrameSlices = NULL;
+
+CleanUp:
+    if (pKvsFrameSlices != NULL) {
+        pFrameSlices = &pKvsFrameSlices->frameSlices;
+        releaseFrameSlices(&pFrameSlices);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS releaseFrameSlices(PRtcFrameSlices* ppRtcFrameSlices)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsFrameSlices pKvsFrameSlices = NULL;
+    UINT32 i;
+
+    CHK(ppRtcFrameSlices != NULL, STATUS_NULL_ARG);
+    pKvsFrameSlices = (PKvsFrameSlices) *ppRtcFrameSlices;
+    CHK(pKvsFrameSlices != NULL, retStatus);
+
+    for (i = 0; i < pKvsFrameSlices->packetCount; i++) {
+        freeRtpPacket(&pKvsFrameSlices->pPackets[i]);
+    }
+    SAFE_MEMFREE(pKvsFrameSlices);
+    *ppRtcFrameSlices = NULL;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS transceiverOnBandwidthEstimation(PRtcRtpTransceiver pRtcRtpTransceiver, UINT64 customData, RtcOnBandwidthEstimation rtcOnBandwidthEstimation)
 {
     ENTERS();
@@ -215,6 +331,38 @@ CleanUp:
     return retStatus;
 }
 
+STATUS transceiverOnTargetBitrate(PRtcRtpTransceiver pRtcRtpTransceiver, UINT64 customData, RtcOnTargetBitrate onTargetBitrate)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+
+    CHK(pKvsRtpTransceiver != NULL && onTargetBitrate != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(egressBandwidthFlowSetCallback(&pKvsRtpTransceiver->egressBandwidthFlow, customData, onTargetBitrate));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS transceiverSetEgressBandwidthShare(PRtcRtpTransceiver pRtcRtpTransceiver, UINT32 weight, UINT64 maxBitrate)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+
+    CHK(pKvsRtpTransceiver != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(egressBandwidthFlowSetShare(&pKvsRtpTransceiver->egressBandwidthFlow, weight, maxBitrate));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS transceiverOnPictureLoss(PRtcRtpTransceiver pRtcRtpTransceiver, UINT64 customData, RtcOnPictureLoss onPictureLoss)
 {
     ENTERS();
@@ -259,15 +407,109 @@ CleanUp:
     return retStatus;
 }
 
+STATUS getRtpPayloadFunc(RTC_CODEC codec, UINT64 presentationTs, RtpPayloadFunc* pRtpPayloadFunc, PUINT64 pRtpTimestamp)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pRtpPayloadFunc != NULL && pRtpTimestamp != NULL, STATUS_NULL_ARG);
+
+    switch (codec) {
+        case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
+            *pRtpPayloadFunc = createPayloadForH264;
+            *pRtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, presentationTs);
+            break;
+
+        case RTC_CODEC_H265:
+            *pRtpPayloadFunc = createPayloadForH265;
+            *pRtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, presentationTs);
+            break;
+
+        case RTC_CODEC_OPUS:
+            *pRtpPayloadFunc = createPayloadForOpus;
+            *pRtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(OPUS_CLOCKRATE, presentationTs);
+            break;
+
+        case RTC_CODEC_MULAW:
+        case RTC_CODEC_ALAW:
+            *pRtpPayloadFunc = createPayloadForG711;
+            *pRtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(PCM_CLOCKRATE, presentationTs);
+            break;
+
+        case RTC_CODEC_VP8:
+            *pRtpPayloadFunc = createPayloadForVP8;
+            *pRtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, presentationTs);
+            break;
+
+        default:
+            CHK(FALSE, STATUS_NOT_IMPLEMENTED);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS packetizeFrame(RtpPayloadFunc rtpPayloadFunc, UINT32 mtu, PFrame pFrame, PPayloadArray pPayloadArray)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(rtpPayloadFunc != NULL && pFrame != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(rtpPayloadFunc(mtu, (PBYTE) pFrame->frameData, pFrame->size, NULL, &(pPayloadArray->payloadLength), NULL,
+                              &(pPayloadArray->payloadSubLenSize)));
+    if (pPayloadArray->payloadLength > pPayloadArray->maxPayloadLength) {
+        SAFE_MEMFREE(pPayloadArray->payloadBuffer);
+        pPayloadArray->maxPayloadLength = 0;
+        pPayloadArray->payloadBuffer = (PBYTE) MEMALLOC(pPayloadArray->payloadLength);
+        CHK(pPayloadArray->payloadBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pPayloadArray->maxPayloadLength = pPayloadArray->payloadLength;
+    }
+    if (pPayloadArray->payloadSubLenSize > pPayloadArray->maxPayloadSubLenSize) {
+        SAFE_MEMFREE(pPayloadArray->payloadSubLength);
+        pPayloadArray->maxPayloadSubLenSize = 0;
+        pPayloadArray->payloadSubLength = (PUINT32) MEMALLOC(pPayloadArray->payloadSubLenSize * SIZEOF(UINT32));
+        CHK(pPayloadArray->payloadSubLength != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pPayloadArray->maxPayloadSubLenSize = pPayloadArray->payloadSubLenSize;
+    }
+    CHK_STATUS(rtpPayloadFunc(mtu, (PBYTE) pFrame->frameData, pFrame->size, pPayloadArray->payloadBuffer, &(pPayloadArray->payloadLength),
+                              pPayloadArray->payloadSubLength, &(pPayloadArray->payloadSubLenSize)));
+
+CleanUp:
+
+    return retStatus;
+}
+
+UINT32 getPayloadMtu(PKvsRtpTransceiver pKvsRtpTransceiver)
+{
+    PKvsPeerConnection pKvsPeerConnection = pKvsRtpTransceiver->pKvsPeerConnection;
+    UINT32 overhead = 0;
+
+    if (pKvsRtpTransceiver->sender.pFecEncoder != NULL && pKvsPeerConnection->ulpfecPayloadType != 0) {
+        overhead = FEC_PACKET_OVERHEAD + (pKvsPeerConnection->twccExtId != 0 ? TWCC_EXT_LENGTH : 0);
+    }
+
+    return pKvsPeerConnection->MTU > overhead ? pKvsPeerConnection->MTU - overhead : 0;
+}
+
 STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
+{
+    return writeFramePayload((PKvsRtpTransceiver) pRtcRtpTransceiver, pFrame, NULL);
+}
+
+STATUS writeFramePayload(PKvsRtpTransceiver pKvsRtpTransceiver, PFrame pFrame, PPayloadArray pSharedPayloadArray)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PKvsPeerConnection pKvsPeerConnection = NULL;
-    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
-    BOOL locked = FALSE, bufferAfterEncrypt = FALSE;
+    BOOL locked = FALSE, bufferAfterEncrypt = FALSE, isMediaPacket;
     PRtpPacket pPacketList = NULL, pRtpPacket = NULL;
-    UINT32 i = 0, packetLen = 0, headerLen = 0, allocSize;
-    PBYTE rawPacket = NULL;
+    UINT32 i = 0, packetLen = 0, headerLen = 0, allocSize, packetCount = 0, sendBufferSize = 0, sendBufferOffset = 0;
+    UINT32 mediaPacketCount = 0, packetCapacity = 0, fecPacketCount = 0, redLength = 0;
+    PFecEncoder pFecEncoder = NULL;
+    PBYTE rawPacket = NULL, pSendBuffer = NULL;
+    PBYTE* ppRawPackets = NULL;
+    PRtpPacketBuffer* ppPacketBuffers = NULL;
+    PRtpPacketBuffer pPacedPacketBuffer = NULL;
+    PUINT32 pRawPacketLengths = NULL, pTwccExtPayloads = NULL;
     PPayloadArray pPayloadArray = NULL;
     RtpPayloadFunc rtpPayloadFunc = NULL;
     UINT64 randomRtpTimeoffset = 0; // TODO: spec requires random rtp time offset
@@ -277,18 +519,20 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
     // stats updates
     DOUBLE fps = 0.0;
     UINT32 frames = 0, keyframes = 0, bytesSent = 0, packetsSent = 0, headerBytesSent = 0, framesSent = 0;
-    UINT32 packetsDiscardedOnSend = 0, bytesDiscardedOnSend = 0, framesDiscardedOnSend = 0;
+    UINT32 packetsDiscardedOnSend = 0, bytesDiscardedOnSend = 0, framesDiscardedOnSend = 0, fecPacketsSent = 0;
     UINT64 lastPacketSentTimestamp = 0;
+    UINT32 pacedPacketCount = 0;
+    PACER_PRIORITY priority;
+    SOCKET_EGRESS_PRIORITY egressPriority;
 
     // temp vars :(
     UINT64 tmpFrames, tmpTime;
     UINT16 twsn;
-    UINT32 extpayload;
+    UINT64 sentTime;
     STATUS sendStatus;
 
     CHK(pKvsRtpTransceiver != NULL && pFrame != NULL, STATUS_NULL_ARG);
     pKvsPeerConnection = pKvsRtpTransceiver->pKvsPeerConnection;
-    pPayloadArray = &(pKvsRtpTransceiver->sender.payloadArray);
     if (MEDIA_STREAM_TRACK_KIND_VIDEO == pKvsRtpTransceiver->sender.track.kind) {
         frames++;
         if (0 != (pFrame->flags & FRAME_FLAG_KEY_FRAME)) {
@@ -307,113 +551,188 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
     MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
     locked = TRUE;
     CHK(pKvsPeerConnection->pSrtpSession != NULL, STATUS_SRTP_NOT_READY_YET); // Discard packets till SRTP is ready
-    switch (pKvsRtpTransceiver->sender.track.codec) {
-        case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
-            rtpPayloadFunc = createPayloadForH264;
-            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
-            break;
-
-        case RTC_CODEC_H265:
-            rtpPayloadFunc = createPayloadForH265;
-            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
-            break;
-
-        case RTC_CODEC_OPUS:
-            rtpPayloadFunc = createPayloadForOpus;
-            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(OPUS_CLOCKRATE, pFrame->presentationTs);
-            break;
-
-        case RTC_CODEC_MULAW:
-        case RTC_CODEC_ALAW:
-            rtpPayloadFunc = createPayloadForG711;
-            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(PCM_CLOCKRATE, pFrame->presentationTs);
-            break;
-
-        case RTC_CODEC_VP8:
-            rtpPayloadFunc = createPayloadForVP8;
-            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
-            break;
-
-        default:
-            CHK(FALSE, STATUS_NOT_IMPLEMENTED);
-    }
-
+    CHK_STATUS(getRtpPayloadFunc(pKvsRtpTransceiver->sender.track.codec, pFrame->presentationTs, &rtpPayloadFunc, &rtpTimestamp));
     rtpTimestamp += randomRtpTimeoffset;
 
-    CHK_STATUS(rtpPayloadFunc(pKvsPeerConnection->MTU, (PBYTE) pFrame->frameData, pFrame->size, NULL, &(pPayloadArray->payloadLength), NULL,
-                              &(pPayloadArray->payloadSubLenSize)));
-    if (pPayloadArray->payloadLength > pPayloadArray->maxPayloadLength) {
-        SAFE_MEMFREE(pPayloadArray->payloadBuffer);
-        pPayloadArray->payloadBuffer = (PBYTE) MEMALLOC(pPayloadArray->payloadLength);
-        pPayloadArray->maxPayloadLength = pPayloadArray->payloadLength;
+    if (pSharedPayloadArray == NULL) {
+        pPayloadArray = &(pKvsRtpTransceiver->sender.payloadArray);
+        CHK_STATUS(packetizeFrame(rtpPayloadFunc, getPayloadMtu(pKvsRtpTransceiver), pFrame, pPayloadArray));
+    } else {
+        // Already packetized once for every member of a broadcast group, only the headers are specific to this transceiver
+        pPayloadArray = pSharedPayloadArray;
     }
-    if (pPayloadArray->payloadSubLenSize > pPayloadArray->maxPayloadSubLenSize) {
-        SAFE_MEMFREE(pPayloadArray->payloadSubLength);
-        pPayloadArray->payloadSubLength = (PUINT32) MEMALLOC(pPayloadArray->payloadSubLenSize * SIZEOF(UINT32));
-        pPayloadArray->maxPayloadSubLenSize = pPayloadArray->payloadSubLenSize;
+
+    // Once ULPFEC is negotiated the media packets go out in RED, followed by the FEC packets of the groups they close. There
+    // are never more FEC packets than media packets in a group, including the packets of earlier frames still in the current one.
+    if (pKvsRtpTransceiver->sender.pFecEncoder != NULL && pKvsPeerConnection->ulpfecPayloadType != 0) {
+        pFecEncoder = pKvsRtpTransceiver->sender.pFecEncoder;
+        redLength = RED_PRIMARY_HEADER_LENGTH;
     }
-    CHK_STATUS(rtpPayloadFunc(pKvsPeerConnection->MTU, (PBYTE) pFrame->frameData, pFrame->size, pPayloadArray->payloadBuffer,
-                              &(pPayloadArray->payloadLength), pPayloadArray->payloadSubLength, &(pPayloadArray->payloadSubLenSize)));
-    pPacketList = (PRtpPacket) MEMALLOC(pPayloadArray->payloadSubLenSize * SIZEOF(RtpPacket));
+    mediaPacketCount = pPayloadArray->payloadSubLenSize;
+    packetCapacity = mediaPacketCount + (pFecEncoder != NULL ? mediaPacketCount + pFecEncoder->groupSize : 0);
+
+    pPacketList = (PRtpPacket) MEMALLOC(packetCapacity * SIZEOF(RtpPacket));
 
     CHK_STATUS(constructRtpPackets(pPayloadArray, pKvsRtpTransceiver->sender.payloadType, pKvsRtpTransceiver->sender.sequenceNumber, rtpTimestamp,
                                    pKvsRtpTransceiver->sender.ssrc, pPacketList, pPayloadArray->payloadSubLenSize));
     pKvsRtpTransceiver->sender.sequenceNumber = GET_UINT16_SEQ_NUM(pKvsRtpTransceiver->sender.sequenceNumber + pPayloadArray->payloadSubLenSize);
 
     bufferAfterEncrypt = (pKvsRtpTransceiver->sender.payloadType == pKvsRtpTransceiver->sender.rtxPayloadType);
-    for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
+    packetCount = mediaPacketCount;
+
+    // The packet buffers of the frame, the encrypted bytes to send, their lengths and TWCC extension payloads. Packets are
+    // kept until the whole frame has been handed to the ICE agent in a single batch.
+    allocSize = packetCapacity * (SIZEOF(PRtpPacketBuffer) + SIZEOF(PBYTE) + SIZEOF(UINT32) + SIZEOF(UINT32));
+    CHK(packetCapacity == 0 || NULL != (ppPacketBuffers = (PRtpPacketBuffer*) MEMCALLOC(1, allocSize)), STATUS_NOT_ENOUGH_MEMORY);
+    ppRawPackets = (PBYTE*) (ppPacketBuffers + packetCapacity);
+    pRawPacketLengths = (PUINT32) (ppRawPackets + packetCapacity);
+    pTwccExtPayloads = pRawPacketLengths + packetCapacity;
+
+    for (i = 0; i < packetCount; i++) {
         pRtpPacket = pPacketList + i;
         if (pKvsRtpTransceiver->pKvsPeerConnection->twccExtId != 0) {
             pRtpPacket->header.extension = TRUE;
             pRtpPacket->header.extensionProfile = TWCC_EXT_PROFILE;
             pRtpPacket->header.extensionLength = SIZEOF(UINT32);
             twsn = (UINT16) ATOMIC_INCREMENT(&pKvsRtpTransceiver->pKvsPeerConnection->transportWideSequenceNumber);
-            extpayload = TWCC_PAYLOAD(pKvsRtpTransceiver->pKvsPeerConnection->twccExtId, twsn);
-            pRtpPacket->header.extensionPayload = (PBYTE) &extpayload;
+            pTwccExtPayloads[i] = TWCC_PAYLOAD(pKvsRtpTransceiver->pKvsPeerConnection->twccExtId, twsn);
+            pRtpPacket->header.extensionPayload = (PBYTE) &pTwccExtPayloads[i];
         }
-        // Get the required size first
-        CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, NULL, &packetLen));
-
-        // Account for SRTP authentication tag
-        allocSize = packetLen + SRTP_AUTH_TAG_OVERHEAD;
-        CHK(NULL != (rawPacket = (PBYTE) MEMALLOC(allocSize)), STATUS_NOT_ENOUGH_MEMORY);
-        CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, rawPacket, &packetLen));
-
-        if (!bufferAfterEncrypt) {
-            pRtpPacket->pRawPacket = rawPacket;
-            pRtpPacket->rawPacketLength = packetLen;
-            CHK_STATUS(rtpRollingBufferAddRtpPacket(pKvsRtpTransceiver->sender.packetBuffer, pRtpPacket));
+        sendBufferSize += RTP_GET_RAW_PACKET_SIZE(pRtpPacket) + SRTP_AUTH_TAG_OVERHEAD + (i < mediaPacketCount ? redLength : 0);
+
+        // The media packets are final once they all have their extension, the FEC packets are appended and go through the same loop
+        if (pFecEncoder != NULL && i + 1 == mediaPacketCount) {
+            CHK_STATUS(appendFecRtpPackets(pKvsRtpTransceiver, pPacketList, mediaPacketCount, (UINT32) rtpTimestamp, &fecPacketCount));
+            packetCount += fecPacketCount;
         }
+    }
 
-        CHK_STATUS(encryptRtpPacket(pKvsPeerConnection->pSrtpSession, rawPacket, (PINT32) &packetLen));
-        sendStatus = iceAgentSendPacket(pKvsPeerConnection->pIceAgent, rawPacket, packetLen);
-        if (sendStatus == STATUS_SEND_DATA_FAILED) {
-            packetsDiscardedOnSend++;
-            bytesDiscardedOnSend += packetLen - headerLen;
-            // TODO is frame considered discarded when at least one of its packets is discarded or all of its packets discarded?
-            framesDiscardedOnSend = 1;
-            SAFE_MEMFREE(rawPacket);
-            continue;
-        } else if (sendStatus == STATUS_SUCCESS && pKvsRtpTransceiver->pKvsPeerConnection->twccExtId != 0) {
-            pRtpPacket->sentTime = GETTIME();
-            twccManagerOnPacketSent(pKvsPeerConnection, pRtpPacket);
+    if (pKvsPeerConnection->pPacer != NULL) {
+        // Packets are handed to the pacer, which sends them and accounts for them later on
+        priority = MEDIA_STREAM_TRACK_KIND_AUDIO == pKvsRtpTransceiver->sender.track.kind ? PACER_PRIORITY_AUDIO : PACER_PRIORITY_VIDEO;
+        for (i = 0; i < packetCount; i++) {
+            pRtpPacket = pPacketList + i;
+            isMediaPacket = i < mediaPacketCount;
+            packetLen = RTP_GET_RAW_PACKET_SIZE(pRtpPacket);
+            headerLen = RTP_HEADER_LEN(pRtpPacket);
+            CHK_STATUS(createRtpPacketBuffer(0, packetLen, SRTP_AUTH_TAG_OVERHEAD + redLength, &ppPacketBuffers[i]));
+            CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, ppPacketBuffers[i]->packet.pRawPacket, &packetLen));
+
+            if (!isMediaPacket) {
+                // FEC packets are not retransmitted
+                CHK_STATUS(rtpPacketBufferSetLength(ppPacketBuffers[i], packetLen));
+                CHK_STATUS(writePacedRtpPacket(pKvsRtpTransceiver, ppPacketBuffers[i], TRUE, priority));
+                fecPacketsSent++;
+            } else if (bufferAfterEncrypt) {
+                if (redLength > 0) {
+                    CHK_STATUS(redEncapsulateRtpPacket(ppPacketBuffers[i]->packet.pRawPacket, headerLen, &packetLen,
+                                                       pKvsPeerConnection->redPayloadType));
+                }
+                CHK_STATUS(rtpPacketBufferSetLength(ppPacketBuffers[i], packetLen));
+                CHK_STATUS(writePacedRtpPacket(pKvsRtpTransceiver, ppPacketBuffers[i], TRUE, priority));
+                CHK_STATUS(rtpRollingBufferAddRtpPacketBuffer(pKvsRtpTransceiver->sender.packetBuffer, ppPacketBuffers[i]));
+            } else {
+                // The rolling buffer keeps the packet in the clear for RTX, an encrypted copy is queued instead
+                CHK_STATUS(rtpPacketBufferSetLength(ppPacketBuffers[i], packetLen));
+                CHK_STATUS(rtpRollingBufferAddRtpPacketBuffer(pKvsRtpTransceiver->sender.packetBuffer, ppPacketBuffers[i]));
+                CHK_STATUS(createRtpPacketBuffer(0, packetLen, SRTP_AUTH_TAG_OVERHEAD + redLength, &pPacedPacketBuffer));
+                MEMCPY(pPacedPacketBuffer->packet.pRawPacket, ppPacketBuffers[i]->packet.pRawPacket, packetLen);
+                if (redLength > 0) {
+                    CHK_STATUS(redEncapsulateRtpPacket(pPacedPacketBuffer->packet.pRawPacket, headerLen, &packetLen,
+                                                       pKvsPeerConnection->redPayloadType));
+                }
+                CHK_STATUS(rtpPacketBufferSetLength(pPacedPacketBuffer, packetLen));
+                CHK_STATUS(writePacedRtpPacket(pKvsRtpTransceiver, pPacedPacketBuffer, TRUE, priority));
+                rtpPacketBufferRelease(&pPacedPacketBuffer);
+            }
+            pacedPacketCount++;
         }
-        CHK_STATUS(sendStatus);
-        if (bufferAfterEncrypt) {
-            pRtpPacket->pRawPacket = rawPacket;
-            pRtpPacket->rawPacketLength = packetLen;
-            CHK_STATUS(rtpRollingBufferAddRtpPacket(pKvsRtpTransceiver->sender.packetBuffer, pRtpPacket));
+    } else {
+        // With RTX the rolling buffer keeps the packets in the clear, so the frame is encrypted into one scratch buffer instead
+        if (!bufferAfterEncrypt && packetCount > 0) {
+            CHK(NULL != (pSendBuffer = (PBYTE) MEMALLOC(sendBufferSize)), STATUS_NOT_ENOUGH_MEMORY);
         }
 
-        // https://tools.ietf.org/html/rfc3550#section-6.4.1
-        // The total number of payload octets (i.e., not including header or padding) transmitted in RTP data packets by the sender
-        headerLen = RTP_HEADER_LEN(pRtpPacket);
-        bytesSent += packetLen - headerLen;
-        packetsSent++;
-        lastPacketSentTimestamp = KVS_CONVERT_TIMESCALE(GETTIME(), HUNDREDS_OF_NANOS_IN_A_SECOND, 1000);
-        headerBytesSent += headerLen;
+        for (i = 0; i < packetCount; i++) {
+            pRtpPacket = pPacketList + i;
+            isMediaPacket = i < mediaPacketCount;
+
+            // Single allocation per packet, with room for the SRTP authentication tag. It is shared with the rolling buffer
+            packetLen = RTP_GET_RAW_PACKET_SIZE(pRtpPacket);
+            CHK_STATUS(createRtpPacketBuffer(0, packetLen, SRTP_AUTH_TAG_OVERHEAD + redLength, &ppPacketBuffers[i]));
+            rawPacket = ppPacketBuffers[i]->packet.pRawPacket;
+            CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, rawPacket, &packetLen));
+
+            if (!bufferAfterEncrypt) {
+                CHK_STATUS(rtpPacketBufferSetLength(ppPacketBuffers[i], packetLen));
+                if (isMediaPacket) {
+                    CHK_STATUS(rtpRollingBufferAddRtpPacketBuffer(pKvsRtpTransceiver->sender.packetBuffer, ppPacketBuffers[i]));
+                }
+                rawPacket = pSendBuffer + sendBufferOffset;
+                MEMCPY(rawPacket, ppPacketBuffers[i]->packet.pRawPacket, packetLen);
+            }
+
+            // The FEC packets are in RED already, and the rolling buffer keeps the media packets in the clear for RTX
+            if (isMediaPacket && redLength > 0) {
+                CHK_STATUS(redEncapsulateRtpPacket(rawPacket, RTP_HEADER_LEN(pRtpPacket), &packetLen, pKvsPeerConnection->redPayloadType));
+            }
+            if (!bufferAfterEncrypt) {
+                sendBufferOffset += packetLen + SRTP_AUTH_TAG_OVERHEAD;
+            }
+
+            CHK_STATUS(encryptRtpPacket(pKvsPeerConnection->pSrtpSession, rawPacket, (PINT32) &packetLen));
+            if (bufferAfterEncrypt) {
+                CHK_STATUS(rtpPacketBufferSetLength(ppPacketBuffers[i], packetLen));
+            }
+            ppRawPackets[i] = rawPacket;
+            pRawPacketLengths[i] = packetLen;
+        }
 
-        SAFE_MEMFREE(rawPacket);
+        // Should the socket have to queue, the delta frames of a video track go first. Only key frames are known to be referenced.
+        if (MEDIA_STREAM_TRACK_KIND_AUDIO == pKvsRtpTransceiver->sender.track.kind) {
+            egressPriority = SOCKET_EGRESS_PRIORITY_AUDIO;
+        } else {
+            egressPriority = 0 != (pFrame->flags & FRAME_FLAG_KEY_FRAME) ? SOCKET_EGRESS_PRIORITY_VIDEO : SOCKET_EGRESS_PRIORITY_DISCARDABLE_VIDEO;
+        }
+
+        // A single pass over the agent and socket locks and as few syscalls as the socket allows for the whole frame
+        sendStatus = packetCount == 0
+            ? STATUS_SUCCESS
+            : iceAgentSendPacketBatch(pKvsPeerConnection->pIceAgent, ppRawPackets, pRawPacketLengths, packetCount, egressPriority);
+        sentTime = GETTIME();
+
+        for (i = 0; i < packetCount; i++) {
+            pRtpPacket = pPacketList + i;
+            rawPacket = ppRawPackets[i];
+            packetLen = pRawPacketLengths[i];
+            headerLen = RTP_HEADER_LEN(pRtpPacket);
+            if (sendStatus == STATUS_SEND_DATA_FAILED) {
+                packetsDiscardedOnSend++;
+                bytesDiscardedOnSend += packetLen - headerLen;
+                // TODO is frame considered discarded when at least one of its packets is discarded or all of its packets discarded?
+                framesDiscardedOnSend = 1;
+                continue;
+            } else if (sendStatus == STATUS_SUCCESS && pKvsRtpTransceiver->pKvsPeerConnection->twccExtId != 0) {
+                pRtpPacket->sentTime = sentTime;
+                twccManagerOnPacketSent(pKvsPeerConnection, pRtpPacket);
+            }
+            CHK_STATUS(sendStatus);
+            if (i >= mediaPacketCount) {
+                fecPacketsSent++;
+            } else if (bufferAfterEncrypt) {
+                CHK_STATUS(rtpRollingBufferAddRtpPacketBuffer(pKvsRtpTransceiver->sender.packetBuffer, ppPacketBuffers[i]));
+            }
+
+            // https://tools.ietf.org/html/rfc3550#section-6.4.1
+            // The total number of payload octets (i.e., not including header or padding) transmitted in RTP data packets by the sender
+            bytesSent += packetLen - headerLen;
+            packetsSent++;
+            headerBytesSent += headerLen;
+        }
+    }
+
+    if (packetsSent > 0) {
+        lastPacketSentTimestamp = KVS_CONVERT_TIMESCALE(sentTime, HUNDREDS_OF_NANOS_IN_A_SECOND, 1000);
     }
 
     if (MEDIA_STREAM_TRACK_KIND_VIDEO == pKvsRtpTransceiver->sender.track.kind) {
@@ -440,6 +759,7 @@ CleanUp:
     pKvsRtpTransceiver->sender.lastKnownFrameCount = pKvsRtpTransceiver->outboundStats.framesEncoded;
     pKvsRtpTransceiver->outboundStats.sent.bytesSent += bytesSent;
     pKvsRtpTransceiver->outboundStats.sent.packetsSent += packetsSent;
+    pKvsRtpTransceiver->outboundStats.fecPacketsSent += fecPacketsSent;
     if (lastPacketSentTimestamp > 0) {
         pKvsRtpTransceiver->outboundStats.lastPacketSentTimestamp = lastPacketSentTimestamp;
     }
@@ -451,16 +771,26 @@ CleanUp:
             pKvsRtpTransceiver->outboundStats.hugeFramesSent++;
         }
     }
-    // iceAgentSendPacket tries to send packet immediately, explicitly settings totalPacketSendDelay to 0
-    pKvsRtpTransceiver->outboundStats.totalPacketSendDelay = 0;
-
     pKvsRtpTransceiver->outboundStats.framesDiscardedOnSend += framesDiscardedOnSend;
     pKvsRtpTransceiver->outboundStats.packetsDiscardedOnSend += packetsDiscardedOnSend;
     pKvsRtpTransceiver->outboundStats.bytesDiscardedOnSend += bytesDiscardedOnSend;
     MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
 
-    SAFE_MEMFREE(rawPacket);
+    if (ppPacketBuffers != NULL) {
+        // The rolling buffer holds its own references
+        for (i = 0; i < packetCount; i++) {
+            rtpPacketBufferRelease(&ppPacketBuffers[i]);
+        }
+        SAFE_MEMFREE(ppPacketBuffers);
+    }
+    rtpPacketBufferRelease(&pPacedPacketBuffer);
+    SAFE_MEMFREE(pSendBuffer);
     SAFE_MEMFREE(pPacketList);
+
+    // Outside of the SRTP session lock, audio and whatever the budget allows leave right away
+    if (pacedPacketCount > 0) {
+        pacerProcess(pKvsPeerConnection->pPacer);
+    }
     if (retStatus != STATUS_SRTP_NOT_READY_YET) {
         CHK_LOG_ERR(retStatus);
     }
@@ -468,29 +798,185 @@ CleanUp:
     return retStatus;
 }
 
-STATUS writeRtpPacket(PKvsPeerConnection pKvsPeerConnection, PRtpPacket pRtpPacket)
+STATUS appendFecRtpPackets(PKvsRtpTransceiver pKvsRtpTransceiver, PRtpPacket pPacketList, UINT32 mediaPacketCount, UINT32 rtpTimestamp,
+                           PUINT32 pFecPacketCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PFecEncoder pFecEncoder;
+    PBYTE pPayload;
+    UINT32 i;
+
+    CHK(pKvsRtpTransceiver != NULL && pPacketList != NULL && pFecPacketCount != NULL, STATUS_NULL_ARG);
+    pFecEncoder = pKvsRtpTransceiver->sender.pFecEncoder;
+    *pFecPacketCount = 0;
+
+    CHK_STATUS(fecEncoderProtect(pFecEncoder, pPacketList, mediaPacketCount));
+
+    // Same stream as the media, the FEC payloads are wrapped in RED in the room the encoder left in front of them
+    for (i = 0; i < pFecEncoder->fecPacketCount; i++) {
+        pPayload = pFecEncoder->pFecPayloads + i * FEC_ENCODER_PAYLOAD_SLOT_LENGTH;
+        pPayload[0] = pKvsRtpTransceiver->pKvsPeerConnection->ulpfecPayloadType;
+        CHK_STATUS(setRtpPacket(2, FALSE, FALSE, 0, FALSE, pKvsRtpTransceiver->pKvsPeerConnection->redPayloadType,
+                                pKvsRtpTransceiver->sender.sequenceNumber, rtpTimestamp, pKvsRtpTransceiver->sender.ssrc, NULL, 0, 0, NULL,
+                                pPayload, RED_PRIMARY_HEADER_LENGTH + pFecEncoder->fecPayloadLengths[i], pPacketList + mediaPacketCount + i));
+        pKvsRtpTransceiver->sender.sequenceNumber = GET_UINT16_SEQ_NUM(pKvsRtpTransceiver->sender.sequenceNumber + 1);
+    }
+
+    *pFecPacketCount = pFecEncoder->fecPacketCount;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS writeRtpPacket(PKvsPeerConnection pKvsPeerConnection, PRtpPacketBuffer pRtpPacketBuffer)
 {
     STATUS retStatus = STATUS_SUCCESS;
     BOOL locked = FALSE;
-    PBYTE pRawPacket = NULL;
     INT32 rawLen = 0;
 
-    CHK(pKvsPeerConnection != NULL && pRtpPacket != NULL && pRtpPacket->pRawPacket != NULL, STATUS_NULL_ARG);
+    CHK(pKvsPeerConnection != NULL && pRtpPacketBuffer != NULL, STATUS_NULL_ARG);
+    CHK(pRtpPacketBuffer->tailroom >= SRTP_AUTH_TAG_OVERHEAD, STATUS_BUFFER_TOO_SMALL);
 
     MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
     locked = TRUE;
-    CHK(pKvsPeerConnection->pSrtpSession != NULL, STATUS_SUCCESS);               // Discard packets till SRTP is ready
-    pRawPacket = MEMALLOC(pRtpPacket->rawPacketLength + SRTP_AUTH_TAG_OVERHEAD); // For SRTP authentication tag
-    rawLen = pRtpPacket->rawPacketLength;
-    MEMCPY(pRawPacket, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength);
-    CHK_STATUS(encryptRtpPacket(pKvsPeerConnection->pSrtpSession, pRawPacket, &rawLen));
-    CHK_STATUS(iceAgentSendPacket(pKvsPeerConnection->pIceAgent, pRawPacket, rawLen));
+    CHK(pKvsPeerConnection->pSrtpSession != NULL, STATUS_SUCCESS); // Discard packets till SRTP is ready
+    rawLen = pRtpPacketBuffer->packet.rawPacketLength;
+    CHK_STATUS(encryptRtpPacket(pKvsPeerConnection->pSrtpSession, pRtpPacketBuffer->packet.pRawPacket, &rawLen));
+    CHK_STATUS(rtpPacketBufferSetLength(pRtpPacketBuffer, (UINT32) rawLen));
+    CHK_STATUS(iceAgentSendPacket(pKvsPeerConnection->pIceAgent, pRtpPacketBuffer->packet.pRawPacket, rawLen));
 
 CleanUp:
     if (locked) {
         MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
     }
-    SAFE_MEMFREE(pRawPacket);
+
+    return retStatus;
+}
+
+STATUS writePacedRtpPacket(PKvsRtpTransceiver pKvsRtpTransceiver, PRtpPacketBuffer pRtpPacketBuffer, BOOL encrypt, PACER_PRIORITY priority)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsPeerConnection pKvsPeerConnection = NULL;
+    BOOL locked = FALSE, queued = FALSE;
+    INT32 rawLen = 0;
+
+    CHK(pKvsRtpTransceiver != NULL && pRtpPacketBuffer != NULL, STATUS_NULL_ARG);
+    pKvsPeerConnection = pKvsRtpTransceiver->pKvsPeerConnection;
+    CHK(pKvsPeerConnection->pPacer != NULL, STATUS_INVALID_OPERATION);
+
+    if (encrypt) {
+        CHK(pRtpPacketBuffer->tailroom >= SRTP_AUTH_TAG_OVERHEAD, STATUS_BUFFER_TOO_SMALL);
+        MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
+        locked = TRUE;
+        CHK(pKvsPeerConnection->pSrtpSession != NULL, STATUS_SRTP_NOT_READY_YET);
+        rawLen = pRtpPacketBuffer->packet.rawPacketLength;
+        CHK_STATUS(encryptRtpPacket(pKvsPeerConnection->pSrtpSession, pRtpPacketBuffer->packet.pRawPacket, &rawLen));
+        CHK_STATUS(rtpPacketBufferSetLength(pRtpPacketBuffer, (UINT32) rawLen));
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+        locked = FALSE;
+    }
+
+    // Counted before the packet becomes visible to a concurrent drain
+    MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
+    pKvsRtpTransceiver->outboundStats.packetsQueued++;
+    pKvsRtpTransceiver->outboundStats.bytesQueued += pRtpPacketBuffer->packet.rawPacketLength;
+    MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+    queued = TRUE;
+
+    CHK_STATUS(pacerEnqueue(pKvsPeerConnection->pPacer, pRtpPacketBuffer, (UINT64) pKvsRtpTransceiver, priority));
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pKvsPeerConnection->pSrtpSessionLock);
+    }
+
+    if (STATUS_FAILED(retStatus) && queued) {
+        MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
+        pKvsRtpTransceiver->outboundStats.packetsQueued--;
+        pKvsRtpTransceiver->outboundStats.bytesQueued -= pRtpPacketBuffer->packet.rawPacketLength;
+        MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+    }
+
+    return retStatus;
+}
+
+STATUS sendPacedPackets(UINT64 customData, PPacedPacket pPacedPackets, UINT32 packetCount)
+{
+    STATUS retStatus = STATUS_SUCCESS, sendStatus = STATUS_SUCCESS, runStatus;
+    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    PRtpPacket pRtpPacket;
+    PBYTE ppRawPackets[PACER_MAX_BATCH_SIZE];
+    UINT32 rawPacketLengths[PACER_MAX_BATCH_SIZE];
+    STATUS packetStatuses[PACER_MAX_BATCH_SIZE];
+    UINT32 i, runStart, headerLen;
+    SOCKET_EGRESS_PRIORITY egressPriority;
+    UINT64 sentTime;
+
+    CHK(pKvsPeerConnection != NULL && pPacedPackets != NULL, STATUS_NULL_ARG);
+    CHK(packetCount > 0 && packetCount <= PACER_MAX_BATCH_SIZE, STATUS_INVALID_ARG);
+
+    for (i = 0; i < packetCount; i++) {
+        ppRawPackets[i] = pPacedPackets[i].pRtpPacketBuffer->packet.pRawPacket;
+        rawPacketLengths[i] = pPacedPackets[i].pRtpPacketBuffer->packet.rawPacketLength;
+    }
+
+    // The batch holds the queues one after the other, each run leaves with the drop priority of its queue. The pacer does
+    // not know which video packets belong to key frames so none of them is marked as discardable.
+    for (runStart = 0; runStart < packetCount; runStart = i) {
+        i = runStart + 1;
+        while (i < packetCount && pPacedPackets[i].priority == pPacedPackets[runStart].priority) {
+            i++;
+        }
+
+        egressPriority = pPacedPackets[runStart].priority == PACER_PRIORITY_AUDIO ? SOCKET_EGRESS_PRIORITY_AUDIO : SOCKET_EGRESS_PRIORITY_VIDEO;
+        runStatus = iceAgentSendPacketBatch(pKvsPeerConnection->pIceAgent, ppRawPackets + runStart, rawPacketLengths + runStart, i - runStart,
+                                            egressPriority);
+        for (; runStart < i; runStart++) {
+            packetStatuses[runStart] = runStatus;
+        }
+        if (STATUS_FAILED(runStatus)) {
+            sendStatus = runStatus;
+        }
+    }
+    sentTime = GETTIME();
+
+    for (i = 0; i < packetCount; i++) {
+        pKvsRtpTransceiver = (PKvsRtpTransceiver) pPacedPackets[i].customData;
+        pRtpPacket = &pPacedPackets[i].pRtpPacketBuffer->packet;
+        headerLen = RTP_HEADER_LEN(pRtpPacket);
+
+        // The header is in the clear, including the transport wide sequence number
+        if (packetStatuses[i] == STATUS_SUCCESS && pKvsPeerConnection->twccExtId != 0) {
+            pRtpPacket->sentTime = sentTime;
+            twccManagerOnPacketSent(pKvsPeerConnection, pRtpPacket);
+        }
+
+        MUTEX_LOCK(pKvsRtpTransceiver->statsLock);
+        pKvsRtpTransceiver->outboundStats.packetsQueued--;
+        pKvsRtpTransceiver->outboundStats.bytesQueued -= rawPacketLengths[i];
+        // Retransmissions are accounted for by the retransmitter
+        if (pPacedPackets[i].priority != PACER_PRIORITY_RETRANSMISSION) {
+            if (packetStatuses[i] == STATUS_SUCCESS) {
+                pKvsRtpTransceiver->outboundStats.sent.bytesSent += rawPacketLengths[i] - headerLen;
+                pKvsRtpTransceiver->outboundStats.sent.packetsSent++;
+                pKvsRtpTransceiver->outboundStats.headerBytesSent += headerLen;
+                pKvsRtpTransceiver->outboundStats.lastPacketSentTimestamp = KVS_CONVERT_TIMESCALE(sentTime, HUNDREDS_OF_NANOS_IN_A_SECOND, 1000);
+                pKvsRtpTransceiver->outboundStats.totalPacketSendDelaySeconds +=
+                    (DOUBLE) (sentTime - pPacedPackets[i].enqueueTime) / HUNDREDS_OF_NANOS_IN_A_SECOND;
+                pKvsRtpTransceiver->outboundStats.totalPacketSendDelay = (UINT64) pKvsRtpTransceiver->outboundStats.totalPacketSendDelaySeconds;
+            } else if (packetStatuses[i] == STATUS_SEND_DATA_FAILED) {
+                pKvsRtpTransceiver->outboundStats.packetsDiscardedOnSend++;
+                pKvsRtpTransceiver->outboundStats.bytesDiscardedOnSend += rawPacketLengths[i] - headerLen;
+            }
+        }
+        MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
+    }
+
+    CHK_STATUS(sendStatus);
+
+CleanUp:
 
     return retStatus;
 }
@@ -504,20 +990,14 @@ STATUS hasTransceiverWithSsrc(PKvsPeerConnection pKvsPeerConnection, UINT32 ssrc
 STATUS findTransceiverBySsrc(PKvsPeerConnection pKvsPeerConnection, PKvsRtpTransceiver* ppTransceiver, UINT32 ssrc)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    PDoubleListNode pCurNode = NULL;
     UINT64 item = 0;
     PKvsRtpTransceiver pTransceiver = NULL;
     CHK(pKvsPeerConnection != NULL && ppTransceiver != NULL, STATUS_NULL_ARG);
 
-    CHK_STATUS(doubleListGetHeadNode(pKvsPeerConnection->pTransceivers, &pCurNode));
-    while (pCurNode != NULL) {
-        CHK_STATUS(doubleListGetNodeData(pCurNode, &item));
+    if (STATUS_SUCCEEDED(ssrcTableGet(pKvsPeerConnection->pSsrcTable, ssrc, SSRC_TABLE_KIND_SENDER, &item)) ||
+        STATUS_SUCCEEDED(ssrcTableGet(pKvsPeerConnection->pSsrcTable, ssrc, SSRC_TABLE_KIND_RTX, &item)) ||
+        STATUS_SUCCEEDED(ssrcTableGet(pKvsPeerConnection->pSsrcTable, ssrc, SSRC_TABLE_KIND_RECEIVER, &item))) {
         pTransceiver = (PKvsRtpTransceiver) item;
-        if (pTransceiver->sender.ssrc == ssrc || pTransceiver->sender.rtxSsrc == ssrc || pTransceiver->jitterBufferSsrc == ssrc) {
-            break;
-        }
-        pTransceiver = NULL;
-        pCurNode = pCurNode->pNext;
     }
     CHK(pTransceiver != NULL, STATUS_NOT_FOUND);
     *ppTransceiver = pTransceiver;
@@ -16,7 +16,7 @@ extern "C" {
 #define DEFAULT_SEQ_NUM_BUFFER_SIZE                1000
 #define DEFAULT_VALID_INDEX_BUFFER_SIZE            1000
 #define DEFAULT_PEER_FRAME_BUFFER_SIZE             (5 * 1024)
-#define SRTP_AUTH_TAG_OVERHEAD                     10
+#define SRTP_AUTH_TAG_OVERHEAD                     16 // Largest of the supported profiles, AEAD_AES_*_GCM
 #define MIN_ROLLING_BUFFER_DURATION_IN_SECONDS     (DOUBLE) 0.1
 #define MIN_EXPECTED_BIT_RATE                      (DOUBLE)(102.4 * 1024) // Considering 1Kib = 1024 bits
 #define MAX_ROLLING_BUFFER_DURATION_IN_SECONDS     (DOUBLE) 10
@@ -26,6 +26,8 @@ extern "C" {
 // Huge frames, by definition, are frames that have an encoded size at least 2.5 times the average size of the frames.
 #define HUGE_FRAME_MULTIPLIER 2.5
 
+typedef STATUS (*RtpPayloadFunc)(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+
 typedef struct {
     UINT8 payloadType;
     UINT8 rtxPayloadType;
@@ -38,6 +40,8 @@ typedef struct {
     RtcMediaStreamTrack track;
     PRtpRollingBuffer packetBuffer;
     PRetransmitter retransmitter;
+    // NULL unless FEC is enabled for a sending video transceiver
+    PFecEncoder pFecEncoder;
 
     UINT64 rtpTimeOffset;
     UINT64 firstFrameWallClockTime; // 100ns precision
@@ -61,17 +65,29 @@ typedef struct {
     PKvsPeerConnection pKvsPeerConnection;
 
     UINT32 jitterBufferSsrc;
+    // Retransmissions of the inbound stream, 0 unless the remote description grouped an RTX ssrc with it
+    UINT32 jitterBufferRtxSsrc;
     PJitterBuffer pJitterBuffer;
+    // NACKs the gaps of the inbound stream, NULL for audio and send only transceivers
+    PNackGenerator pNackGenerator;
+    // Recovers the inbound packets from the FEC packets, NULL unless FEC is enabled for a receiving video transceiver
+    PFecDecoder pFecDecoder;
 
     PRollingBufferConfig pRollingBufferConfig;
 
     UINT64 onFrameCustomData;
     RtcOnFrame onFrame;
+    UINT64 onFrameSlicesCustomData;
+    RtcOnFrameSlices onFrameSlices;
+    // Codec specific, gives the frame slices of a packet
+    DepayRtpPayloadSlicesFunc depaySlicesFn;
 
     UINT64 onBandwidthEstimationCustomData;
     RtcOnBandwidthEstimation onBandwidthEstimation;
     UINT64 onPictureLossCustomData;
     RtcOnPictureLoss onPictureLoss;
+    // Share of the egress bandwidth, only added to the manager for the sending transceivers of a managed PeerConnection
+    EgressBandwidthFlow egressBandwidthFlow;
 
     PBYTE peerFrameBuffer;
     UINT32 peerFrameBufferSize;
@@ -84,6 +100,22 @@ typedef struct {
     RtcInboundRtpStreamStats inboundStats;
 } KvsRtpTransceiver, *PKvsRtpTransceiver;
 
+/**
+ * Frame handed to RtcOnFrameSlices. The slices point into the packets, which were taken out of the jitter buffer and
+ * are freed along with the frame by releaseFrameSlices. Allocated as a single block with the packet and slice arrays.
+ */
+typedef struct {
+    // Given to the application, must stay first
+    RtcFrameSlices frameSlices;
+    UINT32 packetCount;
+    PRtpPacket* pPackets;
+} KvsFrameSlices, *PKvsFrameSlices;
+
+/**
+ * Take the packets of a complete frame out of the jitter buffer and depayload them into slices
+ */
+STATUS createKvsFrameSlices(PJitterBuffer, DepayRtpPayloadSlicesFunc, UINT16, UINT16, PKvsFrameSlices*);
+
 STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION, PKvsPeerConnection, UINT32, UINT32, PRtcMediaStreamTrack, PJitterBuffer, RTC_CODEC,
                                PKvsRtpTransceiver*);
 STATUS freeKvsRtpTransceiver(PKvsRtpTransceiver*);
@@ -92,7 +124,65 @@ STATUS kvsRtpTransceiverSetJitterBuffer(PKvsRtpTransceiver, PJitterBuffer);
 
 #define CONVERT_TIMESTAMP_TO_RTP(clockRate, pts) ((UINT64) ((DOUBLE) (pts) * ((DOUBLE) (clockRate) / HUNDREDS_OF_NANOS_IN_A_SECOND)))
 
-STATUS writeRtpPacket(PKvsPeerConnection pKvsPeerConnection, PRtpPacket pRtpPacket);
+/**
+ * Encrypt a packet in place, in the tailroom of its buffer, and send it. The buffer can not be sent again afterwards
+ */
+STATUS writeRtpPacket(PKvsPeerConnection pKvsPeerConnection, PRtpPacketBuffer pRtpPacketBuffer);
+
+/**
+ * Queue a packet on the pacer of the PeerConnection, encrypting it in place first when the BOOL is set. The pacer takes
+ * its own reference on the buffer.
+ */
+STATUS writePacedRtpPacket(PKvsRtpTransceiver, PRtpPacketBuffer, BOOL, PACER_PRIORITY);
+
+// PacerSendPacketsFunc of the PeerConnection pacer, customData is the PKvsPeerConnection
+STATUS sendPacedPackets(UINT64, PPacedPacket, UINT32);
+
+/**
+ * Get the payloader of a codec and the RTP timestamp of a frame in that codec's clock rate
+ */
+STATUS getRtpPayloadFunc(RTC_CODEC, UINT64, RtpPayloadFunc*, PUINT64);
+
+/**
+ * Packetize a frame into a payload array, growing its buffers as needed
+ */
+STATUS packetizeFrame(RtpPayloadFunc, UINT32, PFrame, PPayloadArray);
+
+/**
+ * The MTU the frames of a transceiver are packetized with. Once ULPFEC is negotiated it leaves room for the FEC packets, which
+ * are longer than the media packets they protect.
+ */
+UINT32 getPayloadMtu(PKvsRtpTransceiver);
+
+/**
+ * Send a frame on a transceiver. The frame is packetized into the sender's own payload array unless an already packetized
+ * payload array is given, in which case only the RTP headers, SRTP and the send are done for this transceiver.
+ */
+STATUS writeFramePayload(PKvsRtpTransceiver, PFrame, PPayloadArray);
+
+/**
+ * Protect the media packets of a frame with the FEC encoder of the transceiver and append the FEC packets of the groups
+ * closed meanwhile to the list, with the next sequence numbers of the stream
+ *
+ * @param - PKvsRtpTransceiver - IN - transceiver with a FEC encoder, ULPFEC negotiated
+ * @param - PRtpPacket - IN/OUT - media packets, room for the FEC packets after them
+ * @param - UINT32 - IN - number of media packets
+ * @param - UINT32 - IN - RTP timestamp of the frame
+ * @param - PUINT32 - OUT - number of FEC packets appended
+ *
+ * @return - STATUS status of execution
+ */
+STATUS appendFecRtpPackets(PKvsRtpTransceiver, PRtpPacket, UINT32, UINT32, PUINT32);
+
+/**
+ * Hand the packets the FEC decoder of the transceiver recovered to its jitter buffer and NACK generator
+ *
+ * @param - PKvsRtpTransceiver - IN - transceiver with a FEC decoder
+ * @param - UINT64 - IN - current time
+ *
+ * @return - STATUS status of execution
+ */
+STATUS pushRecoveredRtpPackets(PKvsRtpTransceiver, UINT64);
 
 STATUS hasTransceiverWithSsrc(PKvsPeerConnection pKvsPeerConnection, UINT32 ssrc);
 STATUS findTransceiverBySsrc(PKvsPeerConnection pKvsPeerConnection, PKvsRtpTransceiver* ppTransceiver, UINT32 ssrc);
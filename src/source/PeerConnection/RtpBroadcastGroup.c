@@ -0,0 +1,182 @@
+#define LOG_CLASS "RtpBroadcastGroup"
+
+#include "../Include_i.h"
+
+STATUS createRtpBroadcastGroup(RTC_CODEC codec, PRTP_BROADCAST_GROUP_HANDLE pBroadcastGroupHandle)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpBroadcastGroup pRtpBroadcastGroup = NULL;
+    RtpPayloadFunc rtpPayloadFunc = NULL;
+    UINT64 rtpTimestamp = 0;
+
+    CHK(pBroadcastGroupHandle != NULL, STATUS_NULL_ARG);
+    // Only the codecs writeFrame knows how to packetize can be broadcast
+    CHK(STATUS_SUCCEEDED(getRtpPayloadFunc(codec, 0, &rtpPayloadFunc, &rtpTimestamp)), STATUS_INVALID_ARG);
+
+    pRtpBroadcastGroup = (PRtpBroadcastGroup) MEMCALLOC(1, SIZEOF(RtpBroadcastGroup));
+    CHK(pRtpBroadcastGroup != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pRtpBroadcastGroup->lock = INVALID_MUTEX_VALUE;
+
+    pRtpBroadcastGroup->codec = codec;
+    pRtpBroadcastGroup->transceiverCapacity = RTP_BROADCAST_GROUP_DEFAULT_CAPACITY;
+    pRtpBroadcastGroup->transceivers = (PKvsRtpTransceiver*) MEMCALLOC(pRtpBroadcastGroup->transceiverCapacity, SIZEOF(PKvsRtpTransceiver));
+    CHK(pRtpBroadcastGroup->transceivers != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pRtpBroadcastGroup->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pRtpBroadcastGroup->lock), STATUS_INVALID_OPERATION);
+
+    *pBroadcastGroupHandle = TO_RTP_BROADCAST_GROUP_HANDLE(pRtpBroadcastGroup);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && pRtpBroadcastGroup != NULL) {
+        RTP_BROADCAST_GROUP_HANDLE handle = TO_RTP_BROADCAST_GROUP_HANDLE(pRtpBroadcastGroup);
+        freeRtpBroadcastGroup(&handle);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeRtpBroadcastGroup(PRTP_BROADCAST_GROUP_HANDLE pBroadcastGroupHandle)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpBroadcastGroup pRtpBroadcastGroup = NULL;
+
+    CHK(pBroadcastGroupHandle != NULL, STATUS_NULL_ARG);
+
+    pRtpBroadcastGroup = FROM_RTP_BROADCAST_GROUP_HANDLE(*pBroadcastGroupHandle);
+    // Idempotent call
+    CHK(pRtpBroadcastGroup != NULL, retStatus);
+
+    if (IS_VALID_MUTEX_VALUE(pRtpBroadcastGroup->lock)) {
+        MUTEX_FREE(pRtpBroadcastGroup->lock);
+    }
+
+    SAFE_MEMFREE(pRtpBroadcastGroup->payloadArray.payloadBuffer);
+    SAFE_MEMFREE(pRtpBroadcastGroup->payloadArray.payloadSubLength);
+    SAFE_MEMFREE(pRtpBroadcastGroup->transceivers);
+    MEMFREE(pRtpBroadcastGroup);
+
+    *pBroadcastGroupHandle = INVALID_RTP_BROADCAST_GROUP_HANDLE_VALUE;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS broadcastGroupAddTransceiver(RTP_BROADCAST_GROUP_HANDLE broadcastGroupHandle, PRtcRtpTransceiver pRtcRtpTransceiver)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpBroadcastGroup pRtpBroadcastGroup = FROM_RTP_BROADCAST_GROUP_HANDLE(broadcastGroupHandle);
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver, *pNewTransceivers = NULL;
+    BOOL locked = FALSE;
+    UINT32 i;
+
+    CHK(pRtpBroadcastGroup != NULL && pKvsRtpTransceiver != NULL, STATUS_NULL_ARG);
+    CHK(pKvsRtpTransceiver->sender.track.codec == pRtpBroadcastGroup->codec, STATUS_RTP_BROADCAST_GROUP_CODEC_MISMATCH);
+
+    MUTEX_LOCK(pRtpBroadcastGroup->lock);
+    locked = TRUE;
+
+    for (i = 0; i < pRtpBroadcastGroup->transceiverCount; i++) {
+        CHK(pRtpBroadcastGroup->transceivers[i] != pKvsRtpTransceiver, STATUS_RTP_BROADCAST_GROUP_ALREADY_MEMBER);
+    }
+
+    if (pRtpBroadcastGroup->transceiverCount == pRtpBroadcastGroup->transceiverCapacity) {
+        pNewTransceivers = (PKvsRtpTransceiver*) MEMREALLOC(pRtpBroadcastGroup->transceivers,
+                                                            2 * pRtpBroadcastGroup->transceiverCapacity * SIZEOF(PKvsRtpTransceiver));
+        CHK(pNewTransceivers != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pRtpBroadcastGroup->transceivers = pNewTransceivers;
+        pRtpBroadcastGroup->transceiverCapacity *= 2;
+    }
+
+    pRtpBroadcastGroup->transceivers[pRtpBroadcastGroup->transceiverCount++] = pKvsRtpTransceiver;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pRtpBroadcastGroup->lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS broadcastGroupRemoveTransceiver(RTP_BROADCAST_GROUP_HANDLE broadcastGroupHandle, PRtcRtpTransceiver pRtcRtpTransceiver)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpBroadcastGroup pRtpBroadcastGroup = FROM_RTP_BROADCAST_GROUP_HANDLE(broadcastGroupHandle);
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+    BOOL locked = FALSE;
+    UINT32 i;
+
+    CHK(pRtpBroadcastGroup != NULL && pKvsRtpTransceiver != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pRtpBroadcastGroup->lock);
+    locked = TRUE;
+
+    for (i = 0; i < pRtpBroadcastGroup->transceiverCount; i++) {
+        if (pRtpBroadcastGroup->transceivers[i] == pKvsRtpTransceiver) {
+            // Order does not matter, move the last member in the hole
+            pRtpBroadcastGroup->transceivers[i] = pRtpBroadcastGroup->transceivers[--pRtpBroadcastGroup->transceiverCount];
+            pRtpBroadcastGroup->transceivers[pRtpBroadcastGroup->transceiverCount] = NULL;
+            break;
+        }
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pRtpBroadcastGroup->lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS broadcastGroupWriteFrame(RTP_BROADCAST_GROUP_HANDLE broadcastGroupHandle, PFrame pFrame)
+{
+    STATUS retStatus = STATUS_SUCCESS, sendStatus;
+    PRtpBroadcastGroup pRtpBroadcastGroup = FROM_RTP_BROADCAST_GROUP_HANDLE(broadcastGroupHandle);
+    RtpPayloadFunc rtpPayloadFunc = NULL;
+    UINT64 rtpTimestamp = 0;
+    UINT32 i, mtu = MAX_UINT32;
+    BOOL locked = FALSE;
+
+    CHK(pRtpBroadcastGroup != NULL && pFrame != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pRtpBroadcastGroup->lock);
+    locked = TRUE;
+
+    CHK(pRtpBroadcastGroup->transceiverCount > 0, retStatus);
+
+    // The payload is shared, so it has to fit the smallest MTU of the group, FEC protected members included
+    for (i = 0; i < pRtpBroadcastGroup->transceiverCount; i++) {
+        mtu = MIN(mtu, getPayloadMtu(pRtpBroadcastGroup->transceivers[i]));
+    }
+
+    CHK_STATUS(getRtpPayloadFunc(pRtpBroadcastGroup->codec, pFrame->presentationTs, &rtpPayloadFunc, &rtpTimestamp));
+    CHK_STATUS(packetizeFrame(rtpPayloadFunc, mtu, pFrame, &pRtpBroadcastGroup->payloadArray));
+
+    for (i = 0; i < pRtpBroadcastGroup->transceiverCount; i++) {
+        sendStatus = writeFramePayload(pRtpBroadcastGroup->transceivers[i], pFrame, &pRtpBroadcastGroup->payloadArray);
+        // A viewer still connecting must not hold back the others
+        if (STATUS_FAILED(sendStatus) && sendStatus != STATUS_SRTP_NOT_READY_YET && STATUS_SUCCEEDED(retStatus)) {
+            retStatus = sendStatus;
+        }
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pRtpBroadcastGroup->lock);
+    }
+
+    return retStatus;
+}
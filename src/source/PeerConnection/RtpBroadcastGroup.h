@@ -0,0 +1,35 @@
+/*******************************************
+RtpBroadcastGroup internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_RTP_BROADCAST_GROUP__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_RTP_BROADCAST_GROUP__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RTP_BROADCAST_GROUP_DEFAULT_CAPACITY 8
+
+/**
+ * Transceivers sending the same media. A frame is packetized once into payloadArray and every member only builds its own
+ * RTP headers, encrypts and sends.
+ */
+typedef struct {
+    // Serializes writes and membership changes, payloadArray is reused from one frame to the next
+    MUTEX lock;
+    RTC_CODEC codec;
+    PayloadArray payloadArray;
+    UINT32 transceiverCount;
+    UINT32 transceiverCapacity;
+    PKvsRtpTransceiver* transceivers;
+} RtpBroadcastGroup, *PRtpBroadcastGroup;
+
+#define TO_RTP_BROADCAST_GROUP_HANDLE(p)   ((RTP_BROADCAST_GROUP_HANDLE) (p))
+#define FROM_RTP_BROADCAST_GROUP_HANDLE(h) (IS_VALID_RTP_BROADCAST_GROUP_HANDLE(h) ? (PRtpBroadcastGroup) (h) : NULL)
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_RTP_BROADCAST_GROUP__ */
@@ -320,6 +320,98 @@ CleanUp:
     return retStatus;
 }
 
+STATUS setFecPayloadTypes(PSessionDescription pSessionDescription, PUINT8 pRedPayloadType, PUINT8 pUlpfecPayloadType)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpMediaDescription pMediaDescription = NULL;
+    UINT32 currentMedia, currentAttribute;
+    PCHAR attributeValue, end;
+    UINT64 parsedPayloadType, redPayloadType = 0, ulpfecPayloadType = 0;
+
+    CHK(pSessionDescription != NULL && pRedPayloadType != NULL && pUlpfecPayloadType != NULL, STATUS_NULL_ARG);
+
+    for (currentMedia = 0; currentMedia < pSessionDescription->mediaCount; currentMedia++) {
+        pMediaDescription = &(pSessionDescription->mediaDescriptions[currentMedia]);
+        if (STRNCMP(pMediaDescription->mediaName, MEDIA_SECTION_VIDEO_VALUE, STRLEN(MEDIA_SECTION_VIDEO_VALUE)) != 0) {
+            continue;
+        }
+
+        for (currentAttribute = 0; currentAttribute < pMediaDescription->mediaAttributesCount; currentAttribute++) {
+            if (STRCMP(pMediaDescription->sdpAttributes[currentAttribute].attributeName, RTPMAP_VALUE) != 0) {
+                continue;
+            }
+
+            attributeValue = pMediaDescription->sdpAttributes[currentAttribute].attributeValue;
+            if (redPayloadType == 0 && (end = STRSTR(attributeValue, " " RED_VALUE)) != NULL) {
+                CHK_STATUS(STRTOUI64(attributeValue, end, 10, &parsedPayloadType));
+                redPayloadType = parsedPayloadType;
+            } else if (ulpfecPayloadType == 0 && (end = STRSTR(attributeValue, " " ULPFEC_VALUE)) != NULL) {
+                CHK_STATUS(STRTOUI64(attributeValue, end, 10, &parsedPayloadType));
+                ulpfecPayloadType = parsedPayloadType;
+            }
+        }
+    }
+
+    // RED alone would carry nothing the SDK generates, and ULPFEC is only sent in RED
+    if (redPayloadType == 0 || ulpfecPayloadType == 0 || redPayloadType > PAYLOAD_TYPE_MASK || ulpfecPayloadType > PAYLOAD_TYPE_MASK) {
+        redPayloadType = 0;
+        ulpfecPayloadType = 0;
+    }
+
+    *pRedPayloadType = (UINT8) redPayloadType;
+    *pUlpfecPayloadType = (UINT8) ulpfecPayloadType;
+
+CleanUp:
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS setRtxAptPayloadTypes(PSessionDescription pSessionDescription, PUINT8 pAptPayloadTypes)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSdpMediaDescription pMediaDescription = NULL;
+    UINT32 currentMedia, currentAttribute;
+    PCHAR attributeValue, aptStart, aptEnd;
+    UINT64 rtxPayloadType, aptPayloadType;
+
+    CHK(pSessionDescription != NULL && pAptPayloadTypes != NULL, STATUS_NULL_ARG);
+
+    MEMSET(pAptPayloadTypes, 0x00, PAYLOAD_TYPE_MASK + 1);
+    for (currentMedia = 0; currentMedia < pSessionDescription->mediaCount; currentMedia++) {
+        pMediaDescription = &(pSessionDescription->mediaDescriptions[currentMedia]);
+        for (currentAttribute = 0; currentAttribute < pMediaDescription->mediaAttributesCount; currentAttribute++) {
+            if (STRCMP(pMediaDescription->sdpAttributes[currentAttribute].attributeName, "fmtp") != 0) {
+                continue;
+            }
+
+            // "<rtx payload type> apt=<payload type>", possibly followed by ";rtx-time=<ms>"
+            attributeValue = pMediaDescription->sdpAttributes[currentAttribute].attributeValue;
+            if ((aptStart = STRSTR(attributeValue, " " RTX_CODEC_VALUE)) == NULL) {
+                continue;
+            }
+            aptEnd = STRCHR(aptStart, ';');
+            // A malformed line only costs the retransmissions of that payload type
+            if (STATUS_FAILED(STRTOUI64(attributeValue, aptStart, 10, &rtxPayloadType)) ||
+                STATUS_FAILED(STRTOUI64(aptStart + 1 + STRLEN(RTX_CODEC_VALUE), aptEnd, 10, &aptPayloadType)) ||
+                rtxPayloadType > PAYLOAD_TYPE_MASK || aptPayloadType > PAYLOAD_TYPE_MASK) {
+                DLOGW("Ignoring malformed rtx fmtp %s", attributeValue);
+                continue;
+            }
+            pAptPayloadTypes[rtxPayloadType] = (UINT8) aptPayloadType;
+        }
+    }
+
+CleanUp:
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS setTransceiverPayloadTypes(PHashTable codecTable, PHashTable rtxTable, PDoubleList pTransceivers)
 {
     ENTERS();
@@ -473,7 +565,7 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT64 payloadType, rtxPayloadType;
+    UINT64 payloadType, rtxPayloadType, redPayloadType = 0, ulpfecPayloadType = 0;
     BOOL containRtx = FALSE;
     BOOL directionFound = FALSE;
     UINT32 i, remoteAttributeCount, attributeCount = 0;
@@ -512,6 +604,11 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
         CHK(retStatus == STATUS_SUCCESS || retStatus == STATUS_HASH_KEY_NOT_PRESENT, retStatus);
         containRtx = (retStatus == STATUS_SUCCESS);
         retStatus = STATUS_SUCCESS;
+        // ULPFEC in RED is offered along with the codecs the SDK packetizes, and only answered when it was offered
+        if (pKvsPeerConnection->fecEnabled && pRtcMediaStreamTrack->codec != RTC_CODEC_UNKNOWN) {
+            redPayloadType = pKvsPeerConnection->isOffer ? DEFAULT_PAYLOAD_RED : pKvsPeerConnection->redPayloadType;
+            ulpfecPayloadType = pKvsPeerConnection->isOffer ? DEFAULT_PAYLOAD_ULPFEC : pKvsPeerConnection->ulpfecPayloadType;
+        }
         if (containRtx) {
             amountWritten = SNPRINTF(pSdpMediaDescription->mediaName, SIZEOF(pSdpMediaDescription->mediaName),
                                      "video 9 UDP/TLS/RTP/SAVPF %" PRId64 " %" PRId64, payloadType, rtxPayloadType);
@@ -521,6 +618,12 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
                 SNPRINTF(pSdpMediaDescription->mediaName, SIZEOF(pSdpMediaDescription->mediaName), "video 9 UDP/TLS/RTP/SAVPF %" PRId64, payloadType);
             CHK_ERR(amountWritten > 0, STATUS_INTERNAL_ERROR, "Full video media name attribute could not be written");
         }
+        if (ulpfecPayloadType != 0) {
+            i = (UINT32) STRLEN(pSdpMediaDescription->mediaName);
+            amountWritten = SNPRINTF(pSdpMediaDescription->mediaName + i, SIZEOF(pSdpMediaDescription->mediaName) - i, " %" PRId64 " %" PRId64,
+                                     redPayloadType, ulpfecPayloadType);
+            CHK_ERR(amountWritten > 0, STATUS_INTERNAL_ERROR, "Full video media name (with red and ulpfec) could not be written");
+        }
     } else if (pRtcMediaStreamTrack->kind == MEDIA_STREAM_TRACK_KIND_AUDIO) {
         amountWritten =
             SNPRINTF(pSdpMediaDescription->mediaName, SIZEOF(pSdpMediaDescription->mediaName), "audio 9 UDP/TLS/RTP/SAVPF %" PRId64, payloadType);
@@ -538,7 +641,7 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
         CHK_ERR(amountWritten > 0, STATUS_INTERNAL_ERROR, "Full msid value (with rtx) could not be written");
         attributeCount++;
 
-        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc-group");
+        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, SSRC_GROUP_KEY);
         amountWritten = SNPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue,
                                  SIZEOF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue), "FID %u %u",
                                  pKvsRtpTransceiver->sender.ssrc, pKvsRtpTransceiver->sender.rtxSsrc);
@@ -876,6 +979,22 @@ STATUS populateSingleMediaSection(PKvsPeerConnection pKvsPeerConnection, PKvsRtp
         attributeCount++;
     }
 
+    if (ulpfecPayloadType != 0) {
+        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtpmap");
+        amountWritten =
+            SNPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue,
+                     SIZEOF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue), "%" PRId64 " " RED_VALUE, redPayloadType);
+        CHK_ERR(amountWritten > 0, STATUS_INTERNAL_ERROR, "Full red rtpmap could not be written");
+        attributeCount++;
+
+        STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "rtpmap");
+        amountWritten =
+            SNPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue,
+                     SIZEOF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue), "%" PRId64 " " ULPFEC_VALUE, ulpfecPayloadType);
+        CHK_ERR(amountWritten > 0, STATUS_INTERNAL_ERROR, "Full ulpfec rtpmap could not be written");
+        attributeCount++;
+    }
+
     STRCPY(pSdpMediaDescription->sdpAttributes[attributeCount].attributeName, "ssrc");
     amountWritten = SNPRINTF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue,
                              SIZEOF(pSdpMediaDescription->sdpAttributes[attributeCount].attributeValue), "%u cname:%s",
@@ -1548,17 +1667,18 @@ CleanUp:
     return retStatus;
 }
 
-STATUS setReceiversSsrc(PSessionDescription pRemoteSessionDescription, PDoubleList pTransceivers)
+STATUS setReceiversSsrc(PSessionDescription pRemoteSessionDescription, PDoubleList pTransceivers, PSsrcTable pSsrcTable)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PSdpMediaDescription pMediaDescription = NULL;
+    PSdpAttributes pSdpAttribute;
     BOOL foundSsrc, isVideoMediaSection, isAudioMediaSection, isAudioCodec, isVideoCodec;
-    UINT32 currentAttribute, currentMedia, ssrc;
+    UINT32 currentAttribute, currentMedia, ssrc, rtxSsrc;
     UINT64 data;
     PDoubleListNode pCurNode = NULL;
     PKvsRtpTransceiver pKvsRtpTransceiver;
     RTC_CODEC codec;
-    PCHAR end = NULL;
+    PCHAR start = NULL, end = NULL;
 
     for (currentMedia = 0; currentMedia < pRemoteSessionDescription->mediaCount; currentMedia++) {
         pMediaDescription = &(pRemoteSessionDescription->mediaDescriptions[currentMedia]);
@@ -1566,13 +1686,23 @@ STATUS setReceiversSsrc(PSessionDescription pRemoteSessionDescription, PDoubleLi
         isAudioMediaSection = (STRNCMP(pMediaDescription->mediaName, MEDIA_SECTION_AUDIO_VALUE, ARRAY_SIZE(MEDIA_SECTION_AUDIO_VALUE) - 1) == 0);
         foundSsrc = FALSE;
         ssrc = 0;
+        rtxSsrc = 0;
 
         if (isVideoMediaSection || isAudioMediaSection) {
-            for (currentAttribute = 0; currentAttribute < pMediaDescription->mediaAttributesCount && !foundSsrc; currentAttribute++) {
-                if (STRNCMP(pMediaDescription->sdpAttributes[currentAttribute].attributeName, SSRC_KEY,
-                            STRLEN(pMediaDescription->sdpAttributes[currentAttribute].attributeName)) == 0) {
-                    if ((end = STRCHR(pMediaDescription->sdpAttributes[currentAttribute].attributeValue, ' ')) != NULL) {
-                        CHK_STATUS(STRTOUI32(pMediaDescription->sdpAttributes[currentAttribute].attributeValue, end, 10, &ssrc));
+            // The first ssrc is played unless an FID group tells which one is the media and which one carries its retransmissions,
+            // https://tools.ietf.org/html/rfc4588#section-8.1
+            for (currentAttribute = 0; currentAttribute < pMediaDescription->mediaAttributesCount && rtxSsrc == 0; currentAttribute++) {
+                pSdpAttribute = &pMediaDescription->sdpAttributes[currentAttribute];
+                if (STRCMP(pSdpAttribute->attributeName, SSRC_GROUP_KEY) == 0) {
+                    start = pSdpAttribute->attributeValue + STRLEN(FID_KEY " ");
+                    if (STRNCMP(pSdpAttribute->attributeValue, FID_KEY " ", STRLEN(FID_KEY " ")) == 0 && (end = STRCHR(start, ' ')) != NULL) {
+                        CHK_STATUS(STRTOUI32(start, end, 10, &ssrc));
+                        CHK_STATUS(STRTOUI32(end + 1, NULL, 10, &rtxSsrc));
+                        foundSsrc = TRUE;
+                    }
+                } else if (!foundSsrc && STRNCMP(pSdpAttribute->attributeName, SSRC_KEY, STRLEN(pSdpAttribute->attributeName)) == 0) {
+                    if ((end = STRCHR(pSdpAttribute->attributeValue, ' ')) != NULL) {
+                        CHK_STATUS(STRTOUI32(pSdpAttribute->attributeValue, end, 10, &ssrc));
                         foundSsrc = TRUE;
                     }
                 }
@@ -1592,6 +1722,11 @@ STATUS setReceiversSsrc(PSessionDescription pRemoteSessionDescription, PDoubleLi
                         ((isVideoCodec && isVideoMediaSection) || (isAudioCodec && isAudioMediaSection))) {
                         // Finish iteration, we assigned the ssrc move on to next media section
                         pKvsRtpTransceiver->jitterBufferSsrc = ssrc;
+                        CHK_STATUS(ssrcTablePut(pSsrcTable, ssrc, SSRC_TABLE_KIND_RECEIVER, (UINT64) pKvsRtpTransceiver));
+                        if (rtxSsrc != 0) {
+                            pKvsRtpTransceiver->jitterBufferRtxSsrc = rtxSsrc;
+                            CHK_STATUS(ssrcTablePut(pSsrcTable, rtxSsrc, SSRC_TABLE_KIND_RECEIVER_RTX, (UINT64) pKvsRtpTransceiver));
+                        }
                         pKvsRtpTransceiver->inboundStats.received.rtpStream.ssrc = ssrc;
                         STRNCPY(pKvsRtpTransceiver->inboundStats.received.rtpStream.kind,
                                 pKvsRtpTransceiver->transceiver.receiver.track.kind == MEDIA_STREAM_TRACK_KIND_VIDEO ? "video" : "audio",
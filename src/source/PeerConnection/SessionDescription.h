@@ -22,12 +22,14 @@ extern "C" {
 #define MEDIA_SECTION_AUDIO_VALUE "audio"
 #define MEDIA_SECTION_VIDEO_VALUE "video"
 
-#define SDP_TYPE_KEY  "type"
-#define SDP_KEY       "sdp"
-#define CANDIDATE_KEY "candidate"
-#define SSRC_KEY      "ssrc"
-#define BUNDLE_KEY    "BUNDLE"
-#define MID_KEY       "mid"
+#define SDP_TYPE_KEY   "type"
+#define SDP_KEY        "sdp"
+#define CANDIDATE_KEY  "candidate"
+#define SSRC_KEY       "ssrc"
+#define SSRC_GROUP_KEY "ssrc-group"
+#define FID_KEY        "FID"
+#define BUNDLE_KEY     "BUNDLE"
+#define MID_KEY        "mid"
 
 #define H264_VALUE      "H264/90000"
 #define H265_VALUE      "H265/90000"
@@ -37,6 +39,8 @@ extern "C" {
 #define ALAW_VALUE      "PCMA/8000"
 #define RTX_VALUE       "rtx/90000"
 #define RTX_CODEC_VALUE "apt="
+#define RED_VALUE       "red/90000"
+#define ULPFEC_VALUE    "ulpfec/90000"
 #define FMTP_VALUE      "fmtp:"
 #define RTPMAP_VALUE    "rtpmap"
 
@@ -47,6 +51,8 @@ extern "C" {
 #define DEFAULT_PAYLOAD_VP8     (UINT64) 96
 #define DEFAULT_PAYLOAD_H264    (UINT64) 125
 #define DEFAULT_PAYLOAD_H265    (UINT64) 127
+#define DEFAULT_PAYLOAD_RED     (UINT64) 116
+#define DEFAULT_PAYLOAD_ULPFEC  (UINT64) 118
 
 #define DEFAULT_PAYLOAD_MULAW_STR (PCHAR) "0"
 #define DEFAULT_PAYLOAD_ALAW_STR  (PCHAR) "8"
@@ -91,13 +97,34 @@ extern "C" {
 STATUS setPayloadTypesFromOffer(PHashTable, PHashTable, PSessionDescription);
 STATUS setPayloadTypesForOffer(PHashTable);
 
+/**
+ * Find the RED and ULPFEC payload types of the video sections of a remote description
+ *
+ * @param - PSessionDescription - IN - remote description
+ * @param - PUINT8 - OUT - RED payload type, 0 unless both RED and ULPFEC are present
+ * @param - PUINT8 - OUT - ULPFEC payload type, 0 unless both RED and ULPFEC are present
+ *
+ * @return - STATUS status of execution
+ */
+STATUS setFecPayloadTypes(PSessionDescription, PUINT8, PUINT8);
+
+/**
+ * Map the RTX payload types of a remote description to the payload types they retransmit, from the apt parameters
+ *
+ * @param - PSessionDescription - IN - remote description
+ * @param - PUINT8 - OUT - PAYLOAD_TYPE_MASK + 1 entries indexed by payload type, 0 for the payload types that are not RTX
+ *
+ * @return - STATUS status of execution
+ */
+STATUS setRtxAptPayloadTypes(PSessionDescription, PUINT8);
+
 STATUS setTransceiverPayloadTypes(PHashTable, PHashTable, PDoubleList);
 STATUS populateSessionDescription(PKvsPeerConnection, PSessionDescription, PSessionDescription);
 RTC_RTP_TRANSCEIVER_DIRECTION intersectTransceiverDirection(RTC_RTP_TRANSCEIVER_DIRECTION, RTC_RTP_TRANSCEIVER_DIRECTION);
 RTC_RTP_TRANSCEIVER_DIRECTION parseTransceiverDirection(PCHAR, RTC_RTP_TRANSCEIVER_DIRECTION*);
 STATUS writeTransceiverDirection(PCHAR, UINT32, RTC_RTP_TRANSCEIVER_DIRECTION);
 STATUS findTransceiversByRemoteDescription(PKvsPeerConnection, PSessionDescription, PHashTable, PHashTable);
-STATUS setReceiversSsrc(PSessionDescription, PDoubleList);
+STATUS setReceiversSsrc(PSessionDescription, PDoubleList, PSsrcTable);
 PCHAR fmtpForPayloadType(UINT64, PSessionDescription);
 UINT64 getH264FmtpScore(PCHAR);
 
@@ -0,0 +1,209 @@
+#define LOG_CLASS "SsrcTable"
+
+#include "../Include_i.h"
+
+// ssrcs are random, mixing in the kind is enough to spread the 3 kinds of the same ssrc apart
+#define SSRC_TABLE_HASH(ssrc, kind) (((ssrc) ^ ((kind) * 0x9E3779B9u)) * 2654435761u)
+
+STATUS createSsrcTable(PSsrcTable* ppSsrcTable)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSsrcTable pSsrcTable = NULL;
+    PSsrcTableSlots pSsrcTableSlots = NULL;
+
+    CHK(ppSsrcTable != NULL, STATUS_NULL_ARG);
+
+    pSsrcTable = (PSsrcTable) MEMCALLOC(1, SIZEOF(SsrcTable));
+    CHK(pSsrcTable != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pSsrcTable->lock = INVALID_MUTEX_VALUE;
+
+    CHK_STATUS(createSsrcTableSlots(SSRC_TABLE_INITIAL_CAPACITY, &pSsrcTableSlots));
+    ATOMIC_STORE(&pSsrcTable->currentSlots, (SIZE_T) pSsrcTableSlots);
+
+    pSsrcTable->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pSsrcTable->lock), STATUS_INVALID_OPERATION);
+
+CleanUp:
+    if (STATUS_FAILED(retStatus)) {
+        freeSsrcTable(&pSsrcTable);
+    }
+
+    if (ppSsrcTable != NULL) {
+        *ppSsrcTable = pSsrcTable;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeSsrcTable(PSsrcTable* ppSsrcTable)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSsrcTable pSsrcTable = NULL;
+    PSsrcTableSlots pSsrcTableSlots = NULL, pRetired = NULL;
+
+    CHK(ppSsrcTable != NULL, STATUS_NULL_ARG);
+    pSsrcTable = *ppSsrcTable;
+    CHK(pSsrcTable != NULL, retStatus);
+
+    pSsrcTableSlots = (PSsrcTableSlots) ATOMIC_LOAD(&pSsrcTable->currentSlots);
+    while (pSsrcTableSlots != NULL) {
+        pRetired = pSsrcTableSlots->pRetired;
+        MEMFREE(pSsrcTableSlots);
+        pSsrcTableSlots = pRetired;
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pSsrcTable->lock)) {
+        MUTEX_FREE(pSsrcTable->lock);
+    }
+
+    SAFE_MEMFREE(*ppSsrcTable);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+STATUS ssrcTablePut(PSsrcTable pSsrcTable, UINT32 ssrc, SSRC_TABLE_KIND kind, UINT64 item)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PSsrcTableSlots pSsrcTableSlots = NULL, pGrownSlots = NULL;
+    PSsrcTableSlot pSlot = NULL;
+    BOOL locked = FALSE;
+    UINT32 i;
+
+    CHK(pSsrcTable != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pSsrcTable->lock);
+    locked = TRUE;
+
+    pSsrcTableSlots = (PSsrcTableSlots) ATOMIC_LOAD(&pSsrcTable->currentSlots);
+    if ((pSlot = ssrcTableFindSlot(pSsrcTableSlots, ssrc, (UINT32) kind)) != NULL) {
+        ATOMIC_STORE(&pSlot->item, (SIZE_T) item);
+    } else {
+        if (2 * (pSsrcTableSlots->usedCount + 1) > pSsrcTableSlots->capacity) {
+            // Readers may still be probing the current slots, fill a bigger copy and publish it once complete
+            CHK_STATUS(createSsrcTableSlots(2 * pSsrcTableSlots->capacity, &pGrownSlots));
+            for (i = 0; i < pSsrcTableSlots->capacity; i++) {
+                pSlot = &pSsrcTableSlots->slots[i];
+                if (ATOMIC_LOAD(&pSlot->used)) {
+                    ssrcTableInsertSlot(pGrownSlots, pSlot->ssrc, pSlot->kind, (UINT64) ATOMIC_LOAD(&pSlot->item));
+                }
+            }
+            pGrownSlots->pRetired = pSsrcTableSlots;
+            ATOMIC_STORE(&pSsrcTable->currentSlots, (SIZE_T) pGrownSlots);
+            pSsrcTableSlots = pGrownSlots;
+        }
+
+        ssrcTableInsertSlot(pSsrcTableSlots, ssrc, (UINT32) kind, item);
+    }
+
+    // The ssrc might have been reported as unknown already
+    MEMSET(pSsrcTable->unknownSsrcs, 0x00, SIZEOF(pSsrcTable->unknownSsrcs));
+
+CleanUp:
+    if (locked) {
+        MUTEX_UNLOCK(pSsrcTable->lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS ssrcTableGet(PSsrcTable pSsrcTable, UINT32 ssrc, SSRC_TABLE_KIND kind, PUINT64 pItem)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSsrcTableSlot pSlot = NULL;
+    UINT64 item = 0;
+
+    CHK(pSsrcTable != NULL && pItem != NULL, STATUS_NULL_ARG);
+
+    pSlot = ssrcTableFindSlot((PSsrcTableSlots) ATOMIC_LOAD(&pSsrcTable->currentSlots), ssrc, (UINT32) kind);
+    CHK(pSlot != NULL, STATUS_NOT_FOUND);
+    item = (UINT64) ATOMIC_LOAD(&pSlot->item);
+    CHK(item != 0, STATUS_NOT_FOUND);
+
+CleanUp:
+    if (pItem != NULL) {
+        *pItem = item;
+    }
+
+    return retStatus;
+}
+
+BOOL ssrcTableReportUnknown(PSsrcTable pSsrcTable, UINT32 ssrc)
+{
+    PUINT64 pCached = NULL;
+
+    if (pSsrcTable == NULL) {
+        return TRUE;
+    }
+
+    pCached = &pSsrcTable->unknownSsrcs[SSRC_TABLE_HASH(ssrc, 0) % SSRC_TABLE_UNKNOWN_CACHE_SIZE];
+    if (*pCached == (SSRC_TABLE_UNKNOWN_CACHE_TAG | ssrc)) {
+        return FALSE;
+    }
+
+    *pCached = SSRC_TABLE_UNKNOWN_CACHE_TAG | ssrc;
+    return TRUE;
+}
+
+STATUS createSsrcTableSlots(UINT32 capacity, PSsrcTableSlots* ppSsrcTableSlots)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSsrcTableSlots pSsrcTableSlots = NULL;
+
+    CHK(ppSsrcTableSlots != NULL, STATUS_NULL_ARG);
+
+    pSsrcTableSlots = (PSsrcTableSlots) MEMCALLOC(1, SIZEOF(SsrcTableSlots) + capacity * SIZEOF(SsrcTableSlot));
+    CHK(pSsrcTableSlots != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pSsrcTableSlots->capacity = capacity;
+    pSsrcTableSlots->slots = (PSsrcTableSlot) (pSsrcTableSlots + 1);
+
+CleanUp:
+    if (ppSsrcTableSlots != NULL) {
+        *ppSsrcTableSlots = pSsrcTableSlots;
+    }
+
+    return retStatus;
+}
+
+PSsrcTableSlot ssrcTableFindSlot(PSsrcTableSlots pSsrcTableSlots, UINT32 ssrc, UINT32 kind)
+{
+    UINT32 mask = pSsrcTableSlots->capacity - 1, index = SSRC_TABLE_HASH(ssrc, kind) & mask, i;
+    PSsrcTableSlot pSlot;
+
+    // Linear probing, the table is never more than half full so an unused slot ends the search
+    for (i = 0; i < pSsrcTableSlots->capacity; i++) {
+        pSlot = &pSsrcTableSlots->slots[(index + i) & mask];
+        if (!ATOMIC_LOAD(&pSlot->used)) {
+            break;
+        }
+        if (pSlot->ssrc == ssrc && pSlot->kind == kind) {
+            return pSlot;
+        }
+    }
+
+    return NULL;
+}
+
+VOID ssrcTableInsertSlot(PSsrcTableSlots pSsrcTableSlots, UINT32 ssrc, UINT32 kind, UINT64 item)
+{
+    UINT32 mask = pSsrcTableSlots->capacity - 1, index = SSRC_TABLE_HASH(ssrc, kind) & mask;
+    PSsrcTableSlot pSlot = &pSsrcTableSlots->slots[index];
+
+    while (ATOMIC_LOAD(&pSlot->used)) {
+        index = (index + 1) & mask;
+        pSlot = &pSsrcTableSlots->slots[index];
+    }
+
+    pSlot->ssrc = ssrc;
+    pSlot->kind = kind;
+    ATOMIC_STORE(&pSlot->item, (SIZE_T) item);
+    // Publishes the key to concurrent readers
+    ATOMIC_STORE(&pSlot->used, (SIZE_T) TRUE);
+    pSsrcTableSlots->usedCount++;
+}
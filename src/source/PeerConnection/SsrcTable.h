@@ -0,0 +1,102 @@
+/*******************************************
+SsrcTable internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_SSRC_TABLE__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_SSRC_TABLE__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Power of 2, the table doubles whenever it gets half full
+#define SSRC_TABLE_INITIAL_CAPACITY 16
+
+// Number of unknown ssrcs remembered so that each of them is only reported once
+#define SSRC_TABLE_UNKNOWN_CACHE_SIZE 16
+
+/**
+ * The same ssrc can be indexed once per kind, e.g. as the sender ssrc of a transceiver and the receiver ssrc of another one
+ */
+typedef enum {
+    SSRC_TABLE_KIND_SENDER = 0,
+    SSRC_TABLE_KIND_RTX = 1,
+    SSRC_TABLE_KIND_RECEIVER = 2,
+    // Retransmissions of a receiver ssrc by the remote peer
+    SSRC_TABLE_KIND_RECEIVER_RTX = 3,
+} SSRC_TABLE_KIND;
+
+typedef struct {
+    // Written before the slot is marked used and never changed afterwards
+    UINT32 ssrc;
+    UINT32 kind;
+    volatile SIZE_T item;
+    // Set last. Slots are never reused so that readers can not see a half written key
+    volatile SIZE_T used;
+} SsrcTableSlot, *PSsrcTableSlot;
+
+typedef struct __SsrcTableSlots SsrcTableSlots;
+struct __SsrcTableSlots {
+    UINT32 capacity;
+    UINT32 usedCount;
+    PSsrcTableSlot slots;
+    // Smaller table this one replaced. Readers do not take any lock, so it is only freed along with the table
+    struct __SsrcTableSlots* pRetired;
+};
+typedef struct __SsrcTableSlots* PSsrcTableSlots;
+
+/**
+ * ssrc to item index, read without any lock on the packet receive path. Writers are serialized by the table lock and
+ * publish a bigger copy of the slots when the table grows.
+ */
+typedef struct {
+    MUTEX lock;
+    // PSsrcTableSlots currently in use
+    volatile SIZE_T currentSlots;
+    // Unknown ssrcs already reported, tagged with SSRC_TABLE_UNKNOWN_CACHE_TAG. Racy by design as it only rate limits logs
+    UINT64 unknownSsrcs[SSRC_TABLE_UNKNOWN_CACHE_SIZE];
+} SsrcTable, *PSsrcTable;
+
+#define SSRC_TABLE_UNKNOWN_CACHE_TAG ((UINT64) 1 << 32)
+
+STATUS createSsrcTable(PSsrcTable*);
+STATUS freeSsrcTable(PSsrcTable*);
+
+/**
+ * Index an item, replacing the item previously indexed with the same ssrc and kind
+ *
+ * @param - PSsrcTable - IN - table
+ * @param - UINT32 - IN - ssrc
+ * @param - SSRC_TABLE_KIND - IN - kind of the ssrc
+ * @param - UINT64 - IN - pointer sized item
+ *
+ * @return - STATUS status of execution
+ */
+STATUS ssrcTablePut(PSsrcTable, UINT32, SSRC_TABLE_KIND, UINT64);
+
+/**
+ * Lock free lookup
+ *
+ * @return - STATUS STATUS_NOT_FOUND when nothing is indexed with this ssrc and kind
+ */
+STATUS ssrcTableGet(PSsrcTable, UINT32, SSRC_TABLE_KIND, PUINT64);
+
+/**
+ * Remember an ssrc that could not be found
+ *
+ * @return - BOOL - TRUE the first time the ssrc is seen since the table last changed, meaning it should be reported
+ */
+BOOL ssrcTableReportUnknown(PSsrcTable, UINT32);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+STATUS createSsrcTableSlots(UINT32, PSsrcTableSlots*);
+PSsrcTableSlot ssrcTableFindSlot(PSsrcTableSlots, UINT32, UINT32);
+VOID ssrcTableInsertSlot(PSsrcTableSlots, UINT32, UINT32, UINT64);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_SSRC_TABLE__ */
@@ -0,0 +1,171 @@
+#define LOG_CLASS "TwccFeedbackGenerator"
+
+#include "../Include_i.h"
+
+STATUS createTwccFeedbackGenerator(TIMER_QUEUE_HANDLE timerQueueHandle, UINT32 senderSsrc, TwccFeedbackGeneratorSendFunc sendFn, UINT64 customData,
+                                   PTwccFeedbackGenerator* ppTwccFeedbackGenerator)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PTwccFeedbackGenerator pTwccFeedbackGenerator = NULL;
+
+    CHK(sendFn != NULL && ppTwccFeedbackGenerator != NULL, STATUS_NULL_ARG);
+
+    CHK(NULL != (pTwccFeedbackGenerator = (PTwccFeedbackGenerator) MEMCALLOC(1, SIZEOF(TwccFeedbackGenerator))), STATUS_NOT_ENOUGH_MEMORY);
+    pTwccFeedbackGenerator->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pTwccFeedbackGenerator->lock), STATUS_INVALID_OPERATION);
+    pTwccFeedbackGenerator->timerQueueHandle = timerQueueHandle;
+    pTwccFeedbackGenerator->timerId = MAX_UINT32;
+    pTwccFeedbackGenerator->sendFn = sendFn;
+    pTwccFeedbackGenerator->customData = customData;
+    pTwccFeedbackGenerator->senderSsrc = senderSsrc;
+
+    if (IS_VALID_TIMER_QUEUE_HANDLE(timerQueueHandle)) {
+        CHK_STATUS(sharedTimerQueueAddTimer(timerQueueHandle, TWCC_FEEDBACK_GENERATOR_INTERVAL, TWCC_FEEDBACK_GENERATOR_INTERVAL,
+                                            twccFeedbackGeneratorTimerCallback, (UINT64) pTwccFeedbackGenerator, &pTwccFeedbackGenerator->timerId));
+    }
+
+    *ppTwccFeedbackGenerator = pTwccFeedbackGenerator;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freeTwccFeedbackGenerator(&pTwccFeedbackGenerator);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeTwccFeedbackGenerator(PTwccFeedbackGenerator* ppTwccFeedbackGenerator)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PTwccFeedbackGenerator pTwccFeedbackGenerator = NULL;
+
+    CHK(ppTwccFeedbackGenerator != NULL, STATUS_NULL_ARG);
+    pTwccFeedbackGenerator = *ppTwccFeedbackGenerator;
+    CHK(pTwccFeedbackGenerator != NULL, retStatus);
+
+    // Waits for a running timer callback to return
+    if (pTwccFeedbackGenerator->timerId != MAX_UINT32) {
+        CHK_LOG_ERR(sharedTimerQueueCancelTimer(pTwccFeedbackGenerator->timerQueueHandle, pTwccFeedbackGenerator->timerId,
+                                                (UINT64) pTwccFeedbackGenerator));
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pTwccFeedbackGenerator->lock)) {
+        MUTEX_FREE(pTwccFeedbackGenerator->lock);
+    }
+
+    SAFE_MEMFREE(*ppTwccFeedbackGenerator);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS twccFeedbackGeneratorOnPacket(PTwccFeedbackGenerator pTwccFeedbackGenerator, UINT16 sequenceNumber, UINT32 ssrc, UINT64 currentTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 unwrappedSequenceNumber, i;
+    BOOL locked = FALSE;
+
+    CHK(pTwccFeedbackGenerator != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pTwccFeedbackGenerator->lock);
+    locked = TRUE;
+
+    if (!pTwccFeedbackGenerator->started) {
+        pTwccFeedbackGenerator->started = TRUE;
+        // Kept away from 0 so that a packet reordered before the first one does not wrap around
+        pTwccFeedbackGenerator->highestSequenceNumber = MAX_RTP_SEQUENCE_NUM + 1 + sequenceNumber;
+        pTwccFeedbackGenerator->nextSequenceNumber = pTwccFeedbackGenerator->highestSequenceNumber;
+    }
+
+    unwrappedSequenceNumber = (UINT64) ((INT64) pTwccFeedbackGenerator->highestSequenceNumber +
+                                        (INT16) (sequenceNumber - (UINT16) pTwccFeedbackGenerator->highestSequenceNumber));
+    // Already reported as lost
+    CHK(unwrappedSequenceNumber >= pTwccFeedbackGenerator->nextSequenceNumber, retStatus);
+
+    if (unwrappedSequenceNumber >= pTwccFeedbackGenerator->nextSequenceNumber + TWCC_FEEDBACK_GENERATOR_WINDOW) {
+        DLOGW("TWCC feedback fell behind, %" PRIu64 " packets are not reported",
+              unwrappedSequenceNumber - TWCC_FEEDBACK_GENERATOR_WINDOW + 1 - pTwccFeedbackGenerator->nextSequenceNumber);
+        for (i = 0; i < TWCC_FEEDBACK_GENERATOR_WINDOW; i++) {
+            pTwccFeedbackGenerator->arrivalTimes[i] = 0;
+        }
+        pTwccFeedbackGenerator->nextSequenceNumber = unwrappedSequenceNumber - TWCC_FEEDBACK_GENERATOR_WINDOW + 1;
+    }
+
+    pTwccFeedbackGenerator->arrivalTimes[unwrappedSequenceNumber % TWCC_FEEDBACK_GENERATOR_WINDOW] = currentTime;
+    pTwccFeedbackGenerator->highestSequenceNumber = MAX(pTwccFeedbackGenerator->highestSequenceNumber, unwrappedSequenceNumber);
+    pTwccFeedbackGenerator->mediaSsrc = ssrc;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pTwccFeedbackGenerator->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS twccFeedbackGeneratorProcess(PTwccFeedbackGenerator pTwccFeedbackGenerator)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE packet[TWCC_FB_MAX_PACKET_LEN];
+    UINT64 arrivalTimes[TWCC_FB_MAX_PACKET_STATUS_COUNT];
+    UINT32 i, count, packetLen;
+    PUINT64 pArrivalTime;
+    BOOL locked = FALSE, done = FALSE;
+
+    CHK(pTwccFeedbackGenerator != NULL, STATUS_NULL_ARG);
+
+    while (!done) {
+        MUTEX_LOCK(pTwccFeedbackGenerator->lock);
+        locked = TRUE;
+
+        CHK(pTwccFeedbackGenerator->started && pTwccFeedbackGenerator->nextSequenceNumber <= pTwccFeedbackGenerator->highestSequenceNumber,
+            retStatus);
+
+        count = (UINT32) MIN(pTwccFeedbackGenerator->highestSequenceNumber - pTwccFeedbackGenerator->nextSequenceNumber + 1,
+                             TWCC_FB_MAX_PACKET_STATUS_COUNT);
+        for (i = 0; i < count; i++) {
+            pArrivalTime = &pTwccFeedbackGenerator->arrivalTimes[(pTwccFeedbackGenerator->nextSequenceNumber + i) % TWCC_FEEDBACK_GENERATOR_WINDOW];
+            arrivalTimes[i] = *pArrivalTime;
+            *pArrivalTime = 0;
+        }
+
+        packetLen = SIZEOF(packet);
+        CHK_STATUS(createRtcpTwccPacket(pTwccFeedbackGenerator->senderSsrc, pTwccFeedbackGenerator->mediaSsrc,
+                                        (UINT16) pTwccFeedbackGenerator->nextSequenceNumber, arrivalTimes, (UINT16) count,
+                                        pTwccFeedbackGenerator->feedbackPacketCount++, packet, &packetLen));
+        pTwccFeedbackGenerator->nextSequenceNumber += count;
+        done = pTwccFeedbackGenerator->nextSequenceNumber > pTwccFeedbackGenerator->highestSequenceNumber;
+
+        MUTEX_UNLOCK(pTwccFeedbackGenerator->lock);
+        locked = FALSE;
+
+        CHK_STATUS(pTwccFeedbackGenerator->sendFn(pTwccFeedbackGenerator->customData, packet, packetLen));
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pTwccFeedbackGenerator->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS twccFeedbackGeneratorTimerCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData)
+{
+    UNUSED_PARAM(timerId);
+    UNUSED_PARAM(currentTime);
+
+    CHK_LOG_ERR(twccFeedbackGeneratorProcess((PTwccFeedbackGenerator) customData));
+
+    return STATUS_SUCCESS;
+}
@@ -0,0 +1,100 @@
+/*******************************************
+TwccFeedbackGenerator internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_TWCC_FEEDBACK_GENERATOR__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_TWCC_FEEDBACK_GENERATOR__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Period of the generator timer, the remote sender gets a fresh delay signal this often
+#define TWCC_FEEDBACK_GENERATOR_INTERVAL (50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// Packets awaiting feedback, indexed by transport-wide sequence number modulo this. Several intervals worth at high bitrates
+#define TWCC_FEEDBACK_GENERATOR_WINDOW 1024
+
+/**
+ * Sends one serialized feedback packet. Invoked without the generator lock held.
+ *
+ * @param - UINT64 - IN - customData given to createTwccFeedbackGenerator
+ * @param - PBYTE - IN - RTCP transport-wide feedback packet
+ * @param - UINT32 - IN - length of the packet
+ *
+ * @return - STATUS status of execution
+ */
+typedef STATUS (*TwccFeedbackGeneratorSendFunc)(UINT64, PBYTE, UINT32);
+
+/**
+ * Records the transport-wide sequence number and arrival time of the inbound packets and reports them periodically
+ * in RTCP transport-wide feedback, https://tools.ietf.org/html/draft-holmer-rmcat-transport-wide-cc-extensions-01
+ */
+typedef struct {
+    MUTEX lock;
+
+    TIMER_QUEUE_HANDLE timerQueueHandle;
+    UINT32 timerId;
+
+    TwccFeedbackGeneratorSendFunc sendFn;
+    UINT64 customData;
+
+    UINT32 senderSsrc;
+    // Media source of the latest packet
+    UINT32 mediaSsrc;
+
+    BOOL started;
+    // Unwrapped transport-wide sequence numbers
+    UINT64 highestSequenceNumber;
+    // First one not reported yet
+    UINT64 nextSequenceNumber;
+    UINT8 feedbackPacketCount;
+
+    // Arrival time of the packets not reported yet, 0 when not received
+    UINT64 arrivalTimes[TWCC_FEEDBACK_GENERATOR_WINDOW];
+} TwccFeedbackGenerator, *PTwccFeedbackGenerator;
+
+/**
+ * Create a TWCC feedback generator. When the timer queue handle is valid it runs periodically from it, otherwise only
+ * by twccFeedbackGeneratorProcess calls.
+ *
+ * @param - TIMER_QUEUE_HANDLE - IN - timer queue to run from
+ * @param - UINT32 - IN - SSRC the feedback is sent from
+ * @param - TwccFeedbackGeneratorSendFunc - IN - function sending the feedback
+ * @param - UINT64 - IN - custom data for the send function
+ * @param - PTwccFeedbackGenerator* - OUT - the new generator
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createTwccFeedbackGenerator(TIMER_QUEUE_HANDLE, UINT32, TwccFeedbackGeneratorSendFunc, UINT64, PTwccFeedbackGenerator*);
+
+/**
+ * Cancel the generator timer and free the generator
+ */
+STATUS freeTwccFeedbackGenerator(PTwccFeedbackGenerator*);
+
+/**
+ * Record a received packet. Packets arriving after their sequence number was reported are ignored.
+ *
+ * @param - PTwccFeedbackGenerator - IN - the generator
+ * @param - UINT16 - IN - transport-wide sequence number of the packet
+ * @param - UINT32 - IN - SSRC of the packet
+ * @param - UINT64 - IN - time the packet was received at
+ */
+STATUS twccFeedbackGeneratorOnPacket(PTwccFeedbackGenerator, UINT16, UINT32, UINT64);
+
+/**
+ * Report the packets recorded since the last run, in as many feedback packets as needed
+ */
+STATUS twccFeedbackGeneratorProcess(PTwccFeedbackGenerator);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+STATUS twccFeedbackGeneratorTimerCallback(UINT32, UINT64, UINT64);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_PEERCONNECTION_TWCC_FEEDBACK_GENERATOR__ */
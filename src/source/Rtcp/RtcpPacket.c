@@ -79,6 +79,85 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Write a generic NACK, https://tools.ietf.org/html/rfc4585#section-6.2.1
+ *
+ * The sequence numbers are expected in increasing order, those following a PID within 16 are folded into its BLP.
+ * When pPacket is NULL only the length is computed. Otherwise pPacketLen holds the size of pPacket on input.
+ */
+STATUS createRtcpNackPacket(PUINT16 pSequenceNumberList, UINT32 sequenceNumberListLen, UINT32 senderSsrc, UINT32 mediaSsrc, PBYTE pPacket,
+                            PUINT32 pPacketLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, fciCount = 0, packetLen;
+    UINT16 pid, blp, diff;
+    PBYTE pCurPtr;
+
+    CHK(pSequenceNumberList != NULL && pPacketLen != NULL, STATUS_NULL_ARG);
+    CHK(sequenceNumberListLen > 0, STATUS_INVALID_ARG);
+
+    for (i = 0; i < sequenceNumberListLen; fciCount++) {
+        pid = pSequenceNumberList[i++];
+        while (i < sequenceNumberListLen && (diff = (UINT16) (pSequenceNumberList[i] - pid)) >= 1 && diff <= 16) {
+            i++;
+        }
+    }
+    packetLen = RTCP_PACKET_HEADER_LEN + RTCP_NACK_LIST_LEN + fciCount * RTCP_NACK_FCI_LEN;
+
+    if (pPacket != NULL) {
+        CHK(*pPacketLen >= packetLen, STATUS_BUFFER_TOO_SMALL);
+        pPacket[0] = (RTCP_PACKET_VERSION_VAL << VERSION_SHIFT) | RTCP_FEEDBACK_MESSAGE_TYPE_NACK;
+        pPacket[RTCP_PACKET_TYPE_OFFSET] = RTCP_PACKET_TYPE_GENERIC_RTP_FEEDBACK;
+        putUnalignedInt16BigEndian(pPacket + RTCP_PACKET_LEN_OFFSET, (packetLen / RTCP_PACKET_LEN_WORD_SIZE) - 1);
+        putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN, senderSsrc);
+        putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN + 4, mediaSsrc);
+
+        pCurPtr = pPacket + RTCP_PACKET_HEADER_LEN + RTCP_NACK_LIST_LEN;
+        for (i = 0; i < sequenceNumberListLen; pCurPtr += RTCP_NACK_FCI_LEN) {
+            pid = pSequenceNumberList[i++];
+            blp = 0;
+            for (; i < sequenceNumberListLen && (diff = (UINT16) (pSequenceNumberList[i] - pid)) >= 1 && diff <= 16; i++) {
+                blp |= (UINT16) (1 << (diff - 1));
+            }
+            putUnalignedInt16BigEndian(pCurPtr, pid);
+            putUnalignedInt16BigEndian(pCurPtr + 2, blp);
+        }
+    }
+
+    *pPacketLen = packetLen;
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * Write a Picture Loss Indication, https://tools.ietf.org/html/rfc4585#section-6.3.1
+ *
+ * When pPacket is NULL only the length is computed. Otherwise pPacketLen holds the size of pPacket on input.
+ */
+STATUS createRtcpPliPacket(UINT32 senderSsrc, UINT32 mediaSsrc, PBYTE pPacket, PUINT32 pPacketLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pPacketLen != NULL, STATUS_NULL_ARG);
+
+    if (pPacket != NULL) {
+        CHK(*pPacketLen >= RTCP_PACKET_PLI_LEN, STATUS_BUFFER_TOO_SMALL);
+        pPacket[0] = (RTCP_PACKET_VERSION_VAL << VERSION_SHIFT) | RTCP_PSFB_PLI;
+        pPacket[RTCP_PACKET_TYPE_OFFSET] = RTCP_PACKET_TYPE_PAYLOAD_SPECIFIC_FEEDBACK;
+        putUnalignedInt16BigEndian(pPacket + RTCP_PACKET_LEN_OFFSET, (RTCP_PACKET_PLI_LEN / RTCP_PACKET_LEN_WORD_SIZE) - 1);
+        putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN, senderSsrc);
+        putUnalignedInt32BigEndian(pPacket + RTCP_PACKET_HEADER_LEN + 4, mediaSsrc);
+    }
+
+    *pPacketLen = RTCP_PACKET_PLI_LEN;
+
+CleanUp:
+
+    return retStatus;
+}
+
 // Assert that Application Layer Feedback payload is REMB
 STATUS isRembPacket(PBYTE pPayload, UINT32 payloadLen)
 {
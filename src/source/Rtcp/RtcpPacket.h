@@ -17,6 +17,7 @@ extern "C" {
 
 #define RTCP_PACKET_HEADER_LEN 4
 #define RTCP_NACK_LIST_LEN     8
+#define RTCP_NACK_FCI_LEN      4
 
 #define RTCP_PACKET_VERSION_VAL 2
 
@@ -30,6 +31,9 @@ extern "C" {
 #define RTCP_PACKET_RECEIVER_REPORT_BLOCK_LEN 24
 #define RTCP_PACKET_RECEIVER_REPORT_MINLEN    4 + RTCP_PACKET_RECEIVER_REPORT_BLOCK_LEN
 
+// Header, sender ssrc and media source ssrc, there is no FCI
+#define RTCP_PACKET_PLI_LEN 12
+
 // https://tools.ietf.org/html/rfc3550#section-4
 // If the participant has not yet sent an RTCP packet (the variable
 // initial is true), the constant Tmin is set to 2.5 seconds, else it
@@ -78,6 +82,8 @@ typedef struct {
 
 STATUS setRtcpPacketFromBytes(PBYTE, UINT32, PRtcpPacket);
 STATUS rtcpNackListGet(PBYTE, UINT32, PUINT32, PUINT32, PUINT16, PUINT32);
+STATUS createRtcpNackPacket(PUINT16, UINT32, UINT32, UINT32, PBYTE, PUINT32);
+STATUS createRtcpPliPacket(UINT32, UINT32, PBYTE, PUINT32);
 STATUS rembValueGet(PBYTE, UINT32, PDOUBLE, PUINT32, PUINT8);
 STATUS isRembPacket(PBYTE, UINT32);
 
@@ -45,7 +45,7 @@ STATUS freeRtpRollingBufferData(PUINT64 pData)
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     CHK(pData != NULL, STATUS_NULL_ARG);
-    CHK_STATUS(freeRtpPacket((PRtpPacket*) pData));
+    CHK_STATUS(rtpPacketBufferRelease((PRtpPacketBuffer*) pData));
 CleanUp:
     LEAVES();
     return retStatus;
@@ -55,23 +55,74 @@ STATUS rtpRollingBufferAddRtpPacket(PRtpRollingBuffer pRollingBuffer, PRtpPacket
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PRtpPacket pRtpPacketCopy = NULL;
-    PBYTE pRawPacketCopy = NULL;
-    UINT64 index = 0;
+    PRtpPacketBuffer pRtpPacketBuffer = NULL;
     CHK(pRollingBuffer != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
 
-    pRawPacketCopy = (PBYTE) MEMALLOC(pRtpPacket->rawPacketLength);
-    CHK(pRawPacketCopy != NULL, STATUS_NOT_ENOUGH_MEMORY);
-    MEMCPY(pRawPacketCopy, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength);
-    CHK_STATUS(createRtpPacketFromBytes(pRawPacketCopy, pRtpPacket->rawPacketLength, &pRtpPacketCopy));
-    // pRtpPacketCopy took ownership of pRawPacketCopy
-    pRawPacketCopy = NULL;
+    CHK_STATUS(createRtpPacketBuffer(0, pRtpPacket->rawPacketLength, 0, &pRtpPacketBuffer));
+    MEMCPY(pRtpPacketBuffer->packet.pRawPacket, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength);
+    CHK_STATUS(rtpPacketBufferSetLength(pRtpPacketBuffer, pRtpPacket->rawPacketLength));
+    CHK_STATUS(rtpRollingBufferAddRtpPacketBuffer(pRollingBuffer, pRtpPacketBuffer));
+
+CleanUp:
+    rtpPacketBufferRelease(&pRtpPacketBuffer);
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
 
-    CHK_STATUS(rollingBufferAppendData(pRollingBuffer->pRollingBuffer, (UINT64) pRtpPacketCopy, &index));
+STATUS rtpRollingBufferAddRtpPacketBuffer(PRtpRollingBuffer pRollingBuffer, PRtpPacketBuffer pRtpPacketBuffer)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL addedRef = FALSE;
+    UINT64 index = 0;
+    CHK(pRollingBuffer != NULL && pRtpPacketBuffer != NULL, STATUS_NULL_ARG);
+
+    // The rolling buffer keeps its own reference, dropped by freeRtpRollingBufferData on eviction
+    CHK_STATUS(rtpPacketBufferAddRef(pRtpPacketBuffer));
+    addedRef = TRUE;
+    CHK_STATUS(rollingBufferAppendData(pRollingBuffer->pRollingBuffer, (UINT64) pRtpPacketBuffer, &index));
     pRollingBuffer->lastIndex = index;
 
 CleanUp:
-    SAFE_MEMFREE(pRawPacketCopy);
+    if (STATUS_FAILED(retStatus) && addedRef) {
+        rtpPacketBufferRelease(&pRtpPacketBuffer);
+    }
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS rtpRollingBufferGetRtpPacketBuffer(PRtpRollingBuffer pRollingBuffer, UINT64 index, PRtpPacketBuffer* ppRtpPacketBuffer)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRollingBuffer pBuffer = NULL;
+    PRtpPacketBuffer pRtpPacketBuffer = NULL;
+    BOOL isLocked = FALSE;
+    CHK(pRollingBuffer != NULL && ppRtpPacketBuffer != NULL, STATUS_NULL_ARG);
+
+    pBuffer = pRollingBuffer->pRollingBuffer;
+
+    // Take the reference with the lock held so that a concurrent eviction can not free the packet under us
+    MUTEX_LOCK(pBuffer->lock);
+    isLocked = TRUE;
+    if (pBuffer->headIndex > index && pBuffer->tailIndex <= index) {
+        pRtpPacketBuffer = (PRtpPacketBuffer) pBuffer->dataBuffer[ROLLING_BUFFER_MAP_INDEX(pBuffer, index)];
+        if (pRtpPacketBuffer != NULL) {
+            CHK_STATUS(rtpPacketBufferAddRef(pRtpPacketBuffer));
+        }
+    }
+
+CleanUp:
+    if (isLocked) {
+        MUTEX_UNLOCK(pBuffer->lock);
+    }
+    if (ppRtpPacketBuffer != NULL) {
+        *ppRtpPacketBuffer = pRtpPacketBuffer;
+    }
     CHK_LOG_ERR(retStatus);
 
     LEAVES();
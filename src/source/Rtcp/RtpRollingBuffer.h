@@ -10,6 +10,10 @@ RTCP Rolling Buffer include file
 extern "C" {
 #endif
 
+/*
+ * Sent packets kept for retransmission. Every slot holds a reference on a PRtpPacketBuffer which is released when the
+ * packet is evicted.
+ */
 typedef struct {
     PRollingBuffer pRollingBuffer;
     // index of last rtp packet in rolling buffer
@@ -20,6 +24,8 @@ STATUS createRtpRollingBuffer(UINT32, PRtpRollingBuffer*);
 STATUS freeRtpRollingBuffer(PRtpRollingBuffer*);
 STATUS freeRtpRollingBufferData(PUINT64);
 STATUS rtpRollingBufferAddRtpPacket(PRtpRollingBuffer, PRtpPacket);
+STATUS rtpRollingBufferAddRtpPacketBuffer(PRtpRollingBuffer, PRtpPacketBuffer);
+STATUS rtpRollingBufferGetRtpPacketBuffer(PRtpRollingBuffer, UINT64, PRtpPacketBuffer*);
 STATUS rtpRollingBufferGetValidSeqIndexList(PRtpRollingBuffer, PUINT16, UINT32, PUINT64, PUINT32);
 
 #ifdef __cplusplus
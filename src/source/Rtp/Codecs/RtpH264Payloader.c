@@ -13,6 +13,7 @@ STATUS createPayloadForH264(UINT32 mtu, PBYTE nalus, UINT32 nalusLength, PBYTE p
     UINT32 startIndex = 0;
     UINT32 singlePayloadLength = 0;
     UINT32 singlePayloadSubLenSize = 0;
+    UINT32 consumedLength = 0;
     BOOL sizeCalculationOnly = (payloadBuffer == NULL);
     PayloadArray payloadArray;
 
@@ -42,20 +43,27 @@ STATUS createPayloadForH264(UINT32 mtu, PBYTE nalus, UINT32 nalusLength, PBYTE p
 
         CHK(remainNalusLength != 0, retStatus);
 
+        // Small NAL units that follow each other, like the parameter sets of a keyframe, share a STAP-A packet
+        CHK_STATUS(createStapAPayloadFromNalus(mtu, curPtrInNalus, remainNalusLength, nextNaluLength, sizeCalculationOnly ? NULL : &payloadArray,
+                                               &singlePayloadLength, &singlePayloadSubLenSize, &consumedLength));
+        if (consumedLength == 0) {
+            consumedLength = nextNaluLength;
+            CHK_STATUS(createPayloadFromNalu(mtu, curPtrInNalus, nextNaluLength, sizeCalculationOnly ? NULL : &payloadArray, &singlePayloadLength,
+                                             &singlePayloadSubLenSize));
+        }
+
         if (sizeCalculationOnly) {
-            CHK_STATUS(createPayloadFromNalu(mtu, curPtrInNalus, nextNaluLength, NULL, &singlePayloadLength, &singlePayloadSubLenSize));
             payloadArray.payloadLength += singlePayloadLength;
             payloadArray.payloadSubLenSize += singlePayloadSubLenSize;
         } else {
-            CHK_STATUS(createPayloadFromNalu(mtu, curPtrInNalus, nextNaluLength, &payloadArray, &singlePayloadLength, &singlePayloadSubLenSize));
             payloadArray.payloadBuffer += singlePayloadLength;
             payloadArray.payloadSubLength += singlePayloadSubLenSize;
             payloadArray.maxPayloadLength -= singlePayloadLength;
             payloadArray.maxPayloadSubLenSize -= singlePayloadSubLenSize;
         }
 
-        remainNalusLength -= nextNaluLength;
-        curPtrInNalus += nextNaluLength;
+        remainNalusLength -= consumedLength;
+        curPtrInNalus += consumedLength;
     } while (remainNalusLength != 0);
 
 CleanUp:
@@ -224,6 +232,78 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createStapAPayloadFromNalus(UINT32 mtu, PBYTE nalus, UINT32 nalusLength, UINT32 firstNaluLength, PPayloadArray pPayloadArray,
+                                   PUINT32 filledLength, PUINT32 filledSubLenSize, PUINT32 pConsumedLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE pCurPtrInNalus = NULL, pPayload = NULL;
+    UINT32 remainNalusLength = 0, startIndex = 0, naluLength = 0, naluCount = 0, payloadLength = 0, consumedLength = 0, i;
+    BYTE forbiddenBit = 0, naluRefIdc = 0;
+    BOOL sizeCalculationOnly = (pPayloadArray == NULL);
+
+    CHK(nalus != NULL && filledLength != NULL && filledSubLenSize != NULL && pConsumedLength != NULL, STATUS_NULL_ARG);
+    CHK(sizeCalculationOnly || (pPayloadArray->payloadSubLength != NULL && pPayloadArray->payloadBuffer != NULL), STATUS_NULL_ARG);
+    CHK(firstNaluLength > 0 && firstNaluLength <= nalusLength, retStatus);
+
+    // NAL units are taken while they fit in the MTU along with their size fields, https://tools.ietf.org/html/rfc6184#section-5.7.1
+    payloadLength = STAP_A_HEADER_SIZE + SIZEOF(UINT16) + firstNaluLength;
+    CHK(payloadLength <= mtu, retStatus);
+    naluCount = 1;
+    consumedLength = firstNaluLength;
+    pCurPtrInNalus = nalus + firstNaluLength;
+    remainNalusLength = nalusLength - firstNaluLength;
+    while (remainNalusLength != 0 && STATUS_SUCCEEDED(getNextNaluLength(pCurPtrInNalus, remainNalusLength, &startIndex, &naluLength)) &&
+           naluLength > 0 && payloadLength + SIZEOF(UINT16) + naluLength <= mtu) {
+        payloadLength += SIZEOF(UINT16) + naluLength;
+        naluCount++;
+        pCurPtrInNalus += startIndex + naluLength;
+        remainNalusLength -= startIndex + naluLength;
+        consumedLength = (UINT32) (pCurPtrInNalus - nalus);
+    }
+
+    // A NAL unit on its own is sent as is
+    CHK(naluCount > 1, retStatus);
+
+    if (!sizeCalculationOnly) {
+        CHK(pPayloadArray->maxPayloadSubLenSize >= 1 && payloadLength <= pPayloadArray->maxPayloadLength, STATUS_BUFFER_TOO_SMALL);
+
+        pPayload = pPayloadArray->payloadBuffer + STAP_A_HEADER_SIZE;
+        pCurPtrInNalus = nalus;
+        naluLength = firstNaluLength;
+        for (i = 0; i < naluCount; i++) {
+            if (i > 0) {
+                CHK_STATUS(getNextNaluLength(pCurPtrInNalus, (UINT32) (nalus + consumedLength - pCurPtrInNalus), &startIndex, &naluLength));
+                pCurPtrInNalus += startIndex;
+            }
+
+            // The F bit is set if any NAL unit has it, and NRI is the highest of them
+            forbiddenBit |= pCurPtrInNalus[0] & 0x80;
+            naluRefIdc = MAX(naluRefIdc, pCurPtrInNalus[0] & 0x60);
+
+            putUnalignedInt16BigEndian((PINT16) pPayload, (UINT16) naluLength);
+            MEMCPY(pPayload + SIZEOF(UINT16), pCurPtrInNalus, naluLength);
+            pPayload += SIZEOF(UINT16) + naluLength;
+            pCurPtrInNalus += naluLength;
+        }
+
+        pPayloadArray->payloadBuffer[0] = forbiddenBit | naluRefIdc | STAP_A_INDICATOR;
+        pPayloadArray->payloadSubLength[0] = payloadLength;
+    }
+
+    *filledLength = payloadLength;
+    *filledSubLenSize = 1;
+    *pConsumedLength = consumedLength;
+
+CleanUp:
+    if (pConsumedLength != NULL && (STATUS_FAILED(retStatus) || naluCount <= 1)) {
+        *pConsumedLength = 0;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS depayH264FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNaluData, PUINT32 pNaluLength, PBOOL pIsStart)
 {
     ENTERS();
@@ -234,14 +314,13 @@ STATUS depayH264FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNal
     UINT8 indicator = 0;
     BOOL sizeCalculationOnly = (pNaluData == NULL);
     BOOL isStartingPacket = FALSE;
-    PBYTE pCurPtr = pRawPacket;
+    PBYTE pCurPtr = pRawPacket, pEnd = pRawPacket + packetLength;
     static BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
     UINT16 subNaluSize = 0;
 
     CHK(pRawPacket != NULL && pNaluLength != NULL, STATUS_NULL_ARG);
     CHK(packetLength > 0, retStatus);
 
-    // TODO: Add support for Aggregate Packets https://tools.ietf.org/html/rfc6184#section-5.7
     // indicator for types https://tools.ietf.org/html/rfc3984#section-5.2
     indicator = *pRawPacket & NAL_TYPE_MASK;
     switch (indicator) {
@@ -262,23 +341,15 @@ STATUS depayH264FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNal
             naluLength = packetLength - FU_A_HEADER_SIZE + 1;
             break;
         case STAP_A_INDICATOR:
-            pCurPtr += STAP_A_HEADER_SIZE;
-            do {
-                subNaluSize = getUnalignedInt16BigEndian(pCurPtr);
-                pCurPtr += SIZEOF(UINT16);
-                naluLength += subNaluSize + SIZEOF(start4ByteCode);
-                pCurPtr += subNaluSize;
-            } while (subNaluSize > 0 && pCurPtr < pRawPacket + packetLength);
-            isStartingPacket = TRUE;
-            break;
         case STAP_B_INDICATOR:
-            pCurPtr += STAP_B_HEADER_SIZE;
-            do {
-                subNaluSize = getUnalignedInt16BigEndian(pCurPtr);
+            // Aggregation packets https://tools.ietf.org/html/rfc6184#section-5.7, each NAL unit gets its own start code
+            pCurPtr += indicator == STAP_A_INDICATOR ? STAP_A_HEADER_SIZE : STAP_B_HEADER_SIZE;
+            while (pCurPtr + SIZEOF(UINT16) <= pEnd && (subNaluSize = getUnalignedInt16BigEndian(pCurPtr)) > 0) {
                 pCurPtr += SIZEOF(UINT16);
+                CHK(pCurPtr + subNaluSize <= pEnd, STATUS_BUFFER_TOO_SMALL);
                 naluLength += subNaluSize + SIZEOF(start4ByteCode);
                 pCurPtr += subNaluSize;
-            } while (subNaluSize > 0 && pCurPtr < pRawPacket + packetLength);
+            }
             isStartingPacket = TRUE;
             break;
         default:
@@ -320,25 +391,11 @@ STATUS depayH264FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNal
             }
             break;
         case STAP_A_INDICATOR:
-            naluLength = 0;
-            pCurPtr = pRawPacket + STAP_A_HEADER_SIZE;
-            do {
-                subNaluSize = getUnalignedInt16BigEndian(pCurPtr);
-                pCurPtr += SIZEOF(UINT16);
-                MEMCPY(pNaluData, start4ByteCode, SIZEOF(start4ByteCode));
-                pNaluData += SIZEOF(start4ByteCode);
-                MEMCPY(pNaluData, pCurPtr, subNaluSize);
-                pCurPtr += subNaluSize;
-                pNaluData += subNaluSize;
-                naluLength += SIZEOF(start4ByteCode) + subNaluSize;
-            } while (subNaluSize > 0 && pCurPtr < pRawPacket + packetLength);
-            DLOGS("STAP_A_INDICATOR starting packet %d len %d", isStartingPacket, naluLength);
-            break;
         case STAP_B_INDICATOR:
+            // The sizes were checked against the packet above
             naluLength = 0;
-            pCurPtr = pRawPacket + STAP_A_HEADER_SIZE;
-            do {
-                subNaluSize = getUnalignedInt16BigEndian(pCurPtr);
+            pCurPtr = pRawPacket + (indicator == STAP_A_INDICATOR ? STAP_A_HEADER_SIZE : STAP_B_HEADER_SIZE);
+            while (pCurPtr + SIZEOF(UINT16) <= pEnd && (subNaluSize = getUnalignedInt16BigEndian(pCurPtr)) > 0) {
                 pCurPtr += SIZEOF(UINT16);
                 MEMCPY(pNaluData, start4ByteCode, SIZEOF(start4ByteCode));
                 pNaluData += SIZEOF(start4ByteCode);
@@ -346,8 +403,8 @@ STATUS depayH264FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNal
                 pCurPtr += subNaluSize;
                 pNaluData += subNaluSize;
                 naluLength += SIZEOF(start4ByteCode) + subNaluSize;
-            } while (subNaluSize > 0 && pCurPtr < pRawPacket + packetLength);
-            DLOGS("STAP_B_INDICATOR starting packet %d len %d", isStartingPacket, naluLength);
+            }
+            DLOGS("STAP indicator %d starting packet %d len %d", indicator, isStartingPacket, naluLength);
             break;
         default:
             DLOGS("Single NALU %d len %d", isStartingPacket, packetLength);
@@ -374,3 +431,62 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS depayH264SlicesFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PRtcFrameSlice pSlices, PUINT32 pSliceCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 capacity, sliceCount = 0, headerSize = 0;
+    UINT8 indicator = 0;
+    UINT16 subNaluSize = 0;
+    PBYTE pCurPtr = pRawPacket, pEnd = pRawPacket + packetLength;
+    static BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
+
+    CHK(pRawPacket != NULL && pSliceCount != NULL, STATUS_NULL_ARG);
+    capacity = *pSliceCount;
+    CHK(packetLength > 0, retStatus);
+
+    indicator = *pRawPacket & NAL_TYPE_MASK;
+    switch (indicator) {
+        case FU_A_INDICATOR:
+        case FU_B_INDICATOR:
+            headerSize = indicator == FU_A_INDICATOR ? FU_A_HEADER_SIZE : FU_B_HEADER_SIZE;
+            CHK(packetLength >= headerSize, STATUS_BUFFER_TOO_SMALL);
+            if ((pRawPacket[1] & (1 << 7)) != 0) {
+                appendRtpPayloadSlice(pSlices, capacity, &sliceCount, start4ByteCode, SIZEOF(start4ByteCode));
+                // Only when the slice below gets written
+                if (pSlices != NULL && sliceCount < capacity) {
+                    pRawPacket[headerSize - 1] = (pRawPacket[0] & 0x60) | (pRawPacket[1] & 0x1f);
+                }
+                appendRtpPayloadSlice(pSlices, capacity, &sliceCount, pRawPacket + headerSize - 1, packetLength - headerSize + 1);
+            } else {
+                appendRtpPayloadSlice(pSlices, capacity, &sliceCount, pRawPacket + headerSize, packetLength - headerSize);
+            }
+            break;
+        case STAP_A_INDICATOR:
+        case STAP_B_INDICATOR:
+            pCurPtr += indicator == STAP_A_INDICATOR ? STAP_A_HEADER_SIZE : STAP_B_HEADER_SIZE;
+            while (pCurPtr + SIZEOF(UINT16) <= pEnd && (subNaluSize = getUnalignedInt16BigEndian(pCurPtr)) > 0) {
+                pCurPtr += SIZEOF(UINT16);
+                CHK(pCurPtr + subNaluSize <= pEnd, STATUS_BUFFER_TOO_SMALL);
+                appendRtpPayloadSlice(pSlices, capacity, &sliceCount, start4ByteCode, SIZEOF(start4ByteCode));
+                appendRtpPayloadSlice(pSlices, capacity, &sliceCount, pCurPtr, subNaluSize);
+                pCurPtr += subNaluSize;
+            }
+            break;
+        default:
+            // Single NALU https://tools.ietf.org/html/rfc6184#section-5.6
+            appendRtpPayloadSlice(pSlices, capacity, &sliceCount, start4ByteCode, SIZEOF(start4ByteCode));
+            appendRtpPayloadSlice(pSlices, capacity, &sliceCount, pRawPacket, packetLength);
+    }
+
+    CHK(pSlices == NULL || sliceCount <= capacity, STATUS_BUFFER_TOO_SMALL);
+
+CleanUp:
+    if (pSliceCount != NULL) {
+        *pSliceCount = sliceCount;
+    }
+
+    LEAVES();
+    return retStatus;
+}
@@ -38,8 +38,33 @@ extern "C" {
 STATUS createPayloadForH264(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
 STATUS getNextNaluLength(PBYTE, UINT32, PUINT32, PUINT32);
 STATUS createPayloadFromNalu(UINT32, PBYTE, UINT32, PPayloadArray, PUINT32, PUINT32);
+
+/**
+ * Aggregate the NAL unit at the start of the Annex-B buffer with the ones following it into a STAP-A payload, as many as
+ * fit in the MTU. Nothing is written and the consumed length is 0 when not even the next NAL unit fits, the first one is
+ * then packetized on its own by createPayloadFromNalu.
+ *
+ * @param - UINT32 - IN - MTU
+ * @param - PBYTE - IN - first NAL unit, without its start code, followed by the rest of the frame
+ * @param - UINT32 - IN - length of the rest of the frame, first NAL unit included
+ * @param - UINT32 - IN - length of the first NAL unit
+ * @param - PPayloadArray - IN/OUT - payload to fill, NULL for size calculation only
+ * @param - PUINT32 - OUT - payload length
+ * @param - PUINT32 - OUT - number of payloads
+ * @param - PUINT32 - OUT - bytes of the frame aggregated, up to the end of the last NAL unit
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createStapAPayloadFromNalus(UINT32, PBYTE, UINT32, UINT32, PPayloadArray, PUINT32, PUINT32, PUINT32);
 STATUS depayH264FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
 
+/**
+ * Slice version of depayH264FromRtpPayload. The Annex-B start codes are given as separate slices. When filling the slices
+ * of a starting fragmentation unit, the reconstructed NAL unit header is written over the last byte of the FU header so that
+ * the NAL unit is a single slice of the payload. The slices of a packet must therefore be filled only once.
+ */
+STATUS depayH264SlicesFromRtpPayload(PBYTE, UINT32, PRtcFrameSlice, PUINT32);
+
 #ifdef __cplusplus
 }
 #endif
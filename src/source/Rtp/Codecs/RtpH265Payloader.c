@@ -13,6 +13,7 @@ STATUS createPayloadForH265(UINT32 mtu, PBYTE nalus, UINT32 nalusLength, PBYTE p
     UINT32 startIndex = 0;
     UINT32 singlePayloadLength = 0;
     UINT32 singlePayloadSubLenSize = 0;
+    UINT32 consumedLength = 0;
     BOOL sizeCalculationOnly = (payloadBuffer == NULL);
     PayloadArray payloadArray;
 
@@ -42,20 +43,27 @@ STATUS createPayloadForH265(UINT32 mtu, PBYTE nalus, UINT32 nalusLength, PBYTE p
 
         CHK(remainNalusLength != 0, retStatus);
 
+        // Small NAL units that follow each other, like the VPS, SPS and PPS of a keyframe, share an aggregation packet
+        CHK_STATUS(createApPayloadFromNalusH265(mtu, curPtrInNalus, remainNalusLength, nextNaluLength, sizeCalculationOnly ? NULL : &payloadArray,
+                                                &singlePayloadLength, &singlePayloadSubLenSize, &consumedLength));
+        if (consumedLength == 0) {
+            consumedLength = nextNaluLength;
+            CHK_STATUS(createPayloadFromNaluH265(mtu, curPtrInNalus, nextNaluLength, sizeCalculationOnly ? NULL : &payloadArray, &singlePayloadLength,
+                                                 &singlePayloadSubLenSize));
+        }
+
         if (sizeCalculationOnly) {
-            CHK_STATUS(createPayloadFromNaluH265(mtu, curPtrInNalus, nextNaluLength, NULL, &singlePayloadLength, &singlePayloadSubLenSize));
             payloadArray.payloadLength += singlePayloadLength;
             payloadArray.payloadSubLenSize += singlePayloadSubLenSize;
         } else {
-            CHK_STATUS(createPayloadFromNaluH265(mtu, curPtrInNalus, nextNaluLength, &payloadArray, &singlePayloadLength, &singlePayloadSubLenSize));
             payloadArray.payloadBuffer += singlePayloadLength;
             payloadArray.payloadSubLength += singlePayloadSubLenSize;
             payloadArray.maxPayloadLength -= singlePayloadLength;
             payloadArray.maxPayloadSubLenSize -= singlePayloadSubLenSize;
         }
 
-        remainNalusLength -= nextNaluLength;
-        curPtrInNalus += nextNaluLength;
+        remainNalusLength -= consumedLength;
+        curPtrInNalus += consumedLength;
     } while (remainNalusLength != 0);
 
 CleanUp:
@@ -221,15 +229,90 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createApPayloadFromNalusH265(UINT32 mtu, PBYTE nalus, UINT32 nalusLength, UINT32 firstNaluLength, PPayloadArray pPayloadArray,
+                                    PUINT32 filledLength, PUINT32 filledSubLenSize, PUINT32 pConsumedLength)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE pCurPtrInNalus = NULL, pPayload = NULL;
+    UINT32 remainNalusLength = 0, startIndex = 0, naluLength = 0, naluCount = 0, payloadLength = 0, consumedLength = 0, i;
+    BYTE forbiddenBit = 0, layerId = H265_LAYER_ID_MASK, temporalId = H265_TID_MASK;
+    BOOL sizeCalculationOnly = (pPayloadArray == NULL);
+
+    CHK(nalus != NULL && filledLength != NULL && filledSubLenSize != NULL && pConsumedLength != NULL, STATUS_NULL_ARG);
+    CHK(sizeCalculationOnly || (pPayloadArray->payloadSubLength != NULL && pPayloadArray->payloadBuffer != NULL), STATUS_NULL_ARG);
+    CHK(firstNaluLength >= H265_NALU_HEADER_SIZE && firstNaluLength <= nalusLength, retStatus);
+
+    // NAL units are taken while they fit in the MTU along with their size fields, https://www.rfc-editor.org/rfc/rfc7798.html#section-4.4.2
+    payloadLength = H265_AP_HEADER_SIZE + SIZEOF(UINT16) + firstNaluLength;
+    CHK(payloadLength <= mtu, retStatus);
+    naluCount = 1;
+    consumedLength = firstNaluLength;
+    pCurPtrInNalus = nalus + firstNaluLength;
+    remainNalusLength = nalusLength - firstNaluLength;
+    while (remainNalusLength != 0 && STATUS_SUCCEEDED(getNextNaluLengthH265(pCurPtrInNalus, remainNalusLength, &startIndex, &naluLength)) &&
+           naluLength >= H265_NALU_HEADER_SIZE && payloadLength + SIZEOF(UINT16) + naluLength <= mtu) {
+        payloadLength += SIZEOF(UINT16) + naluLength;
+        naluCount++;
+        pCurPtrInNalus += startIndex + naluLength;
+        remainNalusLength -= startIndex + naluLength;
+        consumedLength = (UINT32) (pCurPtrInNalus - nalus);
+    }
+
+    // A NAL unit on its own is sent as is
+    CHK(naluCount > 1, retStatus);
+
+    if (!sizeCalculationOnly) {
+        CHK(pPayloadArray->maxPayloadSubLenSize >= 1 && payloadLength <= pPayloadArray->maxPayloadLength, STATUS_BUFFER_TOO_SMALL);
+
+        pPayload = pPayloadArray->payloadBuffer + H265_AP_HEADER_SIZE;
+        pCurPtrInNalus = nalus;
+        naluLength = firstNaluLength;
+        for (i = 0; i < naluCount; i++) {
+            if (i > 0) {
+                CHK_STATUS(getNextNaluLengthH265(pCurPtrInNalus, (UINT32) (nalus + consumedLength - pCurPtrInNalus), &startIndex, &naluLength));
+                pCurPtrInNalus += startIndex;
+            }
+
+            // The F bit is set if any NAL unit has it, LayerId and TID are the lowest of them
+            forbiddenBit |= pCurPtrInNalus[0] & 0x80;
+            layerId = MIN(layerId, ((pCurPtrInNalus[0] & 0x01) << 5) | (pCurPtrInNalus[1] >> 3));
+            temporalId = MIN(temporalId, pCurPtrInNalus[1] & H265_TID_MASK);
+
+            putUnalignedInt16BigEndian((PINT16) pPayload, (UINT16) naluLength);
+            MEMCPY(pPayload + SIZEOF(UINT16), pCurPtrInNalus, naluLength);
+            pPayload += SIZEOF(UINT16) + naluLength;
+            pCurPtrInNalus += naluLength;
+        }
+
+        pPayloadArray->payloadBuffer[0] = forbiddenBit | (H265_AP_TYPE_ID << 1) | (layerId >> 5);
+        pPayloadArray->payloadBuffer[1] = (BYTE) ((layerId << 3) | temporalId);
+        pPayloadArray->payloadSubLength[0] = payloadLength;
+    }
+
+    *filledLength = payloadLength;
+    *filledSubLenSize = 1;
+    *pConsumedLength = consumedLength;
+
+CleanUp:
+    if (pConsumedLength != NULL && (STATUS_FAILED(retStatus) || naluCount <= 1)) {
+        *pConsumedLength = 0;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS depayH265FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNaluData, PUINT32 pNaluLength, PBOOL pIsStart)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     UINT32 naluLength = packetLength, headerSize = 0;
     UINT8 payloadHeaderType;
+    UINT16 subNaluSize = 0;
     BOOL sizeCalculationOnly = (pNaluData == NULL);
     BOOL isStartingPacket = TRUE;
-    PBYTE pCurPtrInNalu = pNaluData;
+    PBYTE pCurPtrInNalu = pNaluData, pCurPtr = NULL, pEnd = pRawPacket + packetLength;
     static BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
 
     CHK(pRawPacket != NULL && pNaluLength != NULL, STATUS_NULL_ARG);
@@ -237,6 +320,31 @@ STATUS depayH265FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNal
 
     payloadHeaderType = (pRawPacket[0] >> 1) & 0x3F;
 
+    if (payloadHeaderType == H265_AP_TYPE_ID) {
+        // Aggregation packets https://www.rfc-editor.org/rfc/rfc7798.html#section-4.4.2, each NAL unit gets its own start code
+        naluLength = 0;
+        pCurPtr = pRawPacket + H265_AP_HEADER_SIZE;
+        while (pCurPtr + SIZEOF(UINT16) <= pEnd && (subNaluSize = getUnalignedInt16BigEndian(pCurPtr)) > 0) {
+            pCurPtr += SIZEOF(UINT16);
+            CHK(pCurPtr + subNaluSize <= pEnd, STATUS_BUFFER_TOO_SMALL);
+            naluLength += SIZEOF(start4ByteCode) + subNaluSize;
+            pCurPtr += subNaluSize;
+        }
+
+        CHK(!sizeCalculationOnly, retStatus);
+        CHK(naluLength <= *pNaluLength, STATUS_BUFFER_TOO_SMALL);
+
+        pCurPtr = pRawPacket + H265_AP_HEADER_SIZE;
+        while (pCurPtr + SIZEOF(UINT16) <= pEnd && (subNaluSize = getUnalignedInt16BigEndian(pCurPtr)) > 0) {
+            pCurPtr += SIZEOF(UINT16);
+            MEMCPY(pCurPtrInNalu, start4ByteCode, SIZEOF(start4ByteCode));
+            MEMCPY(pCurPtrInNalu + SIZEOF(start4ByteCode), pCurPtr, subNaluSize);
+            pCurPtrInNalu += SIZEOF(start4ByteCode) + subNaluSize;
+            pCurPtr += subNaluSize;
+        }
+        CHK(FALSE, retStatus);
+    }
+
     if (payloadHeaderType == H265_FU_TYPE_ID) {
         isStartingPacket = (pRawPacket[2] & 0x80) != 0;
         headerSize = H265_FU_HEADER_SIZE;
@@ -281,3 +389,56 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS depayH265SlicesFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PRtcFrameSlice pSlices, PUINT32 pSliceCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 capacity, sliceCount = 0;
+    UINT16 subNaluSize = 0;
+    BYTE naluHeader;
+    PBYTE pCurPtr = NULL, pEnd = pRawPacket + packetLength;
+    static BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
+
+    CHK(pRawPacket != NULL && pSliceCount != NULL, STATUS_NULL_ARG);
+    capacity = *pSliceCount;
+    CHK(packetLength > 0, retStatus);
+
+    if (((pRawPacket[0] >> 1) & 0x3F) == H265_AP_TYPE_ID) {
+        pCurPtr = pRawPacket + H265_AP_HEADER_SIZE;
+        while (pCurPtr + SIZEOF(UINT16) <= pEnd && (subNaluSize = getUnalignedInt16BigEndian(pCurPtr)) > 0) {
+            pCurPtr += SIZEOF(UINT16);
+            CHK(pCurPtr + subNaluSize <= pEnd, STATUS_BUFFER_TOO_SMALL);
+            appendRtpPayloadSlice(pSlices, capacity, &sliceCount, start4ByteCode, SIZEOF(start4ByteCode));
+            appendRtpPayloadSlice(pSlices, capacity, &sliceCount, pCurPtr, subNaluSize);
+            pCurPtr += subNaluSize;
+        }
+    } else if (((pRawPacket[0] >> 1) & 0x3F) != H265_FU_TYPE_ID) {
+        appendRtpPayloadSlice(pSlices, capacity, &sliceCount, start4ByteCode, SIZEOF(start4ByteCode));
+        appendRtpPayloadSlice(pSlices, capacity, &sliceCount, pRawPacket, packetLength);
+    } else {
+        CHK(packetLength >= H265_FU_HEADER_SIZE, STATUS_BUFFER_TOO_SMALL);
+        if ((pRawPacket[2] & 0x80) != 0) {
+            appendRtpPayloadSlice(pSlices, capacity, &sliceCount, start4ByteCode, SIZEOF(start4ByteCode));
+            // Only when the slice below gets written
+            if (pSlices != NULL && sliceCount < capacity) {
+                naluHeader = ((pRawPacket[2] & 0x3F) << 1) | (pRawPacket[0] & 0x81);
+                pRawPacket[2] = pRawPacket[1];
+                pRawPacket[1] = naluHeader;
+            }
+            appendRtpPayloadSlice(pSlices, capacity, &sliceCount, pRawPacket + 1, packetLength - 1);
+        } else {
+            appendRtpPayloadSlice(pSlices, capacity, &sliceCount, pRawPacket + H265_FU_HEADER_SIZE, packetLength - H265_FU_HEADER_SIZE);
+        }
+    }
+
+    CHK(pSlices == NULL || sliceCount <= capacity, STATUS_BUFFER_TOO_SMALL);
+
+CleanUp:
+    if (pSliceCount != NULL) {
+        *pSliceCount = sliceCount;
+    }
+
+    LEAVES();
+    return retStatus;
+}
@@ -10,8 +10,13 @@ H265 RTP Payloader include file
 extern "C" {
 #endif
 
-#define H265_FU_HEADER_SIZE 3
-#define H265_FU_TYPE_ID     49
+#define H265_FU_HEADER_SIZE   3
+#define H265_FU_TYPE_ID       49
+#define H265_AP_HEADER_SIZE   2
+#define H265_AP_TYPE_ID       48
+#define H265_NALU_HEADER_SIZE 2
+#define H265_LAYER_ID_MASK    0x3F
+#define H265_TID_MASK         0x07
 
 // https://www.rfc-editor.org/rfc/rfc7798.html#section-4.4.3
 
@@ -33,8 +38,33 @@ extern "C" {
 STATUS createPayloadForH265(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
 STATUS getNextNaluLengthH265(PBYTE, UINT32, PUINT32, PUINT32);
 STATUS createPayloadFromNaluH265(UINT32, PBYTE, UINT32, PPayloadArray, PUINT32, PUINT32);
+
+/**
+ * Aggregate the NAL unit at the start of the Annex-B buffer with the ones following it into an aggregation packet, as many
+ * as fit in the MTU. Nothing is written and the consumed length is 0 when not even the next NAL unit fits, the first one
+ * is then packetized on its own by createPayloadFromNaluH265. No DONL fields are written, sprop-max-don-diff is never set.
+ *
+ * @param - UINT32 - IN - MTU
+ * @param - PBYTE - IN - first NAL unit, without its start code, followed by the rest of the frame
+ * @param - UINT32 - IN - length of the rest of the frame, first NAL unit included
+ * @param - UINT32 - IN - length of the first NAL unit
+ * @param - PPayloadArray - IN/OUT - payload to fill, NULL for size calculation only
+ * @param - PUINT32 - OUT - payload length
+ * @param - PUINT32 - OUT - number of payloads
+ * @param - PUINT32 - OUT - bytes of the frame aggregated, up to the end of the last NAL unit
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createApPayloadFromNalusH265(UINT32, PBYTE, UINT32, UINT32, PPayloadArray, PUINT32, PUINT32, PUINT32);
 STATUS depayH265FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
 
+/**
+ * Slice version of depayH265FromRtpPayload. The Annex-B start codes are given as separate slices. When filling the slices
+ * of a starting fragmentation unit, the reconstructed NAL unit header is written over the end of the FU headers, so the
+ * slices of a packet must be filled only once.
+ */
+STATUS depayH265SlicesFromRtpPayload(PBYTE, UINT32, PRtcFrameSlice, PUINT32);
+
 #ifdef __cplusplus
 }
 #endif
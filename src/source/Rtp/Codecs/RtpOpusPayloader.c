@@ -73,3 +73,26 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS depayOpusSlicesFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PRtcFrameSlice pSlices, PUINT32 pSliceCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 capacity, sliceCount = 0;
+
+    CHK(pRawPacket != NULL && pSliceCount != NULL, STATUS_NULL_ARG);
+    capacity = *pSliceCount;
+    CHK(packetLength > 0, retStatus);
+
+    // The whole payload is the frame data
+    appendRtpPayloadSlice(pSlices, capacity, &sliceCount, pRawPacket, packetLength);
+    CHK(pSlices == NULL || sliceCount <= capacity, STATUS_BUFFER_TOO_SMALL);
+
+CleanUp:
+    if (pSliceCount != NULL) {
+        *pSliceCount = sliceCount;
+    }
+
+    LEAVES();
+    return retStatus;
+}
@@ -12,6 +12,7 @@ extern "C" {
 
 STATUS createPayloadForOpus(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
 STATUS depayOpusFromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
+STATUS depayOpusSlicesFromRtpPayload(PBYTE, UINT32, PRtcFrameSlice, PUINT32);
 
 #ifdef __cplusplus
 }
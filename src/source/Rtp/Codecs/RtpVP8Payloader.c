@@ -115,3 +115,27 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS depayVP8SlicesFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PRtcFrameSlice pSlices, PUINT32 pSliceCount)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 capacity, sliceCount = 0, vp8Length = 0;
+
+    CHK(pRawPacket != NULL && pSliceCount != NULL, STATUS_NULL_ARG);
+    capacity = *pSliceCount;
+    CHK(packetLength > 0, retStatus);
+
+    // The frame data is what follows the payload descriptor
+    CHK_STATUS(depayVP8FromRtpPayload(pRawPacket, packetLength, NULL, &vp8Length, NULL));
+    appendRtpPayloadSlice(pSlices, capacity, &sliceCount, pRawPacket + packetLength - vp8Length, vp8Length);
+    CHK(pSlices == NULL || sliceCount <= capacity, STATUS_BUFFER_TOO_SMALL);
+
+CleanUp:
+    if (pSliceCount != NULL) {
+        *pSliceCount = sliceCount;
+    }
+
+    LEAVES();
+    return retStatus;
+}
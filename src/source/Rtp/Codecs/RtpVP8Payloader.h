@@ -15,6 +15,7 @@ extern "C" {
 
 STATUS createPayloadForVP8(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
 STATUS depayVP8FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
+STATUS depayVP8SlicesFromRtpPayload(PBYTE, UINT32, PRtcFrameSlice, PUINT32);
 
 #ifdef __cplusplus
 }
@@ -113,45 +113,43 @@ CleanUp:
     return retStatus;
 }
 
-STATUS constructRetransmitRtpPacketFromBytes(PBYTE rawPacket, UINT32 packetLength, UINT16 sequenceNum, UINT8 payloadType, UINT32 ssrc,
-                                             PRtpPacket* ppRtpPacket)
+STATUS constructRetransmitRtpPacketBuffer(PRtpPacket pRtpPacket, UINT16 sequenceNum, UINT8 payloadType, UINT32 ssrc, UINT32 tailroom,
+                                          PRtpPacketBuffer* ppRtpPacketBuffer)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PBYTE pPayload = NULL;
-    PRtpPacket pRtpPacket = (PRtpPacket) MEMALLOC(SIZEOF(RtpPacket));
-
-    CHK(pRtpPacket != NULL, STATUS_NOT_ENOUGH_MEMORY);
-    CHK_STATUS(setRtpPacketFromBytes(rawPacket, packetLength, pRtpPacket));
-    pPayload = (PBYTE) MEMALLOC(pRtpPacket->payloadLength + SIZEOF(UINT16));
-    CHK(pPayload != NULL, STATUS_NOT_ENOUGH_MEMORY);
-    // Retransmission payload header is OSN original sequence number
-    putUnalignedInt16BigEndian((PINT16) pPayload, pRtpPacket->header.sequenceNumber);
-    MEMCPY(pPayload + SIZEOF(UINT16), pRtpPacket->payload, pRtpPacket->payloadLength);
-    pRtpPacket->payloadLength += SIZEOF(UINT16);
-    pRtpPacket->payload = pPayload;
-
-    pRtpPacket->header.sequenceNumber = sequenceNum;
-    pRtpPacket->header.ssrc = ssrc;
-    pRtpPacket->header.payloadType = payloadType;
-    pRtpPacket->header.padding = FALSE;
-    pRtpPacket->pRawPacket = NULL;
-
-    CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, NULL, &pRtpPacket->rawPacketLength));
-    CHK(NULL != (pRtpPacket->pRawPacket = (PBYTE) MEMALLOC(pRtpPacket->rawPacketLength)), STATUS_NOT_ENOUGH_MEMORY);
-    CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, pRtpPacket->pRawPacket, &pRtpPacket->rawPacketLength));
-    pRtpPacket->payload = pRtpPacket->pRawPacket + RTP_GET_RAW_PACKET_SIZE(pRtpPacket) - pRtpPacket->payloadLength;
+    PRtpPacketBuffer pRtpPacketBuffer = NULL;
+    RtpPacket rtxPacket;
+    UINT32 packetLength = 0, headerLength;
+
+    CHK(pRtpPacket != NULL && ppRtpPacketBuffer != NULL, STATUS_NULL_ARG);
+
+    // Same header on the retransmission stream, the payload is prefixed by the OSN original sequence number
+    rtxPacket = *pRtpPacket;
+    rtxPacket.header.sequenceNumber = sequenceNum;
+    rtxPacket.header.ssrc = ssrc;
+    rtxPacket.header.payloadType = payloadType;
+    rtxPacket.header.padding = FALSE;
+    rtxPacket.payload = NULL;
+    rtxPacket.payloadLength = pRtpPacket->payloadLength + SIZEOF(UINT16);
+
+    CHK_STATUS(createBytesFromRtpPacket(&rtxPacket, NULL, &packetLength));
+    CHK_STATUS(createRtpPacketBuffer(0, packetLength, tailroom, &pRtpPacketBuffer));
+
+    // Only writes the header as the payload is NULL, the payload is copied straight from the original packet
+    CHK_STATUS(setBytesFromRtpPacket(&rtxPacket, pRtpPacketBuffer->packet.pRawPacket, packetLength));
+    headerLength = RTP_HEADER_LEN(&rtxPacket);
+    putUnalignedInt16BigEndian((PINT16) (pRtpPacketBuffer->packet.pRawPacket + headerLength), pRtpPacket->header.sequenceNumber);
+    MEMCPY(pRtpPacketBuffer->packet.pRawPacket + headerLength + SIZEOF(UINT16), pRtpPacket->payload, pRtpPacket->payloadLength);
+    CHK_STATUS(rtpPacketBufferSetLength(pRtpPacketBuffer, packetLength));
 
 CleanUp:
-    SAFE_MEMFREE(pPayload);
-    if (STATUS_FAILED(retStatus) && pRtpPacket != NULL) {
-        SAFE_MEMFREE(pRtpPacket->pRawPacket);
-        freeRtpPacket(&pRtpPacket);
-        pRtpPacket = NULL;
+    if (STATUS_FAILED(retStatus)) {
+        rtpPacketBufferRelease(&pRtpPacketBuffer);
     }
 
-    if (ppRtpPacket != NULL) {
-        *ppRtpPacket = pRtpPacket;
+    if (ppRtpPacketBuffer != NULL) {
+        *ppRtpPacketBuffer = pRtpPacketBuffer;
     }
     LEAVES();
     return retStatus;
@@ -203,6 +201,7 @@ STATUS setRtpPacketFromBytes(PBYTE rawPacket, UINT32 packetLength, PRtpPacket pR
         currOffset += SIZEOF(UINT16);
         extensionPayload = (PBYTE) (rawPacket + currOffset);
         currOffset += extensionLength;
+        CHK(packetLength >= currOffset, STATUS_RTP_INVALID_EXTENSION_LEN);
     }
 
     CHK_STATUS(setRtpPacket(version, padding, extension, csrcCount, marker, payloadType, sequenceNumber, timestamp, ssrc, csrcArray, extensionProfile,
@@ -213,6 +212,49 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Find a one-byte header extension element, https://tools.ietf.org/html/rfc8285#section-4.2
+ *
+ * ppData is set to NULL when the packet does not carry the element.
+ */
+STATUS getRtpOneByteHeaderExtension(PRtpPacket pRtpPacket, UINT8 id, PBYTE* ppData, PUINT8 pLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE pExtension;
+    UINT32 offset = 0;
+    UINT8 elementId, elementLength;
+
+    CHK(pRtpPacket != NULL && ppData != NULL && pLength != NULL, STATUS_NULL_ARG);
+    *ppData = NULL;
+    *pLength = 0;
+    CHK(pRtpPacket->header.extension && pRtpPacket->header.extensionProfile == ONE_BYTE_HEADER_EXTENSION_PROFILE, retStatus);
+
+    pExtension = pRtpPacket->header.extensionPayload;
+    while (offset < pRtpPacket->header.extensionLength) {
+        elementId = pExtension[offset] >> 4;
+        if (elementId == ONE_BYTE_HEADER_EXTENSION_PADDING_ID) {
+            offset++;
+            continue;
+        }
+        // Nothing after the reserved id is read
+        CHK(elementId != ONE_BYTE_HEADER_EXTENSION_RESERVED_ID, retStatus);
+
+        elementLength = (pExtension[offset] & 0x0f) + 1;
+        offset++;
+        CHK(offset + elementLength <= pRtpPacket->header.extensionLength, STATUS_RTP_INVALID_EXTENSION_LEN);
+        if (elementId == id) {
+            *ppData = pExtension + offset;
+            *pLength = elementLength;
+            break;
+        }
+        offset += elementLength;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
 STATUS createBytesFromRtpPacket(PRtpPacket pRtpPacket, PBYTE pRawPacket, PUINT32 pPacketLength)
 {
     ENTERS();
@@ -350,3 +392,83 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS createRtpPacketBuffer(UINT32 headroom, UINT32 packetLength, UINT32 tailroom, PRtpPacketBuffer* ppRtpPacketBuffer)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacketBuffer pRtpPacketBuffer = NULL;
+
+    CHK(ppRtpPacketBuffer != NULL, STATUS_NULL_ARG);
+
+    pRtpPacketBuffer = (PRtpPacketBuffer) MEMALLOC(SIZEOF(RtpPacketBuffer) + headroom + packetLength + tailroom);
+    CHK(pRtpPacketBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    MEMSET(&pRtpPacketBuffer->packet, 0x00, SIZEOF(RtpPacket));
+    ATOMIC_STORE(&pRtpPacketBuffer->refCount, 1);
+    pRtpPacketBuffer->headroom = headroom;
+    pRtpPacketBuffer->tailroom = tailroom;
+    pRtpPacketBuffer->packet.pRawPacket = (PBYTE) (pRtpPacketBuffer + 1) + headroom;
+    pRtpPacketBuffer->packet.rawPacketLength = packetLength;
+
+CleanUp:
+    if (ppRtpPacketBuffer != NULL) {
+        *ppRtpPacketBuffer = pRtpPacketBuffer;
+    }
+    LEAVES();
+    return retStatus;
+}
+
+STATUS rtpPacketBufferAddRef(PRtpPacketBuffer pRtpPacketBuffer)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pRtpPacketBuffer != NULL, STATUS_NULL_ARG);
+    ATOMIC_INCREMENT(&pRtpPacketBuffer->refCount);
+
+CleanUp:
+    return retStatus;
+}
+
+STATUS rtpPacketBufferRelease(PRtpPacketBuffer* ppRtpPacketBuffer)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(ppRtpPacketBuffer != NULL, STATUS_NULL_ARG);
+    CHK(*ppRtpPacketBuffer != NULL, retStatus);
+
+    // ATOMIC_DECREMENT returns the value before the decrement
+    if (ATOMIC_DECREMENT(&(*ppRtpPacketBuffer)->refCount) == 1) {
+        MEMFREE(*ppRtpPacketBuffer);
+    }
+    *ppRtpPacketBuffer = NULL;
+
+CleanUp:
+    return retStatus;
+}
+
+STATUS rtpPacketBufferSetLength(PRtpPacketBuffer pRtpPacketBuffer, UINT32 packetLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 capacity;
+
+    CHK(pRtpPacketBuffer != NULL, STATUS_NULL_ARG);
+
+    capacity = pRtpPacketBuffer->packet.rawPacketLength + pRtpPacketBuffer->tailroom;
+    CHK(packetLength <= capacity, STATUS_BUFFER_TOO_SMALL);
+    pRtpPacketBuffer->tailroom = capacity - packetLength;
+    pRtpPacketBuffer->packet.rawPacketLength = packetLength;
+    CHK_STATUS(setRtpPacketFromBytes(pRtpPacketBuffer->packet.pRawPacket, packetLength, &pRtpPacketBuffer->packet));
+
+CleanUp:
+    return retStatus;
+}
+
+VOID appendRtpPayloadSlice(PRtcFrameSlice pSlices, UINT32 capacity, PUINT32 pSliceCount, PBYTE pData, UINT32 size)
+{
+    if (pSlices != NULL && *pSliceCount < capacity) {
+        pSlices[*pSliceCount].pData = pData;
+        pSlices[*pSliceCount].size = size;
+    }
+    (*pSliceCount)++;
+}
@@ -44,12 +44,21 @@ extern "C" {
      |  ID   | L=1   |transport-wide sequence number | zero padding  |
      +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  */
+// https://tools.ietf.org/html/rfc8285#section-4.2
+#define ONE_BYTE_HEADER_EXTENSION_PROFILE     0xBEDE
+#define ONE_BYTE_HEADER_EXTENSION_PADDING_ID  0
+#define ONE_BYTE_HEADER_EXTENSION_RESERVED_ID 15
+
 // https://tools.ietf.org/html/draft-holmer-rmcat-transport-wide-cc-extensions-01
-#define TWCC_EXT_PROFILE                 0xBEDE
+#define TWCC_EXT_PROFILE                 ONE_BYTE_HEADER_EXTENSION_PROFILE
 #define TWCC_PAYLOAD(extId, sequenceNum) htonl((((extId) & 0xfu) << 28u) | (1u << 24u) | ((UINT32) (sequenceNum) << 8u))
 #define TWCC_SEQNUM(extPayload)          ((UINT16) getUnalignedInt16BigEndian(extPayload + 1))
+// Extension profile and length followed by the one byte header extension
+#define TWCC_EXT_LENGTH (4 + SIZEOF(UINT32))
 
 typedef STATUS (*DepayRtpPayloadFunc)(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
+// Like DepayRtpPayloadFunc but points the slices into the payload instead of copying it. Only counts the slices when they are NULL
+typedef STATUS (*DepayRtpPayloadSlicesFunc)(PBYTE, UINT32, PRtcFrameSlice, PUINT32);
 
 /*
  *  0                   1                   2                   3
@@ -109,15 +118,68 @@ struct __RtpPacket {
 };
 typedef RtpPacket* PRtpPacket;
 
+/*
+ * Outgoing packet allocated once and shared by reference between the send path, the RtpRollingBuffer and the
+ * retransmitter. The bytes live right after the struct:
+ *
+ *   | headroom | pRawPacket (rawPacketLength bytes) | tailroom |
+ *
+ * tailroom leaves space for the SRTP authentication tag so that packets are encrypted in place.
+ */
+typedef struct __RtpPacketBuffer RtpPacketBuffer;
+struct __RtpPacketBuffer {
+    // Parsed view of the bytes. First member so that a PRtpPacketBuffer can be read as a PRtpPacket
+    RtpPacket packet;
+    volatile SIZE_T refCount;
+    UINT32 headroom;
+    UINT32 tailroom;
+};
+typedef RtpPacketBuffer* PRtpPacketBuffer;
+
 STATUS createRtpPacket(UINT8, BOOL, BOOL, UINT8, BOOL, UINT8, UINT16, UINT32, UINT32, PUINT32, UINT16, UINT32, PBYTE, PBYTE, UINT32, PRtpPacket*);
 STATUS setRtpPacket(UINT8, BOOL, BOOL, UINT8, BOOL, UINT8, UINT16, UINT32, UINT32, PUINT32, UINT16, UINT32, PBYTE, PBYTE, UINT32, PRtpPacket);
 STATUS freeRtpPacket(PRtpPacket*);
 STATUS createRtpPacketFromBytes(PBYTE, UINT32, PRtpPacket*);
-STATUS constructRetransmitRtpPacketFromBytes(PBYTE, UINT32, UINT16, UINT8, UINT32, PRtpPacket*);
+STATUS constructRetransmitRtpPacketBuffer(PRtpPacket, UINT16, UINT8, UINT32, UINT32, PRtpPacketBuffer*);
 STATUS setRtpPacketFromBytes(PBYTE, UINT32, PRtpPacket);
 STATUS createBytesFromRtpPacket(PRtpPacket, PBYTE, PUINT32);
 STATUS setBytesFromRtpPacket(PRtpPacket, PBYTE, UINT32);
 STATUS constructRtpPackets(PPayloadArray, UINT8, UINT16, UINT32, UINT32, PRtpPacket, UINT32);
+STATUS getRtpOneByteHeaderExtension(PRtpPacket, UINT8, PBYTE*, PUINT8);
+
+/**
+ * Allocate a packet buffer holding one reference
+ *
+ * @param - UINT32 - IN - free bytes to keep in front of the packet
+ * @param - UINT32 - IN - length of the packet
+ * @param - UINT32 - IN - free bytes to keep after the packet
+ * @param - PRtpPacketBuffer* - OUT - the new buffer
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createRtpPacketBuffer(UINT32, UINT32, UINT32, PRtpPacketBuffer*);
+
+/**
+ * Take an additional reference on a packet buffer
+ */
+STATUS rtpPacketBufferAddRef(PRtpPacketBuffer);
+
+/**
+ * Drop a reference, freeing the buffer with the last one. Sets the pointer to NULL
+ */
+STATUS rtpPacketBufferRelease(PRtpPacketBuffer*);
+
+/**
+ * Set the number of bytes used at pRawPacket, taking room from or giving it back to the tailroom, and parse them into
+ * the packet view. Used once the packet is written and again after it is encrypted in place.
+ */
+STATUS rtpPacketBufferSetLength(PRtpPacketBuffer, UINT32);
+
+/**
+ * Add a slice for a DepayRtpPayloadSlicesFunc. The slice is only written when the array is given and has room, the count
+ * always goes up so that the same code both counts and fills the slices.
+ */
+VOID appendRtpPayloadSlice(PRtcFrameSlice, UINT32, PUINT32, PBYTE, UINT32);
 
 #ifdef __cplusplus
 }
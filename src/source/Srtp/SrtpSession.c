@@ -29,6 +29,17 @@ STATUS initSrtpSession(PBYTE receiveKey, PBYTE transmitKey, KVS_SRTP_PROFILE pro
             srtp_policy_setter = srtp_crypto_policy_set_rtp_default;
             srtcp_policy_setter = srtp_crypto_policy_set_rtp_default;
             break;
+#ifdef HAVE_SRTP_AES_GCM
+        // https://tools.ietf.org/html/rfc7714#section-14.2, 16 byte authentication tags for both RTP and RTCP
+        case KVS_SRTP_PROFILE_AEAD_AES_128_GCM:
+            srtp_policy_setter = srtp_crypto_policy_set_aes_gcm_128_16_auth;
+            srtcp_policy_setter = srtp_crypto_policy_set_aes_gcm_128_16_auth;
+            break;
+        case KVS_SRTP_PROFILE_AEAD_AES_256_GCM:
+            srtp_policy_setter = srtp_crypto_policy_set_aes_gcm_256_16_auth;
+            srtcp_policy_setter = srtp_crypto_policy_set_aes_gcm_256_16_auth;
+            break;
+#endif
         default:
             CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
     }
@@ -72,7 +72,35 @@ STATUS serializeStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passw
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 i, encodedLen = 0, packetSize = 0, remaining = 0, crc32, hmacLen;
+    StunHmacKey hmacKey;
+    BOOL keyInitialized = FALSE;
+
+    CHK(pStunPacket != NULL && (!generateMessageIntegrity || password != NULL) && pSize != NULL, STATUS_NULL_ARG);
+    CHK(password == NULL || passwordLen != 0, STATUS_INVALID_ARG);
+
+    // The key is only used when packaging, getting the size only needs to know that there will be a message integrity
+    if (generateMessageIntegrity && pBuffer != NULL) {
+        CHK_STATUS(initStunHmacKey(&hmacKey, password, passwordLen));
+        keyInitialized = TRUE;
+    }
+
+    CHK_STATUS(serializeStunPacketWithHmacKey(pStunPacket, generateMessageIntegrity ? &hmacKey : NULL, generateFingerprint, pBuffer, pSize));
+
+CleanUp:
+
+    if (keyInitialized) {
+        freeStunHmacKey(&hmacKey);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS serializeStunPacketWithHmacKey(PStunPacket pStunPacket, PStunHmacKey pHmacKey, BOOL generateFingerprint, PBYTE pBuffer, PUINT32 pSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, encodedLen = 0, packetSize = 0, remaining = 0, crc32;
     UINT16 size;
     PBYTE pCurrentBufferPosition = pBuffer;
     PStunAttributeHeader pStunAttributeHeader;
@@ -92,17 +120,13 @@ STATUS serializeStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passw
     BOOL fingerprintFound = FALSE, messaageIntegrityFound = FALSE;
     INT64 data64;
 
-    CHK(pStunPacket != NULL && (!generateMessageIntegrity || password != NULL) && pSize != NULL, STATUS_NULL_ARG);
-    CHK(password == NULL || passwordLen != 0, STATUS_INVALID_ARG);
+    CHK(pStunPacket != NULL && pSize != NULL, STATUS_NULL_ARG);
     CHK(pStunPacket->header.magicCookie == STUN_HEADER_MAGIC_COOKIE, STATUS_STUN_MAGIC_COOKIE_MISMATCH);
 
     packetSize += STUN_HEADER_LEN;
     if (pBuffer != NULL) {
-        // If the buffer is specified then we use the length
-        packetSize = *pSize;
-
-        // Set the remaining size first
-        remaining = packetSize;
+        // If the buffer is specified then the length is its capacity
+        remaining = *pSize;
 
         CHK(remaining >= STUN_HEADER_LEN, STATUS_NOT_ENOUGH_MEMORY);
 
@@ -454,7 +478,7 @@ STATUS serializeStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passw
     }
 
     // Check if we need to generate the message integrity attribute
-    if (generateMessageIntegrity) {
+    if (pHmacKey != NULL) {
         encodedLen = STUN_ATTRIBUTE_HEADER_LEN + STUN_HMAC_VALUE_LEN;
 
         if (pBuffer != NULL) {
@@ -472,7 +496,7 @@ STATUS serializeStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passw
 
             // Calculate the HMAC for the integrity of the packet including STUN header and excluding the integrity attribute
             size = (UINT16) (pCurrentBufferPosition - pBuffer);
-            KVS_SHA1_HMAC(password, (INT32) passwordLen, pBuffer, size, pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN, &hmacLen);
+            CHK_STATUS(computeStunMessageIntegrity(pHmacKey, pBuffer, size, pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN));
 
             // Advance the current position
             pCurrentBufferPosition += encodedLen;
@@ -501,7 +525,7 @@ STATUS serializeStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passw
             // Calculate the fingerprint including STUN header and excluding the fingerprint attribute
             size = (UINT16) (pCurrentBufferPosition - pBuffer);
 
-            crc32 = COMPUTE_CRC32(pBuffer, (UINT32) size) ^ STUN_FINGERPRINT_ATTRIBUTE_XOR_VALUE;
+            crc32 = computeStunFingerprint(pBuffer, (UINT32) size);
 
             // Write out the CRC value
             putInt32((PINT32) (pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN), crc32);
@@ -518,14 +542,11 @@ STATUS serializeStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passw
 
     // Package the length if buffer is not NULL
     if (pBuffer != NULL) {
+        packetSize = (UINT32) (pCurrentBufferPosition - pBuffer);
         encodedLen = (UINT16) (packetSize - STUN_HEADER_LEN);
         putInt16((PINT16) (pBuffer + STUN_HEADER_TYPE_LEN), (UINT16) encodedLen);
     }
 
-    // Validate the overall size if buffer is specified
-    CHK_ERR(pBuffer == NULL || packetSize == (UINT32) (pCurrentBufferPosition - pBuffer), STATUS_INTERNAL_ERROR,
-            "Internal error: Invalid offset calculation.");
-
 CleanUp:
 
     if (STATUS_SUCCEEDED(retStatus) && pSize != NULL) {
@@ -1047,7 +1068,7 @@ STATUS deserializeStunPacket(PBYTE pStunBuffer, UINT32 bufferSize, PBYTE passwor
                 // Calculate the fingerprint
                 size = (UINT16) ((PBYTE) pStunAttributeHeader - pStunBuffer);
 
-                crc32 = COMPUTE_CRC32(pStunBuffer, (UINT32) size) ^ STUN_FINGERPRINT_ATTRIBUTE_XOR_VALUE;
+                crc32 = computeStunFingerprint(pStunBuffer, (UINT32) size);
 
                 // Reset the original size in the buffer
                 putInt16((PINT16) (pStunBuffer + STUN_HEADER_TYPE_LEN), pStunPacket->header.messageLength);
@@ -1085,6 +1106,366 @@ CleanUp:
     return retStatus;
 }
 
+STATUS serializeStunBindingResponse(PBYTE transactionId, PKvsIpAddress pMappedAddress, STUN_ATTRIBUTE_TYPE iceControlType, UINT64 tieBreaker,
+                                    PStunHmacKey pHmacKey, PBYTE pBuffer, PUINT32 pSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    StunHeader stunHeader;
+    PBYTE pCurrentBufferPosition = pBuffer;
+    UINT32 encodedLen, remaining, crc32;
+    INT64 data64;
+
+    CHK(transactionId != NULL && pMappedAddress != NULL && pHmacKey != NULL && pBuffer != NULL && pSize != NULL, STATUS_NULL_ARG);
+    CHK(iceControlType == STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING || iceControlType == STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED, STATUS_INVALID_ARG);
+    CHK(*pSize >= STUN_HEADER_LEN, STATUS_NOT_ENOUGH_MEMORY);
+
+    // Package the header, the length is set once the attributes are in
+    putInt16((PINT16) pCurrentBufferPosition, STUN_PACKET_TYPE_BINDING_RESPONSE_SUCCESS);
+    putInt32((PINT32) (pCurrentBufferPosition + STUN_HEADER_TYPE_LEN + STUN_HEADER_DATA_LEN), STUN_HEADER_MAGIC_COOKIE);
+    MEMCPY(pCurrentBufferPosition + STUN_PACKET_TRANSACTION_ID_OFFSET, transactionId, STUN_TRANSACTION_ID_LEN);
+    pCurrentBufferPosition += STUN_HEADER_LEN;
+    remaining = *pSize - STUN_HEADER_LEN;
+
+    // Only the transaction id of the header is used for the XOR
+    MEMCPY(stunHeader.transactionId, transactionId, STUN_TRANSACTION_ID_LEN);
+    encodedLen = remaining;
+    CHK_STATUS(stunPackageIpAddr(&stunHeader, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, pMappedAddress, pCurrentBufferPosition, &encodedLen));
+    pCurrentBufferPosition += encodedLen;
+    remaining -= encodedLen;
+
+    encodedLen = STUN_ATTRIBUTE_HEADER_LEN + STUN_ATTRIBUTE_ICE_CONTROL_LEN + STUN_ATTRIBUTE_HEADER_LEN + STUN_HMAC_VALUE_LEN +
+        STUN_ATTRIBUTE_HEADER_LEN + STUN_ATTRIBUTE_FINGERPRINT_LEN;
+    CHK(remaining >= encodedLen, STATUS_NOT_ENOUGH_MEMORY);
+
+    PACKAGE_STUN_ATTR_HEADER(pCurrentBufferPosition, iceControlType, STUN_ATTRIBUTE_ICE_CONTROL_LEN);
+    data64 = (INT64) tieBreaker;
+    putInt64(&data64, data64);
+    MEMCPY(pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN, &data64, SIZEOF(INT64));
+    pCurrentBufferPosition += STUN_ATTRIBUTE_HEADER_LEN + STUN_ATTRIBUTE_ICE_CONTROL_LEN;
+
+    // The message integrity covers the header with the length up to and including the message integrity attribute
+    PACKAGE_STUN_ATTR_HEADER(pCurrentBufferPosition, STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY, STUN_HMAC_VALUE_LEN);
+    putInt16((PINT16) (pBuffer + STUN_HEADER_TYPE_LEN),
+             (UINT16) (pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN + STUN_HMAC_VALUE_LEN - pBuffer - STUN_HEADER_LEN));
+    CHK_STATUS(computeStunMessageIntegrity(pHmacKey, pBuffer, (UINT32) (pCurrentBufferPosition - pBuffer),
+                                           pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN));
+    pCurrentBufferPosition += STUN_ATTRIBUTE_HEADER_LEN + STUN_HMAC_VALUE_LEN;
+
+    PACKAGE_STUN_ATTR_HEADER(pCurrentBufferPosition, STUN_ATTRIBUTE_TYPE_FINGERPRINT, STUN_ATTRIBUTE_FINGERPRINT_LEN);
+    putInt16((PINT16) (pBuffer + STUN_HEADER_TYPE_LEN),
+             (UINT16) (pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN + STUN_ATTRIBUTE_FINGERPRINT_LEN - pBuffer - STUN_HEADER_LEN));
+    crc32 = computeStunFingerprint(pBuffer, (UINT32) (pCurrentBufferPosition - pBuffer));
+    putInt32((PINT32) (pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN), crc32);
+    pCurrentBufferPosition += STUN_ATTRIBUTE_HEADER_LEN + STUN_ATTRIBUTE_FINGERPRINT_LEN;
+
+    *pSize = (UINT32) (pCurrentBufferPosition - pBuffer);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS parseStunPacketView(PBYTE pStunBuffer, UINT32 bufferSize, PStunHmacKey pHmacKey, PStunPacketView pStunPacketView)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 magicCookie, crc32;
+    UINT16 messageLength, type, length, paddedLength, ipFamily;
+    PBYTE pCurrent, pEnd, pValue;
+    PStunAttributeView pStunAttributeView;
+    BYTE messageIntegrity[STUN_HMAC_VALUE_LEN];
+    BOOL fingerprintFound = FALSE, messageIntegrityFound = FALSE, lengthModified = FALSE, known;
+
+    CHK(pStunBuffer != NULL && pStunPacketView != NULL, STATUS_NULL_ARG);
+    CHK(bufferSize >= STUN_HEADER_LEN, STATUS_INVALID_ARG);
+
+    messageLength = (UINT16) getInt16(*(PUINT16) (pStunBuffer + STUN_HEADER_TYPE_LEN));
+    magicCookie = (UINT32) getInt32(*(PUINT32) (pStunBuffer + STUN_HEADER_TYPE_LEN + STUN_HEADER_DATA_LEN));
+
+    // Validate the specified size and the magic cookie
+    CHK(bufferSize >= messageLength + STUN_HEADER_LEN, STATUS_INVALID_ARG);
+    CHK(magicCookie == STUN_HEADER_MAGIC_COOKIE, STATUS_STUN_MAGIC_COOKIE_MISMATCH);
+
+    pStunPacketView->pBuffer = pStunBuffer;
+    pStunPacketView->stunMessageType = (UINT16) getInt16(*(PUINT16) pStunBuffer);
+    pStunPacketView->messageLength = messageLength;
+    pStunPacketView->transactionId = pStunBuffer + STUN_PACKET_TRANSACTION_ID_OFFSET;
+    pStunPacketView->attributesCount = 0;
+
+    pCurrent = pStunBuffer + STUN_HEADER_LEN;
+    pEnd = pCurrent + messageLength;
+    while (pCurrent < pEnd) {
+        CHK(pCurrent + STUN_ATTRIBUTE_HEADER_LEN <= pEnd, STATUS_INVALID_ARG);
+        type = (UINT16) getInt16(*(PUINT16) pCurrent);
+        length = (UINT16) getInt16(*(PUINT16) (pCurrent + STUN_ATTRIBUTE_HEADER_TYPE_LEN));
+        paddedLength = (UINT16) ROUND_UP(length, 4);
+        pValue = pCurrent + STUN_ATTRIBUTE_HEADER_LEN;
+        CHK(pValue + length <= pEnd, STATUS_INVALID_ARG);
+        known = TRUE;
+
+        // Same validation as deserializeStunPacket
+        switch (type) {
+            case STUN_ATTRIBUTE_TYPE_MAPPED_ADDRESS:
+            case STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS:
+            case STUN_ATTRIBUTE_TYPE_RESPONSE_ADDRESS:
+            case STUN_ATTRIBUTE_TYPE_SOURCE_ADDRESS:
+            case STUN_ATTRIBUTE_TYPE_REFLECTED_FROM:
+            case STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS:
+            case STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS:
+            case STUN_ATTRIBUTE_TYPE_CHANGED_ADDRESS:
+                CHK(length >= STUN_ATTRIBUTE_ADDRESS_HEADER_LEN, STATUS_STUN_INVALID_ADDRESS_ATTRIBUTE_LENGTH);
+                ipFamily = (UINT16) getInt16(*(PUINT16) pValue) & (UINT16) 0x00ff;
+                CHK(length == STUN_ATTRIBUTE_ADDRESS_HEADER_LEN + ((ipFamily == KVS_IP_FAMILY_TYPE_IPV4) ? IPV4_ADDRESS_LENGTH : IPV6_ADDRESS_LENGTH),
+                    STATUS_STUN_INVALID_ADDRESS_ATTRIBUTE_LENGTH);
+                break;
+            case STUN_ATTRIBUTE_TYPE_USERNAME:
+                CHK(length <= STUN_MAX_USERNAME_LEN, STATUS_STUN_INVALID_USERNAME_ATTRIBUTE_LENGTH);
+                break;
+            case STUN_ATTRIBUTE_TYPE_PRIORITY:
+                CHK(length == STUN_ATTRIBUTE_PRIORITY_LEN, STATUS_STUN_INVALID_PRIORITY_ATTRIBUTE_LENGTH);
+                break;
+            case STUN_ATTRIBUTE_TYPE_USE_CANDIDATE:
+            case STUN_ATTRIBUTE_TYPE_DONT_FRAGMENT:
+                CHK(length == STUN_ATTRIBUTE_FLAG_LEN, STATUS_STUN_INVALID_USE_CANDIDATE_ATTRIBUTE_LENGTH);
+                break;
+            case STUN_ATTRIBUTE_TYPE_LIFETIME:
+                CHK(length == STUN_ATTRIBUTE_LIFETIME_LEN, STATUS_STUN_INVALID_LIFETIME_ATTRIBUTE_LENGTH);
+                break;
+            case STUN_ATTRIBUTE_TYPE_CHANGE_REQUEST:
+                CHK(length == STUN_ATTRIBUTE_CHANGE_REQUEST_FLAG_LEN, STATUS_STUN_INVALID_CHANGE_REQUEST_ATTRIBUTE_LENGTH);
+                break;
+            case STUN_ATTRIBUTE_TYPE_REQUESTED_TRANSPORT:
+                CHK(length == STUN_ATTRIBUTE_REQUESTED_TRANSPORT_PROTOCOL_LEN, STATUS_STUN_INVALID_REQUESTED_TRANSPORT_ATTRIBUTE_LENGTH);
+                break;
+            case STUN_ATTRIBUTE_TYPE_REALM:
+                CHK(length <= STUN_MAX_REALM_LEN, STATUS_STUN_INVALID_REALM_ATTRIBUTE_LENGTH);
+                break;
+            case STUN_ATTRIBUTE_TYPE_NONCE:
+                CHK(length <= STUN_MAX_NONCE_LEN, STATUS_STUN_INVALID_NONCE_ATTRIBUTE_LENGTH);
+                break;
+            case STUN_ATTRIBUTE_TYPE_ERROR_CODE:
+                CHK(length <= STUN_MAX_ERROR_PHRASE_LEN, STATUS_STUN_INVALID_ERROR_CODE_ATTRIBUTE_LENGTH);
+                break;
+            case STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED:
+            case STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING:
+                CHK(length == STUN_ATTRIBUTE_ICE_CONTROL_LEN, STATUS_STUN_INVALID_ICE_CONTROL_ATTRIBUTE_LENGTH);
+                break;
+            case STUN_ATTRIBUTE_TYPE_DATA:
+                break;
+            case STUN_ATTRIBUTE_TYPE_CHANNEL_NUMBER:
+                CHK(length == STUN_ATTRIBUTE_CHANNEL_NUMBER_LEN, STATUS_STUN_INVALID_CHANNEL_NUMBER_ATTRIBUTE_LENGTH);
+                break;
+
+            case STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY:
+                CHK(length == STUN_HMAC_VALUE_LEN, STATUS_STUN_INVALID_MESSAGE_INTEGRITY_ATTRIBUTE_LENGTH);
+                CHK(!messageIntegrityFound, STATUS_STUN_MULTIPLE_MESSAGE_INTEGRITY_ATTRIBUTES);
+                CHK(!fingerprintFound, STATUS_STUN_MESSAGE_INTEGRITY_AFTER_FINGERPRINT);
+                CHK(pHmacKey != NULL, STATUS_NULL_ARG);
+                messageIntegrityFound = TRUE;
+
+                // The HMAC covers the header with the length up to and including this attribute
+                putInt16((PINT16) (pStunBuffer + STUN_HEADER_TYPE_LEN), (UINT16) (pValue + STUN_HMAC_VALUE_LEN - pStunBuffer - STUN_HEADER_LEN));
+                lengthModified = TRUE;
+                CHK_STATUS(computeStunMessageIntegrity(pHmacKey, pStunBuffer, (UINT32) (pCurrent - pStunBuffer), messageIntegrity));
+                putInt16((PINT16) (pStunBuffer + STUN_HEADER_TYPE_LEN), messageLength);
+                lengthModified = FALSE;
+
+                CHK(0 == MEMCMP(messageIntegrity, pValue, STUN_HMAC_VALUE_LEN), STATUS_STUN_MESSAGE_INTEGRITY_MISMATCH);
+                break;
+
+            case STUN_ATTRIBUTE_TYPE_FINGERPRINT:
+                CHK(length == STUN_ATTRIBUTE_FINGERPRINT_LEN, STATUS_STUN_INVALID_FINGERPRINT_ATTRIBUTE_LENGTH);
+                CHK(!fingerprintFound, STATUS_STUN_MULTIPLE_FINGERPRINT_ATTRIBUTES);
+                fingerprintFound = TRUE;
+
+                putInt16((PINT16) (pStunBuffer + STUN_HEADER_TYPE_LEN),
+                         (UINT16) (pValue + STUN_ATTRIBUTE_FINGERPRINT_LEN - pStunBuffer - STUN_HEADER_LEN));
+                crc32 = computeStunFingerprint(pStunBuffer, (UINT32) (pCurrent - pStunBuffer));
+                putInt16((PINT16) (pStunBuffer + STUN_HEADER_TYPE_LEN), messageLength);
+
+                CHK(crc32 == (UINT32) getInt32(*(PUINT32) pValue), STATUS_STUN_FINGERPRINT_MISMATCH);
+                break;
+
+            default:
+                // Unknown attributes are skipped
+                known = FALSE;
+                break;
+        }
+
+        if (known) {
+            if (type != STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY && type != STUN_ATTRIBUTE_TYPE_FINGERPRINT) {
+                CHK(!fingerprintFound && !messageIntegrityFound, STATUS_STUN_ATTRIBUTES_AFTER_FINGERPRINT_MESSAGE_INTEGRITY);
+            }
+
+            CHK(pStunPacketView->attributesCount < STUN_ATTRIBUTE_MAX_COUNT, STATUS_STUN_MAX_ATTRIBUTE_COUNT);
+            pStunAttributeView = &pStunPacketView->attributes[pStunPacketView->attributesCount++];
+            pStunAttributeView->type = type;
+            pStunAttributeView->length = length;
+            pStunAttributeView->pValue = pValue;
+        }
+
+        pCurrent = pValue + paddedLength;
+    }
+
+CleanUp:
+
+    // Restore the original size if the validation bailed out
+    if (lengthModified) {
+        putInt16((PINT16) (pStunBuffer + STUN_HEADER_TYPE_LEN), messageLength);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS getStunPacketViewAttribute(PStunPacketView pStunPacketView, STUN_ATTRIBUTE_TYPE type, PStunAttributeView* ppStunAttributeView)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PStunAttributeView pStunAttributeView = NULL;
+    UINT32 i;
+
+    CHK(pStunPacketView != NULL && ppStunAttributeView != NULL, STATUS_NULL_ARG);
+
+    for (i = 0; i < pStunPacketView->attributesCount && pStunAttributeView == NULL; i++) {
+        if (pStunPacketView->attributes[i].type == (UINT16) type) {
+            pStunAttributeView = &pStunPacketView->attributes[i];
+        }
+    }
+
+    *ppStunAttributeView = pStunAttributeView;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS getStunPacketViewAddress(PStunPacketView pStunPacketView, PStunAttributeView pStunAttributeView, PKvsIpAddress pAddress)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pStunPacketView != NULL && pStunAttributeView != NULL && pAddress != NULL, STATUS_NULL_ARG);
+    CHK(pStunAttributeView->length > STUN_ATTRIBUTE_ADDRESS_HEADER_LEN &&
+            pStunAttributeView->length <= STUN_ATTRIBUTE_ADDRESS_HEADER_LEN + IPV6_ADDRESS_LENGTH,
+        STATUS_STUN_INVALID_ADDRESS_ATTRIBUTE_LENGTH);
+
+    MEMSET(pAddress, 0x00, SIZEOF(KvsIpAddress));
+    pAddress->family = (UINT16) getInt16(*(PUINT16) pStunAttributeView->pValue) & (UINT16) 0x00ff;
+
+    // The port stays in network byte order
+    MEMCPY(&pAddress->port, pStunAttributeView->pValue + STUN_ATTRIBUTE_ADDRESS_FAMILY_LEN, SIZEOF(pAddress->port));
+    MEMCPY(pAddress->address, pStunAttributeView->pValue + STUN_ATTRIBUTE_ADDRESS_HEADER_LEN,
+           pStunAttributeView->length - STUN_ATTRIBUTE_ADDRESS_HEADER_LEN);
+
+    if (pStunAttributeView->type == STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS || pStunAttributeView->type == STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS) {
+        CHK_STATUS(xorIpAddress(pAddress, pStunPacketView->transactionId));
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS initStunHmacKey(PStunHmacKey pStunHmacKey, PBYTE key, UINT32 keyLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE paddedKey[STUN_HMAC_BLOCK_LEN];
+    KVS_SHA1_CONTEXT keyContext;
+    UINT32 i;
+
+    CHK(pStunHmacKey != NULL && (key != NULL || keyLen == 0), STATUS_NULL_ARG);
+
+    // https://tools.ietf.org/html/rfc2104#section-2, keys longer than a block are hashed first
+    MEMSET(paddedKey, 0x00, SIZEOF(paddedKey));
+    if (keyLen > STUN_HMAC_BLOCK_LEN) {
+        KVS_SHA1_INIT(&keyContext);
+        KVS_SHA1_UPDATE(&keyContext, key, keyLen);
+        KVS_SHA1_FINAL(&keyContext, paddedKey);
+        KVS_SHA1_FREE(&keyContext);
+    } else if (keyLen != 0) {
+        MEMCPY(paddedKey, key, keyLen);
+    }
+
+    for (i = 0; i < STUN_HMAC_BLOCK_LEN; i++) {
+        paddedKey[i] ^= 0x36;
+    }
+    KVS_SHA1_INIT(&pStunHmacKey->innerContext);
+    KVS_SHA1_UPDATE(&pStunHmacKey->innerContext, paddedKey, STUN_HMAC_BLOCK_LEN);
+
+    for (i = 0; i < STUN_HMAC_BLOCK_LEN; i++) {
+        paddedKey[i] ^= 0x36 ^ 0x5c;
+    }
+    KVS_SHA1_INIT(&pStunHmacKey->outerContext);
+    KVS_SHA1_UPDATE(&pStunHmacKey->outerContext, paddedKey, STUN_HMAC_BLOCK_LEN);
+
+CleanUp:
+
+    MEMSET(paddedKey, 0x00, SIZEOF(paddedKey));
+
+    return retStatus;
+}
+
+STATUS freeStunHmacKey(PStunHmacKey pStunHmacKey)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pStunHmacKey != NULL, STATUS_NULL_ARG);
+
+    KVS_SHA1_FREE(&pStunHmacKey->innerContext);
+    KVS_SHA1_FREE(&pStunHmacKey->outerContext);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS computeStunMessageIntegrity(PStunHmacKey pStunHmacKey, PBYTE pMessage, UINT32 messageLen, PBYTE pDigest)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    KVS_SHA1_CONTEXT context;
+    BYTE innerDigest[KVS_SHA1_DIGEST_LENGTH];
+
+    CHK(pStunHmacKey != NULL && pMessage != NULL && pDigest != NULL, STATUS_NULL_ARG);
+
+    // Only the message is hashed, the padded key blocks are already in the copied contexts
+    KVS_SHA1_COPY(&context, &pStunHmacKey->innerContext);
+    KVS_SHA1_UPDATE(&context, pMessage, messageLen);
+    KVS_SHA1_FINAL(&context, innerDigest);
+
+    KVS_SHA1_COPY(&context, &pStunHmacKey->outerContext);
+    KVS_SHA1_UPDATE(&context, innerDigest, KVS_SHA1_DIGEST_LENGTH);
+    KVS_SHA1_FINAL(&context, pDigest);
+
+CleanUp:
+
+    KVS_SHA1_FREE(&context);
+
+    return retStatus;
+}
+
+UINT32 computeStunFingerprint(PBYTE pBuffer, UINT32 size)
+{
+#if defined(__ARM_FEATURE_CRC32) && !defined(__ARM_BIG_ENDIAN)
+    // The ARMv8 CRC32 instructions use the same polynomial as the STUN fingerprint
+    UINT32 crc32 = 0xFFFFFFFF;
+    UINT64 data64;
+
+    for (; size >= SIZEOF(UINT64); size -= SIZEOF(UINT64), pBuffer += SIZEOF(UINT64)) {
+        MEMCPY(&data64, pBuffer, SIZEOF(UINT64));
+        crc32 = __crc32d(crc32, data64);
+    }
+
+    for (; size > 0; size--, pBuffer++) {
+        crc32 = __crc32b(crc32, *pBuffer);
+    }
+
+    return ~crc32 ^ STUN_FINGERPRINT_ATTRIBUTE_XOR_VALUE;
+#else
+    return COMPUTE_CRC32(pBuffer, size) ^ STUN_FINGERPRINT_ATTRIBUTE_XOR_VALUE;
+#endif
+}
+
 STATUS freeStunPacket(PStunPacket* ppStunPacket)
 {
     ENTERS();
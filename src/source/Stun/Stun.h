@@ -97,6 +97,11 @@ extern "C" {
  */
 #define STUN_ATTRIBUTE_MAX_COUNT 20
 
+/**
+ * HMAC-SHA1 block size, the key is padded to it
+ */
+#define STUN_HMAC_BLOCK_LEN 64
+
 /**
  * Default allocation size for a STUN packet
  */
@@ -379,8 +384,125 @@ typedef struct {
     PStunAttributeHeader* attributeList;
 } StunPacket, *PStunPacket;
 
+/**
+ * HMAC-SHA1 key schedule of a STUN credential. The inner and outer digests are primed with the padded key once so that
+ * the message integrity of a packet only costs the hashing of the packet itself.
+ */
+typedef struct {
+    KVS_SHA1_CONTEXT innerContext;
+    KVS_SHA1_CONTEXT outerContext;
+} StunHmacKey, *PStunHmacKey;
+
+/**
+ * Attribute of a parsed STUN packet, pointing into the packet buffer
+ */
+typedef struct {
+    UINT16 type;
+
+    // Length of the value without the padding
+    UINT16 length;
+
+    PBYTE pValue;
+} StunAttributeView, *PStunAttributeView;
+
+/**
+ * STUN packet parsed in place. Nothing is copied or allocated, the view is only valid as long as the buffer is.
+ */
+typedef struct {
+    PBYTE pBuffer;
+
+    UINT16 stunMessageType;
+    UINT16 messageLength;
+    PBYTE transactionId;
+
+    UINT32 attributesCount;
+    StunAttributeView attributes[STUN_ATTRIBUTE_MAX_COUNT];
+} StunPacketView, *PStunPacketView;
+
 STATUS serializeStunPacket(PStunPacket, PBYTE, UINT32, BOOL, BOOL, PBYTE, PUINT32);
 STATUS deserializeStunPacket(PBYTE, UINT32, PBYTE, UINT32, PStunPacket*);
+
+/**
+ * Same as serializeStunPacket with a precomputed key. The message integrity is generated when the key is not NULL.
+ * When the buffer is specified the size is its capacity and is set to the packaged size on return.
+ *
+ * @param - PStunPacket - IN - packet to serialize
+ * @param - PStunHmacKey - IN/OPT - message integrity key
+ * @param - BOOL - IN - whether to generate the fingerprint
+ * @param - PBYTE - IN/OPT - buffer to package into, NULL to only get the size
+ * @param - PUINT32 - IN/OUT - buffer capacity / packaged size
+ *
+ * @return - STATUS status of execution
+ */
+STATUS serializeStunPacketWithHmacKey(PStunPacket, PStunHmacKey, BOOL, PBYTE, PUINT32);
+
+/**
+ * Package a binding success response straight into the buffer, without building a StunPacket
+ *
+ * @param - PBYTE - IN - transaction id of the request
+ * @param - PKvsIpAddress - IN - source address of the request, sent back as XOR-MAPPED-ADDRESS
+ * @param - STUN_ATTRIBUTE_TYPE - IN - STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING or STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED
+ * @param - UINT64 - IN - tie breaker
+ * @param - PStunHmacKey - IN - message integrity key
+ * @param - PBYTE - IN - buffer to package into
+ * @param - PUINT32 - IN/OUT - buffer capacity / packaged size
+ *
+ * @return - STATUS status of execution
+ */
+STATUS serializeStunBindingResponse(PBYTE, PKvsIpAddress, STUN_ATTRIBUTE_TYPE, UINT64, PStunHmacKey, PBYTE, PUINT32);
+
+/**
+ * Parse a STUN packet in place. Message integrity and fingerprint are validated the same way deserializeStunPacket
+ * does. The buffer is temporarily modified during the validation.
+ *
+ * @param - PBYTE - IN - packet
+ * @param - UINT32 - IN - packet size
+ * @param - PStunHmacKey - IN/OPT - message integrity key, required if the packet has a message integrity
+ * @param - PStunPacketView - OUT - parsed packet
+ *
+ * @return - STATUS status of execution
+ */
+STATUS parseStunPacketView(PBYTE, UINT32, PStunHmacKey, PStunPacketView);
+
+/**
+ * First attribute of the given type, NULL if the packet does not have one
+ */
+STATUS getStunPacketViewAttribute(PStunPacketView, STUN_ATTRIBUTE_TYPE, PStunAttributeView*);
+
+/**
+ * Decode an address attribute of the view, undoing the XOR for the XOR address types
+ */
+STATUS getStunPacketViewAddress(PStunPacketView, PStunAttributeView, PKvsIpAddress);
+
+/**
+ * Precompute the key schedule of a credential
+ *
+ * @param - PStunHmacKey - OUT - key schedule
+ * @param - PBYTE - IN - credential
+ * @param - UINT32 - IN - credential length
+ *
+ * @return - STATUS status of execution
+ */
+STATUS initStunHmacKey(PStunHmacKey, PBYTE, UINT32);
+STATUS freeStunHmacKey(PStunHmacKey);
+
+/**
+ * HMAC-SHA1 of the message with a precomputed key schedule
+ *
+ * @param - PStunHmacKey - IN - key schedule
+ * @param - PBYTE - IN - message
+ * @param - UINT32 - IN - message length
+ * @param - PBYTE - OUT - STUN_HMAC_VALUE_LEN bytes digest
+ *
+ * @return - STATUS status of execution
+ */
+STATUS computeStunMessageIntegrity(PStunHmacKey, PBYTE, UINT32, PBYTE);
+
+/**
+ * STUN fingerprint of the buffer: CRC-32 XORed with STUN_FINGERPRINT_ATTRIBUTE_XOR_VALUE. Uses the CRC32 instructions
+ * when built for ARMv8 with the CRC extension.
+ */
+UINT32 computeStunFingerprint(PBYTE, UINT32);
 STATUS freeStunPacket(PStunPacket*);
 STATUS createStunPacket(STUN_PACKET_TYPE, PBYTE, PStunPacket*);
 STATUS appendStunAddressAttribute(PStunPacket, STUN_ATTRIBUTE_TYPE, PKvsIpAddress);
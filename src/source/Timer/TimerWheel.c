@@ -0,0 +1,667 @@
+/**
+ * Kinesis Video Producer Shared Timer Wheel
+ */
+#define LOG_CLASS "TimerWheel"
+#include "../Include_i.h"
+
+PTimerWheelService getTimerWheelServiceInstance()
+{
+    static TimerWheelService service = {.lock = INVALID_MUTEX_VALUE, .isInitialized = FALSE, .wheelCount = 0};
+    return &service;
+}
+
+STATUS createTimerWheelService()
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTimerWheelService pTimerWheelService = getTimerWheelServiceInstance();
+
+    CHK_ERR(!IS_VALID_MUTEX_VALUE(pTimerWheelService->lock), STATUS_INVALID_OPERATION, "Timer wheel service has been created already");
+
+    pTimerWheelService->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pTimerWheelService->lock), STATUS_INVALID_OPERATION);
+    pTimerWheelService->isInitialized = TRUE;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS freeTimerWheelService()
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    UINT32 i;
+    PTimerWheelService pTimerWheelService = getTimerWheelServiceInstance();
+
+    CHK_WARN(IS_VALID_MUTEX_VALUE(pTimerWheelService->lock), STATUS_INVALID_OPERATION, "Timer wheel service not created, nothing to free");
+
+    MUTEX_LOCK(pTimerWheelService->lock);
+    locked = TRUE;
+
+    pTimerWheelService->isInitialized = FALSE;
+    for (i = 0; i < pTimerWheelService->wheelCount; i++) {
+        if (pTimerWheelService->wheelUsers[i] != 0) {
+            DLOGW("Freeing timer wheel %u with %u timer queue(s) still attached", i, pTimerWheelService->wheelUsers[i]);
+        }
+
+        CHK_LOG_ERR(freeTimerWheel(&pTimerWheelService->wheels[i]));
+        pTimerWheelService->wheelUsers[i] = 0;
+    }
+
+    // All members of the static instance must be reset so that the service can be created again
+    pTimerWheelService->wheelCount = 0;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pTimerWheelService->lock);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pTimerWheelService->lock)) {
+        MUTEX_FREE(pTimerWheelService->lock);
+        pTimerWheelService->lock = INVALID_MUTEX_VALUE;
+    }
+
+    return retStatus;
+}
+
+UINT32 timerWheelServiceGetThreadCount()
+{
+    PCHAR pThreadCount;
+    UINT32 threadCount;
+
+    if (NULL == (pThreadCount = GETENV(WEBRTC_TIMER_WHEEL_THREADS_ENV_VAR)) || STATUS_SUCCESS != STRTOUI32(pThreadCount, NULL, 10, &threadCount)) {
+        threadCount = TIMER_WHEEL_DEFAULT_THREADS;
+    }
+
+    return MIN(threadCount, TIMER_WHEEL_MAX_THREADS);
+}
+
+STATUS createTimerWheel(PTimerWheel* ppTimerWheel)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTimerWheel pTimerWheel = NULL;
+
+    CHK(ppTimerWheel != NULL, STATUS_NULL_ARG);
+
+    pTimerWheel = (PTimerWheel) MEMCALLOC(1, SIZEOF(TimerWheel));
+    CHK(pTimerWheel != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pTimerWheel->serviceRoutine = INVALID_TID_VALUE;
+    pTimerWheel->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pTimerWheel->lock), STATUS_INVALID_OPERATION);
+    pTimerWheel->wakeCvar = CVAR_CREATE();
+    CHK(IS_VALID_CVAR_VALUE(pTimerWheel->wakeCvar), STATUS_INVALID_OPERATION);
+    pTimerWheel->baseTime = GETTIME();
+
+    CHK_STATUS(THREAD_CREATE(&pTimerWheel->serviceRoutine, timerWheelServiceRoutine, (PVOID) pTimerWheel));
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && pTimerWheel != NULL) {
+        freeTimerWheel(&pTimerWheel);
+    }
+
+    if (ppTimerWheel != NULL) {
+        *ppTimerWheel = pTimerWheel;
+    }
+
+    return retStatus;
+}
+
+STATUS freeTimerWheel(PTimerWheel* ppTimerWheel)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTimerWheel pTimerWheel;
+
+    CHK(ppTimerWheel != NULL, STATUS_NULL_ARG);
+    pTimerWheel = *ppTimerWheel;
+    CHK(pTimerWheel != NULL, retStatus);
+
+    if (IS_VALID_TID_VALUE(pTimerWheel->serviceRoutine)) {
+        MUTEX_LOCK(pTimerWheel->lock);
+        pTimerWheel->terminate = TRUE;
+        CVAR_SIGNAL(pTimerWheel->wakeCvar);
+        MUTEX_UNLOCK(pTimerWheel->lock);
+
+        THREAD_JOIN(pTimerWheel->serviceRoutine, NULL);
+    }
+
+    if (IS_VALID_CVAR_VALUE(pTimerWheel->wakeCvar)) {
+        CVAR_FREE(pTimerWheel->wakeCvar);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pTimerWheel->lock)) {
+        MUTEX_FREE(pTimerWheel->lock);
+    }
+
+    MEMFREE(pTimerWheel);
+    *ppTimerWheel = NULL;
+
+CleanUp:
+
+    return retStatus;
+}
+
+UINT64 timerWheelTimeToTick(PTimerWheel pTimerWheel, UINT64 time)
+{
+    // Round up so that a timer never fires before its due time
+    if (time <= pTimerWheel->baseTime) {
+        return 0;
+    }
+
+    return (time - pTimerWheel->baseTime + TIMER_WHEEL_TICK_DURATION - 1) / TIMER_WHEEL_TICK_DURATION;
+}
+
+VOID timerWheelInsertLocked(PTimerWheel pTimerWheel, PTimerWheelEntry pEntry)
+{
+    UINT64 expirationTick = MAX(pEntry->expirationTick, pTimerWheel->nextTick), delta;
+    UINT32 level = 0, index;
+
+    delta = expirationTick - pTimerWheel->nextTick;
+    if (delta > TIMER_WHEEL_MAX_TICKS) {
+        delta = TIMER_WHEEL_MAX_TICKS;
+        expirationTick = pTimerWheel->nextTick + delta;
+    }
+
+    // Pick the finest level whose range covers the remaining time. The slot is indexed with the absolute tick so that it
+    // is reached exactly when the level below wraps around
+    while (level < TIMER_WHEEL_LEVEL_COUNT - 1 && delta >= ((UINT64) 1 << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+
+    index = (UINT32) ((expirationTick >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK);
+
+    pEntry->expirationTick = expirationTick;
+    pEntry->ppSlot = &pTimerWheel->slots[level][index];
+    pEntry->pPrev = NULL;
+    pEntry->pNext = *pEntry->ppSlot;
+    if (pEntry->pNext != NULL) {
+        pEntry->pNext->pPrev = pEntry;
+    }
+    *pEntry->ppSlot = pEntry;
+
+    if (level == 0) {
+        pTimerWheel->firstLevelBitmap[index / 64] |= (UINT64) 1 << (index % 64);
+    }
+
+    pTimerWheel->entryCount++;
+}
+
+VOID timerWheelRemoveLocked(PTimerWheel pTimerWheel, PTimerWheelEntry pEntry)
+{
+    UINT32 index;
+
+    if (pEntry->ppSlot == NULL) {
+        return;
+    }
+
+    if (pEntry->pPrev != NULL) {
+        pEntry->pPrev->pNext = pEntry->pNext;
+    } else {
+        *pEntry->ppSlot = pEntry->pNext;
+    }
+
+    if (pEntry->pNext != NULL) {
+        pEntry->pNext->pPrev = pEntry->pPrev;
+    }
+
+    // Entries being expired hang off a list outside of the wheel
+    if (*pEntry->ppSlot == NULL && pEntry->ppSlot >= &pTimerWheel->slots[0][0] &&
+        pEntry->ppSlot < &pTimerWheel->slots[0][0] + TIMER_WHEEL_SLOT_COUNT) {
+        index = (UINT32) (pEntry->ppSlot - &pTimerWheel->slots[0][0]);
+        pTimerWheel->firstLevelBitmap[index / 64] &= ~((UINT64) 1 << (index % 64));
+    }
+
+    pEntry->ppSlot = NULL;
+    pEntry->pNext = NULL;
+    pEntry->pPrev = NULL;
+    pTimerWheel->entryCount--;
+}
+
+VOID timerWheelCascadeLocked(PTimerWheel pTimerWheel, UINT32 level, UINT32 index)
+{
+    PTimerWheelEntry pEntry = pTimerWheel->slots[level][index], pNext;
+
+    pTimerWheel->slots[level][index] = NULL;
+    while (pEntry != NULL) {
+        pNext = pEntry->pNext;
+        pEntry->ppSlot = NULL;
+        pTimerWheel->entryCount--;
+        timerWheelInsertLocked(pTimerWheel, pEntry);
+        pEntry = pNext;
+    }
+}
+
+UINT64 timerWheelNextEventTickLocked(PTimerWheel pTimerWheel)
+{
+    UINT32 start = (UINT32) (pTimerWheel->nextTick & TIMER_WHEEL_SLOT_MASK), index = start;
+    UINT64 bits;
+
+    while (index < TIMER_WHEEL_SLOT_COUNT) {
+        bits = pTimerWheel->firstLevelBitmap[index / 64] >> (index % 64);
+        if (bits == 0) {
+            index = (index / 64 + 1) * 64;
+            continue;
+        }
+
+        while ((bits & 1) == 0) {
+            bits >>= 1;
+            index++;
+        }
+
+        return pTimerWheel->nextTick + (index - start);
+    }
+
+    // Nothing else on the first level until it wraps around and the next level cascades
+    return pTimerWheel->nextTick + (TIMER_WHEEL_SLOT_COUNT - start);
+}
+
+VOID timerWheelProcessTickLocked(PTimerWheel pTimerWheel)
+{
+    UINT32 index = (UINT32) (pTimerWheel->nextTick & TIMER_WHEEL_SLOT_MASK), level, levelIndex, generation;
+    PTimerWheelEntry pExpired, pEntry;
+    PSharedTimerQueue pSharedTimerQueue;
+
+    if (index == 0) {
+        for (level = 1; level < TIMER_WHEEL_LEVEL_COUNT; level++) {
+            levelIndex = (UINT32) ((pTimerWheel->nextTick >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK);
+            timerWheelCascadeLocked(pTimerWheel, level, levelIndex);
+            if (levelIndex != 0) {
+                break;
+            }
+        }
+    }
+
+    pTimerWheel->nextTick++;
+
+    // Detach the expired slot as callbacks can schedule new timers into it for the next rotation
+    pExpired = pTimerWheel->slots[0][index];
+    pTimerWheel->slots[0][index] = NULL;
+    pTimerWheel->firstLevelBitmap[index / 64] &= ~((UINT64) 1 << (index % 64));
+    for (pEntry = pExpired; pEntry != NULL; pEntry = pEntry->pNext) {
+        pEntry->ppSlot = &pExpired;
+    }
+
+    while ((pEntry = pExpired) != NULL) {
+        timerWheelRemoveLocked(pTimerWheel, pEntry);
+        pSharedTimerQueue = pEntry->pQueue;
+        generation = pEntry->generation;
+        pSharedTimerQueue->pendingDispatchCount++;
+
+        MUTEX_UNLOCK(pTimerWheel->lock);
+        sharedTimerQueueDispatch(pEntry, generation);
+        MUTEX_LOCK(pTimerWheel->lock);
+    }
+}
+
+PVOID timerWheelServiceRoutine(PVOID arg)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTimerWheel pTimerWheel = (PTimerWheel) arg;
+    UINT64 currentTick, wakeTime, currentTime;
+
+    CHK(pTimerWheel != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pTimerWheel->lock);
+    while (!pTimerWheel->terminate) {
+        currentTime = GETTIME();
+        currentTick = currentTime <= pTimerWheel->baseTime ? 0 : (currentTime - pTimerWheel->baseTime) / TIMER_WHEEL_TICK_DURATION;
+
+        // An empty wheel can skip ahead instead of walking every idle tick
+        if (pTimerWheel->entryCount == 0 && pTimerWheel->nextTick < currentTick) {
+            pTimerWheel->nextTick = currentTick;
+        }
+
+        if (pTimerWheel->nextTick <= currentTick) {
+            timerWheelProcessTickLocked(pTimerWheel);
+            continue;
+        }
+
+        if (pTimerWheel->entryCount == 0) {
+            pTimerWheel->wakeTick = MAX_UINT64;
+            CVAR_WAIT(pTimerWheel->wakeCvar, pTimerWheel->lock, INFINITE_TIME_VALUE);
+        } else {
+            pTimerWheel->wakeTick = timerWheelNextEventTickLocked(pTimerWheel);
+            wakeTime = pTimerWheel->baseTime + pTimerWheel->wakeTick * TIMER_WHEEL_TICK_DURATION;
+            if (wakeTime > currentTime) {
+                CVAR_WAIT(pTimerWheel->wakeCvar, pTimerWheel->lock, wakeTime - currentTime);
+            }
+        }
+
+        // Awake, new timers do not need to signal until the next wait
+        pTimerWheel->wakeTick = 0;
+    }
+    MUTEX_UNLOCK(pTimerWheel->lock);
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return NULL;
+}
+
+STATUS sharedTimerQueueCreate(PTIMER_QUEUE_HANDLE pHandle)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE, started = FALSE;
+    UINT32 i, wheelCount, selected = 0;
+    PSharedTimerQueue pSharedTimerQueue = NULL;
+    PTimerWheelService pTimerWheelService = getTimerWheelServiceInstance();
+
+    CHK(pHandle != NULL, STATUS_NULL_ARG);
+
+    wheelCount = timerWheelServiceGetThreadCount();
+    if (wheelCount == 0 || !IS_VALID_MUTEX_VALUE(pTimerWheelService->lock)) {
+        CHK_STATUS(timerQueueCreate(pHandle));
+        CHK(FALSE, retStatus);
+    }
+
+    MUTEX_LOCK(pTimerWheelService->lock);
+    locked = TRUE;
+
+    CHK_ERR(pTimerWheelService->isInitialized, STATUS_INVALID_OPERATION, "Timer wheel service is shutting down");
+
+    // Start the wheels on first use
+    if (pTimerWheelService->wheelCount == 0) {
+        started = TRUE;
+        for (i = 0; i < wheelCount; i++) {
+            CHK_STATUS(createTimerWheel(&pTimerWheelService->wheels[i]));
+            pTimerWheelService->wheelUsers[i] = 0;
+            pTimerWheelService->wheelCount++;
+        }
+
+        DLOGI("Started %u shared timer wheel thread(s)", wheelCount);
+    }
+
+    for (i = 1; i < pTimerWheelService->wheelCount; i++) {
+        if (pTimerWheelService->wheelUsers[i] < pTimerWheelService->wheelUsers[selected]) {
+            selected = i;
+        }
+    }
+
+    // Entries and the free id stack follow the queue in the same allocation
+    pSharedTimerQueue = (PSharedTimerQueue) MEMCALLOC(
+        1, SIZEOF(SharedTimerQueue) + DEFAULT_TIMER_QUEUE_TIMER_COUNT * (SIZEOF(TimerWheelEntry) + SIZEOF(UINT32)));
+    CHK(pSharedTimerQueue != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pSharedTimerQueue->lock = MUTEX_CREATE(TRUE);
+    CHK(IS_VALID_MUTEX_VALUE(pSharedTimerQueue->lock), STATUS_INVALID_OPERATION);
+    pSharedTimerQueue->dispatchDoneCvar = CVAR_CREATE();
+    CHK(IS_VALID_CVAR_VALUE(pSharedTimerQueue->dispatchDoneCvar), STATUS_INVALID_OPERATION);
+    pSharedTimerQueue->pWheel = pTimerWheelService->wheels[selected];
+    pSharedTimerQueue->wheelIndex = selected;
+    pSharedTimerQueue->maxTimerCount = DEFAULT_TIMER_QUEUE_TIMER_COUNT;
+    pSharedTimerQueue->pEntries = (PTimerWheelEntry) (pSharedTimerQueue + 1);
+    pSharedTimerQueue->freeTimerIds = (PUINT32) (pSharedTimerQueue->pEntries + pSharedTimerQueue->maxTimerCount);
+    for (i = 0; i < pSharedTimerQueue->maxTimerCount; i++) {
+        pSharedTimerQueue->pEntries[i].pQueue = pSharedTimerQueue;
+        pSharedTimerQueue->pEntries[i].timerId = i;
+        // Hand out the lowest ids first
+        pSharedTimerQueue->freeTimerIds[i] = pSharedTimerQueue->maxTimerCount - 1 - i;
+    }
+    pSharedTimerQueue->freeTimerCount = pSharedTimerQueue->maxTimerCount;
+
+    pTimerWheelService->wheelUsers[selected]++;
+    *pHandle = TO_SHARED_TIMER_QUEUE_HANDLE(pSharedTimerQueue);
+    pSharedTimerQueue = NULL;
+
+CleanUp:
+
+    if (pSharedTimerQueue != NULL) {
+        if (IS_VALID_MUTEX_VALUE(pSharedTimerQueue->lock)) {
+            MUTEX_FREE(pSharedTimerQueue->lock);
+        }
+        if (IS_VALID_CVAR_VALUE(pSharedTimerQueue->dispatchDoneCvar)) {
+            CVAR_FREE(pSharedTimerQueue->dispatchDoneCvar);
+        }
+        MEMFREE(pSharedTimerQueue);
+    }
+
+    if (STATUS_FAILED(retStatus) && started) {
+        // Do not leave a partially started service behind
+        for (i = 0; i < pTimerWheelService->wheelCount; i++) {
+            freeTimerWheel(&pTimerWheelService->wheels[i]);
+        }
+        pTimerWheelService->wheelCount = 0;
+    }
+
+    if (locked) {
+        MUTEX_UNLOCK(pTimerWheelService->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS sharedTimerQueueAddTimer(TIMER_QUEUE_HANDLE handle, UINT64 start, UINT64 period, TimerCallbackFunc timerCallbackFn, UINT64 customData,
+                                PUINT32 pIndex)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    PSharedTimerQueue pSharedTimerQueue;
+    PTimerWheelEntry pEntry;
+    PTimerWheel pTimerWheel;
+
+    if (!IS_SHARED_TIMER_QUEUE_HANDLE(handle)) {
+        CHK_STATUS(timerQueueAddTimer(handle, start, period, timerCallbackFn, customData, pIndex));
+        CHK(FALSE, retStatus);
+    }
+
+    CHK(timerCallbackFn != NULL && pIndex != NULL, STATUS_NULL_ARG);
+    pSharedTimerQueue = FROM_SHARED_TIMER_QUEUE_HANDLE(handle);
+    pTimerWheel = pSharedTimerQueue->pWheel;
+
+    MUTEX_LOCK(pSharedTimerQueue->lock);
+    locked = TRUE;
+
+    CHK(!pSharedTimerQueue->shutdown, STATUS_TIMER_QUEUE_SHUTDOWN);
+    CHK(pSharedTimerQueue->freeTimerCount > 0, STATUS_MAX_TIMER_COUNT_REACHED);
+
+    pEntry = &pSharedTimerQueue->pEntries[pSharedTimerQueue->freeTimerIds[--pSharedTimerQueue->freeTimerCount]];
+    pEntry->active = TRUE;
+    pEntry->period = period;
+    pEntry->customData = customData;
+    pEntry->timerCallbackFn = timerCallbackFn;
+
+    MUTEX_LOCK(pTimerWheel->lock);
+    pEntry->expirationTick = timerWheelTimeToTick(pTimerWheel, GETTIME() + start);
+    timerWheelInsertLocked(pTimerWheel, pEntry);
+    if (pEntry->expirationTick < pTimerWheel->wakeTick) {
+        CVAR_SIGNAL(pTimerWheel->wakeCvar);
+    }
+    MUTEX_UNLOCK(pTimerWheel->lock);
+
+    *pIndex = pEntry->timerId;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSharedTimerQueue->lock);
+    }
+
+    return retStatus;
+}
+
+VOID sharedTimerQueueReleaseEntryLocked(PSharedTimerQueue pSharedTimerQueue, PTimerWheelEntry pEntry)
+{
+    MUTEX_LOCK(pSharedTimerQueue->pWheel->lock);
+    timerWheelRemoveLocked(pSharedTimerQueue->pWheel, pEntry);
+    pEntry->generation++;
+    MUTEX_UNLOCK(pSharedTimerQueue->pWheel->lock);
+
+    pEntry->active = FALSE;
+    pEntry->timerCallbackFn = NULL;
+    pEntry->customData = 0;
+    pSharedTimerQueue->freeTimerIds[pSharedTimerQueue->freeTimerCount++] = pEntry->timerId;
+}
+
+VOID sharedTimerQueueDispatch(PTimerWheelEntry pEntry, UINT32 generation)
+{
+    STATUS callbackStatus;
+    UINT64 currentTime;
+    PSharedTimerQueue pSharedTimerQueue = pEntry->pQueue;
+    PTimerWheel pTimerWheel = pSharedTimerQueue->pWheel;
+
+    MUTEX_LOCK(pSharedTimerQueue->lock);
+
+    // The timer might have been cancelled, and its id reused, after it was taken off the wheel
+    if (!pSharedTimerQueue->shutdown && pEntry->active && pEntry->generation == generation) {
+        currentTime = GETTIME();
+        callbackStatus = pEntry->timerCallbackFn(pEntry->timerId, currentTime, pEntry->customData);
+
+        // The callback can cancel its own timer
+        if (pEntry->active && pEntry->generation == generation) {
+            if (callbackStatus == STATUS_TIMER_QUEUE_STOP_SCHEDULING || pEntry->period == TIMER_QUEUE_SINGLE_INVOCATION_PERIOD) {
+                sharedTimerQueueReleaseEntryLocked(pSharedTimerQueue, pEntry);
+            } else {
+                MUTEX_LOCK(pTimerWheel->lock);
+                pEntry->expirationTick = timerWheelTimeToTick(pTimerWheel, currentTime + pEntry->period);
+                timerWheelInsertLocked(pTimerWheel, pEntry);
+                MUTEX_UNLOCK(pTimerWheel->lock);
+            }
+        }
+    }
+
+    MUTEX_UNLOCK(pSharedTimerQueue->lock);
+
+    // The queue can be freed as soon as the waiter in sharedTimerQueueShutdown gets the wheel lock, do not touch it after
+    MUTEX_LOCK(pTimerWheel->lock);
+    if (--pSharedTimerQueue->pendingDispatchCount == 0) {
+        CVAR_BROADCAST(pSharedTimerQueue->dispatchDoneCvar);
+    }
+    MUTEX_UNLOCK(pTimerWheel->lock);
+}
+
+STATUS sharedTimerQueueCancelTimer(TIMER_QUEUE_HANDLE handle, UINT32 timerId, UINT64 customData)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    PSharedTimerQueue pSharedTimerQueue;
+    PTimerWheelEntry pEntry;
+
+    if (!IS_SHARED_TIMER_QUEUE_HANDLE(handle)) {
+        CHK_STATUS(timerQueueCancelTimer(handle, timerId, customData));
+        CHK(FALSE, retStatus);
+    }
+
+    pSharedTimerQueue = FROM_SHARED_TIMER_QUEUE_HANDLE(handle);
+
+    MUTEX_LOCK(pSharedTimerQueue->lock);
+    locked = TRUE;
+
+    CHK(timerId < pSharedTimerQueue->maxTimerCount, STATUS_INVALID_ARG);
+    pEntry = &pSharedTimerQueue->pEntries[timerId];
+    if (pEntry->active && pEntry->customData == customData) {
+        sharedTimerQueueReleaseEntryLocked(pSharedTimerQueue, pEntry);
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSharedTimerQueue->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS sharedTimerQueueUpdateTimerPeriod(TIMER_QUEUE_HANDLE handle, UINT64 customData, UINT32 timerId, UINT64 period)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    PSharedTimerQueue pSharedTimerQueue;
+    PTimerWheelEntry pEntry;
+
+    if (!IS_SHARED_TIMER_QUEUE_HANDLE(handle)) {
+        CHK_STATUS(timerQueueUpdateTimerPeriod(handle, customData, timerId, period));
+        CHK(FALSE, retStatus);
+    }
+
+    pSharedTimerQueue = FROM_SHARED_TIMER_QUEUE_HANDLE(handle);
+
+    MUTEX_LOCK(pSharedTimerQueue->lock);
+    locked = TRUE;
+
+    CHK(timerId < pSharedTimerQueue->maxTimerCount, STATUS_INVALID_ARG);
+    pEntry = &pSharedTimerQueue->pEntries[timerId];
+
+    // Takes effect when the timer is rescheduled after its next invocation
+    if (pEntry->active && pEntry->customData == customData) {
+        pEntry->period = period;
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSharedTimerQueue->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS sharedTimerQueueShutdown(TIMER_QUEUE_HANDLE handle)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSharedTimerQueue pSharedTimerQueue;
+    UINT32 i;
+
+    if (!IS_SHARED_TIMER_QUEUE_HANDLE(handle)) {
+        CHK_STATUS(timerQueueShutdown(handle));
+        CHK(FALSE, retStatus);
+    }
+
+    pSharedTimerQueue = FROM_SHARED_TIMER_QUEUE_HANDLE(handle);
+
+    MUTEX_LOCK(pSharedTimerQueue->lock);
+    pSharedTimerQueue->shutdown = TRUE;
+    for (i = 0; i < pSharedTimerQueue->maxTimerCount; i++) {
+        if (pSharedTimerQueue->pEntries[i].active) {
+            sharedTimerQueueReleaseEntryLocked(pSharedTimerQueue, &pSharedTimerQueue->pEntries[i]);
+        }
+    }
+    MUTEX_UNLOCK(pSharedTimerQueue->lock);
+
+    // Expirations already taken off the wheel are dropped by the wheel thread once it gets the queue lock
+    MUTEX_LOCK(pSharedTimerQueue->pWheel->lock);
+    while (pSharedTimerQueue->pendingDispatchCount > 0) {
+        CVAR_WAIT(pSharedTimerQueue->dispatchDoneCvar, pSharedTimerQueue->pWheel->lock, INFINITE_TIME_VALUE);
+    }
+    MUTEX_UNLOCK(pSharedTimerQueue->pWheel->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS sharedTimerQueueFree(PTIMER_QUEUE_HANDLE pHandle)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSharedTimerQueue pSharedTimerQueue;
+    PTimerWheelService pTimerWheelService = getTimerWheelServiceInstance();
+
+    CHK(pHandle != NULL, STATUS_NULL_ARG);
+
+    if (!IS_SHARED_TIMER_QUEUE_HANDLE(*pHandle)) {
+        CHK_STATUS(timerQueueFree(pHandle));
+        CHK(FALSE, retStatus);
+    }
+
+    pSharedTimerQueue = FROM_SHARED_TIMER_QUEUE_HANDLE(*pHandle);
+    CHK_LOG_ERR(sharedTimerQueueShutdown(*pHandle));
+
+    if (IS_VALID_MUTEX_VALUE(pTimerWheelService->lock)) {
+        MUTEX_LOCK(pTimerWheelService->lock);
+        if (pSharedTimerQueue->wheelIndex < pTimerWheelService->wheelCount && pTimerWheelService->wheelUsers[pSharedTimerQueue->wheelIndex] > 0) {
+            pTimerWheelService->wheelUsers[pSharedTimerQueue->wheelIndex]--;
+        }
+        MUTEX_UNLOCK(pTimerWheelService->lock);
+    }
+
+    MUTEX_FREE(pSharedTimerQueue->lock);
+    CVAR_FREE(pSharedTimerQueue->dispatchDoneCvar);
+    MEMFREE(pSharedTimerQueue);
+    *pHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+
+CleanUp:
+
+    return retStatus;
+}
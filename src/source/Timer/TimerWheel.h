@@ -0,0 +1,175 @@
+/*******************************************
+Shared Timer Wheel internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_TIMER_WHEEL__
+#define __KINESIS_VIDEO_WEBRTC_TIMER_WHEEL__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Resolution of the wheel. Timers never fire early, at most one tick late
+#define TIMER_WHEEL_TICK_DURATION (5 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+
+// 4 levels of 256 slots cover 2^32 ticks, longer timers are clamped to that range
+#define TIMER_WHEEL_LEVEL_COUNT 4
+#define TIMER_WHEEL_SLOT_BITS   8
+#define TIMER_WHEEL_SLOT_COUNT  (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK   (TIMER_WHEEL_SLOT_COUNT - 1)
+#define TIMER_WHEEL_MAX_TICKS   ((UINT64) MAX_UINT32)
+
+// Occupancy bitmap of the first level, used to sleep until the next populated slot
+#define TIMER_WHEEL_BITMAP_WORD_COUNT (TIMER_WHEEL_SLOT_COUNT / 64)
+
+// Shared timer queue handles are tagged pointers so that they can travel through the same TIMER_QUEUE_HANDLE plumbing as
+// handles returned by timerQueueCreate, whose pointers are always at least 2 byte aligned
+#define SHARED_TIMER_QUEUE_HANDLE_TAG     ((UINT64) 0x1)
+#define IS_SHARED_TIMER_QUEUE_HANDLE(h)   (((h) & SHARED_TIMER_QUEUE_HANDLE_TAG) != 0)
+#define TO_SHARED_TIMER_QUEUE_HANDLE(p)   ((TIMER_QUEUE_HANDLE) (p) | SHARED_TIMER_QUEUE_HANDLE_TAG)
+#define FROM_SHARED_TIMER_QUEUE_HANDLE(h) ((struct __SharedTimerQueue*) ((h) & ~SHARED_TIMER_QUEUE_HANDLE_TAG))
+
+struct __TimerWheel;
+struct __SharedTimerQueue;
+
+typedef struct __TimerWheelEntry TimerWheelEntry;
+struct __TimerWheelEntry {
+    // Links within the wheel slot, only accessed with the wheel lock held
+    struct __TimerWheelEntry* pNext;
+    struct __TimerWheelEntry* pPrev;
+    struct __TimerWheelEntry** ppSlot;
+
+    // Owner, its lock protects all the members below. generation is only changed with both locks held
+    struct __SharedTimerQueue* pQueue;
+    UINT64 expirationTick;
+    UINT64 period;
+    UINT64 customData;
+    TimerCallbackFunc timerCallbackFn;
+    UINT32 timerId;
+    // Bumped every time the entry is cancelled so that a stale expiration can be told apart from a re-added timer
+    UINT32 generation;
+    BOOL active;
+};
+typedef struct __TimerWheelEntry* PTimerWheelEntry;
+
+/**
+ * One hierarchical timing wheel serviced by its own thread. Insert and cancel are O(1).
+ */
+typedef struct __TimerWheel TimerWheel;
+struct __TimerWheel {
+    MUTEX lock;
+    CVAR wakeCvar;
+    TID serviceRoutine;
+    BOOL terminate;
+
+    // Time of tick 0
+    UINT64 baseTime;
+    // Next tick to be processed. Everything before it has been dispatched
+    UINT64 nextTick;
+    // Tick the service thread is sleeping until, used to decide whether a new timer needs to wake it up
+    UINT64 wakeTick;
+    UINT32 entryCount;
+
+    PTimerWheelEntry slots[TIMER_WHEEL_LEVEL_COUNT][TIMER_WHEEL_SLOT_COUNT];
+    UINT64 firstLevelBitmap[TIMER_WHEEL_BITMAP_WORD_COUNT];
+};
+typedef struct __TimerWheel* PTimerWheel;
+
+/**
+ * Timer queue view on a shared wheel. Mirrors the semantics of a PIC timer queue: timers of a queue are invoked one at a
+ * time with the queue lock held, so cancelling a timer waits for its running callback to complete.
+ */
+typedef struct __SharedTimerQueue SharedTimerQueue;
+struct __SharedTimerQueue {
+    // Recursive so that callbacks can add, update and cancel timers of their own queue
+    MUTEX lock;
+    BOOL shutdown;
+    PTimerWheel pWheel;
+    UINT32 wheelIndex;
+    // Number of expirations popped from the wheel that have not been dispatched yet, protected by the wheel lock
+    UINT32 pendingDispatchCount;
+    // Signalled with the wheel lock held when pendingDispatchCount drops to 0
+    CVAR dispatchDoneCvar;
+
+    UINT32 maxTimerCount;
+    UINT32 freeTimerCount;
+    PUINT32 freeTimerIds;
+    PTimerWheelEntry pEntries;
+};
+typedef struct __SharedTimerQueue* PSharedTimerQueue;
+
+/**
+ * Process wide set of timer wheels. PeerConnections get their timer queue from here instead of running a timer thread each
+ */
+typedef struct {
+    MUTEX lock;
+    BOOL isInitialized;
+    // Number of wheels, fixed once the wheels are started. 0 until first use
+    UINT32 wheelCount;
+    PTimerWheel wheels[TIMER_WHEEL_MAX_THREADS];
+    // Number of shared timer queues currently attached to each wheel
+    UINT32 wheelUsers[TIMER_WHEEL_MAX_THREADS];
+} TimerWheelService, *PTimerWheelService;
+
+/**
+ * Get the process wide timer wheel service
+ *
+ * @return - PTimerWheelService - the singleton
+ */
+PTimerWheelService getTimerWheelServiceInstance();
+
+/**
+ * Make the timer wheel service available. Called by initKvsWebRtc. No threads are created until a queue is created.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createTimerWheelService();
+
+/**
+ * Stop and free all the wheels. Called by deinitKvsWebRtc once all the PeerConnections have been freed.
+ *
+ * @return - STATUS status of execution
+ */
+STATUS freeTimerWheelService();
+
+/**
+ * Create a timer queue on the least loaded shared wheel. Falls back to timerQueueCreate when the service is disabled
+ * through WEBRTC_TIMER_WHEEL_THREADS_ENV_VAR or was not created.
+ *
+ * @param - PTIMER_QUEUE_HANDLE - OUT - new timer queue handle
+ *
+ * @return - STATUS status of execution
+ */
+STATUS sharedTimerQueueCreate(PTIMER_QUEUE_HANDLE);
+
+/**
+ * The functions below take handles returned either by sharedTimerQueueCreate or by timerQueueCreate and have the same
+ * semantics as their timerQueue* counterparts.
+ */
+STATUS sharedTimerQueueAddTimer(TIMER_QUEUE_HANDLE, UINT64, UINT64, TimerCallbackFunc, UINT64, PUINT32);
+STATUS sharedTimerQueueCancelTimer(TIMER_QUEUE_HANDLE, UINT32, UINT64);
+STATUS sharedTimerQueueUpdateTimerPeriod(TIMER_QUEUE_HANDLE, UINT64, UINT32, UINT64);
+STATUS sharedTimerQueueShutdown(TIMER_QUEUE_HANDLE);
+STATUS sharedTimerQueueFree(PTIMER_QUEUE_HANDLE);
+
+////////////////////////////////////////////
+// internal functionalities
+////////////////////////////////////////////
+UINT32 timerWheelServiceGetThreadCount();
+STATUS createTimerWheel(PTimerWheel*);
+STATUS freeTimerWheel(PTimerWheel*);
+PVOID timerWheelServiceRoutine(PVOID);
+UINT64 timerWheelTimeToTick(PTimerWheel, UINT64);
+VOID timerWheelInsertLocked(PTimerWheel, PTimerWheelEntry);
+VOID timerWheelRemoveLocked(PTimerWheel, PTimerWheelEntry);
+VOID timerWheelCascadeLocked(PTimerWheel, UINT32, UINT32);
+VOID timerWheelProcessTickLocked(PTimerWheel);
+UINT64 timerWheelNextEventTickLocked(PTimerWheel);
+VOID sharedTimerQueueDispatch(PTimerWheelEntry, UINT32);
+VOID sharedTimerQueueReleaseEntryLocked(PSharedTimerQueue, PTimerWheelEntry);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_TIMER_WHEEL__ */
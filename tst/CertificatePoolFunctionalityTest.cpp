@@ -0,0 +1,145 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define TEST_CERTIFICATE_POOL_SIZE 2
+
+class CertificatePoolFunctionalityTest : public WebRtcClientTestBase {
+  public:
+    // The pool is disabled by default
+    VOID enableCertificatePool()
+    {
+        EXPECT_EQ(STATUS_SUCCESS, freeCertificatePool());
+        setenv(WEBRTC_CERTIFICATE_POOL_SIZE_ENV_VAR, "2", 1);
+        EXPECT_EQ(STATUS_SUCCESS, createCertificatePool());
+        unsetenv(WEBRTC_CERTIFICATE_POOL_SIZE_ENV_VAR);
+        EXPECT_EQ(TEST_CERTIFICATE_POOL_SIZE, getCertificatePoolInstance()->poolSize);
+    }
+
+    // The pool is filled in the background right after it is created
+    STATUS waitForPooledCertificate(PPooledCertificate* ppPooledCertificate)
+    {
+        STATUS retStatus = STATUS_NOT_FOUND;
+        UINT64 timeout = GETTIME() + 10 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+
+        while (STATUS_FAILED(retStatus = certificatePoolAcquire(ppPooledCertificate)) && GETTIME() < timeout) {
+            THREAD_SLEEP(20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+
+        return retStatus;
+    }
+};
+
+TEST_F(CertificatePoolFunctionalityTest, acquireAndReleaseTrackReferences)
+{
+    PPooledCertificate pFirst = NULL, pSecond = NULL;
+
+    EXPECT_EQ(STATUS_NULL_ARG, certificatePoolAcquire(NULL));
+    EXPECT_EQ(STATUS_NULL_ARG, certificatePoolRelease(NULL));
+    EXPECT_EQ(STATUS_SUCCESS, certificatePoolRelease(&pFirst));
+
+    enableCertificatePool();
+    ASSERT_EQ(STATUS_SUCCESS, waitForPooledCertificate(&pFirst));
+    ASSERT_TRUE(pFirst != NULL);
+    // The pool holds a reference as well
+    EXPECT_EQ(2, pFirst->refCount);
+    EXPECT_NE(0, STRLEN(pFirst->fingerprint));
+
+    EXPECT_EQ(STATUS_SUCCESS, certificatePoolAcquire(&pSecond));
+    ASSERT_TRUE(pSecond != NULL);
+
+    EXPECT_EQ(STATUS_SUCCESS, certificatePoolRelease(&pSecond));
+    EXPECT_TRUE(pSecond == NULL);
+
+    // Outlives the pool until the last reference is released
+    EXPECT_EQ(STATUS_SUCCESS, freeCertificatePool());
+    EXPECT_EQ(1, pFirst->refCount);
+    EXPECT_EQ(STATUS_NOT_FOUND, certificatePoolAcquire(&pSecond));
+    EXPECT_EQ(STATUS_SUCCESS, certificatePoolRelease(&pFirst));
+    EXPECT_TRUE(pFirst == NULL);
+}
+
+TEST_F(CertificatePoolFunctionalityTest, sessionsWithoutCertificatesUsePooledCertificates)
+{
+    PPooledCertificate pPooledCertificates[TEST_CERTIFICATE_POOL_SIZE];
+    PDtlsSession pDtlsSession = NULL;
+    DtlsSessionCallbacks callbacks;
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    CHAR fingerprint[CERTIFICATE_FINGERPRINT_LENGTH + 1];
+    PCertificatePool pCertificatePool = getCertificatePoolInstance();
+    UINT64 timeout = GETTIME() + 10 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    UINT32 i;
+    BOOL found = FALSE;
+
+    MEMSET(&callbacks, 0x00, SIZEOF(callbacks));
+    MEMSET(pPooledCertificates, 0x00, SIZEOF(pPooledCertificates));
+    ASSERT_EQ(STATUS_SUCCESS, timerQueueCreate(&timerQueueHandle));
+    enableCertificatePool();
+
+    // Wait for the whole pool so that the session can only be given one of these
+    for (i = 0; i < TEST_CERTIFICATE_POOL_SIZE; i++) {
+        while (pPooledCertificates[i] == NULL && GETTIME() < timeout) {
+            THREAD_SLEEP(20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+            MUTEX_LOCK(pCertificatePool->lock);
+            pPooledCertificates[i] = pCertificatePool->certificates[i];
+            MUTEX_UNLOCK(pCertificatePool->lock);
+        }
+        ASSERT_TRUE(pPooledCertificates[i] != NULL);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, timerQueueHandle, 0, FALSE, NULL, &pDtlsSession));
+    ASSERT_TRUE(pDtlsSession != NULL);
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionGetLocalCertificateFingerprint(pDtlsSession, fingerprint, SIZEOF(fingerprint)));
+    for (i = 0; i < TEST_CERTIFICATE_POOL_SIZE; i++) {
+        found = found || STRCMP(fingerprint, pPooledCertificates[i]->fingerprint) == 0;
+    }
+    EXPECT_TRUE(found);
+    EXPECT_EQ(STATUS_SUCCESS, freeDtlsSession(&pDtlsSession));
+
+    // RSA certificates are never pooled
+    EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, timerQueueHandle, 0, TRUE, NULL, &pDtlsSession));
+    ASSERT_TRUE(pDtlsSession != NULL);
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionGetLocalCertificateFingerprint(pDtlsSession, fingerprint, SIZEOF(fingerprint)));
+    for (i = 0; i < TEST_CERTIFICATE_POOL_SIZE; i++) {
+        EXPECT_NE(0, STRCMP(fingerprint, pPooledCertificates[i]->fingerprint));
+    }
+    EXPECT_EQ(STATUS_SUCCESS, freeDtlsSession(&pDtlsSession));
+
+    timerQueueFree(&timerQueueHandle);
+}
+
+TEST_F(CertificatePoolFunctionalityTest, disabledPoolLetsSessionsGenerateCertificates)
+{
+    PPooledCertificate pPooledCertificate = NULL;
+    PDtlsSession pDtlsSession = NULL;
+    DtlsSessionCallbacks callbacks;
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    CHAR fingerprint[CERTIFICATE_FINGERPRINT_LENGTH + 1];
+
+    MEMSET(&callbacks, 0x00, SIZEOF(callbacks));
+    ASSERT_EQ(STATUS_SUCCESS, timerQueueCreate(&timerQueueHandle));
+
+    // Disabled unless asked for
+    EXPECT_EQ(0, getCertificatePoolInstance()->poolSize);
+    EXPECT_FALSE(IS_VALID_TIMER_QUEUE_HANDLE(getCertificatePoolInstance()->timerQueueHandle));
+    THREAD_SLEEP(CERTIFICATE_POOL_REFILL_INTERVAL);
+    EXPECT_EQ(STATUS_NOT_FOUND, certificatePoolAcquire(&pPooledCertificate));
+
+    EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, timerQueueHandle, 0, FALSE, NULL, &pDtlsSession));
+    ASSERT_TRUE(pDtlsSession != NULL);
+    EXPECT_TRUE(pDtlsSession->certificateCount == 1);
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionGetLocalCertificateFingerprint(pDtlsSession, fingerprint, SIZEOF(fingerprint)));
+    EXPECT_EQ(STATUS_SUCCESS, freeDtlsSession(&pDtlsSession));
+
+    timerQueueFree(&timerQueueHandle);
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,151 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define CONGESTION_CONTROLLER_TEST_PACKET_SIZE       1200
+#define CONGESTION_CONTROLLER_TEST_FEEDBACK_INTERVAL (100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define CONGESTION_CONTROLLER_TEST_START_TIME        HUNDREDS_OF_NANOS_IN_A_SECOND
+
+class CongestionControllerFunctionalityTest : public WebRtcClientTestBase {
+  public:
+    UINT64 currentTime;
+    UINT64 nextSendTime;
+    // Time the bottleneck link is done with the last packet it was given
+    UINT64 linkBusyUntil;
+
+    VOID SetUp()
+    {
+        WebRtcClientTestBase::SetUp();
+        currentTime = CONGESTION_CONTROLLER_TEST_START_TIME;
+        nextSendTime = CONGESTION_CONTROLLER_TEST_START_TIME;
+        linkBusyUntil = 0;
+    }
+
+    /**
+     * Send at the target bitrate through a bottleneck of the given capacity with an unbounded queue, every lossPeriod-th packet
+     * is lost when lossPeriod is not 0. Feedback covering the previous interval comes back every
+     * CONGESTION_CONTROLLER_TEST_FEEDBACK_INTERVAL. Returns the average target bitrate over the run.
+     */
+    UINT64 simulate(PCongestionController pCongestionController, UINT64 capacity, UINT64 duration, UINT32 lossPeriod)
+    {
+        std::vector<PacketFeedback> feedback;
+        PacketFeedback packet;
+        UINT64 endTime = currentTime + duration, targetBitrate = 0, targetBitrateSum = 0, feedbackCount = 0;
+        UINT32 packetIndex = 0;
+
+        while (currentTime < endTime) {
+            currentTime += CONGESTION_CONTROLLER_TEST_FEEDBACK_INTERVAL;
+            feedback.clear();
+
+            for (; nextSendTime < currentTime;
+                 nextSendTime += CONGESTION_CONTROLLER_TEST_PACKET_SIZE * 8 * HUNDREDS_OF_NANOS_IN_A_SECOND / pCongestionController->targetBitrate) {
+                packet.sendTime = nextSendTime;
+                packet.packetSize = CONGESTION_CONTROLLER_TEST_PACKET_SIZE;
+                if (lossPeriod != 0 && ++packetIndex % lossPeriod == 0) {
+                    packet.arrivalTime = TWCC_PACKET_LOST_TIME;
+                } else {
+                    linkBusyUntil =
+                        MAX(linkBusyUntil, nextSendTime) + CONGESTION_CONTROLLER_TEST_PACKET_SIZE * 8 * HUNDREDS_OF_NANOS_IN_A_SECOND / capacity;
+                    packet.arrivalTime = linkBusyUntil;
+                }
+                feedback.push_back(packet);
+            }
+
+            EXPECT_EQ(STATUS_SUCCESS,
+                      congestionControllerOnPacketFeedback(pCongestionController, feedback.data(), (UINT32) feedback.size(), currentTime,
+                                                           &targetBitrate));
+            EXPECT_EQ(targetBitrate, pCongestionController->targetBitrate);
+            targetBitrateSum += targetBitrate;
+            feedbackCount++;
+        }
+
+        return targetBitrateSum / feedbackCount;
+    }
+};
+
+TEST_F(CongestionControllerFunctionalityTest, createAndFree)
+{
+    PCongestionController pCongestionController = NULL;
+
+    EXPECT_NE(STATUS_SUCCESS, createCongestionController(0, NULL));
+    EXPECT_EQ(STATUS_SUCCESS, createCongestionController(0, &pCongestionController));
+    EXPECT_EQ(CONGESTION_CONTROL_DEFAULT_START_BITRATE, pCongestionController->targetBitrate);
+    EXPECT_NE(STATUS_SUCCESS, congestionControllerOnPacketFeedback(NULL, NULL, 0, 0, NULL));
+    EXPECT_NE(STATUS_SUCCESS, congestionControllerOnPacketFeedback(pCongestionController, NULL, 1, 0, NULL));
+    EXPECT_EQ(STATUS_SUCCESS, congestionControllerOnPacketFeedback(pCongestionController, NULL, 0, CONGESTION_CONTROLLER_TEST_START_TIME, NULL));
+    EXPECT_EQ(STATUS_SUCCESS, freeCongestionController(&pCongestionController));
+    EXPECT_TRUE(pCongestionController == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, freeCongestionController(&pCongestionController));
+    EXPECT_NE(STATUS_SUCCESS, freeCongestionController(NULL));
+
+    // Start bitrate is kept within the bounds
+    EXPECT_EQ(STATUS_SUCCESS, createCongestionController(1, &pCongestionController));
+    EXPECT_EQ(CONGESTION_CONTROL_MIN_BITRATE, pCongestionController->targetBitrate);
+    EXPECT_EQ(STATUS_SUCCESS, freeCongestionController(&pCongestionController));
+}
+
+TEST_F(CongestionControllerFunctionalityTest, rampsUpOnAnUncongestedLink)
+{
+    PCongestionController pCongestionController = NULL;
+
+    EXPECT_EQ(STATUS_SUCCESS, createCongestionController(300 * 1024, &pCongestionController));
+    simulate(pCongestionController, 20 * 1024 * 1024, 10 * HUNDREDS_OF_NANOS_IN_A_SECOND, 0);
+
+    // Roughly 8% a second compounded
+    EXPECT_GT(pCongestionController->targetBitrate, 500 * 1024);
+    EXPECT_EQ(CONGESTION_CONTROL_USAGE_NORMAL, pCongestionController->usage);
+    EXPECT_EQ(STATUS_SUCCESS, freeCongestionController(&pCongestionController));
+}
+
+TEST_F(CongestionControllerFunctionalityTest, convergesToTheBottleneckAndFollowsItDown)
+{
+    PCongestionController pCongestionController = NULL;
+    UINT64 capacity = 1024 * 1024, averageBitrate;
+
+    EXPECT_EQ(STATUS_SUCCESS, createCongestionController(600 * 1024, &pCongestionController));
+
+    // Ramp up and oscillate around the capacity
+    simulate(pCongestionController, capacity, 30 * HUNDREDS_OF_NANOS_IN_A_SECOND, 0);
+    averageBitrate = simulate(pCongestionController, capacity, 20 * HUNDREDS_OF_NANOS_IN_A_SECOND, 0);
+    EXPECT_GT(averageBitrate, capacity * 6 / 10);
+    EXPECT_LT(averageBitrate, capacity * 12 / 10);
+
+    // Halve the capacity, the queue build up is detected and the target drops below the new capacity
+    capacity /= 2;
+    simulate(pCongestionController, capacity, 5 * HUNDREDS_OF_NANOS_IN_A_SECOND, 0);
+    averageBitrate = simulate(pCongestionController, capacity, 20 * HUNDREDS_OF_NANOS_IN_A_SECOND, 0);
+    EXPECT_GT(averageBitrate, capacity * 6 / 10);
+    EXPECT_LT(averageBitrate, capacity * 12 / 10);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeCongestionController(&pCongestionController));
+}
+
+TEST_F(CongestionControllerFunctionalityTest, heavyLossLowersTheTarget)
+{
+    PCongestionController pCongestionController = NULL;
+    UINT64 startBitrate = 2 * 1024 * 1024;
+
+    EXPECT_EQ(STATUS_SUCCESS, createCongestionController(startBitrate, &pCongestionController));
+
+    // One packet in five lost on a link that is otherwise big enough
+    simulate(pCongestionController, 20 * 1024 * 1024, 2 * HUNDREDS_OF_NANOS_IN_A_SECOND, 5);
+    EXPECT_LT(pCongestionController->lossBasedBitrate, startBitrate / 2);
+    EXPECT_LT(pCongestionController->targetBitrate, startBitrate / 2);
+
+    // Loss below 2% lets it grow again
+    startBitrate = pCongestionController->targetBitrate;
+    simulate(pCongestionController, 20 * 1024 * 1024, 2 * HUNDREDS_OF_NANOS_IN_A_SECOND, 100);
+    EXPECT_GT(pCongestionController->lossBasedBitrate, startBitrate);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeCongestionController(&pCongestionController));
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -248,6 +248,56 @@ TEST_F(DtlsFunctionalityTest, processPacketWithVariedSizesInThread)
     MEMFREE(pData);
 }
 
+TEST_F(DtlsFunctionalityTest, populateKeyingMaterialPrefersAeadProfiles)
+{
+    PDtlsSession pClient = NULL, pServer = NULL;
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    DtlsKeyingMaterial clientKeyingMaterial, serverKeyingMaterial;
+    PSrtpSession pClientSrtpSession = NULL, pServerSrtpSession = NULL;
+    BYTE packet[64 + SRTP_MAX_TRAILER_LEN];
+    INT32 len;
+
+    EXPECT_EQ(STATUS_SUCCESS, timerQueueCreate(&timerQueueHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createAndConnect(timerQueueHandle, &pClient, &pServer, FALSE));
+
+    MEMSET(&clientKeyingMaterial, 0x00, SIZEOF(DtlsKeyingMaterial));
+    MEMSET(&serverKeyingMaterial, 0x00, SIZEOF(DtlsKeyingMaterial));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionPopulateKeyingMaterial(pClient, &clientKeyingMaterial));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionPopulateKeyingMaterial(pServer, &serverKeyingMaterial));
+
+#if defined(KVS_USE_OPENSSL) && defined(HAVE_SRTP_AES_GCM)
+    EXPECT_EQ(KVS_SRTP_PROFILE_AEAD_AES_128_GCM, clientKeyingMaterial.srtpProfile);
+    EXPECT_EQ(SRTP_AES_128_KEY_LEN + SRTP_AES_GCM_SALT_KEY_LEN, clientKeyingMaterial.key_length);
+#else
+    EXPECT_EQ(KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, clientKeyingMaterial.srtpProfile);
+    EXPECT_EQ(SRTP_AES_128_KEY_LEN + SRTP_AES_CM_SALT_KEY_LEN, clientKeyingMaterial.key_length);
+#endif
+    EXPECT_EQ(clientKeyingMaterial.srtpProfile, serverKeyingMaterial.srtpProfile);
+    EXPECT_EQ(clientKeyingMaterial.key_length, serverKeyingMaterial.key_length);
+    EXPECT_EQ(0, MEMCMP(clientKeyingMaterial.clientWriteKey, serverKeyingMaterial.clientWriteKey, clientKeyingMaterial.key_length));
+    EXPECT_EQ(0, MEMCMP(clientKeyingMaterial.serverWriteKey, serverKeyingMaterial.serverWriteKey, clientKeyingMaterial.key_length));
+
+    // What one side protects the other unprotects, as in allocateSrtp
+    EXPECT_EQ(STATUS_SUCCESS,
+              initSrtpSession(clientKeyingMaterial.serverWriteKey, clientKeyingMaterial.clientWriteKey, clientKeyingMaterial.srtpProfile,
+                              &pClientSrtpSession));
+    EXPECT_EQ(STATUS_SUCCESS,
+              initSrtpSession(serverKeyingMaterial.clientWriteKey, serverKeyingMaterial.serverWriteKey, serverKeyingMaterial.srtpProfile,
+                              &pServerSrtpSession));
+    MEMSET(packet, 0x11, SIZEOF(packet));
+    packet[0] = 0x80;
+    packet[1] = 96;
+    len = 64;
+    EXPECT_EQ(STATUS_SUCCESS, encryptRtpPacket(pClientSrtpSession, packet, &len));
+    EXPECT_EQ(STATUS_SUCCESS, decryptSrtpPacket(pServerSrtpSession, packet, &len));
+    EXPECT_EQ(64, len);
+
+    freeSrtpSession(&pClientSrtpSession);
+    freeSrtpSession(&pServerSrtpSession);
+    freeDtlsSession(&pClient);
+    freeDtlsSession(&pServer);
+    timerQueueFree(&timerQueueHandle);
+}
 
 } // namespace webrtcclient
 } // namespace video
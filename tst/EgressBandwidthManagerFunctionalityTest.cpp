@@ -0,0 +1,279 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define EGRESS_TEST_SIMULATED_PEERS  50
+#define EGRESS_TEST_SIMULATED_ROUNDS 200
+
+typedef struct {
+    UINT64 lastBitrate;
+    UINT32 callCount;
+} EgressBandwidthTestTarget, *PEgressBandwidthTestTarget;
+
+VOID egressBandwidthTestOnTarget(UINT64 customData, UINT64 bitrate)
+{
+    PEgressBandwidthTestTarget pTarget = (PEgressBandwidthTestTarget) customData;
+
+    pTarget->lastBitrate = bitrate;
+    pTarget->callCount++;
+}
+
+class EgressBandwidthManagerFunctionalityTest : public WebRtcClientTestBase {
+  protected:
+    EgressBandwidthManager manager;
+
+    VOID SetUp()
+    {
+        WebRtcClientTestBase::SetUp();
+        MEMSET(&manager, 0x00, SIZEOF(manager));
+        manager.lock = INVALID_MUTEX_VALUE;
+    }
+
+    VOID TearDown()
+    {
+        deinitEgressBandwidthManager(&manager);
+        WebRtcClientTestBase::TearDown();
+    }
+
+    VOID addPeers(PEgressBandwidthPeer pPeers, PEgressBandwidthFlow pFlows, PEgressBandwidthTestTarget pTargets, UINT32 count, UINT64 estimate)
+    {
+        UINT32 i;
+
+        MEMSET(pPeers, 0x00, count * SIZEOF(EgressBandwidthPeer));
+        MEMSET(pFlows, 0x00, count * SIZEOF(EgressBandwidthFlow));
+        MEMSET(pTargets, 0x00, count * SIZEOF(EgressBandwidthTestTarget));
+        for (i = 0; i < count; i++) {
+            EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerAddPeer(&manager, &pPeers[i], NULL, 0));
+            EXPECT_EQ(STATUS_SUCCESS, egressBandwidthFlowSetCallback(&pFlows[i], (UINT64) &pTargets[i], egressBandwidthTestOnTarget));
+            EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerAddFlow(&pPeers[i], &pFlows[i], EGRESS_BANDWIDTH_DEFAULT_WEIGHT, 0));
+            EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerOnEstimate(&pPeers[i], estimate));
+        }
+    }
+};
+
+TEST_F(EgressBandwidthManagerFunctionalityTest, capIsSplitEvenly)
+{
+    EgressBandwidthPeer peers[3];
+    EgressBandwidthFlow flows[3];
+    EgressBandwidthTestTarget targets[3];
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, initEgressBandwidthManager(&manager, 3000000));
+    addPeers(peers, flows, targets, 3, 5000000);
+
+    for (i = 0; i < 3; i++) {
+        EXPECT_EQ(1000000, flows[i].allocatedBitrate);
+        EXPECT_EQ(1000000, targets[i].lastBitrate);
+        EXPECT_EQ(1000000, peers[i].allocatedBitrate);
+    }
+
+    for (i = 0; i < 3; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerRemovePeer(&peers[i]));
+    }
+}
+
+TEST_F(EgressBandwidthManagerFunctionalityTest, slowPeerLeavesTheRestToTheOthers)
+{
+    EgressBandwidthPeer peers[3];
+    EgressBandwidthFlow flows[3];
+    EgressBandwidthTestTarget targets[3];
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, initEgressBandwidthManager(&manager, 3000000));
+    addPeers(peers, flows, targets, 3, 5000000);
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerOnEstimate(&peers[0], 500000));
+
+    EXPECT_EQ(500000, flows[0].allocatedBitrate);
+    EXPECT_EQ(1250000, flows[1].allocatedBitrate);
+    EXPECT_EQ(1250000, flows[2].allocatedBitrate);
+
+    // A greedy peer can not take more than the others
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerOnEstimate(&peers[1], 100000000));
+    EXPECT_EQ(1250000, flows[1].allocatedBitrate);
+    EXPECT_EQ(1250000, flows[2].allocatedBitrate);
+
+    for (i = 0; i < 3; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerRemovePeer(&peers[i]));
+    }
+}
+
+TEST_F(EgressBandwidthManagerFunctionalityTest, weightsAndMaximumsSplitThePeerEstimate)
+{
+    EgressBandwidthPeer peer;
+    EgressBandwidthFlow audio, video, screen;
+    EgressBandwidthTestTarget peerTarget, videoTarget;
+
+    MEMSET(&peer, 0x00, SIZEOF(peer));
+    MEMSET(&audio, 0x00, SIZEOF(audio));
+    MEMSET(&video, 0x00, SIZEOF(video));
+    MEMSET(&screen, 0x00, SIZEOF(screen));
+    MEMSET(&peerTarget, 0x00, SIZEOF(peerTarget));
+    MEMSET(&videoTarget, 0x00, SIZEOF(videoTarget));
+
+    EXPECT_EQ(STATUS_SUCCESS, initEgressBandwidthManager(&manager, 0));
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerAddPeer(&manager, &peer, egressBandwidthTestOnTarget, (UINT64) &peerTarget));
+    EXPECT_EQ(STATUS_INVALID_ARG, egressBandwidthPeerAddFlow(&peer, &audio, 0, 0));
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerAddFlow(&peer, &audio, EGRESS_BANDWIDTH_DEFAULT_WEIGHT, 128000));
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerAddFlow(&peer, &video, 2, 0));
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerAddFlow(&peer, &screen, EGRESS_BANDWIDTH_DEFAULT_WEIGHT, 0));
+    EXPECT_EQ(STATUS_INVALID_OPERATION, egressBandwidthPeerAddFlow(&peer, &screen, EGRESS_BANDWIDTH_DEFAULT_WEIGHT, 0));
+
+    // Nothing bounds the flows until the first estimate
+    EXPECT_EQ(0, video.allocatedBitrate);
+    EXPECT_EQ(0, peerTarget.callCount);
+
+    // Audio only takes its maximum, the rest is split 2:1
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerOnEstimate(&peer, 3128000));
+    EXPECT_EQ(128000, audio.allocatedBitrate);
+    EXPECT_EQ(2000000, video.allocatedBitrate);
+    EXPECT_EQ(1000000, screen.allocatedBitrate);
+    EXPECT_EQ(3128000, peerTarget.lastBitrate);
+
+    // A late callback is given the current target right away
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthFlowSetCallback(&video, (UINT64) &videoTarget, egressBandwidthTestOnTarget));
+    EXPECT_EQ(1, videoTarget.callCount);
+    EXPECT_EQ(2000000, videoTarget.lastBitrate);
+
+    // Small moves are not worth reconfiguring the encoder
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerOnEstimate(&peer, 3158000));
+    EXPECT_EQ(2020000, video.allocatedBitrate);
+    EXPECT_EQ(1, videoTarget.callCount);
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerOnEstimate(&peer, 1628000));
+    EXPECT_EQ(2, videoTarget.callCount);
+    EXPECT_EQ(1000000, videoTarget.lastBitrate);
+
+    // Removing a flow gives its share back, removing it again does nothing
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthFlowRemove(&screen));
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthFlowRemove(&screen));
+    EXPECT_EQ(1500000, video.allocatedBitrate);
+
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthFlowSetShare(&video, 1, 600000));
+    EXPECT_EQ(600000, video.allocatedBitrate);
+    EXPECT_EQ(728000, peerTarget.lastBitrate);
+
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerRemovePeer(&peer));
+    EXPECT_TRUE(audio.pPeer == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthFlowRemove(&audio));
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerRemovePeer(&peer));
+}
+
+TEST_F(EgressBandwidthManagerFunctionalityTest, removedPeerBandwidthIsRedistributed)
+{
+    EgressBandwidthPeer peers[4];
+    EgressBandwidthFlow flows[4];
+    EgressBandwidthTestTarget targets[4];
+    UINT32 i, callCount;
+
+    EXPECT_EQ(STATUS_SUCCESS, initEgressBandwidthManager(&manager, 4000000));
+    addPeers(peers, flows, targets, 4, 10000000);
+    EXPECT_EQ(1000000, flows[3].allocatedBitrate);
+
+    callCount = targets[0].callCount;
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerRemovePeer(&peers[0]));
+    EXPECT_EQ(callCount, targets[0].callCount);
+    for (i = 1; i < 4; i++) {
+        EXPECT_EQ(1333333, flows[i].allocatedBitrate);
+        EXPECT_EQ(1333333, targets[i].lastBitrate);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerSetCap(&manager, 0));
+    for (i = 1; i < 4; i++) {
+        EXPECT_EQ(10000000, flows[i].allocatedBitrate);
+        EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerRemovePeer(&peers[i]));
+    }
+}
+
+TEST_F(EgressBandwidthManagerFunctionalityTest, simulatedFeedbackFromManyPeersStaysFair)
+{
+    EgressBandwidthPeer peers[EGRESS_TEST_SIMULATED_PEERS];
+    EgressBandwidthFlow audioFlows[EGRESS_TEST_SIMULATED_PEERS], videoFlows[EGRESS_TEST_SIMULATED_PEERS];
+    EgressBandwidthTestTarget targets[EGRESS_TEST_SIMULATED_PEERS];
+    PEgressBandwidthFlow pFlows[2 * EGRESS_TEST_SIMULATED_PEERS];
+    BOOL heldBack[2 * EGRESS_TEST_SIMULATED_PEERS];
+    UINT32 seed = 12345, round, i, j, flowCount = 2 * EGRESS_TEST_SIMULATED_PEERS;
+    UINT64 capBitrate = 20000000, total, peerTotal, delta;
+    DOUBLE bottleneckShare;
+
+    MEMSET(peers, 0x00, SIZEOF(peers));
+    MEMSET(audioFlows, 0x00, SIZEOF(audioFlows));
+    MEMSET(videoFlows, 0x00, SIZEOF(videoFlows));
+    MEMSET(targets, 0x00, SIZEOF(targets));
+
+    EXPECT_EQ(STATUS_SUCCESS, initEgressBandwidthManager(&manager, capBitrate));
+    for (i = 0; i < EGRESS_TEST_SIMULATED_PEERS; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerAddPeer(&manager, &peers[i], NULL, 0));
+        EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerAddFlow(&peers[i], &audioFlows[i], EGRESS_BANDWIDTH_DEFAULT_WEIGHT, 128000));
+        EXPECT_EQ(STATUS_SUCCESS, egressBandwidthFlowSetCallback(&videoFlows[i], (UINT64) &targets[i], egressBandwidthTestOnTarget));
+        EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerAddFlow(&peers[i], &videoFlows[i], 1 + i % 3, 0));
+        pFlows[2 * i] = &audioFlows[i];
+        pFlows[2 * i + 1] = &videoFlows[i];
+    }
+
+    for (round = 0; round < EGRESS_TEST_SIMULATED_ROUNDS; round++) {
+        // Every round a few peers report a new estimate, between 100 Kbps and 3 Mbps
+        for (j = 0; j < 10; j++) {
+            seed = seed * 1103515245 + 12345;
+            i = (seed >> 16) % EGRESS_TEST_SIMULATED_PEERS;
+            seed = seed * 1103515245 + 12345;
+            EXPECT_EQ(STATUS_SUCCESS, egressBandwidthPeerOnEstimate(&peers[i], 100000 + (seed >> 8) % 2900000));
+        }
+        if (round == EGRESS_TEST_SIMULATED_ROUNDS / 2) {
+            capBitrate = 60000000;
+            EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerSetCap(&manager, capBitrate));
+        }
+
+        total = 0;
+        bottleneckShare = 0;
+        for (i = 0; i < EGRESS_TEST_SIMULATED_PEERS; i++) {
+            peerTotal = audioFlows[i].allocatedBitrate + videoFlows[i].allocatedBitrate;
+            total += peerTotal;
+            if (peers[i].estimate != 0) {
+                EXPECT_GE(peers[i].estimate, peerTotal);
+            }
+            EXPECT_GE(128000, audioFlows[i].allocatedBitrate);
+
+            // Video targets are within the notification threshold of the allocation
+            if (videoFlows[i].allocatedBitrate != 0) {
+                delta = targets[i].lastBitrate > videoFlows[i].allocatedBitrate ? targets[i].lastBitrate - videoFlows[i].allocatedBitrate
+                                                                                 : videoFlows[i].allocatedBitrate - targets[i].lastBitrate;
+                EXPECT_GE(targets[i].lastBitrate * EGRESS_BANDWIDTH_NOTIFY_THRESHOLD_PERCENT, delta * 100);
+            }
+        }
+        EXPECT_GE(capBitrate, total);
+
+        // Max-min: the flows held back by the cap all get the largest share per weight, the others get their whole demand,
+        // which the allocation keeps in the limit of the flow. Flows of a peer without estimate have no demand bound
+        for (j = 0; j < flowCount; j++) {
+            heldBack[j] = pFlows[j]->limit < 0 || pFlows[j]->allocation < pFlows[j]->limit - 1;
+            if (heldBack[j]) {
+                bottleneckShare = MAX(bottleneckShare, pFlows[j]->allocation / pFlows[j]->weight);
+            }
+        }
+        for (j = 0; j < flowCount; j++) {
+            if (heldBack[j]) {
+                EXPECT_NEAR(bottleneckShare, pFlows[j]->allocation / pFlows[j]->weight, 1);
+            } else if (bottleneckShare > 0) {
+                EXPECT_GE(bottleneckShare * pFlows[j]->weight + 1, pFlows[j]->allocation);
+            }
+        }
+        if (bottleneckShare > 0) {
+            // Somebody is held back, so nothing of the cap is left unused
+            EXPECT_LE(capBitrate - flowCount, total);
+        }
+    }
+
+    for (i = 0; i < EGRESS_TEST_SIMULATED_PEERS; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, egressBandwidthManagerRemovePeer(&peers[i]));
+    }
+    EXPECT_TRUE(manager.pPeers == NULL);
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,621 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define FEC_TEST_MEDIA_PAYLOAD_TYPE  96
+#define FEC_TEST_RED_PAYLOAD_TYPE    116
+#define FEC_TEST_ULPFEC_PAYLOAD_TYPE 118
+#define FEC_TEST_SSRC                0x12345678
+#define FEC_TEST_TIMESTAMP           90000
+#define FEC_TEST_MAX_PAYLOAD_LENGTH  300
+
+class FecFunctionalityTest : public WebRtcClientTestBase {
+  protected:
+    RtpPacket mediaPackets[FEC_MAX_GROUP_SIZE];
+    BYTE mediaPayloads[FEC_MAX_GROUP_SIZE][FEC_TEST_MAX_PAYLOAD_LENGTH];
+    BYTE mediaBytes[FEC_MAX_GROUP_SIZE][MIN_HEADER_LENGTH + FEC_TEST_MAX_PAYLOAD_LENGTH];
+    RtpPacket fecPackets[FEC_MAX_GROUP_SIZE];
+    UINT32 fecPacketCount;
+
+    VOID SetUp()
+    {
+        WebRtcClientTestBase::SetUp();
+        MEMSET(mediaPackets, 0x00, SIZEOF(mediaPackets));
+        MEMSET(fecPackets, 0x00, SIZEOF(fecPackets));
+        fecPacketCount = 0;
+    }
+
+    // A frame of packetCount packets of different lengths, the marker bit set on the last one
+    VOID buildFrame(UINT16 baseSequenceNumber, UINT32 packetCount)
+    {
+        UINT32 i, j, payloadLength, packetLength;
+
+        for (i = 0; i < packetCount; i++) {
+            payloadLength = 100 + (i * 37) % 150;
+            for (j = 0; j < payloadLength; j++) {
+                mediaPayloads[i][j] = (BYTE) (i * 13 + j);
+            }
+            EXPECT_EQ(STATUS_SUCCESS,
+                      setRtpPacket(2, FALSE, FALSE, 0, i + 1 == packetCount, FEC_TEST_MEDIA_PAYLOAD_TYPE, (UINT16) (baseSequenceNumber + i),
+                                   FEC_TEST_TIMESTAMP, FEC_TEST_SSRC, NULL, 0, 0, NULL, mediaPayloads[i], payloadLength, &mediaPackets[i]));
+            packetLength = SIZEOF(mediaBytes[i]);
+            EXPECT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(&mediaPackets[i], mediaBytes[i], &packetLength));
+            mediaPackets[i].pRawPacket = mediaBytes[i];
+            mediaPackets[i].rawPacketLength = packetLength;
+        }
+    }
+
+    // The FEC packets the encoder produced, with the sequence numbers following the frame
+    VOID collectFecPackets(PFecEncoder pFecEncoder, UINT16 firstSequenceNumber)
+    {
+        UINT32 i;
+
+        fecPacketCount = pFecEncoder->fecPacketCount;
+        for (i = 0; i < fecPacketCount; i++) {
+            EXPECT_EQ(STATUS_SUCCESS,
+                      setRtpPacket(2, FALSE, FALSE, 0, FALSE, FEC_TEST_ULPFEC_PAYLOAD_TYPE, (UINT16) (firstSequenceNumber + i), FEC_TEST_TIMESTAMP,
+                                   FEC_TEST_SSRC, NULL, 0, 0, NULL,
+                                   pFecEncoder->pFecPayloads + i * FEC_ENCODER_PAYLOAD_SLOT_LENGTH + RED_PRIMARY_HEADER_LENGTH,
+                                   pFecEncoder->fecPayloadLengths[i], &fecPackets[i]));
+        }
+    }
+
+    VOID expectRecovered(PFecDecoder pFecDecoder, UINT32 index)
+    {
+        PRtpPacket pRtpPacket = NULL;
+
+        EXPECT_EQ(STATUS_SUCCESS, fecDecoderPopRecoveredPacket(pFecDecoder, &pRtpPacket));
+        ASSERT_TRUE(pRtpPacket != NULL);
+        EXPECT_EQ(mediaPackets[index].header.sequenceNumber, pRtpPacket->header.sequenceNumber);
+        EXPECT_EQ(mediaPackets[index].header.marker, pRtpPacket->header.marker);
+        EXPECT_EQ(mediaPackets[index].rawPacketLength, pRtpPacket->rawPacketLength);
+        EXPECT_EQ(0, MEMCMP(mediaPackets[index].pRawPacket, pRtpPacket->pRawPacket, mediaPackets[index].rawPacketLength));
+        freeRtpPacket(&pRtpPacket);
+    }
+
+    VOID expectNothingRecovered(PFecDecoder pFecDecoder)
+    {
+        PRtpPacket pRtpPacket = NULL;
+
+        EXPECT_EQ(STATUS_SUCCESS, fecDecoderPopRecoveredPacket(pFecDecoder, &pRtpPacket));
+        EXPECT_TRUE(pRtpPacket == NULL);
+    }
+
+    // Wraps the packet in RED and encrypts it the way the remote peer would, then hands it to the receive path
+    VOID receiveInRed(PKvsPeerConnection pKvsPeerConnection, PRtpPacket pRtpPacket)
+    {
+        BYTE packet[MIN_HEADER_LENGTH + RED_PRIMARY_HEADER_LENGTH + FEC_MAX_PAYLOAD_LENGTH + SRTP_AUTH_TAG_OVERHEAD];
+        UINT32 packetLength = SIZEOF(packet);
+        INT32 encryptedLength;
+
+        ASSERT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(pRtpPacket, packet, &packetLength));
+        ASSERT_EQ(STATUS_SUCCESS, redEncapsulateRtpPacket(packet, RTP_HEADER_LEN(pRtpPacket), &packetLength, FEC_TEST_RED_PAYLOAD_TYPE));
+        encryptedLength = (INT32) packetLength;
+        ASSERT_EQ(STATUS_SUCCESS, encryptRtpPacket(pKvsPeerConnection->pSrtpSession, packet, &encryptedLength));
+        EXPECT_EQ(STATUS_SUCCESS, sendPacketToRtpReceiver(pKvsPeerConnection, packet, (UINT32) encryptedLength));
+    }
+};
+
+typedef struct {
+    UINT32 frameCount;
+    UINT32 frameSizes[4];
+} FecTestReceivedFrames, *PFecTestReceivedFrames;
+
+VOID fecTestOnFrame(UINT64 customData, PFrame pFrame)
+{
+    PFecTestReceivedFrames pReceivedFrames = (PFecTestReceivedFrames) customData;
+
+    if (pReceivedFrames->frameCount < ARRAY_SIZE(pReceivedFrames->frameSizes)) {
+        pReceivedFrames->frameSizes[pReceivedFrames->frameCount] = pFrame->size;
+    }
+    pReceivedFrames->frameCount++;
+}
+
+TEST_F(FecFunctionalityTest, encoderCreationChecksLimits)
+{
+    PFecEncoder pFecEncoder = NULL;
+
+    EXPECT_EQ(STATUS_NULL_ARG, createFecEncoder(0, 0, NULL));
+    EXPECT_EQ(STATUS_INVALID_ARG, createFecEncoder(FEC_MAX_GROUP_SIZE + 1, 0, &pFecEncoder));
+    EXPECT_EQ(STATUS_INVALID_ARG, createFecEncoder(0, 101, &pFecEncoder));
+    EXPECT_TRUE(pFecEncoder == NULL);
+
+    EXPECT_EQ(STATUS_SUCCESS, createFecEncoder(0, 0, &pFecEncoder));
+    EXPECT_EQ(FEC_DEFAULT_GROUP_SIZE, pFecEncoder->groupSize);
+    EXPECT_EQ(FEC_DEFAULT_MAX_PROTECTION_PERCENT, pFecEncoder->maxProtectionPercent);
+    EXPECT_EQ(FEC_INITIAL_PROTECTION_PERCENT, pFecEncoder->protectionPercent);
+    EXPECT_EQ(STATUS_SUCCESS, freeFecEncoder(&pFecEncoder));
+    EXPECT_TRUE(pFecEncoder == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, freeFecEncoder(&pFecEncoder));
+}
+
+TEST_F(FecFunctionalityTest, protectionFollowsReportedLoss)
+{
+    PFecEncoder pFecEncoder = NULL;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFecEncoder(0, 0, &pFecEncoder));
+
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderOnLoss(pFecEncoder, 0.0));
+    EXPECT_EQ(0, pFecEncoder->protectionPercent);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderOnLoss(pFecEncoder, 1.0 / 256));
+    EXPECT_EQ(1, pFecEncoder->protectionPercent);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderOnLoss(pFecEncoder, 0.1));
+    EXPECT_EQ(20, pFecEncoder->protectionPercent);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderOnLoss(pFecEncoder, 0.9));
+    EXPECT_EQ(FEC_DEFAULT_MAX_PROTECTION_PERCENT, pFecEncoder->protectionPercent);
+
+    EXPECT_EQ(STATUS_INVALID_ARG, fecEncoderOnLoss(pFecEncoder, 1.5));
+    EXPECT_EQ(STATUS_INVALID_ARG, fecEncoderOnLoss(pFecEncoder, -0.1));
+    EXPECT_EQ(STATUS_NULL_ARG, fecEncoderOnLoss(NULL, 0.1));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFecEncoder(&pFecEncoder));
+}
+
+TEST_F(FecFunctionalityTest, noFecWithoutLoss)
+{
+    PFecEncoder pFecEncoder = NULL;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFecEncoder(0, 0, &pFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderOnLoss(pFecEncoder, 0.0));
+
+    buildFrame(100, 10);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, 10));
+    EXPECT_EQ(0, pFecEncoder->fecPacketCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFecEncoder(&pFecEncoder));
+}
+
+TEST_F(FecFunctionalityTest, smallFramesShareAGroup)
+{
+    PFecEncoder pFecEncoder = NULL;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFecEncoder(0, 0, &pFecEncoder));
+
+    // 2 packets are not enough to close the group at the marker, 2 more are
+    buildFrame(100, 2);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, 2));
+    EXPECT_EQ(0, pFecEncoder->fecPacketCount);
+    EXPECT_EQ(2, pFecEncoder->packetCount);
+
+    buildFrame(102, 2);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, 2));
+    EXPECT_EQ(1, pFecEncoder->fecPacketCount);
+    EXPECT_EQ(0, pFecEncoder->packetCount);
+    // Mask of the 4 packets starting at 100
+    EXPECT_EQ(100, (UINT16) getUnalignedInt16BigEndian(pFecEncoder->pFecPayloads + RED_PRIMARY_HEADER_LENGTH + SEQ_NUMBER_OFFSET));
+    EXPECT_EQ(0xF0, pFecEncoder->pFecPayloads[RED_PRIMARY_HEADER_LENGTH + FEC_HEADER_LENGTH + 2]);
+
+    // A gap in the sequence numbers closes the group too
+    buildFrame(110, 3);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, 2));
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets + 2, 1));
+    EXPECT_EQ(0, pFecEncoder->fecPacketCount);
+    buildFrame(120, 1);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, 1));
+    EXPECT_EQ(1, pFecEncoder->fecPacketCount);
+    EXPECT_EQ(110, (UINT16) getUnalignedInt16BigEndian(pFecEncoder->pFecPayloads + RED_PRIMARY_HEADER_LENGTH + SEQ_NUMBER_OFFSET));
+    EXPECT_EQ(0xE0, pFecEncoder->pFecPayloads[RED_PRIMARY_HEADER_LENGTH + FEC_HEADER_LENGTH + 2]);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFecEncoder(&pFecEncoder));
+}
+
+TEST_F(FecFunctionalityTest, interleavedFecRecoversBurstLoss)
+{
+    PFecEncoder pFecEncoder = NULL;
+    PFecDecoder pFecDecoder = NULL;
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFecEncoder(0, 0, &pFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, createFecDecoder(&pFecDecoder));
+
+    // 50% protection, packet j is protected by FEC packet j % 4
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderOnLoss(pFecEncoder, 0.25));
+    buildFrame(65530, 8);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, 8));
+    EXPECT_EQ(4, pFecEncoder->fecPacketCount);
+    collectFecPackets(pFecEncoder, (UINT16) (65530 + 8));
+
+    // 2 and 3 are lost, across the sequence number wrap
+    for (i = 0; i < 8; i++) {
+        if (i != 2 && i != 3) {
+            EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnMediaPacket(pFecDecoder, &mediaPackets[i]));
+        }
+    }
+    expectNothingRecovered(pFecDecoder);
+
+    for (i = 0; i < fecPacketCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnFecPacket(pFecDecoder, &fecPackets[i]));
+    }
+    expectRecovered(pFecDecoder, 3);
+    expectRecovered(pFecDecoder, 2);
+    expectNothingRecovered(pFecDecoder);
+
+    // The FEC packets protecting nothing that was lost are of no use
+    EXPECT_EQ(2, pFecDecoder->fecPacketsDiscarded);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFecDecoder(&pFecDecoder));
+    EXPECT_EQ(STATUS_SUCCESS, freeFecEncoder(&pFecEncoder));
+}
+
+TEST_F(FecFunctionalityTest, fecPacketWaitsForASingleMissingPacket)
+{
+    PFecEncoder pFecEncoder = NULL;
+    PFecDecoder pFecDecoder = NULL;
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFecEncoder(0, 0, &pFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, createFecDecoder(&pFecDecoder));
+
+    buildFrame(1000, 6);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, 6));
+    EXPECT_EQ(1, pFecEncoder->fecPacketCount);
+    collectFecPackets(pFecEncoder, 1006);
+
+    // 1 and 4 are missing when the FEC packet comes, 4 is only late
+    for (i = 0; i < 6; i++) {
+        if (i != 1 && i != 4) {
+            EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnMediaPacket(pFecDecoder, &mediaPackets[i]));
+        }
+    }
+    EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnFecPacket(pFecDecoder, &fecPackets[0]));
+    expectNothingRecovered(pFecDecoder);
+
+    EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnMediaPacket(pFecDecoder, &mediaPackets[4]));
+    expectRecovered(pFecDecoder, 1);
+    expectNothingRecovered(pFecDecoder);
+    EXPECT_EQ(0, pFecDecoder->fecPacketsDiscarded);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFecDecoder(&pFecDecoder));
+    EXPECT_EQ(STATUS_SUCCESS, freeFecEncoder(&pFecEncoder));
+}
+
+TEST_F(FecFunctionalityTest, longMaskProtectsLargeGroups)
+{
+    PFecEncoder pFecEncoder = NULL;
+    PFecDecoder pFecDecoder = NULL;
+    UINT32 i, protectionLength = 0;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFecEncoder(FEC_MAX_GROUP_SIZE, 0, &pFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, createFecDecoder(&pFecDecoder));
+
+    // 4% of 40 packets, 2 FEC packets over the even and the odd packets
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderOnLoss(pFecEncoder, 0.02));
+    buildFrame(200, 40);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, 40));
+    EXPECT_EQ(2, pFecEncoder->fecPacketCount);
+    collectFecPackets(pFecEncoder, 240);
+    EXPECT_NE(0, fecPackets[0].payload[0] & FEC_LONG_MASK_FLAG);
+    for (i = 0; i < 40; i += 2) {
+        protectionLength = MAX(protectionLength, mediaPackets[i].payloadLength);
+    }
+    EXPECT_EQ(FEC_HEADER_LENGTH + FEC_LEVEL_HEADER_LONG_LENGTH + protectionLength, fecPackets[0].payloadLength);
+
+    for (i = 0; i < 40; i++) {
+        if (i != 37) {
+            EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnMediaPacket(pFecDecoder, &mediaPackets[i]));
+        }
+    }
+    EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnFecPacket(pFecDecoder, &fecPackets[1]));
+    expectRecovered(pFecDecoder, 37);
+    expectNothingRecovered(pFecDecoder);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFecDecoder(&pFecDecoder));
+    EXPECT_EQ(STATUS_SUCCESS, freeFecEncoder(&pFecEncoder));
+}
+
+TEST_F(FecFunctionalityTest, uselessFecPacketsAreDiscarded)
+{
+    PFecEncoder pFecEncoder = NULL;
+    PFecDecoder pFecDecoder = NULL;
+    RtpPacket malformed;
+    BYTE shortPayload[FEC_HEADER_LENGTH] = {0};
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, createFecEncoder(0, 0, &pFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, createFecDecoder(&pFecDecoder));
+
+    buildFrame(300, 4);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, 4));
+    collectFecPackets(pFecEncoder, 304);
+    EXPECT_EQ(1, fecPacketCount);
+
+    // Nothing lost
+    for (i = 0; i < 4; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnMediaPacket(pFecDecoder, &mediaPackets[i]));
+    }
+    EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnFecPacket(pFecDecoder, &fecPackets[0]));
+    expectNothingRecovered(pFecDecoder);
+    EXPECT_EQ(1, pFecDecoder->fecPacketsDiscarded);
+
+    // Too short for a level header
+    MEMSET(&malformed, 0x00, SIZEOF(malformed));
+    EXPECT_EQ(STATUS_SUCCESS,
+              setRtpPacket(2, FALSE, FALSE, 0, FALSE, FEC_TEST_ULPFEC_PAYLOAD_TYPE, 305, FEC_TEST_TIMESTAMP, FEC_TEST_SSRC, NULL, 0, 0, NULL,
+                           shortPayload, SIZEOF(shortPayload), &malformed));
+    EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnFecPacket(pFecDecoder, &malformed));
+    EXPECT_EQ(2, pFecDecoder->fecPacketsDiscarded);
+
+    // Two packets lost, then the window moves past them
+    buildFrame(400, 4);
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, 4));
+    collectFecPackets(pFecEncoder, 404);
+    EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnMediaPacket(pFecDecoder, &mediaPackets[0]));
+    EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnMediaPacket(pFecDecoder, &mediaPackets[1]));
+    EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnFecPacket(pFecDecoder, &fecPackets[0]));
+    EXPECT_EQ(2, pFecDecoder->fecPacketsDiscarded);
+    buildFrame(400 + FEC_DECODER_MEDIA_WINDOW, 1);
+    EXPECT_EQ(STATUS_SUCCESS, fecDecoderOnMediaPacket(pFecDecoder, &mediaPackets[0]));
+    expectNothingRecovered(pFecDecoder);
+    EXPECT_EQ(3, pFecDecoder->fecPacketsDiscarded);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFecDecoder(&pFecDecoder));
+    EXPECT_EQ(STATUS_SUCCESS, freeFecEncoder(&pFecEncoder));
+}
+
+TEST_F(FecFunctionalityTest, redRoundTrip)
+{
+    BYTE packet[MIN_HEADER_LENGTH + FEC_TEST_MAX_PAYLOAD_LENGTH + RED_PRIMARY_HEADER_LENGTH];
+    UINT32 packetLength;
+    UINT8 blockPayloadType = 0;
+
+    buildFrame(500, 1);
+    packetLength = mediaPackets[0].rawPacketLength;
+    MEMCPY(packet, mediaPackets[0].pRawPacket, packetLength);
+
+    EXPECT_EQ(STATUS_SUCCESS, redEncapsulateRtpPacket(packet, MIN_HEADER_LENGTH, &packetLength, FEC_TEST_RED_PAYLOAD_TYPE));
+    EXPECT_EQ(mediaPackets[0].rawPacketLength + RED_PRIMARY_HEADER_LENGTH, packetLength);
+    EXPECT_EQ((MARKER_MASK << MARKER_SHIFT) | FEC_TEST_RED_PAYLOAD_TYPE, packet[1]);
+    EXPECT_EQ(FEC_TEST_MEDIA_PAYLOAD_TYPE, packet[MIN_HEADER_LENGTH]);
+    EXPECT_EQ(0, MEMCMP(packet + MIN_HEADER_LENGTH + RED_PRIMARY_HEADER_LENGTH, mediaPayloads[0], mediaPackets[0].payloadLength));
+
+    EXPECT_EQ(STATUS_SUCCESS, redDecapsulateRtpPacket(packet, &packetLength, &blockPayloadType));
+    EXPECT_EQ(FEC_TEST_MEDIA_PAYLOAD_TYPE, blockPayloadType);
+    EXPECT_EQ(mediaPackets[0].rawPacketLength, packetLength);
+    EXPECT_EQ(0, MEMCMP(packet, mediaPackets[0].pRawPacket, packetLength));
+}
+
+TEST_F(FecFunctionalityTest, redRedundantBlocksAreDropped)
+{
+    // RED packet with a 3 byte redundant block of payload type 96 and a 2 byte primary block of payload type 118
+    BYTE packet[] = {0x80, FEC_TEST_RED_PAYLOAD_TYPE, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x12, 0x34, 0x56, 0x78, 0x80 | FEC_TEST_MEDIA_PAYLOAD_TYPE,
+                     0x00, 0x00, 0x03, FEC_TEST_ULPFEC_PAYLOAD_TYPE, 0xAA, 0xBB, 0xCC, 0x01, 0x02};
+    BYTE expected[] = {0x80, FEC_TEST_ULPFEC_PAYLOAD_TYPE, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x12, 0x34, 0x56, 0x78, 0x01, 0x02};
+    BYTE truncated[] = {0x80, FEC_TEST_RED_PAYLOAD_TYPE,   0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x12, 0x34, 0x56,
+                        0x78, 0x80 | FEC_TEST_MEDIA_PAYLOAD_TYPE, 0x00, 0x00, 0x03, FEC_TEST_ULPFEC_PAYLOAD_TYPE, 0xAA};
+    UINT32 packetLength = SIZEOF(packet);
+    UINT8 blockPayloadType = 0;
+
+    EXPECT_EQ(STATUS_SUCCESS, redDecapsulateRtpPacket(packet, &packetLength, &blockPayloadType));
+    EXPECT_EQ(FEC_TEST_ULPFEC_PAYLOAD_TYPE, blockPayloadType);
+    EXPECT_EQ(SIZEOF(expected), packetLength);
+    EXPECT_EQ(0, MEMCMP(packet, expected, SIZEOF(expected)));
+
+    packetLength = SIZEOF(truncated);
+    EXPECT_EQ(STATUS_RTP_INPUT_PACKET_TOO_SMALL, redDecapsulateRtpPacket(truncated, &packetLength, &blockPayloadType));
+    packetLength = MIN_HEADER_LENGTH;
+    EXPECT_EQ(STATUS_RTP_INPUT_PACKET_TOO_SMALL, redDecapsulateRtpPacket(truncated, &packetLength, &blockPayloadType));
+}
+
+TEST_F(FecFunctionalityTest, fecPayloadTypesFromSessionDescription)
+{
+    SessionDescription sessionDescription;
+    UINT8 redPayloadType = 0, ulpfecPayloadType = 0;
+    auto withFec = R"(v=0
+o=- 686950092 1576880200 IN IP4 0.0.0.0
+s=-
+t=0 0
+m=audio 9 UDP/TLS/RTP/SAVPF 111 63
+a=rtpmap:111 opus/48000/2
+a=rtpmap:63 red/48000/2
+m=video 9 UDP/TLS/RTP/SAVPF 102 103 114 115
+a=rtpmap:102 H264/90000
+a=rtpmap:103 rtx/90000
+a=rtpmap:114 red/90000
+a=rtpmap:115 ulpfec/90000
+)";
+    auto redOnly = R"(v=0
+o=- 686950092 1576880200 IN IP4 0.0.0.0
+s=-
+t=0 0
+m=video 9 UDP/TLS/RTP/SAVPF 102 114
+a=rtpmap:102 H264/90000
+a=rtpmap:114 red/90000
+)";
+
+    MEMSET(&sessionDescription, 0x00, SIZEOF(SessionDescription));
+    EXPECT_EQ(STATUS_SUCCESS, deserializeSessionDescription(&sessionDescription, (PCHAR) withFec));
+    EXPECT_EQ(STATUS_SUCCESS, setFecPayloadTypes(&sessionDescription, &redPayloadType, &ulpfecPayloadType));
+    EXPECT_EQ(114, redPayloadType);
+    EXPECT_EQ(115, ulpfecPayloadType);
+
+    MEMSET(&sessionDescription, 0x00, SIZEOF(SessionDescription));
+    EXPECT_EQ(STATUS_SUCCESS, deserializeSessionDescription(&sessionDescription, (PCHAR) redOnly));
+    EXPECT_EQ(STATUS_SUCCESS, setFecPayloadTypes(&sessionDescription, &redPayloadType, &ulpfecPayloadType));
+    EXPECT_EQ(0, redPayloadType);
+    EXPECT_EQ(0, ulpfecPayloadType);
+}
+
+TEST_F(FecFunctionalityTest, rtxAptPayloadTypesFromSessionDescription)
+{
+    SessionDescription sessionDescription;
+    UINT8 aptPayloadTypes[PAYLOAD_TYPE_MASK + 1];
+    UINT32 i;
+    auto withRtx = R"(v=0
+o=- 686950092 1576880200 IN IP4 0.0.0.0
+s=-
+t=0 0
+m=video 9 UDP/TLS/RTP/SAVPF 102 103 114 116 115
+a=rtpmap:102 H264/90000
+a=rtpmap:103 rtx/90000
+a=fmtp:103 apt=102
+a=rtpmap:114 red/90000
+a=rtpmap:116 rtx/90000
+a=fmtp:116 apt=114;rtx-time=3000
+a=rtpmap:115 ulpfec/90000
+a=fmtp:120 apt=abc
+)";
+
+    MEMSET(&sessionDescription, 0x00, SIZEOF(SessionDescription));
+    EXPECT_EQ(STATUS_SUCCESS, deserializeSessionDescription(&sessionDescription, (PCHAR) withRtx));
+    MEMSET(aptPayloadTypes, 0xFF, SIZEOF(aptPayloadTypes));
+    EXPECT_EQ(STATUS_SUCCESS, setRtxAptPayloadTypes(&sessionDescription, aptPayloadTypes));
+
+    // RTX of RED restores the RED payload type, the RED decapsulation takes it from there
+    EXPECT_EQ(102, aptPayloadTypes[103]);
+    EXPECT_EQ(114, aptPayloadTypes[116]);
+    for (i = 0; i <= PAYLOAD_TYPE_MASK; i++) {
+        if (i != 103 && i != 116) {
+            EXPECT_EQ(0, aptPayloadTypes[i]);
+        }
+    }
+}
+
+TEST_F(FecFunctionalityTest, fecPacketsInterleavedWithMediaKeepFramesContinuous)
+{
+    BYTE key[30] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+                    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D};
+    RtcConfiguration configuration;
+    RtcMediaStreamTrack track;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+    PKvsPeerConnection pKvsPeerConnection;
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    PFecEncoder pFecEncoder = NULL;
+    FecTestReceivedFrames receivedFrames;
+    RtcInboundRtpStreamStats stats;
+    UINT32 frame, i, j, payloadLength, expectedFrameSize, fecPacketsSent = 0;
+    UINT16 sequenceNumber = 1000;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&receivedFrames, 0x00, SIZEOF(FecTestReceivedFrames));
+    configuration.kvsRtcConfiguration.enableForwardErrorCorrection = TRUE;
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    addTrackToPeerConnection(pRtcPeerConnection, &track, &pRtcRtpTransceiver,
+                             RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    ASSERT_TRUE(pRtcRtpTransceiver != NULL);
+    pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+    ASSERT_TRUE(pKvsRtpTransceiver->pFecDecoder != NULL && pKvsRtpTransceiver->pNackGenerator != NULL);
+    EXPECT_EQ(STATUS_SUCCESS, transceiverOnFrame(pRtcRtpTransceiver, (UINT64) &receivedFrames, fecTestOnFrame));
+
+    // What the remote description and the DTLS handshake would have set up
+    pKvsPeerConnection->redPayloadType = FEC_TEST_RED_PAYLOAD_TYPE;
+    pKvsPeerConnection->ulpfecPayloadType = FEC_TEST_ULPFEC_PAYLOAD_TYPE;
+    pKvsRtpTransceiver->jitterBufferSsrc = FEC_TEST_SSRC;
+    EXPECT_EQ(STATUS_SUCCESS, ssrcTablePut(pKvsPeerConnection->pSsrcTable, FEC_TEST_SSRC, SSRC_TABLE_KIND_RECEIVER, (UINT64) pKvsRtpTransceiver));
+    EXPECT_EQ(STATUS_SUCCESS, initSrtpSession(key, key, KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, &pKvsPeerConnection->pSrtpSession));
+
+    // Three frames of single NAL unit packets, each followed by its FEC packets. The second packet of the second frame is lost
+    // and recovered, only the third frame is still waiting for the next one.
+    EXPECT_EQ(STATUS_SUCCESS, createFecEncoder(0, 0, &pFecEncoder));
+    for (frame = 0; frame < 3; frame++) {
+        for (i = 0; i < 4; i++) {
+            payloadLength = 100 + i * 10;
+            mediaPayloads[i][0] = 0x41;
+            for (j = 1; j < payloadLength; j++) {
+                mediaPayloads[i][j] = (BYTE) (frame + i * 13 + j);
+            }
+            EXPECT_EQ(STATUS_SUCCESS,
+                      setRtpPacket(2, FALSE, FALSE, 0, i == 3, FEC_TEST_MEDIA_PAYLOAD_TYPE, sequenceNumber++, FEC_TEST_TIMESTAMP + frame * 3000,
+                                   FEC_TEST_SSRC, NULL, 0, 0, NULL, mediaPayloads[i], payloadLength, &mediaPackets[i]));
+        }
+        EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, 4));
+        ASSERT_TRUE(pFecEncoder->fecPacketCount > 0);
+        for (i = 0; i < pFecEncoder->fecPacketCount; i++) {
+            EXPECT_EQ(STATUS_SUCCESS,
+                      setRtpPacket(2, FALSE, FALSE, 0, FALSE, FEC_TEST_ULPFEC_PAYLOAD_TYPE, sequenceNumber++, FEC_TEST_TIMESTAMP + frame * 3000,
+                                   FEC_TEST_SSRC, NULL, 0, 0, NULL,
+                                   pFecEncoder->pFecPayloads + i * FEC_ENCODER_PAYLOAD_SLOT_LENGTH + RED_PRIMARY_HEADER_LENGTH,
+                                   pFecEncoder->fecPayloadLengths[i], &fecPackets[i]));
+        }
+
+        for (i = 0; i < 4; i++) {
+            if (frame != 1 || i != 1) {
+                receiveInRed(pKvsPeerConnection, &mediaPackets[i]);
+            }
+        }
+        for (i = 0; i < pFecEncoder->fecPacketCount; i++) {
+            receiveInRed(pKvsPeerConnection, &fecPackets[i]);
+            fecPacketsSent++;
+        }
+    }
+
+    // Annex-B start code in front of every NAL unit
+    expectedFrameSize = 4 * 4 + 100 + 110 + 120 + 130;
+    EXPECT_EQ(2, receivedFrames.frameCount);
+    EXPECT_EQ(expectedFrameSize, receivedFrames.frameSizes[0]);
+    EXPECT_EQ(expectedFrameSize, receivedFrames.frameSizes[1]);
+
+    // The FEC sequence numbers are not missing
+    EXPECT_EQ(0, pKvsRtpTransceiver->pNackGenerator->missingPacketCount);
+
+    MEMSET(&stats, 0x00, SIZEOF(RtcInboundRtpStreamStats));
+    EXPECT_EQ(STATUS_SUCCESS, getRtpInboundStats(pRtcPeerConnection, NULL, &stats));
+    EXPECT_EQ(fecPacketsSent, stats.fecPacketsReceived);
+    EXPECT_EQ(0, stats.received.framesDropped);
+    EXPECT_EQ(0, stats.received.packetsDiscarded);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFecEncoder(&pFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+}
+
+TEST_F(FecFunctionalityTest, fecPacketsFitTheMtu)
+{
+    RtcConfiguration configuration;
+    RtcMediaStreamTrack track;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+    PKvsPeerConnection pKvsPeerConnection;
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    PFecEncoder pFecEncoder = NULL;
+    BYTE payload[DEFAULT_MTU_SIZE_BYTES];
+    UINT32 i, mtu, twccExtPayload;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(payload, 0x41, SIZEOF(payload));
+    configuration.kvsRtcConfiguration.enableForwardErrorCorrection = TRUE;
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    addTrackToPeerConnection(pRtcPeerConnection, &track, &pRtcRtpTransceiver,
+                             RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    ASSERT_TRUE(pRtcRtpTransceiver != NULL);
+    pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+    ASSERT_TRUE(pKvsRtpTransceiver->sender.pFecEncoder != NULL);
+
+    // Nothing is taken from the MTU until ULPFEC is negotiated
+    EXPECT_EQ(pKvsPeerConnection->MTU, getPayloadMtu(pKvsRtpTransceiver));
+
+    pKvsPeerConnection->redPayloadType = FEC_TEST_RED_PAYLOAD_TYPE;
+    pKvsPeerConnection->ulpfecPayloadType = FEC_TEST_ULPFEC_PAYLOAD_TYPE;
+    pKvsPeerConnection->twccExtId = 3;
+    mtu = getPayloadMtu(pKvsRtpTransceiver);
+    EXPECT_EQ(pKvsPeerConnection->MTU - FEC_PACKET_OVERHEAD - TWCC_EXT_LENGTH, mtu);
+
+    // Full packets with the TWCC extension, the FEC packets protecting them are no longer than unprotected packets at the MTU
+    twccExtPayload = TWCC_PAYLOAD(pKvsPeerConnection->twccExtId, 1);
+    for (i = 0; i < FEC_MIN_GROUP_SIZE; i++) {
+        EXPECT_EQ(STATUS_SUCCESS,
+                  setRtpPacket(2, FALSE, TRUE, 0, i + 1 == FEC_MIN_GROUP_SIZE, FEC_TEST_MEDIA_PAYLOAD_TYPE, (UINT16) i, FEC_TEST_TIMESTAMP,
+                               FEC_TEST_SSRC, NULL, TWCC_EXT_PROFILE, SIZEOF(UINT32), (PBYTE) &twccExtPayload, payload, mtu,
+                               &mediaPackets[i]));
+    }
+    EXPECT_EQ(STATUS_SUCCESS, createFecEncoder(0, 0, &pFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, fecEncoderProtect(pFecEncoder, mediaPackets, FEC_MIN_GROUP_SIZE));
+    ASSERT_TRUE(pFecEncoder->fecPacketCount > 0);
+    for (i = 0; i < pFecEncoder->fecPacketCount; i++) {
+        EXPECT_GE(pKvsPeerConnection->MTU, RED_PRIMARY_HEADER_LENGTH + pFecEncoder->fecPayloadLengths[i]);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeFecEncoder(&pFecEncoder));
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -209,6 +209,8 @@ TEST_F(IceFunctionalityTest, connectionListenerFunctionalityTest)
 
     THREAD_JOIN(threadId, NULL);
 
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveAllConnection(pConnectionListener));
+    EXPECT_EQ(0, pConnectionListener->socketCount);
     EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
 
     EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSocketConnection));
@@ -222,6 +224,628 @@ TEST_F(IceFunctionalityTest, connectionListenerFunctionalityTest)
     }
 }
 
+STATUS connectionListenerTestDataAvailableFn(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen,
+                                             PKvsIpAddress pSrc, PKvsIpAddress pDest)
+{
+    UNUSED_PARAM(pSocketConnection);
+    UNUSED_PARAM(pBuffer);
+    UNUSED_PARAM(bufferLen);
+    UNUSED_PARAM(pSrc);
+    UNUSED_PARAM(pDest);
+    ATOMIC_INCREMENT((PSIZE_T) customData);
+    return STATUS_SUCCESS;
+}
+
+TEST_F(IceFunctionalityTest, connectionListenerGrowsBeyondDefaultCapacity)
+{
+    PConnectionListener pConnectionListener = NULL;
+    const UINT32 socketCount = CONNECTION_LISTENER_DEFAULT_SOCKET_CAPACITY * 2 + 1;
+    PSocketConnection socketConnections[CONNECTION_LISTENER_DEFAULT_SOCKET_CAPACITY * 2 + 1];
+    PSocketConnection pSenderSocketConnection = NULL;
+    KvsIpAddress localhost;
+    UINT32 i;
+    SIZE_T receivedCount = 0;
+    BYTE data[] = {0x01, 0x02, 0x03, 0x04};
+    UINT64 timeout;
+
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_SUCCESS, createConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListener));
+
+    for (i = 0; i < socketCount; i++) {
+        localhost.port = 0;
+        EXPECT_EQ(STATUS_SUCCESS,
+                  createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, (UINT64) &receivedCount,
+                                         connectionListenerTestDataAvailableFn, 0, &socketConnections[i]));
+        ATOMIC_STORE_BOOL(&socketConnections[i]->receiveData, TRUE);
+        EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, socketConnections[i]));
+    }
+
+    EXPECT_EQ(socketCount, (UINT32) pConnectionListener->socketCount);
+    EXPECT_LE(socketCount, pConnectionListener->socketCapacity);
+
+    // Adding an already listened connection is a no-op
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, socketConnections[0]));
+    EXPECT_EQ(socketCount, (UINT32) pConnectionListener->socketCount);
+
+    // Data sent to the last registered socket must be dispatched
+    localhost.port = 0;
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSenderSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS,
+              socketConnectionSendData(pSenderSocketConnection, data, SIZEOF(data), &socketConnections[socketCount - 1]->hostIpAddr));
+
+    timeout = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (ATOMIC_LOAD(&receivedCount) == 0 && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_EQ(1, ATOMIC_LOAD(&receivedCount));
+
+    // Removing from the middle keeps the remaining connections registered
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveConnection(pConnectionListener, socketConnections[1]));
+    EXPECT_EQ(socketCount - 1, (UINT32) pConnectionListener->socketCount);
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveConnection(pConnectionListener, socketConnections[1]));
+    EXPECT_EQ(socketCount - 1, (UINT32) pConnectionListener->socketCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveAllConnection(pConnectionListener));
+    EXPECT_EQ(0, (UINT32) pConnectionListener->socketCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
+
+    for (i = 0; i < socketCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&socketConnections[i]));
+    }
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSenderSocketConnection));
+}
+
+typedef struct {
+    SIZE_T batchBeginCount;
+    SIZE_T batchEndCount;
+    SIZE_T receivedCount;
+    SIZE_T receivedOutsideBatchCount;
+    volatile ATOMIC_BOOL inBatch;
+} ConnectionListenerBatchTestData, *PConnectionListenerBatchTestData;
+
+STATUS connectionListenerBatchTestDataAvailableFn(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen,
+                                                  PKvsIpAddress pSrc, PKvsIpAddress pDest)
+{
+    PConnectionListenerBatchTestData pTestData = (PConnectionListenerBatchTestData) customData;
+    UNUSED_PARAM(pSocketConnection);
+    UNUSED_PARAM(pBuffer);
+    UNUSED_PARAM(bufferLen);
+    UNUSED_PARAM(pSrc);
+    UNUSED_PARAM(pDest);
+    if (!ATOMIC_LOAD_BOOL(&pTestData->inBatch)) {
+        ATOMIC_INCREMENT(&pTestData->receivedOutsideBatchCount);
+    }
+    ATOMIC_INCREMENT(&pTestData->receivedCount);
+    return STATUS_SUCCESS;
+}
+
+STATUS connectionListenerTestBatchBeginFn(UINT64 customData, PSocketConnection pSocketConnection)
+{
+    PConnectionListenerBatchTestData pTestData = (PConnectionListenerBatchTestData) customData;
+    UNUSED_PARAM(pSocketConnection);
+    ATOMIC_STORE_BOOL(&pTestData->inBatch, TRUE);
+    ATOMIC_INCREMENT(&pTestData->batchBeginCount);
+    return STATUS_SUCCESS;
+}
+
+STATUS connectionListenerTestBatchEndFn(UINT64 customData, PSocketConnection pSocketConnection)
+{
+    PConnectionListenerBatchTestData pTestData = (PConnectionListenerBatchTestData) customData;
+    UNUSED_PARAM(pSocketConnection);
+    ATOMIC_STORE_BOOL(&pTestData->inBatch, FALSE);
+    ATOMIC_INCREMENT(&pTestData->batchEndCount);
+    return STATUS_SUCCESS;
+}
+
+TEST_F(IceFunctionalityTest, connectionListenerDispatchesDatagramsInBatches)
+{
+    PConnectionListener pConnectionListener = NULL;
+    PSocketConnection pSocketConnection = NULL, pSenderSocketConnection = NULL;
+    ConnectionListenerBatchTestData testData;
+    KvsIpAddress localhost;
+    // More than a single recvmmsg call can hold
+    const UINT32 datagramCount = 40;
+    UINT32 i;
+    BYTE data[] = {0x01, 0x02, 0x03, 0x04};
+    UINT64 timeout;
+
+    MEMSET(&testData, 0x00, SIZEOF(testData));
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, (UINT64) &testData,
+                                     connectionListenerBatchTestDataAvailableFn, 0, &pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS,
+              socketConnectionSetBatchCallbacks(pSocketConnection, connectionListenerTestBatchBeginFn, connectionListenerTestBatchEndFn));
+    ATOMIC_STORE_BOOL(&pSocketConnection->receiveData, TRUE);
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSenderSocketConnection));
+
+    // Queue the datagrams before anyone listens so that they are all drained together
+    for (i = 0; i < datagramCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendData(pSenderSocketConnection, data, SIZEOF(data), &pSocketConnection->hostIpAddr));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, createConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListener));
+
+    timeout = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while ((ATOMIC_LOAD(&testData.receivedCount) < datagramCount || ATOMIC_LOAD_BOOL(&testData.inBatch)) && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(datagramCount, ATOMIC_LOAD(&testData.receivedCount));
+    EXPECT_EQ(0, ATOMIC_LOAD(&testData.receivedOutsideBatchCount));
+    EXPECT_LE(1, ATOMIC_LOAD(&testData.batchBeginCount));
+    EXPECT_EQ(ATOMIC_LOAD(&testData.batchBeginCount), ATOMIC_LOAD(&testData.batchEndCount));
+
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveAllConnection(pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSenderSocketConnection));
+}
+
+typedef struct {
+    SIZE_T receivedCount;
+    SIZE_T receivedBytes;
+} SocketConnectionSendBatchTestData, *PSocketConnectionSendBatchTestData;
+
+STATUS socketConnectionSendBatchTestDataAvailableFn(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen,
+                                                    PKvsIpAddress pSrc, PKvsIpAddress pDest)
+{
+    PSocketConnectionSendBatchTestData pTestData = (PSocketConnectionSendBatchTestData) customData;
+    UNUSED_PARAM(pSocketConnection);
+    UNUSED_PARAM(pBuffer);
+    UNUSED_PARAM(pSrc);
+    UNUSED_PARAM(pDest);
+    ATOMIC_ADD(&pTestData->receivedBytes, bufferLen);
+    ATOMIC_INCREMENT(&pTestData->receivedCount);
+    return STATUS_SUCCESS;
+}
+
+TEST_F(IceFunctionalityTest, socketConnectionSendBatchDeliversEveryDatagram)
+{
+    PConnectionListener pConnectionListener = NULL;
+    PSocketConnection pSocketConnection = NULL, pSenderSocketConnection = NULL;
+    SocketConnectionSendBatchTestData testData;
+    KvsIpAddress localhost;
+    const UINT32 packetCount = 20;
+    BYTE data[1200];
+    PBYTE buffers[20];
+    UINT32 lengths[20], i, sentCount = 0, expectedBytes = 0;
+    UINT64 timeout;
+
+    MEMSET(&testData, 0x00, SIZEOF(testData));
+    MEMSET(data, 0xab, SIZEOF(data));
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, (UINT64) &testData,
+                                     socketConnectionSendBatchTestDataAvailableFn, 0, &pSocketConnection));
+    ATOMIC_STORE_BOOL(&pSocketConnection->receiveData, TRUE);
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSenderSocketConnection));
+
+    EXPECT_EQ(STATUS_SUCCESS, createConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListener));
+
+    // MTU sized packets with a shorter tail, the shape of a fragmented frame that can be segmented by the kernel
+    for (i = 0; i < packetCount / 2; i++) {
+        buffers[i] = data;
+        lengths[i] = i == packetCount / 2 - 1 ? 300 : SIZEOF(data);
+        expectedBytes += lengths[i];
+    }
+    EXPECT_EQ(STATUS_SUCCESS,
+              socketConnectionSendBatch(pSenderSocketConnection, buffers, lengths, packetCount / 2, &pSocketConnection->hostIpAddr,
+                                        SOCKET_EGRESS_PRIORITY_VIDEO, &sentCount));
+    EXPECT_EQ(packetCount / 2, sentCount);
+
+    // Packets of varying size always go through the generic batch path
+    for (i = 0; i < packetCount / 2; i++) {
+        buffers[i] = data;
+        lengths[i] = 100 + i * 50;
+        expectedBytes += lengths[i];
+    }
+    EXPECT_EQ(STATUS_SUCCESS,
+              socketConnectionSendBatch(pSenderSocketConnection, buffers, lengths, packetCount / 2, &pSocketConnection->hostIpAddr,
+                                        SOCKET_EGRESS_PRIORITY_VIDEO, &sentCount));
+    EXPECT_EQ(packetCount / 2, sentCount);
+
+    timeout = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (ATOMIC_LOAD(&testData.receivedCount) < packetCount && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(packetCount, ATOMIC_LOAD(&testData.receivedCount));
+    EXPECT_EQ(expectedBytes, ATOMIC_LOAD(&testData.receivedBytes));
+
+    EXPECT_EQ(STATUS_NULL_ARG,
+              socketConnectionSendBatch(NULL, buffers, lengths, 1, &pSocketConnection->hostIpAddr, SOCKET_EGRESS_PRIORITY_VIDEO, NULL));
+    EXPECT_EQ(STATUS_INVALID_ARG,
+              socketConnectionSendBatch(pSenderSocketConnection, buffers, lengths, 0, &pSocketConnection->hostIpAddr,
+                                        SOCKET_EGRESS_PRIORITY_VIDEO, NULL));
+
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveAllConnection(pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSenderSocketConnection));
+}
+
+TEST_F(IceFunctionalityTest, connectionListenerReceivesDatagramsLargerThanARecvSlot)
+{
+    PConnectionListener pConnectionListener = NULL;
+    PSocketConnection pSocketConnection = NULL, pSenderSocketConnection = NULL;
+    SocketConnectionSendBatchTestData testData;
+    KvsIpAddress localhost;
+    // Queued together so that they are drained by a single recvmmsg call, the big one spills over its slot
+    const UINT32 datagramCount = 3, datagramLens[] = {1200, 20000, 1200};
+    PBYTE data = NULL;
+    UINT32 i, expectedBytes = 0;
+    UINT64 timeout;
+
+    MEMSET(&testData, 0x00, SIZEOF(testData));
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+    data = (PBYTE) MEMCALLOC(1, datagramLens[1]);
+    ASSERT_TRUE(data != NULL);
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, (UINT64) &testData,
+                                     socketConnectionSendBatchTestDataAvailableFn, 0, &pSocketConnection));
+    ATOMIC_STORE_BOOL(&pSocketConnection->receiveData, TRUE);
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSenderSocketConnection));
+
+    for (i = 0; i < datagramCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendData(pSenderSocketConnection, data, datagramLens[i], &pSocketConnection->hostIpAddr));
+        expectedBytes += datagramLens[i];
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, createConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListener));
+
+    timeout = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (ATOMIC_LOAD(&testData.receivedCount) < datagramCount && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(datagramCount, ATOMIC_LOAD(&testData.receivedCount));
+    EXPECT_EQ(expectedBytes, ATOMIC_LOAD(&testData.receivedBytes));
+
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveAllConnection(pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSenderSocketConnection));
+    MEMFREE(data);
+}
+
+typedef struct {
+    SIZE_T receivedCount;
+    UINT32 receivedLen;
+    BYTE received[1500];
+} SocketConnectionSendGatherTestData, *PSocketConnectionSendGatherTestData;
+
+STATUS socketConnectionSendGatherTestDataAvailableFn(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen,
+                                                     PKvsIpAddress pSrc, PKvsIpAddress pDest)
+{
+    PSocketConnectionSendGatherTestData pTestData = (PSocketConnectionSendGatherTestData) customData;
+    UNUSED_PARAM(pSocketConnection);
+    UNUSED_PARAM(pSrc);
+    UNUSED_PARAM(pDest);
+    pTestData->receivedLen = MIN(bufferLen, SIZEOF(pTestData->received));
+    MEMCPY(pTestData->received, pBuffer, pTestData->receivedLen);
+    ATOMIC_INCREMENT(&pTestData->receivedCount);
+    return STATUS_SUCCESS;
+}
+
+TEST_F(IceFunctionalityTest, socketConnectionSendDataGatherSendsOneDatagram)
+{
+    PConnectionListener pConnectionListener = NULL;
+    PSocketConnection pSocketConnection = NULL, pSenderSocketConnection = NULL;
+    SocketConnectionSendGatherTestData testData;
+    KvsIpAddress localhost;
+    BYTE header[4] = {0x40, 0x00, 0x00, 0x05}, payload[5] = {1, 2, 3, 4, 5}, padding[3] = {0};
+    BYTE expected[SIZEOF(header) + SIZEOF(payload) + SIZEOF(padding)];
+    PBYTE buffers[SOCKET_SEND_GATHER_MAX_BUFFERS + 1] = {header, payload, padding};
+    UINT32 lengths[SOCKET_SEND_GATHER_MAX_BUFFERS + 1] = {SIZEOF(header), SIZEOF(payload), SIZEOF(padding)};
+    UINT64 timeout;
+
+    MEMSET(&testData, 0x00, SIZEOF(testData));
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+    MEMCPY(expected, header, SIZEOF(header));
+    MEMCPY(expected + SIZEOF(header), payload, SIZEOF(payload));
+    MEMCPY(expected + SIZEOF(header) + SIZEOF(payload), padding, SIZEOF(padding));
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, (UINT64) &testData,
+                                     socketConnectionSendGatherTestDataAvailableFn, 0, &pSocketConnection));
+    ATOMIC_STORE_BOOL(&pSocketConnection->receiveData, TRUE);
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSenderSocketConnection));
+
+    EXPECT_EQ(STATUS_SUCCESS, createConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListener));
+
+    EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendDataGather(pSenderSocketConnection, buffers, lengths, 3, &pSocketConnection->hostIpAddr));
+
+    timeout = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (ATOMIC_LOAD(&testData.receivedCount) < 1 && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    // The buffers arrive as a single datagram, in order
+    EXPECT_EQ(1, ATOMIC_LOAD(&testData.receivedCount));
+    ASSERT_EQ(SIZEOF(expected), testData.receivedLen);
+    EXPECT_EQ(0, MEMCMP(expected, testData.received, SIZEOF(expected)));
+
+    EXPECT_EQ(STATUS_NULL_ARG, socketConnectionSendDataGather(NULL, buffers, lengths, 3, &pSocketConnection->hostIpAddr));
+    EXPECT_EQ(STATUS_INVALID_ARG, socketConnectionSendDataGather(pSenderSocketConnection, buffers, lengths, 0, &pSocketConnection->hostIpAddr));
+    EXPECT_EQ(STATUS_INVALID_ARG,
+              socketConnectionSendDataGather(pSenderSocketConnection, buffers, lengths, SOCKET_SEND_GATHER_MAX_BUFFERS + 1,
+                                             &pSocketConnection->hostIpAddr));
+    EXPECT_EQ(STATUS_INVALID_ARG, socketConnectionSendDataGather(pSenderSocketConnection, buffers, lengths, 3, NULL));
+
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveAllConnection(pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSenderSocketConnection));
+}
+
+TEST_F(IceFunctionalityTest, socketEgressQueueDropsLowerPrioritiesFirst)
+{
+    PSocketConnection pSocketConnection = NULL;
+    KvsIpAddress localhost;
+    BYTE data[100];
+    PBYTE pBuffer = data;
+    UINT32 i, length = SIZEOF(data);
+    BOOL backpressureStarted = FALSE;
+
+    MEMSET(data, 0x00, SIZEOF(data));
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSocketConnection));
+
+    // Only sockets serviced by a listener queue
+    EXPECT_EQ(STATUS_SEND_DATA_FAILED,
+              socketEgressQueuePushLocked(pSocketConnection, &pBuffer, &length, 1, &localhost, SOCKET_EGRESS_PRIORITY_AUDIO, &backpressureStarted));
+
+    // Not registered with any epoll instance, the queue is just never drained
+    pSocketConnection->egressQueueEnabled = TRUE;
+
+    // Half discardable video, half audio, the first packet starts the backpressure
+    for (i = 0; i < SOCKET_EGRESS_QUEUE_MAX_PACKETS; i++) {
+        data[0] = (BYTE) i;
+        EXPECT_EQ(STATUS_SOCKET_CONNECTION_BACKPRESSURED,
+                  socketEgressQueuePushLocked(pSocketConnection, &pBuffer, &length, 1, &localhost,
+                                              i % 2 == 0 ? SOCKET_EGRESS_PRIORITY_DISCARDABLE_VIDEO : SOCKET_EGRESS_PRIORITY_AUDIO,
+                                              &backpressureStarted));
+        EXPECT_EQ(i == 0, backpressureStarted);
+    }
+    EXPECT_TRUE(ATOMIC_LOAD_BOOL(&pSocketConnection->egressBackpressured));
+    EXPECT_EQ(SOCKET_EGRESS_QUEUE_MAX_PACKETS, pSocketConnection->egressCount);
+    EXPECT_EQ(0, pSocketConnection->egressPacketsDropped);
+
+    // Nothing below discardable video, the new packet is the one dropped
+    EXPECT_EQ(STATUS_SEND_DATA_FAILED,
+              socketEgressQueuePushLocked(pSocketConnection, &pBuffer, &length, 1, &localhost, SOCKET_EGRESS_PRIORITY_DISCARDABLE_VIDEO,
+                                          &backpressureStarted));
+    EXPECT_EQ(1, pSocketConnection->egressPacketsDropped);
+    EXPECT_EQ(SIZEOF(data), pSocketConnection->egressBytesDropped);
+
+    // Audio evicts the oldest discardable video, keeping the order of the rest
+    EXPECT_EQ(STATUS_SOCKET_CONNECTION_BACKPRESSURED,
+              socketEgressQueuePushLocked(pSocketConnection, &pBuffer, &length, 1, &localhost, SOCKET_EGRESS_PRIORITY_AUDIO, &backpressureStarted));
+    EXPECT_FALSE(backpressureStarted);
+    EXPECT_EQ(2, pSocketConnection->egressPacketsDropped);
+    EXPECT_EQ(SOCKET_EGRESS_QUEUE_MAX_PACKETS, pSocketConnection->egressCount);
+    EXPECT_EQ(1, pSocketConnection->pEgressPackets[pSocketConnection->egressHead].pData[0]);
+    EXPECT_EQ(SOCKET_EGRESS_PRIORITY_AUDIO, pSocketConnection->pEgressPackets[pSocketConnection->egressHead].priority);
+    EXPECT_EQ(2, pSocketConnection->pEgressPackets[(pSocketConnection->egressHead + 1) % SOCKET_EGRESS_QUEUE_MAX_PACKETS].pData[0]);
+
+    // Once only audio is left, more audio is dropped
+    for (i = 0; i < SOCKET_EGRESS_QUEUE_MAX_PACKETS / 2 - 1; i++) {
+        EXPECT_EQ(STATUS_SOCKET_CONNECTION_BACKPRESSURED,
+                  socketEgressQueuePushLocked(pSocketConnection, &pBuffer, &length, 1, &localhost, SOCKET_EGRESS_PRIORITY_AUDIO,
+                                              &backpressureStarted));
+    }
+    EXPECT_EQ(STATUS_SEND_DATA_FAILED,
+              socketEgressQueuePushLocked(pSocketConnection, &pBuffer, &length, 1, &localhost, SOCKET_EGRESS_PRIORITY_AUDIO, &backpressureStarted));
+    EXPECT_EQ(SOCKET_EGRESS_QUEUE_MAX_PACKETS / 2 + 2, pSocketConnection->egressPacketsDropped);
+    EXPECT_EQ(SOCKET_EGRESS_QUEUE_MAX_PACKETS * SIZEOF(data), pSocketConnection->egressBytes);
+
+    // Disabling the queue drops everything left
+    EXPECT_EQ(STATUS_SUCCESS, socketConnectionDisableEgressQueue(pSocketConnection));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&pSocketConnection->egressBackpressured));
+    EXPECT_EQ(0, pSocketConnection->egressCount);
+    EXPECT_EQ(0, pSocketConnection->egressBytes);
+    EXPECT_EQ(SOCKET_EGRESS_QUEUE_MAX_PACKETS / 2 + 2 + SOCKET_EGRESS_QUEUE_MAX_PACKETS, pSocketConnection->egressPacketsDropped);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSocketConnection));
+}
+
+typedef struct {
+    SIZE_T receivedCount;
+    SIZE_T backpressureStartedCount;
+    SIZE_T backpressureEndedCount;
+} SocketEgressQueueTestData, *PSocketEgressQueueTestData;
+
+STATUS socketEgressQueueTestDataAvailableFn(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen,
+                                            PKvsIpAddress pSrc, PKvsIpAddress pDest)
+{
+    UNUSED_PARAM(pSocketConnection);
+    UNUSED_PARAM(pBuffer);
+    UNUSED_PARAM(bufferLen);
+    UNUSED_PARAM(pSrc);
+    UNUSED_PARAM(pDest);
+    ATOMIC_INCREMENT(&((PSocketEgressQueueTestData) customData)->receivedCount);
+    return STATUS_SUCCESS;
+}
+
+VOID socketEgressQueueTestEgressStateFn(UINT64 customData, PSocketConnection pSocketConnection, BOOL backpressured)
+{
+    PSocketEgressQueueTestData pTestData = (PSocketEgressQueueTestData) customData;
+    UNUSED_PARAM(pSocketConnection);
+    ATOMIC_INCREMENT(backpressured ? &pTestData->backpressureStartedCount : &pTestData->backpressureEndedCount);
+}
+
+TEST_F(IceFunctionalityTest, socketEgressQueueIsFlushedInOrder)
+{
+    PConnectionListener pConnectionListener = NULL;
+    PSocketConnection pSocketConnection = NULL, pSenderSocketConnection = NULL;
+    SocketEgressQueueTestData testData;
+    KvsIpAddress localhost;
+    BYTE data[200];
+    PBYTE buffers[8];
+    UINT32 lengths[8], i, sentCount = 0;
+    BOOL backpressureStarted = FALSE;
+    UINT64 timeout;
+
+    MEMSET(&testData, 0x00, SIZEOF(testData));
+    MEMSET(data, 0xab, SIZEOF(data));
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, (UINT64) &testData,
+                                     socketEgressQueueTestDataAvailableFn, 0, &pSocketConnection));
+    ATOMIC_STORE_BOOL(&pSocketConnection->receiveData, TRUE);
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, (UINT64) &testData, NULL, 0,
+                                     &pSenderSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, socketConnectionSetEgressStateCallback(pSenderSocketConnection, socketEgressQueueTestEgressStateFn));
+
+    EXPECT_EQ(STATUS_SUCCESS, createConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListener));
+
+    // Stand in for a full send buffer: the socket is not registered with a listener so nothing drains the queue on its own
+    pSenderSocketConnection->egressQueueEnabled = TRUE;
+    for (i = 0; i < ARRAY_SIZE(buffers); i++) {
+        buffers[i] = data;
+        lengths[i] = SIZEOF(data);
+    }
+    EXPECT_EQ(STATUS_SOCKET_CONNECTION_BACKPRESSURED,
+              socketEgressQueuePushLocked(pSenderSocketConnection, buffers, lengths, 1, &pSocketConnection->hostIpAddr,
+                                          SOCKET_EGRESS_PRIORITY_VIDEO, &backpressureStarted));
+    EXPECT_TRUE(backpressureStarted);
+
+    // Later sends must not overtake the queued packet, they are queued behind it
+    EXPECT_EQ(STATUS_SOCKET_CONNECTION_BACKPRESSURED,
+              socketConnectionSendBatch(pSenderSocketConnection, buffers, lengths, ARRAY_SIZE(buffers), &pSocketConnection->hostIpAddr,
+                                        SOCKET_EGRESS_PRIORITY_VIDEO, &sentCount));
+    EXPECT_EQ(ARRAY_SIZE(buffers), sentCount);
+    EXPECT_EQ(STATUS_SOCKET_CONNECTION_BACKPRESSURED,
+              socketConnectionSendData(pSenderSocketConnection, data, SIZEOF(data), &pSocketConnection->hostIpAddr));
+    EXPECT_EQ(ARRAY_SIZE(buffers) + 2, pSenderSocketConnection->egressCount);
+
+    // What the listener does once the socket is writable
+    EXPECT_EQ(STATUS_SUCCESS, socketConnectionFlushEgressQueue(pSenderSocketConnection));
+    EXPECT_EQ(0, pSenderSocketConnection->egressCount);
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&pSenderSocketConnection->egressBackpressured));
+    EXPECT_EQ(1, ATOMIC_LOAD(&testData.backpressureEndedCount));
+
+    timeout = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (ATOMIC_LOAD(&testData.receivedCount) < ARRAY_SIZE(buffers) + 2 && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_EQ(ARRAY_SIZE(buffers) + 2, ATOMIC_LOAD(&testData.receivedCount));
+
+    // Sends go straight to the socket again
+    EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendData(pSenderSocketConnection, data, SIZEOF(data), &pSocketConnection->hostIpAddr));
+    EXPECT_EQ(0, pSenderSocketConnection->egressCount);
+    EXPECT_EQ(0, pSenderSocketConnection->egressPacketsDropped);
+
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveAllConnection(pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSenderSocketConnection));
+}
+
+TEST_F(IceFunctionalityTest, sharedConnectionListenersOnlyRemoveTheirOwnSockets)
+{
+    PConnectionListener pFirstListener = NULL, pSecondListener = NULL;
+    PSocketConnection pFirstSocketConnection = NULL, pSecondSocketConnection = NULL, pSenderSocketConnection = NULL;
+    SocketConnectionSendBatchTestData firstData, secondData;
+    KvsIpAddress localhost;
+    BYTE data[] = {0x01, 0x02, 0x03, 0x04};
+    UINT64 timeout;
+
+    MEMSET(&firstData, 0x00, SIZEOF(firstData));
+    MEMSET(&secondData, 0x00, SIZEOF(secondData));
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, (UINT64) &firstData,
+                                     socketConnectionSendBatchTestDataAvailableFn, 0, &pFirstSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, (UINT64) &secondData,
+                                     socketConnectionSendBatchTestDataAvailableFn, 0, &pSecondSocketConnection));
+    ATOMIC_STORE_BOOL(&pFirstSocketConnection->receiveData, TRUE);
+    ATOMIC_STORE_BOOL(&pSecondSocketConnection->receiveData, TRUE);
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSenderSocketConnection));
+
+    EXPECT_EQ(STATUS_SUCCESS, createSharedConnectionListener(&pFirstListener));
+    EXPECT_EQ(STATUS_SUCCESS, createSharedConnectionListener(&pSecondListener));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pFirstListener, pFirstSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pSecondListener, pSecondSocketConnection));
+
+    // The reactor threads are already running and owned by the pool
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pFirstListener));
+    EXPECT_LE(1, networkReactorPoolGetThreadCount());
+
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveAllConnection(pFirstListener));
+    EXPECT_EQ(0, pFirstListener->socketCount);
+    EXPECT_EQ(1, pSecondListener->socketCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendData(pSenderSocketConnection, data, SIZEOF(data), &pSecondSocketConnection->hostIpAddr));
+    timeout = GETTIME() + MAX_TEST_AWAIT_DURATION;
+    while (ATOMIC_LOAD(&secondData.receivedCount) < 1 && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(1, ATOMIC_LOAD(&secondData.receivedCount));
+    EXPECT_EQ(0, ATOMIC_LOAD(&firstData.receivedCount));
+
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveAllConnection(pSecondListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pFirstListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pSecondListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pFirstSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSecondSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSenderSocketConnection));
+}
+
 ///////////////////////////////////////////////
 // IceAgent Test
 ///////////////////////////////////////////////
@@ -727,6 +1351,246 @@ TEST_F(IceFunctionalityTest, IceAgentPruneUnconnectedIceCandidatePairUnitTest)
     EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.iceCandidatePairs));
 }
 
+TEST_F(IceFunctionalityTest, IceAgentCandidatePairIndexUnitTest)
+{
+    IceAgent iceAgent;
+    SocketConnection socketConnections[2];
+    IceCandidate localCandidates[2], remoteCandidates[3];
+    IceCandidatePair iceCandidatePairs[6];
+    PIceCandidatePair pIceCandidatePair = NULL;
+    KvsIpAddress remoteAddress;
+    UINT32 i, j;
+
+    MEMSET(&iceAgent, 0x00, SIZEOF(IceAgent));
+    MEMSET(localCandidates, 0x00, SIZEOF(localCandidates));
+    MEMSET(remoteCandidates, 0x00, SIZEOF(remoteCandidates));
+    MEMSET(iceCandidatePairs, 0x00, SIZEOF(iceCandidatePairs));
+    doubleListCreate(&iceAgent.iceCandidatePairs);
+
+    // Two remote candidates behind the same address
+    for (i = 0; i < 3; i++) {
+        remoteCandidates[i].ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        remoteCandidates[i].ipAddress.address[0] = 10;
+        remoteCandidates[i].ipAddress.address[3] = i < 2 ? 1 : 2;
+        remoteCandidates[i].ipAddress.port = (UINT16) getInt16(i == 1 ? 2000 : 1000);
+    }
+
+    for (i = 0; i < 2; i++) {
+        localCandidates[i].pSocketConnection = &socketConnections[i];
+        for (j = 0; j < 3; j++) {
+            pIceCandidatePair = &iceCandidatePairs[i * 3 + j];
+            pIceCandidatePair->local = &localCandidates[i];
+            pIceCandidatePair->remote = &remoteCandidates[j];
+            pIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_WAITING;
+            pIceCandidatePair->priority = 100 * (i + 1) + j;
+            EXPECT_EQ(STATUS_SUCCESS, insertIceCandidatePair(iceAgent.iceCandidatePairs, pIceCandidatePair));
+            iceAgentIndexIceCandidatePair(&iceAgent, pIceCandidatePair);
+            EXPECT_TRUE(pIceCandidatePair->indexed);
+        }
+    }
+
+    for (i = 0; i < 2; i++) {
+        for (j = 0; j < 3; j++) {
+            EXPECT_EQ(STATUS_SUCCESS,
+                      findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, &socketConnections[i], &remoteCandidates[j].ipAddress,
+                                                                                 TRUE, &pIceCandidatePair));
+            EXPECT_EQ(&iceCandidatePairs[i * 3 + j], pIceCandidatePair);
+        }
+    }
+
+    // Without the port the highest priority pair of the address wins, as with the list
+    remoteAddress = remoteCandidates[0].ipAddress;
+    remoteAddress.port = (UINT16) getInt16(3000);
+    EXPECT_EQ(STATUS_SUCCESS,
+              findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, &socketConnections[0], &remoteAddress, TRUE, &pIceCandidatePair));
+    EXPECT_TRUE(pIceCandidatePair == NULL);
+    EXPECT_EQ(STATUS_SUCCESS,
+              findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, &socketConnections[0], &remoteAddress, FALSE,
+                                                                         &pIceCandidatePair));
+    EXPECT_EQ(&iceCandidatePairs[1], pIceCandidatePair);
+
+    // Failed pairs are skipped
+    iceCandidatePairs[1].state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+    EXPECT_EQ(STATUS_SUCCESS,
+              findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, &socketConnections[0], &remoteAddress, FALSE,
+                                                                         &pIceCandidatePair));
+    EXPECT_EQ(&iceCandidatePairs[0], pIceCandidatePair);
+
+    iceAgentUnindexIceCandidatePair(&iceAgent, &iceCandidatePairs[0]);
+    EXPECT_FALSE(iceCandidatePairs[0].indexed);
+    EXPECT_EQ(STATUS_SUCCESS,
+              findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, &socketConnections[0], &remoteAddress, FALSE,
+                                                                         &pIceCandidatePair));
+    EXPECT_TRUE(pIceCandidatePair == NULL);
+    // Unindexing twice is harmless
+    iceAgentUnindexIceCandidatePair(&iceAgent, &iceCandidatePairs[0]);
+
+    iceAgentClearIceCandidatePairIndex(&iceAgent);
+    for (i = 0; i < ARRAY_SIZE(iceCandidatePairs); i++) {
+        EXPECT_FALSE(iceCandidatePairs[i].indexed);
+    }
+    EXPECT_EQ(STATUS_SUCCESS,
+              findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, &socketConnections[1], &remoteCandidates[2].ipAddress, TRUE,
+                                                                         &pIceCandidatePair));
+    EXPECT_TRUE(pIceCandidatePair == NULL);
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.iceCandidatePairs, FALSE));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.iceCandidatePairs));
+}
+
+TEST_F(IceFunctionalityTest, IceAgentSendPathUnitTest)
+{
+    IceAgent iceAgent;
+    SocketConnection socketConnection;
+    IceCandidate localCandidate, remoteCandidate;
+    IceCandidatePair iceCandidatePair;
+    RtcIceCandidatePairDiagnostics diagnostics;
+    PIceSendPath pSendPath = NULL, pPublishedSendPath = NULL;
+
+    MEMSET(&iceAgent, 0x00, SIZEOF(IceAgent));
+    MEMSET(&localCandidate, 0x00, SIZEOF(IceCandidate));
+    MEMSET(&remoteCandidate, 0x00, SIZEOF(IceCandidate));
+    MEMSET(&iceCandidatePair, 0x00, SIZEOF(IceCandidatePair));
+    MEMSET(&diagnostics, 0x00, SIZEOF(RtcIceCandidatePairDiagnostics));
+    iceAgent.sendPathLock = MUTEX_CREATE(FALSE);
+    iceAgent.sendPathReleasedCvar = CVAR_CREATE();
+
+    localCandidate.iceCandidateType = ICE_CANDIDATE_TYPE_HOST;
+    localCandidate.pSocketConnection = &socketConnection;
+    remoteCandidate.ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+    remoteCandidate.ipAddress.address[0] = 10;
+    remoteCandidate.ipAddress.address[3] = 1;
+    remoteCandidate.ipAddress.port = (UINT16) getInt16(1000);
+    iceCandidatePair.local = &localCandidate;
+    iceCandidatePair.remote = &remoteCandidate;
+    iceCandidatePair.state = ICE_CANDIDATE_PAIR_STATE_IN_PROGRESS;
+    iceCandidatePair.pRtcIceCandidatePairDiagnostics = &diagnostics;
+
+    // Nothing to send on until the selected pair succeeded
+    iceAgent.pDataSendingIceCandidatePair = &iceCandidatePair;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentUpdateSendPathLocked(&iceAgent));
+    iceAgentAcquireSendPath(&iceAgent, &pSendPath);
+    EXPECT_TRUE(pSendPath == NULL);
+
+    iceCandidatePair.state = ICE_CANDIDATE_PAIR_STATE_SUCCEEDED;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentUpdateSendPathLocked(&iceAgent));
+    iceAgentAcquireSendPath(&iceAgent, &pSendPath);
+    ASSERT_TRUE(pSendPath != NULL);
+    EXPECT_EQ(&socketConnection, pSendPath->pSocketConnection);
+    EXPECT_FALSE(pSendPath->isRelay);
+    EXPECT_TRUE(isSameIpAddress(&remoteCandidate.ipAddress, &pSendPath->remoteAddress, FALSE));
+    EXPECT_EQ(2, ATOMIC_LOAD(&pSendPath->refCount));
+    pPublishedSendPath = pSendPath;
+
+    ATOMIC_ADD(&pSendPath->packetsSent, 3);
+    ATOMIC_ADD(&pSendPath->bytesSent, 300);
+    ATOMIC_STORE(&pSendPath->lastDataSentTime, 1);
+    iceAgentReleaseSendPath(&iceAgent, &pSendPath);
+    EXPECT_TRUE(pSendPath == NULL);
+
+    // Nothing changed, the same snapshot stays published
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentUpdateSendPathLocked(&iceAgent));
+    EXPECT_EQ(pPublishedSendPath, iceAgent.pSendPath);
+
+    // Collecting exchanges the counters so they are accounted for once
+    iceSendPathCollectStats(iceAgent.pSendPath);
+    iceSendPathCollectStats(iceAgent.pSendPath);
+    EXPECT_EQ(3, diagnostics.packetsSent);
+    EXPECT_EQ(300, diagnostics.bytesSent);
+    EXPECT_EQ(pPublishedSendPath->publishTime, diagnostics.lastPacketSentTimestamp);
+
+    // A new remote address is a new snapshot, the replaced one stays retired until its sender is done
+    iceAgentAcquireSendPath(&iceAgent, &pSendPath);
+    remoteCandidate.ipAddress.port = (UINT16) getInt16(2000);
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentUpdateSendPathLocked(&iceAgent));
+    ASSERT_TRUE(iceAgent.pSendPath != NULL);
+    EXPECT_NE(pSendPath, iceAgent.pSendPath);
+    EXPECT_EQ(1, iceAgent.retiredSendPathCount);
+    iceAgentReleaseSendPath(&iceAgent, &pSendPath);
+    EXPECT_EQ(0, iceAgent.retiredSendPathCount);
+    iceAgentAwaitSendPathRelease(&iceAgent);
+    EXPECT_TRUE(isSameIpAddress(&remoteCandidate.ipAddress, &iceAgent.pSendPath->remoteAddress, FALSE));
+    ATOMIC_ADD(&iceAgent.pSendPath->packetsDiscarded, 2);
+    ATOMIC_ADD(&iceAgent.pSendPath->bytesDiscarded, 200);
+
+    // A failed pair unpublishes the snapshot, its counters are collected on the way out
+    iceCandidatePair.state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentUpdateSendPathLocked(&iceAgent));
+    EXPECT_TRUE(iceAgent.pSendPath == NULL);
+    EXPECT_EQ(2, diagnostics.packetsDiscardedOnSend);
+    EXPECT_EQ(200, diagnostics.bytesDiscardedOnSend);
+    EXPECT_EQ(ICE_CANDIDATE_PAIR_STATE_FAILED, diagnostics.state);
+
+    // Relayed pairs need their TURN connection
+    iceCandidatePair.state = ICE_CANDIDATE_PAIR_STATE_SUCCEEDED;
+    localCandidate.iceCandidateType = ICE_CANDIDATE_TYPE_RELAYED;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentUpdateSendPathLocked(&iceAgent));
+    EXPECT_TRUE(iceAgent.pSendPath == NULL);
+
+    localCandidate.iceCandidateType = ICE_CANDIDATE_TYPE_HOST;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentUpdateSendPathLocked(&iceAgent));
+    EXPECT_TRUE(iceAgent.pSendPath != NULL);
+
+    // Shutting down stops the senders
+    ATOMIC_STORE_BOOL(&iceAgent.shutdown, TRUE);
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentUpdateSendPathLocked(&iceAgent));
+    EXPECT_TRUE(iceAgent.pSendPath == NULL);
+
+    MUTEX_FREE(iceAgent.sendPathLock);
+    CVAR_FREE(iceAgent.sendPathReleasedCvar);
+}
+
+TEST_F(IceFunctionalityTest, TransactionIdStoreUnitTest)
+{
+    PTransactionIdStore pTransactionIdStore = NULL;
+    BYTE transactionIds[6][STUN_TRANSACTION_ID_LEN];
+    UINT32 i;
+
+    // All in the same bucket
+    for (i = 0; i < ARRAY_SIZE(transactionIds); i++) {
+        MEMSET(transactionIds[i], 0x00, STUN_TRANSACTION_ID_LEN);
+        transactionIds[i][STUN_TRANSACTION_ID_LEN - 1] = (BYTE) i;
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, createTransactionIdStore(4, &pTransactionIdStore));
+    for (i = 0; i < 4; i++) {
+        transactionIdStoreInsert(pTransactionIdStore, transactionIds[i]);
+    }
+    for (i = 0; i < 4; i++) {
+        EXPECT_TRUE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[i]));
+    }
+    EXPECT_FALSE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[4]));
+
+    // The oldest ids are overwritten
+    transactionIdStoreInsert(pTransactionIdStore, transactionIds[4]);
+    transactionIdStoreInsert(pTransactionIdStore, transactionIds[5]);
+    EXPECT_FALSE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[0]));
+    EXPECT_FALSE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[1]));
+    for (i = 2; i < 6; i++) {
+        EXPECT_TRUE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[i]));
+    }
+
+    transactionIdStoreRemove(pTransactionIdStore, transactionIds[3]);
+    EXPECT_FALSE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[3]));
+    EXPECT_TRUE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[2]));
+    EXPECT_TRUE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[4]));
+    transactionIdStoreRemove(pTransactionIdStore, transactionIds[3]);
+
+    // A removal does not change the ring order, the next id still overwrites the oldest one
+    transactionIdStoreInsert(pTransactionIdStore, transactionIds[0]);
+    EXPECT_TRUE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[0]));
+    EXPECT_FALSE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[2]));
+
+    transactionIdStoreClear(pTransactionIdStore);
+    for (i = 0; i < ARRAY_SIZE(transactionIds); i++) {
+        EXPECT_FALSE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[i]));
+    }
+    transactionIdStoreInsert(pTransactionIdStore, transactionIds[1]);
+    EXPECT_TRUE(transactionIdStoreHasId(pTransactionIdStore, transactionIds[1]));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeTransactionIdStore(&pTransactionIdStore));
+}
+
 TEST_F(IceFunctionalityTest, IceAgentCandidateGatheringTest)
 {
     ASSERT_EQ(TRUE, mAccessKeyIdSet);
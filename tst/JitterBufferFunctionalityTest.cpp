@@ -1851,6 +1851,175 @@ TEST_F(JitterBufferFunctionalityTest, LongRunningWithDroppedPacketsTest)
 }
 #endif
 
+TEST_F(JitterBufferFunctionalityTest, frameMissingStartAfterForcedDropIsDropped)
+{
+    UINT32 i;
+    UINT32 pktCount = 4;
+    initializeJitterBuffer(1, 2, pktCount);
+
+    // First frame "1" "2" at timestamp 100 - rtp packet #0 #1, its last packet #2 is lost
+    mPRtpPackets[0]->payloadLength = 1;
+    mPRtpPackets[0]->payload = (PBYTE) MEMALLOC(mPRtpPackets[0]->payloadLength + 1);
+    mPRtpPackets[0]->payload[0] = 1;
+    mPRtpPackets[0]->payload[1] = 1; // First packet of a frame
+    mPRtpPackets[0]->header.timestamp = 100;
+    mPRtpPackets[0]->header.sequenceNumber = 0;
+    mPRtpPackets[1]->payloadLength = 1;
+    mPRtpPackets[1]->payload = (PBYTE) MEMALLOC(mPRtpPackets[1]->payloadLength + 1);
+    mPRtpPackets[1]->payload[0] = 2;
+    mPRtpPackets[1]->payload[1] = 0; // Following packet of a frame
+    mPRtpPackets[1]->header.timestamp = 100;
+    mPRtpPackets[1]->header.sequenceNumber = 1;
+
+    // Second frame at timestamp 200 only has a following packet #3
+    mPRtpPackets[2]->payloadLength = 1;
+    mPRtpPackets[2]->payload = (PBYTE) MEMALLOC(mPRtpPackets[2]->payloadLength + 1);
+    mPRtpPackets[2]->payload[0] = 3;
+    mPRtpPackets[2]->payload[1] = 0; // Following packet of a frame
+    mPRtpPackets[2]->header.timestamp = 200;
+    mPRtpPackets[2]->header.sequenceNumber = 3;
+
+    // Third frame "4" at timestamp 3000 - rtp packet #4, far enough to force out the first two frames
+    mPRtpPackets[3]->payloadLength = 1;
+    mPRtpPackets[3]->payload = (PBYTE) MEMALLOC(mPRtpPackets[3]->payloadLength + 1);
+    mPRtpPackets[3]->payload[0] = 4;
+    mPRtpPackets[3]->payload[1] = 1; // First packet of a frame
+    mPRtpPackets[3]->header.timestamp = 3000;
+    mPRtpPackets[3]->header.sequenceNumber = 4;
+
+    // Both earlier frames are dropped, the second one must not inherit the start packet of the first one
+    mExpectedDroppedFrameTimestampArr[0] = 100;
+    mExpectedDroppedFrameTimestampArr[1] = 200;
+
+    // Expected to get frame "4" at close
+    mPExpectedFrameArr[0] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[0][0] = 4;
+    mExpectedFrameSizeArr[0] = 1;
+
+    setPayloadToFree();
+
+    for (i = 0; i < pktCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[i], nullptr));
+    }
+
+    clearJitterBufferForTest();
+}
+
+TEST_F(JitterBufferFunctionalityTest, largeFrameGrowsRing)
+{
+    UINT32 i;
+    UINT32 pktCount = 4 * JITTER_BUFFER_INITIAL_RING_CAPACITY + 1;
+    UINT16 startingSequenceNumber = MAX_UINT16 - JITTER_BUFFER_INITIAL_RING_CAPACITY;
+    initializeJitterBuffer(2, 0, pktCount);
+
+    // First frame spans more packets than the initial ring capacity and wraps the sequence numbers
+    mPExpectedFrameArr[0] = (PBYTE) MEMALLOC(pktCount - 1);
+    mExpectedFrameSizeArr[0] = pktCount - 1;
+    for (i = 0; i < pktCount - 1; i++) {
+        mPRtpPackets[i]->payloadLength = 1;
+        mPRtpPackets[i]->payload = (PBYTE) MEMALLOC(mPRtpPackets[i]->payloadLength + 1);
+        mPRtpPackets[i]->payload[0] = (BYTE) i;
+        mPRtpPackets[i]->payload[1] = (i == 0) ? 1 : 0;
+        mPRtpPackets[i]->header.timestamp = 100;
+        mPRtpPackets[i]->header.sequenceNumber = startingSequenceNumber++;
+        mPExpectedFrameArr[0][i] = (BYTE) i;
+    }
+
+    // Second frame "7" at timestamp 200 completes the first one
+    mPRtpPackets[i]->payloadLength = 1;
+    mPRtpPackets[i]->payload = (PBYTE) MEMALLOC(mPRtpPackets[i]->payloadLength + 1);
+    mPRtpPackets[i]->payload[0] = 7;
+    mPRtpPackets[i]->payload[1] = 1;
+    mPRtpPackets[i]->header.timestamp = 200;
+    mPRtpPackets[i]->header.sequenceNumber = startingSequenceNumber;
+    mPExpectedFrameArr[1] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[1][0] = 7;
+    mExpectedFrameSizeArr[1] = 1;
+
+    setPayloadToFree();
+
+    for (i = 0; i < pktCount - 1; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[i], nullptr));
+    }
+    EXPECT_EQ(0, mReadyFrameIndex);
+    EXPECT_LT(JITTER_BUFFER_INITIAL_RING_CAPACITY, mJitterBuffer->ringCapacity);
+
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[pktCount - 1], nullptr));
+    EXPECT_EQ(1, mReadyFrameIndex);
+
+    clearJitterBufferForTest();
+}
+
+TEST_F(JitterBufferFunctionalityTest, paddingKeepsFramesContinuous)
+{
+    UINT32 i;
+    UINT32 pktCount = 7;
+    BOOL discarded = FALSE;
+    initializeJitterBuffer(3, 0, pktCount);
+
+    // Packets #0 #1 #3 #6 carry frames "12", "3" and "4" at timestamps 100, 200 and 300. Packets #2, #4 and #5 are padding
+    // in between, their payload would be taken as the start of a frame otherwise.
+    for (i = 0; i < pktCount; i++) {
+        mPRtpPackets[i]->payloadLength = 1;
+        mPRtpPackets[i]->payload = (PBYTE) MEMALLOC(mPRtpPackets[i]->payloadLength + 1);
+        mPRtpPackets[i]->payload[0] = 9;
+        mPRtpPackets[i]->payload[1] = 1;
+    }
+    mPRtpPackets[0]->payload[0] = 1;
+    mPRtpPackets[0]->header.timestamp = 100;
+    mPRtpPackets[0]->header.sequenceNumber = 0;
+    mPRtpPackets[1]->payload[0] = 2;
+    mPRtpPackets[1]->payload[1] = 0;
+    mPRtpPackets[1]->header.timestamp = 100;
+    mPRtpPackets[1]->header.sequenceNumber = 1;
+    mPRtpPackets[2]->header.timestamp = 100;
+    mPRtpPackets[2]->header.sequenceNumber = 2;
+    mPRtpPackets[3]->payload[0] = 3;
+    mPRtpPackets[3]->header.timestamp = 200;
+    mPRtpPackets[3]->header.sequenceNumber = 3;
+    mPRtpPackets[4]->header.timestamp = 200;
+    mPRtpPackets[4]->header.sequenceNumber = 4;
+    // Late padding, behind the head by then
+    mPRtpPackets[5]->header.timestamp = 100;
+    mPRtpPackets[5]->header.sequenceNumber = 2;
+    mPRtpPackets[6]->payload[0] = 4;
+    mPRtpPackets[6]->header.timestamp = 300;
+    mPRtpPackets[6]->header.sequenceNumber = 5;
+
+    mPExpectedFrameArr[0] = (PBYTE) MEMALLOC(2);
+    mPExpectedFrameArr[0][0] = 1;
+    mPExpectedFrameArr[0][1] = 2;
+    mExpectedFrameSizeArr[0] = 2;
+    mPExpectedFrameArr[1] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[1][0] = 3;
+    mExpectedFrameSizeArr[1] = 1;
+    mPExpectedFrameArr[2] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[2][0] = 4;
+    mExpectedFrameSizeArr[2] = 1;
+
+    setPayloadToFree();
+
+    // The first frame waits for the padding that follows it
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[0], nullptr));
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[1], nullptr));
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[3], nullptr));
+    EXPECT_EQ(0, mReadyFrameIndex);
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPushPadding(mJitterBuffer, mPRtpPackets[2], &discarded));
+    EXPECT_FALSE(discarded);
+    EXPECT_EQ(1, mReadyFrameIndex);
+
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPushPadding(mJitterBuffer, mPRtpPackets[4], &discarded));
+    EXPECT_FALSE(discarded);
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[6], nullptr));
+    EXPECT_EQ(2, mReadyFrameIndex);
+
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPushPadding(mJitterBuffer, mPRtpPackets[5], &discarded));
+    EXPECT_TRUE(discarded);
+    EXPECT_EQ(0, mDroppedFrameIndex);
+
+    clearJitterBufferForTest();
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
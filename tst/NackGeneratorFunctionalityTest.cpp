@@ -0,0 +1,302 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define NACK_GENERATOR_TEST_START_TIME       HUNDREDS_OF_NANOS_IN_A_SECOND
+#define NACK_GENERATOR_TEST_SSRC             0x1234abcd
+#define NACK_GENERATOR_TEST_RTX_SSRC         0x4321dcba
+#define NACK_GENERATOR_TEST_PAYLOAD_TYPE     96
+#define NACK_GENERATOR_TEST_RTX_PAYLOAD_TYPE 97
+#define NACK_GENERATOR_TEST_TIMESTAMP        90000
+#define NACK_GENERATOR_TEST_PAYLOAD_LENGTH   100
+
+class NackGeneratorFunctionalityTest : public WebRtcClientTestBase {
+  public:
+    static std::vector<UINT16> nackedSequenceNumbers;
+    static volatile SIZE_T feedbackCount;
+    static UINT32 pliCount;
+
+    static STATUS sendFn(UINT64 customData, PUINT16 pSequenceNumbers, UINT32 sequenceNumberCount, BOOL sendPli)
+    {
+        UNUSED_PARAM(customData);
+
+        nackedSequenceNumbers.assign(pSequenceNumbers, pSequenceNumbers + sequenceNumberCount);
+        ATOMIC_INCREMENT(&feedbackCount);
+        if (sendPli) {
+            pliCount++;
+        }
+        return STATUS_SUCCESS;
+    }
+
+    VOID SetUp()
+    {
+        WebRtcClientTestBase::SetUp();
+        nackedSequenceNumbers.clear();
+        feedbackCount = 0;
+        pliCount = 0;
+    }
+
+    VOID receive(PNackGenerator pNackGenerator, UINT16 first, UINT16 last, UINT64 time)
+    {
+        UINT16 sequenceNumber = first;
+
+        do {
+            EXPECT_EQ(STATUS_SUCCESS, nackGeneratorOnPacket(pNackGenerator, sequenceNumber, time));
+        } while (sequenceNumber++ != last);
+    }
+
+    // Encrypts the packet the way the remote peer would and hands it to the receive path
+    VOID receivePacket(PKvsPeerConnection pKvsPeerConnection, UINT32 ssrc, UINT8 payloadType, UINT16 sequenceNumber, UINT32 timestamp,
+                       PBYTE pPayload, UINT32 payloadLength)
+    {
+        BYTE packet[MIN_HEADER_LENGTH + SIZEOF(UINT16) + NACK_GENERATOR_TEST_PAYLOAD_LENGTH + SRTP_AUTH_TAG_OVERHEAD];
+        UINT32 packetLength = SIZEOF(packet);
+        INT32 encryptedLength;
+        RtpPacket rtpPacket;
+
+        MEMSET(&rtpPacket, 0x00, SIZEOF(RtpPacket));
+        ASSERT_EQ(STATUS_SUCCESS,
+                  setRtpPacket(2, FALSE, FALSE, 0, TRUE, payloadType, sequenceNumber, timestamp, ssrc, NULL, 0, 0, NULL, pPayload, payloadLength,
+                               &rtpPacket));
+        ASSERT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(&rtpPacket, packet, &packetLength));
+        encryptedLength = (INT32) packetLength;
+        ASSERT_EQ(STATUS_SUCCESS, encryptRtpPacket(pKvsPeerConnection->pSrtpSession, packet, &encryptedLength));
+        EXPECT_EQ(STATUS_SUCCESS, sendPacketToRtpReceiver(pKvsPeerConnection, packet, (UINT32) encryptedLength));
+    }
+};
+
+std::vector<UINT16> NackGeneratorFunctionalityTest::nackedSequenceNumbers;
+volatile SIZE_T NackGeneratorFunctionalityTest::feedbackCount = 0;
+UINT32 NackGeneratorFunctionalityTest::pliCount = 0;
+
+typedef struct {
+    UINT32 frameCount;
+    UINT32 frameSizes[4];
+} NackTestReceivedFrames, *PNackTestReceivedFrames;
+
+VOID nackTestOnFrame(UINT64 customData, PFrame pFrame)
+{
+    PNackTestReceivedFrames pReceivedFrames = (PNackTestReceivedFrames) customData;
+
+    if (pReceivedFrames->frameCount < ARRAY_SIZE(pReceivedFrames->frameSizes)) {
+        pReceivedFrames->frameSizes[pReceivedFrames->frameCount] = pFrame->size;
+    }
+    pReceivedFrames->frameCount++;
+}
+
+TEST_F(NackGeneratorFunctionalityTest, gapsAreNackedOncePerRoundTrip)
+{
+    PNackGenerator pNackGenerator = NULL;
+    UINT64 time = NACK_GENERATOR_TEST_START_TIME, roundTripTime = 50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+
+    EXPECT_NE(STATUS_SUCCESS, createNackGenerator(INVALID_TIMER_QUEUE_HANDLE_VALUE, 0, 0, NULL, 0, &pNackGenerator));
+    EXPECT_EQ(STATUS_SUCCESS, createNackGenerator(INVALID_TIMER_QUEUE_HANDLE_VALUE, 0, 0, sendFn, 0, &pNackGenerator));
+    EXPECT_EQ(STATUS_SUCCESS, nackGeneratorSetRoundTripTime(pNackGenerator, roundTripTime));
+
+    // 3, 4 and 7 are missing
+    receive(pNackGenerator, 0, 2, time);
+    receive(pNackGenerator, 5, 6, time);
+    receive(pNackGenerator, 8, 8, time);
+    EXPECT_EQ(3, pNackGenerator->missingPacketCount);
+
+    // Not before reordering had a chance
+    EXPECT_EQ(STATUS_SUCCESS, nackGeneratorProcessAtTime(pNackGenerator, time));
+    EXPECT_EQ(0, feedbackCount);
+
+    // 4 was only reordered
+    receive(pNackGenerator, 4, 4, time);
+    time += NACK_GENERATOR_REORDERING_DELAY;
+    EXPECT_EQ(STATUS_SUCCESS, nackGeneratorProcessAtTime(pNackGenerator, time));
+    EXPECT_EQ(1, feedbackCount);
+    EXPECT_EQ((std::vector<UINT16>{3, 7}), nackedSequenceNumbers);
+
+    // Nothing new within a round trip
+    EXPECT_EQ(STATUS_SUCCESS, nackGeneratorProcessAtTime(pNackGenerator, time + roundTripTime - 1));
+    EXPECT_EQ(1, feedbackCount);
+
+    // The retransmission of 3 arrived, 7 is asked again
+    receive(pNackGenerator, 3, 3, time);
+    time += roundTripTime;
+    EXPECT_EQ(STATUS_SUCCESS, nackGeneratorProcessAtTime(pNackGenerator, time));
+    EXPECT_EQ(2, feedbackCount);
+    EXPECT_EQ((std::vector<UINT16>{7}), nackedSequenceNumbers);
+    EXPECT_EQ(0, pliCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeNackGenerator(&pNackGenerator));
+    EXPECT_TRUE(pNackGenerator == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, freeNackGenerator(&pNackGenerator));
+}
+
+TEST_F(NackGeneratorFunctionalityTest, sequenceNumberWrap)
+{
+    PNackGenerator pNackGenerator = NULL;
+    UINT64 time = NACK_GENERATOR_TEST_START_TIME;
+
+    EXPECT_EQ(STATUS_SUCCESS, createNackGenerator(INVALID_TIMER_QUEUE_HANDLE_VALUE, 0, 0, sendFn, 0, &pNackGenerator));
+
+    receive(pNackGenerator, 65530, 65533, time);
+    receive(pNackGenerator, 1, 2, time);
+    // Older than the highest, not a new gap
+    receive(pNackGenerator, 65000, 65000, time);
+
+    EXPECT_EQ(STATUS_SUCCESS, nackGeneratorProcessAtTime(pNackGenerator, time + NACK_GENERATOR_REORDERING_DELAY));
+    EXPECT_EQ((std::vector<UINT16>{65534, 65535, 0}), nackedSequenceNumbers);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeNackGenerator(&pNackGenerator));
+}
+
+TEST_F(NackGeneratorFunctionalityTest, unrecoveredPacketsEndInAPli)
+{
+    PNackGenerator pNackGenerator = NULL;
+    UINT64 time = NACK_GENERATOR_TEST_START_TIME;
+    UINT32 i;
+
+    // 2 retries, PLI after 3 packets given up on
+    EXPECT_EQ(STATUS_SUCCESS, createNackGenerator(INVALID_TIMER_QUEUE_HANDLE_VALUE, 2, 3, sendFn, 0, &pNackGenerator));
+
+    receive(pNackGenerator, 0, 0, time);
+    receive(pNackGenerator, 2, 2, time);
+    for (i = 0; i < 3; i++) {
+        time += NACK_GENERATOR_DEFAULT_ROUND_TRIP_TIME;
+        EXPECT_EQ(STATUS_SUCCESS, nackGeneratorProcessAtTime(pNackGenerator, time));
+    }
+    // Two NACKs then given up on, which is within the budget
+    EXPECT_EQ(2, feedbackCount);
+    EXPECT_EQ(0, pNackGenerator->missingPacketCount);
+    EXPECT_EQ(1, pNackGenerator->lostPacketCount);
+    EXPECT_EQ(0, pliCount);
+
+    // The jitter buffer drops the frames of two more missing packets
+    receive(pNackGenerator, 5, 5, time);
+    EXPECT_EQ(STATUS_SUCCESS, nackGeneratorDropUntil(pNackGenerator, 4));
+    EXPECT_EQ(0, pNackGenerator->missingPacketCount);
+    EXPECT_EQ(STATUS_SUCCESS, nackGeneratorProcessAtTime(pNackGenerator, time));
+    EXPECT_EQ(1, pliCount);
+    EXPECT_TRUE(nackedSequenceNumbers.empty());
+
+    // A burst bigger than what is tracked asks for a keyframe right away, but not sooner than the PLI interval
+    receive(pNackGenerator, 5 + NACK_GENERATOR_MAX_MISSING_PACKETS + 2, 5 + NACK_GENERATOR_MAX_MISSING_PACKETS + 2, time);
+    EXPECT_EQ(STATUS_SUCCESS, nackGeneratorProcessAtTime(pNackGenerator, time + 1));
+    EXPECT_EQ(1, pliCount);
+    EXPECT_EQ(STATUS_SUCCESS, nackGeneratorProcessAtTime(pNackGenerator, time + NACK_GENERATOR_MIN_PLI_INTERVAL));
+    EXPECT_EQ(2, pliCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeNackGenerator(&pNackGenerator));
+}
+
+TEST_F(NackGeneratorFunctionalityTest, timerSendsTheNacks)
+{
+    PNackGenerator pNackGenerator = NULL;
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    UINT64 timeout;
+
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueCreate(&timerQueueHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createNackGenerator(timerQueueHandle, 0, 0, sendFn, 0, &pNackGenerator));
+    receive(pNackGenerator, 0, 0, GETTIME());
+    receive(pNackGenerator, 2, 2, GETTIME());
+
+    timeout = GETTIME() + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    while (ATOMIC_LOAD(&feedbackCount) == 0 && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeNackGenerator(&pNackGenerator));
+    EXPECT_LE(1, feedbackCount);
+    EXPECT_EQ((std::vector<UINT16>{1}), nackedSequenceNumbers);
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueFree(&timerQueueHandle));
+}
+
+TEST_F(NackGeneratorFunctionalityTest, retransmissionFillsTheGap)
+{
+    BYTE key[30] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+                    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D};
+    BYTE payload[NACK_GENERATOR_TEST_PAYLOAD_LENGTH], rtxPayload[SIZEOF(UINT16) + NACK_GENERATOR_TEST_PAYLOAD_LENGTH];
+    RtcConfiguration configuration;
+    RtcMediaStreamTrack track;
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+    PKvsPeerConnection pKvsPeerConnection;
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    PSessionDescription pSessionDescription = NULL;
+    PSdpMediaDescription pMediaDescription;
+    NackTestReceivedFrames receivedFrames;
+    UINT32 i;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&receivedFrames, 0x00, SIZEOF(NackTestReceivedFrames));
+    ASSERT_EQ(STATUS_SUCCESS, createPeerConnection(&configuration, &pRtcPeerConnection));
+    pKvsPeerConnection = (PKvsPeerConnection) pRtcPeerConnection;
+    addTrackToPeerConnection(pRtcPeerConnection, &track, &pRtcRtpTransceiver,
+                             RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    ASSERT_TRUE(pRtcRtpTransceiver != NULL);
+    pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+    ASSERT_TRUE(pKvsRtpTransceiver->pNackGenerator != NULL);
+    EXPECT_EQ(STATUS_SUCCESS, transceiverOnFrame(pRtcRtpTransceiver, (UINT64) &receivedFrames, nackTestOnFrame));
+
+    // The RTX ssrc is listed first, the FID group tells it apart from the media ssrc
+    pSessionDescription = (PSessionDescription) MEMCALLOC(1, SIZEOF(SessionDescription));
+    ASSERT_TRUE(pSessionDescription != NULL);
+    pSessionDescription->mediaCount = 1;
+    pMediaDescription = &pSessionDescription->mediaDescriptions[0];
+    STRCPY(pMediaDescription->mediaName, "video 9 UDP/TLS/RTP/SAVPF 96 97");
+    STRCPY(pMediaDescription->sdpAttributes[0].attributeName, "ssrc");
+    SNPRINTF(pMediaDescription->sdpAttributes[0].attributeValue, MAX_SDP_ATTRIBUTE_VALUE_LENGTH, "%u cname:test", NACK_GENERATOR_TEST_RTX_SSRC);
+    STRCPY(pMediaDescription->sdpAttributes[1].attributeName, "ssrc-group");
+    SNPRINTF(pMediaDescription->sdpAttributes[1].attributeValue, MAX_SDP_ATTRIBUTE_VALUE_LENGTH, "FID %u %u", NACK_GENERATOR_TEST_SSRC,
+             NACK_GENERATOR_TEST_RTX_SSRC);
+    pMediaDescription->mediaAttributesCount = 2;
+    EXPECT_EQ(STATUS_SUCCESS, setReceiversSsrc(pSessionDescription, pKvsPeerConnection->pTransceivers, pKvsPeerConnection->pSsrcTable));
+    EXPECT_EQ(NACK_GENERATOR_TEST_SSRC, pKvsRtpTransceiver->jitterBufferSsrc);
+    EXPECT_EQ(NACK_GENERATOR_TEST_RTX_SSRC, pKvsRtpTransceiver->jitterBufferRtxSsrc);
+    MEMFREE(pSessionDescription);
+
+    // What the negotiation and the DTLS handshake would have set up
+    pKvsRtpTransceiver->sender.payloadType = NACK_GENERATOR_TEST_PAYLOAD_TYPE;
+    pKvsRtpTransceiver->sender.rtxPayloadType = NACK_GENERATOR_TEST_RTX_PAYLOAD_TYPE;
+    pKvsPeerConnection->rtxAptPayloadTypes[NACK_GENERATOR_TEST_RTX_PAYLOAD_TYPE] = NACK_GENERATOR_TEST_PAYLOAD_TYPE;
+    EXPECT_EQ(STATUS_SUCCESS, initSrtpSession(key, key, KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, &pKvsPeerConnection->pSrtpSession));
+
+    // Single NAL unit frames, the second one is lost and waited for
+    payload[0] = 0x41;
+    for (i = 1; i < NACK_GENERATOR_TEST_PAYLOAD_LENGTH; i++) {
+        payload[i] = (BYTE) i;
+    }
+    receivePacket(pKvsPeerConnection, NACK_GENERATOR_TEST_SSRC, NACK_GENERATOR_TEST_PAYLOAD_TYPE, 100, NACK_GENERATOR_TEST_TIMESTAMP, payload,
+                  NACK_GENERATOR_TEST_PAYLOAD_LENGTH);
+    receivePacket(pKvsPeerConnection, NACK_GENERATOR_TEST_SSRC, NACK_GENERATOR_TEST_PAYLOAD_TYPE, 102, NACK_GENERATOR_TEST_TIMESTAMP + 6000, payload,
+                  NACK_GENERATOR_TEST_PAYLOAD_LENGTH);
+    receivePacket(pKvsPeerConnection, NACK_GENERATOR_TEST_SSRC, NACK_GENERATOR_TEST_PAYLOAD_TYPE, 103, NACK_GENERATOR_TEST_TIMESTAMP + 9000, payload,
+                  NACK_GENERATOR_TEST_PAYLOAD_LENGTH);
+    EXPECT_EQ(0, receivedFrames.frameCount);
+    EXPECT_EQ(1, pKvsRtpTransceiver->pNackGenerator->missingPacketCount);
+
+    // A probe without any payload on the RTX ssrc retransmits nothing
+    receivePacket(pKvsPeerConnection, NACK_GENERATOR_TEST_RTX_SSRC, NACK_GENERATOR_TEST_RTX_PAYLOAD_TYPE, 5000, NACK_GENERATOR_TEST_TIMESTAMP,
+                  NULL, 0);
+    EXPECT_EQ(1, pKvsRtpTransceiver->pNackGenerator->missingPacketCount);
+
+    // The retransmission starts with the original sequence number, https://tools.ietf.org/html/rfc4588#section-4
+    putUnalignedInt16BigEndian(rtxPayload, 101);
+    MEMCPY(rtxPayload + SIZEOF(UINT16), payload, NACK_GENERATOR_TEST_PAYLOAD_LENGTH);
+    receivePacket(pKvsPeerConnection, NACK_GENERATOR_TEST_RTX_SSRC, NACK_GENERATOR_TEST_RTX_PAYLOAD_TYPE, 5001, NACK_GENERATOR_TEST_TIMESTAMP + 3000,
+                  rtxPayload, SIZEOF(rtxPayload));
+    EXPECT_EQ(0, pKvsRtpTransceiver->pNackGenerator->missingPacketCount);
+
+    // The frame of the last packet waits for the next one, Annex-B start code in front of every NAL unit
+    EXPECT_EQ(3, receivedFrames.frameCount);
+    for (i = 0; i < 3; i++) {
+        EXPECT_EQ(4 + NACK_GENERATOR_TEST_PAYLOAD_LENGTH, receivedFrames.frameSizes[i]);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
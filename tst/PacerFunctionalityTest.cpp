@@ -0,0 +1,196 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define PACER_TEST_PACKET_SIZE 1000
+
+class PacerFunctionalityTest : public WebRtcClientTestBase {
+  public:
+    static std::vector<UINT64> sentPackets;
+    static UINT64 sentBytes;
+
+    static STATUS sendPacketsFn(UINT64 customData, PPacedPacket pPacedPackets, UINT32 packetCount)
+    {
+        UINT32 i;
+        UNUSED_PARAM(customData);
+
+        for (i = 0; i < packetCount; i++) {
+            sentPackets.push_back(pPacedPackets[i].customData);
+            sentBytes += pPacedPackets[i].pRtpPacketBuffer->packet.rawPacketLength;
+        }
+        return STATUS_SUCCESS;
+    }
+
+    VOID enqueuePackets(PPacer pPacer, UINT32 count, UINT64 customData, PACER_PRIORITY priority)
+    {
+        PRtpPacketBuffer pRtpPacketBuffer = NULL;
+        UINT32 i;
+
+        for (i = 0; i < count; i++) {
+            EXPECT_EQ(STATUS_SUCCESS, createRtpPacketBuffer(0, PACER_TEST_PACKET_SIZE, 0, &pRtpPacketBuffer));
+            EXPECT_EQ(STATUS_SUCCESS, pacerEnqueue(pPacer, pRtpPacketBuffer, customData, priority));
+            // The pacer holds its own reference
+            EXPECT_EQ(STATUS_SUCCESS, rtpPacketBufferRelease(&pRtpPacketBuffer));
+        }
+    }
+
+    VOID SetUp()
+    {
+        WebRtcClientTestBase::SetUp();
+        sentPackets.clear();
+        sentBytes = 0;
+    }
+};
+
+std::vector<UINT64> PacerFunctionalityTest::sentPackets;
+UINT64 PacerFunctionalityTest::sentBytes = 0;
+
+TEST_F(PacerFunctionalityTest, audioThenRetransmissionsThenVideo)
+{
+    PPacer pPacer = NULL;
+    UINT64 startTime;
+
+    EXPECT_EQ(STATUS_SUCCESS, createPacer(INVALID_TIMER_QUEUE_HANDLE_VALUE, 1000000, sendPacketsFn, 0, &pPacer));
+    startTime = pPacer->lastBudgetUpdateTime;
+
+    enqueuePackets(pPacer, 1, PACER_PRIORITY_VIDEO, PACER_PRIORITY_VIDEO);
+    enqueuePackets(pPacer, 1, PACER_PRIORITY_RETRANSMISSION, PACER_PRIORITY_RETRANSMISSION);
+    enqueuePackets(pPacer, 1, PACER_PRIORITY_AUDIO, PACER_PRIORITY_AUDIO);
+
+    // No budget yet, only audio is let through
+    EXPECT_EQ(STATUS_SUCCESS, pacerProcessAtTime(pPacer, startTime));
+    EXPECT_EQ(1, sentPackets.size());
+
+    EXPECT_EQ(STATUS_SUCCESS, pacerProcessAtTime(pPacer, startTime + PACER_MAX_BURST_DURATION));
+    EXPECT_EQ(3, sentPackets.size());
+    EXPECT_EQ(PACER_PRIORITY_AUDIO, sentPackets[0]);
+    EXPECT_EQ(PACER_PRIORITY_RETRANSMISSION, sentPackets[1]);
+    EXPECT_EQ(PACER_PRIORITY_VIDEO, sentPackets[2]);
+
+    EXPECT_EQ(STATUS_SUCCESS, freePacer(&pPacer));
+    EXPECT_TRUE(pPacer == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, freePacer(&pPacer));
+}
+
+TEST_F(PacerFunctionalityTest, packetsLeaveAtThePacingRate)
+{
+    PPacer pPacer = NULL;
+    UINT64 startTime, time;
+    UINT32 queuedPackets = 0;
+    UINT64 queuedBytes = 0;
+    // Bytes per second the queue is drained at
+    DOUBLE pacingRate = 1000000 * PACER_PACING_FACTOR / 8;
+
+    EXPECT_EQ(STATUS_SUCCESS, createPacer(INVALID_TIMER_QUEUE_HANDLE_VALUE, 1000000, sendPacketsFn, 0, &pPacer));
+    startTime = pPacer->lastBudgetUpdateTime;
+
+    // A big keyframe
+    enqueuePackets(pPacer, 100, 0, PACER_PRIORITY_VIDEO);
+    EXPECT_EQ(STATUS_SUCCESS, pacerGetQueueDepth(pPacer, &queuedPackets, &queuedBytes));
+    EXPECT_EQ(100, queuedPackets);
+    EXPECT_EQ(100 * PACER_TEST_PACKET_SIZE, queuedBytes);
+
+    for (time = startTime; time <= startTime + 100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND; time += PACER_PROCESS_INTERVAL) {
+        EXPECT_EQ(STATUS_SUCCESS, pacerProcessAtTime(pPacer, time));
+    }
+
+    // Within a packet of what 100ms at the pacing rate allows, instead of the whole frame at once
+    EXPECT_GE(sentBytes, (UINT64) (pacingRate / 10) - PACER_TEST_PACKET_SIZE);
+    EXPECT_LE(sentBytes, (UINT64) (pacingRate / 10) + PACER_TEST_PACKET_SIZE);
+    EXPECT_EQ(STATUS_SUCCESS, pacerGetQueueDepth(pPacer, &queuedPackets, NULL));
+    EXPECT_EQ(100 - sentPackets.size(), queuedPackets);
+
+    for (; time <= startTime + 500 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND; time += PACER_PROCESS_INTERVAL) {
+        EXPECT_EQ(STATUS_SUCCESS, pacerProcessAtTime(pPacer, time));
+    }
+    EXPECT_EQ(100, sentPackets.size());
+
+    // An idle period does not build up more than a burst worth of budget
+    sentBytes = 0;
+    time += HUNDREDS_OF_NANOS_IN_A_SECOND;
+    enqueuePackets(pPacer, 100, 0, PACER_PRIORITY_VIDEO);
+    EXPECT_EQ(STATUS_SUCCESS, pacerProcessAtTime(pPacer, time));
+    EXPECT_LE(sentBytes, (UINT64) (pacingRate * PACER_MAX_BURST_DURATION / HUNDREDS_OF_NANOS_IN_A_SECOND) + PACER_TEST_PACKET_SIZE);
+
+    // Dropped along with the pacer
+    EXPECT_EQ(STATUS_SUCCESS, freePacer(&pPacer));
+}
+
+TEST_F(PacerFunctionalityTest, deepQueueIsDrainedFasterThanTheTarget)
+{
+    PPacer pPacer = NULL;
+    UINT64 startTime, time;
+
+    // 100 kbps would need 6.4s for this queue at the pacing rate
+    EXPECT_EQ(STATUS_SUCCESS, createPacer(INVALID_TIMER_QUEUE_HANDLE_VALUE, 100000, sendPacketsFn, 0, &pPacer));
+    startTime = pPacer->lastBudgetUpdateTime;
+    enqueuePackets(pPacer, 200, 0, PACER_PRIORITY_VIDEO);
+
+    for (time = startTime; time <= startTime + 100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND; time += PACER_PROCESS_INTERVAL) {
+        EXPECT_EQ(STATUS_SUCCESS, pacerProcessAtTime(pPacer, time));
+    }
+    EXPECT_GT(sentBytes, (UINT64) (100000 * PACER_PACING_FACTOR / 8 / 10) * 4);
+
+    // A lower target only applies to what is earned from now on
+    EXPECT_EQ(STATUS_SUCCESS, pacerSetTargetBitrate(pPacer, 50000));
+    EXPECT_EQ(50000, pPacer->targetBitrate);
+    EXPECT_EQ(STATUS_SUCCESS, pacerSetTargetBitrate(pPacer, 0));
+    EXPECT_EQ(50000, pPacer->targetBitrate);
+
+    EXPECT_EQ(STATUS_SUCCESS, freePacer(&pPacer));
+}
+
+TEST_F(PacerFunctionalityTest, fullQueueRejectsPackets)
+{
+    PPacer pPacer = NULL;
+    PRtpPacketBuffer pRtpPacketBuffer = NULL;
+    UINT32 queuedPackets = 0;
+
+    EXPECT_EQ(STATUS_SUCCESS, createPacer(INVALID_TIMER_QUEUE_HANDLE_VALUE, 1000000, sendPacketsFn, 0, &pPacer));
+    enqueuePackets(pPacer, PACER_MAX_QUEUE_CAPACITY, 0, PACER_PRIORITY_VIDEO);
+
+    // The packet is left to the caller, the other queues still take packets
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketBuffer(0, PACER_TEST_PACKET_SIZE, 0, &pRtpPacketBuffer));
+    EXPECT_EQ(STATUS_RTP_PACER_QUEUE_FULL, pacerEnqueue(pPacer, pRtpPacketBuffer, 0, PACER_PRIORITY_VIDEO));
+    EXPECT_EQ(1, ATOMIC_LOAD(&pRtpPacketBuffer->refCount));
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketBufferRelease(&pRtpPacketBuffer));
+    enqueuePackets(pPacer, 1, 0, PACER_PRIORITY_AUDIO);
+
+    EXPECT_EQ(STATUS_SUCCESS, pacerGetQueueDepth(pPacer, &queuedPackets, NULL));
+    EXPECT_EQ(PACER_MAX_QUEUE_CAPACITY + 1, queuedPackets);
+
+    EXPECT_EQ(STATUS_SUCCESS, freePacer(&pPacer));
+}
+
+TEST_F(PacerFunctionalityTest, timerDrainsTheQueues)
+{
+    PPacer pPacer = NULL;
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    UINT32 queuedPackets = 1;
+    UINT64 timeout;
+
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueCreate(&timerQueueHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createPacer(timerQueueHandle, 10000000, sendPacketsFn, 0, &pPacer));
+    enqueuePackets(pPacer, 50, 0, PACER_PRIORITY_VIDEO);
+
+    timeout = GETTIME() + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    while (queuedPackets != 0 && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        EXPECT_EQ(STATUS_SUCCESS, pacerGetQueueDepth(pPacer, &queuedPackets, NULL));
+    }
+    EXPECT_EQ(0, queuedPackets);
+
+    EXPECT_EQ(STATUS_SUCCESS, freePacer(&pPacer));
+    EXPECT_EQ(50, sentPackets.size());
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueFree(&timerQueueHandle));
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
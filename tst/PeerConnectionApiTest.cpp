@@ -35,6 +35,18 @@ TEST_F(PeerConnectionApiTest, deserializeRtcIceCandidateInit)
     EXPECT_STREQ(rtcIceCandidateInit.candidate, "candidate: 1 2 3");
 }
 
+TEST_F(PeerConnectionApiTest, failedInitCanBeRetried)
+{
+    EXPECT_EQ(STATUS_SUCCESS, deinitKvsWebRtc());
+
+    // The last shared service can not be created, the ones before it must not be left behind
+    EXPECT_EQ(STATUS_SUCCESS, createEgressBandwidthManager());
+    EXPECT_NE(STATUS_SUCCESS, initKvsWebRtc());
+    EXPECT_EQ(STATUS_SUCCESS, freeEgressBandwidthManager());
+
+    EXPECT_EQ(STATUS_SUCCESS, initKvsWebRtc());
+}
+
 TEST_F(PeerConnectionApiTest, serializeSessionDescriptionInit)
 {
     RtcSessionDescriptionInit rtcSessionDescriptionInit;
@@ -197,6 +209,99 @@ TEST_F(PeerConnectionApiTest, connectionState)
     freePeerConnection(&pc);
 }
 
+TEST_F(PeerConnectionApiTest, rtpBroadcastGroupApis)
+{
+    PRtcPeerConnection pc = nullptr;
+    RtcConfiguration config{};
+    RtcMediaStreamTrack videoTrack, audioTrack;
+    PRtcRtpTransceiver videoTransceiver, audioTransceiver;
+    RTP_BROADCAST_GROUP_HANDLE groupHandle = INVALID_RTP_BROADCAST_GROUP_HANDLE_VALUE;
+    BYTE frameData[16] = {0};
+    Frame frame{};
+
+    frame.frameData = frameData;
+    frame.size = SIZEOF(frameData);
+
+    EXPECT_EQ(STATUS_NULL_ARG, createRtpBroadcastGroup(RTC_CODEC_VP8, NULL));
+    EXPECT_EQ(STATUS_INVALID_ARG, createRtpBroadcastGroup(RTC_CODEC_UNKNOWN, &groupHandle));
+    EXPECT_FALSE(IS_VALID_RTP_BROADCAST_GROUP_HANDLE(groupHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createRtpBroadcastGroup(RTC_CODEC_VP8, &groupHandle));
+    EXPECT_TRUE(IS_VALID_RTP_BROADCAST_GROUP_HANDLE(groupHandle));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&config, &pc));
+    addTrackToPeerConnection(pc, &videoTrack, &videoTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    addTrackToPeerConnection(pc, &audioTrack, &audioTransceiver, RTC_CODEC_OPUS, MEDIA_STREAM_TRACK_KIND_AUDIO);
+
+    EXPECT_EQ(STATUS_NULL_ARG, broadcastGroupAddTransceiver(INVALID_RTP_BROADCAST_GROUP_HANDLE_VALUE, videoTransceiver));
+    EXPECT_EQ(STATUS_NULL_ARG, broadcastGroupAddTransceiver(groupHandle, NULL));
+    EXPECT_EQ(STATUS_RTP_BROADCAST_GROUP_CODEC_MISMATCH, broadcastGroupAddTransceiver(groupHandle, audioTransceiver));
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupAddTransceiver(groupHandle, videoTransceiver));
+    EXPECT_EQ(STATUS_RTP_BROADCAST_GROUP_ALREADY_MEMBER, broadcastGroupAddTransceiver(groupHandle, videoTransceiver));
+
+    // Not connected yet, the frame is dropped like writeFrame would
+    EXPECT_EQ(STATUS_NULL_ARG, broadcastGroupWriteFrame(groupHandle, NULL));
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &frame));
+
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupRemoveTransceiver(groupHandle, videoTransceiver));
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupRemoveTransceiver(groupHandle, videoTransceiver));
+    EXPECT_EQ(STATUS_SUCCESS, broadcastGroupWriteFrame(groupHandle, &frame));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpBroadcastGroup(&groupHandle));
+    EXPECT_FALSE(IS_VALID_RTP_BROADCAST_GROUP_HANDLE(groupHandle));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpBroadcastGroup(&groupHandle));
+
+    closePeerConnection(pc);
+    freePeerConnection(&pc);
+}
+
+TEST_F(PeerConnectionApiTest, pacerTargetBitrate)
+{
+    PRtcPeerConnection pc = nullptr;
+    RtcConfiguration config{};
+
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&config, &pc));
+    EXPECT_EQ(STATUS_NULL_ARG, peerConnectionSetPacerTargetBitrate(NULL, 500000));
+    // Pacing is opt-in
+    EXPECT_EQ(STATUS_INVALID_OPERATION, peerConnectionSetPacerTargetBitrate(pc, 500000));
+    closePeerConnection(pc);
+    freePeerConnection(&pc);
+
+    config.kvsRtcConfiguration.enablePacer = TRUE;
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&config, &pc));
+    EXPECT_EQ(DEFAULT_PACER_TARGET_BITRATE, ((PKvsPeerConnection) pc)->pPacer->targetBitrate);
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionSetPacerTargetBitrate(pc, 500000));
+    EXPECT_EQ(500000, ((PKvsPeerConnection) pc)->pPacer->targetBitrate);
+    closePeerConnection(pc);
+    freePeerConnection(&pc);
+}
+
+TEST_F(PeerConnectionApiTest, onTargetBitrate)
+{
+    PRtcPeerConnection pc = nullptr;
+    RtcConfiguration config{};
+    RtcOnTargetBitrate onTargetBitrate = [](UINT64 customData, UINT64 targetBitrate) {
+        UNUSED_PARAM(customData);
+        UNUSED_PARAM(targetBitrate);
+    };
+
+    config.kvsRtcConfiguration.enablePacer = TRUE;
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&config, &pc));
+    // Starts from the pacer rate
+    EXPECT_EQ(DEFAULT_PACER_TARGET_BITRATE, ((PKvsPeerConnection) pc)->pCongestionController->targetBitrate);
+    EXPECT_EQ(STATUS_NULL_ARG, peerConnectionOnTargetBitrate(NULL, 0, onTargetBitrate));
+    EXPECT_EQ(STATUS_NULL_ARG, peerConnectionOnTargetBitrate(pc, 0, NULL));
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionOnTargetBitrate(pc, 0, onTargetBitrate));
+    closePeerConnection(pc);
+    freePeerConnection(&pc);
+
+    // No feedback to estimate from
+    config.kvsRtcConfiguration.disableSenderSideBandwidthEstimation = TRUE;
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&config, &pc));
+    EXPECT_EQ(STATUS_INVALID_OPERATION, peerConnectionOnTargetBitrate(pc, 0, onTargetBitrate));
+    closePeerConnection(pc);
+    freePeerConnection(&pc);
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
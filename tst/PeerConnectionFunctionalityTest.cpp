@@ -820,6 +820,129 @@ TEST_F(PeerConnectionFunctionalityTest, exchangeMedia)
     EXPECT_EQ(ATOMIC_LOAD(&seenVideo), 1);
 }
 
+// One frame written to a broadcast group reaches every viewer
+TEST_F(PeerConnectionFunctionalityTest, exchangeMediaThroughBroadcastGroup)
+{
+    auto const frameBufferSize = 200000;
+    auto const viewerCount = 2;
+
+    RtcConfiguration configuration;
+    PRtcPeerConnection offerPc[viewerCount] = {NULL}, answerPc[viewerCount] = {NULL};
+    RtcMediaStreamTrack offerVideoTrack[viewerCount], answerVideoTrack[viewerCount];
+    PRtcRtpTransceiver offerVideoTransceiver[viewerCount], answerVideoTransceiver[viewerCount];
+    SIZE_T seenVideo[viewerCount] = {0};
+    RTP_BROADCAST_GROUP_HANDLE groupHandle = INVALID_RTP_BROADCAST_GROUP_HANDLE_VALUE;
+    Frame videoFrame;
+    auto i = 0;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&videoFrame, 0x00, SIZEOF(Frame));
+
+    videoFrame.frameData = (PBYTE) MEMALLOC(frameBufferSize);
+    videoFrame.size = TEST_VIDEO_FRAME_SIZE;
+    MEMSET(videoFrame.frameData, 0x11, videoFrame.size);
+
+    auto onFrameHandler = [](UINT64 customData, PFrame pFrame) -> void {
+        UNUSED_PARAM(pFrame);
+        ATOMIC_STORE((PSIZE_T) customData, 1);
+    };
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpBroadcastGroup(RTC_CODEC_VP8, &groupHandle));
+
+    for (i = 0; i < viewerCount; i++) {
+        EXPECT_EQ(createPeerConnection(&configuration, &offerPc[i]), STATUS_SUCCESS);
+        EXPECT_EQ(createPeerConnection(&configuration, &answerPc[i]), STATUS_SUCCESS);
+        addTrackToPeerConnection(offerPc[i], &offerVideoTrack[i], &offerVideoTransceiver[i], RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+        addTrackToPeerConnection(answerPc[i], &answerVideoTrack[i], &answerVideoTransceiver[i], RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+        EXPECT_EQ(transceiverOnFrame(answerVideoTransceiver[i], (UINT64) &seenVideo[i], onFrameHandler), STATUS_SUCCESS);
+        EXPECT_EQ(connectTwoPeers(offerPc[i], answerPc[i]), TRUE);
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupAddTransceiver(groupHandle, offerVideoTransceiver[i]));
+    }
+
+    for (i = 0; i <= 1000 && (ATOMIC_LOAD(&seenVideo[0]) != 1 || ATOMIC_LOAD(&seenVideo[1]) != 1); i++) {
+        EXPECT_EQ(broadcastGroupWriteFrame(groupHandle, &videoFrame), STATUS_SUCCESS);
+        videoFrame.presentationTs += (HUNDREDS_OF_NANOS_IN_A_SECOND / 25);
+
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    MEMFREE(videoFrame.frameData);
+
+    for (i = 0; i < viewerCount; i++) {
+        RtcOutboundRtpStreamStats stats{};
+        EXPECT_EQ(STATUS_SUCCESS, getRtpOutboundStats(offerPc[i], offerVideoTransceiver[i], &stats));
+        EXPECT_LE(1, stats.framesSent);
+        EXPECT_EQ(ATOMIC_LOAD(&seenVideo[i]), 1);
+
+        EXPECT_EQ(STATUS_SUCCESS, broadcastGroupRemoveTransceiver(groupHandle, offerVideoTransceiver[i]));
+        closePeerConnection(offerPc[i]);
+        closePeerConnection(answerPc[i]);
+        freePeerConnection(&offerPc[i]);
+        freePeerConnection(&answerPc[i]);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpBroadcastGroup(&groupHandle));
+}
+
+// Inbound media of the answer is decrypted and depacketized on the receive workers
+TEST_F(PeerConnectionFunctionalityTest, exchangeMediaThroughReceiveWorkers)
+{
+    auto const frameBufferSize = 200000;
+
+    RtcConfiguration configuration;
+    PRtcPeerConnection offerPc = NULL, answerPc = NULL;
+    RtcMediaStreamTrack offerVideoTrack, answerVideoTrack;
+    PRtcRtpTransceiver offerVideoTransceiver, answerVideoTransceiver;
+    SIZE_T seenVideo = 0;
+    Frame videoFrame;
+    PeerConnectionMetrics peerConnectionMetrics;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    MEMSET(&videoFrame, 0x00, SIZEOF(Frame));
+    MEMSET(&peerConnectionMetrics, 0x00, SIZEOF(PeerConnectionMetrics));
+
+    videoFrame.frameData = (PBYTE) MEMALLOC(frameBufferSize);
+    videoFrame.size = TEST_VIDEO_FRAME_SIZE;
+    MEMSET(videoFrame.frameData, 0x11, videoFrame.size);
+
+    EXPECT_EQ(createPeerConnection(&configuration, &offerPc), STATUS_SUCCESS);
+    configuration.kvsRtcConfiguration.useReceiveWorkerPool = TRUE;
+    EXPECT_EQ(createPeerConnection(&configuration, &answerPc), STATUS_SUCCESS);
+    ASSERT_TRUE(((PKvsPeerConnection) answerPc)->pReceiveQueue != NULL);
+
+    addTrackToPeerConnection(offerPc, &offerVideoTrack, &offerVideoTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+    addTrackToPeerConnection(answerPc, &answerVideoTrack, &answerVideoTransceiver, RTC_CODEC_VP8, MEDIA_STREAM_TRACK_KIND_VIDEO);
+
+    auto onFrameHandler = [](UINT64 customData, PFrame pFrame) -> void {
+        UNUSED_PARAM(pFrame);
+        ATOMIC_STORE((PSIZE_T) customData, 1);
+    };
+    EXPECT_EQ(transceiverOnFrame(answerVideoTransceiver, (UINT64) &seenVideo, onFrameHandler), STATUS_SUCCESS);
+
+    EXPECT_EQ(connectTwoPeers(offerPc, answerPc), TRUE);
+
+    for (auto i = 0; i <= 1000 && ATOMIC_LOAD(&seenVideo) != 1; i++) {
+        EXPECT_EQ(writeFrame(offerVideoTransceiver, &videoFrame), STATUS_SUCCESS);
+        videoFrame.presentationTs += (HUNDREDS_OF_NANOS_IN_A_SECOND / 25);
+
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    MEMFREE(videoFrame.frameData);
+
+    EXPECT_EQ(STATUS_SUCCESS, peerConnectionGetMetrics(answerPc, &peerConnectionMetrics));
+    EXPECT_LE(1, peerConnectionMetrics.peerConnectionStats.receiveQueueMaxDepth);
+    EXPECT_GE(RECEIVE_WORKER_QUEUE_CAPACITY, peerConnectionMetrics.peerConnectionStats.receiveQueueDepth);
+
+    closePeerConnection(offerPc);
+    closePeerConnection(answerPc);
+
+    freePeerConnection(&offerPc);
+    freePeerConnection(&answerPc);
+
+    EXPECT_EQ(ATOMIC_LOAD(&seenVideo), 1);
+}
+
 // Same test as exchangeMedia, but assert that if one side is RSA DTLS and Key Extraction works
 TEST_F(PeerConnectionFunctionalityTest, exchangeMediaRSA)
 {
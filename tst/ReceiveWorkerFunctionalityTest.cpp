@@ -0,0 +1,284 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+typedef struct {
+    volatile SIZE_T processedCount;
+    volatile ATOMIC_BOOL outOfOrder;
+    volatile ATOMIC_BOOL onPushingThread;
+    volatile ATOMIC_BOOL blocked;
+    volatile ATOMIC_BOOL processedAfterFree;
+    volatile ATOMIC_BOOL freed;
+    TID pushingThread;
+} ReceiveWorkerTestData, *PReceiveWorkerTestData;
+
+// Every packet carries its index
+STATUS receiveWorkerTestProcess(UINT64 customData, PBYTE pBuffer, UINT32 length)
+{
+    PReceiveWorkerTestData pTestData = (PReceiveWorkerTestData) customData;
+
+    while (ATOMIC_LOAD_BOOL(&pTestData->blocked)) {
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    if (ATOMIC_LOAD_BOOL(&pTestData->freed)) {
+        ATOMIC_STORE_BOOL(&pTestData->processedAfterFree, TRUE);
+    }
+    if (GETTID() == pTestData->pushingThread) {
+        ATOMIC_STORE_BOOL(&pTestData->onPushingThread, TRUE);
+    }
+    if (length != SIZEOF(UINT32) || *(PUINT32) pBuffer != (UINT32) ATOMIC_LOAD(&pTestData->processedCount)) {
+        ATOMIC_STORE_BOOL(&pTestData->outOfOrder, TRUE);
+    }
+
+    ATOMIC_INCREMENT(&pTestData->processedCount);
+    return STATUS_SUCCESS;
+}
+
+typedef struct {
+    PReceiveQueue pReceiveQueue;
+    volatile SIZE_T processedCount;
+    volatile ATOMIC_BOOL blocked;
+} ReceiveWorkerSelfFreeTestData, *PReceiveWorkerSelfFreeTestData;
+
+// Frees its own queue like an onFrame callback freeing its PeerConnection
+STATUS receiveWorkerTestSelfFree(UINT64 customData, PBYTE pBuffer, UINT32 length)
+{
+    UNUSED_PARAM(pBuffer);
+    UNUSED_PARAM(length);
+    PReceiveWorkerSelfFreeTestData pTestData = (PReceiveWorkerSelfFreeTestData) customData;
+
+    while (ATOMIC_LOAD_BOOL(&pTestData->blocked)) {
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    ATOMIC_INCREMENT(&pTestData->processedCount);
+    return freeReceiveQueue(&pTestData->pReceiveQueue);
+}
+
+class ReceiveWorkerFunctionalityTest : public WebRtcClientTestBase {
+  public:
+    VOID initTestData(PReceiveWorkerTestData pTestData)
+    {
+        MEMSET(pTestData, 0x00, SIZEOF(ReceiveWorkerTestData));
+        pTestData->pushingThread = GETTID();
+    }
+
+    BOOL waitForProcessedCount(PReceiveWorkerTestData pTestData, SIZE_T count)
+    {
+        UINT64 timeout = GETTIME() + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+
+        while (ATOMIC_LOAD(&pTestData->processedCount) < count && GETTIME() < timeout) {
+            THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+
+        return ATOMIC_LOAD(&pTestData->processedCount) == count;
+    }
+};
+
+TEST_F(ReceiveWorkerFunctionalityTest, packetsAreProcessedInOrderOnTheWorker)
+{
+    PReceiveQueue pReceiveQueue = NULL;
+    ReceiveWorkerTestData testData;
+    UINT32 i, depth, maxDepth;
+    UINT64 droppedPackets;
+
+    initTestData(&testData);
+
+    EXPECT_EQ(STATUS_NULL_ARG, createReceiveQueue(NULL, 0, &pReceiveQueue));
+    EXPECT_EQ(STATUS_NULL_ARG, createReceiveQueue(receiveWorkerTestProcess, 0, NULL));
+    ASSERT_EQ(STATUS_SUCCESS, createReceiveQueue(receiveWorkerTestProcess, (UINT64) &testData, &pReceiveQueue));
+    EXPECT_EQ(STATUS_NULL_ARG, receiveQueuePush(NULL, (PBYTE) &i, SIZEOF(i)));
+    EXPECT_EQ(STATUS_NULL_ARG, receiveQueuePush(pReceiveQueue, NULL, 0));
+
+    // The same buffer is reused for every packet, as the listener does
+    for (i = 0; i < 10 * RECEIVE_WORKER_BATCH_SIZE; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, receiveQueuePush(pReceiveQueue, (PBYTE) &i, SIZEOF(i)));
+        if (i % RECEIVE_WORKER_BATCH_SIZE == 0) {
+            THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        }
+    }
+
+    EXPECT_TRUE(waitForProcessedCount(&testData, 10 * RECEIVE_WORKER_BATCH_SIZE));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&testData.outOfOrder));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&testData.onPushingThread));
+
+    EXPECT_EQ(STATUS_SUCCESS, receiveQueueGetStats(pReceiveQueue, &depth, &maxDepth, &droppedPackets));
+    EXPECT_EQ(0, depth);
+    EXPECT_LE(1, maxDepth);
+    EXPECT_EQ(0, droppedPackets);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeReceiveQueue(&pReceiveQueue));
+    EXPECT_TRUE(pReceiveQueue == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, freeReceiveQueue(&pReceiveQueue));
+}
+
+TEST_F(ReceiveWorkerFunctionalityTest, fullQueueDropsPackets)
+{
+    PReceiveQueue pReceiveQueue = NULL;
+    ReceiveWorkerTestData testData;
+    UINT32 i, depth, maxDepth;
+    UINT64 droppedPackets;
+
+    initTestData(&testData);
+    // The first packet holds its slot until the worker is done with it
+    ATOMIC_STORE_BOOL(&testData.blocked, TRUE);
+
+    ASSERT_EQ(STATUS_SUCCESS, createReceiveQueue(receiveWorkerTestProcess, (UINT64) &testData, &pReceiveQueue));
+    for (i = 0; i < RECEIVE_WORKER_QUEUE_CAPACITY + 5; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, receiveQueuePush(pReceiveQueue, (PBYTE) &i, SIZEOF(i)));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, receiveQueueGetStats(pReceiveQueue, &depth, &maxDepth, &droppedPackets));
+    EXPECT_EQ(RECEIVE_WORKER_QUEUE_CAPACITY, depth);
+    EXPECT_EQ(RECEIVE_WORKER_QUEUE_CAPACITY, maxDepth);
+    EXPECT_EQ(5, droppedPackets);
+
+    ATOMIC_STORE_BOOL(&testData.blocked, FALSE);
+    EXPECT_TRUE(waitForProcessedCount(&testData, RECEIVE_WORKER_QUEUE_CAPACITY));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&testData.outOfOrder));
+
+    // Room again once drained
+    EXPECT_EQ(STATUS_SUCCESS, receiveQueuePush(pReceiveQueue, (PBYTE) &i, SIZEOF(i)));
+    EXPECT_EQ(STATUS_SUCCESS, receiveQueueGetStats(pReceiveQueue, &depth, &maxDepth, &droppedPackets));
+    EXPECT_EQ(5, droppedPackets);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeReceiveQueue(&pReceiveQueue));
+}
+
+TEST_F(ReceiveWorkerFunctionalityTest, freeWaitsForTheWorkerAndDropsPendingPackets)
+{
+    PReceiveQueue pReceiveQueue = NULL;
+    ReceiveWorkerTestData testData;
+    UINT32 i;
+    SIZE_T processedCount;
+
+    initTestData(&testData);
+    ATOMIC_STORE_BOOL(&testData.blocked, TRUE);
+
+    ASSERT_EQ(STATUS_SUCCESS, createReceiveQueue(receiveWorkerTestProcess, (UINT64) &testData, &pReceiveQueue));
+    for (i = 0; i < 4 * RECEIVE_WORKER_BATCH_SIZE; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, receiveQueuePush(pReceiveQueue, (PBYTE) &i, SIZEOF(i)));
+    }
+
+    std::thread unblock([&]() {
+        THREAD_SLEEP(50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        ATOMIC_STORE_BOOL(&testData.blocked, FALSE);
+    });
+
+    // Returns once the running batch is done, the rest is freed with the queue
+    EXPECT_EQ(STATUS_SUCCESS, freeReceiveQueue(&pReceiveQueue));
+    ATOMIC_STORE_BOOL(&testData.freed, TRUE);
+    unblock.join();
+
+    processedCount = ATOMIC_LOAD(&testData.processedCount);
+    EXPECT_LE(1, processedCount);
+    THREAD_SLEEP(50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    EXPECT_EQ(processedCount, ATOMIC_LOAD(&testData.processedCount));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&testData.processedAfterFree));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&testData.outOfOrder));
+}
+
+TEST_F(ReceiveWorkerFunctionalityTest, freeDoesNotWaitForTheOtherQueuesOfTheWorker)
+{
+    PReceiveQueue pBlockedQueue = NULL, pReceiveQueue = NULL;
+    ReceiveWorkerTestData blockedData, testData;
+    UINT32 i = 0;
+    UINT64 start;
+
+    EXPECT_EQ(STATUS_SUCCESS, freeReceiveWorkerPool());
+    setenv(WEBRTC_RECEIVE_WORKER_THREADS_ENV_VAR, "1", 1);
+    EXPECT_EQ(STATUS_SUCCESS, createReceiveWorkerPool());
+
+    initTestData(&blockedData);
+    initTestData(&testData);
+    ATOMIC_STORE_BOOL(&blockedData.blocked, TRUE);
+    ASSERT_EQ(STATUS_SUCCESS, createReceiveQueue(receiveWorkerTestProcess, (UINT64) &blockedData, &pBlockedQueue));
+    ASSERT_EQ(STATUS_SUCCESS, createReceiveQueue(receiveWorkerTestProcess, (UINT64) &testData, &pReceiveQueue));
+    unsetenv(WEBRTC_RECEIVE_WORKER_THREADS_ENV_VAR);
+    EXPECT_EQ(pBlockedQueue->pWorker, pReceiveQueue->pWorker);
+
+    // The worker sits in the callback of the other queue
+    EXPECT_EQ(STATUS_SUCCESS, receiveQueuePush(pBlockedQueue, (PBYTE) &i, SIZEOF(i)));
+    THREAD_SLEEP(20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+
+    start = GETTIME();
+    EXPECT_EQ(STATUS_SUCCESS, freeReceiveQueue(&pReceiveQueue));
+    EXPECT_GT(HUNDREDS_OF_NANOS_IN_A_SECOND, GETTIME() - start);
+
+    ATOMIC_STORE_BOOL(&blockedData.blocked, FALSE);
+    EXPECT_TRUE(waitForProcessedCount(&blockedData, 1));
+    EXPECT_EQ(STATUS_SUCCESS, freeReceiveQueue(&pBlockedQueue));
+}
+
+TEST_F(ReceiveWorkerFunctionalityTest, queueCanBeFreedFromItsOwnCallback)
+{
+    ReceiveWorkerSelfFreeTestData testData;
+    PReceiveQueue pReceiveQueue = NULL;
+    PReceiveWorkerPool pReceiveWorkerPool = getReceiveWorkerPoolInstance();
+    UINT32 i;
+    UINT64 timeout;
+
+    MEMSET(&testData, 0x00, SIZEOF(ReceiveWorkerSelfFreeTestData));
+    ATOMIC_STORE_BOOL(&testData.blocked, TRUE);
+    ASSERT_EQ(STATUS_SUCCESS, createReceiveQueue(receiveWorkerTestSelfFree, (UINT64) &testData, &pReceiveQueue));
+    testData.pReceiveQueue = pReceiveQueue;
+    for (i = 0; i < 4; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, receiveQueuePush(pReceiveQueue, (PBYTE) &i, SIZEOF(i)));
+    }
+    ATOMIC_STORE_BOOL(&testData.blocked, FALSE);
+
+    // The worker releases the queue once the callback returns, the packets left are dropped
+    timeout = GETTIME() + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    MUTEX_LOCK(pReceiveWorkerPool->lock);
+    while (pReceiveWorkerPool->workerUsers[0] != 0 && GETTIME() < timeout) {
+        MUTEX_UNLOCK(pReceiveWorkerPool->lock);
+        THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        MUTEX_LOCK(pReceiveWorkerPool->lock);
+    }
+    EXPECT_EQ(0, pReceiveWorkerPool->workerUsers[0]);
+    MUTEX_UNLOCK(pReceiveWorkerPool->lock);
+
+    EXPECT_EQ(1, ATOMIC_LOAD(&testData.processedCount));
+}
+
+TEST_F(ReceiveWorkerFunctionalityTest, queuesAreSpreadOverTheWorkers)
+{
+    PReceiveQueue pReceiveQueues[4] = {NULL};
+    PReceiveWorkerPool pReceiveWorkerPool = getReceiveWorkerPoolInstance();
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, freeReceiveWorkerPool());
+    setenv(WEBRTC_RECEIVE_WORKER_THREADS_ENV_VAR, "2", 1);
+    EXPECT_EQ(STATUS_SUCCESS, createReceiveWorkerPool());
+
+    // No thread until the first queue
+    EXPECT_EQ(0, pReceiveWorkerPool->workerCount);
+    for (i = 0; i < ARRAY_SIZE(pReceiveQueues); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, createReceiveQueue(receiveWorkerTestProcess, 0, &pReceiveQueues[i]));
+    }
+    unsetenv(WEBRTC_RECEIVE_WORKER_THREADS_ENV_VAR);
+
+    EXPECT_EQ(2, pReceiveWorkerPool->workerCount);
+    EXPECT_EQ(2, pReceiveWorkerPool->workerUsers[0]);
+    EXPECT_EQ(2, pReceiveWorkerPool->workerUsers[1]);
+    EXPECT_NE(pReceiveQueues[0]->pWorker, pReceiveQueues[1]->pWorker);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeReceiveQueue(&pReceiveQueues[0]));
+    EXPECT_EQ(1, pReceiveWorkerPool->workerUsers[pReceiveQueues[1]->workerIndex == 0 ? 1 : 0]);
+    for (i = 1; i < ARRAY_SIZE(pReceiveQueues); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, freeReceiveQueue(&pReceiveQueues[i]));
+    }
+    EXPECT_EQ(0, pReceiveWorkerPool->workerUsers[0]);
+    EXPECT_EQ(0, pReceiveWorkerPool->workerUsers[1]);
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
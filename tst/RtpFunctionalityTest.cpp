@@ -11,7 +11,28 @@ namespace webrtcclient {
 #define DEFAULT_FPS_VALUE     25
 BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
 
+typedef STATUS (*GetNextNaluLengthFunc)(PBYTE, UINT32, PUINT32, PUINT32);
+
 class RtpFunctionalityTest : public WebRtcClientTestBase {
+  protected:
+    // Annex-B frames with the same NAL units, whatever their start codes
+    VOID expectSameNalus(PBYTE frame, UINT32 frameLength, PBYTE otherFrame, UINT32 otherFrameLength, GetNextNaluLengthFunc getNextNaluLengthFn)
+    {
+        UINT32 startIndex, naluLength, otherStartIndex, otherNaluLength;
+
+        while (frameLength != 0 && otherFrameLength != 0) {
+            ASSERT_EQ(STATUS_SUCCESS, getNextNaluLengthFn(frame, frameLength, &startIndex, &naluLength));
+            ASSERT_EQ(STATUS_SUCCESS, getNextNaluLengthFn(otherFrame, otherFrameLength, &otherStartIndex, &otherNaluLength));
+            ASSERT_EQ(naluLength, otherNaluLength);
+            EXPECT_EQ(0, MEMCMP(frame + startIndex, otherFrame + otherStartIndex, naluLength));
+            frame += startIndex + naluLength;
+            frameLength -= startIndex + naluLength;
+            otherFrame += otherStartIndex + otherNaluLength;
+            otherFrameLength -= otherStartIndex + otherNaluLength;
+        }
+        EXPECT_EQ(0, frameLength);
+        EXPECT_EQ(0, otherFrameLength);
+    }
 };
 
 TEST_F(RtpFunctionalityTest, packetUnderflow)
@@ -177,10 +198,7 @@ TEST_F(RtpFunctionalityTest, packingUnpackingVerifySameH264Frame)
     UINT32 offset = 0;
     UINT32 newPayloadLen = 0, newPayloadSubLen = 0;
     BOOL isStartPacket = FALSE;
-    PBYTE pCurPtrInPayload = NULL;
-    UINT32 remainPayloadLen = 0;
-    UINT32 startIndex = 0, naluLength = 0;
-    UINT32 startLen = 0;
+    std::vector<BYTE> rebuiltFrame;
 
     payloadArray.maxPayloadLength = 0;
     payloadArray.maxPayloadSubLenSize = 0;
@@ -218,42 +236,30 @@ TEST_F(RtpFunctionalityTest, packingUnpackingVerifySameH264Frame)
         EXPECT_LT(0, payloadArray.payloadSubLenSize);
 
         offset = 0;
+        newPayloadLen = 0;
 
         for (i = 0; i < payloadArray.payloadSubLenSize; i++) {
             EXPECT_EQ(STATUS_SUCCESS,
                       depayH264FromRtpPayload(payloadArray.payloadBuffer + offset, payloadArray.payloadSubLength[i], NULL, &newPayloadSubLen,
                                               &isStartPacket));
             newPayloadLen += newPayloadSubLen;
-            if (isStartPacket) {
-                newPayloadLen -= SIZEOF(start4ByteCode);
-            }
             EXPECT_LT(0, newPayloadSubLen);
             offset += payloadArray.payloadSubLength[i];
         }
-        EXPECT_LE(newPayloadLen, payloadLen);
 
+        // Aggregation packets hold several NAL units, the frame is rebuilt before it is compared
         offset = 0;
-        newPayloadLen = 0;
-        isStartPacket = FALSE;
-        pCurPtrInPayload = payload;
-        remainPayloadLen = payloadLen;
+        rebuiltFrame.clear();
         for (i = 0; i < payloadArray.payloadSubLenSize; i++) {
             newPayloadSubLen = depayloadSize;
             EXPECT_EQ(STATUS_SUCCESS,
                       depayH264FromRtpPayload(payloadArray.payloadBuffer + offset, payloadArray.payloadSubLength[i], depayload, &newPayloadSubLen,
                                               &isStartPacket));
-            if (isStartPacket) {
-                EXPECT_EQ(STATUS_SUCCESS, getNextNaluLength(pCurPtrInPayload, remainPayloadLen, &startIndex, &naluLength));
-                pCurPtrInPayload += startIndex;
-                startLen = SIZEOF(start4ByteCode);
-            } else {
-                startLen = 0;
-            }
-            EXPECT_TRUE(MEMCMP(pCurPtrInPayload, depayload + startLen, newPayloadSubLen - startLen) == 0);
-            pCurPtrInPayload += newPayloadSubLen - startLen;
-            remainPayloadLen -= newPayloadSubLen;
+            rebuiltFrame.insert(rebuiltFrame.end(), depayload, depayload + newPayloadSubLen);
             offset += payloadArray.payloadSubLength[i];
         }
+        EXPECT_EQ(newPayloadLen, rebuiltFrame.size());
+        expectSameNalus(payload, payloadLen, rebuiltFrame.data(), (UINT32) rebuiltFrame.size(), getNextNaluLength);
     }
 
     MEMFREE(payloadArray.payloadBuffer);
@@ -274,10 +280,7 @@ TEST_F(RtpFunctionalityTest, packingUnpackingVerifySameH265Frame)
     UINT32 offset = 0;
     UINT32 newPayloadLen = 0, newPayloadSubLen = 0;
     BOOL isStartPacket = FALSE;
-    PBYTE pCurPtrInPayload = NULL;
-    UINT32 remainPayloadLen = 0;
-    UINT32 startIndex = 0, naluLength = 0;
-    UINT32 startLen = 0;
+    std::vector<BYTE> rebuiltFrame;
 
     payloadArray.maxPayloadLength = 0;
     payloadArray.maxPayloadSubLenSize = 0;
@@ -315,42 +318,30 @@ TEST_F(RtpFunctionalityTest, packingUnpackingVerifySameH265Frame)
         EXPECT_LT(0, payloadArray.payloadSubLenSize);
 
         offset = 0;
+        newPayloadLen = 0;
 
         for (i = 0; i < payloadArray.payloadSubLenSize; i++) {
             EXPECT_EQ(STATUS_SUCCESS,
                       depayH265FromRtpPayload(payloadArray.payloadBuffer + offset, payloadArray.payloadSubLength[i], NULL, &newPayloadSubLen,
                                               &isStartPacket));
             newPayloadLen += newPayloadSubLen;
-            if (isStartPacket) {
-                newPayloadLen -= SIZEOF(start4ByteCode);
-            }
             EXPECT_LT(0, newPayloadSubLen);
             offset += payloadArray.payloadSubLength[i];
         }
-        EXPECT_LE(newPayloadLen, payloadLen);
 
+        // Aggregation packets hold several NAL units, the frame is rebuilt before it is compared
         offset = 0;
-        newPayloadLen = 0;
-        isStartPacket = FALSE;
-        pCurPtrInPayload = payload;
-        remainPayloadLen = payloadLen;
+        rebuiltFrame.clear();
         for (i = 0; i < payloadArray.payloadSubLenSize; i++) {
             newPayloadSubLen = depayloadSize;
             EXPECT_EQ(STATUS_SUCCESS,
                       depayH265FromRtpPayload(payloadArray.payloadBuffer + offset, payloadArray.payloadSubLength[i], depayload, &newPayloadSubLen,
                                               &isStartPacket));
-            if (isStartPacket) {
-                EXPECT_EQ(STATUS_SUCCESS, getNextNaluLengthH265(pCurPtrInPayload, remainPayloadLen, &startIndex, &naluLength));
-                pCurPtrInPayload += startIndex;
-                startLen = SIZEOF(start4ByteCode);
-            } else {
-                startLen = 0;
-            }
-            EXPECT_TRUE(MEMCMP(pCurPtrInPayload, depayload + startLen, newPayloadSubLen - startLen) == 0);
-            pCurPtrInPayload += newPayloadSubLen - startLen;
-            remainPayloadLen -= newPayloadSubLen;
+            rebuiltFrame.insert(rebuiltFrame.end(), depayload, depayload + newPayloadSubLen);
             offset += payloadArray.payloadSubLength[i];
         }
+        EXPECT_EQ(newPayloadLen, rebuiltFrame.size());
+        expectSameNalus(payload, payloadLen, rebuiltFrame.data(), (UINT32) rebuiltFrame.size(), getNextNaluLengthH265);
     }
 
     MEMFREE(payloadArray.payloadBuffer);
@@ -631,6 +622,312 @@ TEST_F(RtpFunctionalityTest, twccPayload)
     EXPECT_EQ(0, ptr[3]);
 }
 
+TEST_F(RtpFunctionalityTest, constructRetransmitPacketBuffer)
+{
+    PRtpPacket pRtpPacket = NULL;
+    PRtpPacketBuffer pRtxPacketBuffer = NULL;
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketWithSeqNum(1234, &pRtpPacket));
+    // Point the payload at the serialized bytes, like the packets kept by the rolling buffer
+    EXPECT_EQ(STATUS_SUCCESS, setRtpPacketFromBytes(pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength, pRtpPacket));
+    EXPECT_EQ(STATUS_NULL_ARG, constructRetransmitRtpPacketBuffer(NULL, 7, 97, 0x5678, SRTP_AUTH_TAG_OVERHEAD, &pRtxPacketBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, constructRetransmitRtpPacketBuffer(pRtpPacket, 7, 97, 0x5678, SRTP_AUTH_TAG_OVERHEAD, &pRtxPacketBuffer));
+
+    // Same payload prefixed by the original sequence number, on the retransmission stream
+    EXPECT_EQ(7, pRtxPacketBuffer->packet.header.sequenceNumber);
+    EXPECT_EQ(97, pRtxPacketBuffer->packet.header.payloadType);
+    EXPECT_EQ(0x5678, pRtxPacketBuffer->packet.header.ssrc);
+    EXPECT_EQ(pRtpPacket->header.timestamp, pRtxPacketBuffer->packet.header.timestamp);
+    EXPECT_EQ(pRtpPacket->payloadLength + SIZEOF(UINT16), pRtxPacketBuffer->packet.payloadLength);
+    EXPECT_EQ(pRtpPacket->rawPacketLength + SIZEOF(UINT16), pRtxPacketBuffer->packet.rawPacketLength);
+    EXPECT_EQ(1234, (UINT16) getUnalignedInt16BigEndian(pRtxPacketBuffer->packet.payload));
+    EXPECT_EQ(0, MEMCMP(pRtpPacket->payload, pRtxPacketBuffer->packet.payload + SIZEOF(UINT16), pRtpPacket->payloadLength));
+    EXPECT_EQ(SRTP_AUTH_TAG_OVERHEAD, pRtxPacketBuffer->tailroom);
+
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketBufferRelease(&pRtxPacketBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacket(&pRtpPacket));
+}
+
+typedef struct {
+    PJitterBuffer pJitterBuffer;
+    DepayRtpPayloadSlicesFunc depaySlicesFn;
+    std::vector<PRtcFrameSlices> frames;
+    std::vector<UINT32> frameSizes;
+} FrameSlicesTestContext, *PFrameSlicesTestContext;
+
+static STATUS frameSlicesTestReadyFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 frameSize)
+{
+    PFrameSlicesTestContext pContext = (PFrameSlicesTestContext) customData;
+    PKvsFrameSlices pKvsFrameSlices = NULL;
+    STATUS retStatus = createKvsFrameSlices(pContext->pJitterBuffer, pContext->depaySlicesFn, startIndex, endIndex, &pKvsFrameSlices);
+
+    if (STATUS_SUCCEEDED(retStatus)) {
+        pContext->frames.push_back(&pKvsFrameSlices->frameSlices);
+        pContext->frameSizes.push_back(frameSize);
+    }
+
+    return retStatus;
+}
+
+static STATUS frameSlicesTestDroppedFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 timestamp)
+{
+    UNUSED_PARAM(customData);
+    UNUSED_PARAM(startIndex);
+    UNUSED_PARAM(endIndex);
+    UNUSED_PARAM(timestamp);
+    return STATUS_SUCCESS;
+}
+
+TEST_F(RtpFunctionalityTest, frameSlicesMatchDepayloadedFrames)
+{
+    struct {
+        RTC_CODEC codec;
+        PCHAR frameFolder;
+        RtpPayloadFunc payloadFn;
+        DepayRtpPayloadFunc depayFn;
+        DepayRtpPayloadSlicesFunc depaySlicesFn;
+    } codecs[] = {
+        {RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE, (PCHAR) "../samples/h264SampleFrames", createPayloadForH264,
+         depayH264FromRtpPayload, depayH264SlicesFromRtpPayload},
+        {RTC_CODEC_H265, (PCHAR) "../samples/h265SampleFrames", createPayloadForH265, depayH265FromRtpPayload, depayH265SlicesFromRtpPayload},
+    };
+    PBYTE frameData = (PBYTE) MEMCALLOC(1, 200000);
+    std::vector<BYTE> expectedFrames[2], frame;
+    FrameSlicesTestContext context;
+    Frame sourceFrame;
+    PayloadArray payloadArray;
+    PRtpPacket pRtpPacket = NULL;
+    PRtcFrameSlices pFrameSlices = NULL;
+    UINT32 frameDataLen = 0, depayloadLen, i, j, c, offset;
+    UINT16 sequenceNumber = 1000;
+    BOOL isStart;
+
+    MEMSET(&sourceFrame, 0x00, SIZEOF(Frame));
+    for (c = 0; c < ARRAY_SIZE(codecs); c++) {
+        MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+        context.depaySlicesFn = codecs[c].depaySlicesFn;
+        context.frames.clear();
+        context.frameSizes.clear();
+        EXPECT_EQ(STATUS_SUCCESS,
+                  createJitterBuffer(frameSlicesTestReadyFunc, frameSlicesTestDroppedFunc, codecs[c].depayFn, DEFAULT_JITTER_BUFFER_MAX_LATENCY,
+                                     VIDEO_CLOCKRATE, (UINT64) &context, &context.pJitterBuffer));
+
+        // Two frames, the second one is delivered when the jitter buffer is freed
+        for (i = 0; i < ARRAY_SIZE(expectedFrames); i++) {
+            expectedFrames[i].clear();
+            EXPECT_EQ(STATUS_SUCCESS, readFrameData(frameData, &frameDataLen, i + 1, codecs[c].frameFolder, codecs[c].codec));
+            sourceFrame.frameData = frameData;
+            sourceFrame.size = frameDataLen;
+            EXPECT_EQ(STATUS_SUCCESS, packetizeFrame(codecs[c].payloadFn, DEFAULT_MTU_SIZE_BYTES, &sourceFrame, &payloadArray));
+            for (j = 0, offset = 0; j < payloadArray.payloadSubLenSize; offset += payloadArray.payloadSubLength[j++]) {
+                depayloadLen = 0;
+                EXPECT_EQ(STATUS_SUCCESS,
+                          codecs[c].depayFn(payloadArray.payloadBuffer + offset, payloadArray.payloadSubLength[j], NULL, &depayloadLen, &isStart));
+                expectedFrames[i].resize(expectedFrames[i].size() + depayloadLen);
+                EXPECT_EQ(STATUS_SUCCESS,
+                          codecs[c].depayFn(payloadArray.payloadBuffer + offset, payloadArray.payloadSubLength[j],
+                                            expectedFrames[i].data() + expectedFrames[i].size() - depayloadLen, &depayloadLen, NULL));
+
+                pRtpPacket = (PRtpPacket) MEMCALLOC(1, SIZEOF(RtpPacket));
+                pRtpPacket->pRawPacket = (PBYTE) MEMALLOC(payloadArray.payloadSubLength[j]);
+                MEMCPY(pRtpPacket->pRawPacket, payloadArray.payloadBuffer + offset, payloadArray.payloadSubLength[j]);
+                pRtpPacket->payload = pRtpPacket->pRawPacket;
+                pRtpPacket->payloadLength = payloadArray.payloadSubLength[j];
+                pRtpPacket->header.sequenceNumber = sequenceNumber++;
+                pRtpPacket->header.timestamp = (i + 1) * 3000;
+                pRtpPacket->receivedTime = GETTIME();
+                EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(context.pJitterBuffer, pRtpPacket, NULL));
+            }
+        }
+        EXPECT_EQ(STATUS_SUCCESS, freeJitterBuffer(&context.pJitterBuffer));
+
+        ASSERT_EQ(ARRAY_SIZE(expectedFrames), context.frames.size());
+        for (i = 0; i < context.frames.size(); i++) {
+            pFrameSlices = context.frames[i];
+            EXPECT_EQ(RTC_FRAME_SLICES_CURRENT_VERSION, pFrameSlices->version);
+            EXPECT_EQ(context.frameSizes[i], pFrameSlices->size);
+            frame.clear();
+            for (j = 0; j < pFrameSlices->sliceCount; j++) {
+                frame.insert(frame.end(), pFrameSlices->pSlices[j].pData, pFrameSlices->pSlices[j].pData + pFrameSlices->pSlices[j].size);
+            }
+            EXPECT_EQ(pFrameSlices->size, frame.size());
+            EXPECT_TRUE(frame == expectedFrames[i]);
+            // The packets are freed with the frame
+            EXPECT_EQ(STATUS_SUCCESS, releaseFrameSlices(&pFrameSlices));
+            EXPECT_TRUE(pFrameSlices == NULL);
+        }
+
+        SAFE_MEMFREE(payloadArray.payloadBuffer);
+        SAFE_MEMFREE(payloadArray.payloadSubLength);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, releaseFrameSlices(&pFrameSlices));
+    MEMFREE(frameData);
+}
+
+TEST_F(RtpFunctionalityTest, h264AggregationPacketSlices)
+{
+    // STAP-A with two NAL units of 2 and 3 bytes
+    BYTE stapA[] = {STAP_A_INDICATOR, 0x00, 0x02, 0x67, 0x42, 0x00, 0x03, 0x68, 0xce, 0x3c};
+    BYTE expected[] = {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x3c};
+    RtcFrameSlice slices[4];
+    std::vector<BYTE> frame;
+    UINT32 sliceCount = 0, i;
+
+    EXPECT_EQ(STATUS_SUCCESS, depayH264SlicesFromRtpPayload(stapA, SIZEOF(stapA), NULL, &sliceCount));
+    EXPECT_EQ(4, sliceCount);
+    sliceCount = 3;
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, depayH264SlicesFromRtpPayload(stapA, SIZEOF(stapA), slices, &sliceCount));
+    sliceCount = ARRAY_SIZE(slices);
+    EXPECT_EQ(STATUS_SUCCESS, depayH264SlicesFromRtpPayload(stapA, SIZEOF(stapA), slices, &sliceCount));
+    EXPECT_EQ(4, sliceCount);
+    for (i = 0; i < sliceCount; i++) {
+        frame.insert(frame.end(), slices[i].pData, slices[i].pData + slices[i].size);
+    }
+    EXPECT_EQ(SIZEOF(expected), frame.size());
+    EXPECT_EQ(0, MEMCMP(expected, frame.data(), SIZEOF(expected)));
+    // NAL units point into the packet
+    EXPECT_EQ(stapA + 3, slices[1].pData);
+
+    // A truncated NAL unit is rejected
+    sliceCount = ARRAY_SIZE(slices);
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, depayH264SlicesFromRtpPayload(stapA, SIZEOF(stapA) - 1, slices, &sliceCount));
+}
+
+TEST_F(RtpFunctionalityTest, h264SmallNalusAreAggregatedIntoStapA)
+{
+    // SPS, PPS, a 60 byte IDR slice with 3 byte start codes, then a 300 byte slice and a 2 byte AUD
+    BYTE frame[4 + 5 + 3 + 3 + 3 + 60 + 4 + 300 + 4 + 2];
+    BYTE depayload[400];
+    UINT32 frameLength = 0, payloadLength = 0, payloadSubLenSize = 0, depayloadLength, i;
+    UINT32 payloadSubLength[4];
+    BYTE payload[512];
+    BOOL isStart = FALSE;
+
+    MEMCPY(frame, start4ByteCode, SIZEOF(start4ByteCode));
+    frameLength += SIZEOF(start4ByteCode);
+    frame[frameLength++] = 0x67;
+    for (i = 0; i < 4; i++) {
+        frame[frameLength++] = (BYTE) (0x42 + i);
+    }
+    MEMCPY(frame + frameLength, start4ByteCode + 1, 3);
+    frameLength += 3;
+    frame[frameLength++] = 0x28;
+    frame[frameLength++] = 0xce;
+    frame[frameLength++] = 0x3c;
+    MEMCPY(frame + frameLength, start4ByteCode + 1, 3);
+    frameLength += 3;
+    frame[frameLength++] = 0x65;
+    for (i = 1; i < 60; i++) {
+        frame[frameLength++] = (BYTE) (i + 2);
+    }
+    MEMCPY(frame + frameLength, start4ByteCode, SIZEOF(start4ByteCode));
+    frameLength += SIZEOF(start4ByteCode);
+    frame[frameLength++] = 0x41;
+    for (i = 1; i < 300; i++) {
+        frame[frameLength++] = (BYTE) (i + 2);
+    }
+    MEMCPY(frame + frameLength, start4ByteCode, SIZEOF(start4ByteCode));
+    frameLength += SIZEOF(start4ByteCode);
+    frame[frameLength++] = 0x09;
+    frame[frameLength++] = 0xf0;
+    ASSERT_EQ(SIZEOF(frame), frameLength);
+
+    // The first 3 NAL units fit in 100 bytes, the next 2 are sent on their own even though the AUD is small
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadForH264(100, frame, frameLength, NULL, &payloadLength, NULL, &payloadSubLenSize));
+    EXPECT_EQ(STAP_A_HEADER_SIZE + 3 * SIZEOF(UINT16) + 5 + 3 + 60 + 300 - 1 + 4 * FU_A_HEADER_SIZE + 2, payloadLength);
+    EXPECT_EQ(6, payloadSubLenSize);
+
+    // A larger MTU takes the 300 byte slice too
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadForH264(1200, frame, frameLength, NULL, &payloadLength, NULL, &payloadSubLenSize));
+    EXPECT_EQ(1, payloadSubLenSize);
+    payloadSubLenSize = ARRAY_SIZE(payloadSubLength);
+    payloadLength = SIZEOF(payload);
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadForH264(1200, frame, frameLength, payload, &payloadLength, payloadSubLength, &payloadSubLenSize));
+    EXPECT_EQ(STAP_A_HEADER_SIZE + 5 * SIZEOF(UINT16) + 5 + 3 + 60 + 300 + 2, payloadSubLength[0]);
+
+    // NRI is the highest of the NAL units, the SPS sizes come first
+    EXPECT_EQ(0x60 | STAP_A_INDICATOR, payload[0]);
+    EXPECT_EQ(5, (UINT16) getUnalignedInt16BigEndian(payload + STAP_A_HEADER_SIZE));
+    EXPECT_EQ(0x67, payload[STAP_A_HEADER_SIZE + SIZEOF(UINT16)]);
+
+    depayloadLength = 0;
+    EXPECT_EQ(STATUS_SUCCESS, depayH264FromRtpPayload(payload, payloadSubLength[0], NULL, &depayloadLength, &isStart));
+    EXPECT_TRUE(isStart);
+    EXPECT_EQ(5 * SIZEOF(start4ByteCode) + 5 + 3 + 60 + 300 + 2, depayloadLength);
+    EXPECT_EQ(STATUS_SUCCESS, depayH264FromRtpPayload(payload, payloadSubLength[0], depayload, &depayloadLength, NULL));
+    expectSameNalus(frame, frameLength, depayload, depayloadLength, getNextNaluLength);
+
+    // Sizes running past the end of the packet are rejected
+    depayloadLength = SIZEOF(depayload);
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, depayH264FromRtpPayload(payload, payloadSubLength[0] - 1, depayload, &depayloadLength, NULL));
+}
+
+TEST_F(RtpFunctionalityTest, h264SingleSmallNaluIsNotAggregated)
+{
+    BYTE frame[] = {0x00, 0x00, 0x00, 0x01, 0x41, 0x9a, 0x02, 0x03};
+    BYTE payload[16];
+    UINT32 payloadLength = SIZEOF(payload), payloadSubLenSize = 1, payloadSubLength[1];
+
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadForH264(1200, frame, SIZEOF(frame), payload, &payloadLength, payloadSubLength, &payloadSubLenSize));
+    EXPECT_EQ(1, payloadSubLenSize);
+    EXPECT_EQ(SIZEOF(frame) - SIZEOF(start4ByteCode), payloadSubLength[0]);
+    EXPECT_EQ(0, MEMCMP(frame + SIZEOF(start4ByteCode), payload, payloadSubLength[0]));
+}
+
+TEST_F(RtpFunctionalityTest, h265SmallNalusAreAggregatedIntoAp)
+{
+    // VPS, SPS and PPS with TID 1, then a slice with TID 2
+    BYTE frame[] = {0x00, 0x00, 0x00, 0x01, 0x40, 0x01, 0x0c, 0x01, 0x00, 0x00, 0x00, 0x01, 0x42, 0x01, 0x01, 0x01, 0x60,
+                    0x00, 0x00, 0x01, 0x44, 0x01, 0xc1, 0x72, 0x00, 0x00, 0x00, 0x01, 0x26, 0x02, 0xaf, 0x07, 0x10};
+    BYTE expectedAp[] = {0x60, 0x01, 0x00, 0x04, 0x40, 0x01, 0x0c, 0x01, 0x00, 0x05, 0x42, 0x01, 0x01, 0x01,
+                         0x60, 0x00, 0x04, 0x44, 0x01, 0xc1, 0x72, 0x00, 0x05, 0x26, 0x02, 0xaf, 0x07, 0x10};
+    BYTE payload[64], depayload[64];
+    RtcFrameSlice slices[8];
+    std::vector<BYTE> slicedFrame;
+    UINT32 payloadLength = 0, payloadSubLenSize = 0, payloadSubLength[2], depayloadLength, sliceCount, i;
+    BOOL isStart = FALSE;
+
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadForH265(1200, frame, SIZEOF(frame), NULL, &payloadLength, NULL, &payloadSubLenSize));
+    EXPECT_EQ(1, payloadSubLenSize);
+    EXPECT_EQ(SIZEOF(expectedAp), payloadLength);
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadForH265(1200, frame, SIZEOF(frame), payload, &payloadLength, payloadSubLength, &payloadSubLenSize));
+    EXPECT_EQ(SIZEOF(expectedAp), payloadSubLength[0]);
+    EXPECT_EQ(0, MEMCMP(expectedAp, payload, SIZEOF(expectedAp)));
+
+    // Two NAL units fit in 20 bytes, the PPS starts a second aggregation packet
+    payloadLength = 0;
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadForH265(20, frame, SIZEOF(frame), NULL, &payloadLength, NULL, &payloadSubLenSize));
+    EXPECT_EQ(2, payloadSubLenSize);
+    EXPECT_EQ(2 * H265_AP_HEADER_SIZE + 4 * SIZEOF(UINT16) + 4 + 5 + 4 + 5, payloadLength);
+
+    depayloadLength = 0;
+    EXPECT_EQ(STATUS_SUCCESS, depayH265FromRtpPayload(expectedAp, SIZEOF(expectedAp), NULL, &depayloadLength, &isStart));
+    EXPECT_TRUE(isStart);
+    EXPECT_EQ(4 * SIZEOF(start4ByteCode) + 4 + 5 + 4 + 5, depayloadLength);
+    depayloadLength--;
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, depayH265FromRtpPayload(expectedAp, SIZEOF(expectedAp), depayload, &depayloadLength, NULL));
+    depayloadLength = SIZEOF(depayload);
+    EXPECT_EQ(STATUS_SUCCESS, depayH265FromRtpPayload(expectedAp, SIZEOF(expectedAp), depayload, &depayloadLength, NULL));
+    EXPECT_EQ(4 * SIZEOF(start4ByteCode) + 4 + 5 + 4 + 5, depayloadLength);
+    expectSameNalus(frame, SIZEOF(frame), depayload, depayloadLength, getNextNaluLengthH265);
+
+    sliceCount = ARRAY_SIZE(slices);
+    EXPECT_EQ(STATUS_SUCCESS, depayH265SlicesFromRtpPayload(expectedAp, SIZEOF(expectedAp), slices, &sliceCount));
+    EXPECT_EQ(8, sliceCount);
+    for (i = 0; i < sliceCount; i++) {
+        slicedFrame.insert(slicedFrame.end(), slices[i].pData, slices[i].pData + slices[i].size);
+    }
+    EXPECT_EQ(depayloadLength, slicedFrame.size());
+    EXPECT_EQ(0, MEMCMP(depayload, slicedFrame.data(), depayloadLength));
+
+    // A truncated NAL unit is rejected
+    depayloadLength = SIZEOF(depayload);
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, depayH265FromRtpPayload(expectedAp, SIZEOF(expectedAp) - 1, depayload, &depayloadLength, NULL));
+    sliceCount = ARRAY_SIZE(slices);
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, depayH265SlicesFromRtpPayload(expectedAp, SIZEOF(expectedAp) - 1, slices, &sliceCount));
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
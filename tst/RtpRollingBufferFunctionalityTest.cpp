@@ -259,6 +259,49 @@ TEST_F(RtpRollingBufferFunctionalityTest, testRollingBufferParams)
     EXPECT_EQ(freePeerConnection(&pRtcPeerConnection), STATUS_SUCCESS);
 
 }
+TEST_F(RtpRollingBufferFunctionalityTest, packetBufferIsSharedAndReleasedOnEviction)
+{
+    PRtpRollingBuffer pRtpRollingBuffer;
+    PRtpPacket pRtpPacket;
+    PRtpPacketBuffer pFirstBuffer = NULL, pSecondBuffer = NULL, pFoundBuffer = NULL;
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpRollingBuffer(1, &pRtpRollingBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketWithSeqNum(0, &pRtpPacket));
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketBuffer(0, pRtpPacket->rawPacketLength, SRTP_AUTH_TAG_OVERHEAD, &pFirstBuffer));
+    MEMCPY(pFirstBuffer->packet.pRawPacket, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength);
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketBufferSetLength(pFirstBuffer, pRtpPacket->rawPacketLength));
+    EXPECT_EQ(SRTP_AUTH_TAG_OVERHEAD, pFirstBuffer->tailroom);
+    EXPECT_EQ(0, pFirstBuffer->packet.header.sequenceNumber);
+    EXPECT_EQ(10, pFirstBuffer->packet.payloadLength);
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, rtpPacketBufferSetLength(pFirstBuffer, pRtpPacket->rawPacketLength + SRTP_AUTH_TAG_OVERHEAD + 1));
+
+    // No copy, the rolling buffer holds a reference on the same packet
+    EXPECT_EQ(STATUS_SUCCESS, rtpRollingBufferAddRtpPacketBuffer(pRtpRollingBuffer, pFirstBuffer));
+    EXPECT_EQ(2, ATOMIC_LOAD(&pFirstBuffer->refCount));
+    EXPECT_EQ(STATUS_SUCCESS, rtpRollingBufferGetRtpPacketBuffer(pRtpRollingBuffer, 0, &pFoundBuffer));
+    EXPECT_EQ(pFirstBuffer, pFoundBuffer);
+    EXPECT_EQ(3, ATOMIC_LOAD(&pFirstBuffer->refCount));
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketBufferRelease(&pFoundBuffer));
+    EXPECT_EQ(NULL, pFoundBuffer);
+
+    // Evicting the first packet only drops the reference of the rolling buffer
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketBuffer(0, pRtpPacket->rawPacketLength, 0, &pSecondBuffer));
+    MEMCPY(pSecondBuffer->packet.pRawPacket, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength);
+    EXPECT_EQ(STATUS_SUCCESS, rtpRollingBufferAddRtpPacketBuffer(pRtpRollingBuffer, pSecondBuffer));
+    EXPECT_EQ(1, ATOMIC_LOAD(&pFirstBuffer->refCount));
+    EXPECT_EQ(STATUS_SUCCESS, rtpRollingBufferGetRtpPacketBuffer(pRtpRollingBuffer, 0, &pFoundBuffer));
+    EXPECT_EQ(NULL, pFoundBuffer);
+    EXPECT_EQ(STATUS_SUCCESS, rtpRollingBufferGetRtpPacketBuffer(pRtpRollingBuffer, 1, &pFoundBuffer));
+    EXPECT_EQ(pSecondBuffer, pFoundBuffer);
+
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketBufferRelease(&pFoundBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketBufferRelease(&pFirstBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketBufferRelease(&pSecondBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpRollingBuffer(&pRtpRollingBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacket(&pRtpPacket));
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
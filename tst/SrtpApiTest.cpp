@@ -38,6 +38,55 @@ TEST_F(SrtpApiTest, encryptDecryptRtpPacketSuccess)
     EXPECT_EQ(STATUS_SUCCESS, freeSrtpSession(&pSrtpSession));
 }
 
+TEST_F(SrtpApiTest, encryptDecryptRtpAndRtcpPacketsForEachProfile)
+{
+    struct {
+        KVS_SRTP_PROFILE profile;
+        INT32 authTagSize;
+    } profiles[] = {
+        {KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, 10},
+        {KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32, 4},
+#if defined(KVS_USE_OPENSSL) && defined(HAVE_SRTP_AES_GCM)
+        {KVS_SRTP_PROFILE_AEAD_AES_128_GCM, 16},
+        {KVS_SRTP_PROFILE_AEAD_AES_256_GCM, 16},
+#endif
+    };
+    // Sender report without report blocks
+    BYTE rtcpPacket[28] = {0x80, 0xc8, 0x00, 0x06, 0x98, 0x36, 0xbe, 0x88, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+                           0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x05};
+    BYTE key[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
+    BYTE packet[SIZEOF(rtcpPacket) + SRTP_MAX_TRAILER_LEN];
+    PSrtpSession pSrtpSession = NULL;
+    INT32 len;
+    UINT32 i;
+
+    for (i = 0; i < SIZEOF(key); i++) {
+        key[i] = (BYTE) i;
+    }
+
+    for (auto& testCase : profiles) {
+        EXPECT_EQ(STATUS_SUCCESS, initSrtpSession(key, key, testCase.profile, &pSrtpSession));
+
+        MEMCPY(packet, SKEL_RTP_PACKET, SIZEOF(SKEL_RTP_PACKET));
+        len = SIZEOF(SKEL_RTP_PACKET);
+        EXPECT_EQ(STATUS_SUCCESS, encryptRtpPacket(pSrtpSession, packet, &len));
+        EXPECT_EQ(SIZEOF(SKEL_RTP_PACKET) + testCase.authTagSize, len);
+        EXPECT_LE(testCase.authTagSize, SRTP_AUTH_TAG_OVERHEAD);
+        EXPECT_EQ(STATUS_SUCCESS, decryptSrtpPacket(pSrtpSession, packet, &len));
+        EXPECT_EQ(SIZEOF(SKEL_RTP_PACKET), len);
+        EXPECT_EQ(0, MEMCMP(packet, SKEL_RTP_PACKET, len));
+
+        MEMCPY(packet, rtcpPacket, SIZEOF(rtcpPacket));
+        len = SIZEOF(rtcpPacket);
+        EXPECT_EQ(STATUS_SUCCESS, encryptRtcpPacket(pSrtpSession, packet, &len));
+        EXPECT_EQ(STATUS_SUCCESS, decryptSrtcpPacket(pSrtpSession, packet, &len));
+        EXPECT_EQ(SIZEOF(rtcpPacket), len);
+        EXPECT_EQ(0, MEMCMP(packet, rtcpPacket, len));
+
+        EXPECT_EQ(STATUS_SUCCESS, freeSrtpSession(&pSrtpSession));
+    }
+}
+
 TEST_F(SrtpApiTest, encryptDecryptKeyMisMatchFails)
 {
     BYTE transmitKey[30] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
@@ -0,0 +1,104 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+class SsrcTableFunctionalityTest : public WebRtcClientTestBase {
+};
+
+TEST_F(SsrcTableFunctionalityTest, putAndGetAcrossKindsAndGrowth)
+{
+    PSsrcTable pSsrcTable = NULL;
+    UINT64 item;
+    UINT32 i, count = 10 * SSRC_TABLE_INITIAL_CAPACITY;
+
+    EXPECT_EQ(STATUS_NULL_ARG, createSsrcTable(NULL));
+    EXPECT_EQ(STATUS_SUCCESS, createSsrcTable(&pSsrcTable));
+    EXPECT_EQ(STATUS_NOT_FOUND, ssrcTableGet(pSsrcTable, 1, SSRC_TABLE_KIND_SENDER, &item));
+
+    // Same ssrc under different kinds maps to different items
+    EXPECT_EQ(STATUS_SUCCESS, ssrcTablePut(pSsrcTable, 1, SSRC_TABLE_KIND_SENDER, 100));
+    EXPECT_EQ(STATUS_SUCCESS, ssrcTablePut(pSsrcTable, 1, SSRC_TABLE_KIND_RECEIVER, 200));
+    EXPECT_EQ(STATUS_SUCCESS, ssrcTableGet(pSsrcTable, 1, SSRC_TABLE_KIND_SENDER, &item));
+    EXPECT_EQ(100, item);
+    EXPECT_EQ(STATUS_SUCCESS, ssrcTableGet(pSsrcTable, 1, SSRC_TABLE_KIND_RECEIVER, &item));
+    EXPECT_EQ(200, item);
+    EXPECT_EQ(STATUS_NOT_FOUND, ssrcTableGet(pSsrcTable, 1, SSRC_TABLE_KIND_RTX, &item));
+
+    // Putting an existing key replaces its item
+    EXPECT_EQ(STATUS_SUCCESS, ssrcTablePut(pSsrcTable, 1, SSRC_TABLE_KIND_SENDER, 300));
+    EXPECT_EQ(STATUS_SUCCESS, ssrcTableGet(pSsrcTable, 1, SSRC_TABLE_KIND_SENDER, &item));
+    EXPECT_EQ(300, item);
+
+    // Force a few rounds of growth, everything put before must still be found
+    for (i = 0; i < count; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, ssrcTablePut(pSsrcTable, 0x10000 + i * 7919, SSRC_TABLE_KIND_RTX, i + 1));
+    }
+    EXPECT_LT(count, ((PSsrcTableSlots) pSsrcTable->currentSlots)->capacity);
+    for (i = 0; i < count; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, ssrcTableGet(pSsrcTable, 0x10000 + i * 7919, SSRC_TABLE_KIND_RTX, &item));
+        EXPECT_EQ(i + 1, item);
+    }
+    EXPECT_EQ(STATUS_SUCCESS, ssrcTableGet(pSsrcTable, 1, SSRC_TABLE_KIND_RECEIVER, &item));
+    EXPECT_EQ(200, item);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeSsrcTable(&pSsrcTable));
+    EXPECT_TRUE(pSsrcTable == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, freeSsrcTable(&pSsrcTable));
+}
+
+TEST_F(SsrcTableFunctionalityTest, unknownSsrcIsReportedOnce)
+{
+    PSsrcTable pSsrcTable = NULL;
+
+    EXPECT_EQ(STATUS_SUCCESS, createSsrcTable(&pSsrcTable));
+
+    EXPECT_TRUE(ssrcTableReportUnknown(pSsrcTable, 1234));
+    EXPECT_FALSE(ssrcTableReportUnknown(pSsrcTable, 1234));
+    EXPECT_TRUE(ssrcTableReportUnknown(pSsrcTable, 0));
+    EXPECT_FALSE(ssrcTableReportUnknown(pSsrcTable, 0));
+
+    // Any change to the table means a previously unknown ssrc may now be handled
+    EXPECT_EQ(STATUS_SUCCESS, ssrcTablePut(pSsrcTable, 5678, SSRC_TABLE_KIND_RECEIVER, 1));
+    EXPECT_TRUE(ssrcTableReportUnknown(pSsrcTable, 1234));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeSsrcTable(&pSsrcTable));
+}
+
+TEST_F(SsrcTableFunctionalityTest, concurrentReadersDuringGrowth)
+{
+    PSsrcTable pSsrcTable = NULL;
+    volatile ATOMIC_BOOL done = FALSE, failed = FALSE;
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, createSsrcTable(&pSsrcTable));
+    EXPECT_EQ(STATUS_SUCCESS, ssrcTablePut(pSsrcTable, 42, SSRC_TABLE_KIND_RECEIVER, 42));
+
+    std::thread reader([&]() {
+        UINT64 item;
+        while (!ATOMIC_LOAD_BOOL(&done)) {
+            if (STATUS_FAILED(ssrcTableGet(pSsrcTable, 42, SSRC_TABLE_KIND_RECEIVER, &item)) || item != 42) {
+                ATOMIC_STORE_BOOL(&failed, TRUE);
+            }
+        }
+    });
+
+    for (i = 1; i <= 1000; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, ssrcTablePut(pSsrcTable, 42 + i, SSRC_TABLE_KIND_RECEIVER, i));
+    }
+
+    ATOMIC_STORE_BOOL(&done, TRUE);
+    reader.join();
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&failed));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeSsrcTable(&pSsrcTable));
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
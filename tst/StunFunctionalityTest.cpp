@@ -693,6 +693,166 @@ TEST_F(StunFunctionalityTest, deserializeStunErrorCode)
     EXPECT_EQ(STATUS_SUCCESS, freeStunPacket(&pStunPacket));
 }
 
+TEST_F(StunFunctionalityTest, parseStunPacketViewMatchesDeserialize)
+{
+    BYTE bindingRequestUsernameBytes[] = {0x00, 0x01, 0x00, 0x4c, 0x21, 0x12, 0xa4, 0x42, 0x21, 0x8d, 0x70, 0xf0, 0x9c, 0xcd, 0x89, 0x06,
+                                          0x62, 0x25, 0x89, 0x97, 0x00, 0x06, 0x00, 0x11, 0x36, 0x61, 0x30, 0x35, 0x66, 0x38, 0x34, 0x38,
+                                          0x3a, 0x38, 0x61, 0x63, 0x33, 0x65, 0x39, 0x30, 0x32, 0x00, 0x00, 0x00, 0x00, 0x24, 0x00, 0x04,
+                                          0x7e, 0x7f, 0x00, 0xff, 0x80, 0x2a, 0x00, 0x08, 0x22, 0xf2, 0xa4, 0x44, 0x77, 0x68, 0x9b, 0x32,
+                                          0x00, 0x08, 0x00, 0x14, 0xee, 0x55, 0x92, 0xb0, 0xde, 0x31, 0x89, 0x24, 0xa7, 0xef, 0xe5, 0xaf,
+                                          0x2d, 0xbb, 0x84, 0x8e, 0xf0, 0xe6, 0xda, 0x26, 0x80, 0x28, 0x00, 0x04, 0x36, 0xbb, 0x52, 0x10};
+    BYTE original[SIZEOF(bindingRequestUsernameBytes)];
+    StunHmacKey hmacKey, wrongHmacKey;
+    StunPacketView stunPacketView;
+    PStunAttributeView pStunAttributeView = NULL;
+    PStunPacket pStunPacket = NULL;
+    PStunAttributeHeader pAttribute = NULL;
+
+    MEMCPY(original, bindingRequestUsernameBytes, SIZEOF(original));
+    EXPECT_EQ(STATUS_SUCCESS, initStunHmacKey(&hmacKey, (PBYTE) TEST_STUN_PASSWORD, (UINT32) STRLEN(TEST_STUN_PASSWORD)));
+    EXPECT_EQ(STATUS_SUCCESS, initStunHmacKey(&wrongHmacKey, (PBYTE) "wrong password", (UINT32) STRLEN("wrong password")));
+
+    EXPECT_EQ(STATUS_NULL_ARG, parseStunPacketView(NULL, SIZEOF(bindingRequestUsernameBytes), &hmacKey, &stunPacketView));
+    EXPECT_EQ(STATUS_INVALID_ARG, parseStunPacketView(bindingRequestUsernameBytes, STUN_HEADER_LEN - 1, &hmacKey, &stunPacketView));
+    EXPECT_EQ(STATUS_INVALID_ARG,
+              parseStunPacketView(bindingRequestUsernameBytes, SIZEOF(bindingRequestUsernameBytes) - 1, &hmacKey, &stunPacketView));
+    // Has a message integrity
+    EXPECT_EQ(STATUS_NULL_ARG, parseStunPacketView(bindingRequestUsernameBytes, SIZEOF(bindingRequestUsernameBytes), NULL, &stunPacketView));
+    EXPECT_EQ(STATUS_STUN_MESSAGE_INTEGRITY_MISMATCH,
+              parseStunPacketView(bindingRequestUsernameBytes, SIZEOF(bindingRequestUsernameBytes), &wrongHmacKey, &stunPacketView));
+    EXPECT_EQ(0, MEMCMP(original, bindingRequestUsernameBytes, SIZEOF(original)));
+
+    EXPECT_EQ(STATUS_SUCCESS, parseStunPacketView(bindingRequestUsernameBytes, SIZEOF(bindingRequestUsernameBytes), &hmacKey, &stunPacketView));
+    EXPECT_EQ(0, MEMCMP(original, bindingRequestUsernameBytes, SIZEOF(original)));
+
+    // Same attributes as the allocating parser
+    EXPECT_EQ(STATUS_SUCCESS,
+              deserializeStunPacket(bindingRequestUsernameBytes, SIZEOF(bindingRequestUsernameBytes), (PBYTE) TEST_STUN_PASSWORD,
+                                    (UINT32) STRLEN(TEST_STUN_PASSWORD) * SIZEOF(CHAR), &pStunPacket));
+    EXPECT_EQ(pStunPacket->header.stunMessageType, stunPacketView.stunMessageType);
+    EXPECT_EQ(pStunPacket->header.messageLength, stunPacketView.messageLength);
+    EXPECT_EQ(0, MEMCMP(pStunPacket->header.transactionId, stunPacketView.transactionId, STUN_TRANSACTION_ID_LEN));
+    EXPECT_EQ(pStunPacket->attributesCount, stunPacketView.attributesCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, getStunPacketViewAttribute(&stunPacketView, STUN_ATTRIBUTE_TYPE_PRIORITY, &pStunAttributeView));
+    ASSERT_TRUE(pStunAttributeView != NULL);
+    EXPECT_EQ(STATUS_SUCCESS, getStunAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_PRIORITY, &pAttribute));
+    EXPECT_EQ(((PStunAttributePriority) pAttribute)->priority, (UINT32) getInt32(*(PINT32) pStunAttributeView->pValue));
+
+    EXPECT_EQ(STATUS_SUCCESS, getStunPacketViewAttribute(&stunPacketView, STUN_ATTRIBUTE_TYPE_USERNAME, &pStunAttributeView));
+    ASSERT_TRUE(pStunAttributeView != NULL);
+    EXPECT_EQ(17, pStunAttributeView->length);
+    EXPECT_EQ(0, MEMCMP("6a05f848:8ac3e902", pStunAttributeView->pValue, pStunAttributeView->length));
+
+    EXPECT_EQ(STATUS_SUCCESS, getStunPacketViewAttribute(&stunPacketView, STUN_ATTRIBUTE_TYPE_USE_CANDIDATE, &pStunAttributeView));
+    EXPECT_TRUE(pStunAttributeView == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, freeStunPacket(&pStunPacket));
+
+    // Corrupted fingerprint
+    bindingRequestUsernameBytes[SIZEOF(bindingRequestUsernameBytes) - 1] ^= 0x01;
+    EXPECT_EQ(STATUS_STUN_FINGERPRINT_MISMATCH,
+              parseStunPacketView(bindingRequestUsernameBytes, SIZEOF(bindingRequestUsernameBytes), &hmacKey, &stunPacketView));
+
+    // Attribute running past the message
+    bindingRequestUsernameBytes[SIZEOF(bindingRequestUsernameBytes) - 1] ^= 0x01;
+    bindingRequestUsernameBytes[STUN_HEADER_LEN + STUN_ATTRIBUTE_HEADER_TYPE_LEN + 1] = 0xff;
+    EXPECT_EQ(STATUS_INVALID_ARG, parseStunPacketView(bindingRequestUsernameBytes, SIZEOF(bindingRequestUsernameBytes), &hmacKey, &stunPacketView));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeStunHmacKey(&hmacKey));
+    EXPECT_EQ(STATUS_SUCCESS, freeStunHmacKey(&wrongHmacKey));
+}
+
+TEST_F(StunFunctionalityTest, serializeStunBindingResponseMatchesSerialize)
+{
+    BYTE transactionId[STUN_TRANSACTION_ID_LEN];
+    BYTE expected[STUN_PACKET_ALLOCATION_SIZE], actual[STUN_PACKET_ALLOCATION_SIZE];
+    UINT32 expectedSize, actualSize, i;
+    KvsIpAddress addresses[2], mappedAddress;
+    StunHmacKey hmacKey;
+    StunPacketView stunPacketView;
+    PStunAttributeView pStunAttributeView = NULL;
+    PStunPacket pStunPacket = NULL;
+    UINT64 tieBreaker = 0x0123456789abcdefULL;
+
+    MEMCPY(transactionId, (PBYTE) "ABCDEFGHIJKL", STUN_TRANSACTION_ID_LEN);
+    MEMSET(addresses, 0x00, SIZEOF(addresses));
+    addresses[0].family = KVS_IP_FAMILY_TYPE_IPV4;
+    addresses[0].port = (UINT16) getInt16(12345);
+    MEMCPY(addresses[0].address, (PBYTE) "\xc0\xa8\x01\x02", IPV4_ADDRESS_LENGTH);
+    addresses[1].family = KVS_IP_FAMILY_TYPE_IPV6;
+    addresses[1].port = (UINT16) getInt16(54321);
+    MEMCPY(addresses[1].address, (PBYTE) "0123456789abcdef", IPV6_ADDRESS_LENGTH);
+
+    EXPECT_EQ(STATUS_SUCCESS, initStunHmacKey(&hmacKey, (PBYTE) TEST_STUN_PASSWORD, (UINT32) STRLEN(TEST_STUN_PASSWORD)));
+
+    for (i = 0; i < ARRAY_SIZE(addresses); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, createStunPacket(STUN_PACKET_TYPE_BINDING_RESPONSE_SUCCESS, transactionId, &pStunPacket));
+        EXPECT_EQ(STATUS_SUCCESS, appendStunAddressAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, &addresses[i]));
+        EXPECT_EQ(STATUS_SUCCESS, appendStunIceControllAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING, tieBreaker));
+        expectedSize = ARRAY_SIZE(expected);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  iceUtilsPackageStunPacket(pStunPacket, (PBYTE) TEST_STUN_PASSWORD, (UINT32) STRLEN(TEST_STUN_PASSWORD), expected, &expectedSize));
+        EXPECT_EQ(STATUS_SUCCESS, freeStunPacket(&pStunPacket));
+
+        actualSize = ARRAY_SIZE(actual);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  serializeStunBindingResponse(transactionId, &addresses[i], STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING, tieBreaker, &hmacKey, actual,
+                                               &actualSize));
+        ASSERT_EQ(expectedSize, actualSize);
+        EXPECT_EQ(0, MEMCMP(expected, actual, actualSize));
+
+        // Too small
+        actualSize = expectedSize - 1;
+        EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY,
+                  serializeStunBindingResponse(transactionId, &addresses[i], STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING, tieBreaker, &hmacKey, actual,
+                                               &actualSize));
+
+        // Read back in place
+        EXPECT_EQ(STATUS_SUCCESS, parseStunPacketView(expected, expectedSize, &hmacKey, &stunPacketView));
+        EXPECT_EQ(STUN_PACKET_TYPE_BINDING_RESPONSE_SUCCESS, stunPacketView.stunMessageType);
+        EXPECT_EQ(STATUS_SUCCESS, getStunPacketViewAttribute(&stunPacketView, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, &pStunAttributeView));
+        ASSERT_TRUE(pStunAttributeView != NULL);
+        EXPECT_EQ(STATUS_SUCCESS, getStunPacketViewAddress(&stunPacketView, pStunAttributeView, &mappedAddress));
+        EXPECT_EQ(addresses[i].family, mappedAddress.family);
+        EXPECT_EQ(addresses[i].port, mappedAddress.port);
+        EXPECT_EQ(0, MEMCMP(addresses[i].address, mappedAddress.address, IS_IPV4_ADDR(&mappedAddress) ? IPV4_ADDRESS_LENGTH : IPV6_ADDRESS_LENGTH));
+    }
+
+    EXPECT_EQ(STATUS_INVALID_ARG,
+              serializeStunBindingResponse(transactionId, &addresses[0], STUN_ATTRIBUTE_TYPE_PRIORITY, tieBreaker, &hmacKey, actual, &actualSize));
+    EXPECT_EQ(STATUS_NULL_ARG,
+              serializeStunBindingResponse(transactionId, &addresses[0], STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING, tieBreaker, NULL, actual, &actualSize));
+    EXPECT_EQ(STATUS_SUCCESS, freeStunHmacKey(&hmacKey));
+}
+
+TEST_F(StunFunctionalityTest, precomputedHmacKeyMatchesOneShotHmac)
+{
+    BYTE transactionId[STUN_TRANSACTION_ID_LEN];
+    BYTE buffer[STUN_PACKET_ALLOCATION_SIZE];
+    CHAR password[STUN_HMAC_BLOCK_LEN * 2 + 1];
+    UINT32 size, passwordLen;
+    PStunPacket pStunPacket = NULL, pDeserializedPacket = NULL;
+    StunHmacKey hmacKey;
+
+    MEMSET(password, 'p', SIZEOF(password) - 1);
+    password[SIZEOF(password) - 1] = '\0';
+    MEMCPY(transactionId, (PBYTE) "ABCDEFGHIJKL", STUN_TRANSACTION_ID_LEN);
+    EXPECT_EQ(STATUS_SUCCESS, createStunPacket(STUN_PACKET_TYPE_BINDING_REQUEST, transactionId, &pStunPacket));
+    EXPECT_EQ(STATUS_SUCCESS, appendStunPriorityAttribute(pStunPacket, 12345));
+
+    // Shorter than, equal to and longer than the HMAC block, deserializeStunPacket validates with the one shot HMAC
+    for (passwordLen = 1; passwordLen < SIZEOF(password); passwordLen += STUN_HMAC_BLOCK_LEN / 2 - 1) {
+        EXPECT_EQ(STATUS_SUCCESS, initStunHmacKey(&hmacKey, (PBYTE) password, passwordLen));
+        size = ARRAY_SIZE(buffer);
+        EXPECT_EQ(STATUS_SUCCESS, serializeStunPacketWithHmacKey(pStunPacket, &hmacKey, TRUE, buffer, &size));
+        EXPECT_EQ(STATUS_SUCCESS, deserializeStunPacket(buffer, size, (PBYTE) password, passwordLen, &pDeserializedPacket));
+        EXPECT_EQ(STATUS_SUCCESS, freeStunPacket(&pDeserializedPacket));
+        EXPECT_EQ(STATUS_SUCCESS, freeStunHmacKey(&hmacKey));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeStunPacket(&pStunPacket));
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
@@ -0,0 +1,195 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+class TimerWheelFunctionalityTest : public WebRtcClientTestBase {
+};
+
+typedef struct {
+    volatile SIZE_T invocationCount;
+    UINT64 dueTime;
+    volatile ATOMIC_BOOL firedEarly;
+    volatile ATOMIC_BOOL inCallback;
+    UINT32 stopAfter;
+} TimerWheelTestData, *PTimerWheelTestData;
+
+STATUS timerWheelTestCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData)
+{
+    PTimerWheelTestData pTestData = (PTimerWheelTestData) customData;
+    SIZE_T invocationCount;
+    UNUSED_PARAM(timerId);
+
+    if (currentTime < pTestData->dueTime) {
+        ATOMIC_STORE_BOOL(&pTestData->firedEarly, TRUE);
+    }
+
+    invocationCount = ATOMIC_INCREMENT(&pTestData->invocationCount) + 1;
+    if (pTestData->stopAfter != 0 && invocationCount >= pTestData->stopAfter) {
+        return STATUS_TIMER_QUEUE_STOP_SCHEDULING;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+TEST_F(TimerWheelFunctionalityTest, sharedTimerQueueInvokesCancelsAndStopsTimers)
+{
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    TimerWheelTestData singleShot, periodic, cancelled;
+    UINT32 singleShotId, periodicId, cancelledId;
+    UINT64 timeout;
+
+    MEMSET(&singleShot, 0x00, SIZEOF(singleShot));
+    MEMSET(&periodic, 0x00, SIZEOF(periodic));
+    MEMSET(&cancelled, 0x00, SIZEOF(cancelled));
+    periodic.stopAfter = 3;
+
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueCreate(&timerQueueHandle));
+    EXPECT_TRUE(IS_SHARED_TIMER_QUEUE_HANDLE(timerQueueHandle));
+
+    singleShot.dueTime = GETTIME() + 30 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    EXPECT_EQ(STATUS_SUCCESS,
+              sharedTimerQueueAddTimer(timerQueueHandle, 30 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND, TIMER_QUEUE_SINGLE_INVOCATION_PERIOD,
+                                       timerWheelTestCallback, (UINT64) &singleShot, &singleShotId));
+    periodic.dueTime = GETTIME() + 10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    EXPECT_EQ(STATUS_SUCCESS,
+              sharedTimerQueueAddTimer(timerQueueHandle, 10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND, 20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND,
+                                       timerWheelTestCallback, (UINT64) &periodic, &periodicId));
+    EXPECT_EQ(STATUS_SUCCESS,
+              sharedTimerQueueAddTimer(timerQueueHandle, 50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND, TIMER_QUEUE_SINGLE_INVOCATION_PERIOD,
+                                       timerWheelTestCallback, (UINT64) &cancelled, &cancelledId));
+    EXPECT_NE(singleShotId, periodicId);
+
+    // Cancelling with the wrong custom data is a no-op
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueCancelTimer(timerQueueHandle, cancelledId, (UINT64) &singleShot));
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueCancelTimer(timerQueueHandle, cancelledId, (UINT64) &cancelled));
+    EXPECT_EQ(STATUS_INVALID_ARG, sharedTimerQueueCancelTimer(timerQueueHandle, DEFAULT_TIMER_QUEUE_TIMER_COUNT, (UINT64) &cancelled));
+
+    timeout = GETTIME() + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    while ((ATOMIC_LOAD(&singleShot.invocationCount) < 1 || ATOMIC_LOAD(&periodic.invocationCount) < 3) && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    // Leave time for any extra invocation to show up
+    THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+
+    EXPECT_EQ(1, ATOMIC_LOAD(&singleShot.invocationCount));
+    EXPECT_EQ(3, ATOMIC_LOAD(&periodic.invocationCount));
+    EXPECT_EQ(0, ATOMIC_LOAD(&cancelled.invocationCount));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&singleShot.firedEarly));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&periodic.firedEarly));
+
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueShutdown(timerQueueHandle));
+    EXPECT_EQ(STATUS_TIMER_QUEUE_SHUTDOWN,
+              sharedTimerQueueAddTimer(timerQueueHandle, 0, TIMER_QUEUE_SINGLE_INVOCATION_PERIOD, timerWheelTestCallback, (UINT64) &singleShot,
+                                       &singleShotId));
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueFree(&timerQueueHandle));
+    EXPECT_FALSE(IS_VALID_TIMER_QUEUE_HANDLE(timerQueueHandle));
+}
+
+TEST_F(TimerWheelFunctionalityTest, sharedTimerQueueCascadesLongTimers)
+{
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    TimerWheelTestData testData;
+    UINT32 timerId;
+    // Beyond the range of the first level of the wheel
+    UINT64 delay = 2 * TIMER_WHEEL_SLOT_COUNT * TIMER_WHEEL_TICK_DURATION, timeout;
+
+    MEMSET(&testData, 0x00, SIZEOF(testData));
+
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueCreate(&timerQueueHandle));
+    testData.dueTime = GETTIME() + delay;
+    EXPECT_EQ(STATUS_SUCCESS,
+              sharedTimerQueueAddTimer(timerQueueHandle, delay, TIMER_QUEUE_SINGLE_INVOCATION_PERIOD, timerWheelTestCallback, (UINT64) &testData,
+                                       &timerId));
+
+    timeout = testData.dueTime + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    while (ATOMIC_LOAD(&testData.invocationCount) < 1 && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(1, ATOMIC_LOAD(&testData.invocationCount));
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&testData.firedEarly));
+
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueFree(&timerQueueHandle));
+}
+
+STATUS timerWheelTestSlowCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData)
+{
+    PTimerWheelTestData pTestData = (PTimerWheelTestData) customData;
+    UNUSED_PARAM(timerId);
+    UNUSED_PARAM(currentTime);
+
+    ATOMIC_STORE_BOOL(&pTestData->inCallback, TRUE);
+    THREAD_SLEEP(50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    ATOMIC_INCREMENT(&pTestData->invocationCount);
+    ATOMIC_STORE_BOOL(&pTestData->inCallback, FALSE);
+
+    return STATUS_SUCCESS;
+}
+
+TEST_F(TimerWheelFunctionalityTest, sharedTimerQueueShutdownWaitsForRunningCallbacks)
+{
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    TimerWheelTestData testData;
+    UINT32 timerId;
+    SIZE_T invocationCount;
+    UINT64 timeout;
+
+    MEMSET(&testData, 0x00, SIZEOF(testData));
+
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueCreate(&timerQueueHandle));
+    EXPECT_EQ(STATUS_SUCCESS,
+              sharedTimerQueueAddTimer(timerQueueHandle, 0, TIMER_WHEEL_TICK_DURATION, timerWheelTestSlowCallback, (UINT64) &testData, &timerId));
+
+    timeout = GETTIME() + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    while (!ATOMIC_LOAD_BOOL(&testData.inCallback) && GETTIME() < timeout) {
+        THREAD_SLEEP(TIMER_WHEEL_TICK_DURATION);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueShutdown(timerQueueHandle));
+    // The invocation that was running when the queue was shut down has completed
+    EXPECT_FALSE(ATOMIC_LOAD_BOOL(&testData.inCallback));
+    invocationCount = ATOMIC_LOAD(&testData.invocationCount);
+    EXPECT_LE(1, invocationCount);
+
+    THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    EXPECT_EQ(invocationCount, ATOMIC_LOAD(&testData.invocationCount));
+
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueFree(&timerQueueHandle));
+}
+
+TEST_F(TimerWheelFunctionalityTest, sharedTimerQueueFunctionsAcceptDedicatedTimerQueues)
+{
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    TimerWheelTestData testData;
+    UINT32 timerId;
+    UINT64 timeout;
+
+    MEMSET(&testData, 0x00, SIZEOF(testData));
+
+    EXPECT_EQ(STATUS_SUCCESS, timerQueueCreate(&timerQueueHandle));
+    EXPECT_FALSE(IS_SHARED_TIMER_QUEUE_HANDLE(timerQueueHandle));
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              sharedTimerQueueAddTimer(timerQueueHandle, 0, TIMER_QUEUE_SINGLE_INVOCATION_PERIOD, timerWheelTestCallback, (UINT64) &testData,
+                                       &timerId));
+
+    timeout = GETTIME() + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    while (ATOMIC_LOAD(&testData.invocationCount) < 1 && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(1, ATOMIC_LOAD(&testData.invocationCount));
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueShutdown(timerQueueHandle));
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueFree(&timerQueueHandle));
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,357 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define TWCC_FEEDBACK_TEST_START_TIME (1000 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+#define TWCC_FEEDBACK_TEST_SSRC       0x2cd1a0de
+
+class TwccFeedbackGeneratorFunctionalityTest : public WebRtcClientTestBase {
+  public:
+    static std::vector<std::vector<BYTE>> feedbackPackets;
+    static volatile SIZE_T feedbackCount;
+
+    static STATUS sendFn(UINT64 customData, PBYTE pPacket, UINT32 packetLen)
+    {
+        UNUSED_PARAM(customData);
+
+        feedbackPackets.push_back(std::vector<BYTE>(pPacket, pPacket + packetLen));
+        ATOMIC_INCREMENT(&feedbackCount);
+        return STATUS_SUCCESS;
+    }
+
+    VOID SetUp()
+    {
+        WebRtcClientTestBase::SetUp();
+        feedbackPackets.clear();
+        feedbackCount = 0;
+    }
+
+    static UINT16 baseSeqNum(std::vector<BYTE>& packet)
+    {
+        return getUnalignedInt16BigEndian(packet.data() + 12);
+    }
+
+    static UINT16 packetStatusCount(std::vector<BYTE>& packet)
+    {
+        return getUnalignedInt16BigEndian(packet.data() + 14);
+    }
+
+    /**
+     * Parse a feedback packet with parseRtcpTwccPacket and return the remote time it gives to each of the packets it covers,
+     * TWCC_PACKET_LOST_TIME for the ones reported lost
+     */
+    std::vector<UINT64> parse(std::vector<BYTE>& packet)
+    {
+        TwccManager twccManager{};
+        RtcpPacket rtcpPacket;
+        UINT16 count = packetStatusCount(packet);
+        std::vector<TwccRtpPacketInfo> packetInfos(count);
+        std::vector<UINT64> remoteTimes;
+        UINT32 i;
+
+        EXPECT_EQ(STATUS_SUCCESS, setRtcpPacketFromBytes(packet.data(), (UINT32) packet.size(), &rtcpPacket));
+        EXPECT_EQ(RTCP_PACKET_TYPE_GENERIC_RTP_FEEDBACK, rtcpPacket.header.packetType);
+        EXPECT_EQ(RTCP_FEEDBACK_MESSAGE_TYPE_APPLICATION_LAYER_FEEDBACK, rtcpPacket.header.receptionReportCount);
+        EXPECT_EQ(packet.size(), (rtcpPacket.header.packetLength + 1) * RTCP_PACKET_LEN_WORD_SIZE);
+
+        EXPECT_EQ(STATUS_SUCCESS,
+                  hashTableCreateWithParams(TWCC_HASH_TABLE_BUCKET_COUNT, TWCC_HASH_TABLE_BUCKET_LENGTH, &twccManager.pTwccRtpPktInfosHashTable));
+        for (i = 0; i < count; i++) {
+            packetInfos[i].remoteTimeKvs = TWCC_PACKET_UNITIALIZED_TIME;
+            EXPECT_EQ(STATUS_SUCCESS,
+                      hashTableUpsert(twccManager.pTwccRtpPktInfosHashTable, (UINT16) (baseSeqNum(packet) + i), (UINT64) &packetInfos[i]));
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, parseRtcpTwccPacket(&rtcpPacket, &twccManager));
+        EXPECT_EQ(STATUS_SUCCESS, hashTableFree(twccManager.pTwccRtpPktInfosHashTable));
+
+        for (i = 0; i < count; i++) {
+            remoteTimes.push_back(packetInfos[i].remoteTimeKvs);
+        }
+        return remoteTimes;
+    }
+
+    // The arrival times come back within a tick, relative to the first packet received
+    VOID expectArrivalTimes(std::vector<UINT64>& arrivalTimes, std::vector<UINT64> remoteTimes)
+    {
+        UINT32 i, first = 0;
+
+        ASSERT_EQ(arrivalTimes.size(), remoteTimes.size());
+        while (first < arrivalTimes.size() && arrivalTimes[first] == 0) {
+            first++;
+        }
+
+        for (i = 0; i < arrivalTimes.size(); i++) {
+            if (arrivalTimes[i] == 0) {
+                EXPECT_EQ(TWCC_PACKET_LOST_TIME, remoteTimes[i]) << "packet " << i;
+            } else {
+                EXPECT_NEAR((DOUBLE) (INT64) (remoteTimes[i] - remoteTimes[first]), (DOUBLE) (INT64) (arrivalTimes[i] - arrivalTimes[first]),
+                            TWCC_TICK_DURATION)
+                    << "packet " << i;
+            }
+        }
+    }
+
+    // Serialize the arrival times with createRtcpTwccPacket and check them after a round trip through the parser
+    UINT32 roundTrip(UINT16 baseSequenceNumber, std::vector<UINT64>& arrivalTimes)
+    {
+        std::vector<BYTE> packet(TWCC_FB_MAX_PACKET_LEN);
+        UINT32 packetLen = 0;
+
+        EXPECT_EQ(STATUS_SUCCESS,
+                  createRtcpTwccPacket(1, TWCC_FEEDBACK_TEST_SSRC, baseSequenceNumber, arrivalTimes.data(), (UINT16) arrivalTimes.size(), 7,
+                                       NULL, &packetLen));
+        EXPECT_GE(TWCC_FB_MAX_PACKET_LEN, packetLen);
+        packet.resize(packetLen);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  createRtcpTwccPacket(1, TWCC_FEEDBACK_TEST_SSRC, baseSequenceNumber, arrivalTimes.data(), (UINT16) arrivalTimes.size(), 7,
+                                       packet.data(), &packetLen));
+        EXPECT_EQ(packet.size(), packetLen);
+
+        EXPECT_EQ(TWCC_FEEDBACK_TEST_SSRC, getUnalignedInt32BigEndian(packet.data() + 8));
+        EXPECT_EQ(baseSequenceNumber, baseSeqNum(packet));
+        EXPECT_EQ(arrivalTimes.size(), packetStatusCount(packet));
+        EXPECT_EQ(7, packet[19]);
+        expectArrivalTimes(arrivalTimes, parse(packet));
+
+        return packetLen;
+    }
+};
+
+std::vector<std::vector<BYTE>> TwccFeedbackGeneratorFunctionalityTest::feedbackPackets;
+volatile SIZE_T TwccFeedbackGeneratorFunctionalityTest::feedbackCount = 0;
+
+TEST_F(TwccFeedbackGeneratorFunctionalityTest, createRtcpTwccPacketArgs)
+{
+    UINT64 arrivalTimes[TWCC_FB_MAX_PACKET_STATUS_COUNT + 1] = {TWCC_FEEDBACK_TEST_START_TIME};
+    BYTE packet[TWCC_FB_MAX_PACKET_LEN];
+    UINT32 packetLen = 0;
+
+    EXPECT_EQ(STATUS_NULL_ARG, createRtcpTwccPacket(0, 0, 0, NULL, 1, 0, NULL, &packetLen));
+    EXPECT_EQ(STATUS_NULL_ARG, createRtcpTwccPacket(0, 0, 0, arrivalTimes, 1, 0, NULL, NULL));
+    EXPECT_EQ(STATUS_INVALID_ARG, createRtcpTwccPacket(0, 0, 0, arrivalTimes, 0, 0, NULL, &packetLen));
+    EXPECT_EQ(STATUS_INVALID_ARG, createRtcpTwccPacket(0, 0, 0, arrivalTimes, TWCC_FB_MAX_PACKET_STATUS_COUNT + 1, 0, NULL, &packetLen));
+
+    // One run length chunk and one small delta
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpTwccPacket(0, 0, 0, arrivalTimes, 1, 0, NULL, &packetLen));
+    EXPECT_EQ(ROUND_UP(TWCC_FB_HEADER_LEN + TWCC_FB_PACKETCHUNK_SIZE + 1, RTCP_PACKET_LEN_WORD_SIZE), packetLen);
+    packetLen--;
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, createRtcpTwccPacket(0, 0, 0, arrivalTimes, 1, 0, packet, &packetLen));
+    packetLen = SIZEOF(packet);
+    EXPECT_EQ(STATUS_SUCCESS, createRtcpTwccPacket(0, 0, 0, arrivalTimes, 1, 0, packet, &packetLen));
+    EXPECT_EQ(ROUND_UP(TWCC_FB_HEADER_LEN + TWCC_FB_PACKETCHUNK_SIZE + 1, RTCP_PACKET_LEN_WORD_SIZE), packetLen);
+}
+
+TEST_F(TwccFeedbackGeneratorFunctionalityTest, createRtcpTwccPacketRunLength)
+{
+    std::vector<UINT64> arrivalTimes;
+    UINT32 i;
+
+    // A millisecond apart, one run length chunk covers them all
+    for (i = 0; i < 100; i++) {
+        arrivalTimes.push_back(TWCC_FEEDBACK_TEST_START_TIME + i * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_EQ(ROUND_UP(TWCC_FB_HEADER_LEN + TWCC_FB_PACKETCHUNK_SIZE + 100, RTCP_PACKET_LEN_WORD_SIZE), roundTrip(100, arrivalTimes));
+
+    // Then 50 lost, a second chunk without any delta
+    arrivalTimes.resize(150, 0);
+    EXPECT_EQ(ROUND_UP(TWCC_FB_HEADER_LEN + 2 * TWCC_FB_PACKETCHUNK_SIZE + 100, RTCP_PACKET_LEN_WORD_SIZE), roundTrip(100, arrivalTimes));
+}
+
+TEST_F(TwccFeedbackGeneratorFunctionalityTest, createRtcpTwccPacketStatusVectors)
+{
+    std::vector<UINT64> arrivalTimes;
+    UINT64 time = TWCC_FEEDBACK_TEST_START_TIME;
+    UINT32 i;
+
+    // Every other packet lost, one bit status vectors of 14
+    for (i = 0; i < 28; i++) {
+        time += HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        arrivalTimes.push_back(i % 2 == 0 ? time : 0);
+    }
+    EXPECT_EQ(ROUND_UP(TWCC_FB_HEADER_LEN + 2 * TWCC_FB_PACKETCHUNK_SIZE + 14, RTCP_PACKET_LEN_WORD_SIZE), roundTrip(65530, arrivalTimes));
+
+    // Large and negative deltas need two bit status vectors of 7
+    arrivalTimes.clear();
+    time = TWCC_FEEDBACK_TEST_START_TIME;
+    for (i = 0; i < 14; i++) {
+        time += (i % 3 == 0 ? 100 : 1) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        arrivalTimes.push_back(i % 4 == 1 ? 0 : time);
+    }
+    // Reordered
+    arrivalTimes[6] = arrivalTimes[4] - 10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    // 5 large and 5 small deltas
+    EXPECT_EQ(ROUND_UP(TWCC_FB_HEADER_LEN + 2 * TWCC_FB_PACKETCHUNK_SIZE + 5 * 2 + 5, RTCP_PACKET_LEN_WORD_SIZE), roundTrip(0, arrivalTimes));
+}
+
+TEST_F(TwccFeedbackGeneratorFunctionalityTest, createRtcpTwccPacketRandomRoundTrip)
+{
+    std::vector<UINT64> arrivalTimes;
+    UINT64 time = TWCC_FEEDBACK_TEST_START_TIME;
+    UINT32 i, run;
+
+    SRAND(12345);
+    for (run = 0; run < 100; run++) {
+        arrivalTimes.clear();
+        for (i = 0; i < TWCC_FB_MAX_PACKET_STATUS_COUNT; i++) {
+            // Bursts of packets close together, some loss and the odd pause
+            time += (RAND() % 10 == 0 ? RAND() % 300 : RAND() % 3) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND + RAND() % TWCC_TICK_DURATION;
+            arrivalTimes.push_back(RAND() % 5 == 0 ? 0 : time);
+        }
+        roundTrip((UINT16) RAND(), arrivalTimes);
+    }
+}
+
+TEST_F(TwccFeedbackGeneratorFunctionalityTest, createRtcpTwccPacketEpochTime)
+{
+    std::vector<UINT64> arrivalTimes;
+    std::vector<BYTE> packet(TWCC_FB_MAX_PACKET_LEN);
+    UINT64 time = GETTIME();
+    UINT32 i, packetLen = TWCC_FB_MAX_PACKET_LEN;
+
+    // Arrival times come from GETTIME(), far more 64ms units since the epoch than fit in 32 bits
+    for (i = 0; i < 50; i++) {
+        time += (i % 10 == 0 ? 70 : 1) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        arrivalTimes.push_back(time);
+    }
+    roundTrip(0, arrivalTimes);
+
+    // Only the lower 24 bits of the reference time make it to the packet
+    EXPECT_EQ(STATUS_SUCCESS,
+              createRtcpTwccPacket(1, TWCC_FEEDBACK_TEST_SSRC, 0, arrivalTimes.data(), (UINT16) arrivalTimes.size(), 0, packet.data(), &packetLen));
+    EXPECT_EQ((arrivalTimes[0] / TWCC_REFERENCE_TIME_UNIT) & TWCC_REFERENCE_TIME_MASK,
+              ((UINT32) packet[16] << 16) | ((UINT32) packet[17] << 8) | (UINT32) packet[18]);
+}
+
+TEST_F(TwccFeedbackGeneratorFunctionalityTest, reorderedAndLatePackets)
+{
+    PTwccFeedbackGenerator pTwccFeedbackGenerator = NULL;
+    std::vector<UINT64> arrivalTimes;
+    UINT64 time = TWCC_FEEDBACK_TEST_START_TIME;
+
+    EXPECT_NE(STATUS_SUCCESS, createTwccFeedbackGenerator(INVALID_TIMER_QUEUE_HANDLE_VALUE, 1, NULL, 0, &pTwccFeedbackGenerator));
+    EXPECT_EQ(STATUS_SUCCESS, createTwccFeedbackGenerator(INVALID_TIMER_QUEUE_HANDLE_VALUE, 1, sendFn, 0, &pTwccFeedbackGenerator));
+
+    // Nothing to report yet
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorProcess(pTwccFeedbackGenerator));
+    EXPECT_EQ(0, feedbackCount);
+
+    // 11 comes after 12 and 13 never does
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorOnPacket(pTwccFeedbackGenerator, 10, TWCC_FEEDBACK_TEST_SSRC, time));
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorOnPacket(pTwccFeedbackGenerator, 12, TWCC_FEEDBACK_TEST_SSRC, time + 10000));
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorOnPacket(pTwccFeedbackGenerator, 11, TWCC_FEEDBACK_TEST_SSRC, time + 20000));
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorOnPacket(pTwccFeedbackGenerator, 14, TWCC_FEEDBACK_TEST_SSRC, time + 30000));
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorProcess(pTwccFeedbackGenerator));
+
+    ASSERT_EQ(1, feedbackCount);
+    EXPECT_EQ(10, baseSeqNum(feedbackPackets[0]));
+    EXPECT_EQ(TWCC_FEEDBACK_TEST_SSRC, getUnalignedInt32BigEndian(feedbackPackets[0].data() + 8));
+    EXPECT_EQ(0, feedbackPackets[0][19]);
+    arrivalTimes = {time, time + 20000, time + 10000, 0, time + 30000};
+    expectArrivalTimes(arrivalTimes, parse(feedbackPackets[0]));
+
+    // Too late for 13, it was reported lost already
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorOnPacket(pTwccFeedbackGenerator, 13, TWCC_FEEDBACK_TEST_SSRC, time + 40000));
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorProcess(pTwccFeedbackGenerator));
+    EXPECT_EQ(1, feedbackCount);
+
+    // Feedback packet count goes up
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorOnPacket(pTwccFeedbackGenerator, 15, TWCC_FEEDBACK_TEST_SSRC, time + 50000));
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorProcess(pTwccFeedbackGenerator));
+    ASSERT_EQ(2, feedbackCount);
+    EXPECT_EQ(15, baseSeqNum(feedbackPackets[1]));
+    EXPECT_EQ(1, packetStatusCount(feedbackPackets[1]));
+    EXPECT_EQ(1, feedbackPackets[1][19]);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccFeedbackGenerator(&pTwccFeedbackGenerator));
+    EXPECT_TRUE(pTwccFeedbackGenerator == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccFeedbackGenerator(&pTwccFeedbackGenerator));
+}
+
+TEST_F(TwccFeedbackGeneratorFunctionalityTest, sequenceNumberWrapAndSplitFeedback)
+{
+    PTwccFeedbackGenerator pTwccFeedbackGenerator = NULL;
+    std::vector<UINT64> arrivalTimes;
+    UINT64 time = TWCC_FEEDBACK_TEST_START_TIME;
+    UINT16 sequenceNumber = 65500;
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, createTwccFeedbackGenerator(INVALID_TIMER_QUEUE_HANDLE_VALUE, 1, sendFn, 0, &pTwccFeedbackGenerator));
+    for (i = 0; i < 600; i++, sequenceNumber++) {
+        time += HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorOnPacket(pTwccFeedbackGenerator, sequenceNumber, TWCC_FEEDBACK_TEST_SSRC, time));
+        arrivalTimes.push_back(time);
+    }
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorProcess(pTwccFeedbackGenerator));
+
+    // Split into packets that fit the MTU, one after the other
+    ASSERT_EQ(3, feedbackCount);
+    EXPECT_EQ(65500, baseSeqNum(feedbackPackets[0]));
+    EXPECT_EQ(TWCC_FB_MAX_PACKET_STATUS_COUNT, packetStatusCount(feedbackPackets[0]));
+    EXPECT_EQ((UINT16) (65500 + TWCC_FB_MAX_PACKET_STATUS_COUNT), baseSeqNum(feedbackPackets[1]));
+    EXPECT_EQ((UINT16) (65500 + 2 * TWCC_FB_MAX_PACKET_STATUS_COUNT), baseSeqNum(feedbackPackets[2]));
+    EXPECT_EQ(600 - 2 * TWCC_FB_MAX_PACKET_STATUS_COUNT, packetStatusCount(feedbackPackets[2]));
+
+    std::vector<UINT64> firstArrivalTimes(arrivalTimes.begin(), arrivalTimes.begin() + TWCC_FB_MAX_PACKET_STATUS_COUNT);
+    expectArrivalTimes(firstArrivalTimes, parse(feedbackPackets[0]));
+    std::vector<UINT64> lastArrivalTimes(arrivalTimes.begin() + 2 * TWCC_FB_MAX_PACKET_STATUS_COUNT, arrivalTimes.end());
+    expectArrivalTimes(lastArrivalTimes, parse(feedbackPackets[2]));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccFeedbackGenerator(&pTwccFeedbackGenerator));
+}
+
+TEST_F(TwccFeedbackGeneratorFunctionalityTest, fallingBehindSkipsTheOldestPackets)
+{
+    PTwccFeedbackGenerator pTwccFeedbackGenerator = NULL;
+    UINT64 time = TWCC_FEEDBACK_TEST_START_TIME;
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, createTwccFeedbackGenerator(INVALID_TIMER_QUEUE_HANDLE_VALUE, 1, sendFn, 0, &pTwccFeedbackGenerator));
+    for (i = 0; i < 10; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorOnPacket(pTwccFeedbackGenerator, (UINT16) i, TWCC_FEEDBACK_TEST_SSRC, time));
+    }
+    EXPECT_EQ(STATUS_SUCCESS,
+              twccFeedbackGeneratorOnPacket(pTwccFeedbackGenerator, TWCC_FEEDBACK_GENERATOR_WINDOW + 5, TWCC_FEEDBACK_TEST_SSRC, time));
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorProcess(pTwccFeedbackGenerator));
+
+    // Only the last window worth is reported, all lost but the newest
+    ASSERT_LT(0, feedbackCount);
+    EXPECT_EQ(6, baseSeqNum(feedbackPackets[0]));
+    std::vector<UINT64> remoteTimes = parse(feedbackPackets.back());
+    EXPECT_NE(TWCC_PACKET_LOST_TIME, remoteTimes.back());
+    EXPECT_EQ(TWCC_PACKET_LOST_TIME, remoteTimes.front());
+
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccFeedbackGenerator(&pTwccFeedbackGenerator));
+}
+
+TEST_F(TwccFeedbackGeneratorFunctionalityTest, timerSendsTheFeedback)
+{
+    PTwccFeedbackGenerator pTwccFeedbackGenerator = NULL;
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    UINT64 timeout;
+
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueCreate(&timerQueueHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createTwccFeedbackGenerator(timerQueueHandle, 1, sendFn, 0, &pTwccFeedbackGenerator));
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorOnPacket(pTwccFeedbackGenerator, 0, TWCC_FEEDBACK_TEST_SSRC, GETTIME()));
+    EXPECT_EQ(STATUS_SUCCESS, twccFeedbackGeneratorOnPacket(pTwccFeedbackGenerator, 1, TWCC_FEEDBACK_TEST_SSRC, GETTIME()));
+
+    timeout = GETTIME() + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    while (ATOMIC_LOAD(&feedbackCount) == 0 && GETTIME() < timeout) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeTwccFeedbackGenerator(&pTwccFeedbackGenerator));
+    ASSERT_EQ(1, feedbackCount);
+    EXPECT_EQ(2, packetStatusCount(feedbackPackets[0]));
+    EXPECT_EQ(STATUS_SUCCESS, sharedTimerQueueFree(&timerQueueHandle));
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com